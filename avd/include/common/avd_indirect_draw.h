@@ -0,0 +1,94 @@
+#ifndef AVD_INDIRECT_DRAW_H
+#define AVD_INDIRECT_DRAW_H
+
+#include "core/avd_core.h"
+#include "geom/avd_bounds.h"
+#include "model/avd_model_draw.h"
+#include "vulkan/avd_vulkan.h"
+
+#ifdef AVD_DEBUG
+#ifndef AVD_INDIRECT_DRAW_LABEL_COLOR
+#define AVD_INDIRECT_DRAW_LABEL_COLOR \
+    (float[]){0.3f, 0.5f, 0.9f, 1.0f}
+#endif
+#endif
+
+// GPU driven drawing of the mesh nodes of a model. The instances built by
+// avdModelBuildDrawInstances are culled against the frustum by one compute
+// dispatch, one thread per instance, which appends a
+// VkDrawIndexedIndirectCommand for every visible one and counts them. A
+// single vkCmdDrawIndexedIndirectCount then draws all of them from the index
+// buffer of the model, the vertex shader reads the matrix and material of its
+// instance at the instance offset plus SV_InstanceID.
+//
+// The draw count of every frame is copied back and read once the fence of
+// its in flight slot was waited on. Debug builds also cull the same instances
+// with avdDrawInstancesCull and warn when the GPU drew a different number.
+//
+// Usage per frame, outside of any render pass:
+//   avdIndirectDrawCull
+// and inside the render pass with the index buffer and the indirect vertex
+// shader bound:
+//   avdIndirectDrawDraw
+typedef struct AVD_IndirectDraw {
+    // AVD_MAX_IN_FLIGHT_FRAMES slices of maxInstances AVD_DrawInstance written
+    // by the CPU, a slice is only written again when the instances changed
+    AVD_VulkanBuffer instancesBuffer;
+    AVD_DrawInstance *mappedInstances;
+    AVD_VulkanBuffer drawCommandsBuffer;
+    AVD_VulkanBuffer drawCountBuffer;
+
+    // one draw count per in flight frame
+    AVD_VulkanBuffer readbackBuffer;
+    AVD_UInt32 *mappedReadback;
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorSet descriptorSet;
+    VkPipelineLayout pipelineLayout;
+    VkPipeline pipeline;
+
+    AVD_UInt32 maxInstances;
+
+    // what every in flight slot holds, the generation of its instances and
+    // the draw count the CPU reference expects for it
+    AVD_UInt32 slotGenerations[AVD_MAX_IN_FLIGHT_FRAMES];
+    AVD_UInt32 slotInstanceCounts[AVD_MAX_IN_FLIGHT_FRAMES];
+    AVD_UInt32 slotExpectedDrawCounts[AVD_MAX_IN_FLIGHT_FRAMES];
+    bool slotSubmitted[AVD_MAX_IN_FLIGHT_FRAMES];
+    AVD_DrawIndexedCommand *verifyCommands; // debug builds only
+
+    // read back from the frame that last used the current slot
+    AVD_UInt32 lastDrawCount;
+    AVD_UInt32 lastInstanceCount;
+    AVD_UInt32 mismatchedFrames;
+
+    // per frame state between cull and draw
+    AVD_UInt32 frameIndex;
+    AVD_UInt32 instanceCount;
+
+    char label[64];
+} AVD_IndirectDraw;
+
+// maxInstances bounds the number of instances of a frame.
+bool avdIndirectDrawCreate(AVD_IndirectDraw *draw, AVD_Vulkan *vulkan, AVD_UInt32 maxInstances, const char *label);
+void avdIndirectDrawDestroy(AVD_IndirectDraw *draw, AVD_Vulkan *vulkan);
+
+// Culls count instances against viewProjection into the indirect commands.
+// generation names the contents of instances, the instances are only copied
+// to the slice of this frame when it held a different generation.
+bool avdIndirectDrawCull(
+    VkCommandBuffer commandBuffer,
+    AVD_IndirectDraw *draw,
+    AVD_VulkanRenderer *renderer,
+    const AVD_DrawInstance *instances,
+    AVD_UInt32 count,
+    AVD_UInt32 generation,
+    const AVD_Matrix4x4 *viewProjection);
+// Start of the instances of this frame in instancesBuffer, for the vertex shader.
+AVD_UInt32 avdIndirectDrawInstanceOffset(const AVD_IndirectDraw *draw);
+void avdIndirectDrawDraw(VkCommandBuffer commandBuffer, AVD_IndirectDraw *draw);
+
+// Needs a device, run with avd --gpu-tests indirect_draw.
+bool avdIndirectDrawTestsRun(AVD_Vulkan *vulkan);
+
+#endif // AVD_INDIRECT_DRAW_H
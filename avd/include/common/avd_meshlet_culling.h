@@ -0,0 +1,108 @@
+#ifndef AVD_MESHLET_CULLING_H
+#define AVD_MESHLET_CULLING_H
+
+#include "core/avd_core.h"
+#include "geom/avd_bounds.h"
+#include "model/avd_3d_scene.h"
+#include "vulkan/avd_vulkan.h"
+
+#ifdef AVD_DEBUG
+#ifndef AVD_MESHLET_CULLING_LABEL_COLOR
+#define AVD_MESHLET_CULLING_LABEL_COLOR \
+    (float[]){0.2f, 0.8f, 0.4f, 1.0f}
+#endif
+#endif
+
+// Every visible meshlet gets a fixed slot of this many vertices in the
+// indirect draw, the vertex shader collapses the corners past the real
+// triangle count of the meshlet.
+#define AVD_MESHLET_CULLING_SLOT_VERTICES (AVD_MESHLET_MAX_TRIANGLES * 3)
+
+typedef enum AVD_MeshletCullingFlags {
+    AVD_MESHLET_CULLING_FLAG_NONE    = 0,
+    AVD_MESHLET_CULLING_FLAG_FRUSTUM = 1 << 0,
+    AVD_MESHLET_CULLING_FLAG_CONE    = 1 << 1,
+    AVD_MESHLET_CULLING_FLAG_ALL     = AVD_MESHLET_CULLING_FLAG_FRUSTUM | AVD_MESHLET_CULLING_FLAG_CONE,
+} AVD_MeshletCullingFlags;
+
+typedef struct AVD_MeshletCullingStats {
+    AVD_UInt32 visibleMeshlets;
+    AVD_UInt32 frustumCulledMeshlets;
+    AVD_UInt32 coneCulledMeshlets;
+    AVD_UInt32 testedMeshlets;
+} AVD_MeshletCullingStats;
+
+// GPU cluster culling of the meshlets built by avdMeshBuildMeshlets. One
+// compute dispatch per drawn mesh tests its meshlets against the frustum and
+// their normal cones and appends the survivors to the visible list of that
+// draw, the vertex count of its indirect command grows with them.
+//
+// Usage per frame, outside of any render pass:
+//   avdMeshletCullingBegin, avdMeshletCullingDispatch for every draw, avdMeshletCullingEnd
+// and inside the render pass with the meshlet vertex shader bound:
+//   avdMeshletCullingDraw for every draw
+typedef struct AVD_MeshletCulling {
+    AVD_VulkanBuffer meshletsBuffer;
+    AVD_VulkanBuffer meshletVerticesBuffer;
+    AVD_VulkanBuffer meshletTrianglesBuffer;
+    AVD_VulkanBuffer visibleMeshletsBuffer;
+    AVD_VulkanBuffer drawCommandsBuffer;
+
+    // one AVD_MeshletCullingStats per in flight frame, read back after the
+    // fence of that frame was waited on
+    AVD_VulkanBuffer statsBuffer;
+    AVD_MeshletCullingStats *mappedStats;
+    AVD_MeshletCullingStats lastStats;
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorSet descriptorSet;
+    VkPipelineLayout pipelineLayout;
+    VkPipeline pipeline;
+
+    AVD_UInt32 maxDraws;
+    AVD_UInt32 maxVisibleMeshlets;
+
+    // per frame state between begin and end
+    AVD_Frustum frustum;
+    AVD_Vector3 cameraPosition;
+    AVD_UInt32 flags;
+    AVD_UInt32 frameIndex;
+    AVD_UInt32 visibleCursor;
+    AVD_UInt32 testedMeshlets;
+
+    char label[64];
+} AVD_MeshletCulling;
+
+// Uploads the meshlet lists of resources. maxDraws is the number of indirect
+// commands, maxVisibleMeshlets bounds the sum of meshletCount over all draws
+// of a frame.
+bool avdMeshletCullingCreate(
+    AVD_MeshletCulling *culling,
+    AVD_Vulkan *vulkan,
+    const AVD_ModelResources *resources,
+    AVD_UInt32 maxDraws,
+    AVD_UInt32 maxVisibleMeshlets,
+    const char *label);
+void avdMeshletCullingDestroy(AVD_MeshletCulling *culling, AVD_Vulkan *vulkan);
+
+bool avdMeshletCullingBegin(
+    VkCommandBuffer commandBuffer,
+    AVD_MeshletCulling *culling,
+    AVD_VulkanRenderer *renderer,
+    const AVD_Matrix4x4 *viewProjection,
+    AVD_Vector3 cameraPosition,
+    AVD_UInt32 flags);
+// Culls the meshlets of mesh drawn with modelMatrix into the indirect command
+// drawIndex, returns the offset of its visible list through visibleOffset for
+// the vertex shader.
+bool avdMeshletCullingDispatch(
+    VkCommandBuffer commandBuffer,
+    AVD_MeshletCulling *culling,
+    const AVD_Mesh *mesh,
+    const AVD_Matrix4x4 *modelMatrix,
+    AVD_UInt32 drawIndex,
+    AVD_UInt32 *visibleOffset);
+bool avdMeshletCullingEnd(VkCommandBuffer commandBuffer, AVD_MeshletCulling *culling);
+void avdMeshletCullingDraw(VkCommandBuffer commandBuffer, AVD_MeshletCulling *culling, AVD_UInt32 drawIndex);
+
+#endif // AVD_MESHLET_CULLING_H
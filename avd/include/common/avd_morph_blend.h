@@ -0,0 +1,82 @@
+#ifndef AVD_MORPH_BLEND_H
+#define AVD_MORPH_BLEND_H
+
+#include "core/avd_core.h"
+#include "model/avd_3d_scene.h"
+#include "model/avd_model_morph.h"
+#include "vulkan/avd_vulkan.h"
+
+#ifdef AVD_DEBUG
+#ifndef AVD_MORPH_BLEND_LABEL_COLOR
+#define AVD_MORPH_BLEND_LABEL_COLOR \
+    (float[]){0.8f, 0.4f, 0.6f, 1.0f}
+#endif
+#endif
+
+// GPU blend of the sparse morph targets stored by avdMeshAddMorphTargets. The
+// vertices of resources are copied into a deformed vertex buffer that is read
+// in place of the regular one, every blended mesh overwrites its morph range
+// there each frame. Two compute passes per mesh: one thread per delta of
+// every active target adds the weighted delta to the fixed point accumulators
+// of its vertex, then one thread per vertex resolves the sums into a packed
+// vertex, the same math as avdMeshBlendMorphTargets.
+//
+// Usage per frame, outside of any render pass:
+//   avdMorphBlendBegin, avdMorphBlendDispatch once for every morphed mesh, avdMorphBlendEnd
+// then draw from deformedVerticesBuffer.
+typedef struct AVD_MorphBlend {
+    AVD_VulkanBuffer baseVerticesBuffer;
+    AVD_VulkanBuffer deformedVerticesBuffer;
+    AVD_VulkanBuffer morphTargetsBuffer;
+    AVD_VulkanBuffer morphDeltasBuffer;
+    AVD_VulkanBuffer accumulatorsBuffer;
+
+    // {target, weight} of the targets that are blended, AVD_MAX_IN_FLIGHT_FRAMES
+    // slices of maxActiveTargets written by the CPU
+    AVD_VulkanBuffer activeTargetsBuffer;
+    AVD_UInt32 *mappedActiveTargets;
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorSet descriptorSet;
+    VkPipelineLayout pipelineLayout;
+    VkPipeline pipeline;
+
+    AVD_UInt32 maxMorphVertices;
+    AVD_UInt32 maxActiveTargets;
+
+    // per frame state between begin and end
+    AVD_UInt32 frameIndex;
+    AVD_UInt32 accumulatorCursor;
+    AVD_UInt32 activeCursor;
+
+    char label[64];
+} AVD_MorphBlend;
+
+// Uploads the vertices and morph lists of resources. maxMorphVertices bounds
+// the sum of morphVertexCount and maxActiveTargets the number of targets with
+// a weight of at least AVD_MORPH_MIN_WEIGHT over all meshes of a frame.
+bool avdMorphBlendCreate(
+    AVD_MorphBlend *blend,
+    AVD_Vulkan *vulkan,
+    const AVD_ModelResources *resources,
+    AVD_UInt32 maxMorphVertices,
+    AVD_UInt32 maxActiveTargets,
+    const char *label);
+void avdMorphBlendDestroy(AVD_MorphBlend *blend, AVD_Vulkan *vulkan);
+
+bool avdMorphBlendBegin(VkCommandBuffer commandBuffer, AVD_MorphBlend *blend, AVD_VulkanRenderer *renderer);
+// Blends the targets of mesh with weights, one per target, into its morph
+// range of the deformed vertices. Meshes without active targets get their
+// base vertices back.
+bool avdMorphBlendDispatch(
+    VkCommandBuffer commandBuffer,
+    AVD_MorphBlend *blend,
+    const AVD_Mesh *mesh,
+    const AVD_ModelResources *resources,
+    const AVD_Float *weights);
+bool avdMorphBlendEnd(VkCommandBuffer commandBuffer, AVD_MorphBlend *blend);
+
+// Needs a device, run with avd --gpu-tests morph_blend.
+bool avdMorphBlendTestsRun(AVD_Vulkan *vulkan);
+
+#endif // AVD_MORPH_BLEND_H
@@ -0,0 +1,87 @@
+#ifndef AVD_ARENA_H
+#define AVD_ARENA_H
+
+#include "core/avd_base.h"
+
+struct AVD_Bench;
+
+// Size of each block the arena reserves from the system, bigger allocations get a dedicated block.
+#ifndef AVD_ARENA_DEFAULT_BLOCK_SIZE
+#define AVD_ARENA_DEFAULT_BLOCK_SIZE (256 * 1024)
+#endif
+
+#ifndef AVD_ARENA_FRAME_BLOCK_SIZE
+#define AVD_ARENA_FRAME_BLOCK_SIZE (1024 * 1024)
+#endif
+
+#ifndef AVD_ARENA_SCRATCH_BLOCK_SIZE
+#define AVD_ARENA_SCRATCH_BLOCK_SIZE (1024 * 1024)
+#endif
+
+#define AVD_ARENA_DEFAULT_ALIGNMENT 16
+#define AVD_ARENA_SCRATCH_COUNT     2
+
+typedef struct AVD_ArenaBlock {
+    struct AVD_ArenaBlock *next;
+    AVD_Size capacity;
+    AVD_Size used;
+} AVD_ArenaBlock;
+
+// Linear allocator, individual allocations are never freed, instead the whole
+// arena is reset (or rolled back to a marker). Blocks are kept across resets so
+// an arena in steady state does not touch the system allocator at all.
+typedef struct {
+    AVD_ArenaBlock *first;
+    AVD_ArenaBlock *current;
+    AVD_Size blockSize;
+
+    AVD_Size blockCount;
+    AVD_Size reservedSize;
+    AVD_Size allocationCount;
+} AVD_Arena;
+
+typedef struct {
+    AVD_ArenaBlock *block;
+    AVD_Size used;
+} AVD_ArenaMarker;
+
+typedef struct {
+    AVD_Arena *arena;
+    AVD_ArenaMarker marker;
+} AVD_ArenaScratch;
+
+bool avdArenaCreate(AVD_Arena *arena, AVD_Size blockSize);
+void avdArenaDestroy(AVD_Arena *arena);
+
+void *avdArenaAlloc(AVD_Arena *arena, AVD_Size size, AVD_Size alignment);
+void *avdArenaAllocZeroed(AVD_Arena *arena, AVD_Size size, AVD_Size alignment);
+char *avdArenaPrintf(AVD_Arena *arena, const char *format, ...);
+
+AVD_ArenaMarker avdArenaGetMarker(const AVD_Arena *arena);
+void avdArenaResetToMarker(AVD_Arena *arena, AVD_ArenaMarker marker);
+void avdArenaReset(AVD_Arena *arena);
+AVD_Size avdArenaUsedSize(const AVD_Arena *arena);
+
+#define AVD_ARENA_PUSH_ARRAY(arena, type, count)        ((type *)avdArenaAlloc((arena), sizeof(type) * (count), _Alignof(type)))
+#define AVD_ARENA_PUSH_ARRAY_ZEROED(arena, type, count) ((type *)avdArenaAllocZeroed((arena), sizeof(type) * (count), _Alignof(type)))
+
+// Per-frame arena, only to be used from the main thread. Everything allocated
+// from it is released when avdApplicationUpdate starts the next frame.
+bool avdArenaFrameInit(void);
+void avdArenaFrameShutdown(void);
+void avdArenaFrameReset(void);
+AVD_Arena *avdArenaFrame(void);
+
+// Thread local scratch arenas for temporaries, every Begin must be paired with
+// an End in LIFO order. Pass the arena the caller is allocating results from as
+// conflict (or NULL) so that a nested scratch does not roll back the results.
+// Threads other than the main thread must call avdArenaScratchThreadShutdown
+// before exiting if they used scratch memory.
+AVD_ArenaScratch avdArenaScratchBegin(AVD_Arena *conflict);
+void avdArenaScratchEnd(AVD_ArenaScratch scratch);
+void avdArenaScratchThreadShutdown(void);
+
+bool avdArenaTestsRun(void);
+bool avdArenaBenchmarksRun(struct AVD_Bench *bench);
+
+#endif // AVD_ARENA_H
@@ -0,0 +1,121 @@
+#ifndef AVD_ATOMIC_H
+#define AVD_ATOMIC_H
+
+#include "core/avd_base.h"
+
+// Sequentially consistent atomics on plain integers and pointers. C11 <stdatomic.h>
+// is not reliably available with MSVC, so these map to the Interlocked intrinsics
+// there and to the __atomic builtins everywhere else.
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+
+static inline AVD_Int64 avdAtomicLoad64(volatile AVD_Int64 *ptr)
+{
+    return _InterlockedOr64((volatile __int64 *)ptr, 0);
+}
+
+static inline void avdAtomicStore64(volatile AVD_Int64 *ptr, AVD_Int64 value)
+{
+    _InterlockedExchange64((volatile __int64 *)ptr, value);
+}
+
+// returns the value after the addition
+static inline AVD_Int64 avdAtomicAdd64(volatile AVD_Int64 *ptr, AVD_Int64 delta)
+{
+    return _InterlockedExchangeAdd64((volatile __int64 *)ptr, delta) + delta;
+}
+
+static inline AVD_Int64 avdAtomicExchange64(volatile AVD_Int64 *ptr, AVD_Int64 value)
+{
+    return _InterlockedExchange64((volatile __int64 *)ptr, value);
+}
+
+// on failure expected is updated with the current value
+static inline bool avdAtomicCompareExchange64(volatile AVD_Int64 *ptr, AVD_Int64 *expected, AVD_Int64 desired)
+{
+    AVD_Int64 previous = _InterlockedCompareExchange64((volatile __int64 *)ptr, desired, *expected);
+    if (previous == *expected) {
+        return true;
+    }
+    *expected = previous;
+    return false;
+}
+
+static inline void *avdAtomicLoadPtr(void *volatile *ptr)
+{
+    return _InterlockedCompareExchangePointer(ptr, NULL, NULL);
+}
+
+static inline void avdAtomicStorePtr(void *volatile *ptr, void *value)
+{
+    _InterlockedExchangePointer(ptr, value);
+}
+
+static inline bool avdAtomicCompareExchangePtr(void *volatile *ptr, void **expected, void *desired)
+{
+    void *previous = _InterlockedCompareExchangePointer(ptr, desired, *expected);
+    if (previous == *expected) {
+        return true;
+    }
+    *expected = previous;
+    return false;
+}
+
+#define AVD_CPU_PAUSE() _mm_pause()
+
+#else
+
+static inline AVD_Int64 avdAtomicLoad64(volatile AVD_Int64 *ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+}
+
+static inline void avdAtomicStore64(volatile AVD_Int64 *ptr, AVD_Int64 value)
+{
+    __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+// returns the value after the addition
+static inline AVD_Int64 avdAtomicAdd64(volatile AVD_Int64 *ptr, AVD_Int64 delta)
+{
+    return __atomic_add_fetch(ptr, delta, __ATOMIC_SEQ_CST);
+}
+
+static inline AVD_Int64 avdAtomicExchange64(volatile AVD_Int64 *ptr, AVD_Int64 value)
+{
+    return __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+// on failure expected is updated with the current value
+static inline bool avdAtomicCompareExchange64(volatile AVD_Int64 *ptr, AVD_Int64 *expected, AVD_Int64 desired)
+{
+    return __atomic_compare_exchange_n(ptr, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static inline void *avdAtomicLoadPtr(void *volatile *ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+}
+
+static inline void avdAtomicStorePtr(void *volatile *ptr, void *value)
+{
+    __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+static inline bool avdAtomicCompareExchangePtr(void *volatile *ptr, void **expected, void *desired)
+{
+    return __atomic_compare_exchange_n(ptr, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AVD_CPU_PAUSE() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define AVD_CPU_PAUSE() __asm__ __volatile__("yield")
+#else
+#define AVD_CPU_PAUSE() ((void)0)
+#endif
+
+#endif
+
+#endif // AVD_ATOMIC_H
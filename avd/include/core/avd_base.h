@@ -25,6 +25,8 @@
 #include <windows.h>
 #endif
 
+#include "core/avd_log.h"
+#include "core/avd_memory.h"
 #include "core/avd_types.h"
 
 #include "pico/picoLog.h"
@@ -47,11 +49,15 @@
     {                                                                                                \
         if (!(condition)) {                                                                          \
             AVD_LOG_ERROR("Assertion failed: %s, file %s, line %d", #condition, __FILE__, __LINE__); \
+            avdLogFlush();                                                                           \
             assert(condition);                                                                       \
         }                                                                                            \
     }
 
-#if defined(_WIN32) || defined(_WIN64)
+#ifdef AVD_MEMORY_TRACKING
+#define AVD_ALIGNED_ALLOC(alignment, size) avdMemoryTrackedAlloc(size, alignment, AVD_MEMORY_TAG_AUTO, __FILE__, __LINE__)
+#define AVD_ALIGNED_FREE(ptr)              avdMemoryTrackedFree(ptr, __FILE__, __LINE__)
+#elif defined(_WIN32) || defined(_WIN64)
 #include <malloc.h>
 #define AVD_ALIGNED_ALLOC(alignment, size) _aligned_malloc(size, alignment)
 #define AVD_ALIGNED_FREE(ptr)              _aligned_free(ptr)
@@ -60,10 +66,27 @@
 #define AVD_ALIGNED_FREE(ptr)              free(ptr)
 #endif
 
-#define AVD_MALLOC(size) malloc(size)
+#if defined(_MSC_VER)
+#define AVD_THREAD_LOCAL __declspec(thread)
+#else
+#define AVD_THREAD_LOCAL _Thread_local
+#endif
+
+#ifdef AVD_MEMORY_TRACKING
+#define AVD_MALLOC(size)          avdMemoryTrackedAlloc(size, AVD_MEMORY_DEFAULT_ALIGNMENT, AVD_MEMORY_TAG_AUTO, __FILE__, __LINE__)
+#define AVD_CALLOC(count, size)   avdMemoryTrackedCalloc(count, size, AVD_MEMORY_TAG_AUTO, __FILE__, __LINE__)
+#define AVD_REALLOC(ptr, size)    avdMemoryTrackedRealloc(ptr, size, AVD_MEMORY_TAG_AUTO, __FILE__, __LINE__)
+#define PRIV_AVD_MEMORY_FREE(ptr) avdMemoryTrackedFree(ptr, __FILE__, __LINE__)
+#else
+#define AVD_MALLOC(size)          malloc(size)
+#define AVD_CALLOC(count, size)   calloc(count, size)
+#define AVD_REALLOC(ptr, size)    realloc(ptr, size)
+#define PRIV_AVD_MEMORY_FREE(ptr) free(ptr)
+#endif
+
 #define AVD_FREE(ptr)                                                                  \
     if (ptr != NULL) {                                                                 \
-        free(ptr);                                                                     \
+        PRIV_AVD_MEMORY_FREE(ptr);                                                     \
         ptr = NULL;                                                                    \
     } else {                                                                           \
         AVD_LOG_WARN("Attempted to free a NULL pointer at %s:%d", __FILE__, __LINE__); \
@@ -85,17 +108,27 @@
         }                                                                                                          \
     } while (0)
 
-#define AVD_LOG_INIT()            PICO_LOG_INIT()
-#define AVD_LOG_SHUTDOWN()        PICO_LOG_SHUTDOWN()
-#define AVD_LOG_DEBUG(msg, ...)   PICO_DEBUG(msg, ##__VA_ARGS__)
-#define AVD_LOG_VERBOSE(msg, ...) PICO_VERBOSE(msg, ##__VA_ARGS__)
-#define AVD_LOG_INFO(msg, ...)    PICO_INFO(msg, ##__VA_ARGS__)
-#define AVD_LOG_WARN(msg, ...)    PICO_WARN(msg, ##__VA_ARGS__)
-#define AVD_LOG_ERROR(msg, ...)   PICO_ERROR(msg, ##__VA_ARGS__)
-
-#define __AVD_LOG_DEBOUNCED(intervalMs, logFunc, msg, ...)                                         \
-    AVD_EXECUTE_DEBOUNCED(intervalMs, {                                                            \
-        logFunc("[Debounced] " msg " (skipped %d calls)", ##__VA_ARGS__, PRIV_avdNumSkippedCalls); \
+// The messages go through the asynchronous backend in core/avd_log.h once
+// AVD_LOG_INIT has started it, picoLog only does the final output.
+#define AVD_LOG_INIT()   \
+    do {                 \
+        PICO_LOG_INIT(); \
+        avdLogInit();    \
+    } while (0)
+#define AVD_LOG_SHUTDOWN()   \
+    do {                     \
+        avdLogShutdown();    \
+        PICO_LOG_SHUTDOWN(); \
+    } while (0)
+#define AVD_LOG_DEBUG(msg, ...)   PRIV_AVD_LOG(AVD_LOG_LEVEL_DEBUG, msg, ##__VA_ARGS__)
+#define AVD_LOG_VERBOSE(msg, ...) PRIV_AVD_LOG(AVD_LOG_LEVEL_VERBOSE, msg, ##__VA_ARGS__)
+#define AVD_LOG_INFO(msg, ...)    PRIV_AVD_LOG(AVD_LOG_LEVEL_INFO, msg, ##__VA_ARGS__)
+#define AVD_LOG_WARN(msg, ...)    PRIV_AVD_LOG(AVD_LOG_LEVEL_WARN, msg, ##__VA_ARGS__)
+#define AVD_LOG_ERROR(msg, ...)   PRIV_AVD_LOG(AVD_LOG_LEVEL_ERROR, msg, ##__VA_ARGS__)
+
+#define __AVD_LOG_DEBOUNCED(intervalMs, logFunc, msg, ...)                                          \
+    AVD_EXECUTE_DEBOUNCED(intervalMs, {                                                             \
+        logFunc("[Debounced] " msg " (skipped %zu calls)", ##__VA_ARGS__, PRIV_avdNumSkippedCalls); \
     })
 
 #define AVD_LOG_DEBUG_DEBOUNCED(intervalMs, msg, ...) \
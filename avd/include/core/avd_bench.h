@@ -0,0 +1,88 @@
+#ifndef AVD_BENCH_H
+#define AVD_BENCH_H
+
+#include "core/avd_base.h"
+#include "core/avd_list.h"
+
+#ifndef AVD_BENCH_DEFAULT_WARMUP
+#define AVD_BENCH_DEFAULT_WARMUP 2
+#endif
+
+#ifndef AVD_BENCH_DEFAULT_REPETITIONS
+#define AVD_BENCH_DEFAULT_REPETITIONS 10
+#endif
+
+// Relative slowdown of the median against the baseline that counts as a regression.
+#ifndef AVD_BENCH_DEFAULT_TOLERANCE
+#define AVD_BENCH_DEFAULT_TOLERANCE 0.10
+#endif
+
+#define AVD_BENCH_MAX_REPETITIONS 1024
+#define AVD_BENCH_NAME_LENGTH     96
+
+typedef bool(AVD_BenchSetupFn)(void *userData);
+typedef void(AVD_BenchRunFn)(void *userData);
+
+// A single measured case. setup runs untimed before every repetition (including
+// warmup) so cases that consume their input, like removals, can refill it.
+typedef struct {
+    const char *name;
+    const char *unit; // what itemsPerRepetition counts, e.g. "ops" or "bytes"
+    AVD_Size itemsPerRepetition;
+
+    AVD_BenchSetupFn *setup;
+    AVD_BenchRunFn *run;
+    void *userData;
+} AVD_BenchCase;
+
+typedef struct {
+    char name[AVD_BENCH_NAME_LENGTH];
+    char unit[16];
+    AVD_Size itemsPerRepetition;
+    AVD_UInt32 repetitions;
+
+    AVD_Double minMs;
+    AVD_Double meanMs;
+    AVD_Double p50Ms;
+    AVD_Double p90Ms;
+    AVD_Double p99Ms;
+    AVD_Double maxMs;
+
+    // items per second at the median
+    AVD_Double throughput;
+} AVD_BenchResult;
+
+typedef struct {
+    AVD_UInt32 warmup;
+    AVD_UInt32 repetitions;
+    const char *filter; // only cases whose name contains this substring are run, NULL runs all
+} AVD_BenchConfig;
+
+typedef struct AVD_Bench {
+    AVD_BenchConfig config;
+    AVD_List results;
+} AVD_Bench;
+
+void avdBenchConfigDefault(AVD_BenchConfig *config);
+
+bool avdBenchCreate(AVD_Bench *bench, const AVD_BenchConfig *config);
+void avdBenchDestroy(AVD_Bench *bench);
+
+// Returns false only if the case could not be measured, a case skipped by the
+// filter counts as success.
+bool avdBenchRun(AVD_Bench *bench, const AVD_BenchCase *benchCase);
+// Whether avdBenchRun would measure a case of that name, lets suites skip
+// expensive setup for cases the filter excludes.
+bool avdBenchIsSelected(const AVD_Bench *bench, const char *name);
+
+bool avdBenchWriteJson(const AVD_Bench *bench, const char *path);
+// Compares the medians against a report previously written by avdBenchWriteJson,
+// cases missing from the baseline are ignored.
+bool avdBenchCompare(const AVD_Bench *bench, const char *baselinePath, AVD_Double tolerance, AVD_Size *outRegressionCount);
+
+// Linear interpolation between the closest ranks, sortedSamples must be ascending.
+AVD_Double avdBenchPercentile(const AVD_Double *sortedSamples, AVD_Size count, AVD_Double percentile);
+
+bool avdBenchTestsRun(void);
+
+#endif // AVD_BENCH_H
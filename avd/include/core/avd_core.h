@@ -2,11 +2,23 @@
 #define AVD_CORE_H
 
 #include "core/avd_base.h"
+#include "core/avd_arena.h"
+#include "core/avd_atomic.h"
+#include "core/avd_bench.h"
+#include "core/avd_hash.h"
 #include "core/avd_hashtable.h"
 #include "core/avd_input.h"
+#include "core/avd_jobs.h"
 #include "core/avd_list.h"
+#include "core/avd_log.h"
+#include "core/avd_memory.h"
+#include "core/avd_profiler.h"
 #include "core/avd_types.h"
 #include "core/avd_utils.h"
+
+// headless builds (avd_tests, avd_bench) do not have GLFW available
+#ifndef AVD_HEADLESS
 #include "core/avd_window.h"
+#endif
 
 #endif // AVD_CORE_H
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef AVD_HASH_H
+#define AVD_HASH_H
+
+#include "core/avd_base.h"
+
+struct AVD_Bench;
+
+// Inputs are consumed in 64 byte stripes spread over 8 independent 64 bit lanes,
+// the lanes map directly onto SSE2/AVX2/NEON registers when available and the
+// scalar path produces bit identical results, so hashes can be persisted to disk.
+#define AVD_HASH_STRIPE_SIZE       64
+#define AVD_HASH_LANE_COUNT        8
+#define AVD_HASH_STRIPES_PER_BLOCK 16
+
+#define AVD_HASH_DEFAULT_SEED 0ull
+
+typedef struct {
+    AVD_UInt64 low;
+    AVD_UInt64 high;
+} AVD_Hash128;
+
+typedef struct {
+    AVD_UInt64 accumulators[AVD_HASH_LANE_COUNT];
+    AVD_UInt64 seed;
+    AVD_UInt64 totalSize;
+    AVD_UInt32 stripesInBlock;
+    AVD_UInt32 bufferSize;
+    AVD_UInt8 buffer[AVD_HASH_STRIPE_SIZE];
+} AVD_HashState;
+
+AVD_UInt64 avdHash64(const void *data, AVD_Size size, AVD_UInt64 seed);
+AVD_UInt64 avdHash64String(const char *str);
+AVD_Hash128 avdHash128(const void *data, AVD_Size size, AVD_UInt64 seed);
+AVD_UInt64 avdHash64Combine(AVD_UInt64 a, AVD_UInt64 b);
+
+// Incremental hashing, feeding the same bytes in any number of pieces gives the same result as avdHash64.
+void avdHashStateInit(AVD_HashState *state, AVD_UInt64 seed);
+void avdHashStateUpdate(AVD_HashState *state, const void *data, AVD_Size size);
+AVD_UInt64 avdHashStateDigest(const AVD_HashState *state);
+AVD_Hash128 avdHashStateDigest128(const AVD_HashState *state);
+
+// Name of the stripe accumulator in use ("avx2", "sse2", "neon" or "scalar").
+const char *avdHashBackendName(void);
+// Forces the scalar stripe accumulator, only meant for cross checking the SIMD paths.
+void avdHashSetSimdEnabled(bool enabled);
+
+bool avdHashTestsRun(void);
+bool avdHashBenchmarksRun(struct AVD_Bench *bench);
+
+#endif // AVD_HASH_H
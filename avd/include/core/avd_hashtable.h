@@ -3,35 +3,61 @@
 
 #include "avd_core.h"
 
+struct AVD_Bench;
+
+// Number of entries (key + value) allocated together in one storage bank.
 #ifndef AVD_HASHTABLE_BANK_CAPACITY
-#define AVD_HASHTABLE_BANK_CAPACITY 64
+#define AVD_HASHTABLE_BANK_CAPACITY 256
+#endif
+
+// Keys up to this size are stored inside the entry, longer keys are allocated out of line.
+#ifndef AVD_HASHTABLE_INLINE_KEY_SIZE
+#define AVD_HASHTABLE_INLINE_KEY_SIZE 24
 #endif
 
-#ifndef AVD_HASHTABLE_KEY_MAX_SIZE
-#define AVD_HASHTABLE_KEY_MAX_SIZE 256
+#ifndef AVD_HASHTABLE_INITIAL_SLOT_COUNT
+#define AVD_HASHTABLE_INITIAL_SLOT_COUNT 16
 #endif
 
-#ifndef AVD_HASHTABLE_SIZE
-#define AVD_HASHTABLE_SIZE 1024 * 16
+// The slot array is doubled once count exceeds this percentage of the slot count.
+#ifndef AVD_HASHTABLE_MAX_LOAD_PERCENT
+#define AVD_HASHTABLE_MAX_LOAD_PERCENT 85
 #endif
 
-typedef struct AVD_HashTableEntry {
-    void *value;
-    char key[AVD_HASHTABLE_KEY_MAX_SIZE];
-    struct AVD_HashTableEntry *next;
+#define AVD_HASHTABLE_INVALID_INDEX UINT32_MAX
+#define AVD_HASHTABLE_MAX_CAPACITY  (UINT32_MAX / 2)
+
+typedef struct {
+    union {
+        char inlineKey[AVD_HASHTABLE_INLINE_KEY_SIZE];
+        char *externalKey;
+    };
+    AVD_UInt32 keySize;
+    AVD_UInt32 nextFree;
 } AVD_HashTableEntry;
 
 typedef struct {
-    void *dataHolder;
     AVD_HashTableEntry *entries;
-    size_t bankCount;
+    AVD_UInt8 *values;
 } AVD_HashTableBank;
 
+// Robin Hood slot: the stored hash is used both for fast rejection and for
+// computing the probe distance while inserting, removing and rehashing.
+typedef struct {
+    AVD_UInt32 hash;
+    AVD_UInt32 entryIndex;
+} AVD_HashTableSlot;
+
 typedef struct {
+    AVD_HashTableSlot *slots;
+    size_t slotCount;
+
+    // entries live in fixed size banks so that value and key pointers stay
+    // stable while the slot array is rehashed or more banks are added
     AVD_HashTableBank *banks;
     size_t bankCount;
-
-    AVD_HashTableEntry **table;
+    size_t entryCount;
+    AVD_UInt32 freeList;
 
     size_t count;
     size_t keySize;
@@ -50,5 +76,6 @@ bool avdHashTableCount(const AVD_HashTable *table, size_t *outCount);
 bool avdHashTableGetKeys(const AVD_HashTable *table, void **outKeys, size_t *outKeyCount, size_t maxKeys);
 
 bool avdHashTableTestsRun(void);
+bool avdHashTableBenchmarksRun(struct AVD_Bench *bench);
 
-#endif // AVD_HASHTABLE_H
\ No newline at end of file
+#endif // AVD_HASHTABLE_H
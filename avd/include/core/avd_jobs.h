@@ -0,0 +1,64 @@
+#ifndef AVD_JOBS_H
+#define AVD_JOBS_H
+
+#include "core/avd_base.h"
+
+struct AVD_Bench;
+
+#define AVD_JOBS_MAX_WORKERS 64
+
+// Capacity of every per-thread queue, jobs that do not fit are run inline by the submitter.
+#ifndef AVD_JOBS_QUEUE_CAPACITY
+#define AVD_JOBS_QUEUE_CAPACITY 4096
+#endif
+
+// Failed attempts to find work before an idle worker goes to sleep.
+#ifndef AVD_JOBS_SPIN_COUNT
+#define AVD_JOBS_SPIN_COUNT 256
+#endif
+
+typedef void(AVD_JobFn)(void *userData);
+typedef void(AVD_JobRangeFn)(AVD_Size begin, AVD_Size end, void *userData);
+
+typedef struct {
+    AVD_JobFn *function;
+    void *userData;
+} AVD_Job;
+
+// Counts the jobs that still have to finish. Zero initialize before use and
+// keep it alive until it has been waited on, a counter may be reused once it
+// has reached zero.
+typedef struct AVD_JobCounter {
+    volatile AVD_Int64 pending;
+    struct AVD_JobContinuation *continuations;
+} AVD_JobCounter;
+
+// Work-stealing job system shared by the whole application. Every worker owns
+// a queue it pushes to and pops from the back of, idle threads steal from the
+// front of the others. The thread that calls avdJobsInit gets a queue too and
+// helps execute jobs while it waits. workerCount 0 picks one worker per core
+// besides the calling thread.
+bool avdJobsInit(AVD_UInt32 workerCount);
+// Runs everything still queued before the workers are joined.
+void avdJobsShutdown(void);
+bool avdJobsIsInitialized(void);
+AVD_UInt32 avdJobsWorkerCount(void);
+AVD_UInt32 avdJobsHardwareThreadCount(void);
+
+// Queues the jobs and adds them to counter (which may be NULL). Without an
+// initialized job system the jobs run inline before this returns.
+void avdJobsRun(const AVD_Job *jobs, AVD_Size count, AVD_JobCounter *counter);
+// Same as avdJobsRun but the jobs are only queued once dependency reaches zero.
+void avdJobsRunAfter(AVD_JobCounter *dependency, const AVD_Job *jobs, AVD_Size count, AVD_JobCounter *counter);
+// Executes queued jobs on the calling thread until counter reaches zero.
+void avdJobsWait(AVD_JobCounter *counter);
+bool avdJobCounterIsDone(AVD_JobCounter *counter);
+
+// Splits [0, count) into ranges of grainSize indices and blocks until all of
+// them ran. grainSize 0 picks a few ranges per thread.
+void avdJobsParallelFor(AVD_Size count, AVD_Size grainSize, AVD_JobRangeFn *function, void *userData);
+
+bool avdJobsTestsRun(void);
+bool avdJobsBenchmarksRun(struct AVD_Bench *bench);
+
+#endif // AVD_JOBS_H
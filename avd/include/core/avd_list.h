@@ -3,6 +3,8 @@
 
 #include "core/avd_base.h"
 
+struct AVD_Bench;
+
 #ifndef AVD_LIST_INITIAL_CAPACITY
 #define AVD_LIST_INITIAL_CAPACITY 8
 #endif
@@ -13,16 +15,27 @@
 
 typedef void(AVD_ListDestructor)(void *item, void *context);
 
+typedef enum {
+    // items are laid out contiguously from items[0], safe to hand list->items to APIs expecting a flat array
+    AVD_LIST_STORAGE_CONTIGUOUS = 0,
+    // items form a ring starting at items[head], push/pop at both ends are O(1) but list->items
+    // must not be treated as a flat array, use avdListGet or avdListTighten first
+    AVD_LIST_STORAGE_RING,
+} AVD_ListStorage;
+
 typedef struct {
     size_t itemSize;
     size_t capacity;
     size_t count;
+    size_t head;
     void *items;
+    AVD_ListStorage storage;
     AVD_ListDestructor *destructor;
     void *destructorContext;
 } AVD_List;
 
 void avdListCreate(AVD_List *list, size_t itemSize);
+void avdListCreateWithStorage(AVD_List *list, size_t itemSize, AVD_ListStorage storage);
 void avdListSetDestructor(AVD_List *list, AVD_ListDestructor *destructor, void *context);
 void avdListDestroy(AVD_List *list);
 void *avdListPushBack(AVD_List *list, const void *item);
@@ -45,8 +58,10 @@ void avdListRemove(AVD_List *list, size_t index);
 void avdListInsert(AVD_List *list, size_t index, const void *item);
 void avdListSort(AVD_List *list, int (*compare)(const void *, const void *));
 bool avdListIsEmpty(const AVD_List *list);
+// NOTE: For ring lists this also linearizes the items so that list->items can be used as a flat array.
 bool avdListTighten(AVD_List *list);
 
 bool avdListTestsRun(void);
+bool avdListBenchmarksRun(struct AVD_Bench *bench);
 
 #endif
@@ -0,0 +1,103 @@
+#ifndef AVD_LOG_H
+#define AVD_LOG_H
+
+#include "core/avd_types.h"
+
+struct AVD_Bench;
+
+// Records each thread can queue before further messages are dropped.
+#ifndef AVD_LOG_RECORDS_PER_THREAD
+#define AVD_LOG_RECORDS_PER_THREAD 1024
+#endif
+
+// How long the logger thread sleeps when nobody asks it to flush.
+#ifndef AVD_LOG_FLUSH_INTERVAL_MS
+#define AVD_LOG_FLUSH_INTERVAL_MS 10
+#endif
+
+#define AVD_LOG_RECORD_SIZE          256
+#define AVD_LOG_MAX_MESSAGE_SIZE     1024
+#define AVD_LOG_MAX_RECORDS_PER_PASS 4096
+
+typedef enum {
+    AVD_LOG_LEVEL_VERBOSE = 0,
+    AVD_LOG_LEVEL_DEBUG,
+    AVD_LOG_LEVEL_INFO,
+    AVD_LOG_LEVEL_WARN,
+    AVD_LOG_LEVEL_ERROR,
+    AVD_LOG_LEVEL_NONE,
+} AVD_LogLevel;
+
+// Like the memory tags the module is the directory of the logging source file,
+// so code does not have to pass it around.
+typedef enum {
+    AVD_LOG_MODULE_GENERAL = 0,
+    AVD_LOG_MODULE_CORE,
+    AVD_LOG_MODULE_VULKAN,
+    AVD_LOG_MODULE_SCENES,
+    AVD_LOG_MODULE_HLS,
+    AVD_LOG_MODULE_VIDEO,
+    AVD_LOG_MODULE_AUDIO,
+    AVD_LOG_MODULE_MODEL,
+    AVD_LOG_MODULE_FONT,
+    AVD_LOG_MODULE_SHADER,
+    AVD_LOG_MODULE_COUNT
+} AVD_LogModule;
+
+// Receives every message that passed the filter, fully formatted and without a
+// trailing newline. Called from the logger thread, or from the logging thread
+// itself in synchronous mode, but never from two threads at once.
+typedef void(AVD_LogSinkFn)(AVD_LogLevel level, AVD_LogModule module, const char *message, void *userData);
+
+// Starts the background logger. Until then, and after avdLogShutdown, messages
+// are formatted and written synchronously on the calling thread.
+//
+// Once running, AVD_LOG_* only copies the format string pointer and the raw
+// arguments into a fixed-size record in a ring buffer owned by the calling
+// thread, formatting and writing happens on the logger thread. Format strings
+// must therefore be string literals (the macros enforce that), %s arguments are
+// copied. A full ring drops the message and counts it instead of blocking.
+// Errors and messages too big for a record flush the queue and are written on
+// the calling thread.
+bool avdLogInit(void);
+// Flushes everything queued. Other threads must have stopped logging.
+void avdLogShutdown(void);
+bool avdLogIsInitialized(void);
+
+// Blocks until every message queued before the call has reached the sink.
+void avdLogFlush(void);
+// Hands the ring buffer of the calling thread to the next thread that logs.
+void avdLogThreadShutdown(void);
+
+// Messages below the level are discarded before any of their arguments are
+// evaluated. Both default to AVD_LOG_LEVEL_VERBOSE.
+void avdLogSetLevel(AVD_LogLevel level);
+void avdLogSetModuleLevel(AVD_LogModule module, AVD_LogLevel level);
+AVD_LogLevel avdLogGetModuleLevel(AVD_LogModule module);
+// Comma separated list of level or module=level, e.g. "info,hls=warn,video=debug".
+// avdLogInit applies the AVD_LOG_LEVELS environment variable with it.
+bool avdLogSetLevelsFromString(const char *levels);
+
+// Formats and writes on the calling thread even while the logger runs, useful
+// when chasing a crash. Flushes what was queued before switching.
+void avdLogSetSynchronous(bool synchronous);
+// NULL restores the default sink, which forwards to picoLog.
+void avdLogSetSink(AVD_LogSinkFn *sink, void *userData);
+void avdLogDefaultSink(AVD_LogLevel level, AVD_LogModule module, const char *message, void *userData);
+AVD_UInt64 avdLogDroppedCount(void);
+
+const char *avdLogLevelName(AVD_LogLevel level);
+const char *avdLogModuleName(AVD_LogModule module);
+AVD_LogModule avdLogModuleFromFile(const char *file);
+
+bool avdLogIsEnabled(AVD_LogLevel level, const char *file);
+void avdLogWrite(AVD_LogLevel level, const char *file, const char *format, ...);
+
+bool avdLogTestsRun(void);
+bool avdLogBenchmarksRun(struct AVD_Bench *bench);
+
+// The "" forces the format to be a literal, the logger thread reads it later.
+#define PRIV_AVD_LOG(level, msg, ...) \
+    (avdLogIsEnabled(level, __FILE__) ? avdLogWrite(level, __FILE__, "" msg, ##__VA_ARGS__) : (void)0)
+
+#endif // AVD_LOG_H
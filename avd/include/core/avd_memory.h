@@ -0,0 +1,66 @@
+#ifndef AVD_MEMORY_H
+#define AVD_MEMORY_H
+
+#include <stddef.h>
+
+#include "core/avd_types.h"
+
+// CPU memory accounting, only active when AVD_MEMORY_TRACKING is defined
+// (see the AVD_ENABLE_MEMORY_TRACKING CMake option). Without it the AVD_MALLOC
+// family of macros in avd_base.h go straight to libc and nothing here is on
+// any allocation path.
+
+#define AVD_MEMORY_DEFAULT_ALIGNMENT      16
+#define AVD_MEMORY_HISTOGRAM_BUCKET_COUNT 24
+
+typedef enum {
+    AVD_MEMORY_TAG_GENERAL = 0,
+    AVD_MEMORY_TAG_CORE,
+    AVD_MEMORY_TAG_HLS,
+    AVD_MEMORY_TAG_VIDEO,
+    AVD_MEMORY_TAG_MODEL,
+    AVD_MEMORY_TAG_FONT,
+    AVD_MEMORY_TAG_AUDIO,
+    AVD_MEMORY_TAG_SHADER,
+    AVD_MEMORY_TAG_COUNT
+} AVD_MemoryTag;
+
+// Resolve the tag from the directory of the allocating source file. Allocations
+// made from core or uncategorised code are charged to the tag of the calling
+// thread instead (see avdMemorySetThreadTag).
+#define AVD_MEMORY_TAG_AUTO AVD_MEMORY_TAG_COUNT
+
+typedef struct {
+    AVD_Size liveBytes;
+    AVD_Size peakBytes;
+    AVD_Size liveAllocations;
+    AVD_Size totalAllocations;
+    AVD_Size totalFrees;
+    AVD_Size totalAllocatedBytes;
+
+    // bucket i counts allocations of (2^(i-1), 2^i] bytes, the last one everything above
+    AVD_Size histogram[AVD_MEMORY_HISTOGRAM_BUCKET_COUNT];
+} AVD_MemoryStats;
+
+void *avdMemoryTrackedAlloc(AVD_Size size, AVD_Size alignment, AVD_MemoryTag tag, const char *file, int line);
+void *avdMemoryTrackedCalloc(AVD_Size count, AVD_Size size, AVD_MemoryTag tag, const char *file, int line);
+void *avdMemoryTrackedRealloc(void *ptr, AVD_Size size, AVD_MemoryTag tag, const char *file, int line);
+void avdMemoryTrackedFree(void *ptr, const char *file, int line);
+
+bool avdMemoryTrackingEnabled(void);
+const char *avdMemoryTagName(AVD_MemoryTag tag);
+
+// Charges core allocations made by the calling thread to the given subsystem,
+// returns the previous tag so that callers can restore it.
+AVD_MemoryTag avdMemorySetThreadTag(AVD_MemoryTag tag);
+
+// Pass AVD_MEMORY_TAG_COUNT to get the totals over all subsystems.
+bool avdMemoryGetStats(AVD_MemoryTag tag, AVD_MemoryStats *outStats);
+
+// Logs every allocation that is still alive and returns how many there are.
+AVD_Size avdMemoryReportLeaks(void);
+bool avdMemoryWriteReport(const char *path);
+
+bool avdMemoryTestsRun(void);
+
+#endif // AVD_MEMORY_H
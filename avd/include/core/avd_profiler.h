@@ -0,0 +1,88 @@
+#ifndef AVD_PROFILER_H
+#define AVD_PROFILER_H
+
+#include "core/avd_base.h"
+
+// Completed zones kept per thread, older ones are overwritten.
+#ifndef AVD_PROFILER_EVENTS_PER_THREAD
+#define AVD_PROFILER_EVENTS_PER_THREAD (16 * 1024)
+#endif
+
+#ifndef AVD_PROFILER_MAX_FRAMES
+#define AVD_PROFILER_MAX_FRAMES 256
+#endif
+
+#define AVD_PROFILER_MAX_DEPTH        32
+#define AVD_PROFILER_THREAD_NAME_SIZE 32
+
+// Zone names must outlive the profiler, string literals are the intended use.
+typedef struct {
+    const char *name;
+    AVD_Double beginUs; // since avdProfilerInit
+    AVD_Double endUs;
+    AVD_UInt32 depth;
+} AVD_ProfilerEvent;
+
+typedef struct {
+    const char *name;
+    AVD_Double totalMs;
+    AVD_Double maxMs;
+    AVD_UInt32 callCount;
+} AVD_ProfilerZoneStats;
+
+// Zones are recorded into per-thread ring buffers that only their own thread
+// writes to, so recording never takes a lock. Reading them (the overlay, the
+// trace export) is meant for the main thread, events that get overwritten while
+// they are read are dropped.
+bool avdProfilerInit(void);
+// All threads that recorded zones must have stopped.
+void avdProfilerShutdown(void);
+bool avdProfilerIsInitialized(void);
+
+void avdProfilerBeginZone(const char *name);
+void avdProfilerEndZone(void);
+// Marks the start of a new frame, any zone the calling thread left open is closed.
+void avdProfilerFrameMark(void);
+void avdProfilerSetThreadName(const char *format, ...);
+// Hands the buffer of the calling thread to the next thread that starts profiling.
+void avdProfilerThreadShutdown(void);
+
+// Zones of all threads that ended during the last complete frame, the most expensive first.
+AVD_Size avdProfilerGetLastFrameZones(AVD_ProfilerZoneStats *outZones, AVD_Size maxCount, AVD_Double *outFrameMs);
+AVD_Size avdProfilerFormatLastFrame(char *buffer, AVD_Size bufferSize, AVD_Size maxZones);
+// Chrome trace event format, open with chrome://tracing or ui.perfetto.dev.
+bool avdProfilerWriteChromeTrace(const char *path);
+
+bool avdProfilerTestsRun(void);
+
+// The macros compile to nothing unless the build defines AVD_PROFILER
+// (AVD_ENABLE_PROFILER in CMake). AVD_PROFILE_SCOPE wraps the block following
+// it, leaving that block with return, break, continue or goto skips the end of
+// the zone, use AVD_PROFILE_BEGIN/END around code like that instead.
+//
+//   AVD_PROFILE_SCOPE("Scene/Update") {
+//       updated = avdSceneUpdate(...);
+//   }
+#define PRIV_AVD_PROFILE_CONCAT_INNER(a, b) a##b
+#define PRIV_AVD_PROFILE_CONCAT(a, b)       PRIV_AVD_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef AVD_PROFILER
+#define AVD_PROFILE_BEGIN(name) avdProfilerBeginZone(name)
+#define AVD_PROFILE_END()       avdProfilerEndZone()
+#define AVD_PROFILE_SCOPE(name)                                                                           \
+    for (int PRIV_AVD_PROFILE_CONCAT(PRIV_avdProfileScope, __LINE__) = (avdProfilerBeginZone(name), 0); \
+         PRIV_AVD_PROFILE_CONCAT(PRIV_avdProfileScope, __LINE__) == 0;                                  \
+         PRIV_AVD_PROFILE_CONCAT(PRIV_avdProfileScope, __LINE__) = (avdProfilerEndZone(), 1))
+#define AVD_PROFILE_FRAME()           avdProfilerFrameMark()
+#define AVD_PROFILE_THREAD_NAME(...)  avdProfilerSetThreadName(__VA_ARGS__)
+#define AVD_PROFILE_THREAD_SHUTDOWN() avdProfilerThreadShutdown()
+#else
+#define AVD_PROFILE_BEGIN(name) ((void)0)
+#define AVD_PROFILE_END()       ((void)0)
+#define AVD_PROFILE_SCOPE(name)
+#define AVD_PROFILE_FRAME()           ((void)0)
+#define AVD_PROFILE_THREAD_NAME(...)  ((void)0)
+#define AVD_PROFILE_THREAD_SHUTDOWN() ((void)0)
+#endif
+
+#endif // AVD_PROFILER_H
@@ -3,6 +3,7 @@
 #define AVD_TYPES_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 // Redefine common types used in the math module
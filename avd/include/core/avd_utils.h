@@ -3,6 +3,8 @@
 
 #include "core/avd_base.h"
 
+struct AVD_Bench;
+
 uint32_t avdHashBuffer(const void *buffer, size_t size);
 uint32_t avdHashString(const char *str);
 void avdPrintShaderWithLineNumbers(const char *shaderCode, const char *shaderName);
@@ -16,6 +18,32 @@ const char *avdDumpToTmpFile(const void *data, size_t size, const char *extensio
 bool avdWriteBinaryFile(const char *filename, const void *data, size_t size);
 bool avdCreateDirectoryIfNotExists(const char *path);
 
+typedef enum {
+    AVD_FILE_VIEW_FLAG_NONE       = 0,
+    // The file is read front to back once, the OS can read ahead further and
+    // drop pages behind the reader.
+    AVD_FILE_VIEW_FLAG_SEQUENTIAL = 1 << 0,
+    // Starts paging the whole file in right away.
+    AVD_FILE_VIEW_FLAG_WILL_NEED  = 1 << 1,
+    // Reads the file into memory instead of mapping it.
+    AVD_FILE_VIEW_FLAG_NO_MAP     = 1 << 2,
+} AVD_FileViewFlags;
+
+// Read-only view of a whole file. It is mapped when possible and read into
+// memory otherwise, either way data is followed by a NUL byte so text parsers
+// can treat it as a string. Anything keeping pointers into data after the
+// opener is done retains the view and releases it when finished.
+typedef struct AVD_FileView {
+    const void *data;
+    AVD_Size size;
+    bool mapped;
+    volatile AVD_Int64 refCount;
+} AVD_FileView;
+
+bool avdFileViewOpen(const char *filename, AVD_FileViewFlags flags, AVD_FileView **outView);
+AVD_FileView *avdFileViewRetain(AVD_FileView *view);
+void avdFileViewRelease(AVD_FileView *view);
+
 uint16_t avdQuantizeHalf(float value);
 float avdDequantizeHalf(uint16_t value);
 int avdQuantizeSnorm(float v, int N);
@@ -32,6 +60,9 @@ bool avdCurlPostRequest(const char *url, const char *postData, char **outRespons
 
 bool avdCurlUtilsTestsRun(void);
 
+bool avdUtilsTestsRun(void);
+bool avdUtilsBenchmarksRun(struct AVD_Bench *bench);
+
 #ifdef AVD_DEBUG
 void avdPrintBacktrace(void);
 #endif // AVD_DEBUG
@@ -25,7 +25,6 @@ typedef struct {
     size_t characterCount;
     size_t renderableVertexCount;
     AVD_VulkanBuffer vertexBuffer;
-    struct AVD_FontRendererVertex *vertexBufferData;
     AVD_Font *font;
     char fontName[256];
     float charHeight;
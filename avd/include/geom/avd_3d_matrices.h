@@ -1,11 +1,7 @@
 #ifndef AVD_3D_MATRICES_H
 #define AVD_3D_MATRICES_H
 
-#ifndef AVD_MATH_USE_SIMD
 #include "math/avd_matrix_non_simd.h"
-#else
-#error "AVD_MATH_USE_SIMD is not supported in this version."
-#endif
 
 #define avdMatTranslation(tx, ty, tz) avdMat4x4( \
     1.0f, 0.0f, 0.0f, tx,                        \
@@ -0,0 +1,87 @@
+#ifndef AVD_BOUNDS_H
+#define AVD_BOUNDS_H
+
+#include "math/avd_math.h"
+
+#include <float.h>
+
+typedef struct {
+    AVD_Vector3 min;
+    AVD_Vector3 max;
+} AVD_AABB;
+
+typedef struct {
+    AVD_Vector3 center;
+    AVD_Float radius;
+} AVD_Sphere;
+
+// Points with dot(normal, p) + distance >= 0 are on the inner side.
+typedef struct {
+    AVD_Vector3 normal;
+    AVD_Float distance;
+} AVD_Plane;
+
+typedef enum {
+    AVD_FRUSTUM_PLANE_LEFT = 0,
+    AVD_FRUSTUM_PLANE_RIGHT,
+    AVD_FRUSTUM_PLANE_BOTTOM,
+    AVD_FRUSTUM_PLANE_TOP,
+    AVD_FRUSTUM_PLANE_NEAR,
+    AVD_FRUSTUM_PLANE_FAR,
+    AVD_FRUSTUM_PLANE_COUNT,
+} AVD_FrustumPlane;
+
+typedef struct {
+    AVD_Plane planes[AVD_FRUSTUM_PLANE_COUNT];
+} AVD_Frustum;
+
+// Structure of arrays bounds for culling many objects at once, every entry
+// holds a box as center and half extents and a sphere around the same center.
+typedef struct {
+    AVD_Float *centerX;
+    AVD_Float *centerY;
+    AVD_Float *centerZ;
+    AVD_Float *extentX;
+    AVD_Float *extentY;
+    AVD_Float *extentZ;
+    AVD_Float *radius;
+
+    AVD_Size count;
+    AVD_Size capacity;
+} AVD_BoundsStreams;
+
+// Inverted so that extending it with the first point gives that point.
+#define avdAABBEmpty() ((AVD_AABB){            \
+    .min = avdVec3(FLT_MAX, FLT_MAX, FLT_MAX), \
+    .max = avdVec3(-FLT_MAX, -FLT_MAX, -FLT_MAX)})
+
+#define avdAABBIsEmpty(aabb) ((aabb).min.x > (aabb).max.x || (aabb).min.y > (aabb).max.y || (aabb).min.z > (aabb).max.z)
+#define avdAABBCenter(aabb)  avdVec3Scale(avdVec3Add((aabb).min, (aabb).max), 0.5f)
+#define avdAABBExtents(aabb) avdVec3Scale(avdVec3Subtract((aabb).max, (aabb).min), 0.5f)
+
+void avdAABBExtend(AVD_AABB *aabb, const AVD_Vector3 point);
+AVD_AABB avdAABBFromPoints(const AVD_Vector3 *points, AVD_Size count);
+// Box around the transformed box, the result is larger than the contents for rotations.
+AVD_AABB avdAABBTransform(const AVD_AABB *aabb, const AVD_Matrix4x4 *matrix);
+AVD_Sphere avdSphereFromAABB(const AVD_AABB *aabb);
+AVD_Sphere avdSphereTransform(const AVD_Sphere *sphere, const AVD_Matrix4x4 *matrix);
+
+AVD_Plane avdPlaneNormalize(const AVD_Plane plane);
+AVD_Float avdPlaneDistance(const AVD_Plane *plane, const AVD_Vector3 point);
+
+// Planes of the clip volume of a projection or view projection matrix, these
+// are in the space the matrix transforms from (world space for projection * view).
+AVD_Frustum avdFrustumFromMatrix(const AVD_Matrix4x4 *viewProjection);
+bool avdFrustumTestAABB(const AVD_Frustum *frustum, const AVD_AABB *aabb);
+bool avdFrustumTestSphere(const AVD_Frustum *frustum, const AVD_Sphere *sphere);
+
+bool avdBoundsStreamsCreate(AVD_BoundsStreams *streams, AVD_Size capacity);
+void avdBoundsStreamsDestroy(AVD_BoundsStreams *streams);
+void avdBoundsStreamsSet(AVD_BoundsStreams *streams, AVD_Size index, const AVD_AABB *aabb, const AVD_Sphere *sphere);
+
+// Write the indices of the entries that are at least partly inside the frustum
+// to outVisible (room for streams->count indices) and return how many there are.
+AVD_Size avdFrustumCullAABBs(const AVD_Frustum *frustum, const AVD_BoundsStreams *streams, AVD_UInt32 *outVisible);
+AVD_Size avdFrustumCullSpheres(const AVD_Frustum *frustum, const AVD_BoundsStreams *streams, AVD_UInt32 *outVisible);
+
+#endif // AVD_BOUNDS_H
@@ -0,0 +1,90 @@
+#ifndef AVD_BVH_H
+#define AVD_BVH_H
+
+#include "geom/avd_bounds.h"
+
+struct AVD_Bench;
+
+// Triangles per leaf the builder stops at regardless of the SAH cost.
+#ifndef AVD_BVH_MAX_LEAF_TRIANGLES
+#define AVD_BVH_MAX_LEAF_TRIANGLES 4
+#endif
+
+// Centroid bins the SAH sweeps over per axis.
+#ifndef AVD_BVH_BIN_COUNT
+#define AVD_BVH_BIN_COUNT 16
+#endif
+
+// Subtrees with at least this many triangles are built as separate jobs.
+#ifndef AVD_BVH_PARALLEL_THRESHOLD
+#define AVD_BVH_PARALLEL_THRESHOLD 4096
+#endif
+
+#define AVD_BVH_NO_HIT     0xFFFFFFFFu
+#define AVD_BVH_MAX_DEPTH  64
+#define AVD_BVH_RAY_PACKET 4
+
+typedef struct {
+    AVD_Vector3 origin;
+    AVD_Vector3 direction;
+    AVD_Float tMax;
+} AVD_Ray;
+
+// triangle is the index the triangle had in the build input, AVD_BVH_NO_HIT
+// when the ray missed. u and v are the barycentrics of the second and third vertex.
+typedef struct {
+    AVD_Float t;
+    AVD_Float u;
+    AVD_Float v;
+    AVD_UInt32 triangle;
+} AVD_RayHit;
+
+// 32 bytes, two per cache line. Inner nodes have triangleCount 0 and their
+// children at firstIndex and firstIndex + 1, leaves own the triangles
+// [firstIndex, firstIndex + triangleCount) of the reordered triangle arrays.
+typedef struct {
+    AVD_Float boundsMin[3];
+    AVD_UInt32 firstIndex;
+    AVD_Float boundsMax[3];
+    AVD_UInt32 triangleCount;
+} AVD_BvhNode;
+
+// Precomputed for the Moller-Trumbore test.
+typedef struct {
+    AVD_Vector3 vertex0;
+    AVD_Vector3 edge1;
+    AVD_Vector3 edge2;
+} AVD_BvhTriangle;
+
+typedef struct {
+    AVD_BvhNode *nodes;
+    AVD_Size nodeCount;
+
+    // in leaf order, triangleIds maps back to the build input
+    AVD_BvhTriangle *triangles;
+    AVD_UInt32 *triangleIds;
+    AVD_Size triangleCount;
+} AVD_Bvh;
+
+// Binned SAH build over triangleCount triangles. indices holds three vertex
+// indices per triangle, NULL reads the positions as a plain triangle list.
+// Uses the job system when it is initialized.
+bool avdBvhBuild(AVD_Bvh *bvh, const AVD_Vector3 *positions, const AVD_UInt32 *indices, AVD_Size triangleCount);
+void avdBvhDestroy(AVD_Bvh *bvh);
+AVD_AABB avdBvhBounds(const AVD_Bvh *bvh);
+
+// Closest hit along the ray up to ray->tMax, returns false on a miss.
+bool avdBvhIntersect(const AVD_Bvh *bvh, const AVD_Ray *ray, AVD_RayHit *outHit);
+// Any hit before ray->tMax, stops at the first one it finds.
+bool avdBvhOccluded(const AVD_Bvh *bvh, const AVD_Ray *ray);
+
+// Batched versions of the above, every AVD_BVH_RAY_PACKET consecutive rays are
+// traversed together on the SIMD backends so they should start close to each
+// other and point in similar directions, like neighbouring pixels or samples.
+void avdBvhIntersectRays(const AVD_Bvh *bvh, const AVD_Ray *rays, AVD_Size count, AVD_RayHit *outHits);
+void avdBvhOccludedRays(const AVD_Bvh *bvh, const AVD_Ray *rays, AVD_Size count, bool *outOccluded);
+
+bool avdBvhTestsRun(void);
+bool avdBvhBenchmarksRun(struct AVD_Bench *bench);
+
+#endif // AVD_BVH_H
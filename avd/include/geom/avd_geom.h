@@ -2,6 +2,8 @@
 #define AVD_GEOM_H
 
 #include "geom/avd_3d_matrices.h"
+#include "geom/avd_bounds.h"
+#include "geom/avd_bvh.h"
 #include "geom/avd_transform.h"
 
 #endif // AVD_GEOM_H
\ No newline at end of file
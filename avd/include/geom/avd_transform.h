@@ -10,6 +10,26 @@ typedef struct {
     AVD_Quaternion rotation;
 } AVD_Transform;
 
+// Structure of arrays transforms for computing many world matrices at once.
+// Every stream holds capacity entries, nodes are stored parent first so
+// parents[i] is either -1 for a root or an index smaller than i.
+typedef struct {
+    AVD_Float *positionX;
+    AVD_Float *positionY;
+    AVD_Float *positionZ;
+    AVD_Float *rotationX;
+    AVD_Float *rotationY;
+    AVD_Float *rotationZ;
+    AVD_Float *rotationW;
+    AVD_Float *scaleX;
+    AVD_Float *scaleY;
+    AVD_Float *scaleZ;
+    AVD_Int32 *parents;
+
+    AVD_Size count;
+    AVD_Size capacity;
+} AVD_TransformStreams;
+
 // Transform creation and initialization
 #define avdTransformIdentity() ((AVD_Transform){ \
     .position = avdVec3Zero(),                   \
@@ -59,4 +79,16 @@ AVD_Vector3 avdTransformGetForward(const AVD_Transform *transform);
 AVD_Vector3 avdTransformGetUp(const AVD_Transform *transform);
 AVD_Vector3 avdTransformGetRight(const AVD_Transform *transform);
 
+// Batched transforms
+bool avdTransformStreamsCreate(AVD_TransformStreams *streams, AVD_Size capacity);
+// Grows the streams to hold at least capacity nodes, keeping the ones set so far.
+bool avdTransformStreamsReserve(AVD_TransformStreams *streams, AVD_Size capacity);
+void avdTransformStreamsDestroy(AVD_TransformStreams *streams);
+void avdTransformStreamsSet(AVD_TransformStreams *streams, AVD_Size index, const AVD_Transform *transform, AVD_Int32 parent);
+AVD_Transform avdTransformStreamsGet(const AVD_TransformStreams *streams, AVD_Size index);
+// Same result as avdTransformToMatrix for every node in [first, first + count).
+void avdTransformStreamsToMatrices(const AVD_TransformStreams *streams, AVD_Size first, AVD_Size count, AVD_Matrix4x4 *outMatrices);
+// World matrices for all streams->count nodes, outWorld[i] = outWorld[parents[i]] * local[i].
+void avdTransformStreamsToWorldMatrices(const AVD_TransformStreams *streams, AVD_Matrix4x4 *outWorld);
+
 #endif // AVD_TRANSFORM_H
\ No newline at end of file
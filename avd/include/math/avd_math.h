@@ -3,12 +3,9 @@
 
 #include "math/avd_math_base.h"
 
-#ifndef AVD_MATH_USE_SIMD
+// the SIMD backend shares these types and only swaps the function implementations
 #include "math/avd_matrix_non_simd.h"
 #include "math/avd_qaternion_non_simd.h"
 #include "math/avd_vector_non_simd.h"
-#else
-#error "AVD_MATH_USE_SIMD is not supported in this version."
-#endif
 
 #endif // AVD_MATH_H
\ No newline at end of file
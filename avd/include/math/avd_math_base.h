@@ -2,6 +2,7 @@
 #define AVD_MATH_BASE_H
 
 #include "core/avd_core.h"
+#include "math/avd_math_simd.h"
 
 // Define common constants
 #define AVD_PI 3.14159265358979323846f
@@ -21,4 +22,7 @@
 #define avdLerp(a, b, t)          ((a) + ((b) - (a)) * (t))
 #define avdIsFEqual(a, b)         (fabsf((a) - (b)) < 1e-6f && !isnan(a) && !isnan(b) && !isinf(a) && !isinf(b) && fabsf(a) < 1e6f)
 
+// Name of the backend in use ("avx2", "sse2", "neon" or "scalar").
+const char *avdMathBackendName(void);
+
 #endif // AVD_MATH_BASE_H
\ No newline at end of file
@@ -3,6 +3,9 @@
 
 #include "math/avd_math.h"
 
+struct AVD_Bench;
+
 bool avdMathTestsRun();
+bool avdMathBenchmarksRun(struct AVD_Bench *bench);
 
 #endif // AVD_MATH_TESTS_H
@@ -4,7 +4,8 @@
 #include "math/avd_vector_non_simd.h"
 
 // Important Note:
-// This file defines matrix types and operations without SIMD optimizations.
+// This file defines matrix types and operations without SIMD optimizations,
+// with AVD_USE_SIMD the mat4 products come from avd_matrix_simd.c.
 // The matrices are laid out in memory in column-major order,
 // however you must only access them through the provided macros and functions.
 // and thus can use normal row-major access patterns.
@@ -3,6 +3,12 @@
 
 #include "model/avd_model.h"
 #include "model/avd_model_base.h"
+#include "model/avd_model_cache.h"
+#include "model/avd_model_lod.h"
+#include "model/avd_model_meshlets.h"
+#include "model/avd_model_obj_parser.h"
+#include "model/avd_model_optimizer.h"
+#include "model/avd_model_vertex_stream.h"
 
 typedef struct AVD_3DScene {
     AVD_ModelResources modelResources;
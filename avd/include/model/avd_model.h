@@ -3,6 +3,8 @@
 
 #include "model/avd_model_base.h"
 
+struct AVD_Bench;
+
 typedef struct {
     char name[256];
     float weight;
@@ -15,7 +17,7 @@ typedef struct {
 
 typedef struct {
     char path[1024];
-    AVD_UInt32 id;
+    AVD_UInt64 id;
 
     bool hasTexture;
 
@@ -43,58 +45,164 @@ typedef struct {
     bool unlit;
 } AVD_ModelMaterial;
 
+// A range of the index list drawing a simplified version of a mesh with the
+// same vertices.
+typedef struct {
+    AVD_Int32 indexOffset;
+    AVD_Int32 triangleCount;
+    AVD_Float error; // how far the surface may have moved, in mesh units
+} AVD_MeshLod;
+
 typedef struct {
     char name[256];
     AVD_Int32 id;
     AVD_Int32 indexOffset;
     AVD_Int32 triangleCount;
 
+    // local space bounds of the vertices the mesh draws, set at load time
+    AVD_AABB bounds;
+    AVD_Sphere boundingSphere;
+
+    // range in the meshlet list, only set when meshlets were built
+    AVD_Int32 meshletOffset;
+    AVD_Int32 meshletCount;
+
+    // lods[0] is the full mesh, only set when the levels were built, see
+    // avd_model_lod.h
+    AVD_MeshLod lods[AVD_MESH_MAX_LODS];
+    AVD_Int32 lodCount;
+
+    // names and weights of the targets, shared by the primitives of a glTF mesh
     AVD_MorphTargets *morphTargets;
+    // target i of morphTargets is entry morphTargetOffset + i of the morph
+    // target list and moves vertices of the range that starts at
+    // morphVertexOffset, see avd_model_morph.h
+    AVD_Int32 morphTargetOffset;
+    AVD_Int32 morphTargetCount;
+    AVD_Int32 morphVertexOffset;
+    AVD_Int32 morphVertexCount;
+
     AVD_ModelMaterial material;
 } AVD_Mesh;
 
-typedef struct AVD_ModelNode {
+// Every model is created with a root node, the scenes hang below it.
+#define AVD_MODEL_ROOT_NODE 0
+
+// A node of the hierarchy. The links are node indices, -1 when unset, and
+// children are kept in the order they were added.
+typedef struct {
     char name[256];
     AVD_Int32 id;
-    AVD_Transform transform;
-
-    bool hasMesh;
-    AVD_Mesh mesh;
 
-    struct AVD_ModelNode *children[AVD_MODEL_NODE_MAX_CHILDREN];
-    struct AVD_ModelNode *parent;
+    AVD_Int32 parent;
+    AVD_Int32 firstChild;
+    AVD_Int32 lastChild;
+    AVD_Int32 nextSibling;
 } AVD_ModelNode;
 
+// Local and world matrices of the nodes kept between frames. Setting a
+// transform only flags the node, avdModelUpdateWorldMatrices then redoes the
+// flagged nodes and everything below them in one parent first pass.
+typedef struct {
+    AVD_List local; // AVD_Matrix4x4 per node
+    AVD_List world; // AVD_Matrix4x4 per node, contiguous for uploads
+    // generation of the update that last changed the world matrix of a node
+    AVD_List generations;
+    AVD_List dirty; // AVD_UInt8 per node, the transform was set since the last update
+
+    AVD_UInt32 generation; // bumped by every update that changes a matrix
+    AVD_Int32 firstDirty;  // -1 when every matrix is current
+    // the nodes changed by the last update all lie in [changedFirst, changedFirst + changedCount)
+    AVD_Int32 changedFirst;
+    AVD_Int32 changedCount;
+} AVD_ModelNodeMatrices;
+
 typedef struct {
     char name[256];
     AVD_Int32 id;
     AVD_List meshes;
 
-    AVD_ModelNode *nodes;
-    AVD_Int32 nodeCount;
+    // Nodes are stored parent first, every node comes after its parent, so a
+    // linear walk already visits parents before their children. The local
+    // transforms and the mesh of every node (an index into meshes, -1 for
+    // none) are kept in streams of their own with the same indices.
+    AVD_List nodes;
+    AVD_TransformStreams nodeTransforms;
+    AVD_List nodeMeshes;
+    AVD_ModelNodeMatrices nodeMatrices;
 
     AVD_List morphTargets;
 
-    AVD_ModelNode *mainScene;
-    AVD_ModelNode *rootNode;
+    AVD_Int32 mainScene; // node index, -1 for none
 } AVD_Model;
 
 typedef enum {
     AVD_OBJ_LOAD_FLAG_NONE           = 0,
     AVD_OBJ_LOAD_FLAG_IGNORE_OBJECTS = 1 << 0,
+    // also merge vertices that are identical once packed, see avd_model_obj_loader.c
+    AVD_OBJ_LOAD_FLAG_WELD_PACKED       = 1 << 1,
+    // vertex cache and vertex fetch optimization of every mesh, see avd_model_optimizer.h
+    AVD_OBJ_LOAD_FLAG_OPTIMIZE          = 1 << 2,
+    // like AVD_OBJ_LOAD_FLAG_OPTIMIZE and also sorts triangles to reduce overdraw
+    AVD_OBJ_LOAD_FLAG_OPTIMIZE_OVERDRAW = 1 << 3,
+    // split every mesh into meshlets, see avd_model_meshlets.h
+    AVD_OBJ_LOAD_FLAG_MESHLETS          = 1 << 4,
+    // build simplified levels of detail for every mesh, see avd_model_lod.h
+    AVD_OBJ_LOAD_FLAG_LODS              = 1 << 5,
 } AVD_ObjLoadFlags;
 
 typedef enum {
-    AVD_GLT_LOAD_FLAG_NONE = 0,
+    AVD_GLT_LOAD_FLAG_NONE               = 0,
+    // same as the OBJ flags, morph targets follow the vertices they move
+    AVD_GLTF_LOAD_FLAG_OPTIMIZE          = 1 << 0,
+    AVD_GLTF_LOAD_FLAG_OPTIMIZE_OVERDRAW = 1 << 1,
+    AVD_GLTF_LOAD_FLAG_MESHLETS          = 1 << 2,
+    AVD_GLTF_LOAD_FLAG_LODS              = 1 << 3,
+    // store morph target deltas with 16 bit components, see avd_model_morph.h
+    AVD_GLTF_LOAD_FLAG_QUANTIZE_MORPHS   = 1 << 4,
 } AVD_GltfLoadFlags;
 
 bool avdModelCreate(AVD_Model *model, AVD_Int32 id);
 void avdModelDestroy(AVD_Model *model);
 
-bool avdModelNodePrepare(AVD_ModelNode *node, AVD_ModelNode *parent, const char *name, AVD_Int32 id);
-bool avdModelAllocNode(AVD_Model *model, AVD_ModelNode **outNode);
+// Adds a node as the last child of parent, with an identity transform and no
+// mesh. outIndex may be NULL.
+bool avdModelAddNode(AVD_Model *model, AVD_Int32 parent, const char *name, AVD_Int32 id, AVD_Int32 *outIndex);
+// Drops every node but the root.
+void avdModelClearNodes(AVD_Model *model);
+AVD_Int32 avdModelNodeCount(const AVD_Model *model);
+AVD_ModelNode *avdModelGetNode(const AVD_Model *model, AVD_Int32 index);
+AVD_Transform avdModelGetNodeTransform(const AVD_Model *model, AVD_Int32 index);
+void avdModelSetNodeTransform(AVD_Model *model, AVD_Int32 index, const AVD_Transform *transform);
+AVD_Int32 avdModelGetNodeMeshIndex(const AVD_Model *model, AVD_Int32 index);
+// NULL for nodes without a mesh, only valid until the next mesh is added.
+AVD_Mesh *avdModelGetNodeMesh(const AVD_Model *model, AVD_Int32 index);
+void avdModelSetNodeMesh(AVD_Model *model, AVD_Int32 index, AVD_Int32 meshIndex);
+// Number of parents above the node, 0 for the root.
+AVD_Int32 avdModelNodeDepth(const AVD_Model *model, AVD_Int32 index);
+// Depth first walk over root and everything below it without recursion, the
+// node after the given one or -1 once the subtree is done:
+//   for (AVD_Int32 node = root; node >= 0; node = avdModelNodeNext(model, root, node))
+AVD_Int32 avdModelNodeNext(const AVD_Model *model, AVD_Int32 root, AVD_Int32 index);
+// World matrices of all nodes in one linear pass, outWorld holds
+// avdModelNodeCount matrices.
+void avdModelComputeWorldMatrices(const AVD_Model *model, AVD_Matrix4x4 *outWorld);
+// Brings the cached world matrices up to date, only the nodes whose transform
+// was set since the last update and their subtrees are redone, with the same
+// result as avdModelComputeWorldMatrices. Returns the number of nodes whose
+// world matrix changed, 0 for a static hierarchy.
+AVD_Int32 avdModelUpdateWorldMatrices(AVD_Model *model);
+// The avdModelNodeCount world matrices of the last update.
+const AVD_Matrix4x4 *avdModelGetWorldMatrices(const AVD_Model *model);
+// Generation of the update that last changed the world matrix of the node,
+// compare against nodeMatrices.generation of an earlier frame.
+AVD_UInt32 avdModelGetNodeWorldGeneration(const AVD_Model *model, AVD_Int32 index);
 bool avdMeshInit(AVD_Mesh *mesh);
 bool avdMeshInitWithNameId(AVD_Mesh *mesh, const char *name, AVD_Int32 id);
+bool avdMeshComputeBounds(AVD_Mesh *mesh, const AVD_ModelResources *resources);
+// CPU ray query structure over the triangles the mesh draws, hits report the
+// triangle index within the mesh.
+bool avdMeshBuildBvh(const AVD_Mesh *mesh, const AVD_ModelResources *resources, AVD_Bvh *outBvh);
 
 bool avdModelLoadGltf(const char *filename, AVD_Model *model, AVD_ModelResources *resources, AVD_GltfLoadFlags flags);
 
@@ -109,4 +217,7 @@ bool avdModelAddOctaSphere(
     AVD_UInt32 subdivisions);
 bool avdModelAddUnitCube(AVD_Model *model, AVD_ModelResources *resources, const char *name, AVD_Int32 id);
 
+bool avdModelTestsRun(void);
+bool avdModelBenchmarksRun(struct AVD_Bench *bench);
+
 #endif // AVD_MODEL_H
\ No newline at end of file
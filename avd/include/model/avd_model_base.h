@@ -9,12 +9,26 @@
 #define AVD_MAX_MORPH_TARGETS_PER_MESH 1024
 #endif
 
-#ifndef AVD_MODEL_NODE_MAX_CHILDREN
-#define AVD_MODEL_NODE_MAX_CHILDREN 1024
+// Nodes a model makes room for when it is created, the node streams grow
+// past this as needed.
+#ifndef AVD_MODEL_INITIAL_NODE_CAPACITY
+#define AVD_MODEL_INITIAL_NODE_CAPACITY 64
 #endif
 
-#ifndef AVD_MODEL_MAX_NODES
-#define AVD_MODEL_MAX_NODES 1024 * 16
+// Meshlet limits, 64 vertices and 124 triangles fit the mesh shader output
+// limits of most GPUs and keep a meshlet within one or two warps.
+#ifndef AVD_MESHLET_MAX_VERTICES
+#define AVD_MESHLET_MAX_VERTICES 64
+#endif
+
+#ifndef AVD_MESHLET_MAX_TRIANGLES
+#define AVD_MESHLET_MAX_TRIANGLES 124
+#endif
+
+// Levels of detail per mesh including the full mesh, every level usually
+// halves the triangles of the one before.
+#ifndef AVD_MESH_MAX_LODS
+#define AVD_MESH_MAX_LODS 8
 #endif
 
 typedef struct {
@@ -32,9 +46,63 @@ typedef struct {
     uint16_t tu, tv;
 } AVD_ModelVertexPacked;
 
+// A cluster of a mesh, laid out like the std430 struct the shaders read.
+typedef struct {
+    AVD_Float center[3]; // bounding sphere
+    AVD_Float radius;
+    AVD_Float coneAxis[3]; // normal cone, see avdMeshletConeCulled
+    AVD_Float coneCutoff;
+    uint32_t vertexOffset;   // into meshletVerticesList
+    uint32_t triangleOffset; // into meshletTrianglesList
+    uint32_t vertexCount;
+    uint32_t triangleCount;
+} AVD_Meshlet;
+
+typedef enum {
+    AVD_MORPH_DELTA_ENCODING_FLOAT = 0,
+    // 16 bit positions and normals, see AVD_MorphDeltaQuantized
+    AVD_MORPH_DELTA_ENCODING_QUANTIZED,
+} AVD_MorphDeltaEncoding;
+
+// What a morph target adds to one vertex at full weight, targets only store
+// the vertices they move. vertex is relative to the morph vertex range of the
+// mesh.
+typedef struct {
+    uint32_t vertex;
+    AVD_Float position[3];
+    AVD_Float normal[3];
+} AVD_MorphDelta;
+
+// The quantized form, positions in steps of the positionScale of the target
+// and normals in steps of AVD_MORPH_NORMAL_SCALE.
+typedef struct {
+    uint32_t vertex;
+    int16_t position[3];
+    int16_t normal[3];
+} AVD_MorphDeltaQuantized;
+
+// One morph target of a mesh, laid out like the std430 struct the shaders read.
+typedef struct {
+    uint32_t deltaOffset; // into morphDeltasList, in 32 bit words
+    uint32_t deltaCount;
+    uint32_t encoding; // AVD_MorphDeltaEncoding
+    AVD_Float positionScale;
+} AVD_MorphTargetDeltas;
+
 typedef struct {
     AVD_List verticesList;
     AVD_List indicesList;
+
+    AVD_List meshletsList;
+    // vertex index of every meshlet vertex, the same values the index list holds
+    AVD_List meshletVerticesList;
+    // one uint32_t per triangle with three 8 bit meshlet vertex indices
+    AVD_List meshletTrianglesList;
+
+    AVD_List morphTargetsList;
+    // the AVD_MorphDelta or AVD_MorphDeltaQuantized of every target as 32 bit
+    // words, the encoding of the target decides
+    AVD_List morphDeltasList;
 } AVD_ModelResources;
 
 void avdModelVertexInit(AVD_ModelVertex *vertex);
@@ -0,0 +1,70 @@
+#ifndef AVD_MODEL_CACHE_H
+#define AVD_MODEL_CACHE_H
+
+#include "model/avd_model.h"
+
+struct AVD_Bench;
+
+// Loaders keep a baked copy of every model they load in the temp directory,
+// next to the compiled shaders, and load that instead while the sources are
+// unchanged.
+#ifndef AVD_MODEL_CACHE_ENABLED
+#define AVD_MODEL_CACHE_ENABLED 1
+#endif
+
+// Bump whenever the layout of the file or of any struct stored in it changes,
+// and whenever the loaders produce different output for the same source file.
+#define AVD_MODEL_CACHE_VERSION 5
+
+#ifndef AVD_MODEL_CACHE_MAX_DEPENDENCIES
+#define AVD_MODEL_CACHE_MAX_DEPENDENCIES 16
+#endif
+
+typedef struct {
+    char path[512];
+    AVD_UInt64 hash; // of the content
+} AVD_ModelCacheDependency;
+
+// One load of a model through the cache. The file is named after the content
+// hash of the source file, the loader and its flags; every other file the
+// source pulls in is added as a dependency whose content is checked again
+// when the cache is read.
+//
+//   avdModelCacheBegin, avdModelCacheRead
+// and when that fails, after the regular load:
+//   avdModelCacheAddDependency for every further file, avdModelCacheWrite
+typedef struct {
+    char path[1024];
+    AVD_UInt64 key;
+    bool enabled;
+
+    AVD_ModelCacheDependency dependencies[AVD_MODEL_CACHE_MAX_DEPENDENCIES];
+    AVD_Int32 dependencyCount;
+
+    // list counts before the load, everything past them belongs to the model
+    AVD_Size vertexBase;
+    AVD_Size indexBase;
+    AVD_Size meshletBase;
+    AVD_Size meshletVertexBase;
+    AVD_Size meshletTriangleBase;
+    AVD_Size morphTargetBase;
+    AVD_Size morphDeltaBase;
+} AVD_ModelCache;
+
+// Hashes the source file. Returns false, and leaves the entry disabled, when
+// caching is turned off or the source can not be read.
+bool avdModelCacheBegin(AVD_ModelCache *cache, const char *sourcePath, const char *loaderName, AVD_UInt32 loadFlags, const AVD_ModelResources *resources);
+// Disables the entry when the file can not be read or there are too many.
+bool avdModelCacheAddDependency(AVD_ModelCache *cache, const char *path);
+// Loads the model from the cache file into a freshly created model. Returns
+// false without touching model or resources when the file is missing, from
+// another version, corrupted or out of date with its dependencies.
+bool avdModelCacheRead(AVD_ModelCache *cache, AVD_Model *model, AVD_ModelResources *resources);
+// Stores the model loaded since avdModelCacheBegin, does nothing for a
+// disabled entry.
+bool avdModelCacheWrite(const AVD_ModelCache *cache, const AVD_Model *model, const AVD_ModelResources *resources);
+
+bool avdModelCacheTestsRun(void);
+bool avdModelCacheBenchmarksRun(struct AVD_Bench *bench);
+
+#endif // AVD_MODEL_CACHE_H
@@ -0,0 +1,54 @@
+#ifndef AVD_MODEL_DRAW_H
+#define AVD_MODEL_DRAW_H
+
+#include "model/avd_model.h"
+
+struct AVD_Bench;
+
+// One mesh node of a model as the GPU culling reads it, laid out like the
+// std430 struct of IndirectCullComp. The box is in world space.
+typedef struct {
+    AVD_Matrix4x4 modelMatrix;
+    AVD_Float center[3];
+    uint32_t firstIndex; // into indicesList
+    AVD_Float extents[3];
+    uint32_t indexCount;
+    uint32_t materialIndex; // slot of the bindless texture array, 0 for none
+    int32_t node;
+    uint32_t pad0;
+    uint32_t pad1;
+} AVD_DrawInstance;
+
+// Same layout as VkDrawIndexedIndirectCommand, the culling writes one per
+// visible instance with firstInstance set to the index of the instance.
+typedef struct {
+    uint32_t indexCount;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    uint32_t firstInstance;
+} AVD_DrawIndexedCommand;
+
+// Appends an instance for every node below root that has a mesh with
+// triangles to instances (of AVD_DrawInstance), using the world matrices of
+// the last avdModelUpdateWorldMatrices. meshMaterials holds the material
+// index of every mesh of the model and may be NULL for none.
+bool avdModelBuildDrawInstances(
+    const AVD_Model *model,
+    AVD_Int32 root,
+    const AVD_UInt32 *meshMaterials,
+    AVD_List *instances);
+// CPU reference of IndirectCullComp. Writes a command for every instance
+// whose box is at least partly inside the frustum to outCommands (room for
+// count commands) and returns how many there are. Same test as
+// avdFrustumCullAABBs, the shader writes the same commands in any order.
+AVD_UInt32 avdDrawInstancesCull(
+    const AVD_DrawInstance *instances,
+    AVD_UInt32 count,
+    const AVD_Frustum *frustum,
+    AVD_DrawIndexedCommand *outCommands);
+
+bool avdModelDrawTestsRun(void);
+bool avdModelDrawBenchmarksRun(struct AVD_Bench *bench);
+
+#endif // AVD_MODEL_DRAW_H
@@ -0,0 +1,68 @@
+#ifndef AVD_MODEL_LOD_H
+#define AVD_MODEL_LOD_H
+
+#include "model/avd_model.h"
+
+struct AVD_Bench;
+
+typedef struct {
+    // every level aims for this fraction of the triangles of the one before
+    AVD_Float triangleRatio;
+    // collapses that move the surface further than this, relative to the
+    // largest extent of the mesh, are never made
+    AVD_Float maxError;
+    // weights of normal and texture coordinate changes against the position
+    // error, in the same relative units
+    AVD_Float normalWeight;
+    AVD_Float uvWeight;
+    AVD_Int32 maxLevels; // including the full mesh, at most AVD_MESH_MAX_LODS
+    AVD_Int32 minTriangles;
+} AVD_MeshLodOptions;
+
+typedef struct {
+    AVD_Size meshCount;
+    AVD_Size triangleCount[AVD_MESH_MAX_LODS]; // meshes with fewer levels count their last one
+    AVD_Int32 levelCount;
+} AVD_MeshLodStats;
+
+void avdMeshLodOptionsDefault(AVD_MeshLodOptions *options);
+
+// Edge collapse simplification with quadric error metrics (Garland and
+// Heckbert 1997) plus an area weighted quadric of the normal and texture
+// coordinates. Vertices only collapse onto neighbors and never move, so the
+// result indexes the same vertex buffer. Vertices on open borders, on
+// non manifold edges and on attribute seams (a position shared by several
+// vertices) are locked. Stops at targetIndexCount or when every remaining
+// collapse is over options->maxError. outError is the largest surface
+// deviation in the units of the positions.
+bool avdMeshSimplify(
+    AVD_UInt32 *outIndices,
+    AVD_Size *outIndexCount,
+    const AVD_UInt32 *indices,
+    AVD_Size indexCount,
+    const AVD_ModelVertex *vertices,
+    AVD_Size vertexCount,
+    AVD_Size targetIndexCount,
+    const AVD_MeshLodOptions *options,
+    AVD_Float *outError);
+
+// Builds the levels of a loaded mesh one from the other, every level is
+// vertex cache optimized and appended to the index list. options may be NULL
+// for the defaults. Morph targets still apply as the vertices are shared.
+bool avdMeshBuildLods(AVD_Mesh *mesh, AVD_ModelResources *resources, const AVD_MeshLodOptions *options);
+// Level 0 is the full mesh even when no levels were built.
+AVD_MeshLod avdMeshGetLod(const AVD_Mesh *mesh, AVD_Int32 level);
+void avdMeshLodStatsAdd(AVD_MeshLodStats *total, const AVD_Mesh *mesh);
+
+// Pixels covered by one unit at distance one, for a vertical field of view in
+// radians.
+AVD_Float avdMeshLodProjectionScale(AVD_Float fovY, AVD_Float viewportHeight);
+// The coarsest level whose error projects to at most maxPixelError pixels.
+// distance is from the camera to the bounds of the mesh and scale is the
+// largest scale of its transform.
+AVD_Int32 avdMeshSelectLod(const AVD_Mesh *mesh, AVD_Float distance, AVD_Float scale, AVD_Float projectionScale, AVD_Float maxPixelError);
+
+bool avdModelLodTestsRun(void);
+bool avdModelLodBenchmarksRun(struct AVD_Bench *bench);
+
+#endif // AVD_MODEL_LOD_H
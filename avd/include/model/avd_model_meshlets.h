@@ -0,0 +1,36 @@
+#ifndef AVD_MODEL_MESHLETS_H
+#define AVD_MODEL_MESHLETS_H
+
+#include "model/avd_model.h"
+
+struct AVD_Bench;
+
+// Triangles are packed as three 8 bit meshlet vertex indices.
+#define avdMeshletTrianglePack(a, b, c) ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16))
+#define avdMeshletTriangleCorner(triangle, corner) (((triangle) >> ((corner) * 8)) & 0xffu)
+
+typedef struct {
+    AVD_Size meshletCount;
+    AVD_Size triangleCount;
+    AVD_Size vertexCount; // meshlet vertices, shared vertices count once per meshlet
+    AVD_Size coneCount;   // meshlets with a cone narrow enough to ever be culled
+} AVD_MeshletStats;
+
+// Splits the triangles of a loaded mesh into meshlets of at most
+// AVD_MESHLET_MAX_VERTICES vertices and AVD_MESHLET_MAX_TRIANGLES triangles
+// and appends them to the meshlet lists of resources. Meshlets grow over
+// shared edges first, so run the vertex cache optimizer before for a better
+// starting order. Bounds are computed from the packed positions like
+// avdMeshComputeBounds, morph targets are not included.
+bool avdMeshBuildMeshlets(AVD_Mesh *mesh, AVD_ModelResources *resources);
+void avdMeshletStatsAdd(AVD_MeshletStats *total, const AVD_Mesh *mesh, const AVD_ModelResources *resources);
+
+// True when every triangle of the meshlet faces away from cameraPosition,
+// given in the space of the mesh. Same test as the cluster culling shader:
+// dot(center - camera, axis) >= cutoff * length(center - camera) + radius.
+bool avdMeshletConeCulled(const AVD_Meshlet *meshlet, AVD_Vector3 cameraPosition);
+
+bool avdModelMeshletsTestsRun(void);
+bool avdModelMeshletsBenchmarksRun(struct AVD_Bench *bench);
+
+#endif // AVD_MODEL_MESHLETS_H
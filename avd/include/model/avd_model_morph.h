@@ -0,0 +1,74 @@
+#ifndef AVD_MODEL_MORPH_H
+#define AVD_MODEL_MORPH_H
+
+#include "model/avd_model.h"
+
+struct AVD_Bench;
+
+// Vertices whose deltas are all within this are left out of a target.
+#ifndef AVD_MORPH_DELTA_EPSILON
+#define AVD_MORPH_DELTA_EPSILON 1e-6f
+#endif
+
+// Targets whose weight is closer to zero than this are not blended.
+#ifndef AVD_MORPH_MIN_WEIGHT
+#define AVD_MORPH_MIN_WEIGHT 1e-4f
+#endif
+
+// Step of the quantized normal deltas, a unit normal can move by up to two
+// along every axis.
+#define AVD_MORPH_NORMAL_SCALE (2.0f / 32767.0f)
+
+// Weighted deltas are summed as 32 bit fixed point with this many steps per
+// unit. The compute blend adds them with integer atomics and the CPU blend
+// sums the same values, so both give the same vertices.
+#define AVD_MORPH_FIXED_POINT_SCALE 1048576.0f
+
+// Size of one delta of the encoding in 32 bit words.
+AVD_UInt32 avdMorphDeltaWords(AVD_MorphDeltaEncoding encoding);
+
+// Appends a target built from vertexCount dense xyz deltas to targets (of
+// AVD_MorphTargetDeltas) and its deltas to deltas (of uint32_t). normalDeltas
+// may be NULL. Vertices that the target does not move are left out, the
+// others are numbered from the first of the dense deltas.
+bool avdMorphTargetBuild(
+    AVD_List *targets,
+    AVD_List *deltas,
+    const AVD_Float *positionDeltas,
+    const AVD_Float *normalDeltas,
+    AVD_Size vertexCount,
+    AVD_MorphDeltaEncoding encoding);
+// Renumbers the deltas of all targets after the vertices they move were
+// reordered, vertex v becomes remap[v] (see avdMeshOptimize).
+void avdMorphTargetsRemap(const AVD_List *targets, AVD_List *deltas, const AVD_UInt32 *remap);
+// Appends the targets built for a mesh to resources, they move the vertices
+// in [firstVertex, firstVertex + vertexCount).
+bool avdMeshAddMorphTargets(
+    AVD_Mesh *mesh,
+    AVD_ModelResources *resources,
+    AVD_UInt32 firstVertex,
+    AVD_UInt32 vertexCount,
+    const AVD_List *targets,
+    const AVD_List *deltas);
+// Decodes delta index of a target in resources.
+void avdMorphTargetGetDelta(const AVD_ModelResources *resources, const AVD_MorphTargetDeltas *target, AVD_Size index, AVD_MorphDelta *outDelta);
+// Bytes the targets of the mesh take in the morph lists.
+AVD_Size avdMeshMorphTargetsSize(const AVD_Mesh *mesh, const AVD_ModelResources *resources);
+
+// CPU reference of MorphBlendComp. Writes the morphVertexCount vertices of the
+// morph range of mesh to outVertices, the base vertices plus the deltas of
+// every target weighted by weights (one per target, targets with a weight
+// below AVD_MORPH_MIN_WEIGHT are skipped). Normals are renormalized, tangents
+// and texture coordinates are kept. accumulators is a list of AVD_Int32 that
+// is reused between calls.
+bool avdMeshBlendMorphTargets(
+    const AVD_Mesh *mesh,
+    const AVD_ModelResources *resources,
+    const AVD_Float *weights,
+    AVD_List *accumulators,
+    AVD_ModelVertexPacked *outVertices);
+
+bool avdModelMorphTestsRun(void);
+bool avdModelMorphBenchmarksRun(struct AVD_Bench *bench);
+
+#endif // AVD_MODEL_MORPH_H
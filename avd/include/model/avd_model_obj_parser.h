@@ -0,0 +1,72 @@
+#ifndef AVD_MODEL_OBJ_PARSER_H
+#define AVD_MODEL_OBJ_PARSER_H
+
+#include "core/avd_core.h"
+#include "math/avd_math.h"
+
+struct AVD_Bench;
+
+// Files are split into chunks of at least this many bytes, one job each.
+#ifndef AVD_OBJ_PARSER_MIN_CHUNK_SIZE
+#define AVD_OBJ_PARSER_MIN_CHUNK_SIZE (1024 * 1024)
+#endif
+
+#ifndef AVD_OBJ_PARSER_MAX_CHUNKS
+#define AVD_OBJ_PARSER_MAX_CHUNKS 256
+#endif
+
+// Zero based indices of one face corner, -1 for attributes it does not have.
+typedef struct {
+    AVD_Int32 position;
+    AVD_Int32 texCoord;
+    AVD_Int32 normal;
+} AVD_ObjCorner;
+
+// The triangles from an 'o' or 'g' line up to the next one. Triangles before
+// the first such line are in an object without a name.
+typedef struct {
+    char name[256];
+    AVD_Size firstTriangle;
+    AVD_Size triangleCount;
+} AVD_ObjObject;
+
+typedef struct {
+    AVD_List positions; // AVD_Vector3
+    AVD_List texCoords; // AVD_Vector2
+    AVD_List normals;   // AVD_Vector3
+    // three per triangle, polygons are split into fans around their first corner
+    AVD_List corners; // AVD_ObjCorner
+    AVD_List objects; // AVD_ObjObject, only the ones with triangles
+
+    AVD_Size lineCount;
+    AVD_Size chunkCount;
+} AVD_ObjData;
+
+bool avdObjDataCreate(AVD_ObjData *data);
+void avdObjDataDestroy(AVD_ObjData *data);
+
+// Parses the geometry of an OBJ file: positions, texture coordinates,
+// normals, faces and the objects and groups they belong to. Materials,
+// smoothing groups, lines and points are skipped. The text is split at line
+// boundaries into chunks that are parsed as jobs, the results are then copied
+// into data at offsets from prefix sums of the chunk counts. Negative
+// (relative) indices are resolved, every index is checked against its list
+// and a face referencing a missing attribute fails the parse.
+bool avdObjParse(const char *text, AVD_Size size, AVD_ObjData *data);
+bool avdObjParseFile(const char *filename, AVD_ObjData *data);
+
+// Reads a float exactly like strtof for the decimal forms OBJ files use.
+// Digits are classified 16 at a time with SSE2 or NEON and converted 8 at a
+// time within a 64 bit register, values that are not exact in float
+// arithmetic go through strtof.
+// Returns the end of the number or NULL when there is none.
+const char *avdObjParseFloat(const char *text, const char *end, AVD_Float *outValue);
+// Name of the digit scanner in use ("sse2", "neon" or "scalar").
+const char *avdObjParserBackendName(void);
+// Forces the scalar digit scanner, only meant for cross checking the SIMD paths.
+void avdObjParserSetSimdEnabled(bool enabled);
+
+bool avdModelObjParserTestsRun(void);
+bool avdModelObjParserBenchmarksRun(struct AVD_Bench *bench);
+
+#endif // AVD_MODEL_OBJ_PARSER_H
@@ -0,0 +1,89 @@
+#ifndef AVD_MODEL_OPTIMIZER_H
+#define AVD_MODEL_OPTIMIZER_H
+
+#include "model/avd_model.h"
+
+struct AVD_Bench;
+
+// FIFO size the triangle order is optimized for and measured with, close to
+// how many transformed vertices current GPUs reuse.
+#ifndef AVD_MESH_OPTIMIZER_CACHE_SIZE
+#define AVD_MESH_OPTIMIZER_CACHE_SIZE 16
+#endif
+
+// How much the overdraw pass may raise the ACMR of the cache optimized order,
+// 1.05 allows 5%. Higher values cut more clusters and sort them better.
+#ifndef AVD_MESH_OPTIMIZER_OVERDRAW_THRESHOLD
+#define AVD_MESH_OPTIMIZER_OVERDRAW_THRESHOLD 1.05f
+#endif
+
+typedef enum {
+    AVD_MESH_OPTIMIZE_NONE         = 0,
+    AVD_MESH_OPTIMIZE_VERTEX_CACHE = 1 << 0,
+    // sorts clusters of the cache optimized order so that the ones facing away
+    // from the mesh center draw first, implies AVD_MESH_OPTIMIZE_VERTEX_CACHE
+    AVD_MESH_OPTIMIZE_OVERDRAW     = 1 << 1,
+    // renumbers the vertices in the order the index buffer first uses them
+    AVD_MESH_OPTIMIZE_VERTEX_FETCH = 1 << 2,
+} AVD_MeshOptimizeFlags;
+
+// Vertex shader invocations of an index buffer through a simulated FIFO cache.
+typedef struct {
+    AVD_Size triangleCount;
+    AVD_Size vertexCount; // distinct vertices referenced
+    AVD_Size transformCount;
+} AVD_MeshCacheStats;
+
+typedef struct {
+    AVD_MeshCacheStats before;
+    AVD_MeshCacheStats after;
+} AVD_MeshOptimizeStats;
+
+// Average cache miss ratio, transforms per triangle. 3 is the worst case, a
+// large regular grid can get close to 0.5.
+#define avdMeshCacheStatsACMR(stats) ((stats).triangleCount > 0 ? (AVD_Float)(stats).transformCount / (AVD_Float)(stats).triangleCount : 0.0f)
+// Average transform to vertex ratio, 1 means every vertex is transformed once.
+#define avdMeshCacheStatsATVR(stats) ((stats).vertexCount > 0 ? (AVD_Float)(stats).transformCount / (AVD_Float)(stats).vertexCount : 0.0f)
+
+// All index buffers here are triangle lists with indices below vertexCount.
+bool avdMeshAnalyzeVertexCache(const AVD_UInt32 *indices, AVD_Size indexCount, AVD_Size vertexCount, AVD_UInt32 cacheSize, AVD_MeshCacheStats *outStats);
+void avdMeshCacheStatsAdd(AVD_MeshCacheStats *total, const AVD_MeshCacheStats *stats);
+
+// Tipsify (Sander et al. 2007), fans around recently used vertices and runs in
+// linear time. Triangles keep their winding, outIndices must not alias indices.
+bool avdMeshOptimizeVertexCache(AVD_UInt32 *outIndices, const AVD_UInt32 *indices, AVD_Size indexCount, AVD_Size vertexCount, AVD_UInt32 cacheSize);
+// Cuts an already cache optimized index buffer into clusters where the cache
+// restarts or where it can be cut within threshold, then sorts the clusters
+// by how far they face out of the mesh centroid.
+bool avdMeshOptimizeOverdraw(
+    AVD_UInt32 *outIndices,
+    const AVD_UInt32 *indices,
+    AVD_Size indexCount,
+    const AVD_Vector3 *positions,
+    AVD_Size vertexCount,
+    AVD_UInt32 cacheSize,
+    AVD_Float threshold);
+// Writes the new index of every vertex to outRemap, referenced vertices in the
+// order they are first used followed by the unreferenced ones, and returns how
+// many vertices are referenced.
+AVD_Size avdMeshOptimizeVertexFetchRemap(AVD_UInt32 *outRemap, const AVD_UInt32 *indices, AVD_Size indexCount, AVD_Size vertexCount);
+
+// Runs the steps in flags over the triangles of a loaded mesh, which must only
+// reference vertices in [firstVertex, firstVertex + vertexCount). Vertex fetch
+// reordering moves those vertices, so the mesh must own them. outRemap gets
+// the new place of every vertex of the range (relative to firstVertex) for data
+// kept outside of the vertex list, like the morph targets of avd_model_morph.h.
+// outRemap and outStats may be NULL.
+bool avdMeshOptimize(
+    const AVD_Mesh *mesh,
+    AVD_ModelResources *resources,
+    AVD_UInt32 firstVertex,
+    AVD_UInt32 vertexCount,
+    AVD_MeshOptimizeFlags flags,
+    AVD_UInt32 *outRemap,
+    AVD_MeshOptimizeStats *outStats);
+
+bool avdModelOptimizerTestsRun(void);
+bool avdModelOptimizerBenchmarksRun(struct AVD_Bench *bench);
+
+#endif // AVD_MODEL_OPTIMIZER_H
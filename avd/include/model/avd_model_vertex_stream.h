@@ -0,0 +1,59 @@
+#ifndef AVD_MODEL_VERTEX_STREAM_H
+#define AVD_MODEL_VERTEX_STREAM_H
+
+#include "model/avd_model_base.h"
+
+struct AVD_Bench;
+
+// Vertices are decoded into a block of this many before they are packed, the
+// block is kept on the stack.
+#ifndef AVD_VERTEX_STREAM_BLOCK_SIZE
+#define AVD_VERTEX_STREAM_BLOCK_SIZE 64
+#endif
+
+// Component formats of a vertex attribute, the normalized ones map to [0, 1]
+// and [-1, 1] like glTF accessors with normalized set.
+typedef enum {
+    AVD_VERTEX_STREAM_FORMAT_NONE = 0,
+    AVD_VERTEX_STREAM_FORMAT_FLOAT,
+    AVD_VERTEX_STREAM_FORMAT_UNORM8,
+    AVD_VERTEX_STREAM_FORMAT_UNORM16,
+    AVD_VERTEX_STREAM_FORMAT_SNORM8,
+    AVD_VERTEX_STREAM_FORMAT_SNORM16,
+} AVD_VertexStreamFormat;
+
+// One attribute as it lies in memory, usually a glTF accessor in a mapped
+// buffer. Components past the ones the attribute needs are ignored, missing
+// ones read as zero.
+typedef struct {
+    const void *data; // first element, NULL when the attribute is missing
+    AVD_Size stride;  // bytes from one element to the next
+    AVD_VertexStreamFormat format;
+    AVD_UInt32 components;
+} AVD_VertexStream;
+
+typedef struct {
+    AVD_VertexStream position; // xyz
+    AVD_VertexStream normal;   // xyz
+    AVD_VertexStream tangent;  // xyz and the bitangent sign in w
+    AVD_VertexStream texCoord; // uv
+} AVD_VertexStreams;
+
+AVD_Size avdVertexStreamFormatSize(AVD_VertexStreamFormat format);
+
+// Packs count vertices straight from the streams into out, the same values
+// avdModelVertexPack gives for the decoded vertices. Attributes without a
+// stream are taken from the packed vertex at the same index in defaults, or
+// packed from zero when defaults is NULL. Blocks of vertices are decoded with
+// a loop per format and packed four at a time with SSE2 or NEON, quantization
+// and the final interleave included.
+bool avdVertexStreamsPack(const AVD_VertexStreams *streams, AVD_Size count, const AVD_ModelVertexPacked *defaults, AVD_ModelVertexPacked *out);
+// Name of the packer in use ("sse2", "neon" or "scalar").
+const char *avdVertexStreamBackendName(void);
+// Forces the scalar packer, only meant for cross checking the SIMD paths.
+void avdVertexStreamSetSimdEnabled(bool enabled);
+
+bool avdModelVertexStreamTestsRun(void);
+bool avdModelVertexStreamBenchmarksRun(struct AVD_Bench *bench);
+
+#endif // AVD_MODEL_VERTEX_STREAM_H
@@ -2,6 +2,9 @@
 #ifndef AVD_SCENES_DECCER_CUBES_H
 #define AVD_SCENES_DECCER_CUBES_H
 
+#include "common/avd_indirect_draw.h"
+#include "common/avd_meshlet_culling.h"
+#include "common/avd_morph_blend.h"
 #include "scenes/avd_scenes_base.h"
 
 typedef struct AVD_SceneDeccerCubes {
@@ -10,11 +13,43 @@ typedef struct AVD_SceneDeccerCubes {
 
     AVD_Matrix4x4 projectionMatrix;
     AVD_Matrix4x4 viewMatrix;
+    AVD_Vector3 cameraPosition;
 
     AVD_RenderableText title;
     AVD_RenderableText info;
+    AVD_RenderableText cullingInfo;
     AVD_UInt32 loadStage;
 
+    // mesh nodes of the model (node indices) with their world matrices and
+    // bounds, gathered again whenever a node moved and frustum culled every
+    // frame before drawing
+    AVD_List drawNodes;
+    AVD_List drawMatrices;
+    AVD_UInt32 drawGeneration; // of the model world matrices the lists hold
+    AVD_BoundsStreams drawBounds;
+    AVD_UInt32 *visibleDraws;
+    AVD_Size visibleCount;
+    AVD_Double cullingMs;
+
+    // the visible meshes are drawn as meshlets culled on the GPU, one
+    // indirect draw each, toggled with M
+    bool useMeshlets;
+    AVD_MeshletCulling meshletCulling;
+    AVD_UInt32 *meshletVisibleOffsets;
+
+    // all mesh nodes are culled on the GPU and drawn with a single indirect
+    // count draw, toggled with G and used over the meshlets when on
+    bool useIndirect;
+    AVD_IndirectDraw indirectDraw;
+    AVD_List drawInstances;    // AVD_DrawInstance, gathered with drawNodes
+    AVD_UInt32 *meshMaterials; // bindless texture slot of every mesh of the model
+
+    // the meshes with morph targets are blended with their glTF weights on
+    // the GPU every frame, all pipelines then read the vertices from
+    // morphBlend.deformedVerticesBuffer
+    bool useMorphBlend;
+    AVD_MorphBlend morphBlend;
+
     VkDescriptorSetLayout set0Layout;
     VkDescriptorSet set0;
 
@@ -23,8 +58,12 @@ typedef struct AVD_SceneDeccerCubes {
 
     VkPipelineLayout pipelineLayout;
     VkPipeline pipeline;
+    VkPipelineLayout meshletPipelineLayout;
+    VkPipeline meshletPipeline;
+    VkPipelineLayout indirectPipelineLayout;
+    VkPipeline indirectPipeline;
 
-    AVD_UInt32 imagesHashes[16];
+    AVD_UInt64 imagesHashes[16];
     AVD_VulkanImage images[16];
     AVD_UInt32 imagesCount;
 } AVD_SceneDeccerCubes;
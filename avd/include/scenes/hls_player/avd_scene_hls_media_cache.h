@@ -10,7 +10,7 @@ typedef struct {
     char *data;
     AVD_Size dataSize;
     AVD_Size capacity;
-    AVD_UInt32 key;
+    AVD_UInt64 key;
     AVD_UInt32 timestamp;
 } AVD_HLSMediaCacheEntry;
 
@@ -22,7 +22,7 @@ typedef struct {
 bool avdHLSMediaCacheInit(AVD_HLSMediaCache *cache);
 void avdHLSMediaCacheDestroy(AVD_HLSMediaCache *cache);
 
-bool avdHLSMediaCacheQuery(AVD_HLSMediaCache *cache, AVD_UInt32 key, char **data, AVD_Size *dataSize);
-bool avdHLSMediaCacheInsert(AVD_HLSMediaCache *cache, AVD_UInt32 key, const char *data, AVD_Size dataSize);
+bool avdHLSMediaCacheQuery(AVD_HLSMediaCache *cache, AVD_UInt64 key, char **data, AVD_Size *dataSize);
+bool avdHLSMediaCacheInsert(AVD_HLSMediaCache *cache, AVD_UInt64 key, const char *data, AVD_Size dataSize);
 
 #endif // AVD_HLS_MEDIA_CACHE_H
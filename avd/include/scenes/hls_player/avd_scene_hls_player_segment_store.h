@@ -16,6 +16,7 @@ typedef struct {
     uint8_t *h264Buffer;
     AVD_Size h264Size;
 
+    // points into the h264Buffer allocation, never freed on its own
     uint8_t *aacBuffer;
     AVD_Size aacSize;
 } AVD_HLSSegmentAVData;
@@ -38,5 +39,8 @@ AVD_Size avdHLSSegmentStoreGetLoadedSegmentCount(AVD_HLSSegmentStore *store, AVD
 void avdHLSSegmentStoreLogSegmentsInStore(AVD_HLSSegmentStore *store, AVD_Size sourceIndex);
 
 void avdHLSSegmentAVDataFree(AVD_HLSSegmentAVData *avData);
+// Splits an MPEG-TS segment into its H.264 and AAC elementary streams, only the
+// buffers are filled in, source, segmentId and duration are left to the caller.
+bool avdHLSSegmentAVDataDemux(const AVD_UInt8 *data, AVD_Size dataSize, AVD_HLSSegmentAVData *outAvData);
 
 #endif // AVD_SCENES_HLS_PLAYER_SEGMENT_STORE_H
\ No newline at end of file
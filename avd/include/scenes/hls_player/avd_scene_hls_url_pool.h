@@ -9,7 +9,7 @@
 
 typedef struct {
     char urls[AVD_HLS_URL_POOL_CAPACITY][AVD_HLS_URL_MAX_LENGTH];
-    AVD_UInt32 hashes[AVD_HLS_URL_POOL_CAPACITY];
+    AVD_UInt64 hashes[AVD_HLS_URL_POOL_CAPACITY];
     AVD_UInt64 lastAccess[AVD_HLS_URL_POOL_CAPACITY];
     AVD_UInt32 count;
     AVD_UInt64 accessCounter;
@@ -19,8 +19,8 @@ typedef struct {
 bool avdHLSURLPoolInit(AVD_HLSURLPool *pool);
 void avdHLSURLPoolDestroy(AVD_HLSURLPool *pool);
 
-AVD_Bool avdHLSURLPoolInsert(AVD_HLSURLPool *pool, const char *url, AVD_UInt32 *outHash);
-const char *avdHLSURLPoolGet(AVD_HLSURLPool *pool, AVD_UInt32 hash);
+AVD_Bool avdHLSURLPoolInsert(AVD_HLSURLPool *pool, const char *url, AVD_UInt64 *outHash);
+const char *avdHLSURLPoolGet(AVD_HLSURLPool *pool, AVD_UInt64 hash);
 
 void avdHLSURLPoolClear(AVD_HLSURLPool *pool);
 
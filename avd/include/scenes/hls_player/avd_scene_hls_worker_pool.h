@@ -25,8 +25,8 @@ struct AVD_SceneHLSPlayer;
 
 typedef struct {
     AVD_UInt32 sourceIndex;
-    AVD_UInt32 sourcesHash;
-    AVD_UInt32 sourceUrlHash;
+    AVD_UInt64 sourcesHash;
+    AVD_UInt64 sourceUrlHash;
 } AVD_HLSSourceTaskPayload;
 
 typedef struct {
@@ -34,8 +34,8 @@ typedef struct {
     AVD_UInt32 sourceIndex;
     AVD_Float duration;
     AVD_Float refreshIntervalMs;
-    AVD_UInt32 urlHash;
-    AVD_UInt32 sourcesHash;
+    AVD_UInt64 urlHash;
+    AVD_UInt64 sourcesHash;
 } AVD_HLSMediaTaskPayload;
 
 typedef struct {
@@ -44,12 +44,12 @@ typedef struct {
     AVD_Float duration;
     char *data;
     AVD_Size dataSize;
-    AVD_UInt32 sourcesHash;
+    AVD_UInt64 sourcesHash;
 } AVD_HLSDemuxTaskPayload;
 
 typedef struct {
     AVD_HLSSegmentAVData avData;
-    AVD_UInt32 sourcesHash;
+    AVD_UInt64 sourcesHash;
 } AVD_HLSReadyPayload;
 
 typedef struct {
@@ -75,7 +75,7 @@ bool avdHLSWorkerPoolInit(AVD_HLSWorkerPool *pool, AVD_HLSURLPool *urlPool, AVD_
 void avdHLSWorkerPoolDestroy(AVD_HLSWorkerPool *pool);
 void avdHLSWorkerPoolFlush(AVD_HLSWorkerPool *pool);
 
-bool avdHLSWorkerPoolSendSourceTask(AVD_HLSWorkerPool *pool, AVD_UInt32 sourceIndex, AVD_UInt32 sourcesHash, const char *sourceUrl);
+bool avdHLSWorkerPoolSendSourceTask(AVD_HLSWorkerPool *pool, AVD_UInt32 sourceIndex, AVD_UInt64 sourcesHash, const char *sourceUrl);
 bool avdHLSWorkerPoolReceiveReadySegment(AVD_HLSWorkerPool *pool, AVD_HLSReadyPayload *outPayload);
 
 #endif // AVD_HLS_WORKER_POOL_H
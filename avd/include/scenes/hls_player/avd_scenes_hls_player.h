@@ -48,7 +48,7 @@ typedef struct AVD_SceneHLSPlayer {
 
     AVD_SceneHLSPlayerSource sources[AVD_SCENE_HLS_PLAYER_MAX_SOURCES];
     AVD_UInt32 sourceCount;
-    AVD_UInt32 sourcesHash;
+    AVD_UInt64 sourcesHash;
 
     AVD_HLSURLPool urlPool;
     AVD_HLSMediaCache mediaCache;
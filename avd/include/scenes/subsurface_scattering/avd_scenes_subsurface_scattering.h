@@ -19,6 +19,8 @@ typedef struct AVD_SceneSubsurfaceScatteringModelInfo {
 
     AVD_Vector4 lightPositionA;
     AVD_Vector4 lightPositionB;
+
+    int32_t lodLevel; // drawn last frame
 } AVD_SceneSubsurfaceScatteringModelInfo;
 
 typedef struct AVD_SceneSubsurfaceScattering {
@@ -43,6 +45,7 @@ typedef struct AVD_SceneSubsurfaceScattering {
     AVD_VulkanImage noiseTexture;
 
     AVD_VulkanBuffer vertexBuffer;
+    AVD_VulkanBuffer indexBuffer;
 
     bool bloomEnabled;
 
@@ -95,6 +98,14 @@ typedef struct AVD_SceneSubsurfaceScattering {
     float bloomSoftKnee;
     bool useScreenSpaceIrradiance;
 
+    // levels of detail picked by projected error, see avd_model_lod.h
+    bool useLods;
+    float lodMaxPixelError;
+    uint32_t drawnTriangles;
+    // averaged separately so both can be compared after toggling
+    float frameTimeLodsOff;
+    float frameTimeLodsOn;
+
     int32_t currentFocusModelIndex;
     AVD_SceneSubsurfaceScatteringModelInfo modelsInfo[3];
 
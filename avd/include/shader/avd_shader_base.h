@@ -28,6 +28,8 @@ typedef struct {
 typedef struct {
     uint32_t *compiledCode;
     size_t size;
+    // set when compiledCode points into a cached shader file instead of owned memory
+    AVD_FileView *fileView;
     AVD_ShaderStage stage;
     AVD_ShaderLanguage language;
 } AVD_ShaderCompilationResult;
@@ -41,7 +43,7 @@ typedef struct {
 } AVD_ShaderManager;
 
 bool avdShaderCompilationOptionsDefault(AVD_ShaderCompilationOptions *options);
-uint32_t avdShaderCompilationOptionsHash(const AVD_ShaderCompilationOptions *options);
+uint64_t avdShaderCompilationOptionsHash(const AVD_ShaderCompilationOptions *options);
 const char *avdShaderStageToString(AVD_ShaderStage stage);
 const char *avdShaderLanguageToString(AVD_ShaderLanguage language);
 void avdShaderCompilationResultDestroy(AVD_ShaderCompilationResult *result);
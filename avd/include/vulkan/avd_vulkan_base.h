@@ -88,6 +88,9 @@ typedef struct AVD_Vulkan {
 
     AVD_VulkanFeatures supportedFeatures;
 
+    // created without a window, surface or swapchain, see avdVulkanInitHeadless
+    bool headless;
+
 #ifdef AVD_DEBUG
     AVD_VulkanDebugger debugger;
 #endif
@@ -96,9 +99,17 @@ typedef struct AVD_Vulkan {
 AVD_Vulkan *avdVulkanGetGlobalInstance();
 
 bool avdVulkanInit(AVD_Vulkan *vulkan, AVD_Window *window, VkSurfaceKHR *surface);
+// Device for offscreen work only, such as the GPU tests. Takes any device that
+// has the required features when there is no discrete GPU, and does not need
+// GLFW or the swapchain extensions.
+bool avdVulkanInitHeadless(AVD_Vulkan *vulkan);
 void avdVulkanShutdown(AVD_Vulkan *vulkan);
 void avdVulkanWaitIdle(AVD_Vulkan *vulkan);
 void avdVulkanDestroySurface(AVD_Vulkan *vulkan, VkSurfaceKHR surface);
+// Records into a command buffer of the graphics pool, the submit ends it and
+// waits on a fence before freeing it.
+bool avdVulkanBeginOneTimeCommands(AVD_Vulkan *vulkan, VkCommandBuffer *commandBuffer, const char *label);
+bool avdVulkanSubmitOneTimeCommands(AVD_Vulkan *vulkan, VkCommandBuffer commandBuffer);
 
 bool avdVulkanInstanceLayersSupported(const char **layers, uint32_t layerCount);
 uint32_t avdVulkanFindMemoryType(AVD_Vulkan *vulkan, uint32_t typeFilter, VkMemoryPropertyFlags properties);
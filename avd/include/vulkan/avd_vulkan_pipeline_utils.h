@@ -63,6 +63,28 @@ bool avdPipelineUtilsCreateGraphicsLayoutAndPipeline(
     AVD_ShaderCompilationOptions *compilationOptions,
     AVD_VulkanPipelineCreationInfo *creationInfo);
 
+bool avdPipelineUtilsCreateComputePipelineLayout(
+    VkPipelineLayout *pipelineLayout,
+    VkDevice device,
+    VkDescriptorSetLayout *descriptorSetLayouts,
+    size_t descriptorSetLayoutCount,
+    uint32_t pushConstantSize);
+bool avdPipelineUtilsCreateComputePipeline(
+    VkPipeline *pipeline,
+    VkPipelineLayout layout,
+    VkDevice device,
+    const char *compShaderAsset,
+    AVD_ShaderCompilationOptions *compilationOptions);
+bool avdPipelineUtilsCreateComputeLayoutAndPipeline(
+    VkPipelineLayout *pipelineLayout,
+    VkPipeline *pipeline,
+    VkDevice device,
+    VkDescriptorSetLayout *descriptorSetLayouts,
+    size_t descriptorSetLayoutCount,
+    uint32_t pushConstantSize,
+    const char *compShaderAsset,
+    AVD_ShaderCompilationOptions *compilationOptions);
+
 bool avdCreateDescriptorSetLayout(
     VkDescriptorSetLayout *descriptorSetLayout,
     VkDevice device,
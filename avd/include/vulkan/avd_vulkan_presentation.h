@@ -7,6 +7,11 @@
 
 struct AVD_SceneManager;
 
+// Zones listed by the profiler overlay, the most expensive of the last frame first.
+#ifndef AVD_VULKAN_PRESENTATION_PROFILER_ZONES
+#define AVD_VULKAN_PRESENTATION_PROFILER_ZONES 12
+#endif
+
 typedef struct AVD_VulkanPresentation {
     VkPipeline pipeline;
     VkPipelineLayout pipelineLayout;
@@ -15,6 +20,11 @@ typedef struct AVD_VulkanPresentation {
     AVD_RenderableText loadingStatusText;
     AVD_FontRenderer presentationFontRenderer;
     VkDescriptorSetLayout descriptorSetLayout;
+
+#ifdef AVD_PROFILER
+    AVD_RenderableText profilerText;
+    bool profilerOverlayVisible;
+#endif
 } AVD_VulkanPresentation;
 
 bool avdVulkanPresentationInit(AVD_VulkanPresentation *presentation, AVD_Vulkan *vulkan, AVD_VulkanSwapchain *swapchain, AVD_FontManager *fontManager);
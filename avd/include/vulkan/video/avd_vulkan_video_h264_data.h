@@ -6,12 +6,20 @@
 
 #include "core/avd_aligned_buffer.h"
 #include "core/avd_core.h"
-#include "vulkan/avd_vulkan_base.h"
 
 #ifndef AVD_VULKAN_VIDEO_MAX_NAL_TEMP_BUFFER_SIZE
 #define AVD_VULKAN_VIDEO_MAX_NAL_TEMP_BUFFER_SIZE (1024 * 1024 * 16) // 16 MB
 #endif
 
+// Used when no device is given to take the bitstream alignment requirements from.
+#ifndef AVD_H264_VIDEO_DEFAULT_FRAME_DATA_ALIGNMENT
+#define AVD_H264_VIDEO_DEFAULT_FRAME_DATA_ALIGNMENT 256
+#endif
+
+// The parser itself does not need a Vulkan device, this keeps the header usable
+// from the headless test and benchmark builds.
+struct AVD_Vulkan;
+
 typedef struct {
     AVD_Size offset;
     AVD_Size size;
@@ -56,10 +64,10 @@ typedef struct {
     AVD_List sliceHeaders;
 
     picoH264PictureParameterSet *ppsArray;
-    AVD_UInt32 ppsHash;
+    AVD_UInt64 ppsHash;
 
     picoH264SequenceParameterSet *spsArray;
-    AVD_UInt32 spsHash;
+    AVD_UInt64 spsHash;
 
     AVD_H264VideoPictureOrderCountState pocState;
 
@@ -77,10 +85,10 @@ typedef struct {
 
 typedef struct {
     picoH264SequenceParameterSet sps[PICO_H264_MAX_SPS_COUNT];
-    AVD_UInt32 spsHash;
+    AVD_UInt64 spsHash;
 
     picoH264PictureParameterSet pps[PICO_H264_MAX_PPS_COUNT];
-    AVD_UInt32 ppsHash;
+    AVD_UInt64 ppsHash;
 
     AVD_List seekPoints;
 
@@ -103,9 +111,12 @@ typedef struct {
     AVD_Float timestampSinceStartSeconds;
 
     picoH264Bitstream bitstream;
+    // set when loaded from a file, the bitstream reads from it in place
+    AVD_FileView *fileView;
 } AVD_H264Video;
 
-bool avdH264VideoLoadParamsDefault(AVD_Vulkan *vulkan, AVD_H264VideoLoadParams *outParams);
+// vulkan may be NULL, headless builds always pass NULL
+bool avdH264VideoLoadParamsDefault(struct AVD_Vulkan *vulkan, AVD_H264VideoLoadParams *outParams);
 
 bool avdH264VideoLoadFromStream(picoStream stream, AVD_H264VideoLoadParams *params, AVD_H264Video **outVideo);
 bool avdH264VideoLoadFromBuffer(const uint8_t *buffer, size_t bufferSize, bool bufferOwned, AVD_H264VideoLoadParams *params, AVD_H264Video **outVideo);
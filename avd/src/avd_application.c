@@ -18,12 +18,40 @@ static void PRIV_avdApplicationUpdateFramerateCalculation(AVD_Frametime *framera
     }
 }
 
+#ifdef AVD_PROFILER
+// F3 toggles the zone overlay, F4 writes everything still buffered as a Chrome trace
+static void PRIV_avdApplicationHandleProfilerKeys(AVD_AppState *appState)
+{
+    static bool overlayKeyWasDown = false;
+    static bool traceKeyWasDown   = false;
+
+    bool overlayKeyDown = appState->input.keyState[GLFW_KEY_F3];
+    bool traceKeyDown   = appState->input.keyState[GLFW_KEY_F4];
+
+    if (overlayKeyDown && !overlayKeyWasDown) {
+        appState->presentation.profilerOverlayVisible = !appState->presentation.profilerOverlayVisible;
+    }
+    if (traceKeyDown && !traceKeyWasDown) {
+        avdProfilerWriteChromeTrace("avd_profile_trace.json");
+    }
+
+    overlayKeyWasDown = overlayKeyDown;
+    traceKeyWasDown   = traceKeyDown;
+}
+#endif
+
 bool avdApplicationInit(AVD_AppState *appState)
 {
     AVD_ASSERT(appState != NULL);
 
     appState->running = true;
 
+#ifdef AVD_PROFILER
+    // before anything that starts threads, so they can name themselves
+    AVD_CHECK(avdProfilerInit());
+#endif
+    AVD_CHECK(avdArenaFrameInit());
+    AVD_CHECK(avdJobsInit(0));
     AVD_CHECK(avdShaderManagerInit(&appState->shaderManager));
     AVD_CHECK(avdAudioInit(&appState->audio));
     AVD_CHECK(avdWindowInit(&appState->window, appState));
@@ -62,6 +90,19 @@ void avdApplicationShutdown(AVD_AppState *appState)
     avdWindowShutdown(&appState->window);
     avdAudioShutdown(&appState->audio);
     avdShaderManagerDestroy(&appState->shaderManager);
+    avdJobsShutdown();
+    avdArenaScratchThreadShutdown();
+    avdArenaFrameShutdown();
+
+#ifdef AVD_PROFILER
+    avdProfilerWriteChromeTrace("avd_profile_trace.json");
+    avdProfilerShutdown();
+#endif
+
+#ifdef AVD_MEMORY_TRACKING
+    avdMemoryReportLeaks();
+    avdMemoryWriteReport("avd_memory_report.json");
+#endif
 }
 
 bool avdApplicationIsRunning(AVD_AppState *appState)
@@ -74,8 +115,15 @@ void avdApplicationUpdate(AVD_AppState *appState)
 {
     AVD_ASSERT(appState != NULL);
 
+    AVD_PROFILE_FRAME();
+
     avdInputNewFrame(&appState->input);
-    avdWindowPollEvents();
+    AVD_PROFILE_SCOPE("Application/PollEvents") {
+        avdWindowPollEvents();
+    }
+#ifdef AVD_PROFILER
+    PRIV_avdApplicationHandleProfilerKeys(appState);
+#endif
     avdApplicationUpdateWithoutPolling(appState);
 
     // update the title of window with stats
@@ -88,9 +136,14 @@ void avdApplicationUpdate(AVD_AppState *appState)
 void avdApplicationUpdateWithoutPolling(AVD_AppState *appState)
 {
     AVD_ASSERT(appState != NULL);
+
+    // everything allocated from the frame arena during the previous frame is released here
+    avdArenaFrameReset();
     PRIV_avdApplicationUpdateFramerateCalculation(&appState->framerate);
     avdSceneManagerUpdate(&appState->sceneManager, appState);
-    avdApplicationRender(appState);
+    AVD_PROFILE_SCOPE("Application/Render") {
+        avdApplicationRender(appState);
+    }
 }
 
 void avdApplicationRender(AVD_AppState *appState)
@@ -0,0 +1,119 @@
+#include "core/avd_core.h"
+
+#include "geom/avd_bvh.h"
+#include "math/avd_math_tests.h"
+#include "model/avd_model.h"
+#include "model/avd_model_cache.h"
+#include "model/avd_model_draw.h"
+#include "model/avd_model_lod.h"
+#include "model/avd_model_meshlets.h"
+#include "model/avd_model_morph.h"
+#include "model/avd_model_obj_parser.h"
+#include "model/avd_model_optimizer.h"
+#include "model/avd_model_vertex_stream.h"
+
+// Headless micro-benchmark runner, built without GLFW or Vulkan.
+//
+//   avd_bench [--filter <substring>] [--warmup <n>] [--repetitions <n>]
+//             [--json <path>] [--baseline <path>] [--tolerance <fraction>]
+//
+// Results are written to --json (avd_bench.json by default). When a baseline
+// report from an earlier run is given, the process exits with a failure if any
+// median got slower than the tolerance allows.
+
+typedef bool (*AVD_BenchSuite)(AVD_Bench *bench);
+
+static const AVD_BenchSuite PRIV_avdBenchSuites[] = {
+    avdMathBenchmarksRun,
+    avdBvhBenchmarksRun,
+    avdModelBenchmarksRun,
+    avdModelOptimizerBenchmarksRun,
+    avdModelMeshletsBenchmarksRun,
+    avdModelLodBenchmarksRun,
+    avdModelCacheBenchmarksRun,
+    avdModelObjParserBenchmarksRun,
+    avdModelVertexStreamBenchmarksRun,
+    avdModelMorphBenchmarksRun,
+    avdModelDrawBenchmarksRun,
+    avdListBenchmarksRun,
+    avdArenaBenchmarksRun,
+    avdHashBenchmarksRun,
+    avdHashTableBenchmarksRun,
+    avdJobsBenchmarksRun,
+    avdLogBenchmarksRun,
+    avdUtilsBenchmarksRun,
+};
+
+static bool PRIV_avdBenchParseArgs(int argc, char **argv, AVD_BenchConfig *config, const char **jsonPath, const char **baselinePath, AVD_Double *tolerance)
+{
+    for (int i = 1; i < argc; i++) {
+        const char *arg   = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        AVD_CHECK_MSG(value != NULL, "Missing value for argument %s", arg);
+        i++;
+
+        if (strcmp(arg, "--filter") == 0) {
+            config->filter = value;
+        } else if (strcmp(arg, "--warmup") == 0) {
+            config->warmup = (AVD_UInt32)strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--repetitions") == 0) {
+            config->repetitions = (AVD_UInt32)strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--json") == 0) {
+            *jsonPath = value;
+        } else if (strcmp(arg, "--baseline") == 0) {
+            *baselinePath = value;
+        } else if (strcmp(arg, "--tolerance") == 0) {
+            *tolerance = strtod(value, NULL);
+        } else {
+            AVD_LOG_ERROR("Unknown argument %s", arg);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    AVD_LOG_INIT();
+
+    AVD_BenchConfig config;
+    avdBenchConfigDefault(&config);
+    const char *jsonPath     = "avd_bench.json";
+    const char *baselinePath = NULL;
+    AVD_Double tolerance     = AVD_BENCH_DEFAULT_TOLERANCE;
+
+    AVD_Bench bench;
+    if (!PRIV_avdBenchParseArgs(argc, argv, &config, &jsonPath, &baselinePath, &tolerance) || !avdBenchCreate(&bench, &config)) {
+        AVD_LOG_SHUTDOWN();
+        return EXIT_FAILURE;
+    }
+
+    AVD_LOG_INFO("Running benchmarks with %u warmup and %u measured repetitions per case", config.warmup, config.repetitions);
+
+    bool ok = true;
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(PRIV_avdBenchSuites) && ok; i++) {
+        ok = PRIV_avdBenchSuites[i](&bench);
+    }
+
+    // compare before writing so the baseline may be the same file as the output
+    AVD_Size regressions = 0;
+    if (ok && baselinePath != NULL) {
+        ok = avdBenchCompare(&bench, baselinePath, tolerance, &regressions);
+    }
+
+    ok = ok && avdBenchWriteJson(&bench, jsonPath);
+    if (ok) {
+        AVD_LOG_INFO("Wrote %zu benchmark results to %s", bench.results.count, jsonPath);
+    }
+
+    if (regressions > 0) {
+        AVD_LOG_ERROR("%zu benchmarks regressed by more than %.0f%% against %s", regressions, tolerance * 100.0, baselinePath);
+        ok = false;
+    }
+
+    avdBenchDestroy(&bench);
+    avdArenaScratchThreadShutdown();
+    AVD_LOG_SHUTDOWN();
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
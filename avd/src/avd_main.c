@@ -1,11 +1,70 @@
 #include "avd_application.h"
 
+#include "common/avd_indirect_draw.h"
+#include "common/avd_morph_blend.h"
 #include "math/avd_math_tests.h"
 
-int main()
+// Suites that need a device, run on a headless one instead of the application
+// with avd --gpu-tests [suite]. Any Vulkan driver works, e.g. lavapipe.
+typedef struct {
+    const char *name;
+    bool (*run)(AVD_Vulkan *vulkan);
+} AVD_GpuTestSuite;
+
+static const AVD_GpuTestSuite PRIV_avdGpuTestSuites[] = {
+    {"indirect_draw", avdIndirectDrawTestsRun},
+    {"morph_blend", avdMorphBlendTestsRun},
+};
+
+static int PRIV_avdRunGpuTests(const char *only)
+{
+    static AVD_Vulkan vulkan               = {0};
+    static AVD_ShaderManager shaderManager = {0};
+    if (!avdArenaFrameInit() || !avdJobsInit(0) || !avdShaderManagerInit(&shaderManager) || !avdVulkanInitHeadless(&vulkan)) {
+        AVD_LOG_ERROR("Failed to create the headless device for the GPU tests");
+        return EXIT_FAILURE;
+    }
+
+    AVD_Size ran    = 0;
+    AVD_Size failed = 0;
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(PRIV_avdGpuTestSuites); i++) {
+        if (only != NULL && strcmp(only, PRIV_avdGpuTestSuites[i].name) != 0) {
+            continue;
+        }
+
+        ran++;
+        if (!PRIV_avdGpuTestSuites[i].run(&vulkan)) {
+            AVD_LOG_ERROR("GPU test suite '%s' FAILED", PRIV_avdGpuTestSuites[i].name);
+            failed++;
+        }
+    }
+
+    if (ran == 0) {
+        AVD_LOG_ERROR("Unknown GPU test suite '%s'", only);
+        failed++;
+    } else {
+        AVD_LOG_INFO("%zu of %zu GPU test suites passed", ran - failed, ran);
+    }
+
+    avdVulkanShutdown(&vulkan);
+    avdShaderManagerDestroy(&shaderManager);
+    avdJobsShutdown();
+    avdArenaScratchThreadShutdown();
+    avdArenaFrameShutdown();
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char **argv)
 {
     AVD_LOG_INIT();
 
+    if (argc > 1 && strcmp(argv[1], "--gpu-tests") == 0) {
+        int result = PRIV_avdRunGpuTests(argc > 2 ? argv[2] : NULL);
+        AVD_LOG_SHUTDOWN();
+        return result;
+    }
+
     AVD_AppState *appState = (AVD_AppState *)malloc(sizeof(AVD_AppState));
     AVD_CHECK_MSG(appState != NULL, "Failed to allocate memory for application state\n");
     memset(appState, 0, sizeof(AVD_AppState));
@@ -14,7 +73,15 @@ int main()
     // Run tests only in debug mode for now
     AVD_CHECK(avdMathTestsRun());
     AVD_CHECK(avdListTestsRun());
+    AVD_CHECK(avdMemoryTestsRun());
+    AVD_CHECK(avdArenaTestsRun());
+    AVD_CHECK(avdHashTestsRun());
     AVD_CHECK(avdHashTableTestsRun());
+    AVD_CHECK(avdBenchTestsRun());
+    AVD_CHECK(avdJobsTestsRun());
+    AVD_CHECK(avdProfilerTestsRun());
+    AVD_CHECK(avdLogTestsRun());
+    AVD_CHECK(avdUtilsTestsRun());
     // AVD_CHECK(avdCurlUtilsTestsRun());
 #endif
 
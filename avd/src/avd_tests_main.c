@@ -0,0 +1,84 @@
+#include "core/avd_core.h"
+
+#include "geom/avd_bvh.h"
+#include "math/avd_math_tests.h"
+#include "model/avd_model.h"
+#include "model/avd_model_cache.h"
+#include "model/avd_model_draw.h"
+#include "model/avd_model_lod.h"
+#include "model/avd_model_meshlets.h"
+#include "model/avd_model_morph.h"
+#include "model/avd_model_obj_parser.h"
+#include "model/avd_model_optimizer.h"
+#include "model/avd_model_vertex_stream.h"
+
+// Headless entry point for the unit tests, built without GLFW or Vulkan so it
+// can run on machines without a GPU. Pass a suite name to only run that suite.
+
+typedef struct {
+    const char *name;
+    bool (*run)(void);
+} AVD_TestSuite;
+
+static const AVD_TestSuite PRIV_avdTestSuites[] = {
+    {"math", avdMathTestsRun},
+    {"bvh", avdBvhTestsRun},
+    {"model", avdModelTestsRun},
+    {"optimizer", avdModelOptimizerTestsRun},
+    {"meshlets", avdModelMeshletsTestsRun},
+    {"lod", avdModelLodTestsRun},
+    {"cache", avdModelCacheTestsRun},
+    {"obj", avdModelObjParserTestsRun},
+    {"vertex_stream", avdModelVertexStreamTestsRun},
+    {"morph", avdModelMorphTestsRun},
+    {"draw", avdModelDrawTestsRun},
+    {"list", avdListTestsRun},
+    {"memory", avdMemoryTestsRun},
+    {"arena", avdArenaTestsRun},
+    {"hash", avdHashTestsRun},
+    {"hashtable", avdHashTableTestsRun},
+    {"bench", avdBenchTestsRun},
+    {"jobs", avdJobsTestsRun},
+    {"profiler", avdProfilerTestsRun},
+    {"log", avdLogTestsRun},
+    {"utils", avdUtilsTestsRun},
+};
+
+int main(int argc, char **argv)
+{
+    AVD_LOG_INIT();
+
+    const char *only = argc > 1 ? argv[1] : NULL;
+
+    AVD_Size ran    = 0;
+    AVD_Size failed = 0;
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(PRIV_avdTestSuites); i++) {
+        if (only != NULL && strcmp(only, PRIV_avdTestSuites[i].name) != 0) {
+            continue;
+        }
+
+        ran++;
+        if (!PRIV_avdTestSuites[i].run()) {
+            AVD_LOG_ERROR("Test suite '%s' FAILED", PRIV_avdTestSuites[i].name);
+            failed++;
+        }
+    }
+
+    if (ran == 0) {
+        AVD_LOG_ERROR("Unknown test suite '%s'", only);
+        failed++;
+    } else {
+        AVD_LOG_INFO("%zu of %zu test suites passed", ran - failed, ran);
+    }
+
+    avdArenaScratchThreadShutdown();
+#ifdef AVD_MEMORY_TRACKING
+    if (avdMemoryReportLeaks() > 0) {
+        failed++;
+    }
+#endif
+
+    AVD_LOG_SHUTDOWN();
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
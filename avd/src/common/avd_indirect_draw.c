@@ -0,0 +1,330 @@
+#include "common/avd_indirect_draw.h"
+
+// must match [numthreads] in IndirectCullComp
+#define AVD_INDIRECT_DRAW_GROUP_SIZE 64
+
+typedef struct AVD_IndirectDrawPushConstants {
+    AVD_Vector4 frustumPlanes[AVD_FRUSTUM_PLANE_COUNT];
+
+    uint32_t instanceOffset;
+    uint32_t instanceCount;
+    uint32_t pad0;
+    uint32_t pad1;
+} AVD_IndirectDrawPushConstants;
+
+static bool PRIV_avdIndirectDrawCreateBuffers(AVD_IndirectDraw *draw, AVD_Vulkan *vulkan)
+{
+    AVD_ASSERT(draw != NULL);
+    AVD_ASSERT(vulkan != NULL);
+
+    char bufferLabel[64];
+    snprintf(bufferLabel, sizeof(bufferLabel), "IndirectDraw/%s/Instances", draw->label);
+    AVD_CHECK(avdVulkanBufferCreate(
+        vulkan,
+        &draw->instancesBuffer,
+        sizeof(AVD_DrawInstance) * draw->maxInstances * AVD_MAX_IN_FLIGHT_FRAMES,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        bufferLabel));
+    AVD_CHECK(avdVulkanBufferMap(vulkan, &draw->instancesBuffer, (void **)&draw->mappedInstances));
+
+    snprintf(bufferLabel, sizeof(bufferLabel), "IndirectDraw/%s/DrawCommands", draw->label);
+    AVD_CHECK(avdVulkanBufferCreate(
+        vulkan,
+        &draw->drawCommandsBuffer,
+        sizeof(VkDrawIndexedIndirectCommand) * draw->maxInstances,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        bufferLabel));
+
+    snprintf(bufferLabel, sizeof(bufferLabel), "IndirectDraw/%s/DrawCount", draw->label);
+    AVD_CHECK(avdVulkanBufferCreate(
+        vulkan,
+        &draw->drawCountBuffer,
+        sizeof(uint32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        bufferLabel));
+
+    snprintf(bufferLabel, sizeof(bufferLabel), "IndirectDraw/%s/Readback", draw->label);
+    AVD_CHECK(avdVulkanBufferCreate(
+        vulkan,
+        &draw->readbackBuffer,
+        sizeof(uint32_t) * AVD_MAX_IN_FLIGHT_FRAMES,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        bufferLabel));
+    AVD_CHECK(avdVulkanBufferMap(vulkan, &draw->readbackBuffer, (void **)&draw->mappedReadback));
+    memset(draw->mappedReadback, 0, sizeof(uint32_t) * AVD_MAX_IN_FLIGHT_FRAMES);
+
+#ifdef AVD_DEBUG
+    draw->verifyCommands = (AVD_DrawIndexedCommand *)AVD_MALLOC(sizeof(AVD_DrawIndexedCommand) * draw->maxInstances);
+    AVD_CHECK_MSG(draw->verifyCommands != NULL, "Failed to allocate the draw commands to verify %s", draw->label);
+#endif
+
+    return true;
+}
+
+static bool PRIV_avdIndirectDrawCreateDescriptors(AVD_IndirectDraw *draw, AVD_Vulkan *vulkan)
+{
+    AVD_ASSERT(draw != NULL);
+    AVD_ASSERT(vulkan != NULL);
+
+    // the vertex shader reads the same set for the instance of every draw
+    VkDescriptorType descriptorTypes[] = {
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // instances
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // draw commands
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // draw count
+    };
+    AVD_CHECK(avdCreateDescriptorSetLayout(
+        &draw->descriptorSetLayout,
+        vulkan->device,
+        descriptorTypes, AVD_ARRAY_COUNT(descriptorTypes),
+        VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT));
+    AVD_DEBUG_VK_SET_OBJECT_NAME(
+        VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT,
+        draw->descriptorSetLayout,
+        "[DescriptorSetLayout][Common]:IndirectDraw/%s",
+        draw->label);
+    AVD_CHECK(avdAllocateDescriptorSet(
+        vulkan->device,
+        vulkan->descriptorPool,
+        draw->descriptorSetLayout,
+        &draw->descriptorSet));
+    AVD_DEBUG_VK_SET_OBJECT_NAME(
+        VK_OBJECT_TYPE_DESCRIPTOR_SET,
+        draw->descriptorSet,
+        "[DescriptorSet][Common]:IndirectDraw/%s",
+        draw->label);
+
+    AVD_VulkanBuffer *buffers[] = {
+        &draw->instancesBuffer,
+        &draw->drawCommandsBuffer,
+        &draw->drawCountBuffer,
+    };
+    VkWriteDescriptorSet descriptorSetWrites[AVD_ARRAY_COUNT(buffers)] = {0};
+    for (uint32_t i = 0; i < AVD_ARRAY_COUNT(buffers); i++) {
+        AVD_CHECK(avdWriteBufferDescriptorSet(&descriptorSetWrites[i], draw->descriptorSet, i, &buffers[i]->descriptorBufferInfo));
+    }
+    vkUpdateDescriptorSets(vulkan->device, AVD_ARRAY_COUNT(descriptorSetWrites), descriptorSetWrites, 0, NULL);
+
+    return true;
+}
+
+bool avdIndirectDrawCreate(AVD_IndirectDraw *draw, AVD_Vulkan *vulkan, AVD_UInt32 maxInstances, const char *label)
+{
+    AVD_ASSERT(draw != NULL);
+    AVD_ASSERT(vulkan != NULL);
+    AVD_ASSERT(sizeof(AVD_DrawIndexedCommand) == sizeof(VkDrawIndexedIndirectCommand));
+
+    memset(draw, 0, sizeof(AVD_IndirectDraw));
+    snprintf(draw->label, sizeof(draw->label), "%s", label ? label : "Unnamed");
+    draw->maxInstances = AVD_MAX(maxInstances, 1);
+
+    AVD_CHECK(PRIV_avdIndirectDrawCreateBuffers(draw, vulkan));
+    AVD_CHECK(PRIV_avdIndirectDrawCreateDescriptors(draw, vulkan));
+
+    AVD_CHECK(avdPipelineUtilsCreateComputeLayoutAndPipeline(
+        &draw->pipelineLayout,
+        &draw->pipeline,
+        vulkan->device,
+        &draw->descriptorSetLayout,
+        1,
+        sizeof(AVD_IndirectDrawPushConstants),
+        "IndirectCullComp",
+        NULL));
+    AVD_DEBUG_VK_SET_OBJECT_NAME(
+        VK_OBJECT_TYPE_PIPELINE,
+        draw->pipeline,
+        "[Pipeline][Common]:IndirectDraw/%s",
+        draw->label);
+
+    return true;
+}
+
+void avdIndirectDrawDestroy(AVD_IndirectDraw *draw, AVD_Vulkan *vulkan)
+{
+    AVD_ASSERT(draw != NULL);
+    AVD_ASSERT(vulkan != NULL);
+
+    if (draw->mappedInstances != NULL) {
+        avdVulkanBufferUnmap(vulkan, &draw->instancesBuffer);
+        draw->mappedInstances = NULL;
+    }
+    if (draw->mappedReadback != NULL) {
+        avdVulkanBufferUnmap(vulkan, &draw->readbackBuffer);
+        draw->mappedReadback = NULL;
+    }
+    if (draw->verifyCommands != NULL) {
+        AVD_FREE(draw->verifyCommands);
+        draw->verifyCommands = NULL;
+    }
+
+    avdVulkanBufferDestroy(vulkan, &draw->instancesBuffer);
+    avdVulkanBufferDestroy(vulkan, &draw->drawCommandsBuffer);
+    avdVulkanBufferDestroy(vulkan, &draw->drawCountBuffer);
+    avdVulkanBufferDestroy(vulkan, &draw->readbackBuffer);
+
+    vkDestroyPipeline(vulkan->device, draw->pipeline, NULL);
+    vkDestroyPipelineLayout(vulkan->device, draw->pipelineLayout, NULL);
+    vkDestroyDescriptorSetLayout(vulkan->device, draw->descriptorSetLayout, NULL);
+}
+
+// The fence of the slot was waited on, so its draw count is final.
+static void PRIV_avdIndirectDrawReadBack(AVD_IndirectDraw *draw)
+{
+    AVD_UInt32 slot = draw->frameIndex;
+    if (!draw->slotSubmitted[slot]) {
+        return;
+    }
+
+    draw->lastDrawCount     = draw->mappedReadback[slot];
+    draw->lastInstanceCount = draw->slotInstanceCounts[slot];
+#ifdef AVD_DEBUG
+    // a box right on a plane may round the other way on the GPU, so this is
+    // only a warning
+    if (draw->lastDrawCount != draw->slotExpectedDrawCounts[slot]) {
+        draw->mismatchedFrames++;
+        AVD_LOG_WARN(
+            "Indirect draw %s drew %u of %u instances, the CPU culling expected %u",
+            draw->label,
+            draw->lastDrawCount,
+            draw->lastInstanceCount,
+            draw->slotExpectedDrawCounts[slot]);
+    }
+#endif
+}
+
+bool avdIndirectDrawCull(
+    VkCommandBuffer commandBuffer,
+    AVD_IndirectDraw *draw,
+    AVD_VulkanRenderer *renderer,
+    const AVD_DrawInstance *instances,
+    AVD_UInt32 count,
+    AVD_UInt32 generation,
+    const AVD_Matrix4x4 *viewProjection)
+{
+    AVD_ASSERT(commandBuffer != VK_NULL_HANDLE);
+    AVD_ASSERT(draw != NULL);
+    AVD_ASSERT(renderer != NULL);
+    AVD_ASSERT(instances != NULL || count == 0);
+    AVD_ASSERT(viewProjection != NULL);
+
+    AVD_CHECK_MSG(count <= draw->maxInstances, "Indirect draw %s has only room for %u instances", draw->label, draw->maxInstances);
+
+    draw->frameIndex    = renderer->currentFrameIndex;
+    draw->instanceCount = count;
+    PRIV_avdIndirectDrawReadBack(draw);
+
+    AVD_UInt32 slot                = draw->frameIndex;
+    AVD_UInt32 instanceOffset      = avdIndirectDrawInstanceOffset(draw);
+    AVD_Frustum frustum            = avdFrustumFromMatrix(viewProjection);
+    bool stale                     = !draw->slotSubmitted[slot] || draw->slotGenerations[slot] != generation || draw->slotInstanceCounts[slot] != count;
+    draw->slotGenerations[slot]    = generation;
+    draw->slotInstanceCounts[slot] = count;
+    draw->slotSubmitted[slot]      = true;
+    if (stale && count > 0) {
+        memcpy(draw->mappedInstances + instanceOffset, instances, sizeof(AVD_DrawInstance) * count);
+    }
+#ifdef AVD_DEBUG
+    draw->slotExpectedDrawCounts[slot] = avdDrawInstancesCull(instances, count, &frustum, draw->verifyCommands);
+#endif
+
+    AVD_DEBUG_VK_CMD_BEGIN_LABEL(
+        commandBuffer,
+        AVD_INDIRECT_DRAW_LABEL_COLOR,
+        "[Cmd][Common]:IndirectDraw/%s",
+        draw->label);
+
+    // the previous frame may still draw from the commands and the count
+    VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 1, &barrier, 0, NULL, 0, NULL);
+
+    vkCmdFillBuffer(commandBuffer, draw->drawCountBuffer.buffer, 0, VK_WHOLE_SIZE, 0);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 1, &barrier, 0, NULL, 0, NULL);
+
+    if (count > 0) {
+        AVD_IndirectDrawPushConstants pushConstants = {
+            .instanceOffset = instanceOffset,
+            .instanceCount  = count,
+        };
+        for (int i = 0; i < AVD_FRUSTUM_PLANE_COUNT; i++) {
+            const AVD_Plane *plane         = &frustum.planes[i];
+            pushConstants.frustumPlanes[i] = avdVec4(plane->normal.x, plane->normal.y, plane->normal.z, plane->distance);
+        }
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, draw->pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, draw->pipelineLayout, 0, 1, &draw->descriptorSet, 0, NULL);
+        vkCmdPushConstants(commandBuffer, draw->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+        vkCmdDispatch(commandBuffer, (count + AVD_INDIRECT_DRAW_GROUP_SIZE - 1) / AVD_INDIRECT_DRAW_GROUP_SIZE, 1, 1);
+    }
+
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 1, &barrier, 0, NULL, 0, NULL);
+
+    // the count of this frame into its readback slot, read the next time the
+    // slot comes around
+    VkBufferCopy region = {
+        .srcOffset = 0,
+        .dstOffset = sizeof(uint32_t) * slot,
+        .size      = sizeof(uint32_t),
+    };
+    vkCmdCopyBuffer(commandBuffer, draw->drawCountBuffer.buffer, draw->readbackBuffer.buffer, 1, &region);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_HOST_BIT,
+        0, 1, &barrier, 0, NULL, 0, NULL);
+
+    AVD_DEBUG_VK_CMD_END_LABEL(commandBuffer);
+
+    return true;
+}
+
+AVD_UInt32 avdIndirectDrawInstanceOffset(const AVD_IndirectDraw *draw)
+{
+    AVD_ASSERT(draw != NULL);
+    return draw->frameIndex * draw->maxInstances;
+}
+
+void avdIndirectDrawDraw(VkCommandBuffer commandBuffer, AVD_IndirectDraw *draw)
+{
+    AVD_ASSERT(commandBuffer != VK_NULL_HANDLE);
+    AVD_ASSERT(draw != NULL);
+
+    if (draw->instanceCount == 0) {
+        return;
+    }
+
+    vkCmdDrawIndexedIndirectCount(
+        commandBuffer,
+        draw->drawCommandsBuffer.buffer,
+        0,
+        draw->drawCountBuffer.buffer,
+        0,
+        draw->instanceCount,
+        sizeof(VkDrawIndexedIndirectCommand));
+}
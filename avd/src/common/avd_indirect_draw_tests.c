@@ -0,0 +1,223 @@
+#include "common/avd_indirect_draw.h"
+
+// Boxes on a grid in the xz plane culled on the GPU from two cameras, the
+// count and the commands read back have to match avdDrawInstancesCull. Boxes
+// within AVD_INDIRECT_DRAW_TEST_EPSILON of a plane are left out, the GPU may
+// round those the other way.
+#define AVD_INDIRECT_DRAW_TEST_GRID_SIZE 48
+#define AVD_INDIRECT_DRAW_TEST_SPACING   3.0f
+#define AVD_INDIRECT_DRAW_TEST_EPSILON   1e-2f
+#define AVD_INDIRECT_DRAW_TEST_CAMERAS   2
+
+typedef struct {
+    AVD_DrawInstance *instances;
+    AVD_UInt32 count;
+    AVD_Matrix4x4 viewProjections[AVD_INDIRECT_DRAW_TEST_CAMERAS];
+    AVD_Frustum frustums[AVD_INDIRECT_DRAW_TEST_CAMERAS];
+
+    AVD_IndirectDraw draw;
+    AVD_VulkanBuffer commandsReadback;
+    AVD_DrawIndexedCommand *mappedCommands;
+    AVD_DrawIndexedCommand *expectedCommands;
+} AVD_IndirectDrawTest;
+
+// Only the frame index is read by the culling.
+static AVD_VulkanRenderer PRIV_avdIndirectDrawTestRenderer = {0};
+
+static AVD_Float PRIV_avdIndirectDrawTestMargin(const AVD_DrawInstance *instance, const AVD_Frustum *frustum)
+{
+    AVD_Vector3 center = avdVec3(instance->center[0], instance->center[1], instance->center[2]);
+    AVD_Float margin   = FLT_MAX;
+    for (int plane = 0; plane < AVD_FRUSTUM_PLANE_COUNT; plane++) {
+        AVD_Vector3 normal = frustum->planes[plane].normal;
+        AVD_Float radius   = avdAbs(normal.x) * instance->extents[0] + avdAbs(normal.y) * instance->extents[1] + avdAbs(normal.z) * instance->extents[2];
+        margin             = avdMin(margin, avdPlaneDistance(&frustum->planes[plane], center) + radius);
+    }
+    return margin;
+}
+
+static bool PRIV_avdIndirectDrawTestCreate(AVD_IndirectDrawTest *test)
+{
+    AVD_Float extent                                 = (AVD_Float)AVD_INDIRECT_DRAW_TEST_GRID_SIZE * AVD_INDIRECT_DRAW_TEST_SPACING * 0.5f;
+    AVD_Matrix4x4 projection                         = avdMatPerspective(avdDeg2Rad(60.0f), 16.0f / 9.0f, 0.1f, extent * 1.5f);
+    AVD_Vector3 eyes[AVD_INDIRECT_DRAW_TEST_CAMERAS] = {
+        avdVec3(0.0f, extent * 0.3f, extent * 1.2f),
+        avdVec3(extent * 1.1f, extent * 0.6f, -extent * 0.4f),
+    };
+    for (AVD_UInt32 camera = 0; camera < AVD_INDIRECT_DRAW_TEST_CAMERAS; camera++) {
+        AVD_Matrix4x4 view            = avdMatLookAt(eyes[camera], avdVec3Zero(), avdVec3(0.0f, 1.0f, 0.0f));
+        test->viewProjections[camera] = avdMat4x4Multiply(projection, view);
+        test->frustums[camera]        = avdFrustumFromMatrix(&test->viewProjections[camera]);
+    }
+
+    AVD_UInt32 size  = AVD_INDIRECT_DRAW_TEST_GRID_SIZE;
+    AVD_Float offset = (AVD_Float)(size - 1) * AVD_INDIRECT_DRAW_TEST_SPACING * 0.5f;
+    test->instances  = (AVD_DrawInstance *)AVD_MALLOC(sizeof(AVD_DrawInstance) * size * size);
+    test->count      = 0;
+    AVD_CHECK_MSG(test->instances != NULL, "Failed to allocate the indirect draw test instances");
+    for (AVD_UInt32 z = 0; z < size; z++) {
+        for (AVD_UInt32 x = 0; x < size; x++) {
+            AVD_Float halfSize        = 0.5f + 0.25f * (AVD_Float)((x + z) % 3);
+            AVD_DrawInstance instance = {
+                .modelMatrix = avdMat4x4Identity(),
+                .center      = {(AVD_Float)x * AVD_INDIRECT_DRAW_TEST_SPACING - offset, halfSize, (AVD_Float)z * AVD_INDIRECT_DRAW_TEST_SPACING - offset},
+                .firstIndex  = 36 * ((z * size + x) % 5),
+                .extents     = {halfSize, halfSize, halfSize},
+                .indexCount  = 36 * (1 + (x + 2 * z) % 3),
+                .node        = (int32_t)(z * size + x),
+            };
+
+            bool ambiguous = false;
+            for (AVD_UInt32 camera = 0; camera < AVD_INDIRECT_DRAW_TEST_CAMERAS; camera++) {
+                ambiguous = ambiguous || avdAbs(PRIV_avdIndirectDrawTestMargin(&instance, &test->frustums[camera])) < AVD_INDIRECT_DRAW_TEST_EPSILON;
+            }
+            if (!ambiguous) {
+                test->instances[test->count++] = instance;
+            }
+        }
+    }
+
+    test->expectedCommands = (AVD_DrawIndexedCommand *)AVD_MALLOC(sizeof(AVD_DrawIndexedCommand) * test->count);
+    AVD_CHECK_MSG(test->expectedCommands != NULL, "Failed to allocate the expected indirect draw commands");
+    return true;
+}
+
+static void PRIV_avdIndirectDrawTestDestroy(AVD_IndirectDrawTest *test, AVD_Vulkan *vulkan)
+{
+    avdIndirectDrawDestroy(&test->draw, vulkan);
+    if (test->mappedCommands != NULL) {
+        avdVulkanBufferUnmap(vulkan, &test->commandsReadback);
+    }
+    avdVulkanBufferDestroy(vulkan, &test->commandsReadback);
+    if (test->expectedCommands != NULL) {
+        AVD_FREE(test->expectedCommands);
+    }
+    if (test->instances != NULL) {
+        AVD_FREE(test->instances);
+    }
+}
+
+// Culls in slot 0 and copies the commands out, the cull itself copies the
+// count into the readback slot. Both are final once the fence signaled.
+static bool PRIV_avdIndirectDrawTestFrame(AVD_IndirectDrawTest *test, AVD_Vulkan *vulkan, AVD_UInt32 camera)
+{
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    AVD_CHECK(avdVulkanBeginOneTimeCommands(vulkan, &commandBuffer, "IndirectDrawTest"));
+
+    bool culled = avdIndirectDrawCull(
+        commandBuffer,
+        &test->draw,
+        &PRIV_avdIndirectDrawTestRenderer,
+        test->instances,
+        test->count,
+        1,
+        &test->viewProjections[camera]);
+
+    // the cull already made the commands visible to transfers
+    VkBufferCopy region = {
+        .srcOffset = 0,
+        .dstOffset = 0,
+        .size      = sizeof(AVD_DrawIndexedCommand) * test->count,
+    };
+    vkCmdCopyBuffer(commandBuffer, test->draw.drawCommandsBuffer.buffer, test->commandsReadback.buffer, 1, &region);
+
+    VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_HOST_BIT,
+        0, 1, &barrier, 0, NULL, 0, NULL);
+
+    AVD_CHECK(avdVulkanSubmitOneTimeCommands(vulkan, commandBuffer));
+    AVD_CHECK(culled);
+    return true;
+}
+
+static int PRIV_avdIndirectDrawTestCompareCommands(const void *a, const void *b)
+{
+    AVD_UInt32 first  = ((const AVD_DrawIndexedCommand *)a)->firstInstance;
+    AVD_UInt32 second = ((const AVD_DrawIndexedCommand *)b)->firstInstance;
+    return (first > second) - (first < second);
+}
+
+// The commands are appended in whatever order the threads ran, the CPU
+// writes them in instance order.
+static bool PRIV_avdIndirectDrawTestCheck(AVD_IndirectDrawTest *test, AVD_UInt32 camera)
+{
+    AVD_UInt32 drawCount     = test->draw.mappedReadback[0];
+    AVD_UInt32 expectedCount = avdDrawInstancesCull(test->instances, test->count, &test->frustums[camera], test->expectedCommands);
+    AVD_CHECK_MSG(expectedCount > 0 && expectedCount < test->count, "Camera %u sees %u of %u instances, the test needs some culled and some visible", camera, expectedCount, test->count);
+    AVD_CHECK_MSG(drawCount == expectedCount, "Camera %u: the GPU drew %u of %u instances, the CPU culling expected %u", camera, drawCount, test->count, expectedCount);
+
+    qsort(test->mappedCommands, drawCount, sizeof(AVD_DrawIndexedCommand), PRIV_avdIndirectDrawTestCompareCommands);
+    for (AVD_UInt32 i = 0; i < drawCount; i++) {
+        const AVD_DrawIndexedCommand *command  = &test->mappedCommands[i];
+        const AVD_DrawIndexedCommand *expected = &test->expectedCommands[i];
+        AVD_CHECK_MSG(
+            memcmp(command, expected, sizeof(AVD_DrawIndexedCommand)) == 0,
+            "Camera %u: command %u is {%u, %u, %u, %d, %u}, expected {%u, %u, %u, %d, %u}",
+            camera,
+            i,
+            command->indexCount,
+            command->instanceCount,
+            command->firstIndex,
+            command->vertexOffset,
+            command->firstInstance,
+            expected->indexCount,
+            expected->instanceCount,
+            expected->firstIndex,
+            expected->vertexOffset,
+            expected->firstInstance);
+    }
+    return true;
+}
+
+static bool PRIV_avdIndirectDrawTestReadback(AVD_IndirectDrawTest *test, AVD_Vulkan *vulkan)
+{
+    AVD_CHECK(avdIndirectDrawCreate(&test->draw, vulkan, test->count, "Test"));
+    AVD_CHECK(avdVulkanBufferCreate(
+        vulkan,
+        &test->commandsReadback,
+        sizeof(AVD_DrawIndexedCommand) * test->count,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        "IndirectDraw/Test/CommandsReadback"));
+    AVD_CHECK(avdVulkanBufferMap(vulkan, &test->commandsReadback, (void **)&test->mappedCommands));
+
+    AVD_CHECK(PRIV_avdIndirectDrawTestFrame(test, vulkan, 0));
+    AVD_CHECK(PRIV_avdIndirectDrawTestCheck(test, 0));
+    AVD_UInt32 firstDrawCount = test->draw.mappedReadback[0];
+
+    // same slot and generation again, the instances stay in place and the
+    // cull reads back the count of the first frame
+    AVD_CHECK(PRIV_avdIndirectDrawTestFrame(test, vulkan, 1));
+    AVD_CHECK_MSG(
+        test->draw.lastDrawCount == firstDrawCount && test->draw.lastInstanceCount == test->count,
+        "The second cull read back %u of %u instances, the first frame drew %u of %u",
+        test->draw.lastDrawCount,
+        test->draw.lastInstanceCount,
+        firstDrawCount,
+        test->count);
+    AVD_CHECK(PRIV_avdIndirectDrawTestCheck(test, 1));
+#ifdef AVD_DEBUG
+    AVD_CHECK_MSG(test->draw.mismatchedFrames == 0, "The indirect draw counted %u mismatched frames", test->draw.mismatchedFrames);
+#endif
+    return true;
+}
+
+bool avdIndirectDrawTestsRun(AVD_Vulkan *vulkan)
+{
+    AVD_LOG_DEBUG("Running AVD Indirect Draw Tests...");
+
+    AVD_IndirectDrawTest test = {0};
+    bool ok                   = PRIV_avdIndirectDrawTestCreate(&test) && PRIV_avdIndirectDrawTestReadback(&test, vulkan);
+    PRIV_avdIndirectDrawTestDestroy(&test, vulkan);
+    AVD_CHECK(ok);
+
+    AVD_LOG_DEBUG("All AVD Indirect Draw Tests PASSED");
+    return true;
+}
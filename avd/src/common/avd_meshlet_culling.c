@@ -0,0 +1,347 @@
+#include "common/avd_meshlet_culling.h"
+
+// must match [numthreads] in MeshletCullComp
+#define AVD_MESHLET_CULLING_GROUP_SIZE 64
+
+typedef struct AVD_MeshletCullingPushConstants {
+    AVD_Matrix4x4 modelMatrix;
+    AVD_Vector4 frustumPlanes[AVD_FRUSTUM_PLANE_COUNT];
+    AVD_Vector4 cameraPosition;
+
+    uint32_t meshletOffset;
+    uint32_t meshletCount;
+    uint32_t drawIndex;
+    uint32_t visibleOffset;
+
+    uint32_t statsIndex;
+    uint32_t flags;
+    uint32_t pad0;
+    uint32_t pad1;
+} AVD_MeshletCullingPushConstants;
+
+static bool PRIV_avdMeshletCullingUploadList(
+    AVD_Vulkan *vulkan,
+    AVD_VulkanBuffer *buffer,
+    const AVD_List *dataList,
+    const char *label,
+    const char *name)
+{
+    AVD_CHECK_MSG(dataList->count > 0, "Meshlet culling %s has no %s, load the model with the meshlets flag", label, name);
+
+    char bufferLabel[64];
+    snprintf(bufferLabel, sizeof(bufferLabel), "MeshletCulling/%s/%s", label, name);
+
+    AVD_Size size = dataList->count * dataList->itemSize;
+    AVD_CHECK(avdVulkanBufferCreate(
+        vulkan,
+        buffer,
+        size,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        bufferLabel));
+    AVD_CHECK(avdVulkanBufferUpload(vulkan, buffer, dataList->items, size));
+    return true;
+}
+
+static bool PRIV_avdMeshletCullingCreateBuffers(AVD_MeshletCulling *culling, AVD_Vulkan *vulkan, const AVD_ModelResources *resources)
+{
+    AVD_ASSERT(culling != NULL);
+    AVD_ASSERT(vulkan != NULL);
+    AVD_ASSERT(resources != NULL);
+
+    AVD_CHECK(PRIV_avdMeshletCullingUploadList(vulkan, &culling->meshletsBuffer, &resources->meshletsList, culling->label, "Meshlets"));
+    AVD_CHECK(PRIV_avdMeshletCullingUploadList(vulkan, &culling->meshletVerticesBuffer, &resources->meshletVerticesList, culling->label, "Vertices"));
+    AVD_CHECK(PRIV_avdMeshletCullingUploadList(vulkan, &culling->meshletTrianglesBuffer, &resources->meshletTrianglesList, culling->label, "Triangles"));
+
+    char bufferLabel[64];
+    snprintf(bufferLabel, sizeof(bufferLabel), "MeshletCulling/%s/Visible", culling->label);
+    AVD_CHECK(avdVulkanBufferCreate(
+        vulkan,
+        &culling->visibleMeshletsBuffer,
+        sizeof(uint32_t) * culling->maxVisibleMeshlets,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        bufferLabel));
+
+    snprintf(bufferLabel, sizeof(bufferLabel), "MeshletCulling/%s/DrawCommands", culling->label);
+    AVD_CHECK(avdVulkanBufferCreate(
+        vulkan,
+        &culling->drawCommandsBuffer,
+        sizeof(VkDrawIndirectCommand) * culling->maxDraws,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        bufferLabel));
+
+    snprintf(bufferLabel, sizeof(bufferLabel), "MeshletCulling/%s/Stats", culling->label);
+    AVD_CHECK(avdVulkanBufferCreate(
+        vulkan,
+        &culling->statsBuffer,
+        sizeof(AVD_MeshletCullingStats) * AVD_MAX_IN_FLIGHT_FRAMES,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        bufferLabel));
+    AVD_CHECK(avdVulkanBufferMap(vulkan, &culling->statsBuffer, (void **)&culling->mappedStats));
+    memset(culling->mappedStats, 0, sizeof(AVD_MeshletCullingStats) * AVD_MAX_IN_FLIGHT_FRAMES);
+
+    return true;
+}
+
+static bool PRIV_avdMeshletCullingCreateDescriptors(AVD_MeshletCulling *culling, AVD_Vulkan *vulkan)
+{
+    AVD_ASSERT(culling != NULL);
+    AVD_ASSERT(vulkan != NULL);
+
+    // the vertex shader reads the same set to expand the visible meshlets
+    VkDescriptorType descriptorTypes[] = {
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // meshlets
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // meshlet vertices
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // meshlet triangles
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // visible meshlets
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // draw commands
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // stats
+    };
+    AVD_CHECK(avdCreateDescriptorSetLayout(
+        &culling->descriptorSetLayout,
+        vulkan->device,
+        descriptorTypes, AVD_ARRAY_COUNT(descriptorTypes),
+        VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT));
+    AVD_DEBUG_VK_SET_OBJECT_NAME(
+        VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT,
+        culling->descriptorSetLayout,
+        "[DescriptorSetLayout][Common]:MeshletCulling/%s",
+        culling->label);
+    AVD_CHECK(avdAllocateDescriptorSet(
+        vulkan->device,
+        vulkan->descriptorPool,
+        culling->descriptorSetLayout,
+        &culling->descriptorSet));
+    AVD_DEBUG_VK_SET_OBJECT_NAME(
+        VK_OBJECT_TYPE_DESCRIPTOR_SET,
+        culling->descriptorSet,
+        "[DescriptorSet][Common]:MeshletCulling/%s",
+        culling->label);
+
+    AVD_VulkanBuffer *buffers[] = {
+        &culling->meshletsBuffer,
+        &culling->meshletVerticesBuffer,
+        &culling->meshletTrianglesBuffer,
+        &culling->visibleMeshletsBuffer,
+        &culling->drawCommandsBuffer,
+        &culling->statsBuffer,
+    };
+    VkWriteDescriptorSet descriptorSetWrites[AVD_ARRAY_COUNT(buffers)] = {0};
+    for (uint32_t i = 0; i < AVD_ARRAY_COUNT(buffers); i++) {
+        AVD_CHECK(avdWriteBufferDescriptorSet(&descriptorSetWrites[i], culling->descriptorSet, i, &buffers[i]->descriptorBufferInfo));
+    }
+    vkUpdateDescriptorSets(vulkan->device, AVD_ARRAY_COUNT(descriptorSetWrites), descriptorSetWrites, 0, NULL);
+
+    return true;
+}
+
+bool avdMeshletCullingCreate(
+    AVD_MeshletCulling *culling,
+    AVD_Vulkan *vulkan,
+    const AVD_ModelResources *resources,
+    AVD_UInt32 maxDraws,
+    AVD_UInt32 maxVisibleMeshlets,
+    const char *label)
+{
+    AVD_ASSERT(culling != NULL);
+    AVD_ASSERT(vulkan != NULL);
+    AVD_ASSERT(resources != NULL);
+
+    memset(culling, 0, sizeof(AVD_MeshletCulling));
+    snprintf(culling->label, sizeof(culling->label), "%s", label ? label : "Unnamed");
+    culling->maxDraws           = AVD_MAX(maxDraws, 1);
+    culling->maxVisibleMeshlets = AVD_MAX(maxVisibleMeshlets, 1);
+    culling->flags              = AVD_MESHLET_CULLING_FLAG_ALL;
+
+    AVD_CHECK(PRIV_avdMeshletCullingCreateBuffers(culling, vulkan, resources));
+    AVD_CHECK(PRIV_avdMeshletCullingCreateDescriptors(culling, vulkan));
+
+    AVD_CHECK(avdPipelineUtilsCreateComputeLayoutAndPipeline(
+        &culling->pipelineLayout,
+        &culling->pipeline,
+        vulkan->device,
+        &culling->descriptorSetLayout,
+        1,
+        sizeof(AVD_MeshletCullingPushConstants),
+        "MeshletCullComp",
+        NULL));
+    AVD_DEBUG_VK_SET_OBJECT_NAME(
+        VK_OBJECT_TYPE_PIPELINE,
+        culling->pipeline,
+        "[Pipeline][Common]:MeshletCulling/%s",
+        culling->label);
+
+    return true;
+}
+
+void avdMeshletCullingDestroy(AVD_MeshletCulling *culling, AVD_Vulkan *vulkan)
+{
+    AVD_ASSERT(culling != NULL);
+    AVD_ASSERT(vulkan != NULL);
+
+    if (culling->mappedStats != NULL) {
+        avdVulkanBufferUnmap(vulkan, &culling->statsBuffer);
+        culling->mappedStats = NULL;
+    }
+
+    avdVulkanBufferDestroy(vulkan, &culling->meshletsBuffer);
+    avdVulkanBufferDestroy(vulkan, &culling->meshletVerticesBuffer);
+    avdVulkanBufferDestroy(vulkan, &culling->meshletTrianglesBuffer);
+    avdVulkanBufferDestroy(vulkan, &culling->visibleMeshletsBuffer);
+    avdVulkanBufferDestroy(vulkan, &culling->drawCommandsBuffer);
+    avdVulkanBufferDestroy(vulkan, &culling->statsBuffer);
+
+    vkDestroyPipeline(vulkan->device, culling->pipeline, NULL);
+    vkDestroyPipelineLayout(vulkan->device, culling->pipelineLayout, NULL);
+    vkDestroyDescriptorSetLayout(vulkan->device, culling->descriptorSetLayout, NULL);
+}
+
+bool avdMeshletCullingBegin(
+    VkCommandBuffer commandBuffer,
+    AVD_MeshletCulling *culling,
+    AVD_VulkanRenderer *renderer,
+    const AVD_Matrix4x4 *viewProjection,
+    AVD_Vector3 cameraPosition,
+    AVD_UInt32 flags)
+{
+    AVD_ASSERT(commandBuffer != VK_NULL_HANDLE);
+    AVD_ASSERT(culling != NULL);
+    AVD_ASSERT(renderer != NULL);
+    AVD_ASSERT(viewProjection != NULL);
+
+    culling->frustum        = avdFrustumFromMatrix(viewProjection);
+    culling->cameraPosition = cameraPosition;
+    culling->flags          = flags;
+    culling->frameIndex     = renderer->currentFrameIndex;
+    culling->visibleCursor  = 0;
+    culling->testedMeshlets = 0;
+
+    // the fence of this frame was waited on, its slot holds the counts of the
+    // last time it was submitted
+    culling->lastStats                        = culling->mappedStats[culling->frameIndex];
+    culling->mappedStats[culling->frameIndex] = (AVD_MeshletCullingStats){0};
+
+    AVD_DEBUG_VK_CMD_BEGIN_LABEL(
+        commandBuffer,
+        AVD_MESHLET_CULLING_LABEL_COLOR,
+        "[Cmd][Common]:MeshletCulling/%s",
+        culling->label);
+
+    // the previous frame may still draw from the commands and visible lists
+    VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 1, &barrier, 0, NULL, 0, NULL);
+
+    vkCmdFillBuffer(commandBuffer, culling->drawCommandsBuffer.buffer, 0, VK_WHOLE_SIZE, 0);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 1, &barrier, 0, NULL, 0, NULL);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, culling->pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, culling->pipelineLayout, 0, 1, &culling->descriptorSet, 0, NULL);
+
+    return true;
+}
+
+bool avdMeshletCullingDispatch(
+    VkCommandBuffer commandBuffer,
+    AVD_MeshletCulling *culling,
+    const AVD_Mesh *mesh,
+    const AVD_Matrix4x4 *modelMatrix,
+    AVD_UInt32 drawIndex,
+    AVD_UInt32 *visibleOffset)
+{
+    AVD_ASSERT(commandBuffer != VK_NULL_HANDLE);
+    AVD_ASSERT(culling != NULL);
+    AVD_ASSERT(mesh != NULL);
+    AVD_ASSERT(modelMatrix != NULL);
+    AVD_ASSERT(visibleOffset != NULL);
+
+    AVD_UInt32 meshletCount = (AVD_UInt32)AVD_MAX(mesh->meshletCount, 0);
+    AVD_CHECK_MSG(drawIndex < culling->maxDraws, "Meshlet culling %s has only %u draws", culling->label, culling->maxDraws);
+    AVD_CHECK_MSG(
+        culling->visibleCursor + meshletCount <= culling->maxVisibleMeshlets,
+        "Meshlet culling %s ran out of visible meshlet slots (%u)",
+        culling->label,
+        culling->maxVisibleMeshlets);
+
+    *visibleOffset = culling->visibleCursor;
+    if (meshletCount == 0) {
+        return true;
+    }
+
+    AVD_MeshletCullingPushConstants pushConstants = {
+        .modelMatrix    = *modelMatrix,
+        .cameraPosition = avdVec4(culling->cameraPosition.x, culling->cameraPosition.y, culling->cameraPosition.z, 1.0f),
+        .meshletOffset  = (uint32_t)mesh->meshletOffset,
+        .meshletCount   = meshletCount,
+        .drawIndex      = drawIndex,
+        .visibleOffset  = culling->visibleCursor,
+        .statsIndex     = culling->frameIndex,
+        .flags          = culling->flags,
+    };
+    for (int i = 0; i < AVD_FRUSTUM_PLANE_COUNT; i++) {
+        const AVD_Plane *plane         = &culling->frustum.planes[i];
+        pushConstants.frustumPlanes[i] = avdVec4(plane->normal.x, plane->normal.y, plane->normal.z, plane->distance);
+    }
+
+    vkCmdPushConstants(commandBuffer, culling->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+    vkCmdDispatch(commandBuffer, (meshletCount + AVD_MESHLET_CULLING_GROUP_SIZE - 1) / AVD_MESHLET_CULLING_GROUP_SIZE, 1, 1);
+
+    culling->visibleCursor += meshletCount;
+    culling->testedMeshlets += meshletCount;
+    return true;
+}
+
+bool avdMeshletCullingEnd(VkCommandBuffer commandBuffer, AVD_MeshletCulling *culling)
+{
+    AVD_ASSERT(commandBuffer != VK_NULL_HANDLE);
+    AVD_ASSERT(culling != NULL);
+
+    // the tested count is known on the CPU, the shader only adds the others
+    culling->mappedStats[culling->frameIndex].testedMeshlets = culling->testedMeshlets;
+
+    VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_HOST_READ_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+        0, 1, &barrier, 0, NULL, 0, NULL);
+
+    AVD_DEBUG_VK_CMD_END_LABEL(commandBuffer);
+
+    return true;
+}
+
+void avdMeshletCullingDraw(VkCommandBuffer commandBuffer, AVD_MeshletCulling *culling, AVD_UInt32 drawIndex)
+{
+    AVD_ASSERT(commandBuffer != VK_NULL_HANDLE);
+    AVD_ASSERT(culling != NULL);
+    AVD_ASSERT(drawIndex < culling->maxDraws);
+
+    vkCmdDrawIndirect(
+        commandBuffer,
+        culling->drawCommandsBuffer.buffer,
+        sizeof(VkDrawIndirectCommand) * drawIndex,
+        1,
+        sizeof(VkDrawIndirectCommand));
+}
@@ -0,0 +1,349 @@
+#include "common/avd_morph_blend.h"
+
+// must match [numthreads] in MorphBlendComp
+#define AVD_MORPH_BLEND_GROUP_SIZE 64
+
+// int32 sums per vertex, position xyz and normal xyz
+#define AVD_MORPH_BLEND_ACCUMULATORS 6
+
+typedef enum AVD_MorphBlendPass {
+    AVD_MORPH_BLEND_PASS_ACCUMULATE = 0,
+    AVD_MORPH_BLEND_PASS_RESOLVE,
+} AVD_MorphBlendPass;
+
+typedef struct AVD_MorphBlendPushConstants {
+    uint32_t activeOffset;
+    uint32_t activeCount;
+    uint32_t vertexOffset;
+    uint32_t vertexCount;
+
+    uint32_t accumulatorOffset; // in vertices
+    uint32_t pass;
+    uint32_t pad0;
+    uint32_t pad1;
+} AVD_MorphBlendPushConstants;
+
+static bool PRIV_avdMorphBlendUploadList(
+    AVD_Vulkan *vulkan,
+    AVD_VulkanBuffer *buffer,
+    const AVD_List *dataList,
+    VkBufferUsageFlags usage,
+    const char *label,
+    const char *name)
+{
+    AVD_CHECK_MSG(dataList->count > 0, "Morph blend %s has no %s, the model has no morph targets", label, name);
+
+    char bufferLabel[64];
+    snprintf(bufferLabel, sizeof(bufferLabel), "MorphBlend/%s/%s", label, name);
+
+    AVD_Size size = dataList->count * dataList->itemSize;
+    AVD_CHECK(avdVulkanBufferCreate(
+        vulkan,
+        buffer,
+        size,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        bufferLabel));
+    AVD_CHECK(avdVulkanBufferUpload(vulkan, buffer, dataList->items, size));
+    return true;
+}
+
+static bool PRIV_avdMorphBlendCreateBuffers(AVD_MorphBlend *blend, AVD_Vulkan *vulkan, const AVD_ModelResources *resources)
+{
+    AVD_ASSERT(blend != NULL);
+    AVD_ASSERT(vulkan != NULL);
+    AVD_ASSERT(resources != NULL);
+
+    AVD_CHECK(PRIV_avdMorphBlendUploadList(vulkan, &blend->baseVerticesBuffer, &resources->verticesList, 0, blend->label, "BaseVertices"));
+    // starts out as the base vertices so that meshes that are not blended draw as they are,
+    // a transfer source for the readback of the GPU tests
+    AVD_CHECK(PRIV_avdMorphBlendUploadList(vulkan, &blend->deformedVerticesBuffer, &resources->verticesList, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, blend->label, "DeformedVertices"));
+    AVD_CHECK(PRIV_avdMorphBlendUploadList(vulkan, &blend->morphTargetsBuffer, &resources->morphTargetsList, 0, blend->label, "Targets"));
+    AVD_CHECK(PRIV_avdMorphBlendUploadList(vulkan, &blend->morphDeltasBuffer, &resources->morphDeltasList, 0, blend->label, "Deltas"));
+
+    char bufferLabel[64];
+    snprintf(bufferLabel, sizeof(bufferLabel), "MorphBlend/%s/Accumulators", blend->label);
+    AVD_CHECK(avdVulkanBufferCreate(
+        vulkan,
+        &blend->accumulatorsBuffer,
+        sizeof(AVD_Int32) * AVD_MORPH_BLEND_ACCUMULATORS * blend->maxMorphVertices,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        bufferLabel));
+
+    snprintf(bufferLabel, sizeof(bufferLabel), "MorphBlend/%s/ActiveTargets", blend->label);
+    AVD_CHECK(avdVulkanBufferCreate(
+        vulkan,
+        &blend->activeTargetsBuffer,
+        sizeof(AVD_UInt32) * 2 * blend->maxActiveTargets * AVD_MAX_IN_FLIGHT_FRAMES,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        bufferLabel));
+    AVD_CHECK(avdVulkanBufferMap(vulkan, &blend->activeTargetsBuffer, (void **)&blend->mappedActiveTargets));
+    memset(blend->mappedActiveTargets, 0, sizeof(AVD_UInt32) * 2 * blend->maxActiveTargets * AVD_MAX_IN_FLIGHT_FRAMES);
+
+    return true;
+}
+
+static bool PRIV_avdMorphBlendCreateDescriptors(AVD_MorphBlend *blend, AVD_Vulkan *vulkan)
+{
+    AVD_ASSERT(blend != NULL);
+    AVD_ASSERT(vulkan != NULL);
+
+    VkDescriptorType descriptorTypes[] = {
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // base vertices
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // deformed vertices
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // morph targets
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // morph deltas
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // accumulators
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, // active targets
+    };
+    AVD_CHECK(avdCreateDescriptorSetLayout(
+        &blend->descriptorSetLayout,
+        vulkan->device,
+        descriptorTypes, AVD_ARRAY_COUNT(descriptorTypes),
+        VK_SHADER_STAGE_COMPUTE_BIT));
+    AVD_DEBUG_VK_SET_OBJECT_NAME(
+        VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT,
+        blend->descriptorSetLayout,
+        "[DescriptorSetLayout][Common]:MorphBlend/%s",
+        blend->label);
+    AVD_CHECK(avdAllocateDescriptorSet(
+        vulkan->device,
+        vulkan->descriptorPool,
+        blend->descriptorSetLayout,
+        &blend->descriptorSet));
+    AVD_DEBUG_VK_SET_OBJECT_NAME(
+        VK_OBJECT_TYPE_DESCRIPTOR_SET,
+        blend->descriptorSet,
+        "[DescriptorSet][Common]:MorphBlend/%s",
+        blend->label);
+
+    AVD_VulkanBuffer *buffers[] = {
+        &blend->baseVerticesBuffer,
+        &blend->deformedVerticesBuffer,
+        &blend->morphTargetsBuffer,
+        &blend->morphDeltasBuffer,
+        &blend->accumulatorsBuffer,
+        &blend->activeTargetsBuffer,
+    };
+    VkWriteDescriptorSet descriptorSetWrites[AVD_ARRAY_COUNT(buffers)] = {0};
+    for (uint32_t i = 0; i < AVD_ARRAY_COUNT(buffers); i++) {
+        AVD_CHECK(avdWriteBufferDescriptorSet(&descriptorSetWrites[i], blend->descriptorSet, i, &buffers[i]->descriptorBufferInfo));
+    }
+    vkUpdateDescriptorSets(vulkan->device, AVD_ARRAY_COUNT(descriptorSetWrites), descriptorSetWrites, 0, NULL);
+
+    return true;
+}
+
+bool avdMorphBlendCreate(
+    AVD_MorphBlend *blend,
+    AVD_Vulkan *vulkan,
+    const AVD_ModelResources *resources,
+    AVD_UInt32 maxMorphVertices,
+    AVD_UInt32 maxActiveTargets,
+    const char *label)
+{
+    AVD_ASSERT(blend != NULL);
+    AVD_ASSERT(vulkan != NULL);
+    AVD_ASSERT(resources != NULL);
+
+    memset(blend, 0, sizeof(AVD_MorphBlend));
+    snprintf(blend->label, sizeof(blend->label), "%s", label ? label : "Unnamed");
+    blend->maxMorphVertices = AVD_MAX(maxMorphVertices, 1);
+    blend->maxActiveTargets = AVD_MAX(maxActiveTargets, 1);
+
+    AVD_CHECK(PRIV_avdMorphBlendCreateBuffers(blend, vulkan, resources));
+    AVD_CHECK(PRIV_avdMorphBlendCreateDescriptors(blend, vulkan));
+
+    AVD_CHECK(avdPipelineUtilsCreateComputeLayoutAndPipeline(
+        &blend->pipelineLayout,
+        &blend->pipeline,
+        vulkan->device,
+        &blend->descriptorSetLayout,
+        1,
+        sizeof(AVD_MorphBlendPushConstants),
+        "MorphBlendComp",
+        NULL));
+    AVD_DEBUG_VK_SET_OBJECT_NAME(
+        VK_OBJECT_TYPE_PIPELINE,
+        blend->pipeline,
+        "[Pipeline][Common]:MorphBlend/%s",
+        blend->label);
+
+    return true;
+}
+
+void avdMorphBlendDestroy(AVD_MorphBlend *blend, AVD_Vulkan *vulkan)
+{
+    AVD_ASSERT(blend != NULL);
+    AVD_ASSERT(vulkan != NULL);
+
+    if (blend->mappedActiveTargets != NULL) {
+        avdVulkanBufferUnmap(vulkan, &blend->activeTargetsBuffer);
+        blend->mappedActiveTargets = NULL;
+    }
+
+    avdVulkanBufferDestroy(vulkan, &blend->baseVerticesBuffer);
+    avdVulkanBufferDestroy(vulkan, &blend->deformedVerticesBuffer);
+    avdVulkanBufferDestroy(vulkan, &blend->morphTargetsBuffer);
+    avdVulkanBufferDestroy(vulkan, &blend->morphDeltasBuffer);
+    avdVulkanBufferDestroy(vulkan, &blend->accumulatorsBuffer);
+    avdVulkanBufferDestroy(vulkan, &blend->activeTargetsBuffer);
+
+    vkDestroyPipeline(vulkan->device, blend->pipeline, NULL);
+    vkDestroyPipelineLayout(vulkan->device, blend->pipelineLayout, NULL);
+    vkDestroyDescriptorSetLayout(vulkan->device, blend->descriptorSetLayout, NULL);
+}
+
+bool avdMorphBlendBegin(VkCommandBuffer commandBuffer, AVD_MorphBlend *blend, AVD_VulkanRenderer *renderer)
+{
+    AVD_ASSERT(commandBuffer != VK_NULL_HANDLE);
+    AVD_ASSERT(blend != NULL);
+    AVD_ASSERT(renderer != NULL);
+
+    blend->frameIndex        = renderer->currentFrameIndex;
+    blend->accumulatorCursor = 0;
+    blend->activeCursor      = 0;
+
+    AVD_DEBUG_VK_CMD_BEGIN_LABEL(
+        commandBuffer,
+        AVD_MORPH_BLEND_LABEL_COLOR,
+        "[Cmd][Common]:MorphBlend/%s",
+        blend->label);
+
+    // the previous frame may still draw from the deformed vertices
+    VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 1, &barrier, 0, NULL, 0, NULL);
+
+    vkCmdFillBuffer(commandBuffer, blend->accumulatorsBuffer.buffer, 0, VK_WHOLE_SIZE, 0);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 1, &barrier, 0, NULL, 0, NULL);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, blend->pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, blend->pipelineLayout, 0, 1, &blend->descriptorSet, 0, NULL);
+
+    return true;
+}
+
+bool avdMorphBlendDispatch(
+    VkCommandBuffer commandBuffer,
+    AVD_MorphBlend *blend,
+    const AVD_Mesh *mesh,
+    const AVD_ModelResources *resources,
+    const AVD_Float *weights)
+{
+    AVD_ASSERT(commandBuffer != VK_NULL_HANDLE);
+    AVD_ASSERT(blend != NULL);
+    AVD_ASSERT(mesh != NULL);
+    AVD_ASSERT(resources != NULL);
+    AVD_ASSERT(weights != NULL || mesh->morphTargetCount == 0);
+
+    AVD_UInt32 vertexCount = (AVD_UInt32)AVD_MAX(mesh->morphVertexCount, 0);
+    AVD_CHECK_MSG(
+        blend->accumulatorCursor + vertexCount <= blend->maxMorphVertices,
+        "Morph blend %s ran out of accumulators (%u vertices)",
+        blend->label,
+        blend->maxMorphVertices);
+    AVD_CHECK_MSG(
+        (AVD_Size)mesh->morphVertexOffset + vertexCount <= resources->verticesList.count &&
+            (AVD_Size)mesh->morphTargetOffset + (AVD_Size)AVD_MAX(mesh->morphTargetCount, 0) <= resources->morphTargetsList.count,
+        "Mesh '%s' morph targets are out of bounds",
+        mesh->name);
+    if (vertexCount == 0) {
+        return true;
+    }
+
+    // only the targets that move anything are dispatched, the y dimension
+    // picks the target and x the delta
+    AVD_UInt32 *active       = blend->mappedActiveTargets + 2 * ((AVD_Size)blend->frameIndex * blend->maxActiveTargets + blend->activeCursor);
+    AVD_UInt32 activeCount   = 0;
+    AVD_UInt32 maxDeltaCount = 0;
+    for (AVD_Int32 i = 0; i < mesh->morphTargetCount; i++) {
+        if (fabsf(weights[i]) < AVD_MORPH_MIN_WEIGHT) {
+            continue;
+        }
+        AVD_CHECK_MSG(
+            blend->activeCursor + activeCount < blend->maxActiveTargets,
+            "Morph blend %s ran out of active target slots (%u)",
+            blend->label,
+            blend->maxActiveTargets);
+
+        AVD_UInt32 target                   = (AVD_UInt32)(mesh->morphTargetOffset + i);
+        const AVD_MorphTargetDeltas *deltas = (const AVD_MorphTargetDeltas *)avdListGet(&resources->morphTargetsList, target);
+        memcpy(&active[2 * activeCount + 1], &weights[i], sizeof(AVD_Float));
+        active[2 * activeCount] = target;
+        maxDeltaCount           = AVD_MAX(maxDeltaCount, deltas->deltaCount);
+        activeCount++;
+    }
+
+    AVD_MorphBlendPushConstants pushConstants = {
+        .activeOffset      = blend->frameIndex * blend->maxActiveTargets + blend->activeCursor,
+        .activeCount       = activeCount,
+        .vertexOffset      = (uint32_t)mesh->morphVertexOffset,
+        .vertexCount       = vertexCount,
+        .accumulatorOffset = blend->accumulatorCursor,
+        .pass              = AVD_MORPH_BLEND_PASS_ACCUMULATE,
+    };
+
+    if (activeCount > 0 && maxDeltaCount > 0) {
+        vkCmdPushConstants(commandBuffer, blend->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+        vkCmdDispatch(commandBuffer, (maxDeltaCount + AVD_MORPH_BLEND_GROUP_SIZE - 1) / AVD_MORPH_BLEND_GROUP_SIZE, activeCount, 1);
+
+        VkMemoryBarrier barrier = {
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+        };
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0, 1, &barrier, 0, NULL, 0, NULL);
+    }
+
+    // runs without active targets too, the sums are zero and the last blend
+    // of the mesh is replaced with its base vertices
+    pushConstants.pass = AVD_MORPH_BLEND_PASS_RESOLVE;
+    vkCmdPushConstants(commandBuffer, blend->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+    vkCmdDispatch(commandBuffer, (vertexCount + AVD_MORPH_BLEND_GROUP_SIZE - 1) / AVD_MORPH_BLEND_GROUP_SIZE, 1, 1);
+
+    blend->accumulatorCursor += vertexCount;
+    blend->activeCursor += activeCount;
+    return true;
+}
+
+bool avdMorphBlendEnd(VkCommandBuffer commandBuffer, AVD_MorphBlend *blend)
+{
+    AVD_ASSERT(commandBuffer != VK_NULL_HANDLE);
+    AVD_ASSERT(blend != NULL);
+
+    VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        0, 1, &barrier, 0, NULL, 0, NULL);
+
+    AVD_DEBUG_VK_CMD_END_LABEL(commandBuffer);
+
+    return true;
+}
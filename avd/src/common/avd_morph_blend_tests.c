@@ -0,0 +1,248 @@
+#include "common/avd_morph_blend.h"
+
+// Two grids in one set of resources behind a vertex that no mesh morphs, the
+// first with float and the second with quantized deltas. Every target pushes
+// a round patch out along z and tilts its normals. The vertices blended on the
+// GPU have to match avdMeshBlendMorphTargets, which sums the same fixed point
+// values, up to the rounding of the resolve.
+#define AVD_MORPH_BLEND_TEST_GRID_SIZE     24
+#define AVD_MORPH_BLEND_TEST_TARGET_COUNT  6
+#define AVD_MORPH_BLEND_TEST_MESH_COUNT    2
+#define AVD_MORPH_BLEND_TEST_TARGET_RADIUS 0.4f
+
+typedef struct {
+    AVD_ModelResources resources;
+    AVD_Mesh meshes[AVD_MORPH_BLEND_TEST_MESH_COUNT];
+    AVD_UInt32 vertexCount;
+
+    AVD_MorphBlend blend;
+    AVD_VulkanBuffer verticesReadback;
+    AVD_ModelVertexPacked *mappedVertices;
+    AVD_ModelVertexPacked *expectedVertices;
+    AVD_List accumulators;
+} AVD_MorphBlendTest;
+
+// Only the frame index is read by the blend.
+static AVD_VulkanRenderer PRIV_avdMorphBlendTestRenderer = {0};
+
+static void PRIV_avdMorphBlendTestPushVertex(AVD_ModelResources *resources, AVD_Vector3 position, AVD_Vector3 normal)
+{
+    AVD_ModelVertex vertex             = {0};
+    AVD_ModelVertexPacked packedVertex = {0};
+    avdModelVertexInit(&vertex);
+    vertex.position = position;
+    vertex.normal   = normal;
+    vertex.tangent  = avdVec4(1.0f, 0.0f, 0.0f, 1.0f);
+    avdModelVertexPack(&vertex, &packedVertex);
+    avdListPushBack(&resources->verticesList, &packedVertex);
+}
+
+static bool PRIV_avdMorphBlendTestAddMesh(AVD_MorphBlendTest *test, AVD_UInt32 index, AVD_MorphDeltaEncoding encoding)
+{
+    AVD_UInt32 size        = AVD_MORPH_BLEND_TEST_GRID_SIZE;
+    AVD_UInt32 vertexCount = size * size;
+    AVD_UInt32 firstVertex = (AVD_UInt32)test->resources.verticesList.count;
+    for (AVD_UInt32 y = 0; y < size; y++) {
+        for (AVD_UInt32 x = 0; x < size; x++) {
+            AVD_Float u = 2.0f * (AVD_Float)x / (AVD_Float)(size - 1) - 1.0f;
+            AVD_Float v = 2.0f * (AVD_Float)y / (AVD_Float)(size - 1) - 1.0f;
+            PRIV_avdMorphBlendTestPushVertex(&test->resources, avdVec3(u + 3.0f * (AVD_Float)index, v, 0.0f), avdVec3(0.0f, 0.0f, 1.0f));
+        }
+    }
+
+    AVD_Float *positionDeltas = (AVD_Float *)AVD_MALLOC(sizeof(AVD_Float) * vertexCount * 3);
+    AVD_Float *normalDeltas   = (AVD_Float *)AVD_MALLOC(sizeof(AVD_Float) * vertexCount * 3);
+    AVD_List targets          = {0};
+    AVD_List deltas           = {0};
+    avdListCreate(&targets, sizeof(AVD_MorphTargetDeltas));
+    avdListCreate(&deltas, sizeof(AVD_UInt32));
+    bool ok = positionDeltas != NULL && normalDeltas != NULL;
+    for (AVD_UInt32 target = 0; ok && target < AVD_MORPH_BLEND_TEST_TARGET_COUNT; target++) {
+        AVD_Float centerX = sinf((AVD_Float)(target + index) * 2.39996f) * 0.6f;
+        AVD_Float centerY = cosf((AVD_Float)(target + index) * 2.39996f) * 0.6f;
+        for (AVD_UInt32 vertex = 0; vertex < vertexCount; vertex++) {
+            AVD_Float u                    = 2.0f * (AVD_Float)(vertex % size) / (AVD_Float)(size - 1) - 1.0f - centerX;
+            AVD_Float v                    = 2.0f * (AVD_Float)(vertex / size) / (AVD_Float)(size - 1) - 1.0f - centerY;
+            AVD_Float distance             = sqrtf(u * u + v * v) / AVD_MORPH_BLEND_TEST_TARGET_RADIUS;
+            AVD_Float falloff              = distance < 1.0f ? 0.5f + 0.5f * cosf(distance * AVD_PI) : 0.0f;
+            positionDeltas[vertex * 3 + 0] = 0.02f * falloff * (AVD_Float)(target % 3);
+            positionDeltas[vertex * 3 + 1] = 0.0f;
+            positionDeltas[vertex * 3 + 2] = 0.1f * falloff;
+            normalDeltas[vertex * 3 + 0]   = -0.3f * falloff * u / AVD_MORPH_BLEND_TEST_TARGET_RADIUS;
+            normalDeltas[vertex * 3 + 1]   = -0.3f * falloff * v / AVD_MORPH_BLEND_TEST_TARGET_RADIUS;
+            normalDeltas[vertex * 3 + 2]   = 0.0f;
+        }
+        ok = avdMorphTargetBuild(&targets, &deltas, positionDeltas, normalDeltas, vertexCount, encoding);
+    }
+
+    ok = ok && avdMeshInitWithNameId(&test->meshes[index], "MorphBlendTestGrid", (AVD_Int32)index);
+    ok = ok && avdMeshAddMorphTargets(&test->meshes[index], &test->resources, firstVertex, vertexCount, &targets, &deltas);
+    avdListDestroy(&targets);
+    avdListDestroy(&deltas);
+    if (positionDeltas != NULL) {
+        AVD_FREE(positionDeltas);
+    }
+    if (normalDeltas != NULL) {
+        AVD_FREE(normalDeltas);
+    }
+    AVD_CHECK_MSG(ok, "Failed to build the morph targets of test grid %u", index);
+    return true;
+}
+
+static bool PRIV_avdMorphBlendTestCreate(AVD_MorphBlendTest *test)
+{
+    avdListCreate(&test->accumulators, sizeof(AVD_Int32));
+    AVD_CHECK(avdModelResourcesCreate(&test->resources));
+
+    PRIV_avdMorphBlendTestPushVertex(&test->resources, avdVec3(7.0f, 7.0f, 7.0f), avdVec3(0.0f, 1.0f, 0.0f));
+    AVD_CHECK(PRIV_avdMorphBlendTestAddMesh(test, 0, AVD_MORPH_DELTA_ENCODING_FLOAT));
+    AVD_CHECK(PRIV_avdMorphBlendTestAddMesh(test, 1, AVD_MORPH_DELTA_ENCODING_QUANTIZED));
+
+    test->vertexCount      = (AVD_UInt32)test->resources.verticesList.count;
+    test->expectedVertices = (AVD_ModelVertexPacked *)AVD_MALLOC(sizeof(AVD_ModelVertexPacked) * test->vertexCount);
+    AVD_CHECK_MSG(test->expectedVertices != NULL, "Failed to allocate the expected morph blend vertices");
+    return true;
+}
+
+static void PRIV_avdMorphBlendTestDestroy(AVD_MorphBlendTest *test, AVD_Vulkan *vulkan)
+{
+    avdMorphBlendDestroy(&test->blend, vulkan);
+    if (test->mappedVertices != NULL) {
+        avdVulkanBufferUnmap(vulkan, &test->verticesReadback);
+    }
+    avdVulkanBufferDestroy(vulkan, &test->verticesReadback);
+    if (test->expectedVertices != NULL) {
+        AVD_FREE(test->expectedVertices);
+    }
+    avdListDestroy(&test->accumulators);
+    avdModelResourcesDestroy(&test->resources);
+}
+
+// Blends both meshes and copies all deformed vertices out, final once the
+// fence signaled.
+static bool PRIV_avdMorphBlendTestFrame(AVD_MorphBlendTest *test, AVD_Vulkan *vulkan, const AVD_Float (*weights)[AVD_MORPH_BLEND_TEST_TARGET_COUNT])
+{
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    AVD_CHECK(avdVulkanBeginOneTimeCommands(vulkan, &commandBuffer, "MorphBlendTest"));
+
+    bool blended = avdMorphBlendBegin(commandBuffer, &test->blend, &PRIV_avdMorphBlendTestRenderer);
+    for (AVD_UInt32 i = 0; blended && i < AVD_MORPH_BLEND_TEST_MESH_COUNT; i++) {
+        blended = avdMorphBlendDispatch(commandBuffer, &test->blend, &test->meshes[i], &test->resources, weights[i]);
+    }
+    blended = blended && avdMorphBlendEnd(commandBuffer, &test->blend);
+
+    // the end of the blend only made the vertices visible to the draws
+    VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 1, &barrier, 0, NULL, 0, NULL);
+
+    VkBufferCopy region = {
+        .srcOffset = 0,
+        .dstOffset = 0,
+        .size      = sizeof(AVD_ModelVertexPacked) * test->vertexCount,
+    };
+    vkCmdCopyBuffer(commandBuffer, test->blend.deformedVerticesBuffer.buffer, test->verticesReadback.buffer, 1, &region);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_HOST_BIT,
+        0, 1, &barrier, 0, NULL, 0, NULL);
+
+    AVD_CHECK(avdVulkanSubmitOneTimeCommands(vulkan, commandBuffer));
+    AVD_CHECK(blended);
+    return true;
+}
+
+// The vertices outside of the morph ranges are never written and have to be
+// the same bytes, the blended ones are compared unpacked. moved says whether
+// the weights move any vertex away from its base.
+static bool PRIV_avdMorphBlendTestCheck(AVD_MorphBlendTest *test, const AVD_Float (*weights)[AVD_MORPH_BLEND_TEST_TARGET_COUNT], bool moved, const char *name)
+{
+    memcpy(test->expectedVertices, test->resources.verticesList.items, sizeof(AVD_ModelVertexPacked) * test->vertexCount);
+    for (AVD_UInt32 i = 0; i < AVD_MORPH_BLEND_TEST_MESH_COUNT; i++) {
+        const AVD_Mesh *mesh = &test->meshes[i];
+        AVD_CHECK(avdMeshBlendMorphTargets(mesh, &test->resources, weights[i], &test->accumulators, test->expectedVertices + mesh->morphVertexOffset));
+    }
+
+    AVD_Size changed = 0;
+    for (AVD_UInt32 vertex = 0; vertex < test->vertexCount; vertex++) {
+        const AVD_ModelVertexPacked *base = (const AVD_ModelVertexPacked *)test->resources.verticesList.items + vertex;
+        changed += memcmp(&test->expectedVertices[vertex], base, sizeof(AVD_ModelVertexPacked)) != 0;
+        if (memcmp(&test->mappedVertices[vertex], &test->expectedVertices[vertex], sizeof(AVD_ModelVertexPacked)) == 0) {
+            continue;
+        }
+        AVD_CHECK_MSG(vertex >= (AVD_UInt32)test->meshes[0].morphVertexOffset, "%s: vertex %u outside of the morph ranges was written", name, vertex);
+
+        AVD_ModelVertex blended  = {0};
+        AVD_ModelVertex expected = {0};
+        avdModelVertexUnpack(&test->mappedVertices[vertex], &blended);
+        avdModelVertexUnpack(&test->expectedVertices[vertex], &expected);
+        AVD_Float positionError = avdVec3Length(avdVec3Subtract(blended.position, expected.position));
+        AVD_Float normalError   = avdVec3Length(avdVec3Subtract(blended.normal, expected.normal));
+        AVD_CHECK_MSG(positionError <= 1e-5f, "%s: GPU blended vertex %u is %f away from avdMeshBlendMorphTargets", name, vertex, positionError);
+        AVD_CHECK_MSG(normalError <= 2e-3f, "%s: GPU blended normal %u is %f away from avdMeshBlendMorphTargets", name, vertex, normalError);
+    }
+    AVD_CHECK_MSG((changed > 0) == moved, "%s: the CPU blend moved %zu of %u vertices", name, changed, test->vertexCount);
+    return true;
+}
+
+static bool PRIV_avdMorphBlendTestReadback(AVD_MorphBlendTest *test, AVD_Vulkan *vulkan)
+{
+    AVD_UInt32 maxMorphVertices = 0;
+    for (AVD_UInt32 i = 0; i < AVD_MORPH_BLEND_TEST_MESH_COUNT; i++) {
+        maxMorphVertices += (AVD_UInt32)test->meshes[i].morphVertexCount;
+    }
+    AVD_CHECK(avdMorphBlendCreate(
+        &test->blend,
+        vulkan,
+        &test->resources,
+        maxMorphVertices,
+        AVD_MORPH_BLEND_TEST_MESH_COUNT * AVD_MORPH_BLEND_TEST_TARGET_COUNT,
+        "Test"));
+    AVD_CHECK(avdVulkanBufferCreate(
+        vulkan,
+        &test->verticesReadback,
+        sizeof(AVD_ModelVertexPacked) * test->vertexCount,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        "MorphBlend/Test/VerticesReadback"));
+    AVD_CHECK(avdVulkanBufferMap(vulkan, &test->verticesReadback, (void **)&test->mappedVertices));
+
+    // negative weights, weights past one and weights below
+    // AVD_MORPH_MIN_WEIGHT that are skipped
+    static const AVD_Float weights[AVD_MORPH_BLEND_TEST_MESH_COUNT][AVD_MORPH_BLEND_TEST_TARGET_COUNT] = {
+        {0.8f, -0.3f, 0.5f, 0.00005f, 1.0f, 0.25f},
+        {0.0f, 0.6f, 1.5f, 0.35f, -0.7f, 0.00001f},
+    };
+    AVD_CHECK(PRIV_avdMorphBlendTestFrame(test, vulkan, weights));
+    AVD_CHECK(PRIV_avdMorphBlendTestCheck(test, weights, true, "Weighted"));
+
+    // no active targets, the meshes get their base vertices back
+    static const AVD_Float zeroWeights[AVD_MORPH_BLEND_TEST_MESH_COUNT][AVD_MORPH_BLEND_TEST_TARGET_COUNT] = {0};
+    AVD_CHECK(PRIV_avdMorphBlendTestFrame(test, vulkan, zeroWeights));
+    AVD_CHECK(PRIV_avdMorphBlendTestCheck(test, zeroWeights, false, "Reset"));
+    return true;
+}
+
+bool avdMorphBlendTestsRun(AVD_Vulkan *vulkan)
+{
+    AVD_LOG_DEBUG("Running AVD Morph Blend Tests...");
+
+    AVD_MorphBlendTest test = {0};
+    bool ok                 = PRIV_avdMorphBlendTestCreate(&test) && PRIV_avdMorphBlendTestReadback(&test, vulkan);
+    PRIV_avdMorphBlendTestDestroy(&test, vulkan);
+    AVD_CHECK(ok);
+
+    AVD_LOG_DEBUG("All AVD Morph Blend Tests PASSED");
+    return true;
+}
@@ -0,0 +1,257 @@
+#include "core/avd_arena.h"
+
+static AVD_Arena PRIV_avdFrameArena       = {0};
+static bool PRIV_avdFrameArenaInitialized = false;
+
+static AVD_THREAD_LOCAL AVD_Arena PRIV_avdScratchArenas[AVD_ARENA_SCRATCH_COUNT];
+
+// the header is padded so that the data of a freshly malloc'd block starts at the default alignment
+#define AVD_ARENA_BLOCK_HEADER_SIZE AVD_ALIGN(sizeof(AVD_ArenaBlock), AVD_ARENA_DEFAULT_ALIGNMENT)
+
+static AVD_UInt8 *PRIV_avdArenaBlockData(AVD_ArenaBlock *block)
+{
+    return (AVD_UInt8 *)block + AVD_ARENA_BLOCK_HEADER_SIZE;
+}
+
+static void *PRIV_avdArenaBlockTryAlloc(AVD_ArenaBlock *block, AVD_Size size, AVD_Size alignment)
+{
+    if (block == NULL) {
+        return NULL;
+    }
+
+    // align the address rather than the offset so alignments above the malloc guarantee work too
+    uintptr_t base    = (uintptr_t)PRIV_avdArenaBlockData(block);
+    uintptr_t aligned = (base + block->used + (alignment - 1)) & ~((uintptr_t)alignment - 1);
+    AVD_Size offset   = (AVD_Size)(aligned - base);
+
+    if (offset + size > block->capacity) {
+        return NULL;
+    }
+
+    block->used = offset + size;
+    return (void *)aligned;
+}
+
+static AVD_ArenaBlock *PRIV_avdArenaInsertBlock(AVD_Arena *arena, AVD_Size minCapacity)
+{
+    AVD_Size capacity     = AVD_MAX(arena->blockSize, minCapacity);
+    AVD_ArenaBlock *block = (AVD_ArenaBlock *)AVD_MALLOC(AVD_ARENA_BLOCK_HEADER_SIZE + capacity);
+    if (block == NULL) {
+        AVD_LOG_ERROR("Failed to allocate arena block of %zu bytes", capacity);
+        return NULL;
+    }
+
+    block->capacity = capacity;
+    block->used     = 0;
+
+    // the new block goes right after the current one, blocks further down the chain stay reusable
+    if (arena->current == NULL) {
+        block->next  = arena->first;
+        arena->first = block;
+    } else {
+        block->next          = arena->current->next;
+        arena->current->next = block;
+    }
+
+    arena->blockCount++;
+    arena->reservedSize += capacity;
+    return block;
+}
+
+bool avdArenaCreate(AVD_Arena *arena, AVD_Size blockSize)
+{
+    AVD_ASSERT(arena != NULL);
+    AVD_ASSERT(blockSize > 0);
+
+    memset(arena, 0, sizeof(AVD_Arena));
+    arena->blockSize = blockSize;
+    return true;
+}
+
+void avdArenaDestroy(AVD_Arena *arena)
+{
+    AVD_ASSERT(arena != NULL);
+
+    AVD_ArenaBlock *block = arena->first;
+    while (block != NULL) {
+        AVD_ArenaBlock *next = block->next;
+        AVD_FREE(block);
+        block = next;
+    }
+
+    memset(arena, 0, sizeof(AVD_Arena));
+}
+
+void *avdArenaAlloc(AVD_Arena *arena, AVD_Size size, AVD_Size alignment)
+{
+    AVD_ASSERT(arena != NULL);
+    AVD_ASSERT(arena->blockSize > 0);
+    AVD_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    void *result = PRIV_avdArenaBlockTryAlloc(arena->current, size, alignment);
+    while (result == NULL) {
+        AVD_ArenaBlock *next = arena->current ? arena->current->next : arena->first;
+        if (next == NULL || next->capacity < size + alignment) {
+            next = PRIV_avdArenaInsertBlock(arena, size + alignment);
+            if (next == NULL) {
+                return NULL;
+            }
+        }
+
+        next->used     = 0;
+        arena->current = next;
+        result         = PRIV_avdArenaBlockTryAlloc(next, size, alignment);
+    }
+
+    arena->allocationCount++;
+    return result;
+}
+
+void *avdArenaAllocZeroed(AVD_Arena *arena, AVD_Size size, AVD_Size alignment)
+{
+    void *result = avdArenaAlloc(arena, size, alignment);
+    if (result != NULL) {
+        memset(result, 0, size);
+    }
+    return result;
+}
+
+char *avdArenaPrintf(AVD_Arena *arena, const char *format, ...)
+{
+    AVD_ASSERT(arena != NULL);
+    AVD_ASSERT(format != NULL);
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    if (length < 0) {
+        AVD_LOG_ERROR("Invalid format string passed to avdArenaPrintf: %s", format);
+        return NULL;
+    }
+
+    char *result = (char *)avdArenaAlloc(arena, (AVD_Size)length + 1, 1);
+    if (result == NULL) {
+        return NULL;
+    }
+
+    va_start(args, format);
+    vsnprintf(result, (AVD_Size)length + 1, format, args);
+    va_end(args);
+    return result;
+}
+
+AVD_ArenaMarker avdArenaGetMarker(const AVD_Arena *arena)
+{
+    AVD_ASSERT(arena != NULL);
+
+    AVD_ArenaMarker marker = {0};
+    marker.block           = arena->current;
+    marker.used            = arena->current ? arena->current->used : 0;
+    return marker;
+}
+
+void avdArenaResetToMarker(AVD_Arena *arena, AVD_ArenaMarker marker)
+{
+    AVD_ASSERT(arena != NULL);
+
+    if (marker.block == NULL) {
+        // the marker was taken before anything was allocated
+        arena->current = arena->first;
+        if (arena->current != NULL) {
+            arena->current->used = 0;
+        }
+        return;
+    }
+
+    arena->current       = marker.block;
+    arena->current->used = marker.used;
+}
+
+void avdArenaReset(AVD_Arena *arena)
+{
+    AVD_ASSERT(arena != NULL);
+
+    avdArenaResetToMarker(arena, (AVD_ArenaMarker){0});
+    arena->allocationCount = 0;
+}
+
+AVD_Size avdArenaUsedSize(const AVD_Arena *arena)
+{
+    AVD_ASSERT(arena != NULL);
+
+    AVD_Size used = 0;
+    for (AVD_ArenaBlock *block = arena->first; block != NULL; block = block->next) {
+        used += block->used;
+        if (block == arena->current) {
+            break;
+        }
+    }
+    return used;
+}
+
+bool avdArenaFrameInit(void)
+{
+    AVD_CHECK_MSG(!PRIV_avdFrameArenaInitialized, "Frame arena is already initialized");
+    AVD_CHECK(avdArenaCreate(&PRIV_avdFrameArena, AVD_ARENA_FRAME_BLOCK_SIZE));
+    PRIV_avdFrameArenaInitialized = true;
+    return true;
+}
+
+void avdArenaFrameShutdown(void)
+{
+    if (!PRIV_avdFrameArenaInitialized) {
+        return;
+    }
+
+    avdArenaDestroy(&PRIV_avdFrameArena);
+    PRIV_avdFrameArenaInitialized = false;
+}
+
+void avdArenaFrameReset(void)
+{
+    AVD_ASSERT(PRIV_avdFrameArenaInitialized);
+    avdArenaReset(&PRIV_avdFrameArena);
+}
+
+AVD_Arena *avdArenaFrame(void)
+{
+    AVD_ASSERT(PRIV_avdFrameArenaInitialized);
+    return &PRIV_avdFrameArena;
+}
+
+AVD_ArenaScratch avdArenaScratchBegin(AVD_Arena *conflict)
+{
+    AVD_ArenaScratch scratch = {0};
+    for (AVD_Size i = 0; i < AVD_ARENA_SCRATCH_COUNT; i++) {
+        if (&PRIV_avdScratchArenas[i] != conflict) {
+            scratch.arena = &PRIV_avdScratchArenas[i];
+            break;
+        }
+    }
+    AVD_ASSERT(scratch.arena != NULL);
+
+    // thread local storage is zero initialized, the arena itself only allocates on first use
+    if (scratch.arena->blockSize == 0) {
+        avdArenaCreate(scratch.arena, AVD_ARENA_SCRATCH_BLOCK_SIZE);
+    }
+
+    scratch.marker = avdArenaGetMarker(scratch.arena);
+    return scratch;
+}
+
+void avdArenaScratchEnd(AVD_ArenaScratch scratch)
+{
+    AVD_ASSERT(scratch.arena != NULL);
+    avdArenaResetToMarker(scratch.arena, scratch.marker);
+}
+
+void avdArenaScratchThreadShutdown(void)
+{
+    for (AVD_Size i = 0; i < AVD_ARENA_SCRATCH_COUNT; i++) {
+        if (PRIV_avdScratchArenas[i].blockSize != 0) {
+            avdArenaDestroy(&PRIV_avdScratchArenas[i]);
+        }
+    }
+}
@@ -0,0 +1,281 @@
+#include "core/avd_core.h"
+#include <string.h>
+
+static bool PRIV_avdTestArenaAlignment()
+{
+    AVD_LOG_DEBUG("  Testing Arena alignment...");
+
+    AVD_Arena arena;
+    avdArenaCreate(&arena, 4096);
+
+    AVD_Size alignments[] = {1, 2, 4, 8, 16, 32, 64, 128, 256};
+    AVD_UInt8 *pointers[64];
+    for (int round = 0; round < 64; round++) {
+        AVD_Size alignment = alignments[round % AVD_ARRAY_COUNT(alignments)];
+        AVD_Size size      = (AVD_Size)(round * 7 + 1);
+        pointers[round]    = (AVD_UInt8 *)avdArenaAlloc(&arena, size, alignment);
+
+        if (pointers[round] == NULL || ((uintptr_t)pointers[round] & (alignment - 1)) != 0) {
+            AVD_LOG_ERROR("    FAILED: Allocation %d is not aligned to %zu", round, alignment);
+            avdArenaDestroy(&arena);
+            return false;
+        }
+        memset(pointers[round], round, size);
+    }
+
+    // any overlap between allocations would have overwritten an earlier fill pattern
+    for (int round = 0; round < 64; round++) {
+        AVD_Size size = (AVD_Size)(round * 7 + 1);
+        for (AVD_Size i = 0; i < size; i++) {
+            if (pointers[round][i] != (AVD_UInt8)round) {
+                AVD_LOG_ERROR("    FAILED: Allocation %d overlaps another allocation", round);
+                avdArenaDestroy(&arena);
+                return false;
+            }
+        }
+    }
+
+    avdArenaDestroy(&arena);
+    AVD_LOG_DEBUG("    Arena alignment PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestArenaGrowthAndReuse()
+{
+    AVD_LOG_DEBUG("  Testing Arena growth and reuse...");
+
+    AVD_Arena arena;
+    avdArenaCreate(&arena, 1024);
+
+    // more than one block worth of small allocations plus one allocation larger than a block
+    AVD_UInt32 *values[512];
+    for (AVD_UInt32 i = 0; i < 512; i++) {
+        values[i]  = AVD_ARENA_PUSH_ARRAY(&arena, AVD_UInt32, 4);
+        *values[i] = i;
+    }
+    AVD_UInt8 *large = (AVD_UInt8 *)avdArenaAllocZeroed(&arena, 10000, 64);
+    if (large == NULL || large[0] != 0 || large[9999] != 0) {
+        AVD_LOG_ERROR("    FAILED: Large allocation");
+        avdArenaDestroy(&arena);
+        return false;
+    }
+
+    for (AVD_UInt32 i = 0; i < 512; i++) {
+        if (*values[i] != i) {
+            AVD_LOG_ERROR("    FAILED: Value %u was overwritten", i);
+            avdArenaDestroy(&arena);
+            return false;
+        }
+    }
+
+    AVD_Size blockCount   = arena.blockCount;
+    AVD_Size reservedSize = arena.reservedSize;
+    if (blockCount < 2 || avdArenaUsedSize(&arena) < 512 * 16 + 10000) {
+        AVD_LOG_ERROR("    FAILED: Arena did not grow as expected (%zu blocks)", blockCount);
+        avdArenaDestroy(&arena);
+        return false;
+    }
+
+    // the same workload after a reset must be served from the blocks already reserved
+    for (int frame = 0; frame < 8; frame++) {
+        avdArenaReset(&arena);
+        for (AVD_UInt32 i = 0; i < 512; i++) {
+            AVD_ARENA_PUSH_ARRAY(&arena, AVD_UInt32, 4);
+        }
+        avdArenaAlloc(&arena, 10000, 64);
+    }
+
+    if (arena.blockCount != blockCount || arena.reservedSize != reservedSize || arena.allocationCount != 513) {
+        AVD_LOG_ERROR("    FAILED: Arena reserved more memory after reset (%zu -> %zu blocks)", blockCount, arena.blockCount);
+        avdArenaDestroy(&arena);
+        return false;
+    }
+
+    avdArenaDestroy(&arena);
+    if (arena.first != NULL || arena.blockCount != 0) {
+        AVD_LOG_ERROR("    FAILED: Arena destroy");
+        return false;
+    }
+
+    AVD_LOG_DEBUG("    Arena growth and reuse PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestArenaMarkers()
+{
+    AVD_LOG_DEBUG("  Testing Arena markers...");
+
+    AVD_Arena arena;
+    avdArenaCreate(&arena, 256);
+
+    AVD_ArenaMarker empty = avdArenaGetMarker(&arena);
+    char *persistent      = avdArenaPrintf(&arena, "frame %d of %s", 42, "arena");
+    AVD_ArenaMarker outer = avdArenaGetMarker(&arena);
+    AVD_Size outerUsed    = avdArenaUsedSize(&arena);
+
+    for (int i = 0; i < 100; i++) {
+        avdArenaAlloc(&arena, 48, 16);
+    }
+
+    AVD_ArenaMarker inner = avdArenaGetMarker(&arena);
+    AVD_Size innerUsed    = avdArenaUsedSize(&arena);
+    avdArenaAlloc(&arena, 1000, 8);
+    avdArenaResetToMarker(&arena, inner);
+
+    if (avdArenaUsedSize(&arena) != innerUsed) {
+        AVD_LOG_ERROR("    FAILED: Reset to inner marker");
+        avdArenaDestroy(&arena);
+        return false;
+    }
+
+    avdArenaResetToMarker(&arena, outer);
+    if (avdArenaUsedSize(&arena) != outerUsed || strcmp(persistent, "frame 42 of arena") != 0) {
+        AVD_LOG_ERROR("    FAILED: Reset to outer marker");
+        avdArenaDestroy(&arena);
+        return false;
+    }
+
+    avdArenaResetToMarker(&arena, empty);
+    if (avdArenaUsedSize(&arena) != 0) {
+        AVD_LOG_ERROR("    FAILED: Reset to empty marker");
+        avdArenaDestroy(&arena);
+        return false;
+    }
+
+    avdArenaDestroy(&arena);
+    AVD_LOG_DEBUG("    Arena markers PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestArenaScratch()
+{
+    AVD_LOG_DEBUG("  Testing Arena scratch...");
+
+    AVD_ArenaScratch outer = avdArenaScratchBegin(NULL);
+    AVD_UInt64 *result     = AVD_ARENA_PUSH_ARRAY(outer.arena, AVD_UInt64, 16);
+    for (int i = 0; i < 16; i++) {
+        result[i] = (AVD_UInt64)i;
+    }
+
+    // a nested scratch that conflicts with the arena holding the results must pick the other one
+    AVD_ArenaScratch inner = avdArenaScratchBegin(outer.arena);
+    if (inner.arena == outer.arena) {
+        AVD_LOG_ERROR("    FAILED: Scratch conflict not honoured");
+        return false;
+    }
+    AVD_UInt64 *temp = AVD_ARENA_PUSH_ARRAY(inner.arena, AVD_UInt64, 1024);
+    memset(temp, 0xFF, sizeof(AVD_UInt64) * 1024);
+    avdArenaScratchEnd(inner);
+
+    for (int i = 0; i < 16; i++) {
+        if (result[i] != (AVD_UInt64)i) {
+            AVD_LOG_ERROR("    FAILED: Nested scratch clobbered results");
+            return false;
+        }
+    }
+
+    AVD_Size usedBefore = avdArenaUsedSize(outer.arena);
+    avdArenaScratchEnd(outer);
+    if (avdArenaUsedSize(outer.arena) >= usedBefore) {
+        AVD_LOG_ERROR("    FAILED: Scratch end did not release memory");
+        return false;
+    }
+
+    AVD_LOG_DEBUG("    Arena scratch PASSED");
+    return true;
+}
+
+typedef struct {
+    AVD_Arena arena;
+    AVD_Size allocationsPerFrame;
+    AVD_Size frameCount;
+    AVD_Size checksum;
+    void *pointers[4096];
+} AVD_ArenaBenchmarkFrame;
+
+static void PRIV_avdArenaBenchmarkFrameMalloc(void *userData)
+{
+    AVD_ArenaBenchmarkFrame *frame = (AVD_ArenaBenchmarkFrame *)userData;
+    for (AVD_Size f = 0; f < frame->frameCount; f++) {
+        for (AVD_Size i = 0; i < frame->allocationsPerFrame; i++) {
+            frame->pointers[i] = malloc(16 + (i % 16) * 16);
+            frame->checksum += (uintptr_t)frame->pointers[i] & 0xFF;
+        }
+        for (AVD_Size i = 0; i < frame->allocationsPerFrame; i++) {
+            free(frame->pointers[i]);
+        }
+    }
+}
+
+static void PRIV_avdArenaBenchmarkFrameArena(void *userData)
+{
+    AVD_ArenaBenchmarkFrame *frame = (AVD_ArenaBenchmarkFrame *)userData;
+    for (AVD_Size f = 0; f < frame->frameCount; f++) {
+        avdArenaReset(&frame->arena);
+        for (AVD_Size i = 0; i < frame->allocationsPerFrame; i++) {
+            frame->pointers[i] = avdArenaAlloc(&frame->arena, 16 + (i % 16) * 16, AVD_ARENA_DEFAULT_ALIGNMENT);
+            frame->checksum += (uintptr_t)frame->pointers[i] & 0xFF;
+        }
+    }
+}
+
+static bool PRIV_avdArenaBenchmarkFrame(AVD_Bench *bench, AVD_Size allocationsPerFrame, AVD_Size frameCount)
+{
+    static AVD_ArenaBenchmarkFrame frame;
+    AVD_ASSERT(allocationsPerFrame <= AVD_ARRAY_COUNT(frame.pointers));
+
+    frame.allocationsPerFrame = allocationsPerFrame;
+    frame.frameCount          = frameCount;
+    frame.checksum            = 0;
+    AVD_CHECK(avdArenaCreate(&frame.arena, AVD_ARENA_FRAME_BLOCK_SIZE));
+
+    char mallocName[AVD_BENCH_NAME_LENGTH];
+    char arenaName[AVD_BENCH_NAME_LENGTH];
+    snprintf(mallocName, sizeof(mallocName), "arena/frame_malloc_free/%zu", allocationsPerFrame);
+    snprintf(arenaName, sizeof(arenaName), "arena/frame_arena/%zu", allocationsPerFrame);
+
+    AVD_BenchCase mallocCase = {
+        .name               = mallocName,
+        .unit               = "ops",
+        .itemsPerRepetition = allocationsPerFrame * frameCount,
+        .run                = PRIV_avdArenaBenchmarkFrameMalloc,
+        .userData           = &frame,
+    };
+    AVD_BenchCase arenaCase = {
+        .name               = arenaName,
+        .unit               = "ops",
+        .itemsPerRepetition = allocationsPerFrame * frameCount,
+        .run                = PRIV_avdArenaBenchmarkFrameArena,
+        .userData           = &frame,
+    };
+
+    bool ok = avdBenchRun(bench, &mallocCase) && avdBenchRun(bench, &arenaCase);
+
+    AVD_LOG_DEBUG("  %5zu allocations/frame used %zu arena blocks (checksum %zu)", allocationsPerFrame, frame.arena.blockCount, frame.checksum);
+    avdArenaDestroy(&frame.arena);
+    return ok;
+}
+
+bool avdArenaTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Arena Tests...");
+
+    AVD_CHECK(PRIV_avdTestArenaAlignment());
+    AVD_CHECK(PRIV_avdTestArenaGrowthAndReuse());
+    AVD_CHECK(PRIV_avdTestArenaMarkers());
+    AVD_CHECK(PRIV_avdTestArenaScratch());
+
+    AVD_LOG_DEBUG("All AVD Arena Tests PASSED");
+    return true;
+}
+
+bool avdArenaBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD Arena benchmarks...");
+
+    AVD_CHECK(PRIV_avdArenaBenchmarkFrame(bench, 64, 10000));
+    AVD_CHECK(PRIV_avdArenaBenchmarkFrame(bench, 4096, 200));
+
+    return true;
+}
@@ -0,0 +1,202 @@
+#include "core/avd_bench.h"
+#include "core/avd_utils.h"
+
+static int PRIV_avdBenchCompareDouble(const void *a, const void *b)
+{
+    AVD_Double lhs = *(const AVD_Double *)a;
+    AVD_Double rhs = *(const AVD_Double *)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+
+// Only understands the layout written by avdBenchWriteJson, which is all a baseline ever is.
+static bool PRIV_avdBenchFindBaselineMedian(const char *json, const char *name, AVD_Double *outMedianMs)
+{
+    char needle[AVD_BENCH_NAME_LENGTH + 16];
+    snprintf(needle, sizeof(needle), "\"name\": \"%s\"", name);
+
+    const char *entry = strstr(json, needle);
+    if (entry == NULL) {
+        return false;
+    }
+
+    const char *median = strstr(entry, "\"p50Ms\": ");
+    if (median == NULL) {
+        return false;
+    }
+
+    *outMedianMs = strtod(median + strlen("\"p50Ms\": "), NULL);
+    return true;
+}
+
+void avdBenchConfigDefault(AVD_BenchConfig *config)
+{
+    AVD_ASSERT(config != NULL);
+
+    config->warmup      = AVD_BENCH_DEFAULT_WARMUP;
+    config->repetitions = AVD_BENCH_DEFAULT_REPETITIONS;
+    config->filter      = NULL;
+}
+
+bool avdBenchCreate(AVD_Bench *bench, const AVD_BenchConfig *config)
+{
+    AVD_ASSERT(bench != NULL);
+
+    memset(bench, 0, sizeof(AVD_Bench));
+    if (config != NULL) {
+        bench->config = *config;
+    } else {
+        avdBenchConfigDefault(&bench->config);
+    }
+
+    AVD_CHECK_MSG(bench->config.repetitions > 0 && bench->config.repetitions <= AVD_BENCH_MAX_REPETITIONS,
+                  "Benchmark repetitions must be in [1, %d], got %u", AVD_BENCH_MAX_REPETITIONS, bench->config.repetitions);
+
+    avdListCreate(&bench->results, sizeof(AVD_BenchResult));
+    return true;
+}
+
+void avdBenchDestroy(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    avdListDestroy(&bench->results);
+}
+
+AVD_Double avdBenchPercentile(const AVD_Double *sortedSamples, AVD_Size count, AVD_Double percentile)
+{
+    AVD_ASSERT(sortedSamples != NULL);
+    AVD_ASSERT(count > 0);
+
+    AVD_Double rank  = AVD_CLAMP(percentile, 0.0, 100.0) / 100.0 * (AVD_Double)(count - 1);
+    AVD_Size lower   = (AVD_Size)rank;
+    AVD_Size upper   = AVD_MIN(lower + 1, count - 1);
+    AVD_Double blend = rank - (AVD_Double)lower;
+    return sortedSamples[lower] + (sortedSamples[upper] - sortedSamples[lower]) * blend;
+}
+
+bool avdBenchIsSelected(const AVD_Bench *bench, const char *name)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_ASSERT(name != NULL);
+    return bench->config.filter == NULL || strstr(name, bench->config.filter) != NULL;
+}
+
+bool avdBenchRun(AVD_Bench *bench, const AVD_BenchCase *benchCase)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_ASSERT(benchCase != NULL);
+    AVD_ASSERT(benchCase->name != NULL && benchCase->run != NULL);
+
+    if (!avdBenchIsSelected(bench, benchCase->name)) {
+        return true;
+    }
+
+    AVD_CHECK_MSG(strlen(benchCase->name) < AVD_BENCH_NAME_LENGTH && strpbrk(benchCase->name, "\"\\") == NULL,
+                  "Benchmark name '%s' is too long or not JSON safe", benchCase->name);
+
+    for (AVD_UInt32 i = 0; i < bench->config.warmup; i++) {
+        AVD_CHECK_MSG(benchCase->setup == NULL || benchCase->setup(benchCase->userData), "Setup failed for benchmark %s", benchCase->name);
+        benchCase->run(benchCase->userData);
+    }
+
+    AVD_UInt32 repetitions = bench->config.repetitions;
+    AVD_Double *samples    = (AVD_Double *)AVD_MALLOC(sizeof(AVD_Double) * repetitions);
+    AVD_CHECK_MSG(samples != NULL, "Failed to allocate benchmark samples");
+
+    AVD_Double totalMs = 0.0;
+    for (AVD_UInt32 i = 0; i < repetitions; i++) {
+        if (benchCase->setup != NULL && !benchCase->setup(benchCase->userData)) {
+            AVD_FREE(samples);
+            AVD_LOG_ERROR("Setup failed for benchmark %s", benchCase->name);
+            return false;
+        }
+
+        picoPerfTime start = picoPerfNow();
+        benchCase->run(benchCase->userData);
+        samples[i] = picoPerfDurationMilliseconds(start, picoPerfNow());
+        totalMs += samples[i];
+    }
+
+    qsort(samples, repetitions, sizeof(AVD_Double), PRIV_avdBenchCompareDouble);
+
+    AVD_BenchResult result = {0};
+    snprintf(result.name, sizeof(result.name), "%s", benchCase->name);
+    snprintf(result.unit, sizeof(result.unit), "%s", benchCase->unit ? benchCase->unit : "ops");
+    result.itemsPerRepetition = benchCase->itemsPerRepetition;
+    result.repetitions        = repetitions;
+    result.minMs              = samples[0];
+    result.meanMs             = totalMs / (AVD_Double)repetitions;
+    result.p50Ms              = avdBenchPercentile(samples, repetitions, 50.0);
+    result.p90Ms              = avdBenchPercentile(samples, repetitions, 90.0);
+    result.p99Ms              = avdBenchPercentile(samples, repetitions, 99.0);
+    result.maxMs              = samples[repetitions - 1];
+    result.throughput         = result.p50Ms > 0.0 ? (AVD_Double)result.itemsPerRepetition / (result.p50Ms / 1000.0) : 0.0;
+    AVD_FREE(samples);
+
+    avdListPushBack(&bench->results, &result);
+
+    AVD_LOG_INFO("  %-40s p50 %10.4f ms, p90 %10.4f ms, p99 %10.4f ms, %10.2f M%s/s",
+                 result.name,
+                 result.p50Ms,
+                 result.p90Ms,
+                 result.p99Ms,
+                 result.throughput / 1.0e6,
+                 result.unit);
+    return true;
+}
+
+bool avdBenchWriteJson(const AVD_Bench *bench, const char *path)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_ASSERT(path != NULL);
+
+    FILE *file = fopen(path, "w");
+    AVD_CHECK_MSG(file != NULL, "Failed to open benchmark report %s for writing", path);
+
+    fprintf(file, "{\n  \"warmup\": %u,\n  \"repetitions\": %u,\n  \"results\": [", bench->config.warmup, bench->config.repetitions);
+    for (AVD_Size i = 0; i < bench->results.count; i++) {
+        const AVD_BenchResult *result = (const AVD_BenchResult *)avdListGet(&bench->results, i);
+        fprintf(file, "%s\n    {\"name\": \"%s\", \"unit\": \"%s\", \"itemsPerRepetition\": %zu, \"repetitions\": %u, ", i == 0 ? "" : ",", result->name, result->unit, result->itemsPerRepetition, result->repetitions);
+        fprintf(file, "\"minMs\": %.6f, \"meanMs\": %.6f, \"p50Ms\": %.6f, \"p90Ms\": %.6f, \"p99Ms\": %.6f, \"maxMs\": %.6f, ", result->minMs, result->meanMs, result->p50Ms, result->p90Ms, result->p99Ms, result->maxMs);
+        fprintf(file, "\"throughput\": %.3f}", result->throughput);
+    }
+    fprintf(file, "\n  ]\n}\n");
+
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    AVD_CHECK_MSG(ok, "Failed to write benchmark report %s", path);
+    return true;
+}
+
+bool avdBenchCompare(const AVD_Bench *bench, const char *baselinePath, AVD_Double tolerance, AVD_Size *outRegressionCount)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_ASSERT(baselinePath != NULL);
+    AVD_ASSERT(outRegressionCount != NULL);
+
+    char *json    = NULL;
+    AVD_Size size = 0;
+    AVD_CHECK_MSG(avdReadBinaryFile(baselinePath, (void **)&json, &size), "Failed to read benchmark baseline %s", baselinePath);
+
+    AVD_Size regressions = 0;
+    for (AVD_Size i = 0; i < bench->results.count; i++) {
+        const AVD_BenchResult *result = (const AVD_BenchResult *)avdListGet(&bench->results, i);
+
+        AVD_Double baselineMs = 0.0;
+        if (!PRIV_avdBenchFindBaselineMedian(json, result->name, &baselineMs) || baselineMs <= 0.0) {
+            continue;
+        }
+
+        AVD_Double change = (result->p50Ms - baselineMs) / baselineMs;
+        if (change > tolerance) {
+            regressions++;
+            AVD_LOG_WARN("  REGRESSION %-40s p50 %10.4f ms, baseline %10.4f ms (%+.1f%%)", result->name, result->p50Ms, baselineMs, change * 100.0);
+        } else {
+            AVD_LOG_INFO("  %-40s p50 %10.4f ms, baseline %10.4f ms (%+.1f%%)", result->name, result->p50Ms, baselineMs, change * 100.0);
+        }
+    }
+    AVD_FREE(json);
+
+    *outRegressionCount = regressions;
+    return true;
+}
@@ -0,0 +1,121 @@
+#include "core/avd_core.h"
+
+static AVD_UInt32 PRIV_avdBenchTestSetupCalls = 0;
+static AVD_UInt32 PRIV_avdBenchTestRunCalls   = 0;
+
+static bool PRIV_avdBenchTestSetup(void *userData)
+{
+    (void)userData;
+    PRIV_avdBenchTestSetupCalls++;
+    return true;
+}
+
+static void PRIV_avdBenchTestRun(void *userData)
+{
+    volatile AVD_UInt64 *sink = (volatile AVD_UInt64 *)userData;
+    for (AVD_UInt64 i = 0; i < 1000; i++) {
+        *sink += i;
+    }
+    PRIV_avdBenchTestRunCalls++;
+}
+
+static bool PRIV_avdTestBenchPercentile()
+{
+    AVD_LOG_DEBUG("  Testing Bench percentiles...");
+
+    AVD_Double samples[] = {1.0, 2.0, 3.0, 4.0, 5.0};
+    AVD_CHECK_MSG(avdBenchPercentile(samples, 5, 0.0) == 1.0, "p0 should be the minimum");
+    AVD_CHECK_MSG(avdBenchPercentile(samples, 5, 50.0) == 3.0, "p50 of an odd count should be the middle sample");
+    AVD_CHECK_MSG(avdBenchPercentile(samples, 5, 100.0) == 5.0, "p100 should be the maximum");
+    AVD_CHECK_MSG(fabs(avdBenchPercentile(samples, 4, 50.0) - 2.5) < 1e-9, "p50 of an even count should interpolate");
+    AVD_CHECK_MSG(fabs(avdBenchPercentile(samples, 5, 90.0) - 4.6) < 1e-9, "p90 should interpolate between the top samples");
+    AVD_CHECK_MSG(avdBenchPercentile(samples, 1, 99.0) == 1.0, "A single sample is every percentile");
+
+    AVD_LOG_DEBUG("    Bench percentiles PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestBenchRun()
+{
+    AVD_LOG_DEBUG("  Testing Bench run...");
+
+    AVD_BenchConfig config = {.warmup = 3, .repetitions = 7, .filter = "bench_test"};
+    AVD_Bench bench;
+    AVD_CHECK(avdBenchCreate(&bench, &config));
+
+    AVD_UInt64 sink         = 0;
+    AVD_BenchCase benchCase = {
+        .name               = "bench_test/counter",
+        .unit               = "ops",
+        .itemsPerRepetition = 1000,
+        .setup              = PRIV_avdBenchTestSetup,
+        .run                = PRIV_avdBenchTestRun,
+        .userData           = &sink,
+    };
+    PRIV_avdBenchTestSetupCalls = 0;
+    PRIV_avdBenchTestRunCalls   = 0;
+    AVD_CHECK(avdBenchRun(&bench, &benchCase));
+
+    // filtered out cases are skipped without an error
+    benchCase.name = "other/counter";
+    AVD_CHECK(avdBenchRun(&bench, &benchCase));
+
+    bool countsOk = PRIV_avdBenchTestSetupCalls == 10 && PRIV_avdBenchTestRunCalls == 10;
+    bool resultOk = bench.results.count == 1;
+    if (resultOk) {
+        const AVD_BenchResult *result = (const AVD_BenchResult *)avdListGet(&bench.results, 0);
+        bool ordered                  = result->minMs <= result->p50Ms && result->p50Ms <= result->p90Ms &&
+                       result->p90Ms <= result->p99Ms && result->p99Ms <= result->maxMs;
+        resultOk = ordered && result->repetitions == 7 && strcmp(result->name, "bench_test/counter") == 0;
+    }
+    avdBenchDestroy(&bench);
+
+    AVD_CHECK_MSG(countsOk, "Expected 10 setup and run calls, got %u and %u", PRIV_avdBenchTestSetupCalls, PRIV_avdBenchTestRunCalls);
+    AVD_CHECK_MSG(resultOk, "Benchmark result is inconsistent");
+
+    AVD_LOG_DEBUG("    Bench run PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestBenchCompare()
+{
+    AVD_LOG_DEBUG("  Testing Bench baseline comparison...");
+
+    AVD_Bench bench;
+    AVD_CHECK(avdBenchCreate(&bench, NULL));
+
+    AVD_BenchResult fast = {.name = "bench_test/a", .unit = "ops", .repetitions = 1, .p50Ms = 4.0};
+    AVD_BenchResult slow = {.name = "bench_test/ab", .unit = "ops", .repetitions = 1, .p50Ms = 10.0};
+    avdListPushBack(&bench.results, &fast);
+    avdListPushBack(&bench.results, &slow);
+
+    const char *path = "avd_bench_baseline_test.json";
+    bool written     = avdBenchWriteJson(&bench, path);
+
+    // a is 5% slower (within tolerance), ab is twice as slow
+    ((AVD_BenchResult *)avdListGet(&bench.results, 0))->p50Ms = 4.2;
+    ((AVD_BenchResult *)avdListGet(&bench.results, 1))->p50Ms = 20.0;
+
+    AVD_Size regressions = 0;
+    bool compared        = written && avdBenchCompare(&bench, path, 0.10, &regressions);
+    remove(path);
+    avdBenchDestroy(&bench);
+
+    AVD_CHECK_MSG(compared, "Failed to write or compare the baseline");
+    AVD_CHECK_MSG(regressions == 1, "Expected exactly one regression, got %zu", regressions);
+
+    AVD_LOG_DEBUG("    Bench baseline comparison PASSED");
+    return true;
+}
+
+bool avdBenchTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Bench Tests...");
+
+    AVD_CHECK(PRIV_avdTestBenchPercentile());
+    AVD_CHECK(PRIV_avdTestBenchRun());
+    AVD_CHECK(PRIV_avdTestBenchCompare());
+
+    AVD_LOG_DEBUG("All AVD Bench Tests PASSED");
+    return true;
+}
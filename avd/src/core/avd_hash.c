@@ -0,0 +1,448 @@
+#include "core/avd_hash.h"
+
+#if !defined(AVD_HASH_NO_SIMD)
+#if defined(__AVX2__)
+#define AVD_HASH_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AVD_HASH_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define AVD_HASH_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#define AVD_HASH_PRIME32_1 0x9E3779B1ull
+#define AVD_HASH_PRIME32_2 0x85EBCA77ull
+#define AVD_HASH_PRIME32_3 0xC2B2AE3Dull
+#define AVD_HASH_PRIME64_1 0x9E3779B185EBCA87ull
+#define AVD_HASH_PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define AVD_HASH_PRIME64_3 0x165667B19E3779F9ull
+#define AVD_HASH_PRIME64_4 0x85EBCA77C2B2AE63ull
+#define AVD_HASH_PRIME64_5 0x27D4EB2F165667C5ull
+
+// Hexadecimal digits of pi, the first half keys the stripe lanes and the second half the final fold.
+static const AVD_UInt64 PRIV_avdHashSecret[AVD_HASH_LANE_COUNT * 2] = {
+    0x243F6A8885A308D3ull,
+    0x13198A2E03707344ull,
+    0xA4093822299F31D0ull,
+    0x082EFA98EC4E6C89ull,
+    0x452821E638D01377ull,
+    0xBE5466CF34E90C6Cull,
+    0xC0AC29B7C97C50DDull,
+    0x3F84D5B5B5470917ull,
+    0x9216D5D98979FB1Bull,
+    0xD1310BA698DFB5ACull,
+    0x2FFD72DBD01ADFB7ull,
+    0xB8E1AFED6A267E96ull,
+    0xBA7C9045F12C7F99ull,
+    0x24A19947B3916CF7ull,
+    0x0801F2E2858EFC16ull,
+    0x636920D871574E69ull,
+};
+
+static bool PRIV_avdHashSimdEnabled = true;
+
+// NOTE: All reads assume a little endian host, which holds for every platform we target.
+static AVD_UInt64 PRIV_avdHashRead64(const AVD_UInt8 *ptr)
+{
+    AVD_UInt64 value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+static AVD_UInt64 PRIV_avdHashRead32(const AVD_UInt8 *ptr)
+{
+    AVD_UInt32 value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+static AVD_UInt64 PRIV_avdHashMul128Fold64(AVD_UInt64 a, AVD_UInt64 b)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128)a * b;
+    return (AVD_UInt64)product ^ (AVD_UInt64)(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    AVD_UInt64 high = 0;
+    AVD_UInt64 low  = _umul128(a, b, &high);
+    return low ^ high;
+#else
+    AVD_UInt64 aLow   = a & 0xFFFFFFFFull;
+    AVD_UInt64 aHigh  = a >> 32;
+    AVD_UInt64 bLow   = b & 0xFFFFFFFFull;
+    AVD_UInt64 bHigh  = b >> 32;
+    AVD_UInt64 lolo   = aLow * bLow;
+    AVD_UInt64 hilo   = aHigh * bLow;
+    AVD_UInt64 lohi   = aLow * bHigh;
+    AVD_UInt64 hihi   = aHigh * bHigh;
+    AVD_UInt64 cross  = (lolo >> 32) + (hilo & 0xFFFFFFFFull) + lohi;
+    AVD_UInt64 high   = (hilo >> 32) + (cross >> 32) + hihi;
+    AVD_UInt64 lowOut = (cross << 32) | (lolo & 0xFFFFFFFFull);
+    return lowOut ^ high;
+#endif
+}
+
+static AVD_UInt64 PRIV_avdHashAvalanche(AVD_UInt64 hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static void PRIV_avdHashSeededKeys(AVD_UInt64 seed, AVD_UInt64 *outKeys, AVD_Size offset)
+{
+    for (AVD_Size i = 0; i < AVD_HASH_LANE_COUNT; i++) {
+        AVD_UInt64 secret = PRIV_avdHashSecret[(offset + i) % AVD_ARRAY_COUNT(PRIV_avdHashSecret)];
+        outKeys[i]        = (i & 1) ? secret - seed : secret + seed;
+    }
+}
+
+static AVD_UInt64 PRIV_avdHashShort(const AVD_UInt8 *data, AVD_Size size, AVD_UInt64 seed, AVD_Size keyOffset)
+{
+    AVD_UInt64 keys[AVD_HASH_LANE_COUNT];
+    PRIV_avdHashSeededKeys(seed, keys, keyOffset);
+
+    if (size == 0) {
+        return PRIV_avdHashAvalanche(seed ^ keys[0] ^ keys[1]);
+    }
+
+    // 1 to 16 bytes, read the first and last word (they overlap for sizes below 16)
+    if (size <= 16) {
+        AVD_UInt64 first = 0;
+        AVD_UInt64 last  = 0;
+        if (size >= 8) {
+            first = PRIV_avdHashRead64(data);
+            last  = PRIV_avdHashRead64(data + size - 8);
+        } else if (size >= 4) {
+            first = PRIV_avdHashRead32(data);
+            last  = PRIV_avdHashRead32(data + size - 4);
+        } else {
+            first = ((AVD_UInt64)data[0] << 16) | ((AVD_UInt64)data[size >> 1] << 8) | (AVD_UInt64)data[size - 1];
+        }
+        AVD_UInt64 folded = PRIV_avdHashMul128Fold64(first ^ keys[0], last ^ keys[1]);
+        return PRIV_avdHashAvalanche(folded ^ (size * AVD_HASH_PRIME64_1) ^ keys[2]);
+    }
+
+    // 17 to 63 bytes, mix 16 bytes per step with the final step aligned to the end of the input
+    AVD_UInt64 accumulator = size * AVD_HASH_PRIME64_1 + keys[2];
+    AVD_Size step          = 0;
+    for (AVD_Size offset = 0; offset < size; offset += 16, step++) {
+        const AVD_UInt8 *chunk = offset + 16 <= size ? data + offset : data + size - 16;
+        AVD_UInt64 keyLow      = keys[(step * 2) % AVD_HASH_LANE_COUNT];
+        AVD_UInt64 keyHigh     = keys[(step * 2 + 1) % AVD_HASH_LANE_COUNT];
+        accumulator += PRIV_avdHashMul128Fold64(PRIV_avdHashRead64(chunk) ^ keyLow, PRIV_avdHashRead64(chunk + 8) ^ keyHigh);
+    }
+    return PRIV_avdHashAvalanche(accumulator);
+}
+
+static void PRIV_avdHashAccumulateScalar(AVD_UInt64 *accumulators, const AVD_UInt8 *data, AVD_Size stripeCount, const AVD_UInt64 *keys)
+{
+    for (AVD_Size stripe = 0; stripe < stripeCount; stripe++) {
+        const AVD_UInt8 *stripeData = data + stripe * AVD_HASH_STRIPE_SIZE;
+        for (AVD_Size lane = 0; lane < AVD_HASH_LANE_COUNT; lane++) {
+            AVD_UInt64 value = PRIV_avdHashRead64(stripeData + lane * 8);
+            AVD_UInt64 keyed = value ^ keys[lane];
+            accumulators[lane ^ 1] += value;
+            accumulators[lane] += (keyed & 0xFFFFFFFFull) * (keyed >> 32);
+        }
+    }
+}
+
+#if defined(AVD_HASH_AVX2)
+static void PRIV_avdHashAccumulateSimd(AVD_UInt64 *accumulators, const AVD_UInt8 *data, AVD_Size stripeCount, const AVD_UInt64 *keys)
+{
+    __m256i acc[2];
+    __m256i key[2];
+    for (AVD_Size i = 0; i < 2; i++) {
+        acc[i] = _mm256_loadu_si256((const __m256i *)(accumulators + i * 4));
+        key[i] = _mm256_loadu_si256((const __m256i *)(keys + i * 4));
+    }
+
+    for (AVD_Size stripe = 0; stripe < stripeCount; stripe++) {
+        const AVD_UInt8 *stripeData = data + stripe * AVD_HASH_STRIPE_SIZE;
+        for (AVD_Size i = 0; i < 2; i++) {
+            __m256i value   = _mm256_loadu_si256((const __m256i *)(stripeData + i * 32));
+            __m256i keyed   = _mm256_xor_si256(value, key[i]);
+            __m256i keyedHi = _mm256_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+            __m256i product = _mm256_mul_epu32(keyed, keyedHi);
+            __m256i swapped = _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+            acc[i]          = _mm256_add_epi64(acc[i], _mm256_add_epi64(product, swapped));
+        }
+    }
+
+    for (AVD_Size i = 0; i < 2; i++) {
+        _mm256_storeu_si256((__m256i *)(accumulators + i * 4), acc[i]);
+    }
+}
+#elif defined(AVD_HASH_SSE2)
+static void PRIV_avdHashAccumulateSimd(AVD_UInt64 *accumulators, const AVD_UInt8 *data, AVD_Size stripeCount, const AVD_UInt64 *keys)
+{
+    __m128i acc[4];
+    __m128i key[4];
+    for (AVD_Size i = 0; i < 4; i++) {
+        acc[i] = _mm_loadu_si128((const __m128i *)(accumulators + i * 2));
+        key[i] = _mm_loadu_si128((const __m128i *)(keys + i * 2));
+    }
+
+    for (AVD_Size stripe = 0; stripe < stripeCount; stripe++) {
+        const AVD_UInt8 *stripeData = data + stripe * AVD_HASH_STRIPE_SIZE;
+        for (AVD_Size i = 0; i < 4; i++) {
+            __m128i value   = _mm_loadu_si128((const __m128i *)(stripeData + i * 16));
+            __m128i keyed   = _mm_xor_si128(value, key[i]);
+            __m128i keyedHi = _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+            __m128i product = _mm_mul_epu32(keyed, keyedHi);
+            __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+            acc[i]          = _mm_add_epi64(acc[i], _mm_add_epi64(product, swapped));
+        }
+    }
+
+    for (AVD_Size i = 0; i < 4; i++) {
+        _mm_storeu_si128((__m128i *)(accumulators + i * 2), acc[i]);
+    }
+}
+#elif defined(AVD_HASH_NEON)
+static void PRIV_avdHashAccumulateSimd(AVD_UInt64 *accumulators, const AVD_UInt8 *data, AVD_Size stripeCount, const AVD_UInt64 *keys)
+{
+    uint64x2_t acc[4];
+    uint64x2_t key[4];
+    for (AVD_Size i = 0; i < 4; i++) {
+        acc[i] = vld1q_u64(accumulators + i * 2);
+        key[i] = vld1q_u64(keys + i * 2);
+    }
+
+    for (AVD_Size stripe = 0; stripe < stripeCount; stripe++) {
+        const AVD_UInt8 *stripeData = data + stripe * AVD_HASH_STRIPE_SIZE;
+        for (AVD_Size i = 0; i < 4; i++) {
+            uint64x2_t value   = vreinterpretq_u64_u8(vld1q_u8(stripeData + i * 16));
+            uint64x2_t keyed   = veorq_u64(value, key[i]);
+            uint64x2_t product = vmull_u32(vmovn_u64(keyed), vshrn_n_u64(keyed, 32));
+            uint64x2_t swapped = vextq_u64(value, value, 1);
+            acc[i]             = vaddq_u64(acc[i], vaddq_u64(product, swapped));
+        }
+    }
+
+    for (AVD_Size i = 0; i < 4; i++) {
+        vst1q_u64(accumulators + i * 2, acc[i]);
+    }
+}
+#endif
+
+static void PRIV_avdHashAccumulate(AVD_UInt64 *accumulators, const AVD_UInt8 *data, AVD_Size stripeCount, const AVD_UInt64 *keys)
+{
+#if defined(AVD_HASH_AVX2) || defined(AVD_HASH_SSE2) || defined(AVD_HASH_NEON)
+    if (PRIV_avdHashSimdEnabled) {
+        PRIV_avdHashAccumulateSimd(accumulators, data, stripeCount, keys);
+        return;
+    }
+#endif
+    PRIV_avdHashAccumulateScalar(accumulators, data, stripeCount, keys);
+}
+
+static void PRIV_avdHashScramble(AVD_UInt64 *accumulators, AVD_UInt64 seed)
+{
+    AVD_UInt64 keys[AVD_HASH_LANE_COUNT];
+    PRIV_avdHashSeededKeys(seed, keys, AVD_HASH_LANE_COUNT);
+
+    for (AVD_Size lane = 0; lane < AVD_HASH_LANE_COUNT; lane++) {
+        AVD_UInt64 value = accumulators[lane];
+        value ^= value >> 47;
+        value ^= keys[lane];
+        accumulators[lane] = value * AVD_HASH_PRIME32_1;
+    }
+}
+
+// Consumes whole stripes and scrambles the accumulators at every block boundary.
+static void PRIV_avdHashConsumeStripes(AVD_HashState *state, const AVD_UInt8 *data, AVD_Size stripeCount)
+{
+    AVD_UInt64 keys[AVD_HASH_LANE_COUNT];
+    PRIV_avdHashSeededKeys(state->seed, keys, 0);
+
+    while (stripeCount > 0) {
+        AVD_Size batch = AVD_MIN(stripeCount, (AVD_Size)(AVD_HASH_STRIPES_PER_BLOCK - state->stripesInBlock));
+        PRIV_avdHashAccumulate(state->accumulators, data, batch, keys);
+
+        data += batch * AVD_HASH_STRIPE_SIZE;
+        stripeCount -= batch;
+        state->stripesInBlock += (AVD_UInt32)batch;
+
+        if (state->stripesInBlock == AVD_HASH_STRIPES_PER_BLOCK) {
+            PRIV_avdHashScramble(state->accumulators, state->seed);
+            state->stripesInBlock = 0;
+        }
+    }
+}
+
+static AVD_UInt64 PRIV_avdHashFinalizeLong(const AVD_HashState *state, AVD_Size keyOffset)
+{
+    AVD_UInt64 accumulators[AVD_HASH_LANE_COUNT];
+    memcpy(accumulators, state->accumulators, sizeof(accumulators));
+
+    // the tail (1 to 64 bytes) is zero padded into a last stripe, the total size below disambiguates the padding
+    AVD_UInt8 lastStripe[AVD_HASH_STRIPE_SIZE] = {0};
+    memcpy(lastStripe, state->buffer, state->bufferSize);
+
+    AVD_UInt64 keys[AVD_HASH_LANE_COUNT];
+    PRIV_avdHashSeededKeys(state->seed, keys, 0);
+    PRIV_avdHashAccumulate(accumulators, lastStripe, 1, keys);
+
+    AVD_UInt64 finalKeys[AVD_HASH_LANE_COUNT];
+    PRIV_avdHashSeededKeys(state->seed, finalKeys, keyOffset);
+
+    AVD_UInt64 result = state->totalSize * AVD_HASH_PRIME64_1;
+    for (AVD_Size i = 0; i < AVD_HASH_LANE_COUNT; i += 2) {
+        result += PRIV_avdHashMul128Fold64(accumulators[i] ^ finalKeys[i], accumulators[i + 1] ^ finalKeys[i + 1]);
+    }
+    return PRIV_avdHashAvalanche(result);
+}
+
+void avdHashStateInit(AVD_HashState *state, AVD_UInt64 seed)
+{
+    AVD_ASSERT(state != NULL);
+
+    state->accumulators[0] = AVD_HASH_PRIME32_3;
+    state->accumulators[1] = AVD_HASH_PRIME64_1;
+    state->accumulators[2] = AVD_HASH_PRIME64_2;
+    state->accumulators[3] = AVD_HASH_PRIME64_3;
+    state->accumulators[4] = AVD_HASH_PRIME64_4;
+    state->accumulators[5] = AVD_HASH_PRIME32_2;
+    state->accumulators[6] = AVD_HASH_PRIME64_5;
+    state->accumulators[7] = AVD_HASH_PRIME32_1;
+    state->seed            = seed;
+    state->totalSize       = 0;
+    state->stripesInBlock  = 0;
+    state->bufferSize      = 0;
+}
+
+void avdHashStateUpdate(AVD_HashState *state, const void *data, AVD_Size size)
+{
+    AVD_ASSERT(state != NULL);
+    AVD_ASSERT(data != NULL || size == 0);
+
+    const AVD_UInt8 *input = (const AVD_UInt8 *)data;
+    state->totalSize += size;
+
+    // the buffer is only flushed once more input arrives, so it always holds the last 1 to 64 bytes
+    if (state->bufferSize > 0) {
+        AVD_Size toCopy = AVD_MIN(size, (AVD_Size)(AVD_HASH_STRIPE_SIZE - state->bufferSize));
+        memcpy(state->buffer + state->bufferSize, input, toCopy);
+        state->bufferSize += (AVD_UInt32)toCopy;
+        input += toCopy;
+        size -= toCopy;
+
+        if (size == 0) {
+            return;
+        }
+
+        PRIV_avdHashConsumeStripes(state, state->buffer, 1);
+        state->bufferSize = 0;
+    }
+
+    if (size > AVD_HASH_STRIPE_SIZE) {
+        AVD_Size stripeCount = (size - 1) / AVD_HASH_STRIPE_SIZE;
+        PRIV_avdHashConsumeStripes(state, input, stripeCount);
+        input += stripeCount * AVD_HASH_STRIPE_SIZE;
+        size -= stripeCount * AVD_HASH_STRIPE_SIZE;
+    }
+
+    memcpy(state->buffer, input, size);
+    state->bufferSize = (AVD_UInt32)size;
+}
+
+AVD_UInt64 avdHashStateDigest(const AVD_HashState *state)
+{
+    AVD_ASSERT(state != NULL);
+
+    if (state->totalSize < AVD_HASH_STRIPE_SIZE) {
+        return PRIV_avdHashShort(state->buffer, (AVD_Size)state->totalSize, state->seed, 0);
+    }
+    return PRIV_avdHashFinalizeLong(state, AVD_HASH_LANE_COUNT);
+}
+
+AVD_Hash128 avdHashStateDigest128(const AVD_HashState *state)
+{
+    AVD_ASSERT(state != NULL);
+
+    AVD_Hash128 result = {0};
+    if (state->totalSize < AVD_HASH_STRIPE_SIZE) {
+        result.low  = PRIV_avdHashShort(state->buffer, (AVD_Size)state->totalSize, state->seed, 0);
+        result.high = PRIV_avdHashShort(state->buffer, (AVD_Size)state->totalSize, state->seed, AVD_HASH_LANE_COUNT);
+    } else {
+        result.low  = PRIV_avdHashFinalizeLong(state, AVD_HASH_LANE_COUNT);
+        result.high = PRIV_avdHashFinalizeLong(state, AVD_HASH_LANE_COUNT + 3);
+    }
+    return result;
+}
+
+AVD_UInt64 avdHash64(const void *data, AVD_Size size, AVD_UInt64 seed)
+{
+    AVD_ASSERT(data != NULL || size == 0);
+
+    if (size < AVD_HASH_STRIPE_SIZE) {
+        return PRIV_avdHashShort((const AVD_UInt8 *)data, size, seed, 0);
+    }
+
+    AVD_HashState state;
+    avdHashStateInit(&state, seed);
+    avdHashStateUpdate(&state, data, size);
+    return avdHashStateDigest(&state);
+}
+
+AVD_UInt64 avdHash64String(const char *str)
+{
+    AVD_ASSERT(str != NULL);
+    return avdHash64(str, strlen(str), AVD_HASH_DEFAULT_SEED);
+}
+
+AVD_Hash128 avdHash128(const void *data, AVD_Size size, AVD_UInt64 seed)
+{
+    AVD_ASSERT(data != NULL || size == 0);
+
+    if (size < AVD_HASH_STRIPE_SIZE) {
+        AVD_Hash128 result = {
+            .low  = PRIV_avdHashShort((const AVD_UInt8 *)data, size, seed, 0),
+            .high = PRIV_avdHashShort((const AVD_UInt8 *)data, size, seed, AVD_HASH_LANE_COUNT),
+        };
+        return result;
+    }
+
+    AVD_HashState state;
+    avdHashStateInit(&state, seed);
+    avdHashStateUpdate(&state, data, size);
+    return avdHashStateDigest128(&state);
+}
+
+AVD_UInt64 avdHash64Combine(AVD_UInt64 a, AVD_UInt64 b)
+{
+    AVD_UInt64 pair[2] = {a, b};
+    return avdHash64(pair, sizeof(pair), AVD_HASH_DEFAULT_SEED);
+}
+
+const char *avdHashBackendName(void)
+{
+    if (!PRIV_avdHashSimdEnabled) {
+        return "scalar";
+    }
+#if defined(AVD_HASH_AVX2)
+    return "avx2";
+#elif defined(AVD_HASH_SSE2)
+    return "sse2";
+#elif defined(AVD_HASH_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+void avdHashSetSimdEnabled(bool enabled)
+{
+    PRIV_avdHashSimdEnabled = enabled;
+}
@@ -0,0 +1,330 @@
+#include "core/avd_core.h"
+#include <string.h>
+
+static AVD_UInt64 PRIV_avdHashTestRandom(AVD_UInt64 *state)
+{
+    AVD_UInt64 x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+static void PRIV_avdHashTestFillRandom(AVD_UInt8 *buffer, size_t size, AVD_UInt64 seed)
+{
+    AVD_UInt64 state = seed | 1;
+    for (size_t i = 0; i < size; i++) {
+        buffer[i] = (AVD_UInt8)(PRIV_avdHashTestRandom(&state) >> 56);
+    }
+}
+
+static int PRIV_avdHashTestCompareUInt64(const void *a, const void *b)
+{
+    AVD_UInt64 lhs = *(const AVD_UInt64 *)a;
+    AVD_UInt64 rhs = *(const AVD_UInt64 *)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static int PRIV_avdHashTestCompareUInt32(const void *a, const void *b)
+{
+    AVD_UInt32 lhs = *(const AVD_UInt32 *)a;
+    AVD_UInt32 rhs = *(const AVD_UInt32 *)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static bool PRIV_avdTestHashDeterminism()
+{
+    AVD_LOG_DEBUG("  Testing Hash determinism and seeding...");
+
+    static AVD_UInt8 buffer[4096];
+    PRIV_avdHashTestFillRandom(buffer, sizeof(buffer), 0x1234);
+
+    // cover every length class: empty, short, mid, exactly one stripe, multiple blocks
+    size_t sizes[] = {0, 1, 3, 4, 7, 8, 15, 16, 17, 63, 64, 65, 127, 1024, 1025, 4096};
+    for (size_t i = 0; i < AVD_ARRAY_COUNT(sizes); i++) {
+        AVD_UInt64 first  = avdHash64(buffer, sizes[i], 0);
+        AVD_UInt64 second = avdHash64(buffer, sizes[i], 0);
+        AVD_UInt64 seeded = avdHash64(buffer, sizes[i], 42);
+        if (first != second || first == seeded) {
+            AVD_LOG_ERROR("    FAILED: Hash determinism/seeding for size %zu", sizes[i]);
+            return false;
+        }
+
+        AVD_Hash128 wide = avdHash128(buffer, sizes[i], 0);
+        if (wide.low == wide.high) {
+            AVD_LOG_ERROR("    FAILED: 128 bit hash halves are identical for size %zu", sizes[i]);
+            return false;
+        }
+
+        if (i > 0 && avdHash64(buffer, sizes[i - 1], 0) == first) {
+            AVD_LOG_ERROR("    FAILED: Hash of prefix %zu equals hash of size %zu", sizes[i - 1], sizes[i]);
+            return false;
+        }
+    }
+
+    // zero padding of the last stripe must not make trailing zero bytes invisible
+    static AVD_UInt8 zeros[256] = {0};
+    for (size_t size = 64; size < 255; size++) {
+        if (avdHash64(zeros, size, 0) == avdHash64(zeros, size + 1, 0)) {
+            AVD_LOG_ERROR("    FAILED: Trailing zero byte not reflected in hash for size %zu", size);
+            return false;
+        }
+    }
+
+    if (avdHash64String("avd") != avdHash64("avd", 3, AVD_HASH_DEFAULT_SEED) ||
+        avdHash64Combine(1, 2) == avdHash64Combine(2, 1)) {
+        AVD_LOG_ERROR("    FAILED: String/combine helpers");
+        return false;
+    }
+
+    AVD_LOG_DEBUG("    Hash determinism and seeding PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestHashAvalanche()
+{
+    AVD_LOG_DEBUG("  Testing Hash avalanche...");
+
+    static AVD_UInt8 buffer[512];
+    size_t sizes[] = {4, 8, 13, 32, 100, 512};
+
+    for (size_t s = 0; s < AVD_ARRAY_COUNT(sizes); s++) {
+        PRIV_avdHashTestFillRandom(buffer, sizes[s], 0x9876 + s);
+        AVD_UInt64 reference = avdHash64(buffer, sizes[s], 0);
+
+        size_t totalFlipped = 0;
+        size_t bitCount     = sizes[s] * 8;
+        for (size_t bit = 0; bit < bitCount; bit++) {
+            buffer[bit / 8] ^= (AVD_UInt8)(1u << (bit % 8));
+            AVD_UInt64 flipped = avdHash64(buffer, sizes[s], 0) ^ reference;
+            buffer[bit / 8] ^= (AVD_UInt8)(1u << (bit % 8));
+
+            if (flipped == 0) {
+                AVD_LOG_ERROR("    FAILED: Flipping bit %zu of a %zu byte input left the hash unchanged", bit, sizes[s]);
+                return false;
+            }
+            for (; flipped; flipped &= flipped - 1) {
+                totalFlipped++;
+            }
+        }
+
+        // a good 64 bit hash flips 32 output bits per input bit on average
+        double average = (double)totalFlipped / (double)bitCount;
+        if (average < 28.0 || average > 36.0) {
+            AVD_LOG_ERROR("    FAILED: Poor avalanche for size %zu (%.2f bits flipped on average)", sizes[s], average);
+            return false;
+        }
+    }
+
+    AVD_LOG_DEBUG("    Hash avalanche PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestHashStreaming()
+{
+    AVD_LOG_DEBUG("  Testing Hash streaming matches one-shot...");
+
+    static AVD_UInt8 buffer[3000];
+    PRIV_avdHashTestFillRandom(buffer, sizeof(buffer), 0x5555);
+
+    // every split point of inputs around the stripe and block boundaries
+    size_t sizes[] = {0, 10, 63, 64, 65, 128, 200, 1023, 1024, 1025, 1100};
+    for (size_t s = 0; s < AVD_ARRAY_COUNT(sizes); s++) {
+        AVD_UInt64 expected     = avdHash64(buffer, sizes[s], 7);
+        AVD_Hash128 expected128 = avdHash128(buffer, sizes[s], 7);
+
+        for (size_t split = 0; split <= sizes[s]; split++) {
+            AVD_HashState state;
+            avdHashStateInit(&state, 7);
+            avdHashStateUpdate(&state, buffer, split);
+            avdHashStateUpdate(&state, buffer + split, sizes[s] - split);
+
+            AVD_Hash128 digest128 = avdHashStateDigest128(&state);
+            if (avdHashStateDigest(&state) != expected ||
+                digest128.low != expected128.low ||
+                digest128.high != expected128.high) {
+                AVD_LOG_ERROR("    FAILED: Streaming hash mismatch for size %zu split at %zu", sizes[s], split);
+                return false;
+            }
+        }
+    }
+
+    // random sized pieces over the whole buffer
+    AVD_UInt64 random = 0xABCDEF;
+    for (int round = 0; round < 64; round++) {
+        AVD_HashState state;
+        avdHashStateInit(&state, 0);
+
+        size_t offset = 0;
+        while (offset < sizeof(buffer)) {
+            size_t piece = (size_t)(PRIV_avdHashTestRandom(&random) % 300);
+            piece        = AVD_MIN(piece, sizeof(buffer) - offset);
+            avdHashStateUpdate(&state, buffer + offset, piece);
+            offset += piece;
+        }
+
+        if (avdHashStateDigest(&state) != avdHash64(buffer, sizeof(buffer), 0)) {
+            AVD_LOG_ERROR("    FAILED: Streaming hash mismatch with random pieces (round %d)", round);
+            return false;
+        }
+    }
+
+    AVD_LOG_DEBUG("    Hash streaming PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestHashSimdMatchesScalar()
+{
+    AVD_LOG_DEBUG("  Testing Hash %s backend matches scalar...", avdHashBackendName());
+
+    static AVD_UInt8 buffer[70000];
+    PRIV_avdHashTestFillRandom(buffer, sizeof(buffer), 0x7777);
+
+    size_t sizes[] = {64, 65, 100, 1024, 1087, 4096, 65536, 70000};
+    for (size_t s = 0; s < AVD_ARRAY_COUNT(sizes); s++) {
+        // the input is offset by s bytes to exercise unaligned loads
+        for (AVD_UInt64 seed = 0; seed < 3; seed++) {
+            avdHashSetSimdEnabled(true);
+            AVD_UInt64 simd = avdHash64(buffer + s, sizes[s] - s, seed);
+            avdHashSetSimdEnabled(false);
+            AVD_UInt64 scalar = avdHash64(buffer + s, sizes[s] - s, seed);
+            avdHashSetSimdEnabled(true);
+
+            if (simd != scalar) {
+                AVD_LOG_ERROR("    FAILED: SIMD and scalar hashes differ for size %zu seed %llu", sizes[s] - s, (unsigned long long)seed);
+                return false;
+            }
+        }
+    }
+
+    AVD_LOG_DEBUG("    Hash SIMD matches scalar PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestHashUrlCorpusCollisions()
+{
+    AVD_LOG_DEBUG("  Testing Hash collisions on a generated URL corpus...");
+
+    // shaped like the HLS segment URLs that are used as cache identities
+    const size_t urlCount = 1000000;
+    AVD_UInt64 *hashes64  = (AVD_UInt64 *)AVD_MALLOC(sizeof(AVD_UInt64) * urlCount);
+    AVD_UInt32 *hashes32  = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * urlCount);
+    AVD_CHECK_MSG(hashes64 != NULL && hashes32 != NULL, "Failed to allocate hash arrays");
+
+    char url[256];
+    for (size_t i = 0; i < urlCount; i++) {
+        int length = snprintf(url, sizeof(url), "https://cdn%zu.example.com/live/stream_%zu/1080p/segment_%08zu.ts?token=%zx",
+                              i % 7, i % 97, i, (i * 2654435761u) & 0xFFFFFF);
+        hashes64[i] = avdHash64(url, (size_t)length, AVD_HASH_DEFAULT_SEED);
+        hashes32[i] = avdHashBuffer(url, (size_t)length);
+    }
+
+    qsort(hashes64, urlCount, sizeof(AVD_UInt64), PRIV_avdHashTestCompareUInt64);
+    qsort(hashes32, urlCount, sizeof(AVD_UInt32), PRIV_avdHashTestCompareUInt32);
+
+    size_t collisions64 = 0;
+    size_t collisions32 = 0;
+    for (size_t i = 1; i < urlCount; i++) {
+        collisions64 += hashes64[i] == hashes64[i - 1];
+        collisions32 += hashes32[i] == hashes32[i - 1];
+    }
+
+    AVD_FREE(hashes64);
+    AVD_FREE(hashes32);
+
+    // ~116 collisions are expected from any 32 bit hash at this size, which is why identities moved to 64 bits
+    AVD_LOG_DEBUG("    %zu URLs: %zu collisions with 64 bit hashes, %zu with 32 bit hashes", urlCount, collisions64, collisions32);
+    if (collisions64 != 0) {
+        AVD_LOG_ERROR("    FAILED: 64 bit hash collisions in URL corpus");
+        return false;
+    }
+
+    AVD_LOG_DEBUG("    Hash URL corpus collisions PASSED");
+    return true;
+}
+
+typedef struct {
+    AVD_UInt8 *buffer;
+    size_t size;
+    size_t iterations;
+    bool simd;
+    AVD_UInt64 checksum;
+} AVD_HashBenchmark;
+
+static void PRIV_avdHashBenchmarkRun(void *userData)
+{
+    AVD_HashBenchmark *benchmark = (AVD_HashBenchmark *)userData;
+    avdHashSetSimdEnabled(benchmark->simd);
+    for (size_t i = 0; i < benchmark->iterations; i++) {
+        benchmark->checksum += avdHash64(benchmark->buffer, benchmark->size, benchmark->checksum);
+    }
+}
+
+static bool PRIV_avdHashBenchmark(AVD_Bench *bench, size_t size, size_t totalBytes)
+{
+    AVD_HashBenchmark benchmark = {.size = size, .iterations = AVD_MAX(totalBytes / size, (size_t)1)};
+    benchmark.buffer            = (AVD_UInt8 *)AVD_MALLOC(size);
+    AVD_CHECK_MSG(benchmark.buffer != NULL, "Failed to allocate benchmark buffer");
+    PRIV_avdHashTestFillRandom(benchmark.buffer, size, 0x4242);
+
+    // resolve the name while the SIMD path is still enabled, without one only the scalar case is run
+    const char *simdBackend = avdHashBackendName();
+    int firstBackend        = strcmp(simdBackend, "scalar") == 0 ? 1 : 0;
+
+    bool ok = true;
+    for (int backend = firstBackend; backend < 2 && ok; backend++) {
+        benchmark.simd = backend == 0;
+
+        char name[AVD_BENCH_NAME_LENGTH];
+        snprintf(name, sizeof(name), "hash/%s/%zu", benchmark.simd ? simdBackend : "scalar", size);
+
+        AVD_BenchCase benchCase = {
+            .name               = name,
+            .unit               = "bytes",
+            .itemsPerRepetition = benchmark.iterations * size,
+            .run                = PRIV_avdHashBenchmarkRun,
+            .userData           = &benchmark,
+        };
+        ok = avdBenchRun(bench, &benchCase);
+    }
+    avdHashSetSimdEnabled(true);
+
+    // keeps the loop from being optimized away
+    if (benchmark.checksum == 0x5EED) {
+        AVD_LOG_DEBUG("  unlikely checksum");
+    }
+
+    AVD_FREE(benchmark.buffer);
+    return ok;
+}
+
+bool avdHashTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Hash Tests...");
+
+    AVD_CHECK(PRIV_avdTestHashDeterminism());
+    AVD_CHECK(PRIV_avdTestHashAvalanche());
+    AVD_CHECK(PRIV_avdTestHashStreaming());
+    AVD_CHECK(PRIV_avdTestHashSimdMatchesScalar());
+    AVD_CHECK(PRIV_avdTestHashUrlCorpusCollisions());
+
+    AVD_LOG_DEBUG("All AVD Hash Tests PASSED");
+    return true;
+}
+
+bool avdHashBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD Hash benchmarks (%s backend)...", avdHashBackendName());
+
+    // sizes are per repetition, the harness repeats every case
+    AVD_CHECK(PRIV_avdHashBenchmark(bench, 16, 16 * 1024 * 1024));
+    AVD_CHECK(PRIV_avdHashBenchmark(bench, 64, 32 * 1024 * 1024));
+    AVD_CHECK(PRIV_avdHashBenchmark(bench, 256, 64 * 1024 * 1024));
+    AVD_CHECK(PRIV_avdHashBenchmark(bench, 4 * 1024, 64 * 1024 * 1024));
+    AVD_CHECK(PRIV_avdHashBenchmark(bench, 1024 * 1024, 64 * 1024 * 1024));
+    AVD_CHECK(PRIV_avdHashBenchmark(bench, 64 * 1024 * 1024, 64 * 1024 * 1024));
+
+    return true;
+}
@@ -1,82 +1,226 @@
 #include "core/avd_hashtable.h"
 #include "core/avd_utils.h"
 
-static size_t PRIV_avdHashTableHash(const AVD_HashTable *table, const void *key)
+static size_t PRIV_avdHashTableStoredKeySize(const AVD_HashTable *table, AVD_UInt32 keySize)
 {
-    if (table->stringKey) {
-        return avdHashString((const char *)key) % AVD_HASHTABLE_SIZE;
-    } else {
-        return avdHashBuffer(key, table->keySize) % AVD_HASHTABLE_SIZE;
+    // string keys keep their null terminator so that avdHashTableGetKeys can hand them out as C strings
+    return table->stringKey ? (size_t)keySize + 1 : (size_t)keySize;
+}
+
+static AVD_UInt32 PRIV_avdHashTableKeySize(const AVD_HashTable *table, const void *key)
+{
+    return table->stringKey ? (AVD_UInt32)strlen((const char *)key) : (AVD_UInt32)table->keySize;
+}
+
+static AVD_HashTableEntry *PRIV_avdHashTableGetEntry(const AVD_HashTable *table, AVD_UInt32 entryIndex)
+{
+    return &table->banks[entryIndex / AVD_HASHTABLE_BANK_CAPACITY].entries[entryIndex % AVD_HASHTABLE_BANK_CAPACITY];
+}
+
+static void *PRIV_avdHashTableGetValue(const AVD_HashTable *table, AVD_UInt32 entryIndex)
+{
+    AVD_HashTableBank *bank = &table->banks[entryIndex / AVD_HASHTABLE_BANK_CAPACITY];
+    return bank->values + (entryIndex % AVD_HASHTABLE_BANK_CAPACITY) * table->itemSize;
+}
+
+static const char *PRIV_avdHashTableGetEntryKey(const AVD_HashTable *table, const AVD_HashTableEntry *entry)
+{
+    if (PRIV_avdHashTableStoredKeySize(table, entry->keySize) <= AVD_HASHTABLE_INLINE_KEY_SIZE) {
+        return entry->inlineKey;
     }
+    return entry->externalKey;
 }
 
-static bool PRIV_avdHashTableKeysEqual(const AVD_HashTable *table, const void *key1, const void *key2)
+static size_t PRIV_avdHashTableProbeDistance(const AVD_HashTable *table, size_t slotIndex, AVD_UInt32 hash)
 {
-    if (table->stringKey) {
-        return strcmp((const char *)key1, (const char *)key2) == 0;
-    } else {
-        return memcmp(key1, key2, table->keySize) == 0;
+    size_t mask = table->slotCount - 1;
+    return (slotIndex - (hash & mask)) & mask;
+}
+
+static bool PRIV_avdHashTableAllocateSlots(AVD_HashTableSlot **outSlots, size_t slotCount)
+{
+    AVD_HashTableSlot *slots = (AVD_HashTableSlot *)AVD_MALLOC(sizeof(AVD_HashTableSlot) * slotCount);
+    if (!slots) {
+        return false;
     }
+
+    for (size_t i = 0; i < slotCount; i++) {
+        slots[i].hash       = 0;
+        slots[i].entryIndex = AVD_HASHTABLE_INVALID_INDEX;
+    }
+
+    *outSlots = slots;
+    return true;
 }
 
-static void PRIV_avdHashTableCopyKey(const AVD_HashTable *table, char *dest, const void *src)
+// Robin Hood insertion, the incoming slot steals the position of any resident
+// that is closer to its home bucket and the displaced slot continues probing.
+static void PRIV_avdHashTableInsertSlot(AVD_HashTable *table, AVD_HashTableSlot slot)
 {
-    if (table->stringKey) {
-        strncpy(dest, (const char *)src, AVD_HASHTABLE_KEY_MAX_SIZE - 1);
-        dest[AVD_HASHTABLE_KEY_MAX_SIZE - 1] = '\0';
-    } else {
-        memcpy(dest, src, table->keySize);
+    size_t mask     = table->slotCount - 1;
+    size_t index    = slot.hash & mask;
+    size_t distance = 0;
+
+    while (true) {
+        AVD_HashTableSlot *current = &table->slots[index];
+        if (current->entryIndex == AVD_HASHTABLE_INVALID_INDEX) {
+            *current = slot;
+            return;
+        }
+
+        size_t currentDistance = PRIV_avdHashTableProbeDistance(table, index, current->hash);
+        if (currentDistance < distance) {
+            AVD_HashTableSlot displaced = *current;
+            *current                    = slot;
+            slot                        = displaced;
+            distance                    = currentDistance;
+        }
+
+        index = (index + 1) & mask;
+        distance++;
     }
 }
 
-static AVD_HashTableEntry *PRIV_avdHashTableAllocateEntry(AVD_HashTable *table)
+static bool PRIV_avdHashTableRehash(AVD_HashTable *table, size_t newSlotCount)
 {
-    for (size_t i = 0; i < table->bankCount; i++) {
-        AVD_HashTableBank *bank = &table->banks[i];
-        for (size_t j = 0; j < bank->bankCount; j++) {
-            AVD_HashTableEntry *entry = &bank->entries[j];
-            if (entry->value == NULL) {
-                uint8_t *data = (uint8_t *)bank->dataHolder;
-                entry->value  = &data[j * table->itemSize];
-                return entry;
+    AVD_HashTableSlot *oldSlots = table->slots;
+    size_t oldSlotCount         = table->slotCount;
+
+    AVD_HashTableSlot *newSlots = NULL;
+    if (!PRIV_avdHashTableAllocateSlots(&newSlots, newSlotCount)) {
+        return false;
+    }
+
+    table->slots     = newSlots;
+    table->slotCount = newSlotCount;
+
+    for (size_t i = 0; i < oldSlotCount; i++) {
+        if (oldSlots[i].entryIndex != AVD_HASHTABLE_INVALID_INDEX) {
+            PRIV_avdHashTableInsertSlot(table, oldSlots[i]);
+        }
+    }
+
+    AVD_FREE(oldSlots);
+    return true;
+}
+
+static bool PRIV_avdHashTableFindSlot(const AVD_HashTable *table, const void *key, AVD_UInt32 keySize, AVD_UInt32 hash, size_t *outSlotIndex)
+{
+    size_t mask  = table->slotCount - 1;
+    size_t index = hash & mask;
+
+    for (size_t distance = 0;; distance++) {
+        const AVD_HashTableSlot *slot = &table->slots[index];
+        if (slot->entryIndex == AVD_HASHTABLE_INVALID_INDEX) {
+            return false;
+        }
+
+        // once we reach a slot that is closer to home than we are, the key cannot be further along
+        if (PRIV_avdHashTableProbeDistance(table, index, slot->hash) < distance) {
+            return false;
+        }
+
+        if (slot->hash == hash) {
+            const AVD_HashTableEntry *entry = PRIV_avdHashTableGetEntry(table, slot->entryIndex);
+            if (entry->keySize == keySize && memcmp(PRIV_avdHashTableGetEntryKey(table, entry), key, keySize) == 0) {
+                *outSlotIndex = index;
+                return true;
             }
         }
+
+        index = (index + 1) & mask;
+    }
+}
+
+static bool PRIV_avdHashTableAddBank(AVD_HashTable *table)
+{
+    AVD_HashTableBank *banks = (AVD_HashTableBank *)AVD_REALLOC(table->banks, sizeof(AVD_HashTableBank) * (table->bankCount + 1));
+    if (!banks) {
+        return false;
     }
+    table->banks = banks;
 
-    for (size_t i = 0; i < table->bankCount; i++) {
-        AVD_HashTableBank *bank = &table->banks[i];
-        if (bank->bankCount < AVD_HASHTABLE_BANK_CAPACITY) {
-            AVD_HashTableEntry *entry = &bank->entries[bank->bankCount];
-            uint8_t *data             = (uint8_t *)bank->dataHolder;
-            entry->value              = &data[bank->bankCount * table->itemSize];
-            bank->bankCount++;
-            return entry;
+    AVD_HashTableBank *bank = &table->banks[table->bankCount];
+    bank->entries           = (AVD_HashTableEntry *)AVD_MALLOC(sizeof(AVD_HashTableEntry) * AVD_HASHTABLE_BANK_CAPACITY);
+    bank->values            = (AVD_UInt8 *)AVD_MALLOC(table->itemSize * AVD_HASHTABLE_BANK_CAPACITY);
+
+    if (!bank->entries || !bank->values) {
+        if (bank->entries) {
+            AVD_FREE(bank->entries);
+        }
+        if (bank->values) {
+            AVD_FREE(bank->values);
         }
+        return false;
     }
 
     table->bankCount++;
-    table->banks = realloc(table->banks, sizeof(AVD_HashTableBank) * table->bankCount);
-    if (!table->banks) {
-        return NULL;
+    return true;
+}
+
+static AVD_UInt32 PRIV_avdHashTableAllocateEntry(AVD_HashTable *table)
+{
+    if (table->freeList != AVD_HASHTABLE_INVALID_INDEX) {
+        AVD_UInt32 entryIndex = table->freeList;
+        table->freeList       = PRIV_avdHashTableGetEntry(table, entryIndex)->nextFree;
+        return entryIndex;
+    }
+
+    if (table->entryCount == table->bankCount * AVD_HASHTABLE_BANK_CAPACITY) {
+        if (!PRIV_avdHashTableAddBank(table)) {
+            return AVD_HASHTABLE_INVALID_INDEX;
+        }
+    }
+
+    return (AVD_UInt32)table->entryCount++;
+}
+
+static void PRIV_avdHashTableReleaseEntry(AVD_HashTable *table, AVD_UInt32 entryIndex)
+{
+    AVD_HashTableEntry *entry = PRIV_avdHashTableGetEntry(table, entryIndex);
+    if (PRIV_avdHashTableStoredKeySize(table, entry->keySize) > AVD_HASHTABLE_INLINE_KEY_SIZE) {
+        AVD_FREE(entry->externalKey);
+        entry->externalKey = NULL;
     }
 
-    AVD_HashTableBank *newBank = &table->banks[table->bankCount - 1];
-    newBank->entries           = malloc(sizeof(AVD_HashTableEntry) * AVD_HASHTABLE_BANK_CAPACITY);
-    newBank->dataHolder        = malloc(table->itemSize * AVD_HASHTABLE_BANK_CAPACITY);
-    newBank->bankCount         = 1;
+    entry->nextFree = table->freeList;
+    table->freeList = entryIndex;
+}
 
-    if (!newBank->entries || !newBank->dataHolder) {
-        return NULL;
+static bool PRIV_avdHashTableStoreKey(AVD_HashTable *table, AVD_HashTableEntry *entry, const void *key, AVD_UInt32 keySize)
+{
+    size_t storedSize = PRIV_avdHashTableStoredKeySize(table, keySize);
+    char *dest        = entry->inlineKey;
+
+    if (storedSize > AVD_HASHTABLE_INLINE_KEY_SIZE) {
+        dest = (char *)AVD_MALLOC(storedSize);
+        if (!dest) {
+            return false;
+        }
+        entry->externalKey = dest;
     }
 
-    for (size_t j = 0; j < AVD_HASHTABLE_BANK_CAPACITY; j++) {
-        newBank->entries[j].value = NULL;
-        newBank->entries[j].next  = NULL;
+    memcpy(dest, key, keySize);
+    if (table->stringKey) {
+        dest[keySize] = '\0';
     }
+    entry->keySize = keySize;
+    return true;
+}
+
+static void PRIV_avdHashTableFreeExternalKeys(AVD_HashTable *table)
+{
+    for (size_t i = 0; i < table->slotCount; i++) {
+        if (table->slots[i].entryIndex == AVD_HASHTABLE_INVALID_INDEX) {
+            continue;
+        }
 
-    AVD_HashTableEntry *entry = &newBank->entries[0];
-    entry->value              = newBank->dataHolder;
-    return entry;
+        AVD_HashTableEntry *entry = PRIV_avdHashTableGetEntry(table, table->slots[i].entryIndex);
+        if (PRIV_avdHashTableStoredKeySize(table, entry->keySize) > AVD_HASHTABLE_INLINE_KEY_SIZE) {
+            AVD_FREE(entry->externalKey);
+            entry->externalKey = NULL;
+        }
+    }
 }
 
 bool avdHashTableCreate(AVD_HashTable *table, size_t keySize, size_t itemSize, size_t initialCapacity, bool stringKey)
@@ -93,48 +237,35 @@ bool avdHashTableCreate(AVD_HashTable *table, size_t keySize, size_t itemSize, s
         return false;
     }
 
+    if (initialCapacity > AVD_HASHTABLE_MAX_CAPACITY) {
+        return false;
+    }
+
     memset(table, 0, sizeof(AVD_HashTable));
 
     table->keySize   = keySize;
     table->itemSize  = itemSize;
     table->stringKey = stringKey;
     table->count     = 0;
-    table->bankCount = 0;
-    table->banks     = NULL;
+    table->freeList  = AVD_HASHTABLE_INVALID_INDEX;
+
+    size_t slotCount   = AVD_HASHTABLE_INITIAL_SLOT_COUNT;
+    size_t minRequired = initialCapacity * 100 / AVD_HASHTABLE_MAX_LOAD_PERCENT + 1;
+    while (slotCount < minRequired) {
+        slotCount *= 2;
+    }
 
-    table->table = malloc(sizeof(AVD_HashTableEntry *) * AVD_HASHTABLE_SIZE);
-    if (!table->table) {
+    if (!PRIV_avdHashTableAllocateSlots(&table->slots, slotCount)) {
         return false;
     }
-    memset(table->table, 0, sizeof(AVD_HashTableEntry *) * AVD_HASHTABLE_SIZE);
+    table->slotCount = slotCount;
 
-    if (initialCapacity > 0) {
-        size_t banksNeeded = (initialCapacity + AVD_HASHTABLE_BANK_CAPACITY - 1) / AVD_HASHTABLE_BANK_CAPACITY;
-        table->banks       = malloc(sizeof(AVD_HashTableBank) * banksNeeded);
-        if (!table->banks) {
+    size_t banksNeeded = (initialCapacity + AVD_HASHTABLE_BANK_CAPACITY - 1) / AVD_HASHTABLE_BANK_CAPACITY;
+    for (size_t i = 0; i < banksNeeded; i++) {
+        if (!PRIV_avdHashTableAddBank(table)) {
+            avdHashTableDestroy(table);
             return false;
         }
-
-        for (size_t i = 0; i < banksNeeded; i++) {
-            table->banks[i].entries    = malloc(sizeof(AVD_HashTableEntry) * AVD_HASHTABLE_BANK_CAPACITY);
-            table->banks[i].dataHolder = malloc(itemSize * AVD_HASHTABLE_BANK_CAPACITY);
-            table->banks[i].bankCount  = 0;
-
-            if (!table->banks[i].entries || !table->banks[i].dataHolder) {
-                for (size_t j = 0; j <= i; j++) {
-                    free(table->banks[j].entries);
-                    free(table->banks[j].dataHolder);
-                }
-                free(table->banks);
-                return false;
-            }
-
-            for (size_t j = 0; j < AVD_HASHTABLE_BANK_CAPACITY; j++) {
-                table->banks[i].entries[j].value = NULL;
-                table->banks[i].entries[j].next  = NULL;
-            }
-        }
-        table->bankCount = banksNeeded;
     }
 
     return true;
@@ -146,16 +277,17 @@ bool avdHashTableDestroy(AVD_HashTable *table)
         return false;
     }
 
-    if (table->table) {
-        free(table->table);
+    if (table->slots) {
+        PRIV_avdHashTableFreeExternalKeys(table);
+        AVD_FREE(table->slots);
     }
 
     if (table->banks) {
         for (size_t i = 0; i < table->bankCount; i++) {
-            free(table->banks[i].entries);
-            free(table->banks[i].dataHolder);
+            AVD_FREE(table->banks[i].entries);
+            AVD_FREE(table->banks[i].values);
         }
-        free(table->banks);
+        AVD_FREE(table->banks);
     }
 
     memset(table, 0, sizeof(AVD_HashTable));
@@ -168,26 +300,44 @@ bool avdHashTableSet(AVD_HashTable *table, const void *key, const void *value)
         return false;
     }
 
-    size_t hash               = PRIV_avdHashTableHash(table, key);
-    AVD_HashTableEntry *entry = table->table[hash];
+    AVD_UInt32 keySize = PRIV_avdHashTableKeySize(table, key);
+    AVD_UInt32 hash    = avdHashBuffer(key, keySize);
+
+    size_t slotIndex = 0;
+    if (PRIV_avdHashTableFindSlot(table, key, keySize, hash, &slotIndex)) {
+        memcpy(PRIV_avdHashTableGetValue(table, table->slots[slotIndex].entryIndex), value, table->itemSize);
+        return true;
+    }
+
+    if (table->count >= AVD_HASHTABLE_MAX_CAPACITY) {
+        return false;
+    }
 
-    while (entry) {
-        if (PRIV_avdHashTableKeysEqual(table, entry->key, key)) {
-            memcpy(entry->value, value, table->itemSize);
-            return true;
+    if ((table->count + 1) * 100 > table->slotCount * AVD_HASHTABLE_MAX_LOAD_PERCENT) {
+        if (!PRIV_avdHashTableRehash(table, table->slotCount * 2)) {
+            return false;
         }
-        entry = entry->next;
     }
 
-    AVD_HashTableEntry *newEntry = PRIV_avdHashTableAllocateEntry(table);
-    if (!newEntry) {
+    AVD_UInt32 entryIndex = PRIV_avdHashTableAllocateEntry(table);
+    if (entryIndex == AVD_HASHTABLE_INVALID_INDEX) {
+        return false;
+    }
+
+    AVD_HashTableEntry *entry = PRIV_avdHashTableGetEntry(table, entryIndex);
+    if (!PRIV_avdHashTableStoreKey(table, entry, key, keySize)) {
+        entry->keySize  = 0;
+        entry->nextFree = table->freeList;
+        table->freeList = entryIndex;
         return false;
     }
+    memcpy(PRIV_avdHashTableGetValue(table, entryIndex), value, table->itemSize);
 
-    PRIV_avdHashTableCopyKey(table, newEntry->key, key);
-    memcpy(newEntry->value, value, table->itemSize);
-    newEntry->next     = table->table[hash];
-    table->table[hash] = newEntry;
+    AVD_HashTableSlot slot = {
+        .hash       = hash,
+        .entryIndex = entryIndex,
+    };
+    PRIV_avdHashTableInsertSlot(table, slot);
     table->count++;
 
     return true;
@@ -199,20 +349,18 @@ bool avdHashTableGet(AVD_HashTable *table, const void *key, void *outValue)
         return false;
     }
 
-    size_t hash               = PRIV_avdHashTableHash(table, key);
-    AVD_HashTableEntry *entry = table->table[hash];
+    AVD_UInt32 keySize = PRIV_avdHashTableKeySize(table, key);
+    AVD_UInt32 hash    = avdHashBuffer(key, keySize);
 
-    while (entry) {
-        if (PRIV_avdHashTableKeysEqual(table, entry->key, key)) {
-            if (outValue) {
-                memcpy(outValue, entry->value, table->itemSize);
-            }
-            return true;
-        }
-        entry = entry->next;
+    size_t slotIndex = 0;
+    if (!PRIV_avdHashTableFindSlot(table, key, keySize, hash, &slotIndex)) {
+        return false;
     }
 
-    return false;
+    if (outValue) {
+        memcpy(outValue, PRIV_avdHashTableGetValue(table, table->slots[slotIndex].entryIndex), table->itemSize);
+    }
+    return true;
 }
 
 bool avdHashTableContains(AVD_HashTable *table, const void *key)
@@ -226,29 +374,30 @@ bool avdHashTableRemove(AVD_HashTable *table, const void *key)
         return false;
     }
 
-    size_t hash               = PRIV_avdHashTableHash(table, key);
-    AVD_HashTableEntry *entry = table->table[hash];
-    AVD_HashTableEntry *prev  = NULL;
+    AVD_UInt32 keySize = PRIV_avdHashTableKeySize(table, key);
+    AVD_UInt32 hash    = avdHashBuffer(key, keySize);
 
-    while (entry) {
-        if (PRIV_avdHashTableKeysEqual(table, entry->key, key)) {
-            if (prev) {
-                prev->next = entry->next;
-            } else {
-                table->table[hash] = entry->next;
-            }
+    size_t slotIndex = 0;
+    if (!PRIV_avdHashTableFindSlot(table, key, keySize, hash, &slotIndex)) {
+        return false;
+    }
 
-            entry->value = NULL;
-            entry->next  = NULL;
+    PRIV_avdHashTableReleaseEntry(table, table->slots[slotIndex].entryIndex);
 
-            table->count--;
-            return true;
-        }
-        prev  = entry;
-        entry = entry->next;
+    // backward shift deletion, pull following displaced slots one step closer to home
+    size_t mask      = table->slotCount - 1;
+    size_t nextIndex = (slotIndex + 1) & mask;
+    while (table->slots[nextIndex].entryIndex != AVD_HASHTABLE_INVALID_INDEX &&
+           PRIV_avdHashTableProbeDistance(table, nextIndex, table->slots[nextIndex].hash) != 0) {
+        table->slots[slotIndex] = table->slots[nextIndex];
+        slotIndex               = nextIndex;
+        nextIndex               = (nextIndex + 1) & mask;
     }
+    table->slots[slotIndex].hash       = 0;
+    table->slots[slotIndex].entryIndex = AVD_HASHTABLE_INVALID_INDEX;
 
-    return false;
+    table->count--;
+    return true;
 }
 
 bool avdHashTableClear(AVD_HashTable *table)
@@ -257,17 +406,17 @@ bool avdHashTableClear(AVD_HashTable *table)
         return false;
     }
 
-    memset(table->table, 0, sizeof(AVD_HashTableEntry *) * AVD_HASHTABLE_SIZE);
-    table->count = 0;
+    PRIV_avdHashTableFreeExternalKeys(table);
 
-    for (size_t i = 0; i < table->bankCount; i++) {
-        AVD_HashTableBank *bank = &table->banks[i];
-        for (size_t j = 0; j < bank->bankCount; j++) {
-            bank->entries[j].value = NULL;
-            bank->entries[j].next  = NULL;
-        }
+    for (size_t i = 0; i < table->slotCount; i++) {
+        table->slots[i].hash       = 0;
+        table->slots[i].entryIndex = AVD_HASHTABLE_INVALID_INDEX;
     }
 
+    table->count      = 0;
+    table->entryCount = 0;
+    table->freeList   = AVD_HASHTABLE_INVALID_INDEX;
+
     return true;
 }
 
@@ -289,15 +438,15 @@ bool avdHashTableGetKeys(const AVD_HashTable *table, void **outKeys, size_t *out
 
     size_t keyCount = 0;
 
-    for (size_t i = 0; i < AVD_HASHTABLE_SIZE && keyCount < maxKeys; i++) {
-        AVD_HashTableEntry *entry = table->table[i];
-        while (entry && keyCount < maxKeys) {
-            outKeys[keyCount] = (void *)entry->key;
-            keyCount++;
-            entry = entry->next;
+    for (size_t i = 0; i < table->slotCount && keyCount < maxKeys; i++) {
+        if (table->slots[i].entryIndex == AVD_HASHTABLE_INVALID_INDEX) {
+            continue;
         }
+
+        const AVD_HashTableEntry *entry = PRIV_avdHashTableGetEntry(table, table->slots[i].entryIndex);
+        outKeys[keyCount++]             = (void *)PRIV_avdHashTableGetEntryKey(table, entry);
     }
 
     *outKeyCount = keyCount;
     return true;
-}
\ No newline at end of file
+}
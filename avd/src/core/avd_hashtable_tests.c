@@ -527,8 +527,9 @@ static bool PRIV_avdTestHashTableCollisions()
     // Create keys that are likely to cause collisions
     // We'll use a pattern that might cause hash collisions
     int numCollisionKeys = 50;
+    int collisionStride  = 1024 * 16;
     for (int i = 0; i < numCollisionKeys; i++) {
-        int key   = i * AVD_HASHTABLE_SIZE + 42; // Force same hash bucket
+        int key   = i * collisionStride + 42;
         int value = i + 1000;
 
         bool result = avdHashTableSet(&table, &key, &value);
@@ -541,7 +542,7 @@ static bool PRIV_avdTestHashTableCollisions()
 
     // Verify all collision keys can be retrieved
     for (int i = 0; i < numCollisionKeys; i++) {
-        int key = i * AVD_HASHTABLE_SIZE + 42;
+        int key = i * collisionStride + 42;
         int value;
 
         bool result = avdHashTableGet(&table, &key, &value);
@@ -554,7 +555,7 @@ static bool PRIV_avdTestHashTableCollisions()
 
     // Remove some collision keys and verify others remain
     for (int i = 0; i < numCollisionKeys; i += 2) {
-        int key     = i * AVD_HASHTABLE_SIZE + 42;
+        int key     = i * collisionStride + 42;
         bool result = avdHashTableRemove(&table, &key);
         if (!result) {
             AVD_LOG_ERROR("    ERROR: Failed to remove collision key");
@@ -565,7 +566,7 @@ static bool PRIV_avdTestHashTableCollisions()
 
     // Verify remaining keys still work
     for (int i = 1; i < numCollisionKeys; i += 2) {
-        int key = i * AVD_HASHTABLE_SIZE + 42;
+        int key = i * collisionStride + 42;
         int value;
 
         bool result = avdHashTableGet(&table, &key, &value);
@@ -706,6 +707,208 @@ static bool PRIV_avdTestHashTableLargeDataTypes()
     return true;
 }
 
+static bool PRIV_avdTestHashTableGrowth()
+{
+    AVD_LOG_DEBUG("  Testing HashTable growth and rehashing...");
+
+    AVD_HashTable table;
+    avdHashTableCreate(&table, sizeof(int), sizeof(int), 0, false);
+
+    size_t initialSlotCount = table.slotCount;
+    int numKeys             = 100000;
+
+    for (int i = 0; i < numKeys; i++) {
+        int value = i ^ 0x5a5a;
+        if (!avdHashTableSet(&table, &i, &value)) {
+            AVD_LOG_ERROR("    ERROR: Failed to insert key %d while growing", i);
+            avdHashTableDestroy(&table);
+            return false;
+        }
+    }
+
+    if (table.slotCount <= initialSlotCount || table.count * 100 > table.slotCount * AVD_HASHTABLE_MAX_LOAD_PERCENT) {
+        AVD_LOG_ERROR("    ERROR: Slot array did not grow with the load factor");
+        avdHashTableDestroy(&table);
+        return false;
+    }
+
+    // Remove every third key, this exercises the backward shift deletion across long probe runs
+    for (int i = 0; i < numKeys; i += 3) {
+        if (!avdHashTableRemove(&table, &i)) {
+            AVD_LOG_ERROR("    ERROR: Failed to remove key %d after growing", i);
+            avdHashTableDestroy(&table);
+            return false;
+        }
+    }
+
+    for (int i = 0; i < numKeys; i++) {
+        int value   = 0;
+        bool found  = avdHashTableGet(&table, &i, &value);
+        bool expect = (i % 3) != 0;
+        if (found != expect || (found && value != (i ^ 0x5a5a))) {
+            AVD_LOG_ERROR("    ERROR: Key %d has wrong state after removals", i);
+            avdHashTableDestroy(&table);
+            return false;
+        }
+    }
+
+    avdHashTableDestroy(&table);
+    AVD_LOG_DEBUG("    HashTable growth and rehashing PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestHashTableLongKeys()
+{
+    AVD_LOG_DEBUG("  Testing HashTable with out of line keys...");
+
+    AVD_HashTable table;
+    avdHashTableCreate(&table, 0, sizeof(int), 0, true);
+
+    // Keys longer than the inline storage as well as keys longer than the old 256 byte limit
+    char keys[8][600];
+    for (int i = 0; i < 8; i++) {
+        size_t length = 16 + i * 80;
+        memset(keys[i], 'k', length);
+        snprintf(keys[i], 8, "key%d", i);
+        keys[i][strlen(keys[i])] = '-';
+        keys[i][length]          = '\0';
+
+        if (!avdHashTableSet(&table, keys[i], &i)) {
+            AVD_LOG_ERROR("    ERROR: Failed to set key of length %zu", length);
+            avdHashTableDestroy(&table);
+            return false;
+        }
+    }
+
+    // Two keys sharing the same 256 byte prefix must not alias
+    char prefixKey[600];
+    strcpy(prefixKey, keys[7]);
+    prefixKey[strlen(prefixKey) - 1] = 'x';
+    if (avdHashTableContains(&table, prefixKey)) {
+        AVD_LOG_ERROR("    ERROR: Long keys with a shared prefix alias each other");
+        avdHashTableDestroy(&table);
+        return false;
+    }
+
+    for (int i = 0; i < 8; i++) {
+        int value = -1;
+        if (!avdHashTableGet(&table, keys[i], &value) || value != i) {
+            AVD_LOG_ERROR("    ERROR: Failed to get key of length %zu", strlen(keys[i]));
+            avdHashTableDestroy(&table);
+            return false;
+        }
+    }
+
+    void *outKeys[8];
+    size_t keyCount = 0;
+    avdHashTableGetKeys(&table, outKeys, &keyCount, 8);
+    for (size_t i = 0; i < keyCount; i++) {
+        if (!avdHashTableContains(&table, outKeys[i])) {
+            AVD_LOG_ERROR("    ERROR: Returned key is not a valid string key");
+            avdHashTableDestroy(&table);
+            return false;
+        }
+    }
+
+    for (int i = 0; i < 8; i += 2) {
+        avdHashTableRemove(&table, keys[i]);
+    }
+    avdHashTableClear(&table);
+
+    avdHashTableDestroy(&table);
+    AVD_LOG_DEBUG("    HashTable out of line keys PASSED");
+    return true;
+}
+
+static AVD_UInt64 PRIV_avdHashTableBenchmarkKey(size_t index)
+{
+    // spread sequential indices so the keys do not arrive in hash order
+    return (AVD_UInt64)index * 0x9E3779B97F4A7C15ull;
+}
+
+typedef struct {
+    AVD_HashTable table;
+    size_t entryCount;
+    size_t found;
+    bool failed;
+} AVD_HashTableBenchmark;
+
+static bool PRIV_avdHashTableBenchmarkClear(void *userData)
+{
+    AVD_HashTableBenchmark *benchmark = (AVD_HashTableBenchmark *)userData;
+    avdHashTableClear(&benchmark->table);
+    return true;
+}
+
+static void PRIV_avdHashTableBenchmarkInsert(void *userData)
+{
+    AVD_HashTableBenchmark *benchmark = (AVD_HashTableBenchmark *)userData;
+    for (size_t i = 0; i < benchmark->entryCount; i++) {
+        AVD_UInt64 key = PRIV_avdHashTableBenchmarkKey(i);
+        benchmark->failed |= !avdHashTableSet(&benchmark->table, &key, &i);
+    }
+}
+
+static bool PRIV_avdHashTableBenchmarkFill(void *userData)
+{
+    AVD_HashTableBenchmark *benchmark = (AVD_HashTableBenchmark *)userData;
+    PRIV_avdHashTableBenchmarkInsert(benchmark);
+    return !benchmark->failed;
+}
+
+static void PRIV_avdHashTableBenchmarkLookup(void *userData)
+{
+    AVD_HashTableBenchmark *benchmark = (AVD_HashTableBenchmark *)userData;
+    benchmark->found                  = 0;
+    for (size_t i = 0; i < benchmark->entryCount; i++) {
+        AVD_UInt64 key   = PRIV_avdHashTableBenchmarkKey(i);
+        AVD_UInt64 value = 0;
+        benchmark->found += avdHashTableGet(&benchmark->table, &key, &value) && value == i;
+    }
+}
+
+static void PRIV_avdHashTableBenchmarkRemove(void *userData)
+{
+    AVD_HashTableBenchmark *benchmark = (AVD_HashTableBenchmark *)userData;
+    for (size_t i = 0; i < benchmark->entryCount; i++) {
+        AVD_UInt64 key = PRIV_avdHashTableBenchmarkKey(i);
+        avdHashTableRemove(&benchmark->table, &key);
+    }
+}
+
+static bool PRIV_avdHashTableBenchmark(AVD_Bench *bench, size_t entryCount)
+{
+    // found is only rewritten if the lookup case is not filtered out
+    AVD_HashTableBenchmark benchmark = {.entryCount = entryCount, .found = entryCount};
+    AVD_CHECK(avdHashTableCreate(&benchmark.table, sizeof(AVD_UInt64), sizeof(AVD_UInt64), 0, false));
+
+    char insertName[AVD_BENCH_NAME_LENGTH];
+    char lookupName[AVD_BENCH_NAME_LENGTH];
+    char removeName[AVD_BENCH_NAME_LENGTH];
+    snprintf(insertName, sizeof(insertName), "hashtable/insert/%zu", entryCount);
+    snprintf(lookupName, sizeof(lookupName), "hashtable/lookup/%zu", entryCount);
+    snprintf(removeName, sizeof(removeName), "hashtable/remove/%zu", entryCount);
+
+    // insert and remove start from an empty or a full table every repetition, the
+    // table keeps its capacity across clears so growth is only paid during warmup
+    AVD_BenchCase cases[] = {
+        {.name = insertName, .unit = "ops", .itemsPerRepetition = entryCount, .setup = PRIV_avdHashTableBenchmarkClear, .run = PRIV_avdHashTableBenchmarkInsert, .userData = &benchmark},
+        {.name = lookupName, .unit = "ops", .itemsPerRepetition = entryCount, .setup = PRIV_avdHashTableBenchmarkFill, .run = PRIV_avdHashTableBenchmarkLookup, .userData = &benchmark},
+        {.name = removeName, .unit = "ops", .itemsPerRepetition = entryCount, .setup = PRIV_avdHashTableBenchmarkFill, .run = PRIV_avdHashTableBenchmarkRemove, .userData = &benchmark},
+    };
+
+    bool ok = true;
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(cases) && ok; i++) {
+        ok = avdBenchRun(bench, &cases[i]);
+    }
+
+    avdHashTableDestroy(&benchmark.table);
+
+    AVD_CHECK_MSG(ok && !benchmark.failed, "HashTable benchmark failed");
+    AVD_CHECK_MSG(benchmark.found == entryCount, "HashTable benchmark lookups found %zu of %zu entries", benchmark.found, entryCount);
+    return true;
+}
+
 bool avdHashTableTestsRun(void)
 {
     AVD_LOG_DEBUG("Running HashTable tests...");
@@ -723,6 +926,8 @@ bool avdHashTableTestsRun(void)
     allPassed &= PRIV_avdTestHashTableCollisions();
     allPassed &= PRIV_avdTestHashTableEdgeCases();
     allPassed &= PRIV_avdTestHashTableLargeDataTypes();
+    allPassed &= PRIV_avdTestHashTableGrowth();
+    allPassed &= PRIV_avdTestHashTableLongKeys();
 
     if (allPassed) {
         AVD_LOG_DEBUG("All HashTable tests PASSED!");
@@ -732,3 +937,15 @@ bool avdHashTableTestsRun(void)
 
     return allPassed;
 }
+
+bool avdHashTableBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running HashTable benchmarks...");
+
+    AVD_CHECK(PRIV_avdHashTableBenchmark(bench, 1000));
+    AVD_CHECK(PRIV_avdHashTableBenchmark(bench, 100000));
+    AVD_CHECK(PRIV_avdHashTableBenchmark(bench, 1000000));
+
+    return true;
+}
@@ -0,0 +1,519 @@
+#include "core/avd_jobs.h"
+#include "core/avd_arena.h"
+#include "core/avd_atomic.h"
+#include "core/avd_profiler.h"
+
+#include "pico/picoThreads.h"
+
+#ifndef _WIN32
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+// How long a sleeping worker waits for a wake token before checking the queues again.
+#define AVD_JOBS_IDLE_TIMEOUT_MS 100
+
+// the queue of the thread that called avdJobsInit, workers own 1..workerCount
+#define AVD_JOBS_MAIN_QUEUE 0
+
+typedef struct AVD_JobContinuation {
+    struct AVD_JobContinuation *next;
+    AVD_JobCounter *counter;
+    AVD_Size jobCount;
+    AVD_Job jobs[];
+} AVD_JobContinuation;
+
+typedef struct {
+    AVD_Job job;
+    AVD_JobCounter *counter;
+} AVD_JobEntry;
+
+// Ring buffer guarded by a mutex, the owner works LIFO on the back for cache
+// locality while thieves take the oldest (and usually biggest) jobs from the front.
+typedef struct {
+    picoThreadMutex mutex;
+    AVD_JobEntry *entries;
+    AVD_Size head;
+    AVD_Size count;
+} AVD_JobQueue;
+
+typedef struct {
+    bool initialized;
+    volatile AVD_Int64 running;
+
+    AVD_UInt32 workerCount;
+    AVD_UInt32 queueCount;
+    picoThread workers[AVD_JOBS_MAX_WORKERS];
+    AVD_JobQueue queues[AVD_JOBS_MAX_WORKERS + 1];
+
+    volatile AVD_Int64 queuedJobs;
+    volatile AVD_Int64 sleepingWorkers;
+    volatile AVD_Int64 nextExternalQueue;
+    picoThreadChannel wakeChannel;
+
+    // guards the continuation lists of all counters
+    picoThreadMutex continuationMutex;
+} AVD_JobSystem;
+
+static AVD_JobSystem PRIV_avdJobs = {0};
+
+// -1 for threads the job system does not know about
+static AVD_THREAD_LOCAL AVD_Int32 PRIV_avdJobsThreadQueue = -1;
+
+static void PRIV_avdJobsSubmit(const AVD_Job *jobs, AVD_Size count, AVD_JobCounter *counter);
+
+static void PRIV_avdJobsYield(void)
+{
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+static bool PRIV_avdJobQueueCreate(AVD_JobQueue *queue)
+{
+    queue->entries = (AVD_JobEntry *)AVD_MALLOC(sizeof(AVD_JobEntry) * AVD_JOBS_QUEUE_CAPACITY);
+    AVD_CHECK_MSG(queue->entries != NULL, "Failed to allocate job queue");
+    queue->mutex = picoThreadMutexCreate();
+    AVD_CHECK_MSG(queue->mutex != NULL, "Failed to create job queue mutex");
+    queue->head  = 0;
+    queue->count = 0;
+    return true;
+}
+
+static void PRIV_avdJobQueueDestroy(AVD_JobQueue *queue)
+{
+    if (queue->mutex != NULL) {
+        picoThreadMutexDestroy(queue->mutex);
+        queue->mutex = NULL;
+    }
+    if (queue->entries != NULL) {
+        AVD_FREE(queue->entries);
+    }
+}
+
+static bool PRIV_avdJobQueuePush(AVD_JobQueue *queue, const AVD_JobEntry *entry)
+{
+    picoThreadMutexLock(queue->mutex, PICO_THREAD_INFINITE);
+    if (queue->count == AVD_JOBS_QUEUE_CAPACITY) {
+        picoThreadMutexUnlock(queue->mutex);
+        return false;
+    }
+    queue->entries[(queue->head + queue->count) % AVD_JOBS_QUEUE_CAPACITY] = *entry;
+    queue->count++;
+    picoThreadMutexUnlock(queue->mutex);
+    return true;
+}
+
+static bool PRIV_avdJobQueuePopBack(AVD_JobQueue *queue, AVD_JobEntry *outEntry)
+{
+    picoThreadMutexLock(queue->mutex, PICO_THREAD_INFINITE);
+    if (queue->count == 0) {
+        picoThreadMutexUnlock(queue->mutex);
+        return false;
+    }
+    queue->count--;
+    *outEntry = queue->entries[(queue->head + queue->count) % AVD_JOBS_QUEUE_CAPACITY];
+    picoThreadMutexUnlock(queue->mutex);
+    return true;
+}
+
+static bool PRIV_avdJobQueueStealFront(AVD_JobQueue *queue, AVD_JobEntry *outEntry)
+{
+    picoThreadMutexLock(queue->mutex, PICO_THREAD_INFINITE);
+    if (queue->count == 0) {
+        picoThreadMutexUnlock(queue->mutex);
+        return false;
+    }
+    *outEntry   = queue->entries[queue->head];
+    queue->head = (queue->head + 1) % AVD_JOBS_QUEUE_CAPACITY;
+    queue->count--;
+    picoThreadMutexUnlock(queue->mutex);
+    return true;
+}
+
+static void PRIV_avdJobCounterDecrement(AVD_JobCounter *counter)
+{
+    if (counter == NULL) {
+        return;
+    }
+
+    // only the final decrement has to look at the continuations
+    AVD_Int64 pending = avdAtomicLoad64(&counter->pending);
+    while (pending > 1) {
+        if (avdAtomicCompareExchange64(&counter->pending, &pending, pending - 1)) {
+            return;
+        }
+    }
+
+    // without the job system there are no continuations, see avdJobsRunAfter
+    if (PRIV_avdJobs.continuationMutex == NULL) {
+        avdAtomicAdd64(&counter->pending, -1);
+        return;
+    }
+
+    // The list is detached before the decrement since a waiter may destroy the
+    // counter the moment it reads zero, after that it must not be touched again.
+    picoThreadMutexLock(PRIV_avdJobs.continuationMutex, PICO_THREAD_INFINITE);
+    AVD_JobContinuation *continuations = counter->continuations;
+    counter->continuations             = NULL;
+    if (avdAtomicAdd64(&counter->pending, -1) != 0) {
+        counter->continuations = continuations;
+        continuations          = NULL;
+    }
+    picoThreadMutexUnlock(PRIV_avdJobs.continuationMutex);
+
+    while (continuations != NULL) {
+        AVD_JobContinuation *next = continuations->next;
+        PRIV_avdJobsSubmit(continuations->jobs, continuations->jobCount, continuations->counter);
+        AVD_FREE(continuations);
+        continuations = next;
+    }
+}
+
+static void PRIV_avdJobExecute(const AVD_JobEntry *entry)
+{
+    entry->job.function(entry->job.userData);
+    PRIV_avdJobCounterDecrement(entry->counter);
+}
+
+static bool PRIV_avdJobsTryRunOne(void)
+{
+    if (avdAtomicLoad64(&PRIV_avdJobs.queuedJobs) == 0) {
+        return false;
+    }
+
+    AVD_Int32 ownQueue = PRIV_avdJobsThreadQueue;
+    AVD_JobEntry entry;
+    bool found = ownQueue >= 0 && PRIV_avdJobQueuePopBack(&PRIV_avdJobs.queues[ownQueue], &entry);
+
+    // start stealing right after the own queue so the thieves spread over the victims
+    AVD_UInt32 start = ownQueue >= 0 ? (AVD_UInt32)ownQueue + 1 : 0;
+    for (AVD_UInt32 i = 0; i < PRIV_avdJobs.queueCount && !found; i++) {
+        AVD_UInt32 victim = (start + i) % PRIV_avdJobs.queueCount;
+        if ((AVD_Int32)victim == ownQueue) {
+            continue;
+        }
+        found = PRIV_avdJobQueueStealFront(&PRIV_avdJobs.queues[victim], &entry);
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    avdAtomicAdd64(&PRIV_avdJobs.queuedJobs, -1);
+    PRIV_avdJobExecute(&entry);
+    return true;
+}
+
+static void PRIV_avdJobsWakeWorkers(AVD_Size count)
+{
+    AVD_Int64 sleeping = avdAtomicLoad64(&PRIV_avdJobs.sleepingWorkers);
+    AVD_UInt8 token    = 0;
+    for (AVD_Int64 i = 0; i < sleeping && (AVD_Size)i < count; i++) {
+        picoThreadChannelSend(PRIV_avdJobs.wakeChannel, &token);
+    }
+}
+
+static void PRIV_avdJobsSubmit(const AVD_Job *jobs, AVD_Size count, AVD_JobCounter *counter)
+{
+    AVD_JobQueue *queue = NULL;
+    if (PRIV_avdJobs.initialized) {
+        AVD_Int32 ownQueue = PRIV_avdJobsThreadQueue;
+        if (ownQueue < 0) {
+            ownQueue = (AVD_Int32)((AVD_UInt64)avdAtomicAdd64(&PRIV_avdJobs.nextExternalQueue, 1) % PRIV_avdJobs.queueCount);
+        }
+        queue = &PRIV_avdJobs.queues[ownQueue];
+    }
+
+    AVD_Size queued = 0;
+    for (AVD_Size i = 0; i < count; i++) {
+        AVD_JobEntry entry = {.job = jobs[i], .counter = counter};
+        if (queue != NULL && PRIV_avdJobQueuePush(queue, &entry)) {
+            // published per job so that thieves can start while the rest is still being pushed
+            avdAtomicAdd64(&PRIV_avdJobs.queuedJobs, 1);
+            queued++;
+            if (queued == 1) {
+                PRIV_avdJobsWakeWorkers(1);
+            }
+        } else {
+            PRIV_avdJobExecute(&entry);
+        }
+    }
+
+    if (queued > 1) {
+        PRIV_avdJobsWakeWorkers(queued - 1);
+    }
+}
+
+static void PRIV_avdJobsWorker(void *userData)
+{
+    PRIV_avdJobsThreadQueue = (AVD_Int32)(uintptr_t)userData;
+    AVD_PROFILE_THREAD_NAME("Job Worker %d", PRIV_avdJobsThreadQueue);
+
+    AVD_UInt32 idle = 0;
+    while (avdAtomicLoad64(&PRIV_avdJobs.running)) {
+        if (PRIV_avdJobsTryRunOne()) {
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < AVD_JOBS_SPIN_COUNT) {
+            if (idle % 16 == 0) {
+                PRIV_avdJobsYield();
+            } else {
+                AVD_CPU_PAUSE();
+            }
+            continue;
+        }
+
+        // Register as sleeper before the final check, a submitter increments
+        // queuedJobs before it reads sleepingWorkers so one of us sees the other.
+        avdAtomicAdd64(&PRIV_avdJobs.sleepingWorkers, 1);
+        if (avdAtomicLoad64(&PRIV_avdJobs.queuedJobs) == 0 && avdAtomicLoad64(&PRIV_avdJobs.running)) {
+            AVD_UInt8 token = 0;
+            picoThreadChannelReceive(PRIV_avdJobs.wakeChannel, &token, AVD_JOBS_IDLE_TIMEOUT_MS);
+        }
+        avdAtomicAdd64(&PRIV_avdJobs.sleepingWorkers, -1);
+        idle = 0;
+    }
+
+    AVD_PROFILE_THREAD_SHUTDOWN();
+    avdLogThreadShutdown();
+    avdArenaScratchThreadShutdown();
+    PRIV_avdJobsThreadQueue = -1;
+}
+
+AVD_UInt32 avdJobsHardwareThreadCount(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return AVD_MAX((AVD_UInt32)info.dwNumberOfProcessors, 1u);
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (AVD_UInt32)count : 1u;
+#endif
+}
+
+bool avdJobsInit(AVD_UInt32 workerCount)
+{
+    AVD_CHECK_MSG(!PRIV_avdJobs.initialized, "Job system is already initialized");
+
+    if (workerCount == 0) {
+        workerCount = avdJobsHardwareThreadCount() - 1;
+    }
+    workerCount = AVD_MIN(workerCount, (AVD_UInt32)AVD_JOBS_MAX_WORKERS);
+
+    memset(&PRIV_avdJobs, 0, sizeof(PRIV_avdJobs));
+    PRIV_avdJobs.workerCount = workerCount;
+    PRIV_avdJobs.queueCount  = workerCount + 1;
+
+    for (AVD_UInt32 i = 0; i < PRIV_avdJobs.queueCount; i++) {
+        AVD_CHECK(PRIV_avdJobQueueCreate(&PRIV_avdJobs.queues[i]));
+    }
+
+    PRIV_avdJobs.wakeChannel = picoThreadChannelCreateUnbounded(sizeof(AVD_UInt8));
+    AVD_CHECK_MSG(PRIV_avdJobs.wakeChannel != NULL, "Failed to create job system wake channel");
+    PRIV_avdJobs.continuationMutex = picoThreadMutexCreate();
+    AVD_CHECK_MSG(PRIV_avdJobs.continuationMutex != NULL, "Failed to create job continuation mutex");
+
+    PRIV_avdJobsThreadQueue = AVD_JOBS_MAIN_QUEUE;
+    avdAtomicStore64(&PRIV_avdJobs.running, 1);
+    PRIV_avdJobs.initialized = true;
+
+    for (AVD_UInt32 i = 0; i < workerCount; i++) {
+        PRIV_avdJobs.workers[i] = picoThreadCreate(PRIV_avdJobsWorker, (void *)(uintptr_t)(i + 1));
+        AVD_CHECK_MSG(PRIV_avdJobs.workers[i] != NULL, "Failed to create job worker %u", i);
+    }
+
+    AVD_LOG_INFO("Job system started with %u workers", workerCount);
+    return true;
+}
+
+void avdJobsShutdown(void)
+{
+    if (!PRIV_avdJobs.initialized) {
+        return;
+    }
+
+    while (PRIV_avdJobsTryRunOne()) {
+    }
+
+    avdAtomicStore64(&PRIV_avdJobs.running, 0);
+    AVD_UInt8 token = 0;
+    for (AVD_UInt32 i = 0; i < PRIV_avdJobs.workerCount; i++) {
+        picoThreadChannelSend(PRIV_avdJobs.wakeChannel, &token);
+    }
+    for (AVD_UInt32 i = 0; i < PRIV_avdJobs.workerCount; i++) {
+        if (PRIV_avdJobs.workers[i] != NULL) {
+            picoThreadDestroy(PRIV_avdJobs.workers[i]);
+            PRIV_avdJobs.workers[i] = NULL;
+        }
+    }
+
+    // jobs the workers pushed while they were being stopped
+    while (PRIV_avdJobsTryRunOne()) {
+    }
+
+    PRIV_avdJobs.initialized = false;
+    PRIV_avdJobsThreadQueue  = -1;
+
+    for (AVD_UInt32 i = 0; i < PRIV_avdJobs.queueCount; i++) {
+        PRIV_avdJobQueueDestroy(&PRIV_avdJobs.queues[i]);
+    }
+    picoThreadChannelDestroy(PRIV_avdJobs.wakeChannel);
+    picoThreadMutexDestroy(PRIV_avdJobs.continuationMutex);
+    memset(&PRIV_avdJobs, 0, sizeof(PRIV_avdJobs));
+}
+
+bool avdJobsIsInitialized(void)
+{
+    return PRIV_avdJobs.initialized;
+}
+
+AVD_UInt32 avdJobsWorkerCount(void)
+{
+    return PRIV_avdJobs.workerCount;
+}
+
+void avdJobsRun(const AVD_Job *jobs, AVD_Size count, AVD_JobCounter *counter)
+{
+    AVD_ASSERT(jobs != NULL || count == 0);
+
+    if (count == 0) {
+        return;
+    }
+
+    if (counter != NULL) {
+        avdAtomicAdd64(&counter->pending, (AVD_Int64)count);
+    }
+    PRIV_avdJobsSubmit(jobs, count, counter);
+}
+
+void avdJobsRunAfter(AVD_JobCounter *dependency, const AVD_Job *jobs, AVD_Size count, AVD_JobCounter *counter)
+{
+    AVD_ASSERT(dependency != NULL);
+    AVD_ASSERT(jobs != NULL || count == 0);
+
+    if (count == 0) {
+        return;
+    }
+
+    if (!PRIV_avdJobs.initialized) {
+        // everything ran inline, so the dependency is already done
+        avdJobsRun(jobs, count, counter);
+        return;
+    }
+
+    AVD_JobContinuation *continuation = (AVD_JobContinuation *)AVD_MALLOC(sizeof(AVD_JobContinuation) + sizeof(AVD_Job) * count);
+    if (continuation == NULL) {
+        AVD_LOG_ERROR("Failed to allocate job continuation, waiting for the dependency instead");
+        avdJobsWait(dependency);
+        avdJobsRun(jobs, count, counter);
+        return;
+    }
+    continuation->counter  = counter;
+    continuation->jobCount = count;
+    memcpy(continuation->jobs, jobs, sizeof(AVD_Job) * count);
+
+    picoThreadMutexLock(PRIV_avdJobs.continuationMutex, PICO_THREAD_INFINITE);
+    // the final decrement of the dependency takes this mutex, so it cannot complete in between
+    bool ready = avdAtomicLoad64(&dependency->pending) == 0;
+    if (!ready) {
+        if (counter != NULL) {
+            avdAtomicAdd64(&counter->pending, (AVD_Int64)count);
+        }
+        continuation->next        = dependency->continuations;
+        dependency->continuations = continuation;
+    }
+    picoThreadMutexUnlock(PRIV_avdJobs.continuationMutex);
+
+    if (ready) {
+        AVD_FREE(continuation);
+        avdJobsRun(jobs, count, counter);
+    }
+}
+
+void avdJobsWait(AVD_JobCounter *counter)
+{
+    AVD_ASSERT(counter != NULL);
+
+    AVD_UInt32 idle = 0;
+    while (avdAtomicLoad64(&counter->pending) > 0) {
+        if (PRIV_avdJobsTryRunOne()) {
+            idle = 0;
+        } else if (++idle % 16 == 0) {
+            PRIV_avdJobsYield();
+        } else {
+            AVD_CPU_PAUSE();
+        }
+    }
+}
+
+bool avdJobCounterIsDone(AVD_JobCounter *counter)
+{
+    AVD_ASSERT(counter != NULL);
+    return avdAtomicLoad64(&counter->pending) == 0;
+}
+
+typedef struct {
+    AVD_JobRangeFn *function;
+    void *userData;
+    AVD_Size begin;
+    AVD_Size end;
+} AVD_JobRange;
+
+static void PRIV_avdJobsRunRange(void *userData)
+{
+    AVD_JobRange *range = (AVD_JobRange *)userData;
+    range->function(range->begin, range->end, range->userData);
+}
+
+void avdJobsParallelFor(AVD_Size count, AVD_Size grainSize, AVD_JobRangeFn *function, void *userData)
+{
+    AVD_ASSERT(function != NULL);
+
+    if (count == 0) {
+        return;
+    }
+
+    if (grainSize == 0) {
+        // a few ranges per thread leave room for stealing when the ranges are uneven
+        AVD_Size rangeCount = ((AVD_Size)PRIV_avdJobs.workerCount + 1) * 4;
+        grainSize           = AVD_MAX((count + rangeCount - 1) / rangeCount, (AVD_Size)1);
+    }
+
+    AVD_Size rangeCount = (count + grainSize - 1) / grainSize;
+    if (!PRIV_avdJobs.initialized || rangeCount == 1) {
+        function(0, count, userData);
+        return;
+    }
+
+    AVD_ArenaScratch scratch = avdArenaScratchBegin(NULL);
+    AVD_JobRange *ranges     = AVD_ARENA_PUSH_ARRAY(scratch.arena, AVD_JobRange, rangeCount);
+    AVD_Job *jobs            = AVD_ARENA_PUSH_ARRAY(scratch.arena, AVD_Job, rangeCount);
+    if (ranges == NULL || jobs == NULL) {
+        avdArenaScratchEnd(scratch);
+        function(0, count, userData);
+        return;
+    }
+
+    for (AVD_Size i = 0; i < rangeCount; i++) {
+        ranges[i].function = function;
+        ranges[i].userData = userData;
+        ranges[i].begin    = i * grainSize;
+        ranges[i].end      = AVD_MIN(ranges[i].begin + grainSize, count);
+        jobs[i].function   = PRIV_avdJobsRunRange;
+        jobs[i].userData   = &ranges[i];
+    }
+
+    AVD_JobCounter counter = {0};
+    avdJobsRun(jobs, rangeCount, &counter);
+    AVD_PROFILE_SCOPE("Jobs/ParallelForWait") {
+        avdJobsWait(&counter);
+    }
+
+    avdArenaScratchEnd(scratch);
+}
@@ -0,0 +1,351 @@
+#include "core/avd_atomic.h"
+#include "core/avd_core.h"
+#include <string.h>
+
+#define AVD_JOBS_TEST_WORKERS 3
+
+static void PRIV_avdTestJobsIncrement(void *userData)
+{
+    avdAtomicAdd64((volatile AVD_Int64 *)userData, 1);
+}
+
+static bool PRIV_avdTestJobsInline()
+{
+    AVD_LOG_DEBUG("  Testing Jobs inline fallback...");
+
+    volatile AVD_Int64 value = 0;
+    AVD_Job jobs[16];
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(jobs); i++) {
+        jobs[i] = (AVD_Job){.function = PRIV_avdTestJobsIncrement, .userData = (void *)&value};
+    }
+
+    AVD_JobCounter counter = {0};
+    avdJobsRun(jobs, AVD_ARRAY_COUNT(jobs), &counter);
+    if (value != 16 || !avdJobCounterIsDone(&counter)) {
+        AVD_LOG_ERROR("    FAILED: Jobs did not run inline without a job system (%lld)", (long long)value);
+        return false;
+    }
+
+    AVD_JobCounter after = {0};
+    avdJobsRunAfter(&counter, jobs, 4, &after);
+    avdJobsWait(&after);
+    if (value != 20) {
+        AVD_LOG_ERROR("    FAILED: Dependent jobs did not run inline (%lld)", (long long)value);
+        return false;
+    }
+
+    AVD_LOG_DEBUG("    Jobs inline fallback PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestJobsCounter()
+{
+    AVD_LOG_DEBUG("  Testing Jobs counter...");
+
+    static AVD_Job jobs[1000];
+    volatile AVD_Int64 value = 0;
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(jobs); i++) {
+        jobs[i] = (AVD_Job){.function = PRIV_avdTestJobsIncrement, .userData = (void *)&value};
+    }
+
+    // the counter is reused after every wait
+    AVD_JobCounter counter = {0};
+    for (int round = 1; round <= 5; round++) {
+        avdJobsRun(jobs, AVD_ARRAY_COUNT(jobs), &counter);
+        avdJobsWait(&counter);
+        if (avdAtomicLoad64(&value) != round * 1000) {
+            AVD_LOG_ERROR("    FAILED: Round %d finished with %lld jobs done", round, (long long)avdAtomicLoad64(&value));
+            return false;
+        }
+    }
+
+    AVD_LOG_DEBUG("    Jobs counter PASSED");
+    return true;
+}
+
+typedef struct {
+    volatile AVD_Int64 *hits;
+    volatile AVD_Int64 rangeCount;
+} AVD_JobsTestParallelFor;
+
+static void PRIV_avdTestJobsMarkRange(AVD_Size begin, AVD_Size end, void *userData)
+{
+    AVD_JobsTestParallelFor *test = (AVD_JobsTestParallelFor *)userData;
+    for (AVD_Size i = begin; i < end; i++) {
+        avdAtomicAdd64(&test->hits[i], 1);
+    }
+    avdAtomicAdd64(&test->rangeCount, 1);
+}
+
+static bool PRIV_avdTestJobsParallelFor()
+{
+    AVD_LOG_DEBUG("  Testing Jobs parallel for...");
+
+    static volatile AVD_Int64 hits[10007];
+    AVD_Size grainSizes[] = {1, 7, 0, 100000};
+
+    for (AVD_Size g = 0; g < AVD_ARRAY_COUNT(grainSizes); g++) {
+        memset((void *)hits, 0, sizeof(hits));
+        AVD_JobsTestParallelFor test = {.hits = hits};
+        avdJobsParallelFor(AVD_ARRAY_COUNT(hits), grainSizes[g], PRIV_avdTestJobsMarkRange, &test);
+
+        for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(hits); i++) {
+            if (hits[i] != 1) {
+                AVD_LOG_ERROR("    FAILED: Index %zu visited %lld times with grain size %zu", i, (long long)hits[i], grainSizes[g]);
+                return false;
+            }
+        }
+        if (grainSizes[g] != 0) {
+            AVD_Size expectedRanges = (AVD_ARRAY_COUNT(hits) + grainSizes[g] - 1) / grainSizes[g];
+            if ((AVD_Size)test.rangeCount != expectedRanges) {
+                AVD_LOG_ERROR("    FAILED: Expected %zu ranges, got %lld", expectedRanges, (long long)test.rangeCount);
+                return false;
+            }
+        }
+    }
+
+    AVD_JobsTestParallelFor empty = {.hits = hits};
+    avdJobsParallelFor(0, 0, PRIV_avdTestJobsMarkRange, &empty);
+    if (empty.rangeCount != 0) {
+        AVD_LOG_ERROR("    FAILED: Empty parallel for ran a range");
+        return false;
+    }
+
+    AVD_LOG_DEBUG("    Jobs parallel for PASSED");
+    return true;
+}
+
+typedef struct {
+    volatile AVD_Int64 stage;
+    volatile AVD_Int64 order[3];
+    volatile AVD_Int64 errors;
+} AVD_JobsTestChain;
+
+typedef struct {
+    AVD_JobsTestChain *chain;
+    AVD_Int64 index;
+} AVD_JobsTestChainLink;
+
+static void PRIV_avdTestJobsChainLink(void *userData)
+{
+    AVD_JobsTestChainLink *link = (AVD_JobsTestChainLink *)userData;
+    // the earlier stages have to be complete by the time a link runs
+    for (AVD_Int64 i = 0; i < link->index; i++) {
+        if (avdAtomicLoad64(&link->chain->order[i]) == 0) {
+            avdAtomicAdd64(&link->chain->errors, 1);
+        }
+    }
+    avdAtomicStore64(&link->chain->order[link->index], avdAtomicAdd64(&link->chain->stage, 1));
+}
+
+static void PRIV_avdTestJobsBlock(void *userData)
+{
+    volatile AVD_Int64 *release = (volatile AVD_Int64 *)userData;
+    while (avdAtomicLoad64(release) == 0) {
+        AVD_CPU_PAUSE();
+    }
+}
+
+static bool PRIV_avdTestJobsDependencies()
+{
+    AVD_LOG_DEBUG("  Testing Jobs dependencies...");
+
+    for (int round = 0; round < 100; round++) {
+        AVD_JobsTestChain chain        = {0};
+        AVD_JobsTestChainLink links[3] = {{&chain, 0}, {&chain, 1}, {&chain, 2}};
+        AVD_JobCounter counters[3]     = {0};
+        AVD_Job jobs[3];
+        for (AVD_Size i = 0; i < 3; i++) {
+            jobs[i] = (AVD_Job){.function = PRIV_avdTestJobsChainLink, .userData = &links[i]};
+        }
+
+        // the gate keeps A (and with it B and C) deferred until the whole chain is queued
+        volatile AVD_Int64 release = 0;
+        AVD_Job blocker            = {.function = PRIV_avdTestJobsBlock, .userData = (void *)&release};
+        AVD_JobCounter gate        = {0};
+        avdJobsRun(&blocker, 1, &gate);
+        avdJobsRunAfter(&gate, &jobs[0], 1, &counters[0]);
+        avdJobsRunAfter(&counters[0], &jobs[1], 1, &counters[1]);
+        avdJobsRunAfter(&counters[1], &jobs[2], 1, &counters[2]);
+
+        if (avdJobCounterIsDone(&counters[0]) || avdJobCounterIsDone(&counters[2])) {
+            AVD_LOG_ERROR("    FAILED: Dependent job finished before its dependency");
+            avdAtomicStore64(&release, 1);
+            avdJobsWait(&counters[2]);
+            return false;
+        }
+
+        avdAtomicStore64(&release, 1);
+        avdJobsWait(&counters[2]);
+
+        if (chain.errors != 0 || chain.order[0] != 1 || chain.order[1] != 2 || chain.order[2] != 3 || !avdJobCounterIsDone(&gate)) {
+            AVD_LOG_ERROR("    FAILED: Chain ran out of order (%lld, %lld, %lld)", (long long)chain.order[0], (long long)chain.order[1], (long long)chain.order[2]);
+            return false;
+        }
+    }
+
+    AVD_LOG_DEBUG("    Jobs dependencies PASSED");
+    return true;
+}
+
+typedef struct {
+    volatile AVD_Int64 sum;
+} AVD_JobsTestNested;
+
+static void PRIV_avdTestJobsNestedInner(AVD_Size begin, AVD_Size end, void *userData)
+{
+    AVD_JobsTestNested *test = (AVD_JobsTestNested *)userData;
+    AVD_Int64 sum            = 0;
+    for (AVD_Size i = begin; i < end; i++) {
+        sum += (AVD_Int64)i;
+    }
+    avdAtomicAdd64(&test->sum, sum);
+}
+
+static void PRIV_avdTestJobsNestedOuter(AVD_Size begin, AVD_Size end, void *userData)
+{
+    // every outer index waits on its own inner loop from whatever thread it landed on
+    for (AVD_Size i = begin; i < end; i++) {
+        avdJobsParallelFor(1000, 16, PRIV_avdTestJobsNestedInner, userData);
+    }
+}
+
+static bool PRIV_avdTestJobsNested()
+{
+    AVD_LOG_DEBUG("  Testing Jobs nested parallel for...");
+
+    AVD_JobsTestNested test = {0};
+    avdJobsParallelFor(64, 1, PRIV_avdTestJobsNestedOuter, &test);
+
+    AVD_Int64 expected = 64 * (999 * 1000 / 2);
+    if (test.sum != expected) {
+        AVD_LOG_ERROR("    FAILED: Nested sum is %lld, expected %lld", (long long)test.sum, (long long)expected);
+        return false;
+    }
+
+    AVD_LOG_DEBUG("    Jobs nested parallel for PASSED");
+    return true;
+}
+
+// The job system may already be running when the app calls this, in that case
+// the tests use it as is and the inline fallback can not be checked.
+bool avdJobsTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Jobs Tests...");
+
+    bool ownsJobSystem = !avdJobsIsInitialized();
+    if (ownsJobSystem) {
+        AVD_CHECK(PRIV_avdTestJobsInline());
+        AVD_CHECK(avdJobsInit(AVD_JOBS_TEST_WORKERS));
+    }
+
+    bool ok = PRIV_avdTestJobsCounter() && PRIV_avdTestJobsParallelFor() && PRIV_avdTestJobsDependencies() && PRIV_avdTestJobsNested();
+
+    if (ownsJobSystem) {
+        avdJobsShutdown();
+    }
+    AVD_CHECK(ok);
+
+    AVD_LOG_DEBUG("All AVD Jobs Tests PASSED");
+    return true;
+}
+
+typedef struct {
+    AVD_Float *values;
+    AVD_Size count;
+} AVD_JobsBenchmarkData;
+
+static void PRIV_avdJobsBenchmarkTransformRange(AVD_Size begin, AVD_Size end, void *userData)
+{
+    AVD_JobsBenchmarkData *data = (AVD_JobsBenchmarkData *)userData;
+    for (AVD_Size i = begin; i < end; i++) {
+        AVD_Float x = data->values[i];
+        for (int k = 0; k < 16; k++) {
+            x = x * 0.999f + 0.5f;
+        }
+        data->values[i] = x;
+    }
+}
+
+static void PRIV_avdJobsBenchmarkParallelFor(void *userData)
+{
+    AVD_JobsBenchmarkData *data = (AVD_JobsBenchmarkData *)userData;
+    avdJobsParallelFor(data->count, 4096, PRIV_avdJobsBenchmarkTransformRange, data);
+}
+
+static void PRIV_avdJobsBenchmarkEmpty(void *userData)
+{
+    (void)userData;
+}
+
+static void PRIV_avdJobsBenchmarkTinyJobs(void *userData)
+{
+    static AVD_Job jobs[4096];
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(jobs); i++) {
+        jobs[i] = (AVD_Job){.function = PRIV_avdJobsBenchmarkEmpty, .userData = userData};
+    }
+
+    AVD_JobCounter counter = {0};
+    avdJobsRun(jobs, AVD_ARRAY_COUNT(jobs), &counter);
+    avdJobsWait(&counter);
+}
+
+static bool PRIV_avdJobsBenchmarkThreads(AVD_Bench *bench, AVD_JobsBenchmarkData *data, AVD_UInt32 threadCount)
+{
+    AVD_CHECK(avdJobsInit(threadCount - 1));
+
+    char parallelForName[AVD_BENCH_NAME_LENGTH];
+    char tinyJobsName[AVD_BENCH_NAME_LENGTH];
+    snprintf(parallelForName, sizeof(parallelForName), "jobs/parallel_for/threads_%u", threadCount);
+    snprintf(tinyJobsName, sizeof(tinyJobsName), "jobs/tiny_jobs/threads_%u", threadCount);
+
+    AVD_BenchCase parallelForCase = {
+        .name               = parallelForName,
+        .unit               = "items",
+        .itemsPerRepetition = data->count,
+        .run                = PRIV_avdJobsBenchmarkParallelFor,
+        .userData           = data,
+    };
+    AVD_BenchCase tinyJobsCase = {
+        .name               = tinyJobsName,
+        .unit               = "jobs",
+        .itemsPerRepetition = 4096,
+        .run                = PRIV_avdJobsBenchmarkTinyJobs,
+        .userData           = NULL,
+    };
+
+    bool ok = avdBenchRun(bench, &parallelForCase) && avdBenchRun(bench, &tinyJobsCase);
+    avdJobsShutdown();
+    return ok;
+}
+
+bool avdJobsBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD Jobs benchmarks...");
+
+    // every thread count gets a fresh job system, so the caller must not have one running
+    AVD_CHECK_MSG(!avdJobsIsInitialized(), "Job benchmarks need to start the job system themselves");
+
+    AVD_JobsBenchmarkData data = {0};
+    data.count                 = 1 << 22;
+    data.values                = (AVD_Float *)AVD_MALLOC(sizeof(AVD_Float) * data.count);
+    AVD_CHECK_MSG(data.values != NULL, "Failed to allocate benchmark data");
+    for (AVD_Size i = 0; i < data.count; i++) {
+        data.values[i] = (AVD_Float)(i % 1024);
+    }
+
+    // 1, 2, 4, ... threads and always the full hardware thread count last
+    AVD_UInt32 maxThreads = AVD_MIN(avdJobsHardwareThreadCount(), (AVD_UInt32)AVD_JOBS_MAX_WORKERS + 1);
+    bool ok               = true;
+    for (AVD_UInt32 threads = 1; ok; threads *= 2) {
+        AVD_UInt32 threadCount = AVD_MIN(threads, maxThreads);
+        ok                     = PRIV_avdJobsBenchmarkThreads(bench, &data, threadCount);
+        if (threadCount == maxThreads) {
+            break;
+        }
+    }
+
+    AVD_FREE(data.values);
+    return ok;
+}
@@ -3,7 +3,98 @@
 #include <stdlib.h>
 #include <string.h>
 
+static size_t PRIV_avdListPhysicalIndex(const AVD_List *list, size_t index)
+{
+    size_t physical = list->head + index;
+    return physical >= list->capacity ? physical - list->capacity : physical;
+}
+
+static void *PRIV_avdListAt(const AVD_List *list, size_t index)
+{
+    return (char *)list->items + PRIV_avdListPhysicalIndex(list, index) * list->itemSize;
+}
+
+static void *PRIV_avdListAtPhysical(const AVD_List *list, size_t physical)
+{
+    return (char *)list->items + physical * list->itemSize;
+}
+
+// Shifts count items starting at the physical slot src one slot towards the front of the ring,
+// copying chunk by chunk front to back so the overlapping ranges stay intact.
+static void PRIV_avdListShiftTowardsFront(AVD_List *list, size_t src, size_t count)
+{
+    size_t dst = src == 0 ? list->capacity - 1 : src - 1;
+    while (count > 0) {
+        size_t chunk = AVD_MIN(count, AVD_MIN(list->capacity - src, list->capacity - dst));
+        memmove(PRIV_avdListAtPhysical(list, dst), PRIV_avdListAtPhysical(list, src), chunk * list->itemSize);
+        src = (src + chunk) % list->capacity;
+        dst = (dst + chunk) % list->capacity;
+        count -= chunk;
+    }
+}
+
+// Shifts count items starting at the physical slot src one slot towards the back of the ring,
+// copying chunk by chunk back to front so the overlapping ranges stay intact.
+static void PRIV_avdListShiftTowardsBack(AVD_List *list, size_t src, size_t count)
+{
+    size_t srcEnd = (src + count) % list->capacity;
+    size_t dstEnd = (src + count + 1) % list->capacity;
+    while (count > 0) {
+        size_t srcAvailable = srcEnd == 0 ? list->capacity : srcEnd;
+        size_t dstAvailable = dstEnd == 0 ? list->capacity : dstEnd;
+        size_t chunk        = AVD_MIN(count, AVD_MIN(srcAvailable, dstAvailable));
+        srcEnd              = srcAvailable - chunk;
+        dstEnd              = dstAvailable - chunk;
+        memmove(PRIV_avdListAtPhysical(list, dstEnd), PRIV_avdListAtPhysical(list, srcEnd), chunk * list->itemSize);
+        count -= chunk;
+    }
+}
+
+// Copies the items in logical order into a new allocation so that items[0] is the front.
+static bool PRIV_avdListLinearize(AVD_List *list, size_t newCapacity)
+{
+    assert(newCapacity >= list->count);
+
+    void *newItems = AVD_MALLOC(newCapacity * list->itemSize);
+    if (newItems == NULL) {
+        return false;
+    }
+
+    size_t firstChunk = AVD_MIN(list->count, list->capacity - list->head);
+    if (list->count > 0) {
+        memcpy(newItems, PRIV_avdListAtPhysical(list, list->head), firstChunk * list->itemSize);
+        memcpy((char *)newItems + firstChunk * list->itemSize, list->items, (list->count - firstChunk) * list->itemSize);
+    }
+
+    AVD_FREE(list->items);
+    list->items    = newItems;
+    list->capacity = newCapacity;
+    list->head     = 0;
+    return true;
+}
+
+static bool PRIV_avdListIsWrapped(const AVD_List *list)
+{
+    return list->head + list->count > list->capacity;
+}
+
+static void PRIV_avdListCallDestructors(AVD_List *list)
+{
+    if (!list->destructor) {
+        return;
+    }
+
+    for (size_t i = 0; i < list->count; i++) {
+        list->destructor(PRIV_avdListAt(list, i), list->destructorContext);
+    }
+}
+
 void avdListCreate(AVD_List *list, size_t itemSize)
+{
+    avdListCreateWithStorage(list, itemSize, AVD_LIST_STORAGE_CONTIGUOUS);
+}
+
+void avdListCreateWithStorage(AVD_List *list, size_t itemSize, AVD_ListStorage storage)
 {
     assert(list != NULL);
     assert(itemSize > 0);
@@ -11,7 +102,9 @@ void avdListCreate(AVD_List *list, size_t itemSize)
     list->itemSize          = itemSize;
     list->capacity          = AVD_LIST_INITIAL_CAPACITY;
     list->count             = 0;
-    list->items             = malloc(list->capacity * itemSize);
+    list->head              = 0;
+    list->items             = AVD_MALLOC(list->capacity * itemSize);
+    list->storage           = storage;
     list->destructor        = NULL;
     list->destructorContext = NULL;
     assert(list->items != NULL);
@@ -31,17 +124,13 @@ void avdListDestroy(AVD_List *list)
     AVD_ASSERT(list != NULL);
 
     if (list && list->items) {
-        if (list->destructor) {
-            for (size_t i = 0; i < list->count; i++) {
-                void *item = (char *)list->items + (i * list->itemSize);
-                list->destructor(item, list->destructorContext);
-            }
-        }
+        PRIV_avdListCallDestructors(list);
 
-        free(list->items);
+        AVD_FREE(list->items);
         list->items    = NULL;
         list->count    = 0;
         list->capacity = 0;
+        list->head     = 0;
     }
 }
 
@@ -53,16 +142,27 @@ void avdListEnsureCapacity(AVD_List *list, size_t newCapacity)
         return;
     }
 
-    size_t capacity = list->capacity;
+    size_t oldCapacity = list->capacity;
+    size_t capacity    = oldCapacity > 0 ? oldCapacity : AVD_LIST_INITIAL_CAPACITY;
     while (capacity < newCapacity) {
         capacity *= AVD_LIST_GROWTH_FACTOR;
     }
 
-    void *newItems = realloc(list->items, capacity * list->itemSize);
+    bool wasWrapped = PRIV_avdListIsWrapped(list);
+
+    void *newItems = AVD_REALLOC(list->items, capacity * list->itemSize);
     assert(newItems != NULL);
 
     list->items    = newItems;
     list->capacity = capacity;
+
+    // move the segment between head and the old end up to the new end so the ring stays in order
+    if (wasWrapped) {
+        size_t tailSegment = oldCapacity - list->head;
+        size_t newHead     = capacity - tailSegment;
+        memmove(PRIV_avdListAtPhysical(list, newHead), PRIV_avdListAtPhysical(list, list->head), tailSegment * list->itemSize);
+        list->head = newHead;
+    }
 }
 
 void *avdListAddEmpty(AVD_List *list)
@@ -71,7 +171,7 @@ void *avdListAddEmpty(AVD_List *list)
 
     avdListEnsureCapacity(list, list->count + 1);
 
-    void *dest = (char *)list->items + (list->count * list->itemSize);
+    void *dest = PRIV_avdListAt(list, list->count);
     memset(dest, 0, list->itemSize);
     list->count++;
 
@@ -85,7 +185,14 @@ void *avdListAddEmptyN(AVD_List *list, size_t n) // adds N empty elements and re
 
     avdListEnsureCapacity(list, list->count + n);
 
-    void *dest = (char *)list->items + (list->count * list->itemSize);
+    // the returned range has to be contiguous, so a ring that would wrap inside it is linearized first
+    if (PRIV_avdListPhysicalIndex(list, list->count) + n > list->capacity) {
+        bool linearized = PRIV_avdListLinearize(list, list->capacity);
+        assert(linearized);
+        (void)linearized;
+    }
+
+    void *dest = PRIV_avdListAt(list, list->count);
     memset(dest, 0, n * list->itemSize);
     list->count += n;
 
@@ -99,7 +206,7 @@ void *avdListPushBack(AVD_List *list, const void *item)
 
     avdListEnsureCapacity(list, list->count + 1);
 
-    void *dest = (char *)list->items + (list->count * list->itemSize);
+    void *dest = PRIV_avdListAt(list, list->count);
     memcpy(dest, item, list->itemSize);
     list->count++;
 
@@ -113,16 +220,19 @@ void *avdListPushFront(AVD_List *list, const void *item)
 
     avdListEnsureCapacity(list, list->count + 1);
 
-    // Shift all elements one position to the right
-    if (list->count > 0) {
+    if (list->storage == AVD_LIST_STORAGE_RING) {
+        list->head = list->head == 0 ? list->capacity - 1 : list->head - 1;
+    } else if (list->count > 0) {
+        // Shift all elements one position to the right
         memmove((char *)list->items + list->itemSize, list->items,
                 list->count * list->itemSize);
     }
 
-    memcpy(list->items, item, list->itemSize);
+    void *dest = PRIV_avdListAt(list, 0);
+    memcpy(dest, item, list->itemSize);
     list->count++;
 
-    return list->items;
+    return dest;
 }
 
 void *avdListPopBack(AVD_List *list)
@@ -134,7 +244,7 @@ void *avdListPopBack(AVD_List *list)
     }
 
     list->count--;
-    return (char *)list->items + (list->count * list->itemSize);
+    return PRIV_avdListAt(list, list->count);
 }
 
 void *avdListPopFront(AVD_List *list)
@@ -145,7 +255,17 @@ void *avdListPopFront(AVD_List *list)
         return NULL;
     }
 
-    void *front = list->items;
+    if (list->storage == AVD_LIST_STORAGE_RING) {
+        void *front = PRIV_avdListAt(list, 0);
+        list->head  = PRIV_avdListPhysicalIndex(list, 1);
+        list->count--;
+        return front;
+    }
+
+    // Park the popped item in the spare slot past the end, the shift below overwrites items[0]
+    avdListEnsureCapacity(list, list->count + 1);
+    void *front = (char *)list->items + (list->count * list->itemSize);
+    memcpy(front, list->items, list->itemSize);
 
     // Shift all elements one position to the left
     if (list->count > 1) {
@@ -165,7 +285,7 @@ void *avdListGet(const AVD_List *list, size_t index)
         return NULL;
     }
 
-    return (char *)list->items + (index * list->itemSize);
+    return PRIV_avdListAt(list, index);
 }
 
 void *avdListGetBack(const AVD_List *list)
@@ -176,7 +296,7 @@ void *avdListGetBack(const AVD_List *list)
         return NULL;
     }
 
-    return (char *)list->items + ((list->count - 1) * list->itemSize);
+    return PRIV_avdListAt(list, list->count - 1);
 }
 
 void *avdListGetFront(const AVD_List *list)
@@ -187,19 +307,15 @@ void *avdListGetFront(const AVD_List *list)
         return NULL;
     }
 
-    return list->items;
+    return PRIV_avdListAt(list, 0);
 }
 
 void avdListClear(AVD_List *list)
 {
     assert(list != NULL);
-    if (list->destructor) {
-        for (size_t i = 0; i < list->count; i++) {
-            void *item = (char *)list->items + (i * list->itemSize);
-            list->destructor(item, list->destructorContext);
-        }
-    }
+    PRIV_avdListCallDestructors(list);
     list->count = 0;
+    list->head  = 0;
 }
 
 void avdListResize(AVD_List *list, size_t newSize)
@@ -210,10 +326,13 @@ void avdListResize(AVD_List *list, size_t newSize)
         avdListEnsureCapacity(list, newSize);
     }
 
-    // If growing, zero out new elements
-    if (newSize > list->count) {
-        void *newElements = (char *)list->items + (list->count * list->itemSize);
-        memset(newElements, 0, (newSize - list->count) * list->itemSize);
+    // If growing, zero out new elements (in up to two chunks when the ring wraps)
+    size_t index = list->count;
+    while (index < newSize) {
+        size_t physical = PRIV_avdListPhysicalIndex(list, index);
+        size_t chunk    = AVD_MIN(newSize - index, list->capacity - physical);
+        memset(PRIV_avdListAtPhysical(list, physical), 0, chunk * list->itemSize);
+        index += chunk;
     }
 
     list->count = newSize;
@@ -228,16 +347,19 @@ void avdListRemove(AVD_List *list, size_t index)
     }
 
     if (list->destructor) {
-        void *item = (char *)list->items + (index * list->itemSize);
-        list->destructor(item, list->destructorContext);
+        list->destructor(PRIV_avdListAt(list, index), list->destructorContext);
     }
 
-    // Shift elements after index to the left
-    if (index < list->count - 1) {
-        void *dest      = (char *)list->items + (index * list->itemSize);
-        void *src       = (char *)list->items + ((index + 1) * list->itemSize);
-        size_t moveSize = (list->count - index - 1) * list->itemSize;
-        memmove(dest, src, moveSize);
+    size_t itemsBefore = index;
+    size_t itemsAfter  = list->count - index - 1;
+
+    if (list->storage == AVD_LIST_STORAGE_RING && itemsBefore < itemsAfter) {
+        // Shift elements before index to the right and advance the head
+        PRIV_avdListShiftTowardsBack(list, list->head, itemsBefore);
+        list->head = PRIV_avdListPhysicalIndex(list, 1);
+    } else if (itemsAfter > 0) {
+        // Shift elements after index to the left
+        PRIV_avdListShiftTowardsFront(list, PRIV_avdListPhysicalIndex(list, index + 1), itemsAfter);
     }
 
     list->count--;
@@ -254,17 +376,21 @@ void avdListInsert(AVD_List *list, size_t index, const void *item)
 
     avdListEnsureCapacity(list, list->count + 1);
 
-    // Shift elements after index to the right
-    if (index < list->count) {
-        void *dest      = (char *)list->items + ((index + 1) * list->itemSize);
-        void *src       = (char *)list->items + (index * list->itemSize);
-        size_t moveSize = (list->count - index) * list->itemSize;
-        memmove(dest, src, moveSize);
+    size_t itemsBefore = index;
+    size_t itemsAfter  = list->count - index;
+
+    if (list->storage == AVD_LIST_STORAGE_RING && itemsBefore < itemsAfter) {
+        // Step the head back and shift elements before index to the left
+        size_t oldHead = list->head;
+        list->head     = list->head == 0 ? list->capacity - 1 : list->head - 1;
+        PRIV_avdListShiftTowardsFront(list, oldHead, itemsBefore);
+    } else if (itemsAfter > 0) {
+        // Shift elements after index to the right
+        PRIV_avdListShiftTowardsBack(list, PRIV_avdListPhysicalIndex(list, index), itemsAfter);
     }
 
     // Insert new item
-    void *insertPos = (char *)list->items + (index * list->itemSize);
-    memcpy(insertPos, item, list->itemSize);
+    memcpy(PRIV_avdListAt(list, index), item, list->itemSize);
     list->count++;
 }
 
@@ -277,6 +403,12 @@ void avdListSort(AVD_List *list, int (*compare)(const void *, const void *))
         return;
     }
 
+    if (list->head != 0) {
+        bool linearized = PRIV_avdListLinearize(list, list->capacity);
+        assert(linearized);
+        (void)linearized;
+    }
+
     qsort(list->items, list->count, list->itemSize, compare);
 }
 
@@ -291,13 +423,20 @@ bool avdListTighten(AVD_List *list)
     assert(list != NULL);
 
     if (list->count == 0) {
-        free(list->items);
+        if (list->items) {
+            AVD_FREE(list->items);
+        }
         list->items    = NULL;
         list->capacity = 0;
+        list->head     = 0;
         return true;
     }
 
-    void *newItems = realloc(list->items, list->count * list->itemSize);
+    if (list->head != 0) {
+        return PRIV_avdListLinearize(list, list->count);
+    }
+
+    void *newItems = AVD_REALLOC(list->items, list->count * list->itemSize);
     if (newItems == NULL) {
         return false; // Reallocation failed
     }
@@ -633,6 +633,219 @@ static bool PRIV_avdTestListDestructor()
     return true;
 }
 
+static bool PRIV_avdTestListRingQueue()
+{
+    AVD_LOG_DEBUG("  Testing ring List queue operations...");
+
+    AVD_List list;
+    avdListCreateWithStorage(&list, sizeof(int), AVD_LIST_STORAGE_RING);
+
+    // Keep the queue partially full while pushing and popping so the head wraps many times
+    int nextPush = 0;
+    int nextPop  = 0;
+    for (int round = 0; round < 1000; round++) {
+        for (int i = 0; i < 3; i++) {
+            avdListPushBack(&list, &nextPush);
+            nextPush++;
+        }
+        for (int i = 0; i < 2; i++) {
+            int *value = (int *)avdListPopFront(&list);
+            if (value == NULL || *value != nextPop) {
+                AVD_LOG_ERROR("    FAILED: Ring queue pop order");
+                avdListDestroy(&list);
+                return false;
+            }
+            nextPop++;
+        }
+    }
+
+    if (list.count != (size_t)(nextPush - nextPop)) {
+        AVD_LOG_ERROR("    FAILED: Ring queue count");
+        avdListDestroy(&list);
+        return false;
+    }
+
+    for (size_t i = 0; i < list.count; i++) {
+        int *value = (int *)avdListGet(&list, i);
+        if (value == NULL || *value != nextPop + (int)i) {
+            AVD_LOG_ERROR("    FAILED: Ring queue indexing at %zu", i);
+            avdListDestroy(&list);
+            return false;
+        }
+    }
+
+    // Push front and pop back form the mirrored queue
+    avdListClear(&list);
+    for (int i = 0; i < 100; i++) {
+        avdListPushFront(&list, &i);
+    }
+    for (int i = 0; i < 100; i++) {
+        int *value = (int *)avdListPopBack(&list);
+        if (value == NULL || *value != i) {
+            AVD_LOG_ERROR("    FAILED: Ring push front / pop back order");
+            avdListDestroy(&list);
+            return false;
+        }
+    }
+
+    avdListDestroy(&list);
+    AVD_LOG_DEBUG("    Ring List queue operations PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestListRingMatchesContiguous()
+{
+    AVD_LOG_DEBUG("  Testing ring List against contiguous List...");
+
+    AVD_List ring;
+    AVD_List flat;
+    avdListCreateWithStorage(&ring, sizeof(int), AVD_LIST_STORAGE_RING);
+    avdListCreate(&flat, sizeof(int));
+
+    // Deterministic pseudo random sequence of every mutating operation
+    uint32_t state = 12345;
+    for (int step = 0; step < 20000; step++) {
+        state          = state * 1664525u + 1013904223u;
+        uint32_t op    = (state >> 8) % 8;
+        int value      = (int)(state >> 4);
+        size_t index   = flat.count > 0 ? (state >> 12) % (flat.count + 1) : 0;
+        bool shouldPop = flat.count > 64;
+
+        if (op == 0 || (op == 1 && shouldPop)) {
+            avdListPopFront(&ring);
+            avdListPopFront(&flat);
+        } else if (op == 1) {
+            avdListPushFront(&ring, &value);
+            avdListPushFront(&flat, &value);
+        } else if (op == 2 && shouldPop) {
+            avdListPopBack(&ring);
+            avdListPopBack(&flat);
+        } else if (op == 2 || op == 3) {
+            avdListPushBack(&ring, &value);
+            avdListPushBack(&flat, &value);
+        } else if (op == 4) {
+            avdListInsert(&ring, index, &value);
+            avdListInsert(&flat, index, &value);
+        } else if (op == 5) {
+            avdListRemove(&ring, index);
+            avdListRemove(&flat, index);
+        } else if (op == 6 && step % 97 == 0) {
+            int *added = (int *)avdListAddEmptyN(&ring, 5);
+            for (int i = 0; i < 5; i++) {
+                added[i] = value + i;
+            }
+            added = (int *)avdListAddEmptyN(&flat, 5);
+            for (int i = 0; i < 5; i++) {
+                added[i] = value + i;
+            }
+        } else if (op == 7 && step % 101 == 0) {
+            avdListTighten(&ring);
+            avdListTighten(&flat);
+        }
+
+        if (ring.count != flat.count) {
+            AVD_LOG_ERROR("    FAILED: Ring count diverged at step %d", step);
+            avdListDestroy(&ring);
+            avdListDestroy(&flat);
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < flat.count; i++) {
+        if (*(int *)avdListGet(&ring, i) != *(int *)avdListGet(&flat, i)) {
+            AVD_LOG_ERROR("    FAILED: Ring contents diverged at index %zu", i);
+            avdListDestroy(&ring);
+            avdListDestroy(&flat);
+            return false;
+        }
+    }
+
+    // Tighten must leave a flat array behind even when the ring wraps
+    avdListTighten(&ring);
+    if (ring.head != 0 || memcmp(ring.items, flat.items, flat.count * sizeof(int)) != 0) {
+        AVD_LOG_ERROR("    FAILED: Ring tighten did not linearize");
+        avdListDestroy(&ring);
+        avdListDestroy(&flat);
+        return false;
+    }
+
+    avdListDestroy(&ring);
+    avdListDestroy(&flat);
+    AVD_LOG_DEBUG("    Ring List against contiguous List PASSED");
+    return true;
+}
+
+typedef struct {
+    AVD_List list;
+    size_t depth;
+    size_t iterations;
+    AVD_UInt64 checksum;
+} AVD_ListBenchmarkQueue;
+
+static bool PRIV_avdListBenchmarkQueueClear(void *userData)
+{
+    AVD_ListBenchmarkQueue *queue = (AVD_ListBenchmarkQueue *)userData;
+    avdListClear(&queue->list);
+    return true;
+}
+
+static void PRIV_avdListBenchmarkQueueFill(void *userData)
+{
+    AVD_ListBenchmarkQueue *queue = (AVD_ListBenchmarkQueue *)userData;
+    for (AVD_UInt64 i = 0; i < queue->depth; i++) {
+        avdListPushBack(&queue->list, &i);
+    }
+}
+
+static void PRIV_avdListBenchmarkQueueSteady(void *userData)
+{
+    // steady state FIFO, every iteration dequeues the oldest item and enqueues a new one
+    AVD_ListBenchmarkQueue *queue = (AVD_ListBenchmarkQueue *)userData;
+    for (AVD_UInt64 i = 0; i < queue->iterations; i++) {
+        queue->checksum += *(AVD_UInt64 *)avdListPopFront(&queue->list);
+        avdListPushBack(&queue->list, &i);
+    }
+}
+
+static bool PRIV_avdListBenchmarkQueue(AVD_Bench *bench, AVD_ListStorage storage, size_t depth, size_t iterations)
+{
+    const char *storageName      = storage == AVD_LIST_STORAGE_RING ? "ring" : "contiguous";
+    AVD_ListBenchmarkQueue queue = {.depth = depth, .iterations = iterations};
+    avdListCreateWithStorage(&queue.list, sizeof(AVD_UInt64), storage);
+
+    char fillName[AVD_BENCH_NAME_LENGTH];
+    char steadyName[AVD_BENCH_NAME_LENGTH];
+    snprintf(fillName, sizeof(fillName), "list/%s/fill/%zu", storageName, depth);
+    snprintf(steadyName, sizeof(steadyName), "list/%s/pop_front_push_back/%zu", storageName, depth);
+
+    AVD_BenchCase fill = {
+        .name               = fillName,
+        .unit               = "ops",
+        .itemsPerRepetition = depth,
+        .setup              = PRIV_avdListBenchmarkQueueClear,
+        .run                = PRIV_avdListBenchmarkQueueFill,
+        .userData           = &queue,
+    };
+    AVD_BenchCase steady = {
+        .name               = steadyName,
+        .unit               = "ops",
+        .itemsPerRepetition = iterations,
+        .run                = PRIV_avdListBenchmarkQueueSteady,
+        .userData           = &queue,
+    };
+
+    // the fill case leaves the queue at full depth for the steady state case
+    bool ok = avdBenchRun(bench, &fill);
+    if (ok && queue.list.count != depth) {
+        PRIV_avdListBenchmarkQueueClear(&queue);
+        PRIV_avdListBenchmarkQueueFill(&queue);
+    }
+    ok = ok && avdBenchRun(bench, &steady);
+
+    avdListDestroy(&queue.list);
+    return ok;
+}
+
 bool avdListTestsRun(void)
 {
     AVD_LOG_DEBUG("Running AVD List Tests...");
@@ -647,7 +860,21 @@ bool avdListTestsRun(void)
     AVD_CHECK(PRIV_avdTestListWithStrings());
     AVD_CHECK(PRIV_avdTestListEdgeCases());
     AVD_CHECK(PRIV_avdTestListDestructor());
+    AVD_CHECK(PRIV_avdTestListRingQueue());
+    AVD_CHECK(PRIV_avdTestListRingMatchesContiguous());
 
     AVD_LOG_DEBUG("All AVD List Tests passed successfully!");
     return true;
-}
\ No newline at end of file
+}
+
+bool avdListBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD List benchmarks...");
+
+    AVD_CHECK(PRIV_avdListBenchmarkQueue(bench, AVD_LIST_STORAGE_RING, 1000000, 1000000));
+    // the contiguous list moves the whole queue on every pop, so only a few iterations are measured
+    AVD_CHECK(PRIV_avdListBenchmarkQueue(bench, AVD_LIST_STORAGE_CONTIGUOUS, 1000000, 1000));
+
+    return true;
+}
@@ -0,0 +1,979 @@
+#include "core/avd_log.h"
+#include "core/avd_atomic.h"
+#include "core/avd_base.h"
+
+#include "pico/picoThreads.h"
+
+#define AVD_LOG_MODULE_CACHE_SIZE 64
+#define AVD_LOG_MAX_SPEC_LENGTH   32
+
+typedef enum {
+    AVD_LOG_ARG_INT = 0,
+    AVD_LOG_ARG_LONG,
+    AVD_LOG_ARG_LONG_LONG,
+    AVD_LOG_ARG_SIZE,
+    AVD_LOG_ARG_INTMAX,
+    AVD_LOG_ARG_PTRDIFF,
+    AVD_LOG_ARG_DOUBLE,
+    AVD_LOG_ARG_LONG_DOUBLE,
+    AVD_LOG_ARG_POINTER,
+    AVD_LOG_ARG_STRING,
+} AVD_LogArgType;
+
+// One printf conversion, without the leading '%'.
+typedef struct {
+    AVD_Size length; // up to and including the conversion character
+    AVD_LogArgType type;
+    bool widthFromArg;
+    bool precisionFromArg;
+    int precision; // -1 when there is none or it is passed as an argument
+} AVD_LogSpec;
+
+// The arguments are stored back to back in the order the format consumes them,
+// strings inline with their terminator. Messages whose arguments do not fit are
+// written synchronously instead.
+typedef struct {
+    const char *format;
+    AVD_Double timeUs;
+    AVD_UInt16 argsSize;
+    AVD_UInt8 level;
+    AVD_UInt8 module;
+    AVD_UInt8 args[AVD_LOG_RECORD_SIZE - 20];
+} AVD_LogRecord;
+
+// Single producer (the owning thread), single consumer (the logger thread).
+typedef struct AVD_LogThread {
+    struct AVD_LogThread *next;
+
+    volatile AVD_Int64 writeIndex;
+    volatile AVD_Int64 readIndex;
+    volatile AVD_Int64 dropped;
+    volatile AVD_Int64 retired;
+
+    AVD_LogRecord records[AVD_LOG_RECORDS_PER_THREAD];
+} AVD_LogThread;
+
+typedef struct {
+    AVD_LogThread *thread;
+    AVD_Int64 index;
+} AVD_LogRecordRef;
+
+typedef struct {
+    const char *file;
+    AVD_LogModule module;
+} AVD_LogModuleCacheEntry;
+
+typedef struct {
+    volatile AVD_Int64 running;
+    volatile AVD_Int64 stopping;
+    volatile AVD_Int64 synchronous;
+    picoPerfTime epoch;
+
+    void *volatile threads; // AVD_LogThread list, only ever prepended to
+
+    picoThread thread;
+    picoThreadChannel wakeChannel;  // AVD_Int64 flush tickets, 0 only wakes the logger up
+    picoThreadChannel flushChannel; // one entry per handled ticket
+    volatile AVD_Int64 nextFlushTicket;
+    volatile AVD_Int64 flushedTicket;
+
+    // held while the sink runs once the logger is up
+    picoThreadMutex sinkMutex;
+    AVD_LogSinkFn *sink;
+    void *sinkUserData;
+
+    // owned by the logger thread
+    AVD_LogRecordRef *refs;
+    AVD_Int64 reportedDrops;
+} AVD_Logger;
+
+static AVD_Logger PRIV_avdLogger   = {0};
+static bool PRIV_avdLogAtExitAdded = false;
+
+static volatile AVD_Int64 PRIV_avdLogModuleLevels[AVD_LOG_MODULE_COUNT] = {0};
+
+static AVD_THREAD_LOCAL AVD_LogThread *PRIV_avdLogCurrentThread = NULL;
+static AVD_THREAD_LOCAL bool PRIV_avdLogIsLoggerThread          = false;
+static AVD_THREAD_LOCAL AVD_LogModuleCacheEntry PRIV_avdLogModuleCache[AVD_LOG_MODULE_CACHE_SIZE];
+
+static const char *PRIV_avdLogLevelNames[] = {
+    "verbose",
+    "debug",
+    "info",
+    "warn",
+    "error",
+    "none",
+};
+
+static const char *PRIV_avdLogModuleNames[AVD_LOG_MODULE_COUNT] = {
+    "general",
+    "core",
+    "vulkan",
+    "scenes",
+    "hls",
+    "video",
+    "audio",
+    "model",
+    "font",
+    "shader",
+};
+
+static const struct {
+    const char *directory;
+    AVD_LogModule module;
+} PRIV_avdLogModuleDirectories[] = {
+    {"core", AVD_LOG_MODULE_CORE},
+    {"vulkan", AVD_LOG_MODULE_VULKAN},
+    {"scenes", AVD_LOG_MODULE_SCENES},
+    {"hls_player", AVD_LOG_MODULE_HLS},
+    {"video", AVD_LOG_MODULE_VIDEO},
+    {"audio", AVD_LOG_MODULE_AUDIO},
+    {"model", AVD_LOG_MODULE_MODEL},
+    {"font", AVD_LOG_MODULE_FONT},
+    {"shader", AVD_LOG_MODULE_SHADER},
+};
+
+void avdLogDefaultSink(AVD_LogLevel level, AVD_LogModule module, const char *message, void *userData)
+{
+    (void)module;
+    (void)userData;
+
+    switch (level) {
+        case AVD_LOG_LEVEL_VERBOSE:
+            PICO_VERBOSE("%s", message);
+            break;
+        case AVD_LOG_LEVEL_DEBUG:
+            PICO_DEBUG("%s", message);
+            break;
+        case AVD_LOG_LEVEL_INFO:
+            PICO_INFO("%s", message);
+            break;
+        case AVD_LOG_LEVEL_WARN:
+            PICO_WARN("%s", message);
+            break;
+        default:
+            PICO_ERROR("%s", message);
+            break;
+    }
+}
+
+static void PRIV_avdLogEmit(AVD_LogLevel level, AVD_LogModule module, const char *message)
+{
+    AVD_LogSinkFn *sink = PRIV_avdLogger.sink != NULL ? PRIV_avdLogger.sink : avdLogDefaultSink;
+    sink(level, module, message, PRIV_avdLogger.sinkUserData);
+}
+
+static void PRIV_avdLogLockSink(void)
+{
+    if (PRIV_avdLogger.sinkMutex != NULL) {
+        picoThreadMutexLock(PRIV_avdLogger.sinkMutex, PICO_THREAD_INFINITE);
+    }
+}
+
+static void PRIV_avdLogUnlockSink(void)
+{
+    if (PRIV_avdLogger.sinkMutex != NULL) {
+        picoThreadMutexUnlock(PRIV_avdLogger.sinkMutex);
+    }
+}
+
+static bool PRIV_avdLogIsSeparator(char c)
+{
+    return c == '/' || c == '\\';
+}
+
+static AVD_LogModule PRIV_avdLogModuleOf(const char *file)
+{
+    // __FILE__ is the same literal for every call in a translation unit
+    AVD_LogModuleCacheEntry *entry = &PRIV_avdLogModuleCache[((uintptr_t)file >> 4) % AVD_LOG_MODULE_CACHE_SIZE];
+    if (entry->file != file) {
+        entry->file   = file;
+        entry->module = avdLogModuleFromFile(file);
+    }
+    return entry->module;
+}
+
+static bool PRIV_avdLogParseSpec(const char *spec, AVD_LogSpec *outSpec)
+{
+    memset(outSpec, 0, sizeof(AVD_LogSpec));
+    outSpec->precision = -1;
+
+    const char *c = spec;
+    while (*c != '\0' && strchr("-+ #0", *c) != NULL) {
+        c++;
+    }
+
+    if (*c == '*') {
+        outSpec->widthFromArg = true;
+        c++;
+    } else {
+        while (isdigit((unsigned char)*c)) {
+            c++;
+        }
+    }
+
+    if (*c == '.') {
+        c++;
+        if (*c == '*') {
+            outSpec->precisionFromArg = true;
+            c++;
+        } else {
+            outSpec->precision = 0;
+            while (isdigit((unsigned char)*c)) {
+                outSpec->precision = outSpec->precision * 10 + (*c - '0');
+                c++;
+            }
+        }
+    }
+
+    // h and hh arguments are promoted to int anyway
+    AVD_LogArgType integerType = AVD_LOG_ARG_INT;
+    bool longDouble            = false;
+    bool hasLength             = true;
+    if (c[0] == 'h') {
+        c += c[1] == 'h' ? 2 : 1;
+    } else if (c[0] == 'l' && c[1] == 'l') {
+        integerType = AVD_LOG_ARG_LONG_LONG;
+        c += 2;
+    } else if (c[0] == 'l') {
+        integerType = AVD_LOG_ARG_LONG;
+        c++;
+    } else if (c[0] == 'z') {
+        integerType = AVD_LOG_ARG_SIZE;
+        c++;
+    } else if (c[0] == 'j') {
+        integerType = AVD_LOG_ARG_INTMAX;
+        c++;
+    } else if (c[0] == 't') {
+        integerType = AVD_LOG_ARG_PTRDIFF;
+        c++;
+    } else if (c[0] == 'L') {
+        longDouble = true;
+        c++;
+    } else {
+        hasLength = false;
+    }
+
+    switch (*c) {
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            if (longDouble) {
+                return false;
+            }
+            outSpec->type = integerType;
+            break;
+        case 'c':
+            // %lc takes a wint_t
+            if (hasLength) {
+                return false;
+            }
+            outSpec->type = AVD_LOG_ARG_INT;
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            outSpec->type = longDouble ? AVD_LOG_ARG_LONG_DOUBLE : AVD_LOG_ARG_DOUBLE;
+            break;
+        case 's':
+            // %ls takes a wide string
+            if (hasLength) {
+                return false;
+            }
+            outSpec->type = AVD_LOG_ARG_STRING;
+            break;
+        case 'p':
+            outSpec->type = AVD_LOG_ARG_POINTER;
+            break;
+        default:
+            // %n and anything we do not know about
+            return false;
+    }
+
+    outSpec->length = (AVD_Size)(c + 1 - spec);
+    return outSpec->length <= AVD_LOG_MAX_SPEC_LENGTH;
+}
+
+static bool PRIV_avdLogPushArg(AVD_LogRecord *record, AVD_Size *offset, const void *value, AVD_Size size)
+{
+    if (*offset + size > sizeof(record->args)) {
+        return false;
+    }
+    memcpy(record->args + *offset, value, size);
+    *offset += size;
+    return true;
+}
+
+static void PRIV_avdLogPopArg(const AVD_LogRecord *record, AVD_Size *offset, void *value, AVD_Size size)
+{
+    memcpy(value, record->args + *offset, size);
+    *offset += size;
+}
+
+#define PRIV_AVD_LOG_PUSH_ARG(record, offset, args, type)                 \
+    {                                                                     \
+        type value = va_arg(args, type);                                  \
+        if (!PRIV_avdLogPushArg(record, offset, &value, sizeof(value))) { \
+            return false;                                                 \
+        }                                                                 \
+    }
+
+// Copies the raw arguments the format will consume, fails for conversions the
+// logger thread could not reproduce and when they do not fit into the record.
+static bool PRIV_avdLogEncodeArgs(AVD_LogRecord *record, const char *format, va_list args)
+{
+    AVD_Size offset = 0;
+    for (const char *c = format; *c != '\0'; c++) {
+        if (*c != '%') {
+            continue;
+        }
+        if (c[1] == '%') {
+            c++;
+            continue;
+        }
+
+        AVD_LogSpec spec;
+        if (!PRIV_avdLogParseSpec(c + 1, &spec)) {
+            return false;
+        }
+        c += spec.length;
+
+        if (spec.widthFromArg) {
+            PRIV_AVD_LOG_PUSH_ARG(record, &offset, args, int);
+        }
+        int precision = spec.precision;
+        if (spec.precisionFromArg) {
+            precision = va_arg(args, int);
+            if (!PRIV_avdLogPushArg(record, &offset, &precision, sizeof(precision))) {
+                return false;
+            }
+        }
+
+        switch (spec.type) {
+            case AVD_LOG_ARG_INT:
+                PRIV_AVD_LOG_PUSH_ARG(record, &offset, args, int);
+                break;
+            case AVD_LOG_ARG_LONG:
+                PRIV_AVD_LOG_PUSH_ARG(record, &offset, args, long);
+                break;
+            case AVD_LOG_ARG_LONG_LONG:
+                PRIV_AVD_LOG_PUSH_ARG(record, &offset, args, long long);
+                break;
+            case AVD_LOG_ARG_SIZE:
+                PRIV_AVD_LOG_PUSH_ARG(record, &offset, args, size_t);
+                break;
+            case AVD_LOG_ARG_INTMAX:
+                PRIV_AVD_LOG_PUSH_ARG(record, &offset, args, intmax_t);
+                break;
+            case AVD_LOG_ARG_PTRDIFF:
+                PRIV_AVD_LOG_PUSH_ARG(record, &offset, args, ptrdiff_t);
+                break;
+            case AVD_LOG_ARG_DOUBLE:
+                PRIV_AVD_LOG_PUSH_ARG(record, &offset, args, double);
+                break;
+            case AVD_LOG_ARG_LONG_DOUBLE:
+                PRIV_AVD_LOG_PUSH_ARG(record, &offset, args, long double);
+                break;
+            case AVD_LOG_ARG_POINTER:
+                PRIV_AVD_LOG_PUSH_ARG(record, &offset, args, void *);
+                break;
+            case AVD_LOG_ARG_STRING: {
+                const char *value = va_arg(args, const char *);
+                if (value == NULL) {
+                    value = "(null)";
+                }
+                // with a precision the string does not have to be terminated
+                AVD_Size length = 0;
+                if (precision >= 0) {
+                    const char *end = (const char *)memchr(value, '\0', (AVD_Size)precision);
+                    length          = end != NULL ? (AVD_Size)(end - value) : (AVD_Size)precision;
+                } else {
+                    length = strlen(value);
+                }
+                if (offset + length + 1 > sizeof(record->args)) {
+                    return false;
+                }
+                memcpy(record->args + offset, value, length);
+                record->args[offset + length] = '\0';
+                offset += length + 1;
+                break;
+            }
+        }
+    }
+
+    record->argsSize = (AVD_UInt16)offset;
+    return true;
+}
+
+#define PRIV_AVD_LOG_FORMAT_ARG(record, offset, type, spec, out, outSize, written) \
+    {                                                                              \
+        type value;                                                                \
+        PRIV_avdLogPopArg(record, offset, &value, sizeof(value));                  \
+        written = snprintf(out, outSize, spec, value);                             \
+    }
+
+static void PRIV_avdLogFormatRecord(const AVD_LogRecord *record, char *buffer, AVD_Size bufferSize)
+{
+    AVD_Size length = 0;
+    AVD_Size offset = 0;
+    const char *c   = record->format;
+    while (*c != '\0' && length + 1 < bufferSize) {
+        if (*c != '%') {
+            buffer[length++] = *c++;
+            continue;
+        }
+        if (c[1] == '%') {
+            buffer[length++] = '%';
+            c += 2;
+            continue;
+        }
+
+        // the producer already parsed the same format successfully
+        AVD_LogSpec spec;
+        PRIV_avdLogParseSpec(c + 1, &spec);
+
+        // rebuild the conversion with the recorded width and precision in place of the *
+        char specText[AVD_LOG_MAX_SPEC_LENGTH * 2];
+        AVD_Size specLength    = 0;
+        specText[specLength++] = '%';
+        for (AVD_Size i = 1; i <= spec.length; i++) {
+            if (c[i] == '*') {
+                int value = 0;
+                PRIV_avdLogPopArg(record, &offset, &value, sizeof(value));
+                specLength += (AVD_Size)snprintf(specText + specLength, sizeof(specText) - specLength, "%d", value);
+            } else {
+                specText[specLength++] = c[i];
+            }
+        }
+        specText[specLength] = '\0';
+        c += spec.length + 1;
+
+        char *out        = buffer + length;
+        AVD_Size outSize = bufferSize - length;
+        int written      = 0;
+        switch (spec.type) {
+            case AVD_LOG_ARG_INT:
+                PRIV_AVD_LOG_FORMAT_ARG(record, &offset, int, specText, out, outSize, written);
+                break;
+            case AVD_LOG_ARG_LONG:
+                PRIV_AVD_LOG_FORMAT_ARG(record, &offset, long, specText, out, outSize, written);
+                break;
+            case AVD_LOG_ARG_LONG_LONG:
+                PRIV_AVD_LOG_FORMAT_ARG(record, &offset, long long, specText, out, outSize, written);
+                break;
+            case AVD_LOG_ARG_SIZE:
+                PRIV_AVD_LOG_FORMAT_ARG(record, &offset, size_t, specText, out, outSize, written);
+                break;
+            case AVD_LOG_ARG_INTMAX:
+                PRIV_AVD_LOG_FORMAT_ARG(record, &offset, intmax_t, specText, out, outSize, written);
+                break;
+            case AVD_LOG_ARG_PTRDIFF:
+                PRIV_AVD_LOG_FORMAT_ARG(record, &offset, ptrdiff_t, specText, out, outSize, written);
+                break;
+            case AVD_LOG_ARG_DOUBLE:
+                PRIV_AVD_LOG_FORMAT_ARG(record, &offset, double, specText, out, outSize, written);
+                break;
+            case AVD_LOG_ARG_LONG_DOUBLE:
+                PRIV_AVD_LOG_FORMAT_ARG(record, &offset, long double, specText, out, outSize, written);
+                break;
+            case AVD_LOG_ARG_POINTER:
+                PRIV_AVD_LOG_FORMAT_ARG(record, &offset, void *, specText, out, outSize, written);
+                break;
+            case AVD_LOG_ARG_STRING: {
+                const char *value = (const char *)record->args + offset;
+                offset += strlen(value) + 1;
+                written = snprintf(out, outSize, specText, value);
+                break;
+            }
+        }
+        if (written > 0) {
+            length += AVD_MIN((AVD_Size)written, outSize - 1);
+        }
+    }
+    buffer[length] = '\0';
+}
+
+static AVD_LogThread *PRIV_avdLogFirstThread(void)
+{
+    return (AVD_LogThread *)avdAtomicLoadPtr(&PRIV_avdLogger.threads);
+}
+
+static AVD_LogThread *PRIV_avdLogGetThread(void)
+{
+    AVD_LogThread *thread = PRIV_avdLogCurrentThread;
+    if (thread != NULL) {
+        return thread;
+    }
+
+    // the ring of an exited thread keeps its indices, whatever is still queued
+    // in it gets written before the new owner's messages
+    for (AVD_LogThread *candidate = PRIV_avdLogFirstThread(); candidate != NULL; candidate = candidate->next) {
+        AVD_Int64 expected = 1;
+        if (avdAtomicCompareExchange64(&candidate->retired, &expected, 0)) {
+            thread = candidate;
+            break;
+        }
+    }
+
+    if (thread == NULL) {
+        // not AVD_MALLOC, the memory tracker logs while it holds its lock
+        thread = (AVD_LogThread *)malloc(sizeof(AVD_LogThread));
+        if (thread == NULL) {
+            return NULL;
+        }
+        memset(thread, 0, sizeof(AVD_LogThread));
+
+        void *head = avdAtomicLoadPtr(&PRIV_avdLogger.threads);
+        do {
+            thread->next = (AVD_LogThread *)head;
+        } while (!avdAtomicCompareExchangePtr(&PRIV_avdLogger.threads, &head, thread));
+    }
+
+    PRIV_avdLogCurrentThread = thread;
+    return thread;
+}
+
+static void PRIV_avdLogWake(AVD_Int64 ticket)
+{
+    picoThreadChannelSend(PRIV_avdLogger.wakeChannel, &ticket);
+}
+
+static bool PRIV_avdLogIsAsync(void)
+{
+    return avdAtomicLoad64(&PRIV_avdLogger.running) && !avdAtomicLoad64(&PRIV_avdLogger.synchronous) && !PRIV_avdLogIsLoggerThread;
+}
+
+// Returns false when the message has to be written synchronously instead.
+static bool PRIV_avdLogEnqueue(AVD_LogLevel level, AVD_LogModule module, const char *format, va_list args)
+{
+    AVD_LogThread *thread = PRIV_avdLogGetThread();
+    if (thread == NULL) {
+        return false;
+    }
+
+    AVD_Int64 writeIndex = avdAtomicLoad64(&thread->writeIndex);
+    if (writeIndex - avdAtomicLoad64(&thread->readIndex) >= AVD_LOG_RECORDS_PER_THREAD) {
+        avdAtomicAdd64(&thread->dropped, 1);
+        return true;
+    }
+
+    AVD_LogRecord *record = &thread->records[writeIndex % AVD_LOG_RECORDS_PER_THREAD];
+    record->format        = format;
+    record->timeUs        = picoPerfDurationMilliseconds(PRIV_avdLogger.epoch, picoPerfNow()) * 1000.0;
+    record->level         = (AVD_UInt8)level;
+    record->module        = (AVD_UInt8)module;
+
+    va_list encodeArgs;
+    va_copy(encodeArgs, args);
+    bool encoded = PRIV_avdLogEncodeArgs(record, format, encodeArgs);
+    va_end(encodeArgs);
+    if (!encoded) {
+        return false;
+    }
+
+    // publishing after the record is written keeps the logger from reading a half written one
+    avdAtomicStore64(&thread->writeIndex, writeIndex + 1);
+    return true;
+}
+
+static void PRIV_avdLogWriteNow(AVD_LogLevel level, AVD_LogModule module, const char *format, va_list args)
+{
+    char buffer[AVD_LOG_MAX_MESSAGE_SIZE];
+    char *message = buffer;
+
+    va_list formatArgs;
+    va_copy(formatArgs, args);
+    int length = vsnprintf(buffer, sizeof(buffer), format, formatArgs);
+    va_end(formatArgs);
+
+    // shader compiler output and the like can be a lot longer than a usual message
+    if (length >= (int)sizeof(buffer)) {
+        char *longMessage = (char *)malloc((AVD_Size)length + 1);
+        if (longMessage != NULL) {
+            vsnprintf(longMessage, (AVD_Size)length + 1, format, args);
+            message = longMessage;
+        }
+    }
+
+    PRIV_avdLogLockSink();
+    PRIV_avdLogEmit(level, module, message);
+    PRIV_avdLogUnlockSink();
+
+    if (message != buffer) {
+        free(message);
+    }
+}
+
+static int PRIV_avdLogCompareRefs(const void *a, const void *b)
+{
+    const AVD_LogRecordRef *refA = (const AVD_LogRecordRef *)a;
+    const AVD_LogRecordRef *refB = (const AVD_LogRecordRef *)b;
+    AVD_Double timeA             = refA->thread->records[refA->index % AVD_LOG_RECORDS_PER_THREAD].timeUs;
+    AVD_Double timeB             = refB->thread->records[refB->index % AVD_LOG_RECORDS_PER_THREAD].timeUs;
+    if (timeA != timeB) {
+        return timeA < timeB ? -1 : 1;
+    }
+    if (refA->thread != refB->thread) {
+        return (uintptr_t)refA->thread < (uintptr_t)refB->thread ? -1 : 1;
+    }
+    return (refA->index > refB->index) - (refA->index < refB->index);
+}
+
+static AVD_Int64 PRIV_avdLogTotalDropped(void)
+{
+    AVD_Int64 dropped = 0;
+    for (AVD_LogThread *thread = PRIV_avdLogFirstThread(); thread != NULL; thread = thread->next) {
+        dropped += avdAtomicLoad64(&thread->dropped);
+    }
+    return dropped;
+}
+
+// Writes everything queued at the time of the call, merged across threads by
+// timestamp. Returns the number of records written.
+static AVD_Size PRIV_avdLogDrainOnce(void)
+{
+    AVD_Size refCount = 0;
+    for (AVD_LogThread *thread = PRIV_avdLogFirstThread(); thread != NULL && refCount < AVD_LOG_MAX_RECORDS_PER_PASS; thread = thread->next) {
+        AVD_Int64 readIndex  = avdAtomicLoad64(&thread->readIndex);
+        AVD_Int64 writeIndex = avdAtomicLoad64(&thread->writeIndex);
+        for (AVD_Int64 i = readIndex; i < writeIndex && refCount < AVD_LOG_MAX_RECORDS_PER_PASS; i++) {
+            PRIV_avdLogger.refs[refCount].thread  = thread;
+            PRIV_avdLogger.refs[refCount++].index = i;
+        }
+    }
+
+    AVD_Int64 dropped = PRIV_avdLogTotalDropped();
+    if (refCount == 0 && dropped == PRIV_avdLogger.reportedDrops) {
+        return 0;
+    }
+
+    qsort(PRIV_avdLogger.refs, refCount, sizeof(AVD_LogRecordRef), PRIV_avdLogCompareRefs);
+
+    char message[AVD_LOG_MAX_MESSAGE_SIZE];
+    PRIV_avdLogLockSink();
+    for (AVD_Size i = 0; i < refCount; i++) {
+        const AVD_LogRecord *record = &PRIV_avdLogger.refs[i].thread->records[PRIV_avdLogger.refs[i].index % AVD_LOG_RECORDS_PER_THREAD];
+        PRIV_avdLogFormatRecord(record, message, sizeof(message));
+        PRIV_avdLogEmit((AVD_LogLevel)record->level, (AVD_LogModule)record->module, message);
+    }
+    if (dropped != PRIV_avdLogger.reportedDrops) {
+        snprintf(message, sizeof(message), "Dropped %lld log messages, a thread filled its log buffer", (long long)(dropped - PRIV_avdLogger.reportedDrops));
+        PRIV_avdLogEmit(AVD_LOG_LEVEL_WARN, AVD_LOG_MODULE_CORE, message);
+        PRIV_avdLogger.reportedDrops = dropped;
+    }
+    PRIV_avdLogUnlockSink();
+
+    // the slots only go back to their producers once they have been written
+    for (AVD_Size i = 0; i < refCount; i++) {
+        avdAtomicStore64(&PRIV_avdLogger.refs[i].thread->readIndex, PRIV_avdLogger.refs[i].index + 1);
+    }
+    return refCount;
+}
+
+static void PRIV_avdLogDrain(void)
+{
+    while (PRIV_avdLogDrainOnce() > 0) {
+    }
+}
+
+static void PRIV_avdLogThreadMain(void *userData)
+{
+    (void)userData;
+    PRIV_avdLogIsLoggerThread = true;
+
+    while (true) {
+        AVD_Int64 ticket = 0;
+        picoThreadChannelReceive(PRIV_avdLogger.wakeChannel, &ticket, AVD_LOG_FLUSH_INTERVAL_MS);
+        bool stopping = avdAtomicLoad64(&PRIV_avdLogger.stopping) != 0;
+
+        PRIV_avdLogDrain();
+
+        if (ticket > 0) {
+            // tickets can arrive out of order, but every record queued before
+            // the larger one was drained as well
+            AVD_Int64 flushed = avdAtomicLoad64(&PRIV_avdLogger.flushedTicket);
+            if (ticket > flushed) {
+                avdAtomicStore64(&PRIV_avdLogger.flushedTicket, ticket);
+            }
+            picoThreadChannelSend(PRIV_avdLogger.flushChannel, &ticket);
+        }
+
+        if (stopping) {
+            break;
+        }
+    }
+
+    PRIV_avdLogIsLoggerThread = false;
+}
+
+// returning from main with an AVD_CHECK failure skips avdLogShutdown
+static void PRIV_avdLogAtExit(void)
+{
+    avdLogFlush();
+}
+
+bool avdLogInit(void)
+{
+    AVD_CHECK_MSG(!avdLogIsInitialized(), "Logger is already initialized");
+
+    const char *levels = getenv("AVD_LOG_LEVELS");
+    if (levels != NULL) {
+        avdLogSetLevelsFromString(levels);
+    }
+
+    PRIV_avdLogger.epoch         = picoPerfNow();
+    PRIV_avdLogger.reportedDrops = 0;
+    PRIV_avdLogger.refs          = (AVD_LogRecordRef *)malloc(sizeof(AVD_LogRecordRef) * AVD_LOG_MAX_RECORDS_PER_PASS);
+    AVD_CHECK_MSG(PRIV_avdLogger.refs != NULL, "Failed to allocate the log record list");
+    PRIV_avdLogger.wakeChannel  = picoThreadChannelCreateUnbounded(sizeof(AVD_Int64));
+    PRIV_avdLogger.flushChannel = picoThreadChannelCreateUnbounded(sizeof(AVD_Int64));
+    PRIV_avdLogger.sinkMutex    = picoThreadMutexCreate();
+    AVD_CHECK_MSG(PRIV_avdLogger.wakeChannel != NULL && PRIV_avdLogger.flushChannel != NULL && PRIV_avdLogger.sinkMutex != NULL, "Failed to create the logger channels");
+
+    if (!PRIV_avdLogAtExitAdded) {
+        atexit(PRIV_avdLogAtExit);
+        PRIV_avdLogAtExitAdded = true;
+    }
+
+    avdAtomicStore64(&PRIV_avdLogger.stopping, 0);
+    avdAtomicStore64(&PRIV_avdLogger.running, 1);
+    PRIV_avdLogger.thread = picoThreadCreate(PRIV_avdLogThreadMain, NULL);
+    if (PRIV_avdLogger.thread == NULL) {
+        avdAtomicStore64(&PRIV_avdLogger.running, 0);
+        AVD_LOG_ERROR("Failed to start the logger thread");
+        return false;
+    }
+    return true;
+}
+
+void avdLogShutdown(void)
+{
+    if (!avdLogIsInitialized()) {
+        return;
+    }
+
+    // from here on messages are written synchronously, the logger thread drains
+    // what was queued before it exits
+    avdAtomicStore64(&PRIV_avdLogger.running, 0);
+    avdAtomicStore64(&PRIV_avdLogger.stopping, 1);
+    PRIV_avdLogWake(0);
+    picoThreadDestroy(PRIV_avdLogger.thread);
+
+    AVD_LogThread *thread = PRIV_avdLogFirstThread();
+    while (thread != NULL) {
+        AVD_LogThread *next = thread->next;
+        free(thread);
+        thread = next;
+    }
+    avdAtomicStorePtr(&PRIV_avdLogger.threads, NULL);
+    PRIV_avdLogCurrentThread = NULL;
+
+    picoThreadChannelDestroy(PRIV_avdLogger.wakeChannel);
+    picoThreadChannelDestroy(PRIV_avdLogger.flushChannel);
+    picoThreadMutexDestroy(PRIV_avdLogger.sinkMutex);
+    free(PRIV_avdLogger.refs);
+
+    PRIV_avdLogger.thread       = NULL;
+    PRIV_avdLogger.refs         = NULL;
+    PRIV_avdLogger.wakeChannel  = NULL;
+    PRIV_avdLogger.flushChannel = NULL;
+    PRIV_avdLogger.sinkMutex    = NULL;
+}
+
+bool avdLogIsInitialized(void)
+{
+    return avdAtomicLoad64(&PRIV_avdLogger.running) != 0;
+}
+
+void avdLogFlush(void)
+{
+    if (!avdLogIsInitialized() || PRIV_avdLogIsLoggerThread) {
+        return;
+    }
+
+    AVD_Int64 ticket = avdAtomicAdd64(&PRIV_avdLogger.nextFlushTicket, 1);
+    PRIV_avdLogWake(ticket);
+    while (avdAtomicLoad64(&PRIV_avdLogger.flushedTicket) < ticket) {
+        AVD_Int64 flushed = 0;
+        picoThreadChannelReceive(PRIV_avdLogger.flushChannel, &flushed, AVD_LOG_FLUSH_INTERVAL_MS);
+    }
+}
+
+void avdLogThreadShutdown(void)
+{
+    AVD_LogThread *thread = PRIV_avdLogCurrentThread;
+    if (thread == NULL) {
+        return;
+    }
+
+    PRIV_avdLogCurrentThread = NULL;
+    if (avdLogIsInitialized()) {
+        avdAtomicStore64(&thread->retired, 1);
+    }
+}
+
+void avdLogSetLevel(AVD_LogLevel level)
+{
+    for (AVD_Size i = 0; i < AVD_LOG_MODULE_COUNT; i++) {
+        avdLogSetModuleLevel((AVD_LogModule)i, level);
+    }
+}
+
+void avdLogSetModuleLevel(AVD_LogModule module, AVD_LogLevel level)
+{
+    AVD_ASSERT(module < AVD_LOG_MODULE_COUNT && level <= AVD_LOG_LEVEL_NONE);
+    avdAtomicStore64(&PRIV_avdLogModuleLevels[module], (AVD_Int64)level);
+}
+
+AVD_LogLevel avdLogGetModuleLevel(AVD_LogModule module)
+{
+    AVD_ASSERT(module < AVD_LOG_MODULE_COUNT);
+    return (AVD_LogLevel)avdAtomicLoad64(&PRIV_avdLogModuleLevels[module]);
+}
+
+static bool PRIV_avdLogFindName(const char **names, AVD_Size count, const char *name, AVD_Size nameLength, AVD_Size *outIndex)
+{
+    for (AVD_Size i = 0; i < count; i++) {
+        if (strlen(names[i]) == nameLength && strncmp(names[i], name, nameLength) == 0) {
+            *outIndex = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool avdLogSetLevelsFromString(const char *levels)
+{
+    AVD_ASSERT(levels != NULL);
+
+    bool ok = true;
+    for (const char *entry = levels; *entry != '\0';) {
+        AVD_Size entryLength = strcspn(entry, ",");
+        const char *equals   = (const char *)memchr(entry, '=', entryLength);
+
+        AVD_Size level  = 0;
+        AVD_Size module = AVD_LOG_MODULE_COUNT;
+        if (equals != NULL) {
+            AVD_Size moduleLength = (AVD_Size)(equals - entry);
+            if (!PRIV_avdLogFindName(PRIV_avdLogModuleNames, AVD_LOG_MODULE_COUNT, entry, moduleLength, &module) ||
+                !PRIV_avdLogFindName(PRIV_avdLogLevelNames, AVD_ARRAY_COUNT(PRIV_avdLogLevelNames), equals + 1, entryLength - moduleLength - 1, &level)) {
+                AVD_LOG_ERROR("Unknown log level setting \"%.*s\"", (int)entryLength, entry);
+                ok = false;
+            } else {
+                avdLogSetModuleLevel((AVD_LogModule)module, (AVD_LogLevel)level);
+            }
+        } else if (entryLength > 0) {
+            if (!PRIV_avdLogFindName(PRIV_avdLogLevelNames, AVD_ARRAY_COUNT(PRIV_avdLogLevelNames), entry, entryLength, &level)) {
+                AVD_LOG_ERROR("Unknown log level \"%.*s\"", (int)entryLength, entry);
+                ok = false;
+            } else {
+                avdLogSetLevel((AVD_LogLevel)level);
+            }
+        }
+
+        entry += entryLength;
+        if (*entry == ',') {
+            entry++;
+        }
+    }
+    return ok;
+}
+
+void avdLogSetSynchronous(bool synchronous)
+{
+    if (synchronous) {
+        avdLogFlush();
+    }
+    avdAtomicStore64(&PRIV_avdLogger.synchronous, synchronous ? 1 : 0);
+}
+
+void avdLogSetSink(AVD_LogSinkFn *sink, void *userData)
+{
+    PRIV_avdLogLockSink();
+    PRIV_avdLogger.sink         = sink;
+    PRIV_avdLogger.sinkUserData = userData;
+    PRIV_avdLogUnlockSink();
+}
+
+AVD_UInt64 avdLogDroppedCount(void)
+{
+    return (AVD_UInt64)PRIV_avdLogTotalDropped();
+}
+
+const char *avdLogLevelName(AVD_LogLevel level)
+{
+    return level <= AVD_LOG_LEVEL_NONE ? PRIV_avdLogLevelNames[level] : "unknown";
+}
+
+const char *avdLogModuleName(AVD_LogModule module)
+{
+    return module < AVD_LOG_MODULE_COUNT ? PRIV_avdLogModuleNames[module] : "unknown";
+}
+
+AVD_LogModule avdLogModuleFromFile(const char *file)
+{
+    if (file == NULL) {
+        return AVD_LOG_MODULE_GENERAL;
+    }
+
+    // the innermost directory naming a module wins, so scenes/hls_player is hls
+    // while scenes/bloom is scenes, nothing above src or include is looked at
+    const char *end = file + strlen(file);
+    while (end > file && !PRIV_avdLogIsSeparator(end[-1])) {
+        end--;
+    }
+    while (end > file) {
+        const char *dirEnd   = end - 1;
+        const char *dirStart = dirEnd;
+        while (dirStart > file && !PRIV_avdLogIsSeparator(dirStart[-1])) {
+            dirStart--;
+        }
+
+        AVD_Size dirLength = (AVD_Size)(dirEnd - dirStart);
+        if ((dirLength == 3 && strncmp(dirStart, "src", 3) == 0) || (dirLength == 7 && strncmp(dirStart, "include", 7) == 0)) {
+            break;
+        }
+        for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(PRIV_avdLogModuleDirectories); i++) {
+            const char *directory = PRIV_avdLogModuleDirectories[i].directory;
+            if (strlen(directory) == dirLength && strncmp(dirStart, directory, dirLength) == 0) {
+                return PRIV_avdLogModuleDirectories[i].module;
+            }
+        }
+        end = dirStart;
+    }
+    return AVD_LOG_MODULE_GENERAL;
+}
+
+bool avdLogIsEnabled(AVD_LogLevel level, const char *file)
+{
+    return (AVD_Int64)level >= avdAtomicLoad64(&PRIV_avdLogModuleLevels[PRIV_avdLogModuleOf(file)]);
+}
+
+void avdLogWrite(AVD_LogLevel level, const char *file, const char *format, ...)
+{
+    AVD_LogModule module = PRIV_avdLogModuleOf(file);
+
+    va_list args;
+    va_start(args, format);
+
+    // errors are often the last thing printed before the process goes down, so
+    // they are written right away, as are messages that do not fit a record,
+    // both only once everything queued before them is out
+    bool async = PRIV_avdLogIsAsync();
+    if (!async || level >= AVD_LOG_LEVEL_ERROR || !PRIV_avdLogEnqueue(level, module, format, args)) {
+        if (async) {
+            avdLogFlush();
+        }
+        PRIV_avdLogWriteNow(level, module, format, args);
+    }
+
+    va_end(args);
+}
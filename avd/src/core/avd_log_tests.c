@@ -0,0 +1,385 @@
+#include "core/avd_atomic.h"
+#include "core/avd_core.h"
+#include "pico/picoThreads.h"
+#include <string.h>
+
+#define AVD_LOG_TEST_PREFIX              "logtest: "
+#define AVD_LOG_TEST_MAX_MESSAGES        4096
+#define AVD_LOG_TEST_MESSAGE_SIZE        160
+#define AVD_LOG_TEST_THREADS             4
+#define AVD_LOG_TEST_MESSAGES_PER_THREAD 200
+#define AVD_LOG_BENCH_MESSAGES           512
+
+// Only messages starting with AVD_LOG_TEST_PREFIX are kept, everything else
+// (like the progress output of the tests themselves) is passed on.
+typedef struct {
+    AVD_Size count;
+    char messages[AVD_LOG_TEST_MAX_MESSAGES][AVD_LOG_TEST_MESSAGE_SIZE];
+    AVD_Size lengths[AVD_LOG_TEST_MAX_MESSAGES];
+    AVD_Size dropReports;
+
+    // the sink spins while blocked is set, entered tells the test it got there
+    volatile AVD_Int64 blocked;
+    volatile AVD_Int64 entered;
+} AVD_LogTestCapture;
+
+static AVD_LogTestCapture PRIV_avdTestLogCapture;
+
+static void PRIV_avdTestLogSink(AVD_LogLevel level, AVD_LogModule module, const char *message, void *userData)
+{
+    AVD_LogTestCapture *capture = (AVD_LogTestCapture *)userData;
+
+    if (avdAtomicLoad64(&capture->blocked)) {
+        avdAtomicStore64(&capture->entered, 1);
+        while (avdAtomicLoad64(&capture->blocked)) {
+            AVD_CPU_PAUSE();
+        }
+    }
+
+    if (strncmp(message, "Dropped ", 8) == 0) {
+        capture->dropReports++;
+    }
+    if (strncmp(message, AVD_LOG_TEST_PREFIX, strlen(AVD_LOG_TEST_PREFIX)) != 0) {
+        avdLogDefaultSink(level, module, message, NULL);
+        return;
+    }
+    if (capture->count == AVD_LOG_TEST_MAX_MESSAGES) {
+        return;
+    }
+    snprintf(capture->messages[capture->count], AVD_LOG_TEST_MESSAGE_SIZE, "%s", message);
+    capture->lengths[capture->count] = strlen(message);
+    capture->count++;
+}
+
+static void PRIV_avdTestLogReset(void)
+{
+    avdLogFlush();
+    PRIV_avdTestLogCapture.count       = 0;
+    PRIV_avdTestLogCapture.dropReports = 0;
+}
+
+// Logs the message and formats the same arguments with snprintf for comparison.
+#define PRIV_AVD_TEST_LOG_EXPECT(expected, expectedCount, format, ...)                                           \
+    {                                                                                                            \
+        snprintf(expected[expectedCount++], AVD_LOG_TEST_MESSAGE_SIZE, AVD_LOG_TEST_PREFIX format, __VA_ARGS__); \
+        AVD_LOG_INFO(AVD_LOG_TEST_PREFIX format, __VA_ARGS__);                                                   \
+    }
+
+static bool PRIV_avdTestLogFormatting()
+{
+    AVD_LOG_DEBUG("  Testing Log deferred formatting...");
+    PRIV_avdTestLogReset();
+
+    static char expected[16][AVD_LOG_TEST_MESSAGE_SIZE];
+    AVD_Size expectedCount = 0;
+
+    // the logger has to reproduce the output from the raw arguments alone
+    char unterminated[4] = {'a', 'b', 'c', 'd'};
+    char onStack[32];
+    snprintf(onStack, sizeof(onStack), "stack %d", 17);
+
+    PRIV_AVD_TEST_LOG_EXPECT(expected, expectedCount, "ints %d %i %u %x %X %o [%5d] [%-5d] [%05d] %hhd %hu", -42, 7, 42u, 255u, 255u, 8u, 3, 3, 3, (signed char)-1, (unsigned short)65535);
+    PRIV_AVD_TEST_LOG_EXPECT(expected, expectedCount, "wide %ld %lld %llu %zu %td %jd", -1L, -2LL, 3ULL, (size_t)4, (ptrdiff_t)-5, (intmax_t)6);
+    PRIV_AVD_TEST_LOG_EXPECT(expected, expectedCount, "floats %f %.3f %8.2e %g %lf %Lf", 1.5, 3.14159, 12345.678, 0.0001, 2.25, (long double)1.25);
+    PRIV_AVD_TEST_LOG_EXPECT(expected, expectedCount, "strings [%s] [%10s] [%-6s] [%.3s] [%.*s] [%*s]", "abc", "right", "left", "truncate", 4, "precision", 6, "star");
+    PRIV_AVD_TEST_LOG_EXPECT(expected, expectedCount, "copied [%.*s] [%s]", 4, unterminated, onStack);
+    PRIV_AVD_TEST_LOG_EXPECT(expected, expectedCount, "misc %c %p 100%% [%*.*f]", 'x', (void *)&expected, 8, 2, 3.14159);
+    PRIV_AVD_TEST_LOG_EXPECT(expected, expectedCount, "%s", "only a string");
+    // overwriting the buffer must not change what gets logged
+    snprintf(onStack, sizeof(onStack), "overwritten");
+
+    avdLogFlush();
+
+    if (PRIV_avdTestLogCapture.count != expectedCount) {
+        AVD_LOG_ERROR("    FAILED: Expected %zu messages, got %zu", expectedCount, PRIV_avdTestLogCapture.count);
+        return false;
+    }
+    for (AVD_Size i = 0; i < expectedCount; i++) {
+        if (strcmp(PRIV_avdTestLogCapture.messages[i], expected[i]) != 0) {
+            AVD_LOG_ERROR("    FAILED: Got \"%s\", expected \"%s\"", PRIV_avdTestLogCapture.messages[i], expected[i]);
+            return false;
+        }
+    }
+
+    AVD_LOG_DEBUG("    Log deferred formatting PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestLogFiltering()
+{
+    AVD_LOG_DEBUG("  Testing Log level filtering...");
+    PRIV_avdTestLogReset();
+
+    // this file lives in core
+    AVD_CHECK(avdLogModuleFromFile(__FILE__) == AVD_LOG_MODULE_CORE);
+    AVD_CHECK(avdLogModuleFromFile("C:\\avd\\src\\scenes\\hls_player\\avd_scenes_hls_player.c") == AVD_LOG_MODULE_HLS);
+    AVD_CHECK(avdLogModuleFromFile("/home/avd/src/vulkan/video/avd_vulkan_video_decoder.c") == AVD_LOG_MODULE_VIDEO);
+    AVD_CHECK(avdLogModuleFromFile("/home/avd/src/scenes/bloom/avd_scenes_bloom.c") == AVD_LOG_MODULE_SCENES);
+    AVD_CHECK(avdLogModuleFromFile("/home/core/avd/src/avd_main.c") == AVD_LOG_MODULE_GENERAL);
+    AVD_CHECK(avdLogModuleFromFile("avd_main.c") == AVD_LOG_MODULE_GENERAL);
+
+    int evaluated = 0;
+    avdLogSetModuleLevel(AVD_LOG_MODULE_CORE, AVD_LOG_LEVEL_WARN);
+    AVD_LOG_INFO(AVD_LOG_TEST_PREFIX "filtered %d", ++evaluated);
+    AVD_LOG_WARN(AVD_LOG_TEST_PREFIX "kept");
+    avdLogSetModuleLevel(AVD_LOG_MODULE_CORE, AVD_LOG_LEVEL_VERBOSE);
+    avdLogFlush();
+
+    if (evaluated != 0 || PRIV_avdTestLogCapture.count != 1 || strcmp(PRIV_avdTestLogCapture.messages[0], AVD_LOG_TEST_PREFIX "kept") != 0) {
+        AVD_LOG_ERROR("    FAILED: Level filter let %zu messages through (arguments evaluated %d times)", PRIV_avdTestLogCapture.count, evaluated);
+        return false;
+    }
+
+    AVD_CHECK(avdLogSetLevelsFromString("error,hls=debug"));
+    AVD_CHECK(avdLogGetModuleLevel(AVD_LOG_MODULE_GENERAL) == AVD_LOG_LEVEL_ERROR);
+    AVD_CHECK(avdLogGetModuleLevel(AVD_LOG_MODULE_HLS) == AVD_LOG_LEVEL_DEBUG);
+    AVD_CHECK(avdLogSetLevelsFromString("verbose"));
+    AVD_CHECK(avdLogGetModuleLevel(AVD_LOG_MODULE_HLS) == AVD_LOG_LEVEL_VERBOSE);
+
+    AVD_LOG_DEBUG("    Expecting two errors about unknown log levels:");
+    AVD_CHECK(!avdLogSetLevelsFromString("loud"));
+    AVD_CHECK(!avdLogSetLevelsFromString("audio=verbose,nothing=info"));
+    AVD_CHECK(avdLogGetModuleLevel(AVD_LOG_MODULE_AUDIO) == AVD_LOG_LEVEL_VERBOSE);
+
+    AVD_LOG_DEBUG("    Log level filtering PASSED");
+    return true;
+}
+
+static void PRIV_avdTestLogThread(void *userData)
+{
+    AVD_UInt32 index = (AVD_UInt32)(uintptr_t)userData;
+    for (AVD_UInt32 i = 0; i < AVD_LOG_TEST_MESSAGES_PER_THREAD; i++) {
+        AVD_LOG_INFO(AVD_LOG_TEST_PREFIX "thread %u message %u", index, i);
+    }
+    avdLogThreadShutdown();
+}
+
+static bool PRIV_avdTestLogThreads()
+{
+    AVD_LOG_DEBUG("  Testing Log per-thread buffers...");
+
+    // the second round reuses the buffers the first round handed back
+    for (int round = 0; round < 2; round++) {
+        PRIV_avdTestLogReset();
+
+        picoThread threads[AVD_LOG_TEST_THREADS];
+        for (AVD_UInt32 i = 0; i < AVD_LOG_TEST_THREADS; i++) {
+            threads[i] = picoThreadCreate(PRIV_avdTestLogThread, (void *)(uintptr_t)i);
+        }
+        for (AVD_UInt32 i = 0; i < AVD_LOG_TEST_THREADS; i++) {
+            picoThreadDestroy(threads[i]);
+        }
+        avdLogFlush();
+
+        if (PRIV_avdTestLogCapture.count != AVD_LOG_TEST_THREADS * AVD_LOG_TEST_MESSAGES_PER_THREAD) {
+            AVD_LOG_ERROR("    FAILED: Round %d got %zu messages", round, PRIV_avdTestLogCapture.count);
+            return false;
+        }
+
+        // every thread's messages have to come out in the order they were logged
+        AVD_Int32 next[AVD_LOG_TEST_THREADS] = {0};
+        for (AVD_Size i = 0; i < PRIV_avdTestLogCapture.count; i++) {
+            unsigned int thread = 0, message = 0;
+            if (sscanf(PRIV_avdTestLogCapture.messages[i], AVD_LOG_TEST_PREFIX "thread %u message %u", &thread, &message) != 2 || thread >= AVD_LOG_TEST_THREADS || (AVD_Int32)message != next[thread]) {
+                AVD_LOG_ERROR("    FAILED: Unexpected message \"%s\"", PRIV_avdTestLogCapture.messages[i]);
+                return false;
+            }
+            next[thread]++;
+        }
+    }
+
+    AVD_LOG_DEBUG("    Log per-thread buffers PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestLogOverflow()
+{
+    AVD_LOG_DEBUG("  Testing Log ring buffer overflow...");
+    PRIV_avdTestLogReset();
+
+    // park the logger thread inside the sink so nothing gets drained
+    AVD_UInt64 droppedBefore = avdLogDroppedCount();
+    avdAtomicStore64(&PRIV_avdTestLogCapture.entered, 0);
+    avdAtomicStore64(&PRIV_avdTestLogCapture.blocked, 1);
+    AVD_LOG_INFO(AVD_LOG_TEST_PREFIX "blocker");
+    picoPerfTime start = picoPerfNow();
+    while (!avdAtomicLoad64(&PRIV_avdTestLogCapture.entered) && picoPerfDurationMilliseconds(start, picoPerfNow()) < 5000.0) {
+        AVD_CPU_PAUSE();
+    }
+    bool entered = avdAtomicLoad64(&PRIV_avdTestLogCapture.entered) != 0;
+
+    AVD_Size total = AVD_LOG_RECORDS_PER_THREAD + 100;
+    for (AVD_Size i = 0; i < total; i++) {
+        AVD_LOG_INFO(AVD_LOG_TEST_PREFIX "overflow %zu", i);
+    }
+    AVD_UInt64 dropped = avdLogDroppedCount() - droppedBefore;
+
+    avdAtomicStore64(&PRIV_avdTestLogCapture.blocked, 0);
+    avdLogFlush();
+
+    AVD_CHECK_MSG(entered, "The logger thread never reached the sink");
+    // the blocker itself still occupies a slot while the sink runs
+    if (dropped < 100 || PRIV_avdTestLogCapture.count + dropped != total + 1 || PRIV_avdTestLogCapture.dropReports == 0) {
+        AVD_LOG_ERROR("    FAILED: %zu messages written, %llu dropped, %zu drop reports", PRIV_avdTestLogCapture.count, (unsigned long long)dropped, PRIV_avdTestLogCapture.dropReports);
+        return false;
+    }
+
+    AVD_LOG_DEBUG("    Log ring buffer overflow PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestLogSynchronousPaths()
+{
+    AVD_LOG_DEBUG("  Testing Log synchronous paths...");
+    PRIV_avdTestLogReset();
+
+    // too big for a record, written on this thread after what was queued before
+    char longString[600];
+    memset(longString, 'x', sizeof(longString) - 1);
+    longString[sizeof(longString) - 1] = '\0';
+    AVD_LOG_INFO(AVD_LOG_TEST_PREFIX "before");
+    AVD_LOG_INFO(AVD_LOG_TEST_PREFIX "long %s", longString);
+    if (PRIV_avdTestLogCapture.count != 2 || strcmp(PRIV_avdTestLogCapture.messages[0], AVD_LOG_TEST_PREFIX "before") != 0 ||
+        PRIV_avdTestLogCapture.lengths[1] != strlen(AVD_LOG_TEST_PREFIX "long ") + strlen(longString)) {
+        AVD_LOG_ERROR("    FAILED: Long message was not written in order and in full");
+        return false;
+    }
+
+    // errors must be out before the call returns
+    AVD_LOG_ERROR(AVD_LOG_TEST_PREFIX "expected error");
+    AVD_CHECK_MSG(PRIV_avdTestLogCapture.count == 3, "Error was queued instead of written");
+
+    avdLogSetSynchronous(true);
+    AVD_LOG_INFO(AVD_LOG_TEST_PREFIX "synchronous %d", 1);
+    avdLogSetSynchronous(false);
+    AVD_CHECK_MSG(PRIV_avdTestLogCapture.count == 4, "Synchronous mode queued the message");
+
+    AVD_LOG_DEBUG("    Log synchronous paths PASSED");
+    return true;
+}
+
+bool avdLogTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Log Tests...");
+
+    bool ownsLogger = !avdLogIsInitialized();
+    if (ownsLogger) {
+        AVD_CHECK(avdLogInit());
+    }
+
+    AVD_LogLevel levels[AVD_LOG_MODULE_COUNT];
+    for (AVD_Size i = 0; i < AVD_LOG_MODULE_COUNT; i++) {
+        levels[i] = avdLogGetModuleLevel((AVD_LogModule)i);
+    }
+    avdLogSetLevel(AVD_LOG_LEVEL_VERBOSE);
+    avdLogFlush();
+    avdLogSetSink(PRIV_avdTestLogSink, &PRIV_avdTestLogCapture);
+
+    bool ok = PRIV_avdTestLogFormatting() &&
+              PRIV_avdTestLogFiltering() &&
+              PRIV_avdTestLogThreads() &&
+              PRIV_avdTestLogOverflow() &&
+              PRIV_avdTestLogSynchronousPaths();
+
+    avdLogFlush();
+    avdLogSetSink(NULL, NULL);
+    for (AVD_Size i = 0; i < AVD_LOG_MODULE_COUNT; i++) {
+        avdLogSetModuleLevel((AVD_LogModule)i, levels[i]);
+    }
+    if (ownsLogger) {
+        avdLogShutdown();
+    }
+    AVD_CHECK(ok);
+
+    AVD_LOG_DEBUG("All AVD Log Tests PASSED");
+    return true;
+}
+
+static void PRIV_avdLogBenchmarkNullSink(AVD_LogLevel level, AVD_LogModule module, const char *message, void *userData)
+{
+    (void)level;
+    (void)module;
+    (void)message;
+    (void)userData;
+}
+
+static bool PRIV_avdLogBenchmarkSetupAsync(void *userData)
+{
+    (void)userData;
+    avdLogSetSynchronous(false);
+    // start every repetition with an empty ring so nothing gets dropped
+    avdLogFlush();
+    return true;
+}
+
+static bool PRIV_avdLogBenchmarkSetupSynchronous(void *userData)
+{
+    (void)userData;
+    avdLogSetSynchronous(true);
+    return true;
+}
+
+static void PRIV_avdLogBenchmarkMessages(void *userData)
+{
+    (void)userData;
+    for (AVD_UInt32 i = 0; i < AVD_LOG_BENCH_MESSAGES; i++) {
+        AVD_LOG_INFO("Decoded frame %u of segment %s in %.3f ms", i, "segment_00042.ts", 1.25);
+    }
+}
+
+static void PRIV_avdLogBenchmarkFiltered(void *userData)
+{
+    (void)userData;
+    for (AVD_UInt32 i = 0; i < AVD_LOG_BENCH_MESSAGES; i++) {
+        AVD_LOG_VERBOSE("Decoded frame %u of segment %s in %.3f ms", i, "segment_00042.ts", 1.25);
+    }
+}
+
+bool avdLogBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD Log benchmarks...");
+
+    bool ownsLogger = !avdLogIsInitialized();
+    if (ownsLogger) {
+        AVD_CHECK(avdLogInit());
+    }
+
+    // the sink is left out, the interesting part is what the logging thread pays
+    AVD_LogLevel coreLevel = avdLogGetModuleLevel(AVD_LOG_MODULE_CORE);
+    avdLogFlush();
+    avdLogSetSink(PRIV_avdLogBenchmarkNullSink, NULL);
+    avdLogSetModuleLevel(AVD_LOG_MODULE_CORE, AVD_LOG_LEVEL_INFO);
+
+    AVD_BenchCase synchronousCase = {
+        .name               = "log/synchronous",
+        .unit               = "messages",
+        .itemsPerRepetition = AVD_LOG_BENCH_MESSAGES,
+        .setup              = PRIV_avdLogBenchmarkSetupSynchronous,
+        .run                = PRIV_avdLogBenchmarkMessages,
+    };
+    AVD_BenchCase asyncCase = {
+        .name               = "log/async",
+        .unit               = "messages",
+        .itemsPerRepetition = AVD_LOG_BENCH_MESSAGES,
+        .setup              = PRIV_avdLogBenchmarkSetupAsync,
+        .run                = PRIV_avdLogBenchmarkMessages,
+    };
+    AVD_BenchCase filteredCase = {
+        .name               = "log/filtered",
+        .unit               = "messages",
+        .itemsPerRepetition = AVD_LOG_BENCH_MESSAGES,
+        .run                = PRIV_avdLogBenchmarkFiltered,
+    };
+
+    bool ok = avdBenchRun(bench, &synchronousCase) && avdBenchRun(bench, &asyncCase) && avdBenchRun(bench, &filteredCase);
+
+    avdLogSetSynchronous(false);
+    avdLogFlush();
+    avdLogSetSink(NULL, NULL);
+    avdLogSetModuleLevel(AVD_LOG_MODULE_CORE, coreLevel);
+    if (ownsLogger) {
+        avdLogShutdown();
+    }
+    return ok;
+}
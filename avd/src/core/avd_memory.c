@@ -0,0 +1,398 @@
+#include "core/avd_memory.h"
+#include "core/avd_base.h"
+
+#include "pico/picoThreads.h"
+
+#define AVD_MEMORY_HEADER_MAGIC       0x4D454D41u
+#define AVD_MEMORY_FREED_MAGIC        0x45455246u
+#define AVD_MEMORY_MAX_REPORTED_LEAKS 64
+#define AVD_MEMORY_MAX_JSON_LEAKS     1024
+
+// Placed right in front of every tracked allocation, the magic is the last
+// member so that it sits directly before the user data.
+typedef struct AVD_MemoryHeader {
+    struct AVD_MemoryHeader *prev;
+    struct AVD_MemoryHeader *next;
+    void *base;
+    const char *file;
+    AVD_Size size;
+    AVD_Int32 line;
+    AVD_UInt16 tag;
+    AVD_UInt16 reserved;
+    AVD_UInt32 magic;
+} AVD_MemoryHeader;
+
+static picoThreadMutex PRIV_avdMemoryMutex  = NULL;
+static AVD_MemoryHeader *PRIV_avdMemoryLive = NULL;
+static AVD_MemoryStats PRIV_avdMemoryStats[AVD_MEMORY_TAG_COUNT + 1];
+static AVD_THREAD_LOCAL AVD_MemoryTag PRIV_avdMemoryThreadTag = AVD_MEMORY_TAG_GENERAL;
+
+static const char *PRIV_avdMemoryTagNames[AVD_MEMORY_TAG_COUNT] = {
+    "general",
+    "core",
+    "hls",
+    "video",
+    "model",
+    "font",
+    "audio",
+    "shader",
+};
+
+static const struct {
+    const char *directory;
+    AVD_MemoryTag tag;
+} PRIV_avdMemoryTagDirectories[] = {
+    {"core", AVD_MEMORY_TAG_CORE},
+    {"hls_player", AVD_MEMORY_TAG_HLS},
+    {"video", AVD_MEMORY_TAG_VIDEO},
+    {"model", AVD_MEMORY_TAG_MODEL},
+    {"font", AVD_MEMORY_TAG_FONT},
+    {"audio", AVD_MEMORY_TAG_AUDIO},
+    {"shader", AVD_MEMORY_TAG_SHADER},
+};
+
+static void PRIV_avdMemoryLock(void)
+{
+    // the first tracked allocation always happens on the main thread before any
+    // worker thread exists, so creating the mutex lazily here does not race
+    if (PRIV_avdMemoryMutex == NULL) {
+        PRIV_avdMemoryMutex = picoThreadMutexCreate();
+    }
+    picoThreadMutexLock(PRIV_avdMemoryMutex, PICO_THREAD_INFINITE);
+}
+
+static void PRIV_avdMemoryUnlock(void)
+{
+    picoThreadMutexUnlock(PRIV_avdMemoryMutex);
+}
+
+static bool PRIV_avdMemoryIsSeparator(char c)
+{
+    return c == '/' || c == '\\';
+}
+
+static AVD_MemoryTag PRIV_avdMemoryTagFromPath(const char *file)
+{
+    if (file == NULL) {
+        return AVD_MEMORY_TAG_GENERAL;
+    }
+
+    // the subsystem is the directory the source file lives in, __FILE__ uses
+    // either separator depending on the compiler
+    const char *nameStart = NULL;
+    const char *dirStart  = file;
+    for (const char *c = file; *c; c++) {
+        if (PRIV_avdMemoryIsSeparator(*c)) {
+            dirStart  = nameStart ? nameStart : file;
+            nameStart = c + 1;
+        }
+    }
+    if (nameStart == NULL) {
+        return AVD_MEMORY_TAG_GENERAL;
+    }
+
+    AVD_Size dirLength = (AVD_Size)(nameStart - 1 - dirStart);
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(PRIV_avdMemoryTagDirectories); i++) {
+        const char *directory = PRIV_avdMemoryTagDirectories[i].directory;
+        if (strlen(directory) == dirLength && strncmp(dirStart, directory, dirLength) == 0) {
+            return PRIV_avdMemoryTagDirectories[i].tag;
+        }
+    }
+    return AVD_MEMORY_TAG_GENERAL;
+}
+
+static AVD_MemoryTag PRIV_avdMemoryResolveTag(AVD_MemoryTag tag, const char *file)
+{
+    if (tag != AVD_MEMORY_TAG_AUTO) {
+        return tag;
+    }
+
+    AVD_MemoryTag fileTag = PRIV_avdMemoryTagFromPath(file);
+    if ((fileTag == AVD_MEMORY_TAG_CORE || fileTag == AVD_MEMORY_TAG_GENERAL) && PRIV_avdMemoryThreadTag != AVD_MEMORY_TAG_GENERAL) {
+        return PRIV_avdMemoryThreadTag;
+    }
+    return fileTag;
+}
+
+static AVD_Size PRIV_avdMemoryHistogramBucket(AVD_Size size)
+{
+    AVD_Size bucket = 0;
+    while (bucket < AVD_MEMORY_HISTOGRAM_BUCKET_COUNT - 1 && ((AVD_Size)1 << bucket) < size) {
+        bucket++;
+    }
+    return bucket;
+}
+
+static void PRIV_avdMemoryStatsAdd(AVD_MemoryStats *stats, AVD_Size size, AVD_Size bucket)
+{
+    stats->liveBytes += size;
+    stats->liveAllocations++;
+    stats->totalAllocations++;
+    stats->totalAllocatedBytes += size;
+    stats->histogram[bucket]++;
+    stats->peakBytes = AVD_MAX(stats->peakBytes, stats->liveBytes);
+}
+
+static void PRIV_avdMemoryStatsRemove(AVD_MemoryStats *stats, AVD_Size size)
+{
+    stats->liveBytes -= size;
+    stats->liveAllocations--;
+    stats->totalFrees++;
+}
+
+static AVD_MemoryHeader *PRIV_avdMemoryGetHeader(void *ptr, const char *file, int line)
+{
+    AVD_MemoryHeader *header = (AVD_MemoryHeader *)ptr - 1;
+    if (header->magic != AVD_MEMORY_HEADER_MAGIC) {
+        AVD_LOG_ERROR("Memory tracker: %s pointer %p passed at %s:%d",
+                      header->magic == AVD_MEMORY_FREED_MAGIC ? "already freed" : "untracked or corrupted",
+                      ptr,
+                      file,
+                      line);
+        return NULL;
+    }
+    return header;
+}
+
+void *avdMemoryTrackedAlloc(AVD_Size size, AVD_Size alignment, AVD_MemoryTag tag, const char *file, int line)
+{
+    alignment = AVD_MAX(alignment, (AVD_Size)AVD_MEMORY_DEFAULT_ALIGNMENT);
+    AVD_ASSERT((alignment & (alignment - 1)) == 0);
+
+    if (size > SIZE_MAX - sizeof(AVD_MemoryHeader) - alignment) {
+        return NULL;
+    }
+
+    AVD_UInt8 *base = (AVD_UInt8 *)malloc(size + sizeof(AVD_MemoryHeader) + alignment - 1);
+    if (base == NULL) {
+        return NULL;
+    }
+
+    uintptr_t user           = ((uintptr_t)(base + sizeof(AVD_MemoryHeader)) + alignment - 1) & ~((uintptr_t)alignment - 1);
+    AVD_MemoryHeader *header = (AVD_MemoryHeader *)user - 1;
+    header->base             = base;
+    header->file             = file;
+    header->line             = (AVD_Int32)line;
+    header->size             = size;
+    header->tag              = (AVD_UInt16)PRIV_avdMemoryResolveTag(tag, file);
+    header->reserved         = 0;
+    header->magic            = AVD_MEMORY_HEADER_MAGIC;
+    header->prev             = NULL;
+
+    AVD_Size bucket = PRIV_avdMemoryHistogramBucket(size);
+
+    PRIV_avdMemoryLock();
+    header->next = PRIV_avdMemoryLive;
+    if (PRIV_avdMemoryLive) {
+        PRIV_avdMemoryLive->prev = header;
+    }
+    PRIV_avdMemoryLive = header;
+    PRIV_avdMemoryStatsAdd(&PRIV_avdMemoryStats[header->tag], size, bucket);
+    PRIV_avdMemoryStatsAdd(&PRIV_avdMemoryStats[AVD_MEMORY_TAG_COUNT], size, bucket);
+    PRIV_avdMemoryUnlock();
+
+    return (void *)user;
+}
+
+void *avdMemoryTrackedCalloc(AVD_Size count, AVD_Size size, AVD_MemoryTag tag, const char *file, int line)
+{
+    if (size != 0 && count > SIZE_MAX / size) {
+        return NULL;
+    }
+
+    void *result = avdMemoryTrackedAlloc(count * size, AVD_MEMORY_DEFAULT_ALIGNMENT, tag, file, line);
+    if (result != NULL) {
+        memset(result, 0, count * size);
+    }
+    return result;
+}
+
+void *avdMemoryTrackedRealloc(void *ptr, AVD_Size size, AVD_MemoryTag tag, const char *file, int line)
+{
+    if (ptr == NULL) {
+        return avdMemoryTrackedAlloc(size, AVD_MEMORY_DEFAULT_ALIGNMENT, tag, file, line);
+    }
+
+    AVD_MemoryHeader *header = PRIV_avdMemoryGetHeader(ptr, file, line);
+    if (header == NULL) {
+        return NULL;
+    }
+
+    // the new block is charged like a fresh allocation, growing a core container
+    // on behalf of a subsystem moves the memory over to that subsystem
+    void *result = avdMemoryTrackedAlloc(size, AVD_MEMORY_DEFAULT_ALIGNMENT, tag, file, line);
+    if (result == NULL) {
+        return NULL;
+    }
+
+    memcpy(result, ptr, AVD_MIN(size, header->size));
+    avdMemoryTrackedFree(ptr, file, line);
+    return result;
+}
+
+void avdMemoryTrackedFree(void *ptr, const char *file, int line)
+{
+    if (ptr == NULL) {
+        return;
+    }
+
+    AVD_MemoryHeader *header = PRIV_avdMemoryGetHeader(ptr, file, line);
+    if (header == NULL) {
+        // freeing memory the tracker does not own would corrupt the heap, leak it instead
+        return;
+    }
+
+    PRIV_avdMemoryLock();
+    if (header->prev) {
+        header->prev->next = header->next;
+    } else {
+        PRIV_avdMemoryLive = header->next;
+    }
+    if (header->next) {
+        header->next->prev = header->prev;
+    }
+    PRIV_avdMemoryStatsRemove(&PRIV_avdMemoryStats[header->tag], header->size);
+    PRIV_avdMemoryStatsRemove(&PRIV_avdMemoryStats[AVD_MEMORY_TAG_COUNT], header->size);
+    header->magic = AVD_MEMORY_FREED_MAGIC;
+    PRIV_avdMemoryUnlock();
+
+    free(header->base);
+}
+
+bool avdMemoryTrackingEnabled(void)
+{
+#ifdef AVD_MEMORY_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char *avdMemoryTagName(AVD_MemoryTag tag)
+{
+    if (tag >= AVD_MEMORY_TAG_COUNT) {
+        return "total";
+    }
+    return PRIV_avdMemoryTagNames[tag];
+}
+
+AVD_MemoryTag avdMemorySetThreadTag(AVD_MemoryTag tag)
+{
+    AVD_ASSERT(tag < AVD_MEMORY_TAG_COUNT);
+
+    AVD_MemoryTag previous  = PRIV_avdMemoryThreadTag;
+    PRIV_avdMemoryThreadTag = tag;
+    return previous;
+}
+
+bool avdMemoryGetStats(AVD_MemoryTag tag, AVD_MemoryStats *outStats)
+{
+    AVD_ASSERT(outStats != NULL);
+    AVD_ASSERT(tag <= AVD_MEMORY_TAG_COUNT);
+
+    PRIV_avdMemoryLock();
+    *outStats = PRIV_avdMemoryStats[tag];
+    PRIV_avdMemoryUnlock();
+    return true;
+}
+
+AVD_Size avdMemoryReportLeaks(void)
+{
+    AVD_Size count = 0;
+    AVD_Size bytes = 0;
+
+    PRIV_avdMemoryLock();
+    for (AVD_MemoryHeader *header = PRIV_avdMemoryLive; header != NULL; header = header->next) {
+        if (count < AVD_MEMORY_MAX_REPORTED_LEAKS) {
+            AVD_LOG_WARN("Leaked %zu bytes [%s] allocated at %s:%d",
+                         header->size,
+                         avdMemoryTagName((AVD_MemoryTag)header->tag),
+                         header->file ? header->file : "<unknown>",
+                         header->line);
+        }
+        count++;
+        bytes += header->size;
+    }
+    PRIV_avdMemoryUnlock();
+
+    if (count > AVD_MEMORY_MAX_REPORTED_LEAKS) {
+        AVD_LOG_WARN("... and %zu more leaked allocations", count - AVD_MEMORY_MAX_REPORTED_LEAKS);
+    }
+
+    if (count > 0) {
+        AVD_LOG_WARN("Memory tracker: %zu allocations (%zu bytes) are still alive", count, bytes);
+    } else {
+        AVD_LOG_INFO("Memory tracker: no leaks detected");
+    }
+    return count;
+}
+
+static void PRIV_avdMemoryWriteJsonString(FILE *file, const char *str)
+{
+    fputc('"', file);
+    for (const char *c = str; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+        }
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+static void PRIV_avdMemoryWriteJsonStats(FILE *file, const AVD_MemoryStats *stats)
+{
+    fprintf(file, "{\"liveBytes\": %zu, \"peakBytes\": %zu, \"liveAllocations\": %zu, ", stats->liveBytes, stats->peakBytes, stats->liveAllocations);
+    fprintf(file, "\"totalAllocations\": %zu, \"totalFrees\": %zu, \"totalAllocatedBytes\": %zu, ", stats->totalAllocations, stats->totalFrees, stats->totalAllocatedBytes);
+    fprintf(file, "\"histogram\": [");
+    for (AVD_Size i = 0; i < AVD_MEMORY_HISTOGRAM_BUCKET_COUNT; i++) {
+        fprintf(file, "%s%zu", i == 0 ? "" : ", ", stats->histogram[i]);
+    }
+    fprintf(file, "]}");
+}
+
+bool avdMemoryWriteReport(const char *path)
+{
+    AVD_ASSERT(path != NULL);
+
+    FILE *file = fopen(path, "w");
+    AVD_CHECK_MSG(file != NULL, "Failed to open memory report file: %s", path);
+
+    AVD_MemoryStats stats[AVD_MEMORY_TAG_COUNT + 1];
+    PRIV_avdMemoryLock();
+    memcpy(stats, PRIV_avdMemoryStats, sizeof(stats));
+    PRIV_avdMemoryUnlock();
+
+    fprintf(file, "{\n  \"trackingEnabled\": %s,\n", avdMemoryTrackingEnabled() ? "true" : "false");
+
+    // bucket i holds sizes up to 2^i bytes, the last bucket is open ended
+    fprintf(file, "  \"histogramBucketUpperBounds\": [");
+    for (AVD_Size i = 0; i < AVD_MEMORY_HISTOGRAM_BUCKET_COUNT - 1; i++) {
+        fprintf(file, "%zu, ", (AVD_Size)1 << i);
+    }
+    fprintf(file, "null],\n");
+
+    fprintf(file, "  \"total\": ");
+    PRIV_avdMemoryWriteJsonStats(file, &stats[AVD_MEMORY_TAG_COUNT]);
+    fprintf(file, ",\n  \"subsystems\": {\n");
+    for (AVD_Size i = 0; i < AVD_MEMORY_TAG_COUNT; i++) {
+        fprintf(file, "    \"%s\": ", PRIV_avdMemoryTagNames[i]);
+        PRIV_avdMemoryWriteJsonStats(file, &stats[i]);
+        fprintf(file, "%s\n", i + 1 < AVD_MEMORY_TAG_COUNT ? "," : "");
+    }
+    fprintf(file, "  },\n  \"liveAllocations\": [");
+
+    AVD_Size count           = 0;
+    AVD_MemoryHeader *header = NULL;
+    PRIV_avdMemoryLock();
+    for (header = PRIV_avdMemoryLive; header != NULL && count < AVD_MEMORY_MAX_JSON_LEAKS; header = header->next, count++) {
+        fprintf(file, "%s\n    {\"subsystem\": \"%s\", \"size\": %zu, \"file\": ", count == 0 ? "" : ",", avdMemoryTagName((AVD_MemoryTag)header->tag), header->size);
+        PRIV_avdMemoryWriteJsonString(file, header->file ? header->file : "");
+        fprintf(file, ", \"line\": %d}", header->line);
+    }
+    bool truncated = header != NULL;
+    PRIV_avdMemoryUnlock();
+
+    fprintf(file, "%s],\n  \"liveAllocationsTruncated\": %s\n}\n", count == 0 ? "" : "\n  ", truncated ? "true" : "false");
+    fclose(file);
+    return true;
+}
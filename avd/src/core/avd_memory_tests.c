@@ -0,0 +1,165 @@
+#include "core/avd_core.h"
+
+// The tests drive the tracker directly so they also run in builds where the
+// AVD_MALLOC macros are not routed through it.
+
+static bool PRIV_avdTestMemoryAccounting()
+{
+    AVD_LOG_DEBUG("  Testing Memory accounting...");
+
+    AVD_MemoryStats before = {0};
+    AVD_MemoryStats total  = {0};
+    AVD_CHECK(avdMemoryGetStats(AVD_MEMORY_TAG_AUDIO, &before));
+    AVD_CHECK(avdMemoryGetStats(AVD_MEMORY_TAG_COUNT, &total));
+
+    void *small = avdMemoryTrackedAlloc(24, 0, AVD_MEMORY_TAG_AUDIO, __FILE__, __LINE__);
+    void *large = avdMemoryTrackedAlloc(5000, 0, AVD_MEMORY_TAG_AUDIO, __FILE__, __LINE__);
+    AVD_CHECK_MSG(small != NULL && large != NULL, "Tracked allocation failed");
+    memset(small, 0xAB, 24);
+    memset(large, 0xCD, 5000);
+
+    AVD_MemoryStats during = {0};
+    AVD_CHECK(avdMemoryGetStats(AVD_MEMORY_TAG_AUDIO, &during));
+    AVD_CHECK_MSG(during.liveBytes == before.liveBytes + 5024, "Live bytes %zu, expected %zu", during.liveBytes, before.liveBytes + 5024);
+    AVD_CHECK_MSG(during.liveAllocations == before.liveAllocations + 2, "Live allocation count mismatch");
+    AVD_CHECK_MSG(during.peakBytes >= during.liveBytes, "Peak below live bytes");
+    AVD_CHECK_MSG(during.histogram[5] == before.histogram[5] + 1, "24 bytes should land in the (16, 32] bucket");
+    AVD_CHECK_MSG(during.histogram[13] == before.histogram[13] + 1, "5000 bytes should land in the (4096, 8192] bucket");
+
+    avdMemoryTrackedFree(large, __FILE__, __LINE__);
+    avdMemoryTrackedFree(small, __FILE__, __LINE__);
+
+    AVD_MemoryStats after      = {0};
+    AVD_MemoryStats totalAfter = {0};
+    AVD_CHECK(avdMemoryGetStats(AVD_MEMORY_TAG_AUDIO, &after));
+    AVD_CHECK(avdMemoryGetStats(AVD_MEMORY_TAG_COUNT, &totalAfter));
+    AVD_CHECK_MSG(after.liveBytes == before.liveBytes && after.liveAllocations == before.liveAllocations, "Free did not release accounting");
+    AVD_CHECK_MSG(after.totalFrees == before.totalFrees + 2, "Free count mismatch");
+    AVD_CHECK_MSG(after.peakBytes >= before.liveBytes + 5024, "Peak was not recorded");
+    AVD_CHECK_MSG(totalAfter.totalAllocations == total.totalAllocations + 2, "Totals do not include tagged allocations");
+
+    AVD_LOG_DEBUG("    Memory accounting PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestMemoryTagResolution()
+{
+    AVD_LOG_DEBUG("  Testing Memory tag resolution...");
+
+    static const struct {
+        const char *file;
+        AVD_MemoryTag threadTag;
+        AVD_MemoryTag expected;
+    } cases[] = {
+        {"src/scenes/hls_player/avd_scenes_hls_player.c", AVD_MEMORY_TAG_GENERAL, AVD_MEMORY_TAG_HLS},
+        {"C:\\avd\\src\\vulkan\\video\\avd_vulkan_video_decoder.c", AVD_MEMORY_TAG_GENERAL, AVD_MEMORY_TAG_VIDEO},
+        {"model/avd_model.c", AVD_MEMORY_TAG_GENERAL, AVD_MEMORY_TAG_MODEL},
+        {"src/core/avd_list.c", AVD_MEMORY_TAG_GENERAL, AVD_MEMORY_TAG_CORE},
+        {"src/core/avd_list.c", AVD_MEMORY_TAG_MODEL, AVD_MEMORY_TAG_MODEL},
+        {"src/shader/avd_shader.c", AVD_MEMORY_TAG_HLS, AVD_MEMORY_TAG_SHADER},
+        {"avd_main.c", AVD_MEMORY_TAG_FONT, AVD_MEMORY_TAG_FONT},
+        {"avd_main.c", AVD_MEMORY_TAG_GENERAL, AVD_MEMORY_TAG_GENERAL},
+    };
+
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(cases); i++) {
+        AVD_MemoryStats before = {0};
+        AVD_MemoryStats after  = {0};
+        AVD_CHECK(avdMemoryGetStats(cases[i].expected, &before));
+
+        AVD_MemoryTag previous = avdMemorySetThreadTag(cases[i].threadTag);
+        void *ptr              = avdMemoryTrackedAlloc(8, 0, AVD_MEMORY_TAG_AUTO, cases[i].file, 1);
+        avdMemorySetThreadTag(previous);
+
+        AVD_CHECK(avdMemoryGetStats(cases[i].expected, &after));
+        avdMemoryTrackedFree(ptr, __FILE__, __LINE__);
+
+        AVD_CHECK_MSG(after.liveAllocations == before.liveAllocations + 1, "Allocation from %s was not charged to %s", cases[i].file, avdMemoryTagName(cases[i].expected));
+    }
+
+    AVD_LOG_DEBUG("    Memory tag resolution PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestMemoryAlignmentAndRealloc()
+{
+    AVD_LOG_DEBUG("  Testing Memory alignment and realloc...");
+
+    AVD_Size alignments[] = {1, 16, 64, 256, 4096};
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(alignments); i++) {
+        void *ptr = avdMemoryTrackedAlloc(100, alignments[i], AVD_MEMORY_TAG_CORE, __FILE__, __LINE__);
+        AVD_CHECK_MSG(ptr != NULL && ((uintptr_t)ptr % AVD_MAX(alignments[i], (AVD_Size)AVD_MEMORY_DEFAULT_ALIGNMENT)) == 0, "Allocation not aligned to %zu", alignments[i]);
+        avdMemoryTrackedFree(ptr, __FILE__, __LINE__);
+    }
+
+    AVD_UInt8 *zeroed = (AVD_UInt8 *)avdMemoryTrackedCalloc(64, 4, AVD_MEMORY_TAG_CORE, __FILE__, __LINE__);
+    AVD_CHECK_MSG(zeroed != NULL, "Calloc failed");
+    for (AVD_Size i = 0; i < 256; i++) {
+        AVD_CHECK_MSG(zeroed[i] == 0, "Calloc memory is not zeroed");
+        zeroed[i] = (AVD_UInt8)i;
+    }
+
+    AVD_MemoryStats coreBefore = {0};
+    AVD_MemoryStats hlsBefore  = {0};
+    AVD_CHECK(avdMemoryGetStats(AVD_MEMORY_TAG_CORE, &coreBefore));
+    AVD_CHECK(avdMemoryGetStats(AVD_MEMORY_TAG_HLS, &hlsBefore));
+
+    // a reallocation is charged to the subsystem doing it, not the original one
+    AVD_UInt8 *grown = (AVD_UInt8 *)avdMemoryTrackedRealloc(zeroed, 1024, AVD_MEMORY_TAG_HLS, __FILE__, __LINE__);
+    AVD_CHECK_MSG(grown != NULL, "Realloc failed");
+    for (AVD_Size i = 0; i < 256; i++) {
+        AVD_CHECK_MSG(grown[i] == (AVD_UInt8)i, "Realloc lost data at %zu", i);
+    }
+
+    AVD_MemoryStats coreAfter = {0};
+    AVD_MemoryStats hlsAfter  = {0};
+    AVD_CHECK(avdMemoryGetStats(AVD_MEMORY_TAG_CORE, &coreAfter));
+    AVD_CHECK(avdMemoryGetStats(AVD_MEMORY_TAG_HLS, &hlsAfter));
+    AVD_CHECK_MSG(coreAfter.liveBytes == coreBefore.liveBytes - 256 && hlsAfter.liveBytes == hlsBefore.liveBytes + 1024, "Realloc accounting mismatch");
+
+    AVD_UInt8 *shrunk = (AVD_UInt8 *)avdMemoryTrackedRealloc(grown, 16, AVD_MEMORY_TAG_AUTO, __FILE__, __LINE__);
+    AVD_CHECK_MSG(shrunk != NULL && shrunk[15] == 15, "Shrinking realloc failed");
+    avdMemoryTrackedFree(shrunk, __FILE__, __LINE__);
+
+    AVD_LOG_DEBUG("    Memory alignment and realloc PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestMemoryReport()
+{
+    AVD_LOG_DEBUG("  Testing Memory report...");
+
+    void *leak = avdMemoryTrackedAlloc(333, 0, AVD_MEMORY_TAG_SHADER, "src/core/avd_memory_tests.c", 4242);
+
+    const char *path = "avd_memory_report_test.json";
+    AVD_CHECK(avdMemoryWriteReport(path));
+
+    char *json      = NULL;
+    AVD_Size length = 0;
+    bool readOk     = avdReadBinaryFile(path, (void **)&json, &length);
+    remove(path);
+    avdMemoryTrackedFree(leak, __FILE__, __LINE__);
+    AVD_CHECK_MSG(readOk, "Failed to read back the memory report");
+
+    bool valid = strstr(json, "\"subsystems\"") != NULL &&
+                 strstr(json, "\"shader\": {\"liveBytes\"") != NULL &&
+                 strstr(json, "\"size\": 333, \"file\": \"src/core/avd_memory_tests.c\", \"line\": 4242}") != NULL &&
+                 strstr(json, "\"liveAllocationsTruncated\": false") != NULL;
+    AVD_FREE(json);
+    AVD_CHECK_MSG(valid, "Memory report is missing expected entries");
+
+    AVD_LOG_DEBUG("    Memory report PASSED");
+    return true;
+}
+
+bool avdMemoryTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Memory Tests...");
+
+    AVD_CHECK(PRIV_avdTestMemoryAccounting());
+    AVD_CHECK(PRIV_avdTestMemoryTagResolution());
+    AVD_CHECK(PRIV_avdTestMemoryAlignmentAndRealloc());
+    AVD_CHECK(PRIV_avdTestMemoryReport());
+
+    AVD_LOG_DEBUG("All AVD Memory Tests PASSED");
+    return true;
+}
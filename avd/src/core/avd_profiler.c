@@ -0,0 +1,410 @@
+#include "core/avd_profiler.h"
+#include "core/avd_arena.h"
+#include "core/avd_atomic.h"
+
+#include <stdarg.h>
+
+// distinct zone names the last frame summary can aggregate
+#define AVD_PROFILER_MAX_FRAME_ZONES 256
+
+typedef struct {
+    const char *name;
+    AVD_Double beginUs;
+} AVD_ProfilerOpenZone;
+
+typedef struct AVD_ProfilerThread {
+    struct AVD_ProfilerThread *next;
+
+    // only the owning thread writes events, readers validate what they copied
+    // against writeIndex afterwards
+    volatile AVD_Int64 writeIndex;
+    volatile AVD_Int64 retired;
+
+    AVD_UInt32 threadIndex;
+    char name[AVD_PROFILER_THREAD_NAME_SIZE];
+
+    AVD_UInt32 depth;
+    AVD_ProfilerOpenZone openZones[AVD_PROFILER_MAX_DEPTH];
+    AVD_ProfilerEvent events[AVD_PROFILER_EVENTS_PER_THREAD];
+} AVD_ProfilerThread;
+
+typedef struct {
+    volatile AVD_Int64 initialized;
+    picoPerfTime epoch;
+
+    void *volatile threads; // AVD_ProfilerThread list, only ever prepended to
+    volatile AVD_Int64 threadCount;
+
+    // written by the thread calling avdProfilerFrameMark
+    AVD_Double frameBeginUs[AVD_PROFILER_MAX_FRAMES];
+    AVD_Int64 frameCount;
+} AVD_Profiler;
+
+static AVD_Profiler PRIV_avdProfiler = {0};
+
+static AVD_THREAD_LOCAL AVD_ProfilerThread *PRIV_avdProfilerCurrentThread = NULL;
+
+static AVD_Double PRIV_avdProfilerNowUs(void)
+{
+    return picoPerfDurationMilliseconds(PRIV_avdProfiler.epoch, picoPerfNow()) * 1000.0;
+}
+
+static AVD_ProfilerThread *PRIV_avdProfilerFirstThread(void)
+{
+    return (AVD_ProfilerThread *)avdAtomicLoadPtr(&PRIV_avdProfiler.threads);
+}
+
+static AVD_ProfilerThread *PRIV_avdProfilerGetThread(void)
+{
+    AVD_ProfilerThread *thread = PRIV_avdProfilerCurrentThread;
+    if (thread != NULL) {
+        return thread;
+    }
+
+    // reuse the buffer of a thread that already exited before growing the list,
+    // its events stay in the ring and are reported under the new thread name
+    for (AVD_ProfilerThread *candidate = PRIV_avdProfilerFirstThread(); candidate != NULL; candidate = candidate->next) {
+        AVD_Int64 expected = 1;
+        if (avdAtomicCompareExchange64(&candidate->retired, &expected, 0)) {
+            thread = candidate;
+            break;
+        }
+    }
+
+    if (thread == NULL) {
+        thread = (AVD_ProfilerThread *)AVD_MALLOC(sizeof(AVD_ProfilerThread));
+        if (thread == NULL) {
+            return NULL;
+        }
+        memset(thread, 0, sizeof(AVD_ProfilerThread));
+        thread->threadIndex = (AVD_UInt32)avdAtomicAdd64(&PRIV_avdProfiler.threadCount, 1);
+
+        void *head = avdAtomicLoadPtr(&PRIV_avdProfiler.threads);
+        do {
+            thread->next = (AVD_ProfilerThread *)head;
+        } while (!avdAtomicCompareExchangePtr(&PRIV_avdProfiler.threads, &head, thread));
+    }
+
+    thread->depth = 0;
+    snprintf(thread->name, sizeof(thread->name), "Thread %u", thread->threadIndex);
+    PRIV_avdProfilerCurrentThread = thread;
+    return thread;
+}
+
+static void PRIV_avdProfilerRecord(AVD_ProfilerThread *thread, const AVD_ProfilerOpenZone *zone, AVD_Double endUs)
+{
+    AVD_Int64 index          = avdAtomicLoad64(&thread->writeIndex);
+    AVD_ProfilerEvent *event = &thread->events[index % AVD_PROFILER_EVENTS_PER_THREAD];
+    event->name              = zone->name;
+    event->beginUs           = zone->beginUs;
+    event->endUs             = endUs;
+    event->depth             = thread->depth;
+    // publishing after the event is written keeps readers from seeing a half written one
+    avdAtomicStore64(&thread->writeIndex, index + 1);
+}
+
+// Copies the events of one thread that ended after sinceUs, newest first,
+// and drops whatever the owner may have overwritten in the meantime.
+static AVD_Size PRIV_avdProfilerCopyEvents(AVD_ProfilerThread *thread, AVD_Double sinceUs, AVD_ProfilerEvent *outEvents)
+{
+    AVD_Int64 writeIndex = avdAtomicLoad64(&thread->writeIndex);
+
+    // the slot at writeIndex - capacity is the one the owner writes next
+    AVD_Int64 oldest = AVD_MAX(writeIndex - AVD_PROFILER_EVENTS_PER_THREAD + 1, (AVD_Int64)0);
+    AVD_Size count   = 0;
+    for (AVD_Int64 i = writeIndex - 1; i >= oldest; i--) {
+        AVD_ProfilerEvent event = thread->events[i % AVD_PROFILER_EVENTS_PER_THREAD];
+        // events are recorded in the order they end, one ending on a frame
+        // mark belongs to the frame before it
+        if (event.endUs <= sinceUs) {
+            break;
+        }
+        outEvents[count++] = event;
+    }
+
+    AVD_Int64 newWriteIndex = avdAtomicLoad64(&thread->writeIndex);
+    AVD_Int64 overwritten   = newWriteIndex - AVD_PROFILER_EVENTS_PER_THREAD + 1 - oldest;
+    if (overwritten > 0) {
+        count = overwritten >= (AVD_Int64)count ? 0 : count - (AVD_Size)overwritten;
+    }
+    return count;
+}
+
+static int PRIV_avdProfilerCompareZones(const void *a, const void *b)
+{
+    AVD_Double totalA = ((const AVD_ProfilerZoneStats *)a)->totalMs;
+    AVD_Double totalB = ((const AVD_ProfilerZoneStats *)b)->totalMs;
+    return (totalA < totalB) - (totalA > totalB);
+}
+
+static void PRIV_avdProfilerWriteJsonString(FILE *file, const char *value)
+{
+    fputc('"', file);
+    for (const char *c = value; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+        }
+        fputc((unsigned char)*c < 0x20 ? ' ' : *c, file);
+    }
+    fputc('"', file);
+}
+
+bool avdProfilerInit(void)
+{
+    AVD_CHECK_MSG(!avdProfilerIsInitialized(), "Profiler is already initialized");
+
+    PRIV_avdProfiler.epoch      = picoPerfNow();
+    PRIV_avdProfiler.frameCount = 0;
+    avdAtomicStore64(&PRIV_avdProfiler.initialized, 1);
+
+    avdProfilerSetThreadName("Main");
+    return true;
+}
+
+void avdProfilerShutdown(void)
+{
+    if (!avdProfilerIsInitialized()) {
+        return;
+    }
+
+    avdAtomicStore64(&PRIV_avdProfiler.initialized, 0);
+
+    AVD_ProfilerThread *thread = PRIV_avdProfilerFirstThread();
+    while (thread != NULL) {
+        AVD_ProfilerThread *next = thread->next;
+        AVD_FREE(thread);
+        thread = next;
+    }
+
+    avdAtomicStorePtr(&PRIV_avdProfiler.threads, NULL);
+    avdAtomicStore64(&PRIV_avdProfiler.threadCount, 0);
+    PRIV_avdProfilerCurrentThread = NULL;
+}
+
+bool avdProfilerIsInitialized(void)
+{
+    return avdAtomicLoad64(&PRIV_avdProfiler.initialized) != 0;
+}
+
+void avdProfilerBeginZone(const char *name)
+{
+    if (!avdProfilerIsInitialized()) {
+        return;
+    }
+
+    AVD_ProfilerThread *thread = PRIV_avdProfilerGetThread();
+    if (thread == NULL) {
+        return;
+    }
+
+    // zones nested deeper than the stack are counted but not recorded
+    if (thread->depth < AVD_PROFILER_MAX_DEPTH) {
+        thread->openZones[thread->depth].name    = name;
+        thread->openZones[thread->depth].beginUs = PRIV_avdProfilerNowUs();
+    }
+    thread->depth++;
+}
+
+void avdProfilerEndZone(void)
+{
+    AVD_ProfilerThread *thread = PRIV_avdProfilerCurrentThread;
+    if (thread == NULL || thread->depth == 0 || !avdProfilerIsInitialized()) {
+        return;
+    }
+
+    thread->depth--;
+    if (thread->depth < AVD_PROFILER_MAX_DEPTH) {
+        PRIV_avdProfilerRecord(thread, &thread->openZones[thread->depth], PRIV_avdProfilerNowUs());
+    }
+}
+
+void avdProfilerFrameMark(void)
+{
+    if (!avdProfilerIsInitialized()) {
+        return;
+    }
+
+    AVD_Double nowUs = PRIV_avdProfilerNowUs();
+
+    AVD_ProfilerThread *thread = PRIV_avdProfilerCurrentThread;
+    if (thread != NULL && thread->depth > 0) {
+        AVD_LOG_WARN_DEBOUNCED(5000, "%u profiler zones were still open at the end of the frame", thread->depth);
+        while (thread->depth > 0) {
+            thread->depth--;
+            if (thread->depth < AVD_PROFILER_MAX_DEPTH) {
+                PRIV_avdProfilerRecord(thread, &thread->openZones[thread->depth], nowUs);
+            }
+        }
+    }
+
+    PRIV_avdProfiler.frameBeginUs[PRIV_avdProfiler.frameCount % AVD_PROFILER_MAX_FRAMES] = nowUs;
+    PRIV_avdProfiler.frameCount++;
+}
+
+void avdProfilerSetThreadName(const char *format, ...)
+{
+    AVD_ASSERT(format != NULL);
+
+    if (!avdProfilerIsInitialized()) {
+        return;
+    }
+
+    AVD_ProfilerThread *thread = PRIV_avdProfilerGetThread();
+    if (thread == NULL) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(thread->name, sizeof(thread->name), format, args);
+    va_end(args);
+}
+
+void avdProfilerThreadShutdown(void)
+{
+    AVD_ProfilerThread *thread = PRIV_avdProfilerCurrentThread;
+    if (thread == NULL) {
+        return;
+    }
+
+    PRIV_avdProfilerCurrentThread = NULL;
+    if (avdProfilerIsInitialized()) {
+        avdAtomicStore64(&thread->retired, 1);
+    }
+}
+
+AVD_Size avdProfilerGetLastFrameZones(AVD_ProfilerZoneStats *outZones, AVD_Size maxCount, AVD_Double *outFrameMs)
+{
+    AVD_ASSERT(outZones != NULL || maxCount == 0);
+
+    if (outFrameMs != NULL) {
+        *outFrameMs = 0.0;
+    }
+
+    AVD_Int64 frameCount = PRIV_avdProfiler.frameCount;
+    if (!avdProfilerIsInitialized() || frameCount < 2) {
+        return 0;
+    }
+
+    AVD_Double frameBeginUs = PRIV_avdProfiler.frameBeginUs[(frameCount - 2) % AVD_PROFILER_MAX_FRAMES];
+    AVD_Double frameEndUs   = PRIV_avdProfiler.frameBeginUs[(frameCount - 1) % AVD_PROFILER_MAX_FRAMES];
+    if (outFrameMs != NULL) {
+        *outFrameMs = (frameEndUs - frameBeginUs) / 1000.0;
+    }
+
+    AVD_ArenaScratch scratch     = avdArenaScratchBegin(NULL);
+    AVD_ProfilerEvent *events    = AVD_ARENA_PUSH_ARRAY(scratch.arena, AVD_ProfilerEvent, AVD_PROFILER_EVENTS_PER_THREAD);
+    AVD_ProfilerZoneStats *zones = AVD_ARENA_PUSH_ARRAY(scratch.arena, AVD_ProfilerZoneStats, AVD_PROFILER_MAX_FRAME_ZONES);
+    AVD_Size zoneCount           = 0;
+    if (events == NULL || zones == NULL) {
+        avdArenaScratchEnd(scratch);
+        return 0;
+    }
+
+    for (AVD_ProfilerThread *thread = PRIV_avdProfilerFirstThread(); thread != NULL; thread = thread->next) {
+        AVD_Size eventCount = PRIV_avdProfilerCopyEvents(thread, frameBeginUs, events);
+        for (AVD_Size i = 0; i < eventCount; i++) {
+            if (events[i].endUs > frameEndUs) {
+                continue;
+            }
+
+            AVD_ProfilerZoneStats *zone = NULL;
+            for (AVD_Size j = 0; j < zoneCount && zone == NULL; j++) {
+                // literals with the same text are not guaranteed to share an address across files
+                if (zones[j].name == events[i].name || strcmp(zones[j].name, events[i].name) == 0) {
+                    zone = &zones[j];
+                }
+            }
+            if (zone == NULL) {
+                if (zoneCount == AVD_PROFILER_MAX_FRAME_ZONES) {
+                    continue;
+                }
+                zone = &zones[zoneCount++];
+                memset(zone, 0, sizeof(AVD_ProfilerZoneStats));
+                zone->name = events[i].name;
+            }
+
+            AVD_Double durationMs = (events[i].endUs - events[i].beginUs) / 1000.0;
+            zone->totalMs += durationMs;
+            zone->maxMs = AVD_MAX(zone->maxMs, durationMs);
+            zone->callCount++;
+        }
+    }
+
+    qsort(zones, zoneCount, sizeof(AVD_ProfilerZoneStats), PRIV_avdProfilerCompareZones);
+    AVD_Size count = AVD_MIN(zoneCount, maxCount);
+    memcpy(outZones, zones, sizeof(AVD_ProfilerZoneStats) * count);
+
+    avdArenaScratchEnd(scratch);
+    return count;
+}
+
+AVD_Size avdProfilerFormatLastFrame(char *buffer, AVD_Size bufferSize, AVD_Size maxZones)
+{
+    AVD_ASSERT(buffer != NULL && bufferSize > 0);
+
+    AVD_ProfilerZoneStats zones[32];
+    AVD_Double frameMs = 0.0;
+    AVD_Size count     = avdProfilerGetLastFrameZones(zones, AVD_MIN(maxZones, AVD_ARRAY_COUNT(zones)), &frameMs);
+
+    int written = snprintf(buffer, bufferSize, "Frame %.2f ms", frameMs);
+    for (AVD_Size i = 0; i < count && written > 0 && (AVD_Size)written < bufferSize; i++) {
+        written += snprintf(buffer + written, bufferSize - (AVD_Size)written, "\n%-28s %7.3f ms  x%u", zones[i].name, zones[i].totalMs, zones[i].callCount);
+    }
+    return count;
+}
+
+bool avdProfilerWriteChromeTrace(const char *path)
+{
+    AVD_ASSERT(path != NULL);
+    AVD_CHECK_MSG(avdProfilerIsInitialized(), "Profiler is not initialized");
+
+    AVD_ArenaScratch scratch  = avdArenaScratchBegin(NULL);
+    AVD_ProfilerEvent *events = AVD_ARENA_PUSH_ARRAY(scratch.arena, AVD_ProfilerEvent, AVD_PROFILER_EVENTS_PER_THREAD);
+    if (events == NULL) {
+        avdArenaScratchEnd(scratch);
+        AVD_LOG_ERROR("Failed to allocate profiler trace events");
+        return false;
+    }
+
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        avdArenaScratchEnd(scratch);
+        AVD_LOG_ERROR("Failed to open profiler trace %s for writing", path);
+        return false;
+    }
+
+    AVD_Size eventTotal = 0;
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    fprintf(file, "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"avd\"}}");
+
+    for (AVD_ProfilerThread *thread = PRIV_avdProfilerFirstThread(); thread != NULL; thread = thread->next) {
+        fprintf(file, ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": ", thread->threadIndex);
+        PRIV_avdProfilerWriteJsonString(file, thread->name);
+        fprintf(file, "}}");
+
+        AVD_Size eventCount = PRIV_avdProfilerCopyEvents(thread, 0.0, events);
+        // oldest first so the file reads in time order per thread
+        for (AVD_Size i = eventCount; i > 0; i--) {
+            const AVD_ProfilerEvent *event = &events[i - 1];
+            fprintf(file, ",\n  {\"name\": ");
+            PRIV_avdProfilerWriteJsonString(file, event->name);
+            fprintf(file, ", \"cat\": \"avd\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}", thread->threadIndex, event->beginUs, event->endUs - event->beginUs);
+        }
+        eventTotal += eventCount;
+    }
+
+    AVD_Int64 frameCount = PRIV_avdProfiler.frameCount;
+    for (AVD_Int64 i = AVD_MAX(frameCount - AVD_PROFILER_MAX_FRAMES, (AVD_Int64)0); i < frameCount; i++) {
+        fprintf(file, ",\n  {\"name\": \"Frame %lld\", \"ph\": \"i\", \"s\": \"g\", \"pid\": 1, \"tid\": 0, \"ts\": %.3f}", (long long)i, PRIV_avdProfiler.frameBeginUs[i % AVD_PROFILER_MAX_FRAMES]);
+    }
+
+    fprintf(file, "\n]}\n");
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    avdArenaScratchEnd(scratch);
+
+    AVD_CHECK_MSG(ok, "Failed to write profiler trace %s", path);
+    AVD_LOG_INFO("Wrote %zu profiler zones to %s", eventTotal, path);
+    return true;
+}
@@ -0,0 +1,228 @@
+#include "core/avd_core.h"
+#include "pico/picoThreads.h"
+#include <string.h>
+
+#define AVD_PROFILER_TEST_THREADS         4
+#define AVD_PROFILER_TEST_ZONES_PER_THREAD 1000
+
+static const AVD_ProfilerZoneStats *PRIV_avdTestProfilerFindZone(const AVD_ProfilerZoneStats *zones, AVD_Size count, const char *name)
+{
+    for (AVD_Size i = 0; i < count; i++) {
+        if (strcmp(zones[i].name, name) == 0) {
+            return &zones[i];
+        }
+    }
+    return NULL;
+}
+
+static void PRIV_avdTestProfilerSpin(AVD_Double milliseconds)
+{
+    picoPerfTime start = picoPerfNow();
+    while (picoPerfDurationMilliseconds(start, picoPerfNow()) < milliseconds) {
+    }
+}
+
+static bool PRIV_avdTestProfilerNesting()
+{
+    AVD_LOG_DEBUG("  Testing Profiler nested zones...");
+
+    avdProfilerFrameMark();
+    avdProfilerBeginZone("profiler_test/outer");
+    avdProfilerBeginZone("profiler_test/inner");
+    PRIV_avdTestProfilerSpin(1.0);
+    avdProfilerEndZone();
+    avdProfilerBeginZone("profiler_test/inner");
+    PRIV_avdTestProfilerSpin(1.0);
+    avdProfilerEndZone();
+    avdProfilerEndZone();
+
+    int macroRuns = 0;
+    AVD_PROFILE_SCOPE("profiler_test/macro") {
+        macroRuns++;
+    }
+    avdProfilerFrameMark();
+
+    AVD_ProfilerZoneStats zones[8];
+    AVD_Double frameMs = 0.0;
+    AVD_Size count     = avdProfilerGetLastFrameZones(zones, AVD_ARRAY_COUNT(zones), &frameMs);
+
+    const AVD_ProfilerZoneStats *outer = PRIV_avdTestProfilerFindZone(zones, count, "profiler_test/outer");
+    const AVD_ProfilerZoneStats *inner = PRIV_avdTestProfilerFindZone(zones, count, "profiler_test/inner");
+    if (outer == NULL || inner == NULL || outer->callCount != 1 || inner->callCount != 2) {
+        AVD_LOG_ERROR("    FAILED: Expected one outer and two inner zones in the last frame");
+        return false;
+    }
+    if (zones[0].name != outer->name || outer->totalMs < inner->totalMs || inner->totalMs < 2.0 || frameMs < outer->totalMs) {
+        AVD_LOG_ERROR("    FAILED: Zone times are inconsistent (frame %.3f, outer %.3f, inner %.3f)", frameMs, outer->totalMs, inner->totalMs);
+        return false;
+    }
+
+    if (macroRuns != 1) {
+        AVD_LOG_ERROR("    FAILED: AVD_PROFILE_SCOPE ran its block %d times", macroRuns);
+        return false;
+    }
+#ifdef AVD_PROFILER
+    if (PRIV_avdTestProfilerFindZone(zones, count, "profiler_test/macro") == NULL) {
+        AVD_LOG_ERROR("    FAILED: AVD_PROFILE_SCOPE did not record a zone");
+        return false;
+    }
+#endif
+
+    AVD_LOG_DEBUG("    Profiler nested zones PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestProfilerFrameClosesZones()
+{
+    AVD_LOG_DEBUG("  Testing Profiler frame mark closing open zones...");
+
+    avdProfilerFrameMark();
+    avdProfilerBeginZone("profiler_test/left_open");
+    avdProfilerBeginZone("profiler_test/left_open_nested");
+    avdProfilerFrameMark();
+
+    AVD_ProfilerZoneStats zones[8];
+    AVD_Size count = avdProfilerGetLastFrameZones(zones, AVD_ARRAY_COUNT(zones), NULL);
+    if (PRIV_avdTestProfilerFindZone(zones, count, "profiler_test/left_open") == NULL || PRIV_avdTestProfilerFindZone(zones, count, "profiler_test/left_open_nested") == NULL) {
+        AVD_LOG_ERROR("    FAILED: Zones left open were not closed by the frame mark");
+        return false;
+    }
+
+    // an unbalanced end must not underflow
+    avdProfilerEndZone();
+    avdProfilerFrameMark();
+    count = avdProfilerGetLastFrameZones(zones, AVD_ARRAY_COUNT(zones), NULL);
+    if (count != 0) {
+        AVD_LOG_ERROR("    FAILED: Expected an empty frame, got %zu zones", count);
+        return false;
+    }
+
+    AVD_LOG_DEBUG("    Profiler frame mark closing open zones PASSED");
+    return true;
+}
+
+static void PRIV_avdTestProfilerThread(void *userData)
+{
+    AVD_UInt32 index = (AVD_UInt32)(uintptr_t)userData;
+    avdProfilerSetThreadName("Profiler Test %u", index);
+    for (AVD_Size i = 0; i < AVD_PROFILER_TEST_ZONES_PER_THREAD; i++) {
+        avdProfilerBeginZone("profiler_test/worker");
+        avdProfilerEndZone();
+    }
+    avdProfilerThreadShutdown();
+}
+
+static bool PRIV_avdTestProfilerThreads()
+{
+    AVD_LOG_DEBUG("  Testing Profiler per-thread buffers...");
+
+    // the second round must reuse the buffers the first round handed back
+    for (int round = 0; round < 2; round++) {
+        avdProfilerFrameMark();
+
+        picoThread threads[AVD_PROFILER_TEST_THREADS];
+        for (AVD_UInt32 i = 0; i < AVD_PROFILER_TEST_THREADS; i++) {
+            threads[i] = picoThreadCreate(PRIV_avdTestProfilerThread, (void *)(uintptr_t)i);
+        }
+        for (AVD_UInt32 i = 0; i < AVD_PROFILER_TEST_THREADS; i++) {
+            picoThreadDestroy(threads[i]);
+        }
+        avdProfilerFrameMark();
+
+        AVD_ProfilerZoneStats zones[8];
+        AVD_Size count                      = avdProfilerGetLastFrameZones(zones, AVD_ARRAY_COUNT(zones), NULL);
+        const AVD_ProfilerZoneStats *worker = PRIV_avdTestProfilerFindZone(zones, count, "profiler_test/worker");
+        if (worker == NULL || worker->callCount != AVD_PROFILER_TEST_THREADS * AVD_PROFILER_TEST_ZONES_PER_THREAD) {
+            AVD_LOG_ERROR("    FAILED: Round %d recorded %u worker zones", round, worker != NULL ? worker->callCount : 0);
+            return false;
+        }
+    }
+
+    AVD_LOG_DEBUG("    Profiler per-thread buffers PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestProfilerOverflow()
+{
+    AVD_LOG_DEBUG("  Testing Profiler ring buffer overflow...");
+
+    avdProfilerFrameMark();
+    for (AVD_Size i = 0; i < AVD_PROFILER_EVENTS_PER_THREAD * 2 + 17; i++) {
+        avdProfilerBeginZone("profiler_test/overflow");
+        avdProfilerEndZone();
+    }
+    avdProfilerFrameMark();
+
+    // only the newest events survive, everything older was overwritten
+    AVD_ProfilerZoneStats zones[4];
+    AVD_Size count                        = avdProfilerGetLastFrameZones(zones, AVD_ARRAY_COUNT(zones), NULL);
+    const AVD_ProfilerZoneStats *overflow = PRIV_avdTestProfilerFindZone(zones, count, "profiler_test/overflow");
+    if (overflow == NULL || overflow->callCount == 0 || overflow->callCount >= AVD_PROFILER_EVENTS_PER_THREAD) {
+        AVD_LOG_ERROR("    FAILED: Unexpected zone count %u after overflowing the buffer", overflow != NULL ? overflow->callCount : 0);
+        return false;
+    }
+
+    AVD_LOG_DEBUG("    Profiler ring buffer overflow PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestProfilerChromeTrace()
+{
+    AVD_LOG_DEBUG("  Testing Profiler Chrome trace export...");
+
+    avdProfilerBeginZone("profiler_test/\"quoted\"");
+    avdProfilerEndZone();
+    avdProfilerFrameMark();
+
+    const char *path = "avd_profiler_trace_test.json";
+    AVD_CHECK(avdProfilerWriteChromeTrace(path));
+
+    char *json    = NULL;
+    AVD_Size size = 0;
+    bool read     = avdReadBinaryFile(path, (void **)&json, &size);
+    remove(path);
+    AVD_CHECK_MSG(read, "Failed to read back the trace");
+
+    bool ok = strncmp(json, "{\"displayTimeUnit\"", 18) == 0 &&
+              strstr(json, "\"traceEvents\": [") != NULL &&
+              strstr(json, "\"name\": \"Main\"") != NULL &&
+              strstr(json, "\"name\": \"Profiler Test ") != NULL &&
+              strstr(json, "\"name\": \"profiler_test/\\\"quoted\\\"\", \"cat\": \"avd\", \"ph\": \"X\"") != NULL &&
+              strstr(json, "\"ph\": \"i\"") != NULL &&
+              strstr(json, "\n]}\n") != NULL;
+    AVD_FREE(json);
+    AVD_CHECK_MSG(ok, "Trace is missing expected entries");
+
+    char summary[512];
+    avdProfilerFormatLastFrame(summary, sizeof(summary), 4);
+    AVD_CHECK_MSG(strncmp(summary, "Frame ", 6) == 0 && strstr(summary, "profiler_test/\"quoted\"") != NULL, "Unexpected frame summary: %s", summary);
+
+    AVD_LOG_DEBUG("    Profiler Chrome trace export PASSED");
+    return true;
+}
+
+// Runs against the live profiler when the app already started one, otherwise
+// the tests bring up their own.
+bool avdProfilerTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Profiler Tests...");
+
+    bool ownsProfiler = !avdProfilerIsInitialized();
+    if (ownsProfiler) {
+        AVD_CHECK(avdProfilerInit());
+    }
+
+    bool ok = PRIV_avdTestProfilerNesting() &&
+              PRIV_avdTestProfilerFrameClosesZones() &&
+              PRIV_avdTestProfilerThreads() &&
+              PRIV_avdTestProfilerOverflow() &&
+              PRIV_avdTestProfilerChromeTrace();
+
+    if (ownsProfiler) {
+        avdProfilerShutdown();
+    }
+    AVD_CHECK(ok);
+
+    AVD_LOG_DEBUG("All AVD Profiler Tests PASSED");
+    return true;
+}
@@ -9,22 +9,21 @@
 #endif
 #else
 #include <execinfo.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif
 
+#include "core/avd_atomic.h"
+#include "core/avd_hash.h"
 #include "core/avd_utils.h"
 
-// FNV-1a 32-bit hash function
-// See: http://www.isthe.com/chongo/tech/comp/fnv/
+// 32 bit fold of avdHash64, fine for bucketing but use the 64 bit hash for identities.
 uint32_t avdHashBuffer(const void *buffer, size_t size)
 {
-    uint32_t hash      = 2166136261u; // FNV offset basis
-    const uint8_t *ptr = (const uint8_t *)buffer;
-    for (size_t i = 0; i < size; i++) {
-        hash ^= (uint32_t)ptr[i];
-        hash *= 16777619u; // FNV prime
-    }
-    return hash;
+    uint64_t hash = avdHash64(buffer, size, AVD_HASH_DEFAULT_SEED);
+    return (uint32_t)(hash ^ (hash >> 32));
 }
 
 uint32_t avdHashString(const char *str)
@@ -109,19 +108,9 @@ void avdPrintShaderWithLineNumbers(const char *shaderCode, const char *shaderNam
             lineEnd = lineStart + strlen(lineStart);
         }
 
-        size_t lineLength = lineEnd - lineStart;
-        char *lineBuffer  = (char *)malloc(lineLength + 1);
-        if (lineBuffer == NULL) {
-            AVD_LOG_ERROR("Failed to allocate memory for shader line");
-            return;
-        }
-
-        strncpy(lineBuffer, lineStart, lineLength);
-        lineBuffer[lineLength] = '\0';
+        int lineLength = (int)(lineEnd - lineStart);
+        AVD_LOG_INFO("%d: %.*s", lineNumber++, lineLength, lineStart);
 
-        AVD_LOG_INFO("%d: %s", lineNumber++, lineBuffer);
-
-        free(lineBuffer);
         lineStart = (*lineEnd == '\0') ? lineEnd : lineEnd + 1;
     }
     AVD_LOG_INFO("");
@@ -168,7 +157,7 @@ bool avdReadBinaryFile(const char *filename, void **data, size_t *size)
     *size = ftell(file);
     fseek(file, 0, SEEK_SET);
 
-    *data = malloc(*size + 1);
+    *data = AVD_MALLOC(*size + 1);
     if (*data == NULL) {
         fclose(file);
         return false;
@@ -180,12 +169,166 @@ bool avdReadBinaryFile(const char *filename, void **data, size_t *size)
     return true;
 }
 
+static bool PRIV_avdFileViewRead(const char *filename, AVD_FileView *view)
+{
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL) {
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *data = size >= 0 ? (char *)AVD_MALLOC((size_t)size + 1) : NULL;
+    bool read  = data != NULL && fread(data, 1, (size_t)size, file) == (size_t)size;
+    fclose(file);
+    if (!read) {
+        AVD_FREE(data);
+        return false;
+    }
+
+    data[size]   = '\0';
+    view->data   = data;
+    view->size   = (AVD_Size)size;
+    view->mapped = false;
+    return true;
+}
+
+// A mapping is only followed by zeroes when the file does not end on a page
+// boundary, those and empty files take the read path to keep the NUL.
+#if defined(_WIN32) || defined(__CYGWIN__)
+static bool PRIV_avdFileViewMap(const char *filename, AVD_FileViewFlags flags, AVD_FileView *view)
+{
+    DWORD fileFlags = (flags & AVD_FILE_VIEW_FLAG_SEQUENTIAL) ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL;
+    HANDLE file     = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, fileFlags, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    SYSTEM_INFO systemInfo = {0};
+    GetSystemInfo(&systemInfo);
+
+    LARGE_INTEGER size = {0};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0 || (AVD_UInt64)size.QuadPart > SIZE_MAX || size.QuadPart % systemInfo.dwPageSize == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    // the view keeps the mapping alive, both handles can go right away
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    void *data     = mapping != NULL ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (mapping != NULL) {
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    if (data == NULL) {
+        return false;
+    }
+
+    view->data   = data;
+    view->size   = (AVD_Size)size.QuadPart;
+    view->mapped = true;
+    return true;
+}
+
+static void PRIV_avdFileViewUnmap(AVD_FileView *view)
+{
+    UnmapViewOfFile(view->data);
+}
+#else
+static bool PRIV_avdFileViewMap(const char *filename, AVD_FileViewFlags flags, AVD_FileView *view)
+{
+    int file = open(filename, O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        return false;
+    }
+
+    struct stat st;
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (fstat(file, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0 || (AVD_UInt64)st.st_size > SIZE_MAX || pageSize <= 0 || st.st_size % pageSize == 0) {
+        close(file);
+        return false;
+    }
+
+    // the mapping holds its own reference to the file
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    if (flags & AVD_FILE_VIEW_FLAG_SEQUENTIAL) {
+        madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+    }
+    if (flags & AVD_FILE_VIEW_FLAG_WILL_NEED) {
+        madvise(data, (size_t)st.st_size, MADV_WILLNEED);
+    }
+
+    view->data   = data;
+    view->size   = (AVD_Size)st.st_size;
+    view->mapped = true;
+    return true;
+}
+
+static void PRIV_avdFileViewUnmap(AVD_FileView *view)
+{
+    munmap((void *)view->data, view->size);
+}
+#endif
+
+bool avdFileViewOpen(const char *filename, AVD_FileViewFlags flags, AVD_FileView **outView)
+{
+    AVD_ASSERT(filename != NULL);
+    AVD_ASSERT(outView != NULL);
+
+    *outView = NULL;
+
+    AVD_FileView *view = (AVD_FileView *)AVD_MALLOC(sizeof(AVD_FileView));
+    AVD_CHECK_MSG(view != NULL, "Failed to allocate file view for %s", filename);
+    memset(view, 0, sizeof(AVD_FileView));
+
+    bool opened = (!(flags & AVD_FILE_VIEW_FLAG_NO_MAP) && PRIV_avdFileViewMap(filename, flags, view)) ||
+                  PRIV_avdFileViewRead(filename, view);
+    if (!opened) {
+        AVD_FREE(view);
+        AVD_LOG_ERROR("Failed to open file view: %s", filename);
+        return false;
+    }
+
+    view->refCount = 1;
+    *outView       = view;
+    return true;
+}
+
+AVD_FileView *avdFileViewRetain(AVD_FileView *view)
+{
+    AVD_ASSERT(view != NULL);
+    avdAtomicAdd64(&view->refCount, 1);
+    return view;
+}
+
+void avdFileViewRelease(AVD_FileView *view)
+{
+    if (view == NULL || avdAtomicAdd64(&view->refCount, -1) > 0) {
+        return;
+    }
+
+    if (view->mapped) {
+        PRIV_avdFileViewUnmap(view);
+    } else {
+        void *data = (void *)view->data;
+        AVD_FREE(data);
+    }
+    AVD_FREE(view);
+}
+
 const char *avdDumpToTmpFile(const void *data, size_t size, const char *extension, const char *prefix)
 {
     static char tmpFilePath[4096];
     const char *tempDir = avdGetTempDirPath();
-    uint32_t hash       = avdHashBuffer(data, size);
-    snprintf(tmpFilePath, sizeof(tmpFilePath), "%savd_%s.DUMP.%d.%s", tempDir, prefix ? prefix : "Generic", hash, extension ? extension : "bin");
+    uint64_t hash       = avdHash64(data, size, AVD_HASH_DEFAULT_SEED);
+    snprintf(tmpFilePath, sizeof(tmpFilePath), "%savd_%s.DUMP.%016llx.%s", tempDir, prefix ? prefix : "Generic", (unsigned long long)hash, extension ? extension : "bin");
 
     FILE *file = fopen(tmpFilePath, "wb");
     if (!file) {
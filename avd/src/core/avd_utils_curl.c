@@ -70,7 +70,7 @@ bool avdCurlDownloadToMemory(const char *url, void **data, size_t *size)
 
     size_t capacity = 4096;
     size_t length   = 0;
-    char *buffer    = (char *)malloc(capacity);
+    char *buffer    = (char *)AVD_MALLOC(capacity);
 
     if (buffer == NULL) {
 #ifdef _WIN32
@@ -87,9 +87,9 @@ bool avdCurlDownloadToMemory(const char *url, void **data, size_t *size)
 
         if (length >= capacity) {
             capacity *= 2;
-            char *newBuffer = (char *)realloc(buffer, capacity);
+            char *newBuffer = (char *)AVD_REALLOC(buffer, capacity);
             if (newBuffer == NULL) {
-                free(buffer);
+                AVD_FREE(buffer);
 #ifdef _WIN32
                 _pclose(fp);
 #else
@@ -108,7 +108,7 @@ bool avdCurlDownloadToMemory(const char *url, void **data, size_t *size)
 #endif
 
     if (length == 0) {
-        free(buffer);
+        AVD_FREE(buffer);
         return false;
     }
 
@@ -143,7 +143,7 @@ bool avdCurlFetchStringContent(const char *url, char **outString, int *outReturn
 
     size_t capacity = 4096;
     size_t length   = 0;
-    char *buffer    = (char *)malloc(capacity);
+    char *buffer    = (char *)AVD_MALLOC(capacity);
 
     if (buffer == NULL) {
 #ifdef _WIN32
@@ -162,9 +162,9 @@ bool avdCurlFetchStringContent(const char *url, char **outString, int *outReturn
 
         if (length >= capacity) {
             capacity *= 2;
-            char *newBuffer = (char *)realloc(buffer, capacity);
+            char *newBuffer = (char *)AVD_REALLOC(buffer, capacity);
             if (newBuffer == NULL) {
-                free(buffer);
+                AVD_FREE(buffer);
 #ifdef _WIN32
                 _pclose(fp);
 #else
@@ -185,7 +185,7 @@ bool avdCurlFetchStringContent(const char *url, char **outString, int *outReturn
 #endif
 
     if (length < 3) {
-        free(buffer);
+        AVD_FREE(buffer);
         if (outReturnCode)
             *outReturnCode = -1;
         return false;
@@ -201,16 +201,16 @@ bool avdCurlFetchStringContent(const char *url, char **outString, int *outReturn
         *outReturnCode = httpCode;
     }
 
-    *outString = (char *)malloc(length + 1);
+    *outString = (char *)AVD_MALLOC(length + 1);
     if (*outString == NULL) {
-        free(buffer);
+        AVD_FREE(buffer);
         return false;
     }
 
     memcpy(*outString, buffer, length);
     (*outString)[length] = '\0';
 
-    free(buffer);
+    AVD_FREE(buffer);
 
     return true;
 }
@@ -240,7 +240,7 @@ bool avdCurlPostRequest(const char *url, const char *postData, char **outRespons
 
     size_t capacity = 4096;
     size_t length   = 0;
-    char *buffer    = (char *)malloc(capacity);
+    char *buffer    = (char *)AVD_MALLOC(capacity);
 
     if (buffer == NULL) {
 #ifdef _WIN32
@@ -259,9 +259,9 @@ bool avdCurlPostRequest(const char *url, const char *postData, char **outRespons
 
         if (length >= capacity) {
             capacity *= 2;
-            char *newBuffer = (char *)realloc(buffer, capacity);
+            char *newBuffer = (char *)AVD_REALLOC(buffer, capacity);
             if (newBuffer == NULL) {
-                free(buffer);
+                AVD_FREE(buffer);
 #ifdef _WIN32
                 _pclose(fp);
 #else
@@ -282,7 +282,7 @@ bool avdCurlPostRequest(const char *url, const char *postData, char **outRespons
 #endif
 
     if (length < 3) {
-        free(buffer);
+        AVD_FREE(buffer);
         if (outReturnCode)
             *outReturnCode = -1;
         return false;
@@ -299,9 +299,9 @@ bool avdCurlPostRequest(const char *url, const char *postData, char **outRespons
     }
 
     if (outResponse) {
-        *outResponse = (char *)malloc(length + 1);
+        *outResponse = (char *)AVD_MALLOC(length + 1);
         if (*outResponse == NULL) {
-            free(buffer);
+            AVD_FREE(buffer);
             return false;
         }
 
@@ -309,7 +309,7 @@ bool avdCurlPostRequest(const char *url, const char *postData, char **outRespons
         (*outResponse)[length] = '\0';
     }
 
-    free(buffer);
+    AVD_FREE(buffer);
 
     return true;
 }
\ No newline at end of file
@@ -44,7 +44,7 @@ static bool PRIV_avdTestCurlDownloadToFile()
         return false;
     }
 
-    free(data);
+    AVD_FREE(data);
     remove(outputFile);
 
     AVD_LOG_DEBUG("    Curl download to file PASSED (downloaded %zu bytes)", size);
@@ -74,11 +74,11 @@ static bool PRIV_avdTestCurlDownloadToMemory()
     if (data == NULL || size == 0) {
         AVD_LOG_ERROR("    Downloaded data is NULL or empty");
         if (data)
-            free(data);
+            AVD_FREE(data);
         return false;
     }
 
-    free(data);
+    AVD_FREE(data);
 
     AVD_LOG_DEBUG("    Curl download to memory PASSED (downloaded %zu bytes)", size);
     return true;
@@ -106,18 +106,18 @@ static bool PRIV_avdTestCurlFetchStringContent()
     if (content == NULL || strlen(content) == 0) {
         AVD_LOG_ERROR("    Fetched content is NULL or empty");
         if (content)
-            free(content);
+            AVD_FREE(content);
         return false;
     }
 
     if (returnCode != 200) {
         AVD_LOG_ERROR("    Expected HTTP 200, got %d", returnCode);
-        free(content);
+        AVD_FREE(content);
         return false;
     }
 
     size_t contentLength = strlen(content);
-    free(content);
+    AVD_FREE(content);
 
     AVD_LOG_DEBUG("    Curl fetch string content PASSED (fetched %zu characters, HTTP %d)", contentLength, returnCode);
     return true;
@@ -141,7 +141,7 @@ static bool PRIV_avdTestCurlInvalidUrl()
     if (result) {
         AVD_LOG_ERROR("    Expected download to fail for invalid URL");
         if (data)
-            free(data);
+            AVD_FREE(data);
         return false;
     }
 
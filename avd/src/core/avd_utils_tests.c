@@ -0,0 +1,195 @@
+#include "core/avd_core.h"
+#include <string.h>
+
+// multiple of every page size in use, so a file of this size is never mapped
+#define AVD_UTILS_TEST_PAGE_ALIGNED_SIZE (64 * 1024)
+
+static bool PRIV_avdTestUtilsWriteFile(char *path, size_t pathSize, const char *name, AVD_Size size)
+{
+    snprintf(path, pathSize, "%savd_utils_test_%s.bin", avdGetTempDirPath(), name);
+
+    char *content = (char *)AVD_MALLOC(size + 1);
+    AVD_CHECK_MSG(content != NULL, "Failed to allocate test file content");
+    for (AVD_Size i = 0; i < size; i++) {
+        content[i] = (char)('a' + (i * 7) % 26);
+    }
+
+    FILE *file = fopen(path, "wb");
+    bool ok    = file != NULL && fwrite(content, 1, size, file) == size;
+    if (file != NULL) {
+        fclose(file);
+    }
+    AVD_FREE(content);
+    AVD_CHECK_MSG(ok, "Failed to write test file %s", path);
+    return true;
+}
+
+static bool PRIV_avdTestUtilsFileViewMatches(const AVD_FileView *view, AVD_Size size)
+{
+    const char *data = (const char *)view->data;
+    if (view->size != size || data[size] != '\0') {
+        AVD_LOG_ERROR("    FAILED: Expected %zu bytes followed by a NUL, got %zu", size, view->size);
+        return false;
+    }
+    for (AVD_Size i = 0; i < size; i++) {
+        if (data[i] != (char)('a' + (i * 7) % 26)) {
+            AVD_LOG_ERROR("    FAILED: File view differs from the file at byte %zu", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool PRIV_avdTestUtilsFileView()
+{
+    AVD_LOG_DEBUG("  Testing File view mapping and fallback...");
+
+    const struct {
+        const char *name;
+        AVD_Size size;
+        AVD_FileViewFlags flags;
+        bool expectMapped;
+    } cases[] = {
+        {"odd", 100003, AVD_FILE_VIEW_FLAG_SEQUENTIAL | AVD_FILE_VIEW_FLAG_WILL_NEED, true},
+        {"aligned", AVD_UTILS_TEST_PAGE_ALIGNED_SIZE, AVD_FILE_VIEW_FLAG_NONE, false},
+        {"read", 100003, AVD_FILE_VIEW_FLAG_NO_MAP, false},
+        {"empty", 0, AVD_FILE_VIEW_FLAG_NONE, false},
+    };
+
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(cases); i++) {
+        char path[1024];
+        AVD_CHECK(PRIV_avdTestUtilsWriteFile(path, sizeof(path), cases[i].name, cases[i].size));
+
+        AVD_FileView *view = NULL;
+        bool opened        = avdFileViewOpen(path, cases[i].flags, &view);
+        remove(path);
+        AVD_CHECK_MSG(opened, "Failed to open file view for the %s case", cases[i].name);
+
+        // the mapping must stay valid after the file is gone
+        bool ok = PRIV_avdTestUtilsFileViewMatches(view, cases[i].size);
+        if (ok && view->mapped != cases[i].expectMapped) {
+            AVD_LOG_ERROR("    FAILED: Expected the %s case to be %s", cases[i].name, cases[i].expectMapped ? "mapped" : "read");
+            ok = false;
+        }
+        avdFileViewRelease(view);
+        AVD_CHECK(ok);
+    }
+
+    AVD_FileView *missing = (AVD_FileView *)(uintptr_t)1;
+    AVD_LOG_DEBUG("    Expecting an error about a missing file:");
+    if (avdFileViewOpen("avd_utils_test_missing_file.bin", AVD_FILE_VIEW_FLAG_NONE, &missing) || missing != NULL) {
+        AVD_LOG_ERROR("    FAILED: Opening a missing file succeeded");
+        return false;
+    }
+
+    AVD_LOG_DEBUG("    File view mapping and fallback PASSED");
+    return true;
+}
+
+static bool PRIV_avdTestUtilsFileViewRefCount()
+{
+    AVD_LOG_DEBUG("  Testing File view reference counting...");
+
+    char path[1024];
+    AVD_CHECK(PRIV_avdTestUtilsWriteFile(path, sizeof(path), "refcount", 5000));
+
+    AVD_FileView *view = NULL;
+    bool opened        = avdFileViewOpen(path, AVD_FILE_VIEW_FLAG_NONE, &view);
+    remove(path);
+    AVD_CHECK_MSG(opened, "Failed to open file view");
+
+    AVD_FileView *parser = avdFileViewRetain(view);
+    avdFileViewRelease(view);
+
+    // the opener is gone, the parser reference keeps the data alive
+    bool ok = parser == view && avdAtomicLoad64(&parser->refCount) == 1 && PRIV_avdTestUtilsFileViewMatches(parser, 5000);
+    avdFileViewRelease(parser);
+    avdFileViewRelease(NULL);
+    AVD_CHECK_MSG(ok, "File view did not survive the release of its opener");
+
+    AVD_LOG_DEBUG("    File view reference counting PASSED");
+    return true;
+}
+
+bool avdUtilsTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Utils Tests...");
+
+    AVD_CHECK(PRIV_avdTestUtilsFileView());
+    AVD_CHECK(PRIV_avdTestUtilsFileViewRefCount());
+
+    AVD_LOG_DEBUG("All AVD Utils Tests PASSED");
+    return true;
+}
+
+typedef struct {
+    char path[1024];
+    AVD_Size size;
+    AVD_FileViewFlags flags;
+    AVD_Size checksum;
+} AVD_UtilsBenchmarkFile;
+
+// Touches every cache line like a parser would, page cache warm after warmup.
+static AVD_Size PRIV_avdUtilsBenchmarkConsume(const void *data, AVD_Size size)
+{
+    const AVD_UInt8 *bytes = (const AVD_UInt8 *)data;
+    AVD_Size checksum      = 0;
+    for (AVD_Size i = 0; i < size; i += 64) {
+        checksum += bytes[i];
+    }
+    return checksum;
+}
+
+static void PRIV_avdUtilsBenchmarkReadBinaryFile(void *userData)
+{
+    AVD_UtilsBenchmarkFile *file = (AVD_UtilsBenchmarkFile *)userData;
+    void *data                   = NULL;
+    size_t size                  = 0;
+    if (avdReadBinaryFile(file->path, &data, &size)) {
+        file->checksum += PRIV_avdUtilsBenchmarkConsume(data, size);
+        AVD_FREE(data);
+    }
+}
+
+static void PRIV_avdUtilsBenchmarkFileView(void *userData)
+{
+    AVD_UtilsBenchmarkFile *file = (AVD_UtilsBenchmarkFile *)userData;
+    AVD_FileView *view           = NULL;
+    if (avdFileViewOpen(file->path, file->flags, &view)) {
+        file->checksum += PRIV_avdUtilsBenchmarkConsume(view->data, view->size);
+        avdFileViewRelease(view);
+    }
+}
+
+bool avdUtilsBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD Utils benchmarks...");
+
+    // about the size of the larger OBJ assets, one byte short of a page multiple
+    static AVD_UtilsBenchmarkFile file = {0};
+    file.size                          = 64 * 1024 * 1024 - 1;
+    AVD_CHECK(PRIV_avdTestUtilsWriteFile(file.path, sizeof(file.path), "bench", file.size));
+
+    AVD_BenchCase readCase = {
+        .name               = "file/read_binary_file",
+        .unit               = "bytes",
+        .itemsPerRepetition = file.size,
+        .run                = PRIV_avdUtilsBenchmarkReadBinaryFile,
+        .userData           = &file,
+    };
+    AVD_BenchCase viewCase = {
+        .name               = "file/view_sequential",
+        .unit               = "bytes",
+        .itemsPerRepetition = file.size,
+        .run                = PRIV_avdUtilsBenchmarkFileView,
+        .userData           = &file,
+    };
+
+    file.flags = AVD_FILE_VIEW_FLAG_SEQUENTIAL;
+    bool ok    = avdBenchRun(bench, &readCase) && avdBenchRun(bench, &viewCase);
+    remove(file.path);
+
+    AVD_LOG_DEBUG("  File benchmark checksum %zu", file.checksum);
+    return ok;
+}
@@ -13,9 +13,6 @@
 #define CGLTF_IMPLEMENTATION
 #include "cgltf.h"
 
-#define TINYOBJ_LOADER_C_IMPLEMENTATION
-#include "tinyobj_loader_c.h"
-
 #ifdef AVD_DEBUG
 // This one is purely for the purpose of debugging (using DebugPrint functions of picoM3U8)
 #define PICO_M3U8_LOG(...)   \
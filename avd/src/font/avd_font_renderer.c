@@ -199,6 +199,10 @@ static bool PRIV_avdUpdateFontText(AVD_Vulkan *vulkan, AVD_RenderableText *rende
     renderableText->boundsMaxY = -1000000.0f;
     renderableText->numLines   = 1;
 
+    // the vertices are only staged here before being copied into the mapped buffer
+    AVD_FontRendererVertex *vertices = AVD_ARENA_PUSH_ARRAY(avdArenaFrame(), AVD_FontRendererVertex, 6 * renderableText->characterCount);
+    AVD_CHECK_MSG(vertices != NULL, "Failed to allocate staging vertices for renderable text");
+
     for (size_t i = 0; i < renderableText->characterCount; i++) {
         uint32_t c = (uint32_t)text[i];
         if (c == '\n') {
@@ -240,7 +244,7 @@ static bool PRIV_avdUpdateFontText(AVD_Vulkan *vulkan, AVD_RenderableText *rende
 
         cX += glyph->advanceX * charHeight;
 
-        AVD_FontRendererVertex *vertex = &renderableText->vertexBufferData[indexOffset];
+        AVD_FontRendererVertex *vertex = &vertices[indexOffset];
         AVD_CHECK(PRIV_avdSetCharQuad(vertex, ax, ay, bx, by,
                                       bounds->left / atlasWidth,
                                       bounds->top / atlasHeight,
@@ -257,7 +261,7 @@ static bool PRIV_avdUpdateFontText(AVD_Vulkan *vulkan, AVD_RenderableText *rende
 
     AVD_CHECK(avdVulkanBufferMap(vulkan, vertexBuffer, (void **)&mappedVertexBuffer));
     AVD_ASSERT(mappedVertexBuffer != NULL);
-    memcpy(mappedVertexBuffer, renderableText->vertexBufferData, vertexBuffer->descriptorBufferInfo.range);
+    memcpy(mappedVertexBuffer, vertices, sizeof(AVD_FontRendererVertex) * indexOffset);
     avdVulkanBufferUnmap(vulkan, vertexBuffer);
 
     return true;
@@ -286,9 +290,7 @@ bool avdRenderableTextCreate(AVD_RenderableText *renderableText, AVD_FontRendere
         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, // so that we can map it anc easy ly update it
         "Font/RenderableText/VertexBuffer"));
 
-    // create the vertex buffer data
-    renderableText->vertexBufferData = (AVD_FontRendererVertex *)malloc(currentSize);
-    renderableText->charHeight       = charHeight;
+    renderableText->charHeight = charHeight;
 
     // get the font data
     AVD_Font *font = NULL;
@@ -321,9 +323,6 @@ bool avdRenderableTextUpdate(AVD_RenderableText *renderableText, AVD_FontRendere
             VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, // so that we can map it and easily update it
             "Font/RenderableText/VertexBuffer"));
-
-        free(renderableText->vertexBufferData);
-        renderableText->vertexBufferData = (AVD_FontRendererVertex *)malloc(newSize);
     }
     // get the font data
     AVD_Font *font = NULL;
@@ -341,7 +340,6 @@ void avdRenderableTextDestroy(AVD_RenderableText *renderableText, AVD_Vulkan *vu
     AVD_ASSERT(vulkan != NULL);
 
     avdVulkanBufferDestroy(vulkan, &renderableText->vertexBuffer);
-    free(renderableText->vertexBufferData);
 }
 
 void avdRenderableTextGetBounds(AVD_RenderableText *renderableText, float *minX, float *minY, float *maxX, float *maxY)
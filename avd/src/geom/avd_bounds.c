@@ -0,0 +1,309 @@
+#include "geom/avd_bounds.h"
+
+void avdAABBExtend(AVD_AABB *aabb, const AVD_Vector3 point)
+{
+    AVD_ASSERT(aabb != NULL);
+
+    aabb->min.x = avdMin(aabb->min.x, point.x);
+    aabb->min.y = avdMin(aabb->min.y, point.y);
+    aabb->min.z = avdMin(aabb->min.z, point.z);
+    aabb->max.x = avdMax(aabb->max.x, point.x);
+    aabb->max.y = avdMax(aabb->max.y, point.y);
+    aabb->max.z = avdMax(aabb->max.z, point.z);
+}
+
+AVD_AABB avdAABBFromPoints(const AVD_Vector3 *points, AVD_Size count)
+{
+    AVD_ASSERT(points != NULL || count == 0);
+
+    AVD_AABB aabb = avdAABBEmpty();
+    for (AVD_Size i = 0; i < count; i++) {
+        avdAABBExtend(&aabb, points[i]);
+    }
+    return aabb;
+}
+
+AVD_AABB avdAABBTransform(const AVD_AABB *aabb, const AVD_Matrix4x4 *matrix)
+{
+    AVD_ASSERT(aabb != NULL && matrix != NULL);
+
+    if (avdAABBIsEmpty(*aabb)) {
+        return *aabb;
+    }
+
+    // the center moves as a point, every new half extent is the sum of the
+    // old ones projected onto that axis
+    AVD_Vector3 center  = avdAABBCenter(*aabb);
+    AVD_Vector3 extents = avdAABBExtents(*aabb);
+
+    AVD_Vector3 newCenter;
+    AVD_Vector3 newExtents;
+    for (int row = 0; row < 3; row++) {
+        newCenter.v[row] = avdMat4x4Val(*matrix, row, 0) * center.x +
+                           avdMat4x4Val(*matrix, row, 1) * center.y +
+                           avdMat4x4Val(*matrix, row, 2) * center.z +
+                           avdMat4x4Val(*matrix, row, 3);
+        newExtents.v[row] = avdAbs(avdMat4x4Val(*matrix, row, 0)) * extents.x +
+                            avdAbs(avdMat4x4Val(*matrix, row, 1)) * extents.y +
+                            avdAbs(avdMat4x4Val(*matrix, row, 2)) * extents.z;
+    }
+
+    return (AVD_AABB){
+        .min = avdVec3Subtract(newCenter, newExtents),
+        .max = avdVec3Add(newCenter, newExtents),
+    };
+}
+
+AVD_Sphere avdSphereFromAABB(const AVD_AABB *aabb)
+{
+    AVD_ASSERT(aabb != NULL);
+
+    if (avdAABBIsEmpty(*aabb)) {
+        // a sphere no plane test can pass
+        return (AVD_Sphere){.center = avdVec3Zero(), .radius = -FLT_MAX};
+    }
+
+    AVD_Vector3 extents = avdAABBExtents(*aabb);
+    return (AVD_Sphere){
+        .center = avdAABBCenter(*aabb),
+        .radius = avdVec3Length(extents),
+    };
+}
+
+AVD_Sphere avdSphereTransform(const AVD_Sphere *sphere, const AVD_Matrix4x4 *matrix)
+{
+    AVD_ASSERT(sphere != NULL && matrix != NULL);
+
+    AVD_Vector4 center = avdMat4x4MultiplyVec4(*matrix, avdVec4(sphere->center.x, sphere->center.y, sphere->center.z, 1.0f));
+
+    // the longest basis vector bounds the stretch in every direction
+    AVD_Float maxScaleSq = 0.0f;
+    for (int column = 0; column < 3; column++) {
+        AVD_Vector3 axis = avdVec3(avdMat4x4Val(*matrix, 0, column), avdMat4x4Val(*matrix, 1, column), avdMat4x4Val(*matrix, 2, column));
+        maxScaleSq       = avdMax(maxScaleSq, avdVec3LengthSq(axis));
+    }
+
+    return (AVD_Sphere){
+        .center = avdVec3(center.x, center.y, center.z),
+        .radius = sphere->radius * avdSqrt(maxScaleSq),
+    };
+}
+
+AVD_Plane avdPlaneNormalize(const AVD_Plane plane)
+{
+    AVD_Float length = avdVec3Length(plane.normal);
+    if (!(length > 0.0f)) {
+        return plane;
+    }
+    return (AVD_Plane){
+        .normal   = avdVec3Scale(plane.normal, 1.0f / length),
+        .distance = plane.distance / length,
+    };
+}
+
+AVD_Float avdPlaneDistance(const AVD_Plane *plane, const AVD_Vector3 point)
+{
+    AVD_ASSERT(plane != NULL);
+    return avdVec3Dot(plane->normal, point) + plane->distance;
+}
+
+static AVD_Plane PRIV_avdFrustumPlane(const AVD_Matrix4x4 *matrix, int row, AVD_Float sign)
+{
+    // w row plus or minus one of the other rows (Gribb and Hartmann)
+    AVD_Plane plane = {
+        .normal = avdVec3(
+            avdMat4x4Val(*matrix, 3, 0) + sign * avdMat4x4Val(*matrix, row, 0),
+            avdMat4x4Val(*matrix, 3, 1) + sign * avdMat4x4Val(*matrix, row, 1),
+            avdMat4x4Val(*matrix, 3, 2) + sign * avdMat4x4Val(*matrix, row, 2)),
+        .distance = avdMat4x4Val(*matrix, 3, 3) + sign * avdMat4x4Val(*matrix, row, 3),
+    };
+    return avdPlaneNormalize(plane);
+}
+
+AVD_Frustum avdFrustumFromMatrix(const AVD_Matrix4x4 *viewProjection)
+{
+    AVD_ASSERT(viewProjection != NULL);
+
+    // avdMatPerspective maps depth to [-1, 1], for a Vulkan style [0, 1]
+    // projection this near plane is behind the real one which only makes the
+    // culling more conservative
+    AVD_Frustum frustum;
+    frustum.planes[AVD_FRUSTUM_PLANE_LEFT]   = PRIV_avdFrustumPlane(viewProjection, 0, 1.0f);
+    frustum.planes[AVD_FRUSTUM_PLANE_RIGHT]  = PRIV_avdFrustumPlane(viewProjection, 0, -1.0f);
+    frustum.planes[AVD_FRUSTUM_PLANE_BOTTOM] = PRIV_avdFrustumPlane(viewProjection, 1, 1.0f);
+    frustum.planes[AVD_FRUSTUM_PLANE_TOP]    = PRIV_avdFrustumPlane(viewProjection, 1, -1.0f);
+    frustum.planes[AVD_FRUSTUM_PLANE_NEAR]   = PRIV_avdFrustumPlane(viewProjection, 2, 1.0f);
+    frustum.planes[AVD_FRUSTUM_PLANE_FAR]    = PRIV_avdFrustumPlane(viewProjection, 2, -1.0f);
+    return frustum;
+}
+
+bool avdFrustumTestAABB(const AVD_Frustum *frustum, const AVD_AABB *aabb)
+{
+    AVD_ASSERT(frustum != NULL && aabb != NULL);
+
+    if (avdAABBIsEmpty(*aabb)) {
+        return false;
+    }
+
+    AVD_Vector3 center  = avdAABBCenter(*aabb);
+    AVD_Vector3 extents = avdAABBExtents(*aabb);
+    for (int i = 0; i < AVD_FRUSTUM_PLANE_COUNT; i++) {
+        const AVD_Plane *plane = &frustum->planes[i];
+        // radius of the box projected onto the plane normal
+        AVD_Float radius = avdAbs(plane->normal.x) * extents.x + avdAbs(plane->normal.y) * extents.y + avdAbs(plane->normal.z) * extents.z;
+        if (avdPlaneDistance(plane, center) + radius < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool avdFrustumTestSphere(const AVD_Frustum *frustum, const AVD_Sphere *sphere)
+{
+    AVD_ASSERT(frustum != NULL && sphere != NULL);
+
+    for (int i = 0; i < AVD_FRUSTUM_PLANE_COUNT; i++) {
+        if (avdPlaneDistance(&frustum->planes[i], sphere->center) + sphere->radius < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool avdBoundsStreamsCreate(AVD_BoundsStreams *streams, AVD_Size capacity)
+{
+    AVD_ASSERT(streams != NULL);
+
+    *streams = (AVD_BoundsStreams){0};
+
+    AVD_Size streamSize = AVD_MAX(capacity, 1) * sizeof(AVD_Float);
+    AVD_UInt8 *block    = (AVD_UInt8 *)AVD_MALLOC(streamSize * 7);
+    AVD_CHECK_MSG(block != NULL, "Failed to allocate bounds streams for %zu entries", capacity);
+
+    streams->centerX  = (AVD_Float *)(block + streamSize * 0);
+    streams->centerY  = (AVD_Float *)(block + streamSize * 1);
+    streams->centerZ  = (AVD_Float *)(block + streamSize * 2);
+    streams->extentX  = (AVD_Float *)(block + streamSize * 3);
+    streams->extentY  = (AVD_Float *)(block + streamSize * 4);
+    streams->extentZ  = (AVD_Float *)(block + streamSize * 5);
+    streams->radius   = (AVD_Float *)(block + streamSize * 6);
+    streams->capacity = capacity;
+    return true;
+}
+
+void avdBoundsStreamsDestroy(AVD_BoundsStreams *streams)
+{
+    AVD_ASSERT(streams != NULL);
+    // centerX is the start of the block
+    if (streams->centerX != NULL) {
+        AVD_FREE(streams->centerX);
+    }
+    *streams = (AVD_BoundsStreams){0};
+}
+
+void avdBoundsStreamsSet(AVD_BoundsStreams *streams, AVD_Size index, const AVD_AABB *aabb, const AVD_Sphere *sphere)
+{
+    AVD_ASSERT(streams != NULL && aabb != NULL);
+    AVD_ASSERT(index < streams->capacity);
+
+    AVD_Vector3 center  = avdAABBCenter(*aabb);
+    AVD_Vector3 extents = avdAABBExtents(*aabb);
+    if (avdAABBIsEmpty(*aabb)) {
+        // far enough below zero that any plane distance stays negative, small
+        // enough that summing three of them does not overflow
+        center  = avdVec3Zero();
+        extents = avdVec3(-FLT_MAX / 4.0f, -FLT_MAX / 4.0f, -FLT_MAX / 4.0f);
+    }
+
+    streams->centerX[index] = center.x;
+    streams->centerY[index] = center.y;
+    streams->centerZ[index] = center.z;
+    streams->extentX[index] = extents.x;
+    streams->extentY[index] = extents.y;
+    streams->extentZ[index] = extents.z;
+    // without a sphere use the one around the box
+    streams->radius[index] = sphere != NULL ? sphere->radius : avdSphereFromAABB(aabb).radius;
+    streams->count         = AVD_MAX(streams->count, index + 1);
+}
+
+// Smallest signed distance of the entry to any plane, negative when it is
+// fully outside one of them. sphere selects the radius stream over the box.
+static AVD_Float PRIV_avdFrustumMinDistance(const AVD_Frustum *frustum, const AVD_BoundsStreams *streams, AVD_Size index, bool sphere)
+{
+    AVD_Vector3 center = avdVec3(streams->centerX[index], streams->centerY[index], streams->centerZ[index]);
+
+    AVD_Float minDistance = FLT_MAX;
+    for (int i = 0; i < AVD_FRUSTUM_PLANE_COUNT; i++) {
+        const AVD_Plane *plane = &frustum->planes[i];
+        AVD_Float radius       = sphere ? streams->radius[index]
+                                        : avdAbs(plane->normal.x) * streams->extentX[index] + avdAbs(plane->normal.y) * streams->extentY[index] + avdAbs(plane->normal.z) * streams->extentZ[index];
+        minDistance = avdMin(minDistance, avdPlaneDistance(plane, center) + radius);
+    }
+    return minDistance;
+}
+
+#if defined(AVD_MATH_SIMD)
+// Four entries per iteration, each plane is splatted once and every lane
+// keeps the smallest distance so there is no branch until the very end.
+static void PRIV_avdFrustumMinDistance4(const AVD_Frustum *frustum, const AVD_BoundsStreams *streams, AVD_Size first, bool sphere, AVD_Float *outDistances)
+{
+    AVD_SimdFloat4 centerX = avdSimdLoad(streams->centerX + first);
+    AVD_SimdFloat4 centerY = avdSimdLoad(streams->centerY + first);
+    AVD_SimdFloat4 centerZ = avdSimdLoad(streams->centerZ + first);
+    AVD_SimdFloat4 extentX = avdSimdLoad(streams->extentX + first);
+    AVD_SimdFloat4 extentY = avdSimdLoad(streams->extentY + first);
+    AVD_SimdFloat4 extentZ = avdSimdLoad(streams->extentZ + first);
+    AVD_SimdFloat4 radius  = avdSimdLoad(streams->radius + first);
+
+    AVD_SimdFloat4 minDistance = avdSimdSplat(FLT_MAX);
+    for (int i = 0; i < AVD_FRUSTUM_PLANE_COUNT; i++) {
+        const AVD_Plane *plane = &frustum->planes[i];
+
+        AVD_SimdFloat4 distance = avdSimdMulAdd(centerX, avdSimdSplat(plane->normal.x), avdSimdSplat(plane->distance));
+        distance                = avdSimdMulAdd(centerY, avdSimdSplat(plane->normal.y), distance);
+        distance                = avdSimdMulAdd(centerZ, avdSimdSplat(plane->normal.z), distance);
+
+        AVD_SimdFloat4 reach = radius;
+        if (!sphere) {
+            reach = avdSimdMul(extentX, avdSimdSplat(avdAbs(plane->normal.x)));
+            reach = avdSimdMulAdd(extentY, avdSimdSplat(avdAbs(plane->normal.y)), reach);
+            reach = avdSimdMulAdd(extentZ, avdSimdSplat(avdAbs(plane->normal.z)), reach);
+        }
+        minDistance = avdSimdMin(minDistance, avdSimdAdd(distance, reach));
+    }
+    avdSimdStore(outDistances, minDistance);
+}
+#endif
+
+static AVD_Size PRIV_avdFrustumCull(const AVD_Frustum *frustum, const AVD_BoundsStreams *streams, AVD_UInt32 *outVisible, bool sphere)
+{
+    AVD_ASSERT(frustum != NULL && streams != NULL && outVisible != NULL);
+
+    AVD_Size visibleCount = 0;
+    AVD_Size i            = 0;
+#if defined(AVD_MATH_SIMD)
+    AVD_Float distances[4];
+    for (; i + 4 <= streams->count; i += 4) {
+        PRIV_avdFrustumMinDistance4(frustum, streams, i, sphere, distances);
+        for (AVD_Size lane = 0; lane < 4; lane++) {
+            outVisible[visibleCount] = (AVD_UInt32)(i + lane);
+            visibleCount += distances[lane] >= 0.0f;
+        }
+    }
+#endif
+    for (; i < streams->count; i++) {
+        outVisible[visibleCount] = (AVD_UInt32)i;
+        visibleCount += PRIV_avdFrustumMinDistance(frustum, streams, i, sphere) >= 0.0f;
+    }
+    return visibleCount;
+}
+
+AVD_Size avdFrustumCullAABBs(const AVD_Frustum *frustum, const AVD_BoundsStreams *streams, AVD_UInt32 *outVisible)
+{
+    return PRIV_avdFrustumCull(frustum, streams, outVisible, false);
+}
+
+AVD_Size avdFrustumCullSpheres(const AVD_Frustum *frustum, const AVD_BoundsStreams *streams, AVD_UInt32 *outVisible)
+{
+    return PRIV_avdFrustumCull(frustum, streams, outVisible, true);
+}
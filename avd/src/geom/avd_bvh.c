@@ -0,0 +1,647 @@
+#include "geom/avd_bvh.h"
+#include "core/avd_atomic.h"
+#include "core/avd_jobs.h"
+
+#define AVD_BVH_NODE_ALIGNMENT 64
+#define AVD_BVH_DET_EPSILON    1e-10f
+
+typedef struct {
+    AVD_AABB bounds;
+    AVD_UInt32 count;
+} AVD_BvhBin;
+
+typedef struct {
+    AVD_Bvh *bvh;
+    const AVD_Vector3 *positions;
+    const AVD_UInt32 *indices;
+
+    // per input triangle
+    AVD_AABB *triangleBounds;
+    AVD_Vector3 *centroids;
+
+    volatile AVD_Int64 nodeCount;
+} AVD_BvhBuilder;
+
+typedef struct {
+    AVD_BvhBuilder *builder;
+    AVD_UInt32 nodeIndex;
+    AVD_UInt32 depth;
+} AVD_BvhBuildTask;
+
+static AVD_Float PRIV_avdBvhHalfArea(const AVD_AABB *aabb)
+{
+    if (avdAABBIsEmpty(*aabb)) {
+        return 0.0f;
+    }
+    AVD_Vector3 size = avdVec3Subtract(aabb->max, aabb->min);
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+static void PRIV_avdBvhTriangleVertices(const AVD_BvhBuilder *builder, AVD_Size triangle, AVD_Vector3 *outVertices)
+{
+    for (AVD_Size i = 0; i < 3; i++) {
+        AVD_Size index = builder->indices != NULL ? builder->indices[triangle * 3 + i] : triangle * 3 + i;
+        outVertices[i] = builder->positions[index];
+    }
+}
+
+static void PRIV_avdBvhPrepareTriangles(AVD_Size begin, AVD_Size end, void *userData)
+{
+    AVD_BvhBuilder *builder = (AVD_BvhBuilder *)userData;
+    for (AVD_Size i = begin; i < end; i++) {
+        AVD_Vector3 vertices[3];
+        PRIV_avdBvhTriangleVertices(builder, i, vertices);
+        builder->triangleBounds[i]   = avdAABBFromPoints(vertices, 3);
+        builder->centroids[i]        = avdAABBCenter(builder->triangleBounds[i]);
+        builder->bvh->triangleIds[i] = (AVD_UInt32)i;
+    }
+}
+
+static void PRIV_avdBvhStoreTriangles(AVD_Size begin, AVD_Size end, void *userData)
+{
+    AVD_BvhBuilder *builder = (AVD_BvhBuilder *)userData;
+    for (AVD_Size i = begin; i < end; i++) {
+        AVD_Vector3 vertices[3];
+        PRIV_avdBvhTriangleVertices(builder, builder->bvh->triangleIds[i], vertices);
+        builder->bvh->triangles[i] = (AVD_BvhTriangle){
+            .vertex0 = vertices[0],
+            .edge1   = avdVec3Subtract(vertices[1], vertices[0]),
+            .edge2   = avdVec3Subtract(vertices[2], vertices[0]),
+        };
+    }
+}
+
+static void PRIV_avdBvhNodeSetBounds(AVD_BvhNode *node, const AVD_AABB *bounds)
+{
+    node->boundsMin[0] = bounds->min.x;
+    node->boundsMin[1] = bounds->min.y;
+    node->boundsMin[2] = bounds->min.z;
+    node->boundsMax[0] = bounds->max.x;
+    node->boundsMax[1] = bounds->max.y;
+    node->boundsMax[2] = bounds->max.z;
+}
+
+static AVD_AABB PRIV_avdBvhNodeGetBounds(const AVD_BvhNode *node)
+{
+    return (AVD_AABB){
+        .min = avdVec3(node->boundsMin[0], node->boundsMin[1], node->boundsMin[2]),
+        .max = avdVec3(node->boundsMax[0], node->boundsMax[1], node->boundsMax[2]),
+    };
+}
+
+static AVD_Int32 PRIV_avdBvhBinIndex(AVD_Float centroid, AVD_Float minimum, AVD_Float scale)
+{
+    AVD_Int32 bin = (AVD_Int32)((centroid - minimum) * scale);
+    return AVD_MIN(AVD_MAX(bin, 0), AVD_BVH_BIN_COUNT - 1);
+}
+
+// Sweeps the bins of every axis for the plane with the lowest SAH cost, the
+// cost is relative and skips the constant traversal and area terms.
+static bool PRIV_avdBvhFindSplit(const AVD_BvhBuilder *builder, const AVD_BvhNode *node, const AVD_AABB *centroidBounds, AVD_Int32 *outAxis, AVD_Int32 *outBin, AVD_Float *outCost)
+{
+    const AVD_UInt32 *ids = builder->bvh->triangleIds + node->firstIndex;
+
+    bool found = false;
+    *outCost   = FLT_MAX;
+    for (AVD_Int32 axis = 0; axis < 3; axis++) {
+        AVD_Float minimum = centroidBounds->min.v[axis];
+        AVD_Float extent  = centroidBounds->max.v[axis] - minimum;
+        if (!(extent > 0.0f)) {
+            continue;
+        }
+        AVD_Float scale = (AVD_Float)AVD_BVH_BIN_COUNT / extent;
+
+        AVD_BvhBin bins[AVD_BVH_BIN_COUNT];
+        for (AVD_Int32 b = 0; b < AVD_BVH_BIN_COUNT; b++) {
+            bins[b] = (AVD_BvhBin){.bounds = avdAABBEmpty(), .count = 0};
+        }
+        for (AVD_UInt32 i = 0; i < node->triangleCount; i++) {
+            AVD_BvhBin *bin    = &bins[PRIV_avdBvhBinIndex(builder->centroids[ids[i]].v[axis], minimum, scale)];
+            const AVD_AABB *tb = &builder->triangleBounds[ids[i]];
+            avdAABBExtend(&bin->bounds, tb->min);
+            avdAABBExtend(&bin->bounds, tb->max);
+            bin->count++;
+        }
+
+        // left to right sums first, then the right side while walking back
+        AVD_Float leftArea[AVD_BVH_BIN_COUNT - 1];
+        AVD_UInt32 leftCount[AVD_BVH_BIN_COUNT - 1];
+        AVD_AABB accumulated = avdAABBEmpty();
+        AVD_UInt32 count     = 0;
+        for (AVD_Int32 b = 0; b < AVD_BVH_BIN_COUNT - 1; b++) {
+            if (bins[b].count > 0) {
+                avdAABBExtend(&accumulated, bins[b].bounds.min);
+                avdAABBExtend(&accumulated, bins[b].bounds.max);
+            }
+            count += bins[b].count;
+            leftArea[b]  = PRIV_avdBvhHalfArea(&accumulated);
+            leftCount[b] = count;
+        }
+
+        accumulated = avdAABBEmpty();
+        count       = 0;
+        for (AVD_Int32 b = AVD_BVH_BIN_COUNT - 1; b > 0; b--) {
+            if (bins[b].count > 0) {
+                avdAABBExtend(&accumulated, bins[b].bounds.min);
+                avdAABBExtend(&accumulated, bins[b].bounds.max);
+            }
+            count += bins[b].count;
+            if (count == 0 || leftCount[b - 1] == 0) {
+                continue;
+            }
+            AVD_Float cost = leftArea[b - 1] * (AVD_Float)leftCount[b - 1] + PRIV_avdBvhHalfArea(&accumulated) * (AVD_Float)count;
+            if (cost < *outCost) {
+                *outCost = cost;
+                *outAxis = axis;
+                *outBin  = b - 1;
+                found    = true;
+            }
+        }
+    }
+    return found;
+}
+
+static void PRIV_avdBvhSubdivide(AVD_BvhBuilder *builder, AVD_UInt32 nodeIndex, AVD_UInt32 depth);
+
+static void PRIV_avdBvhSubdivideJob(void *userData)
+{
+    AVD_BvhBuildTask *task = (AVD_BvhBuildTask *)userData;
+    PRIV_avdBvhSubdivide(task->builder, task->nodeIndex, task->depth);
+}
+
+static void PRIV_avdBvhSubdivide(AVD_BvhBuilder *builder, AVD_UInt32 nodeIndex, AVD_UInt32 depth)
+{
+    AVD_Bvh *bvh      = builder->bvh;
+    AVD_BvhNode *node = &bvh->nodes[nodeIndex];
+    AVD_UInt32 *ids   = bvh->triangleIds + node->firstIndex;
+
+    AVD_AABB bounds         = avdAABBEmpty();
+    AVD_AABB centroidBounds = avdAABBEmpty();
+    for (AVD_UInt32 i = 0; i < node->triangleCount; i++) {
+        avdAABBExtend(&bounds, builder->triangleBounds[ids[i]].min);
+        avdAABBExtend(&bounds, builder->triangleBounds[ids[i]].max);
+        avdAABBExtend(&centroidBounds, builder->centroids[ids[i]]);
+    }
+    PRIV_avdBvhNodeSetBounds(node, &bounds);
+
+    // the traversal stacks hold one entry per level
+    if (node->triangleCount <= AVD_BVH_MAX_LEAF_TRIANGLES || depth + 2 >= AVD_BVH_MAX_DEPTH) {
+        return;
+    }
+
+    AVD_Int32 axis  = 0;
+    AVD_Int32 bin   = 0;
+    AVD_Float cost  = 0.0f;
+    AVD_UInt32 left = 0;
+    if (PRIV_avdBvhFindSplit(builder, node, &centroidBounds, &axis, &bin, &cost)) {
+        if (cost >= PRIV_avdBvhHalfArea(&bounds) * (AVD_Float)node->triangleCount) {
+            return;
+        }
+
+        AVD_Float minimum = centroidBounds.min.v[axis];
+        AVD_Float scale   = (AVD_Float)AVD_BVH_BIN_COUNT / (centroidBounds.max.v[axis] - minimum);
+        AVD_UInt32 right  = node->triangleCount;
+        while (left < right) {
+            if (PRIV_avdBvhBinIndex(builder->centroids[ids[left]].v[axis], minimum, scale) <= bin) {
+                left++;
+            } else {
+                AVD_UInt32 swap = ids[left];
+                ids[left]       = ids[--right];
+                ids[right]      = swap;
+            }
+        }
+    } else {
+        // every centroid in the same spot, halving keeps the leaves small
+        left = node->triangleCount / 2;
+    }
+
+    AVD_UInt32 childIndex = (AVD_UInt32)avdAtomicAdd64(&builder->nodeCount, 2) - 2;
+    AVD_BvhNode *children = &bvh->nodes[childIndex];
+    children[0]           = (AVD_BvhNode){.firstIndex = node->firstIndex, .triangleCount = left};
+    children[1]           = (AVD_BvhNode){.firstIndex = node->firstIndex + left, .triangleCount = node->triangleCount - left};
+    node->firstIndex      = childIndex;
+    node->triangleCount   = 0;
+
+    if (children[0].triangleCount >= AVD_BVH_PARALLEL_THRESHOLD && avdJobsIsInitialized()) {
+        AVD_BvhBuildTask task  = {.builder = builder, .nodeIndex = childIndex, .depth = depth + 1};
+        AVD_Job job            = {.function = PRIV_avdBvhSubdivideJob, .userData = &task};
+        AVD_JobCounter counter = {0};
+        avdJobsRun(&job, 1, &counter);
+        PRIV_avdBvhSubdivide(builder, childIndex + 1, depth + 1);
+        avdJobsWait(&counter);
+    } else {
+        PRIV_avdBvhSubdivide(builder, childIndex, depth + 1);
+        PRIV_avdBvhSubdivide(builder, childIndex + 1, depth + 1);
+    }
+}
+
+bool avdBvhBuild(AVD_Bvh *bvh, const AVD_Vector3 *positions, const AVD_UInt32 *indices, AVD_Size triangleCount)
+{
+    AVD_ASSERT(bvh != NULL);
+    AVD_ASSERT(positions != NULL || triangleCount == 0);
+
+    memset(bvh, 0, sizeof(AVD_Bvh));
+    AVD_CHECK_MSG(triangleCount < AVD_BVH_NO_HIT / 2, "Too many triangles for a BVH: %zu", triangleCount);
+
+    // node 1 stays unused so that siblings share a cache line
+    AVD_Size nodeCapacity = AVD_MAX(triangleCount * 2, (AVD_Size)2);
+    bvh->nodes            = (AVD_BvhNode *)AVD_ALIGNED_ALLOC(AVD_BVH_NODE_ALIGNMENT, nodeCapacity * sizeof(AVD_BvhNode));
+    bvh->triangles        = (AVD_BvhTriangle *)AVD_MALLOC(AVD_MAX(triangleCount, (AVD_Size)1) * sizeof(AVD_BvhTriangle));
+    bvh->triangleIds      = (AVD_UInt32 *)AVD_MALLOC(AVD_MAX(triangleCount, (AVD_Size)1) * sizeof(AVD_UInt32));
+    bvh->triangleCount    = triangleCount;
+
+    AVD_BvhBuilder builder = {
+        .bvh            = bvh,
+        .positions      = positions,
+        .indices        = indices,
+        .triangleBounds = (AVD_AABB *)AVD_MALLOC(AVD_MAX(triangleCount, (AVD_Size)1) * sizeof(AVD_AABB)),
+        .centroids      = (AVD_Vector3 *)AVD_MALLOC(AVD_MAX(triangleCount, (AVD_Size)1) * sizeof(AVD_Vector3)),
+        .nodeCount      = 2,
+    };
+    if (bvh->nodes == NULL || bvh->triangles == NULL || bvh->triangleIds == NULL || builder.triangleBounds == NULL || builder.centroids == NULL) {
+        if (builder.triangleBounds != NULL) {
+            AVD_FREE(builder.triangleBounds);
+        }
+        if (builder.centroids != NULL) {
+            AVD_FREE(builder.centroids);
+        }
+        avdBvhDestroy(bvh);
+        AVD_LOG_ERROR("Failed to allocate a BVH for %zu triangles", triangleCount);
+        return false;
+    }
+
+    avdJobsParallelFor(triangleCount, 0, PRIV_avdBvhPrepareTriangles, &builder);
+
+    bvh->nodes[0] = (AVD_BvhNode){.firstIndex = 0, .triangleCount = (AVD_UInt32)triangleCount};
+    bvh->nodes[1] = (AVD_BvhNode){0};
+    PRIV_avdBvhSubdivide(&builder, 0, 0);
+    bvh->nodeCount = (AVD_Size)builder.nodeCount;
+
+    avdJobsParallelFor(triangleCount, 0, PRIV_avdBvhStoreTriangles, &builder);
+
+    AVD_FREE(builder.triangleBounds);
+    AVD_FREE(builder.centroids);
+    return true;
+}
+
+void avdBvhDestroy(AVD_Bvh *bvh)
+{
+    AVD_ASSERT(bvh != NULL);
+    if (bvh->nodes != NULL) {
+        AVD_ALIGNED_FREE(bvh->nodes);
+    }
+    if (bvh->triangles != NULL) {
+        AVD_FREE(bvh->triangles);
+    }
+    if (bvh->triangleIds != NULL) {
+        AVD_FREE(bvh->triangleIds);
+    }
+    memset(bvh, 0, sizeof(AVD_Bvh));
+}
+
+AVD_AABB avdBvhBounds(const AVD_Bvh *bvh)
+{
+    AVD_ASSERT(bvh != NULL);
+    if (bvh->nodes == NULL || bvh->triangleCount == 0) {
+        return avdAABBEmpty();
+    }
+    return PRIV_avdBvhNodeGetBounds(&bvh->nodes[0]);
+}
+
+// Entry distance of the ray into the node, FLT_MAX when it misses or the
+// node starts past tMax.
+static inline AVD_Float PRIV_avdBvhRayNode(const AVD_BvhNode *node, const AVD_Vector3 *origin, const AVD_Vector3 *inverse, AVD_Float tMax)
+{
+    AVD_Float tx1  = (node->boundsMin[0] - origin->x) * inverse->x;
+    AVD_Float tx2  = (node->boundsMax[0] - origin->x) * inverse->x;
+    AVD_Float ty1  = (node->boundsMin[1] - origin->y) * inverse->y;
+    AVD_Float ty2  = (node->boundsMax[1] - origin->y) * inverse->y;
+    AVD_Float tz1  = (node->boundsMin[2] - origin->z) * inverse->z;
+    AVD_Float tz2  = (node->boundsMax[2] - origin->z) * inverse->z;
+    AVD_Float tmin = avdMax(avdMax(avdMin(tx1, tx2), avdMin(ty1, ty2)), avdMax(avdMin(tz1, tz2), 0.0f));
+    AVD_Float tmax = avdMin(avdMin(avdMax(tx1, tx2), avdMax(ty1, ty2)), avdMin(avdMax(tz1, tz2), tMax));
+    return tmin <= tmax ? tmin : FLT_MAX;
+}
+
+static inline bool PRIV_avdBvhRayTriangle(const AVD_BvhTriangle *triangle, const AVD_Ray *ray, AVD_Float tMax, AVD_RayHit *outHit)
+{
+    AVD_Vector3 pvec = avdVec3Cross(ray->direction, triangle->edge2);
+    AVD_Float det    = avdVec3Dot(triangle->edge1, pvec);
+    if (det > -AVD_BVH_DET_EPSILON && det < AVD_BVH_DET_EPSILON) {
+        return false;
+    }
+
+    AVD_Float inverseDet = 1.0f / det;
+    AVD_Vector3 tvec     = avdVec3Subtract(ray->origin, triangle->vertex0);
+    AVD_Float u          = avdVec3Dot(tvec, pvec) * inverseDet;
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+
+    AVD_Vector3 qvec = avdVec3Cross(tvec, triangle->edge1);
+    AVD_Float v      = avdVec3Dot(ray->direction, qvec) * inverseDet;
+    if (v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+
+    AVD_Float t = avdVec3Dot(triangle->edge2, qvec) * inverseDet;
+    if (!(t > 0.0f && t < tMax)) {
+        return false;
+    }
+    outHit->t = t;
+    outHit->u = u;
+    outHit->v = v;
+    return true;
+}
+
+// Ordered traversal, the nearer child is visited first and the farther one
+// is only pushed when the ray enters it before the closest hit so far.
+static bool PRIV_avdBvhTraverse(const AVD_Bvh *bvh, const AVD_Ray *ray, bool anyHit, AVD_RayHit *outHit)
+{
+    outHit->t        = ray->tMax;
+    outHit->u        = 0.0f;
+    outHit->v        = 0.0f;
+    outHit->triangle = AVD_BVH_NO_HIT;
+    if (bvh->triangleCount == 0) {
+        return false;
+    }
+
+    AVD_Vector3 inverse = avdVec3(1.0f / ray->direction.x, 1.0f / ray->direction.y, 1.0f / ray->direction.z);
+    if (PRIV_avdBvhRayNode(&bvh->nodes[0], &ray->origin, &inverse, outHit->t) == FLT_MAX) {
+        return false;
+    }
+
+    const AVD_BvhNode *stack[AVD_BVH_MAX_DEPTH];
+    AVD_Size stackSize      = 0;
+    const AVD_BvhNode *node = &bvh->nodes[0];
+    while (true) {
+        if (node->triangleCount > 0) {
+            for (AVD_UInt32 i = 0; i < node->triangleCount; i++) {
+                AVD_UInt32 index = node->firstIndex + i;
+                if (PRIV_avdBvhRayTriangle(&bvh->triangles[index], ray, outHit->t, outHit)) {
+                    outHit->triangle = bvh->triangleIds[index];
+                    if (anyHit) {
+                        return true;
+                    }
+                }
+            }
+            if (stackSize == 0) {
+                break;
+            }
+            node = stack[--stackSize];
+            continue;
+        }
+
+        const AVD_BvhNode *near = &bvh->nodes[node->firstIndex];
+        const AVD_BvhNode *far  = near + 1;
+        AVD_Float nearDistance  = PRIV_avdBvhRayNode(near, &ray->origin, &inverse, outHit->t);
+        AVD_Float farDistance   = PRIV_avdBvhRayNode(far, &ray->origin, &inverse, outHit->t);
+        if (nearDistance > farDistance) {
+            const AVD_BvhNode *swapNode = near;
+            AVD_Float swapDistance      = nearDistance;
+            near                        = far;
+            nearDistance                = farDistance;
+            far                         = swapNode;
+            farDistance                 = swapDistance;
+        }
+
+        if (nearDistance == FLT_MAX) {
+            if (stackSize == 0) {
+                break;
+            }
+            node = stack[--stackSize];
+        } else {
+            node = near;
+            if (farDistance != FLT_MAX) {
+                stack[stackSize++] = far;
+            }
+        }
+    }
+    return outHit->triangle != AVD_BVH_NO_HIT;
+}
+
+bool avdBvhIntersect(const AVD_Bvh *bvh, const AVD_Ray *ray, AVD_RayHit *outHit)
+{
+    AVD_ASSERT(bvh != NULL && ray != NULL && outHit != NULL);
+    return PRIV_avdBvhTraverse(bvh, ray, false, outHit);
+}
+
+bool avdBvhOccluded(const AVD_Bvh *bvh, const AVD_Ray *ray)
+{
+    AVD_ASSERT(bvh != NULL && ray != NULL);
+    AVD_RayHit hit;
+    return PRIV_avdBvhTraverse(bvh, ray, true, &hit);
+}
+
+#if defined(AVD_MATH_SIMD)
+// Up to four rays in structure of arrays form, lanes past the end of the input
+// start inactive. tMax, u, v and triangles hold the closest hits found so far.
+typedef struct {
+    AVD_SimdFloat4 originX, originY, originZ;
+    AVD_SimdFloat4 directionX, directionY, directionZ;
+    AVD_SimdFloat4 inverseX, inverseY, inverseZ;
+    AVD_SimdFloat4 tMax, u, v;
+    AVD_SimdFloat4 active;
+    AVD_Vector3 directionSum;
+    AVD_UInt32 triangles[AVD_BVH_RAY_PACKET];
+} AVD_BvhRayPacket;
+
+static void PRIV_avdBvhPacketLoad(AVD_BvhRayPacket *packet, const AVD_Ray *rays, AVD_Size count)
+{
+    AVD_Float lanes[10][AVD_BVH_RAY_PACKET];
+    AVD_UInt32 activeLanes[AVD_BVH_RAY_PACKET];
+    packet->directionSum = avdVec3Zero();
+    for (AVD_Size i = 0; i < AVD_BVH_RAY_PACKET; i++) {
+        // padding lanes repeat the first ray so they cannot produce NaNs
+        const AVD_Ray *ray = &rays[i < count ? i : 0];
+        lanes[0][i]        = ray->origin.x;
+        lanes[1][i]        = ray->origin.y;
+        lanes[2][i]        = ray->origin.z;
+        lanes[3][i]        = ray->direction.x;
+        lanes[4][i]        = ray->direction.y;
+        lanes[5][i]        = ray->direction.z;
+        lanes[6][i]        = 1.0f / ray->direction.x;
+        lanes[7][i]        = 1.0f / ray->direction.y;
+        lanes[8][i]        = 1.0f / ray->direction.z;
+        lanes[9][i]        = ray->tMax;
+        activeLanes[i]     = i < count ? 0xFFFFFFFFu : 0u;
+
+        packet->triangles[i] = AVD_BVH_NO_HIT;
+        packet->directionSum = avdVec3Add(packet->directionSum, ray->direction);
+    }
+
+    packet->originX    = avdSimdLoad(lanes[0]);
+    packet->originY    = avdSimdLoad(lanes[1]);
+    packet->originZ    = avdSimdLoad(lanes[2]);
+    packet->directionX = avdSimdLoad(lanes[3]);
+    packet->directionY = avdSimdLoad(lanes[4]);
+    packet->directionZ = avdSimdLoad(lanes[5]);
+    packet->inverseX   = avdSimdLoad(lanes[6]);
+    packet->inverseY   = avdSimdLoad(lanes[7]);
+    packet->inverseZ   = avdSimdLoad(lanes[8]);
+    packet->tMax       = avdSimdLoad(lanes[9]);
+    packet->u          = avdSimdSplat(0.0f);
+    packet->v          = avdSimdSplat(0.0f);
+
+    AVD_Float activeFloats[AVD_BVH_RAY_PACKET];
+    memcpy(activeFloats, activeLanes, sizeof(activeFloats));
+    packet->active = avdSimdLoad(activeFloats);
+}
+
+// Bit mask of the active lanes that enter the node before their tMax.
+static inline int PRIV_avdBvhPacketNode(const AVD_BvhNode *node, const AVD_BvhRayPacket *packet)
+{
+    AVD_SimdFloat4 tx1  = avdSimdMul(avdSimdSub(avdSimdSplat(node->boundsMin[0]), packet->originX), packet->inverseX);
+    AVD_SimdFloat4 tx2  = avdSimdMul(avdSimdSub(avdSimdSplat(node->boundsMax[0]), packet->originX), packet->inverseX);
+    AVD_SimdFloat4 ty1  = avdSimdMul(avdSimdSub(avdSimdSplat(node->boundsMin[1]), packet->originY), packet->inverseY);
+    AVD_SimdFloat4 ty2  = avdSimdMul(avdSimdSub(avdSimdSplat(node->boundsMax[1]), packet->originY), packet->inverseY);
+    AVD_SimdFloat4 tz1  = avdSimdMul(avdSimdSub(avdSimdSplat(node->boundsMin[2]), packet->originZ), packet->inverseZ);
+    AVD_SimdFloat4 tz2  = avdSimdMul(avdSimdSub(avdSimdSplat(node->boundsMax[2]), packet->originZ), packet->inverseZ);
+    AVD_SimdFloat4 tmin = avdSimdMax(avdSimdMax(avdSimdMin(tx1, tx2), avdSimdMin(ty1, ty2)), avdSimdMax(avdSimdMin(tz1, tz2), avdSimdSplat(0.0f)));
+    AVD_SimdFloat4 tmax = avdSimdMin(avdSimdMin(avdSimdMax(tx1, tx2), avdSimdMax(ty1, ty2)), avdSimdMin(avdSimdMax(tz1, tz2), packet->tMax));
+    return avdSimdMask(avdSimdAnd(avdSimdLessEqual(tmin, tmax), packet->active));
+}
+
+// Same test as PRIV_avdBvhRayTriangle for all four lanes, returns the mask
+// of the lanes that got a closer hit. With anyHit those lanes are retired.
+static inline int PRIV_avdBvhPacketTriangle(const AVD_BvhTriangle *triangle, AVD_UInt32 triangleId, AVD_BvhRayPacket *packet, bool anyHit)
+{
+    AVD_SimdFloat4 edge1X = avdSimdSplat(triangle->edge1.x);
+    AVD_SimdFloat4 edge1Y = avdSimdSplat(triangle->edge1.y);
+    AVD_SimdFloat4 edge1Z = avdSimdSplat(triangle->edge1.z);
+    AVD_SimdFloat4 edge2X = avdSimdSplat(triangle->edge2.x);
+    AVD_SimdFloat4 edge2Y = avdSimdSplat(triangle->edge2.y);
+    AVD_SimdFloat4 edge2Z = avdSimdSplat(triangle->edge2.z);
+
+    AVD_SimdFloat4 pvecX = avdSimdSub(avdSimdMul(packet->directionY, edge2Z), avdSimdMul(packet->directionZ, edge2Y));
+    AVD_SimdFloat4 pvecY = avdSimdSub(avdSimdMul(packet->directionZ, edge2X), avdSimdMul(packet->directionX, edge2Z));
+    AVD_SimdFloat4 pvecZ = avdSimdSub(avdSimdMul(packet->directionX, edge2Y), avdSimdMul(packet->directionY, edge2X));
+    AVD_SimdFloat4 det   = avdSimdMulAdd(edge1X, pvecX, avdSimdMulAdd(edge1Y, pvecY, avdSimdMul(edge1Z, pvecZ)));
+
+    AVD_SimdFloat4 inverseDet = avdSimdDiv(avdSimdSplat(1.0f), det);
+    AVD_SimdFloat4 tvecX      = avdSimdSub(packet->originX, avdSimdSplat(triangle->vertex0.x));
+    AVD_SimdFloat4 tvecY      = avdSimdSub(packet->originY, avdSimdSplat(triangle->vertex0.y));
+    AVD_SimdFloat4 tvecZ      = avdSimdSub(packet->originZ, avdSimdSplat(triangle->vertex0.z));
+    AVD_SimdFloat4 u          = avdSimdMul(avdSimdMulAdd(tvecX, pvecX, avdSimdMulAdd(tvecY, pvecY, avdSimdMul(tvecZ, pvecZ))), inverseDet);
+
+    AVD_SimdFloat4 qvecX = avdSimdSub(avdSimdMul(tvecY, edge1Z), avdSimdMul(tvecZ, edge1Y));
+    AVD_SimdFloat4 qvecY = avdSimdSub(avdSimdMul(tvecZ, edge1X), avdSimdMul(tvecX, edge1Z));
+    AVD_SimdFloat4 qvecZ = avdSimdSub(avdSimdMul(tvecX, edge1Y), avdSimdMul(tvecY, edge1X));
+    AVD_SimdFloat4 v     = avdSimdMul(avdSimdMulAdd(packet->directionX, qvecX, avdSimdMulAdd(packet->directionY, qvecY, avdSimdMul(packet->directionZ, qvecZ))), inverseDet);
+    AVD_SimdFloat4 t     = avdSimdMul(avdSimdMulAdd(edge2X, qvecX, avdSimdMulAdd(edge2Y, qvecY, avdSimdMul(edge2Z, qvecZ))), inverseDet);
+
+    AVD_SimdFloat4 zero   = avdSimdSplat(0.0f);
+    AVD_SimdFloat4 absDet = avdSimdMax(det, avdSimdSub(zero, det));
+    AVD_SimdFloat4 hit    = avdSimdAnd(packet->active, avdSimdLess(avdSimdSplat(AVD_BVH_DET_EPSILON), absDet));
+    hit                   = avdSimdAnd(hit, avdSimdAnd(avdSimdLessEqual(zero, u), avdSimdLessEqual(zero, v)));
+    hit                   = avdSimdAnd(hit, avdSimdLessEqual(avdSimdAdd(u, v), avdSimdSplat(1.0f)));
+    hit                   = avdSimdAnd(hit, avdSimdAnd(avdSimdLess(zero, t), avdSimdLess(t, packet->tMax)));
+
+    int mask = avdSimdMask(hit);
+    if (mask != 0) {
+        packet->tMax = avdSimdSelect(hit, t, packet->tMax);
+        packet->u    = avdSimdSelect(hit, u, packet->u);
+        packet->v    = avdSimdSelect(hit, v, packet->v);
+        if (anyHit) {
+            // lanes that found a hit are done
+            packet->active = avdSimdAndNot(packet->active, hit);
+        }
+        for (AVD_Size lane = 0; lane < AVD_BVH_RAY_PACKET; lane++) {
+            if (mask & (1 << lane)) {
+                packet->triangles[lane] = triangleId;
+            }
+        }
+    }
+    return mask;
+}
+
+// The packet walks the tree as a whole and a node is entered as long as one
+// lane hits it. Children are ordered by the summed direction of the packet,
+// which is the same order every lane would pick when they are coherent.
+static void PRIV_avdBvhTraversePacket(const AVD_Bvh *bvh, AVD_BvhRayPacket *packet, bool anyHit)
+{
+    if (bvh->triangleCount == 0) {
+        return;
+    }
+
+    AVD_UInt32 stack[AVD_BVH_MAX_DEPTH + 1];
+    AVD_Size stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const AVD_BvhNode *node = &bvh->nodes[stack[--stackSize]];
+        if (PRIV_avdBvhPacketNode(node, packet) == 0) {
+            continue;
+        }
+
+        if (node->triangleCount > 0) {
+            for (AVD_UInt32 i = 0; i < node->triangleCount; i++) {
+                AVD_UInt32 index = node->firstIndex + i;
+                int mask         = PRIV_avdBvhPacketTriangle(&bvh->triangles[index], bvh->triangleIds[index], packet, anyHit);
+                if (anyHit && mask != 0 && avdSimdMask(packet->active) == 0) {
+                    return;
+                }
+            }
+            continue;
+        }
+
+        const AVD_BvhNode *first  = &bvh->nodes[node->firstIndex];
+        const AVD_BvhNode *second = first + 1;
+        AVD_Float order           = 0.0f;
+        for (int axis = 0; axis < 3; axis++) {
+            order += packet->directionSum.v[axis] * ((second->boundsMin[axis] + second->boundsMax[axis]) - (first->boundsMin[axis] + first->boundsMax[axis]));
+        }
+        // the nearer child goes on top of the stack
+        stack[stackSize++] = order >= 0.0f ? node->firstIndex + 1 : node->firstIndex;
+        stack[stackSize++] = order >= 0.0f ? node->firstIndex : node->firstIndex + 1;
+    }
+}
+#endif
+
+void avdBvhIntersectRays(const AVD_Bvh *bvh, const AVD_Ray *rays, AVD_Size count, AVD_RayHit *outHits)
+{
+    AVD_ASSERT(bvh != NULL && ((rays != NULL && outHits != NULL) || count == 0));
+
+#if defined(AVD_MATH_SIMD)
+    for (AVD_Size first = 0; first < count; first += AVD_BVH_RAY_PACKET) {
+        AVD_Size packetCount = AVD_MIN(count - first, (AVD_Size)AVD_BVH_RAY_PACKET);
+
+        AVD_BvhRayPacket packet;
+        PRIV_avdBvhPacketLoad(&packet, rays + first, packetCount);
+        PRIV_avdBvhTraversePacket(bvh, &packet, false);
+
+        AVD_Float t[AVD_BVH_RAY_PACKET], u[AVD_BVH_RAY_PACKET], v[AVD_BVH_RAY_PACKET];
+        avdSimdStore(t, packet.tMax);
+        avdSimdStore(u, packet.u);
+        avdSimdStore(v, packet.v);
+        for (AVD_Size lane = 0; lane < packetCount; lane++) {
+            outHits[first + lane] = (AVD_RayHit){.t = t[lane], .u = u[lane], .v = v[lane], .triangle = packet.triangles[lane]};
+        }
+    }
+#else
+    for (AVD_Size i = 0; i < count; i++) {
+        PRIV_avdBvhTraverse(bvh, &rays[i], false, &outHits[i]);
+    }
+#endif
+}
+
+void avdBvhOccludedRays(const AVD_Bvh *bvh, const AVD_Ray *rays, AVD_Size count, bool *outOccluded)
+{
+    AVD_ASSERT(bvh != NULL && ((rays != NULL && outOccluded != NULL) || count == 0));
+
+#if defined(AVD_MATH_SIMD)
+    for (AVD_Size first = 0; first < count; first += AVD_BVH_RAY_PACKET) {
+        AVD_Size packetCount = AVD_MIN(count - first, (AVD_Size)AVD_BVH_RAY_PACKET);
+
+        AVD_BvhRayPacket packet;
+        PRIV_avdBvhPacketLoad(&packet, rays + first, packetCount);
+        PRIV_avdBvhTraversePacket(bvh, &packet, true);
+        for (AVD_Size lane = 0; lane < packetCount; lane++) {
+            outOccluded[first + lane] = packet.triangles[lane] != AVD_BVH_NO_HIT;
+        }
+    }
+#else
+    for (AVD_Size i = 0; i < count; i++) {
+        outOccluded[i] = avdBvhOccluded(bvh, &rays[i]);
+    }
+#endif
+}
@@ -0,0 +1,561 @@
+#include "core/avd_core.h"
+#include "geom/avd_bvh.h"
+#include "model/avd_model.h"
+
+#define AVD_BVH_TEST_RAYS    1001
+#define AVD_BVH_TEST_SOUP    2000
+#define AVD_BVH_TEST_WORKERS 3
+#define AVD_BVH_BENCH_RAYS_X 256
+#define AVD_BVH_BENCH_RAYS_Y 256
+
+static AVD_Float PRIV_avdBvhRandom(AVD_UInt32 *state, AVD_Float range)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return ((AVD_Float)(*state >> 8) / (AVD_Float)(1u << 24) * 2.0f - 1.0f) * range;
+}
+
+static AVD_Vector3 PRIV_avdBvhRandomVec3(AVD_UInt32 *state, AVD_Float range)
+{
+    return avdVec3(PRIV_avdBvhRandom(state, range), PRIV_avdBvhRandom(state, range), PRIV_avdBvhRandom(state, range));
+}
+
+static AVD_Vector3 PRIV_avdBvhRandomDirection(AVD_UInt32 *state)
+{
+    AVD_Vector3 direction;
+    do {
+        direction = PRIV_avdBvhRandomVec3(state, 1.0f);
+    } while (avdVec3LengthSq(direction) < 0.01f || avdVec3LengthSq(direction) > 1.0f);
+    return avdVec3Normalize(direction);
+}
+
+typedef struct {
+    AVD_Vector3 *positions;
+    AVD_UInt32 *indices;
+    AVD_Size triangleCount;
+} AVD_BvhTestMesh;
+
+static void PRIV_avdBvhTestMeshDestroy(AVD_BvhTestMesh *mesh)
+{
+    if (mesh->positions != NULL) {
+        AVD_FREE(mesh->positions);
+    }
+    if (mesh->indices != NULL) {
+        AVD_FREE(mesh->indices);
+    }
+}
+
+// Indexed lat-long sphere with ridges, so neighbouring triangles share edges
+// and the surface folds in on itself a little.
+static bool PRIV_avdBvhTestMeshSphere(AVD_BvhTestMesh *mesh, AVD_UInt32 rings, AVD_UInt32 segments)
+{
+    AVD_Size vertexCount = (AVD_Size)(rings + 1) * (segments + 1);
+    mesh->triangleCount  = (AVD_Size)rings * segments * 2;
+    mesh->positions      = (AVD_Vector3 *)AVD_MALLOC(sizeof(AVD_Vector3) * vertexCount);
+    mesh->indices        = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * mesh->triangleCount * 3);
+    AVD_CHECK_MSG(mesh->positions != NULL && mesh->indices != NULL, "Failed to allocate the test sphere");
+
+    for (AVD_UInt32 ring = 0; ring <= rings; ring++) {
+        for (AVD_UInt32 segment = 0; segment <= segments; segment++) {
+            AVD_Float theta  = AVD_PI * (AVD_Float)ring / (AVD_Float)rings;
+            AVD_Float phi    = 2.0f * AVD_PI * (AVD_Float)segment / (AVD_Float)segments;
+            AVD_Float radius = 1.0f + 0.1f * avdSin(7.0f * theta) * avdCos(5.0f * phi);
+
+            mesh->positions[ring * (segments + 1) + segment] = avdVec3(radius * avdSin(theta) * avdCos(phi), radius * avdCos(theta), radius * avdSin(theta) * avdSin(phi));
+        }
+    }
+
+    AVD_UInt32 *index = mesh->indices;
+    for (AVD_UInt32 ring = 0; ring < rings; ring++) {
+        for (AVD_UInt32 segment = 0; segment < segments; segment++) {
+            AVD_UInt32 corner = ring * (segments + 1) + segment;
+            *index++          = corner;
+            *index++          = corner + segments + 1;
+            *index++          = corner + 1;
+            *index++          = corner + 1;
+            *index++          = corner + segments + 1;
+            *index++          = corner + segments + 2;
+        }
+    }
+    return true;
+}
+
+// Unindexed, randomly placed and overlapping triangles.
+static bool PRIV_avdBvhTestMeshSoup(AVD_BvhTestMesh *mesh, AVD_Size triangleCount)
+{
+    mesh->triangleCount = triangleCount;
+    mesh->positions     = (AVD_Vector3 *)AVD_MALLOC(sizeof(AVD_Vector3) * triangleCount * 3);
+    mesh->indices       = NULL;
+    AVD_CHECK_MSG(mesh->positions != NULL, "Failed to allocate the test triangles");
+
+    AVD_UInt32 state = 0x50u;
+    for (AVD_Size i = 0; i < triangleCount; i++) {
+        AVD_Vector3 center = PRIV_avdBvhRandomVec3(&state, 2.0f);
+        for (AVD_Size j = 0; j < 3; j++) {
+            mesh->positions[i * 3 + j] = avdVec3Add(center, PRIV_avdBvhRandomVec3(&state, 0.2f));
+        }
+    }
+    return true;
+}
+
+static void PRIV_avdBvhTestTriangle(const AVD_BvhTestMesh *mesh, AVD_Size triangle, AVD_Vector3 *outVertices)
+{
+    for (AVD_Size i = 0; i < 3; i++) {
+        outVertices[i] = mesh->positions[mesh->indices != NULL ? mesh->indices[triangle * 3 + i] : triangle * 3 + i];
+    }
+}
+
+// Every triangle tested, written independently of the BVH code.
+static bool PRIV_avdBvhTestBruteForce(const AVD_BvhTestMesh *mesh, const AVD_Ray *ray, AVD_RayHit *outHit)
+{
+    outHit->t        = ray->tMax;
+    outHit->triangle = AVD_BVH_NO_HIT;
+    for (AVD_Size i = 0; i < mesh->triangleCount; i++) {
+        AVD_Vector3 v[3];
+        PRIV_avdBvhTestTriangle(mesh, i, v);
+        AVD_Vector3 edge1 = avdVec3Subtract(v[1], v[0]);
+        AVD_Vector3 edge2 = avdVec3Subtract(v[2], v[0]);
+        AVD_Vector3 pvec  = avdVec3Cross(ray->direction, edge2);
+        AVD_Float det     = avdVec3Dot(edge1, pvec);
+        if (avdAbs(det) < 1e-10f) {
+            continue;
+        }
+        AVD_Vector3 tvec = avdVec3Subtract(ray->origin, v[0]);
+        AVD_Vector3 qvec = avdVec3Cross(tvec, edge1);
+        AVD_Float u      = avdVec3Dot(tvec, pvec) / det;
+        AVD_Float w      = avdVec3Dot(ray->direction, qvec) / det;
+        AVD_Float t      = avdVec3Dot(edge2, qvec) / det;
+        if (u >= 0.0f && w >= 0.0f && u + w <= 1.0f && t > 0.0f && t < outHit->t) {
+            outHit->t        = t;
+            outHit->u        = u;
+            outHit->v        = w;
+            outHit->triangle = (AVD_UInt32)i;
+        }
+    }
+    return outHit->triangle != AVD_BVH_NO_HIT;
+}
+
+// Two triangles sharing an edge may both claim a ray through it, the distance
+// has to match either way.
+static bool PRIV_avdBvhTestSameHit(const AVD_RayHit *a, const AVD_RayHit *b)
+{
+    if ((a->triangle == AVD_BVH_NO_HIT) != (b->triangle == AVD_BVH_NO_HIT)) {
+        return false;
+    }
+    if (a->triangle == AVD_BVH_NO_HIT) {
+        return true;
+    }
+    return avdAbs(a->t - b->t) <= 1e-4f * avdMax(1.0f, avdAbs(a->t));
+}
+
+static bool PRIV_avdBvhTestInside(const AVD_BvhNode *outer, const AVD_Float *innerMin, const AVD_Float *innerMax, AVD_Float tolerance)
+{
+    for (int axis = 0; axis < 3; axis++) {
+        if (innerMin[axis] < outer->boundsMin[axis] - tolerance || innerMax[axis] > outer->boundsMax[axis] + tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Children inside their parents, triangles inside their leaves and every
+// triangle in exactly one leaf.
+static bool PRIV_avdBvhTestStructure(const AVD_Bvh *bvh, const char *name)
+{
+    AVD_CHECK_MSG(sizeof(AVD_BvhNode) == 32, "BVH nodes are %zu bytes", sizeof(AVD_BvhNode));
+
+    AVD_UInt8 *seen = (AVD_UInt8 *)AVD_CALLOC(bvh->triangleCount, 1);
+    AVD_CHECK_MSG(seen != NULL, "Failed to allocate the BVH structure check");
+
+    AVD_UInt32 stack[AVD_BVH_MAX_DEPTH + 1];
+    AVD_UInt32 depths[AVD_BVH_MAX_DEPTH + 1];
+    AVD_Size stackSize = 1;
+    stack[0]           = 0;
+    depths[0]          = 0;
+
+    bool ok = true;
+    while (ok && stackSize > 0) {
+        stackSize--;
+        const AVD_BvhNode *node = &bvh->nodes[stack[stackSize]];
+        AVD_UInt32 depth        = depths[stackSize];
+
+        if (node->triangleCount > 0) {
+            for (AVD_UInt32 i = 0; ok && i < node->triangleCount; i++) {
+                const AVD_BvhTriangle *triangle = &bvh->triangles[node->firstIndex + i];
+                AVD_AABB bounds                 = avdAABBEmpty();
+                avdAABBExtend(&bounds, triangle->vertex0);
+                avdAABBExtend(&bounds, avdVec3Add(triangle->vertex0, triangle->edge1));
+                avdAABBExtend(&bounds, avdVec3Add(triangle->vertex0, triangle->edge2));
+
+                AVD_UInt32 id = bvh->triangleIds[node->firstIndex + i];
+                ok            = id < bvh->triangleCount && !seen[id] && PRIV_avdBvhTestInside(node, bounds.min.v, bounds.max.v, 1e-5f);
+                if (ok) {
+                    seen[id] = 1;
+                }
+            }
+            continue;
+        }
+
+        ok = node->firstIndex >= 2 && node->firstIndex + 1 < bvh->nodeCount && depth + 1 < AVD_BVH_MAX_DEPTH;
+        for (AVD_UInt32 c = 0; ok && c < 2; c++) {
+            const AVD_BvhNode *child = &bvh->nodes[node->firstIndex + c];
+            ok                       = PRIV_avdBvhTestInside(node, child->boundsMin, child->boundsMax, 0.0f);
+            stack[stackSize]         = node->firstIndex + c;
+            depths[stackSize]        = depth + 1;
+            stackSize++;
+        }
+    }
+
+    for (AVD_Size i = 0; ok && i < bvh->triangleCount; i++) {
+        ok = seen[i] != 0;
+    }
+    AVD_FREE(seen);
+
+    if (!ok) {
+        AVD_LOG_ERROR("    FAILED: BVH over the %s is malformed", name);
+    }
+    return ok;
+}
+
+static AVD_Ray PRIV_avdBvhTestRay(AVD_UInt32 *state, AVD_Size index)
+{
+    // from outside towards the middle, every third ray stops early
+    AVD_Ray ray = {
+        .origin = avdVec3Scale(PRIV_avdBvhRandomDirection(state), 4.0f),
+        .tMax   = index % 3 == 0 ? 3.5f : FLT_MAX,
+    };
+    ray.direction = avdVec3Normalize(avdVec3Subtract(PRIV_avdBvhRandomVec3(state, 1.5f), ray.origin));
+    return ray;
+}
+
+static bool PRIV_avdBvhTestQueries(const AVD_BvhTestMesh *mesh, const char *name)
+{
+    AVD_Bvh bvh = {0};
+    AVD_CHECK(avdBvhBuild(&bvh, mesh->positions, mesh->indices, mesh->triangleCount));
+
+    AVD_Ray *rays     = (AVD_Ray *)AVD_MALLOC(sizeof(AVD_Ray) * AVD_BVH_TEST_RAYS);
+    AVD_RayHit *hits  = (AVD_RayHit *)AVD_MALLOC(sizeof(AVD_RayHit) * AVD_BVH_TEST_RAYS);
+    bool *occluded    = (bool *)AVD_MALLOC(sizeof(bool) * AVD_BVH_TEST_RAYS);
+    bool ok           = rays != NULL && hits != NULL && occluded != NULL && PRIV_avdBvhTestStructure(&bvh, name);
+    AVD_Size hitCount = 0;
+    AVD_UInt32 state  = 0xACE1u;
+    for (AVD_Size i = 0; ok && i < AVD_BVH_TEST_RAYS; i++) {
+        rays[i] = PRIV_avdBvhTestRay(&state, i);
+    }
+
+    if (ok) {
+        avdBvhIntersectRays(&bvh, rays, AVD_BVH_TEST_RAYS, hits);
+        avdBvhOccludedRays(&bvh, rays, AVD_BVH_TEST_RAYS, occluded);
+    }
+    for (AVD_Size i = 0; ok && i < AVD_BVH_TEST_RAYS; i++) {
+        AVD_RayHit expected, single;
+        bool expectedHit = PRIV_avdBvhTestBruteForce(mesh, &rays[i], &expected);
+        bool singleHit   = avdBvhIntersect(&bvh, &rays[i], &single);
+
+        ok = singleHit == expectedHit && PRIV_avdBvhTestSameHit(&single, &expected) && PRIV_avdBvhTestSameHit(&hits[i], &expected);
+        ok = ok && avdBvhOccluded(&bvh, &rays[i]) == expectedHit && occluded[i] == expectedHit;
+        if (!ok) {
+            AVD_LOG_ERROR("    FAILED: Ray %zu against the %s: expected triangle %u at %f, got %u at %f (batched %u at %f)",
+                          i, name, expected.triangle, expected.t, single.triangle, single.t, hits[i].triangle, hits[i].t);
+        }
+        hitCount += expectedHit;
+    }
+
+    // both outcomes should be common or the comparison above proves little
+    if (ok && (hitCount < AVD_BVH_TEST_RAYS / 10 || hitCount > AVD_BVH_TEST_RAYS * 9 / 10)) {
+        AVD_LOG_ERROR("    FAILED: Only %zu of %d test rays hit the %s", hitCount, AVD_BVH_TEST_RAYS, name);
+        ok = false;
+    }
+
+    if (rays != NULL) {
+        AVD_FREE(rays);
+    }
+    if (hits != NULL) {
+        AVD_FREE(hits);
+    }
+    if (occluded != NULL) {
+        AVD_FREE(occluded);
+    }
+    avdBvhDestroy(&bvh);
+    return ok;
+}
+
+static bool PRIV_avdBvhTestEmpty()
+{
+    AVD_Bvh bvh = {0};
+    AVD_CHECK(avdBvhBuild(&bvh, NULL, NULL, 0));
+
+    AVD_Ray ray = {.origin = avdVec3Zero(), .direction = avdVec3(0.0f, 0.0f, 1.0f), .tMax = FLT_MAX};
+    AVD_RayHit hit;
+    bool ok = !avdBvhIntersect(&bvh, &ray, &hit) && hit.triangle == AVD_BVH_NO_HIT && !avdBvhOccluded(&bvh, &ray) && avdAABBIsEmpty(avdBvhBounds(&bvh));
+    avdBvhDestroy(&bvh);
+    if (!ok) {
+        AVD_LOG_ERROR("    FAILED: Empty BVH reported a hit");
+    }
+    return ok;
+}
+
+bool avdBvhTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD BVH Tests...");
+
+    AVD_BvhTestMesh sphere = {0};
+    AVD_BvhTestMesh soup   = {0};
+    bool ok                = PRIV_avdBvhTestMeshSphere(&sphere, 96, 192) && PRIV_avdBvhTestMeshSoup(&soup, AVD_BVH_TEST_SOUP);
+
+    ok = ok && PRIV_avdBvhTestEmpty();
+    ok = ok && PRIV_avdBvhTestQueries(&soup, "triangle soup");
+    ok = ok && PRIV_avdBvhTestQueries(&sphere, "sphere");
+
+    // again with subtrees built as jobs, the sphere is large enough to split
+    bool ownsJobSystem = ok && !avdJobsIsInitialized();
+    if (ownsJobSystem) {
+        ok = avdJobsInit(AVD_BVH_TEST_WORKERS);
+    }
+    ok = ok && PRIV_avdBvhTestQueries(&sphere, "sphere built in parallel");
+    if (ownsJobSystem) {
+        avdJobsShutdown();
+    }
+
+    PRIV_avdBvhTestMeshDestroy(&sphere);
+    PRIV_avdBvhTestMeshDestroy(&soup);
+    AVD_CHECK(ok);
+
+    AVD_LOG_DEBUG("All AVD BVH Tests PASSED");
+    return true;
+}
+
+typedef struct {
+    // either a loaded mesh or a generated one
+    const AVD_Mesh *mesh;
+    const AVD_ModelResources *resources;
+    AVD_BvhTestMesh generated;
+
+    AVD_Bvh bvh;
+    AVD_Bvh rebuilt;
+
+    AVD_Ray *cameraRays;
+    AVD_Ray *randomRays;
+    AVD_RayHit *hits;
+    bool *occluded;
+    AVD_Size rayCount;
+} AVD_BvhBenchmark;
+
+static void PRIV_avdBvhBenchmarkBuild(void *userData)
+{
+    AVD_BvhBenchmark *benchmark = (AVD_BvhBenchmark *)userData;
+    avdBvhDestroy(&benchmark->rebuilt);
+    if (benchmark->mesh != NULL) {
+        avdMeshBuildBvh(benchmark->mesh, benchmark->resources, &benchmark->rebuilt);
+    } else {
+        avdBvhBuild(&benchmark->rebuilt, benchmark->generated.positions, benchmark->generated.indices, benchmark->generated.triangleCount);
+    }
+}
+
+static void PRIV_avdBvhBenchmarkClosestSingle(void *userData)
+{
+    AVD_BvhBenchmark *benchmark = (AVD_BvhBenchmark *)userData;
+    for (AVD_Size i = 0; i < benchmark->rayCount; i++) {
+        avdBvhIntersect(&benchmark->bvh, &benchmark->cameraRays[i], &benchmark->hits[i]);
+    }
+}
+
+static void PRIV_avdBvhBenchmarkClosestPacket(void *userData)
+{
+    AVD_BvhBenchmark *benchmark = (AVD_BvhBenchmark *)userData;
+    avdBvhIntersectRays(&benchmark->bvh, benchmark->cameraRays, benchmark->rayCount, benchmark->hits);
+}
+
+static void PRIV_avdBvhBenchmarkOccludedSingle(void *userData)
+{
+    AVD_BvhBenchmark *benchmark = (AVD_BvhBenchmark *)userData;
+    for (AVD_Size i = 0; i < benchmark->rayCount; i++) {
+        benchmark->occluded[i] = avdBvhOccluded(&benchmark->bvh, &benchmark->randomRays[i]);
+    }
+}
+
+static void PRIV_avdBvhBenchmarkOccludedPacket(void *userData)
+{
+    AVD_BvhBenchmark *benchmark = (AVD_BvhBenchmark *)userData;
+    avdBvhOccludedRays(&benchmark->bvh, benchmark->randomRays, benchmark->rayCount, benchmark->occluded);
+}
+
+// Camera rays over the bounds in 2x2 pixel tiles so every packet is coherent,
+// random rays start inside the bounds and go anywhere, like occlusion samples.
+static bool PRIV_avdBvhBenchmarkPrepareRays(AVD_BvhBenchmark *benchmark)
+{
+    benchmark->rayCount   = AVD_BVH_BENCH_RAYS_X * AVD_BVH_BENCH_RAYS_Y;
+    benchmark->cameraRays = (AVD_Ray *)AVD_MALLOC(sizeof(AVD_Ray) * benchmark->rayCount);
+    benchmark->randomRays = (AVD_Ray *)AVD_MALLOC(sizeof(AVD_Ray) * benchmark->rayCount);
+    benchmark->hits       = (AVD_RayHit *)AVD_MALLOC(sizeof(AVD_RayHit) * benchmark->rayCount);
+    benchmark->occluded   = (bool *)AVD_MALLOC(sizeof(bool) * benchmark->rayCount);
+    AVD_CHECK_MSG(benchmark->cameraRays != NULL && benchmark->randomRays != NULL && benchmark->hits != NULL && benchmark->occluded != NULL,
+                  "Failed to allocate the benchmark rays");
+
+    AVD_AABB bounds     = avdBvhBounds(&benchmark->bvh);
+    AVD_Vector3 center  = avdAABBCenter(bounds);
+    AVD_Vector3 extents = avdAABBExtents(bounds);
+    AVD_Float radius    = avdVec3Length(extents);
+    AVD_Vector3 eye     = avdVec3Add(center, avdVec3(0.0f, 0.0f, 2.5f * radius));
+
+    AVD_Size ray = 0;
+    for (AVD_Size tileY = 0; tileY < AVD_BVH_BENCH_RAYS_Y; tileY += 2) {
+        for (AVD_Size tileX = 0; tileX < AVD_BVH_BENCH_RAYS_X; tileX += 2) {
+            for (AVD_Size i = 0; i < 4; i++) {
+                AVD_Float x = ((AVD_Float)(tileX + i % 2) + 0.5f) / AVD_BVH_BENCH_RAYS_X * 2.0f - 1.0f;
+                AVD_Float y = ((AVD_Float)(tileY + i / 2) + 0.5f) / AVD_BVH_BENCH_RAYS_Y * 2.0f - 1.0f;
+                AVD_Vector3 target             = avdVec3Add(center, avdVec3(x * radius, y * radius, 0.0f));
+                benchmark->cameraRays[ray++] = (AVD_Ray){
+                    .origin    = eye,
+                    .direction = avdVec3Normalize(avdVec3Subtract(target, eye)),
+                    .tMax      = FLT_MAX,
+                };
+            }
+        }
+    }
+
+    AVD_UInt32 state = 0xD1CEu;
+    for (AVD_Size i = 0; i < benchmark->rayCount; i++) {
+        AVD_Vector3 offset       = avdVec3(PRIV_avdBvhRandom(&state, extents.x), PRIV_avdBvhRandom(&state, extents.y), PRIV_avdBvhRandom(&state, extents.z));
+        benchmark->randomRays[i] = (AVD_Ray){
+            .origin    = avdVec3Add(center, offset),
+            .direction = PRIV_avdBvhRandomDirection(&state),
+            .tMax      = radius * 0.25f,
+        };
+    }
+    return true;
+}
+
+#define AVD_BVH_BENCH_CASES 6
+
+static void PRIV_avdBvhBenchmarkNames(const char *modelName, char (*outNames)[AVD_BENCH_NAME_LENGTH])
+{
+    snprintf(outNames[0], AVD_BENCH_NAME_LENGTH, "bvh/build_%s/threads_1", modelName);
+    snprintf(outNames[1], AVD_BENCH_NAME_LENGTH, "bvh/build_%s/threads_%u", modelName, avdJobsHardwareThreadCount());
+    snprintf(outNames[2], AVD_BENCH_NAME_LENGTH, "bvh/closest_single_%s", modelName);
+    snprintf(outNames[3], AVD_BENCH_NAME_LENGTH, "bvh/closest_packet_%s", modelName);
+    snprintf(outNames[4], AVD_BENCH_NAME_LENGTH, "bvh/occluded_single_%s", modelName);
+    snprintf(outNames[5], AVD_BENCH_NAME_LENGTH, "bvh/occluded_packet_%s", modelName);
+}
+
+// Loading and building for a model is slow, skip it when none of its cases run.
+static bool PRIV_avdBvhBenchmarkIsSelected(const AVD_Bench *bench, const char *modelName)
+{
+    char names[AVD_BVH_BENCH_CASES][AVD_BENCH_NAME_LENGTH];
+    PRIV_avdBvhBenchmarkNames(modelName, names);
+    for (AVD_Size i = 0; i < AVD_BVH_BENCH_CASES; i++) {
+        if (avdBenchIsSelected(bench, names[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool PRIV_avdBvhBenchmarkModel(AVD_Bench *bench, AVD_BvhBenchmark *benchmark, const char *modelName, AVD_Size triangleCount)
+{
+    char names[AVD_BVH_BENCH_CASES][AVD_BENCH_NAME_LENGTH];
+    PRIV_avdBvhBenchmarkNames(modelName, names);
+
+    AVD_BenchCase cases[AVD_BVH_BENCH_CASES] = {
+        {.name = names[0], .unit = "triangles", .itemsPerRepetition = triangleCount, .run = PRIV_avdBvhBenchmarkBuild},
+        {.name = names[1], .unit = "triangles", .itemsPerRepetition = triangleCount, .run = PRIV_avdBvhBenchmarkBuild},
+        {.name = names[2], .unit = "rays", .itemsPerRepetition = benchmark->rayCount, .run = PRIV_avdBvhBenchmarkClosestSingle},
+        {.name = names[3], .unit = "rays", .itemsPerRepetition = benchmark->rayCount, .run = PRIV_avdBvhBenchmarkClosestPacket},
+        {.name = names[4], .unit = "rays", .itemsPerRepetition = benchmark->rayCount, .run = PRIV_avdBvhBenchmarkOccludedSingle},
+        {.name = names[5], .unit = "rays", .itemsPerRepetition = benchmark->rayCount, .run = PRIV_avdBvhBenchmarkOccludedPacket},
+    };
+
+    // only the second build runs with the job system, one worker per core
+    bool ok = true;
+    for (AVD_Size i = 0; ok && i < AVD_BVH_BENCH_CASES; i++) {
+        cases[i].userData = benchmark;
+        if (i == 1) {
+            ok = avdJobsInit(0);
+        }
+        ok = ok && avdBenchRun(bench, &cases[i]);
+        if (i == 1 && avdJobsIsInitialized()) {
+            avdJobsShutdown();
+        }
+    }
+    return ok;
+}
+
+static void PRIV_avdBvhBenchmarkDestroy(AVD_BvhBenchmark *benchmark)
+{
+    PRIV_avdBvhTestMeshDestroy(&benchmark->generated);
+    avdBvhDestroy(&benchmark->bvh);
+    avdBvhDestroy(&benchmark->rebuilt);
+    if (benchmark->cameraRays != NULL) {
+        AVD_FREE(benchmark->cameraRays);
+    }
+    if (benchmark->randomRays != NULL) {
+        AVD_FREE(benchmark->randomRays);
+    }
+    if (benchmark->hits != NULL) {
+        AVD_FREE(benchmark->hits);
+    }
+    if (benchmark->occluded != NULL) {
+        AVD_FREE(benchmark->occluded);
+    }
+}
+
+static bool PRIV_avdBvhBenchmarkGenerated(AVD_Bench *bench)
+{
+    if (!PRIV_avdBvhBenchmarkIsSelected(bench, "sphere_256k")) {
+        return true;
+    }
+
+    AVD_BvhBenchmark benchmark = {0};
+    bool ok                    = PRIV_avdBvhTestMeshSphere(&benchmark.generated, 256, 512);
+    ok                         = ok && avdBvhBuild(&benchmark.bvh, benchmark.generated.positions, benchmark.generated.indices, benchmark.generated.triangleCount);
+    ok                         = ok && PRIV_avdBvhBenchmarkPrepareRays(&benchmark);
+    ok                         = ok && PRIV_avdBvhBenchmarkModel(bench, &benchmark, "sphere_256k", benchmark.generated.triangleCount);
+    PRIV_avdBvhBenchmarkDestroy(&benchmark);
+    return ok;
+}
+
+// The models of the subsurface scattering scene, skipped when the assets have
+// not been downloaded next to the working directory.
+static bool PRIV_avdBvhBenchmarkObj(AVD_Bench *bench, const char *path, const char *modelName)
+{
+    if (!PRIV_avdBvhBenchmarkIsSelected(bench, modelName)) {
+        return true;
+    }
+    if (!avdPathExists(path)) {
+        AVD_LOG_WARN("Skipping the %s BVH benchmarks, %s was not found", modelName, path);
+        return true;
+    }
+
+    AVD_Model model              = {0};
+    AVD_ModelResources resources = {0};
+    AVD_BvhBenchmark benchmark   = {0};
+    AVD_CHECK(avdModelCreate(&model, 0));
+    AVD_CHECK(avdModelResourcesCreate(&resources));
+
+    bool ok = avdModelLoadObj(path, &model, &resources, AVD_OBJ_LOAD_FLAG_IGNORE_OBJECTS) && model.meshes.count > 0;
+    if (ok) {
+        benchmark.mesh      = (const AVD_Mesh *)avdListGet(&model.meshes, 0);
+        benchmark.resources = &resources;
+        ok                  = avdMeshBuildBvh(benchmark.mesh, &resources, &benchmark.bvh);
+        ok                  = ok && PRIV_avdBvhBenchmarkPrepareRays(&benchmark);
+        ok                  = ok && PRIV_avdBvhBenchmarkModel(bench, &benchmark, modelName, (AVD_Size)benchmark.mesh->triangleCount);
+    }
+
+    PRIV_avdBvhBenchmarkDestroy(&benchmark);
+    avdModelResourcesDestroy(&resources);
+    avdModelDestroy(&model);
+    return ok;
+}
+
+bool avdBvhBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD BVH benchmarks...");
+
+    // the parallel build cases start the job system themselves
+    AVD_CHECK_MSG(!avdJobsIsInitialized(), "BVH benchmarks need to start the job system themselves");
+
+    bool ok = PRIV_avdBvhBenchmarkGenerated(bench);
+    ok      = ok && PRIV_avdBvhBenchmarkObj(bench, "assets/scene_subsurface_scattering/standford_dragon.obj", "dragon");
+    ok      = ok && PRIV_avdBvhBenchmarkObj(bench, "assets/scene_subsurface_scattering/buddha.obj", "buddha");
+    return ok;
+}
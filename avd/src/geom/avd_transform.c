@@ -249,3 +249,234 @@ AVD_Vector3 avdTransformGetRight(const AVD_Transform *transform)
     // Right is positive X
     return avdQuatRotateVec3(transform->rotation, avdVec3(1.0f, 0.0f, 0.0f));
 }
+
+// Batched transforms
+// nodes per pass of the world matrix walk, small enough that the local
+// matrices are still in cache when they get multiplied with their parents
+#define AVD_TRANSFORM_STREAMS_PASS_SIZE 64
+
+bool avdTransformStreamsCreate(AVD_TransformStreams *streams, AVD_Size capacity)
+{
+    AVD_ASSERT(streams != NULL);
+
+    *streams = (AVD_TransformStreams){0};
+
+    // a single block holding the ten float streams followed by the parents
+    AVD_Size floatStreamSize = AVD_MAX(capacity, 1) * sizeof(AVD_Float);
+    AVD_UInt8 *block         = (AVD_UInt8 *)AVD_MALLOC(floatStreamSize * 10 + AVD_MAX(capacity, 1) * sizeof(AVD_Int32));
+    AVD_CHECK_MSG(block != NULL, "Failed to allocate transform streams for %zu nodes", capacity);
+
+    streams->positionX = (AVD_Float *)(block + floatStreamSize * 0);
+    streams->positionY = (AVD_Float *)(block + floatStreamSize * 1);
+    streams->positionZ = (AVD_Float *)(block + floatStreamSize * 2);
+    streams->rotationX = (AVD_Float *)(block + floatStreamSize * 3);
+    streams->rotationY = (AVD_Float *)(block + floatStreamSize * 4);
+    streams->rotationZ = (AVD_Float *)(block + floatStreamSize * 5);
+    streams->rotationW = (AVD_Float *)(block + floatStreamSize * 6);
+    streams->scaleX    = (AVD_Float *)(block + floatStreamSize * 7);
+    streams->scaleY    = (AVD_Float *)(block + floatStreamSize * 8);
+    streams->scaleZ    = (AVD_Float *)(block + floatStreamSize * 9);
+    streams->parents   = (AVD_Int32 *)(block + floatStreamSize * 10);
+    streams->capacity  = capacity;
+    return true;
+}
+
+bool avdTransformStreamsReserve(AVD_TransformStreams *streams, AVD_Size capacity)
+{
+    AVD_ASSERT(streams != NULL);
+
+    if (capacity <= streams->capacity) {
+        return true;
+    }
+
+    // every stream starts at a multiple of the capacity, so the block can not
+    // just be resized and the nodes are copied stream by stream
+    AVD_TransformStreams grown = {0};
+    AVD_CHECK(avdTransformStreamsCreate(&grown, AVD_MAX(capacity, streams->capacity * 2)));
+    if (streams->count > 0) {
+        AVD_Size floatSize = sizeof(AVD_Float) * streams->count;
+        memcpy(grown.positionX, streams->positionX, floatSize);
+        memcpy(grown.positionY, streams->positionY, floatSize);
+        memcpy(grown.positionZ, streams->positionZ, floatSize);
+        memcpy(grown.rotationX, streams->rotationX, floatSize);
+        memcpy(grown.rotationY, streams->rotationY, floatSize);
+        memcpy(grown.rotationZ, streams->rotationZ, floatSize);
+        memcpy(grown.rotationW, streams->rotationW, floatSize);
+        memcpy(grown.scaleX, streams->scaleX, floatSize);
+        memcpy(grown.scaleY, streams->scaleY, floatSize);
+        memcpy(grown.scaleZ, streams->scaleZ, floatSize);
+        memcpy(grown.parents, streams->parents, sizeof(AVD_Int32) * streams->count);
+    }
+    grown.count = streams->count;
+
+    avdTransformStreamsDestroy(streams);
+    *streams = grown;
+    return true;
+}
+
+void avdTransformStreamsDestroy(AVD_TransformStreams *streams)
+{
+    AVD_ASSERT(streams != NULL);
+    // positionX is the start of the block
+    if (streams->positionX != NULL) {
+        AVD_FREE(streams->positionX);
+    }
+    *streams = (AVD_TransformStreams){0};
+}
+
+void avdTransformStreamsSet(AVD_TransformStreams *streams, AVD_Size index, const AVD_Transform *transform, AVD_Int32 parent)
+{
+    AVD_ASSERT(streams != NULL && transform != NULL);
+    AVD_ASSERT(index < streams->capacity);
+    AVD_ASSERT(parent < 0 || (AVD_Size)parent < index);
+
+    streams->positionX[index] = transform->position.x;
+    streams->positionY[index] = transform->position.y;
+    streams->positionZ[index] = transform->position.z;
+    streams->rotationX[index] = transform->rotation.x;
+    streams->rotationY[index] = transform->rotation.y;
+    streams->rotationZ[index] = transform->rotation.z;
+    streams->rotationW[index] = transform->rotation.w;
+    streams->scaleX[index]    = transform->scale.x;
+    streams->scaleY[index]    = transform->scale.y;
+    streams->scaleZ[index]    = transform->scale.z;
+    streams->parents[index]   = parent;
+    streams->count            = AVD_MAX(streams->count, index + 1);
+}
+
+AVD_Transform avdTransformStreamsGet(const AVD_TransformStreams *streams, AVD_Size index)
+{
+    AVD_ASSERT(streams != NULL);
+    AVD_ASSERT(index < streams->count);
+
+    return avdTransform(
+        avdVec3(streams->positionX[index], streams->positionY[index], streams->positionZ[index]),
+        avdQuat(streams->rotationX[index], streams->rotationY[index], streams->rotationZ[index], streams->rotationW[index]),
+        avdVec3(streams->scaleX[index], streams->scaleY[index], streams->scaleZ[index]));
+}
+
+// Translation * Rotation * Scale written out directly, the scale only
+// multiplies the rotation columns so no full matrix products are needed.
+static void PRIV_avdTransformStreamsToMatrix(const AVD_TransformStreams *streams, AVD_Size index, AVD_Matrix4x4 *out)
+{
+    AVD_Float x = streams->rotationX[index];
+    AVD_Float y = streams->rotationY[index];
+    AVD_Float z = streams->rotationZ[index];
+    AVD_Float w = streams->rotationW[index];
+
+    AVD_Float x2 = x + x;
+    AVD_Float y2 = y + y;
+    AVD_Float z2 = z + z;
+
+    AVD_Float xx = x * x2;
+    AVD_Float xy = x * y2;
+    AVD_Float xz = x * z2;
+    AVD_Float yy = y * y2;
+    AVD_Float yz = y * z2;
+    AVD_Float zz = z * z2;
+    AVD_Float wx = w * x2;
+    AVD_Float wy = w * y2;
+    AVD_Float wz = w * z2;
+
+    AVD_Float sx = streams->scaleX[index];
+    AVD_Float sy = streams->scaleY[index];
+    AVD_Float sz = streams->scaleZ[index];
+
+    out->m[0]  = (1.0f - (yy + zz)) * sx;
+    out->m[1]  = (xy + wz) * sx;
+    out->m[2]  = (xz - wy) * sx;
+    out->m[3]  = 0.0f;
+    out->m[4]  = (xy - wz) * sy;
+    out->m[5]  = (1.0f - (xx + zz)) * sy;
+    out->m[6]  = (yz + wx) * sy;
+    out->m[7]  = 0.0f;
+    out->m[8]  = (xz + wy) * sz;
+    out->m[9]  = (yz - wx) * sz;
+    out->m[10] = (1.0f - (xx + yy)) * sz;
+    out->m[11] = 0.0f;
+    out->m[12] = streams->positionX[index];
+    out->m[13] = streams->positionY[index];
+    out->m[14] = streams->positionZ[index];
+    out->m[15] = 1.0f;
+}
+
+#if defined(AVD_MATH_SIMD)
+// Same as above for four nodes at once, every register holds one matrix
+// element of four nodes and gets transposed back into columns on store.
+static void PRIV_avdTransformStreamsToMatrices4(const AVD_TransformStreams *streams, AVD_Size first, AVD_Matrix4x4 *out)
+{
+    AVD_SimdFloat4 x = avdSimdLoad(streams->rotationX + first);
+    AVD_SimdFloat4 y = avdSimdLoad(streams->rotationY + first);
+    AVD_SimdFloat4 z = avdSimdLoad(streams->rotationZ + first);
+    AVD_SimdFloat4 w = avdSimdLoad(streams->rotationW + first);
+
+    AVD_SimdFloat4 x2 = avdSimdAdd(x, x);
+    AVD_SimdFloat4 y2 = avdSimdAdd(y, y);
+    AVD_SimdFloat4 z2 = avdSimdAdd(z, z);
+
+    AVD_SimdFloat4 xx = avdSimdMul(x, x2);
+    AVD_SimdFloat4 xy = avdSimdMul(x, y2);
+    AVD_SimdFloat4 xz = avdSimdMul(x, z2);
+    AVD_SimdFloat4 yy = avdSimdMul(y, y2);
+    AVD_SimdFloat4 yz = avdSimdMul(y, z2);
+    AVD_SimdFloat4 zz = avdSimdMul(z, z2);
+    AVD_SimdFloat4 wx = avdSimdMul(w, x2);
+    AVD_SimdFloat4 wy = avdSimdMul(w, y2);
+    AVD_SimdFloat4 wz = avdSimdMul(w, z2);
+
+    AVD_SimdFloat4 sx   = avdSimdLoad(streams->scaleX + first);
+    AVD_SimdFloat4 sy   = avdSimdLoad(streams->scaleY + first);
+    AVD_SimdFloat4 sz   = avdSimdLoad(streams->scaleZ + first);
+    AVD_SimdFloat4 one  = avdSimdSplat(1.0f);
+    AVD_SimdFloat4 zero = avdSimdSplat(0.0f);
+
+    AVD_SimdFloat4 columns[4][4] = {
+        {avdSimdMul(avdSimdSub(one, avdSimdAdd(yy, zz)), sx), avdSimdMul(avdSimdAdd(xy, wz), sx), avdSimdMul(avdSimdSub(xz, wy), sx), zero},
+        {avdSimdMul(avdSimdSub(xy, wz), sy), avdSimdMul(avdSimdSub(one, avdSimdAdd(xx, zz)), sy), avdSimdMul(avdSimdAdd(yz, wx), sy), zero},
+        {avdSimdMul(avdSimdAdd(xz, wy), sz), avdSimdMul(avdSimdSub(yz, wx), sz), avdSimdMul(avdSimdSub(one, avdSimdAdd(xx, yy)), sz), zero},
+        {avdSimdLoad(streams->positionX + first), avdSimdLoad(streams->positionY + first), avdSimdLoad(streams->positionZ + first), one},
+    };
+
+    for (int column = 0; column < 4; column++) {
+        avdSimdTranspose4(&columns[column][0], &columns[column][1], &columns[column][2], &columns[column][3]);
+        for (int node = 0; node < 4; node++) {
+            avdSimdStore(out[node].m + column * 4, columns[column][node]);
+        }
+    }
+}
+#endif
+
+void avdTransformStreamsToMatrices(const AVD_TransformStreams *streams, AVD_Size first, AVD_Size count, AVD_Matrix4x4 *outMatrices)
+{
+    AVD_ASSERT(streams != NULL && outMatrices != NULL);
+    AVD_ASSERT(first + count <= streams->count);
+
+    AVD_Size i = 0;
+#if defined(AVD_MATH_SIMD)
+    for (; i + 4 <= count; i += 4) {
+        PRIV_avdTransformStreamsToMatrices4(streams, first + i, outMatrices + i);
+    }
+#endif
+    for (; i < count; i++) {
+        PRIV_avdTransformStreamsToMatrix(streams, first + i, outMatrices + i);
+    }
+}
+
+void avdTransformStreamsToWorldMatrices(const AVD_TransformStreams *streams, AVD_Matrix4x4 *outWorld)
+{
+    AVD_ASSERT(streams != NULL && outWorld != NULL);
+
+    for (AVD_Size first = 0; first < streams->count; first += AVD_TRANSFORM_STREAMS_PASS_SIZE) {
+        AVD_Size count = AVD_MIN(streams->count - first, (AVD_Size)AVD_TRANSFORM_STREAMS_PASS_SIZE);
+        avdTransformStreamsToMatrices(streams, first, count, outWorld + first);
+
+        // parents come first, so they are final by the time their children get here
+        for (AVD_Size i = first; i < first + count; i++) {
+            AVD_Int32 parent = streams->parents[i];
+            if (parent >= 0) {
+                AVD_ASSERT((AVD_Size)parent < i);
+                outWorld[i] = avdMat4x4Multiply(outWorld[parent], outWorld[i]);
+            }
+        }
+    }
+}
@@ -1,4 +1,7 @@
 #include "math/avd_math_tests.h"
+#include "geom/avd_3d_matrices.h"
+#include "geom/avd_bounds.h"
+#include "geom/avd_transform.h"
 
 static bool PRIV_avdCheckMatrix4x4()
 {
@@ -789,6 +792,352 @@ static bool PRIV_avdCheckQuaternion()
     return true;
 }
 
+#define AVD_MATH_TEST_CROSS_CHECK_ITERATIONS 1000
+#define AVD_MATH_BENCH_COUNT                 1024
+#define AVD_MATH_TEST_TRANSFORM_NODES        1003
+#define AVD_MATH_TEST_BOUNDS                 1003
+
+static AVD_Float PRIV_avdMathRandom(AVD_UInt32 *state, AVD_Float range)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return ((AVD_Float)(*state >> 8) / (AVD_Float)(1u << 24) * 2.0f - 1.0f) * range;
+}
+
+static bool PRIV_avdMathNearlyEqual(const AVD_Float *a, const AVD_Float *b, AVD_Size count)
+{
+    for (AVD_Size i = 0; i < count; i++) {
+        AVD_Float scale = avdMax(1.0f, avdMax(avdAbs(a[i]), avdAbs(b[i])));
+        if (!(avdAbs(a[i] - b[i]) <= 1e-5f * scale)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static AVD_Matrix4x4 PRIV_avdMathRandomMat4x4(AVD_UInt32 *state)
+{
+    AVD_Matrix4x4 mat;
+    for (int i = 0; i < 16; i++) {
+        mat.m[i] = PRIV_avdMathRandom(state, 10.0f);
+    }
+    return mat;
+}
+
+static AVD_Quaternion PRIV_avdMathRandomQuat(AVD_UInt32 *state)
+{
+    return avdQuat(PRIV_avdMathRandom(state, 1.0f), PRIV_avdMathRandom(state, 1.0f), PRIV_avdMathRandom(state, 1.0f), PRIV_avdMathRandom(state, 1.0f));
+}
+
+// Straight from the definitions, independent of the backend the library was built with.
+static AVD_Matrix4x4 PRIV_avdMathReferenceMat4x4Multiply(const AVD_Matrix4x4 *a, const AVD_Matrix4x4 *b)
+{
+    AVD_Matrix4x4 result = avdMat4x4Zero();
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            for (int k = 0; k < 4; k++) {
+                avdMat4x4Val(result, i, j) += avdMat4x4Val(*a, i, k) * avdMat4x4Val(*b, k, j);
+            }
+        }
+    }
+    return result;
+}
+
+static AVD_Quaternion PRIV_avdMathReferenceQuatMultiply(const AVD_Quaternion *a, const AVD_Quaternion *b)
+{
+    // (s1, v1)(s2, v2) = (s1 s2 - v1.v2, s1 v2 + s2 v1 + v1 x v2)
+    AVD_Vector3 va    = avdVec3(a->x, a->y, a->z);
+    AVD_Vector3 vb    = avdVec3(b->x, b->y, b->z);
+    AVD_Vector3 cross = avdVec3Cross(va, vb);
+    AVD_Vector3 vec   = avdVec3Add(avdVec3Add(avdVec3Scale(vb, a->w), avdVec3Scale(va, b->w)), cross);
+    return avdQuat(vec.x, vec.y, vec.z, a->w * b->w - avdVec3Dot(va, vb));
+}
+
+static bool PRIV_avdCheckSimdMatchesScalar()
+{
+    AVD_LOG_DEBUG("  Testing %s math backend against scalar references...", avdMathBackendName());
+
+    AVD_UInt32 state = 0x12345678u;
+    for (int iteration = 0; iteration < AVD_MATH_TEST_CROSS_CHECK_ITERATIONS; iteration++) {
+        AVD_Matrix4x4 a    = PRIV_avdMathRandomMat4x4(&state);
+        AVD_Matrix4x4 b    = PRIV_avdMathRandomMat4x4(&state);
+        AVD_Vector4 vec    = avdVec4(PRIV_avdMathRandom(&state, 10.0f), PRIV_avdMathRandom(&state, 10.0f), PRIV_avdMathRandom(&state, 10.0f), PRIV_avdMathRandom(&state, 10.0f));
+        AVD_Float scalar   = PRIV_avdMathRandom(&state, 4.0f);
+        AVD_Quaternion qa  = PRIV_avdMathRandomQuat(&state);
+        AVD_Quaternion qb  = PRIV_avdMathRandomQuat(&state);
+        AVD_Vector3 point  = avdVec3(vec.x, vec.y, vec.z);
+        AVD_Matrix4x4 ab   = PRIV_avdMathReferenceMat4x4Multiply(&a, &b);
+        AVD_Matrix4x4 temp = a;
+
+        AVD_Matrix4x4 product = avdMat4x4Multiply(a, b);
+        avdMat4x4MultiplyInplace(&temp, &b);
+        if (!PRIV_avdMathNearlyEqual(product.m, ab.m, 16) || !PRIV_avdMathNearlyEqual(temp.m, ab.m, 16)) {
+            AVD_LOG_ERROR("    FAILED: Matrix4x4 multiplication differs from the reference at iteration %d", iteration);
+            return false;
+        }
+
+        AVD_Vector4 transformed = avdMat4x4MultiplyVec4(a, vec);
+        AVD_Vector4 expectedVec = avdVec4Zero();
+        for (int i = 0; i < 4; i++) {
+            expectedVec.v[i] = avdMat4x4Val(a, i, 0) * vec.x + avdMat4x4Val(a, i, 1) * vec.y + avdMat4x4Val(a, i, 2) * vec.z + avdMat4x4Val(a, i, 3) * vec.w;
+        }
+        if (!PRIV_avdMathNearlyEqual(transformed.v, expectedVec.v, 4)) {
+            AVD_LOG_ERROR("    FAILED: Matrix4x4 vector multiplication differs from the reference at iteration %d", iteration);
+            return false;
+        }
+
+        AVD_Matrix4x4 sum        = avdMat4x4Add(a, b);
+        AVD_Matrix4x4 difference = avdMat4x4Subtract(a, b);
+        AVD_Matrix4x4 scaled     = avdMat4x4Scale(a, scalar);
+        for (int i = 0; i < 16; i++) {
+            AVD_Float expected[3] = {a.m[i] + b.m[i], a.m[i] - b.m[i], a.m[i] * scalar};
+            AVD_Float actual[3]   = {sum.m[i], difference.m[i], scaled.m[i]};
+            if (!PRIV_avdMathNearlyEqual(actual, expected, 3)) {
+                AVD_LOG_ERROR("    FAILED: Matrix4x4 element-wise operations differ from the reference at iteration %d", iteration);
+                return false;
+            }
+        }
+
+        AVD_Quaternion quatProduct  = avdQuatMultiply(qa, qb);
+        AVD_Quaternion quatExpected = PRIV_avdMathReferenceQuatMultiply(&qa, &qb);
+        if (!PRIV_avdMathNearlyEqual(quatProduct.q, quatExpected.q, 4)) {
+            AVD_LOG_ERROR("    FAILED: Quaternion multiplication differs from the reference at iteration %d", iteration);
+            return false;
+        }
+
+        // rotating through q v q^-1 takes a different route than the library
+        AVD_Quaternion unit         = avdQuatNormalize(qa);
+        AVD_Quaternion inverse      = avdQuatInverse(unit);
+        AVD_Quaternion pointQuat    = avdQuat(point.x, point.y, point.z, 0.0f);
+        AVD_Quaternion rotatedQuat  = PRIV_avdMathReferenceQuatMultiply(&unit, &pointQuat);
+        rotatedQuat                 = PRIV_avdMathReferenceQuatMultiply(&rotatedQuat, &inverse);
+        AVD_Vector3 rotated         = avdQuatRotateVec3(unit, point);
+        AVD_Float lengthSq          = avdQuatLengthSq(unit);
+        AVD_Float qaLengthSq        = avdQuatLengthSq(qa);
+        AVD_Quaternion qaInverse    = avdQuatInverse(qa);
+        AVD_Quaternion expectedInv  = avdQuat(-qa.x / qaLengthSq, -qa.y / qaLengthSq, -qa.z / qaLengthSq, qa.w / qaLengthSq);
+        AVD_Vector4 vecNormalized   = avdVec4Normalize(vec);
+        AVD_Float vecLength         = avdVec4Length(vec);
+        AVD_Vector4 expectedNormVec = avdVec4(vec.x / vecLength, vec.y / vecLength, vec.z / vecLength, vec.w / vecLength);
+        if (!PRIV_avdMathNearlyEqual(&lengthSq, (AVD_Float[]){1.0f}, 1) ||
+            !PRIV_avdMathNearlyEqual(rotated.v, rotatedQuat.q, 3) ||
+            !PRIV_avdMathNearlyEqual(qaInverse.q, expectedInv.q, 4) ||
+            !PRIV_avdMathNearlyEqual(vecNormalized.v, expectedNormVec.v, 4)) {
+            AVD_LOG_ERROR("    FAILED: Quaternion normalize, inverse or rotation differ from the reference at iteration %d", iteration);
+            return false;
+        }
+    }
+
+    // degenerate inputs keep their scalar behaviour
+    AVD_Quaternion zeroNormalized = avdQuatNormalize(avdQuatZero());
+    AVD_Quaternion zeroInverse    = avdQuatInverse(avdQuatZero());
+    AVD_Quaternion identity       = avdQuatIdentity();
+    AVD_Vector4 zeroVec           = avdVec4Normalize(avdVec4Zero());
+    if (!PRIV_avdMathNearlyEqual(zeroNormalized.q, identity.q, 4) || !PRIV_avdMathNearlyEqual(zeroInverse.q, identity.q, 4) || zeroVec.x != 0.0f || zeroVec.w != 0.0f) {
+        AVD_LOG_ERROR("    FAILED: Degenerate quaternion or vector inputs");
+        return false;
+    }
+
+    AVD_LOG_DEBUG("    %s math backend PASSED", avdMathBackendName());
+    return true;
+}
+
+static AVD_Transform PRIV_avdMathRandomTransform(AVD_UInt32 *state)
+{
+    return avdTransform(
+        avdVec3(PRIV_avdMathRandom(state, 2.0f), PRIV_avdMathRandom(state, 2.0f), PRIV_avdMathRandom(state, 2.0f)),
+        avdQuatNormalize(PRIV_avdMathRandomQuat(state)),
+        avdVec3(1.0f + PRIV_avdMathRandom(state, 0.25f), 1.0f + PRIV_avdMathRandom(state, 0.25f), 1.0f + PRIV_avdMathRandom(state, 0.25f)));
+}
+
+// A four way tree with a few extra roots, nodes are numbered parent first.
+static AVD_Int32 PRIV_avdMathTransformParent(AVD_Size index)
+{
+    return index % 97 == 0 ? -1 : (AVD_Int32)((index - 1) / 4);
+}
+
+static bool PRIV_avdCheckTransformStreams()
+{
+    AVD_LOG_DEBUG("  Testing batched transform streams...");
+
+    AVD_TransformStreams streams = {0};
+    AVD_CHECK(avdTransformStreamsCreate(&streams, AVD_MATH_TEST_TRANSFORM_NODES));
+
+    AVD_Transform *transforms = (AVD_Transform *)AVD_MALLOC(sizeof(AVD_Transform) * AVD_MATH_TEST_TRANSFORM_NODES);
+    AVD_Matrix4x4 *world      = (AVD_Matrix4x4 *)AVD_MALLOC(sizeof(AVD_Matrix4x4) * AVD_MATH_TEST_TRANSFORM_NODES * 2);
+    if (transforms == NULL || world == NULL) {
+        AVD_FREE(transforms);
+        AVD_FREE(world);
+        avdTransformStreamsDestroy(&streams);
+        AVD_LOG_ERROR("    FAILED: Could not allocate the test hierarchy");
+        return false;
+    }
+    AVD_Matrix4x4 *expected = world + AVD_MATH_TEST_TRANSFORM_NODES;
+
+    // the per node path the renderers use
+    AVD_UInt32 state = 0xC0FFEEu;
+    for (AVD_Size i = 0; i < AVD_MATH_TEST_TRANSFORM_NODES; i++) {
+        AVD_Int32 parent = PRIV_avdMathTransformParent(i);
+        transforms[i]    = PRIV_avdMathRandomTransform(&state);
+        avdTransformStreamsSet(&streams, i, &transforms[i], parent);
+
+        AVD_Matrix4x4 local = avdTransformToMatrix(&transforms[i]);
+        expected[i]         = parent < 0 ? local : avdMat4x4Multiply(expected[parent], local);
+    }
+
+    bool ok = streams.count == AVD_MATH_TEST_TRANSFORM_NODES;
+    for (AVD_Size i = 0; ok && i < AVD_MATH_TEST_TRANSFORM_NODES; i++) {
+        AVD_Transform stored = avdTransformStreamsGet(&streams, i);
+        ok                   = memcmp(&stored, &transforms[i], sizeof(AVD_Transform)) == 0;
+    }
+    if (!ok) {
+        AVD_LOG_ERROR("    FAILED: Transform streams did not store the transforms");
+    }
+
+    // local matrices of an unaligned range, then the full world walk
+    if (ok) {
+        avdTransformStreamsToMatrices(&streams, 3, 10, world);
+        for (AVD_Size i = 0; ok && i < 10; i++) {
+            AVD_Matrix4x4 local = avdTransformToMatrix(&transforms[3 + i]);
+            ok                  = PRIV_avdMathNearlyEqual(world[i].m, local.m, 16);
+        }
+        if (!ok) {
+            AVD_LOG_ERROR("    FAILED: Batched local matrices differ from avdTransformToMatrix");
+        }
+    }
+    if (ok) {
+        avdTransformStreamsToWorldMatrices(&streams, world);
+        for (AVD_Size i = 0; ok && i < AVD_MATH_TEST_TRANSFORM_NODES; i++) {
+            ok = PRIV_avdMathNearlyEqual(world[i].m, expected[i].m, 16);
+            if (!ok) {
+                AVD_LOG_ERROR("    FAILED: Batched world matrix of node %zu differs from the per node path", i);
+            }
+        }
+    }
+
+    AVD_FREE(transforms);
+    AVD_FREE(world);
+    avdTransformStreamsDestroy(&streams);
+    AVD_CHECK(ok);
+
+    AVD_LOG_DEBUG("    Batched transform streams PASSED");
+    return true;
+}
+
+static AVD_AABB PRIV_avdMathBox(AVD_Vector3 center, AVD_Float halfSize)
+{
+    AVD_Vector3 extents = avdVec3(halfSize, halfSize, halfSize);
+    return (AVD_AABB){.min = avdVec3Subtract(center, extents), .max = avdVec3Add(center, extents)};
+}
+
+static bool PRIV_avdMathBoxVisible(const AVD_Frustum *frustum, AVD_Vector3 center, AVD_Float halfSize)
+{
+    AVD_AABB box = PRIV_avdMathBox(center, halfSize);
+    return avdFrustumTestAABB(frustum, &box);
+}
+
+// Camera at (0, 0, 10) looking down -z with a 90 degree field of view, so the
+// side planes at the origin are at |x| = 10 and |y| = 10.
+static AVD_Frustum PRIV_avdMathTestFrustum()
+{
+    AVD_Matrix4x4 view           = avdMatLookAt(avdVec3(0.0f, 0.0f, 10.0f), avdVec3Zero(), avdVec3(0.0f, 1.0f, 0.0f));
+    AVD_Matrix4x4 projection     = avdMatPerspective(avdDeg2Rad(90.0f), 1.0f, 0.1f, 100.0f);
+    AVD_Matrix4x4 viewProjection = avdMat4x4Multiply(projection, view);
+    return avdFrustumFromMatrix(&viewProjection);
+}
+
+static bool PRIV_avdCheckBounds()
+{
+    AVD_LOG_DEBUG("  Testing bounding volumes and frustum culling...");
+
+    AVD_Vector3 points[] = {
+        avdVec3(1.0f, -2.0f, 3.0f),
+        avdVec3(-1.0f, 4.0f, 0.5f),
+        avdVec3(0.0f, 0.0f, -3.0f),
+    };
+    AVD_AABB pointsBox = avdAABBFromPoints(points, AVD_ARRAY_COUNT(points));
+    AVD_CHECK(PRIV_avdMathNearlyEqual(pointsBox.min.v, (AVD_Float[]){-1.0f, -2.0f, -3.0f}, 3));
+    AVD_CHECK(PRIV_avdMathNearlyEqual(pointsBox.max.v, (AVD_Float[]){1.0f, 4.0f, 3.0f}, 3));
+    AVD_CHECK(avdAABBIsEmpty(avdAABBEmpty()));
+    AVD_CHECK(avdAABBIsEmpty(avdAABBFromPoints(NULL, 0)));
+
+    // a quarter turn around y swaps the x and z extents of the box
+    AVD_AABB box             = {.min = avdVec3(-1.0f, -2.0f, -3.0f), .max = avdVec3(1.0f, 2.0f, 3.0f)};
+    AVD_Transform transform  = avdTransform(avdVec3(5.0f, 0.0f, 0.0f), avdQuatFromAxisAngle(avdVec3(0.0f, 1.0f, 0.0f), AVD_PI * 0.5f), avdVec3(2.0f, 2.0f, 2.0f));
+    AVD_Matrix4x4 matrix     = avdTransformToMatrix(&transform);
+    AVD_AABB transformed     = avdAABBTransform(&box, &matrix);
+    AVD_Float expectedMin[3] = {-1.0f, -4.0f, -2.0f};
+    AVD_Float expectedMax[3] = {11.0f, 4.0f, 2.0f};
+    AVD_CHECK(PRIV_avdMathNearlyEqual(transformed.min.v, expectedMin, 3));
+    AVD_CHECK(PRIV_avdMathNearlyEqual(transformed.max.v, expectedMax, 3));
+
+    AVD_Sphere sphere = avdSphereTransform(&(AVD_Sphere){.center = avdVec3(1.0f, 0.0f, 0.0f), .radius = 1.5f}, &matrix);
+    AVD_CHECK(PRIV_avdMathNearlyEqual(&sphere.radius, &(AVD_Float){3.0f}, 1));
+    AVD_CHECK(PRIV_avdMathNearlyEqual(sphere.center.v, (AVD_Float[]){5.0f, 0.0f, -2.0f}, 3));
+
+    AVD_Frustum frustum = PRIV_avdMathTestFrustum();
+    for (int i = 0; i < AVD_FRUSTUM_PLANE_COUNT; i++) {
+        AVD_CHECK(avdPlaneDistance(&frustum.planes[i], avdVec3Zero()) > 0.0f);
+    }
+    AVD_CHECK(PRIV_avdMathBoxVisible(&frustum, avdVec3Zero(), 1.0f));
+    AVD_CHECK(!PRIV_avdMathBoxVisible(&frustum, avdVec3(0.0f, 0.0f, 20.0f), 1.0f));
+    AVD_CHECK(!PRIV_avdMathBoxVisible(&frustum, avdVec3(0.0f, 0.0f, -200.0f), 1.0f));
+    AVD_CHECK(PRIV_avdMathBoxVisible(&frustum, avdVec3(-10.5f, 0.0f, 0.0f), 1.0f));
+    AVD_CHECK(!PRIV_avdMathBoxVisible(&frustum, avdVec3(-13.0f, 0.0f, 0.0f), 1.0f));
+    AVD_AABB empty = avdAABBEmpty();
+    AVD_CHECK(!avdFrustumTestAABB(&frustum, &empty));
+    AVD_CHECK(avdFrustumTestSphere(&frustum, &(AVD_Sphere){.center = avdVec3(0.0f, 10.5f, 0.0f), .radius = 1.0f}));
+    AVD_CHECK(!avdFrustumTestSphere(&frustum, &(AVD_Sphere){.center = avdVec3(0.0f, 12.0f, 0.0f), .radius = 1.0f}));
+
+    // the batched paths have to agree with the single tests, including the
+    // entries past the last full group of four
+    AVD_BoundsStreams streams = {0};
+    AVD_CHECK(avdBoundsStreamsCreate(&streams, AVD_MATH_TEST_BOUNDS));
+    AVD_UInt32 *visible = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * AVD_MATH_TEST_BOUNDS);
+    AVD_AABB *boxes     = (AVD_AABB *)AVD_MALLOC(sizeof(AVD_AABB) * AVD_MATH_TEST_BOUNDS);
+    if (visible == NULL || boxes == NULL) {
+        AVD_FREE(visible);
+        AVD_FREE(boxes);
+        avdBoundsStreamsDestroy(&streams);
+        AVD_LOG_ERROR("    FAILED: Could not allocate the test bounds");
+        return false;
+    }
+
+    AVD_UInt32 state = 0x5EEDu;
+    for (AVD_Size i = 0; i < AVD_MATH_TEST_BOUNDS; i++) {
+        AVD_Vector3 center = avdVec3(PRIV_avdMathRandom(&state, 30.0f), PRIV_avdMathRandom(&state, 30.0f), PRIV_avdMathRandom(&state, 30.0f));
+        boxes[i]           = i % 101 == 0 ? avdAABBEmpty() : PRIV_avdMathBox(center, 1.0f + PRIV_avdMathRandom(&state, 0.5f));
+        avdBoundsStreamsSet(&streams, i, &boxes[i], NULL);
+    }
+
+    bool ok = streams.count == AVD_MATH_TEST_BOUNDS;
+    for (int pass = 0; ok && pass < 2; pass++) {
+        bool spheres       = pass == 1;
+        AVD_Size count     = spheres ? avdFrustumCullSpheres(&frustum, &streams, visible) : avdFrustumCullAABBs(&frustum, &streams, visible);
+        AVD_Size next      = 0;
+        AVD_Size reference = 0;
+        for (AVD_Size i = 0; ok && i < AVD_MATH_TEST_BOUNDS; i++) {
+            AVD_Sphere boxSphere = avdSphereFromAABB(&boxes[i]);
+            bool inside          = spheres ? avdFrustumTestSphere(&frustum, &boxSphere) : avdFrustumTestAABB(&frustum, &boxes[i]);
+            if (inside) {
+                ok = next < count && visible[next++] == i;
+                reference++;
+            }
+        }
+        ok = ok && next == count && reference > 0 && reference < AVD_MATH_TEST_BOUNDS;
+        if (!ok) {
+            AVD_LOG_ERROR("    FAILED: Batched %s culling differs from the single tests", spheres ? "sphere" : "box");
+        }
+    }
+
+    AVD_FREE(visible);
+    AVD_FREE(boxes);
+    avdBoundsStreamsDestroy(&streams);
+    AVD_CHECK(ok);
+
+    AVD_LOG_DEBUG("    Bounding volumes and frustum culling PASSED");
+    return true;
+}
+
 bool avdMathTestsRun()
 {
     AVD_LOG_DEBUG("Running AVD Math Tests...");
@@ -799,7 +1148,274 @@ bool avdMathTestsRun()
     AVD_CHECK(PRIV_avdCheckVector3());
     AVD_CHECK(PRIV_avdCheckVector4());
     AVD_CHECK(PRIV_avdCheckQuaternion());
+    AVD_CHECK(PRIV_avdCheckSimdMatchesScalar());
+    AVD_CHECK(PRIV_avdCheckTransformStreams());
+    AVD_CHECK(PRIV_avdCheckBounds());
 
     AVD_LOG_DEBUG("All AVD Math Tests passed successfully!");
     return true;
-}
\ No newline at end of file
+}
+
+typedef struct {
+    AVD_Matrix4x4 matrices[AVD_MATH_BENCH_COUNT];
+    AVD_Matrix4x4 matrixResults[AVD_MATH_BENCH_COUNT];
+    AVD_Vector4 vectors[AVD_MATH_BENCH_COUNT];
+    AVD_Quaternion quaternions[AVD_MATH_BENCH_COUNT];
+    AVD_Quaternion quaternionResults[AVD_MATH_BENCH_COUNT];
+    AVD_Vector3 points[AVD_MATH_BENCH_COUNT];
+} AVD_MathBenchmark;
+
+// Each case chains through its inputs the way a hierarchy walk would, the
+// results are kept so nothing gets optimized away.
+static void PRIV_avdMathBenchmarkMat4x4Multiply(void *userData)
+{
+    AVD_MathBenchmark *benchmark = (AVD_MathBenchmark *)userData;
+    for (AVD_Size i = 1; i < AVD_MATH_BENCH_COUNT; i++) {
+        benchmark->matrixResults[i] = avdMat4x4Multiply(benchmark->matrixResults[i - 1], benchmark->matrices[i]);
+    }
+}
+
+static void PRIV_avdMathBenchmarkMat4x4Add(void *userData)
+{
+    AVD_MathBenchmark *benchmark = (AVD_MathBenchmark *)userData;
+    for (AVD_Size i = 1; i < AVD_MATH_BENCH_COUNT; i++) {
+        benchmark->matrixResults[i] = avdMat4x4Add(benchmark->matrixResults[i - 1], benchmark->matrices[i]);
+    }
+}
+
+static void PRIV_avdMathBenchmarkMat4x4Scale(void *userData)
+{
+    AVD_MathBenchmark *benchmark = (AVD_MathBenchmark *)userData;
+    for (AVD_Size i = 1; i < AVD_MATH_BENCH_COUNT; i++) {
+        benchmark->matrixResults[i] = avdMat4x4Scale(benchmark->matrixResults[i - 1], 0.999f);
+    }
+}
+
+static void PRIV_avdMathBenchmarkMat4x4MultiplyVec4(void *userData)
+{
+    AVD_MathBenchmark *benchmark = (AVD_MathBenchmark *)userData;
+    for (AVD_Size i = 0; i < AVD_MATH_BENCH_COUNT; i++) {
+        benchmark->vectors[i] = avdMat4x4MultiplyVec4(benchmark->matrices[i], benchmark->vectors[i]);
+    }
+}
+
+static void PRIV_avdMathBenchmarkQuatMultiply(void *userData)
+{
+    AVD_MathBenchmark *benchmark = (AVD_MathBenchmark *)userData;
+    for (AVD_Size i = 1; i < AVD_MATH_BENCH_COUNT; i++) {
+        benchmark->quaternionResults[i] = avdQuatMultiply(benchmark->quaternionResults[i - 1], benchmark->quaternions[i]);
+    }
+}
+
+static void PRIV_avdMathBenchmarkQuatNormalize(void *userData)
+{
+    AVD_MathBenchmark *benchmark = (AVD_MathBenchmark *)userData;
+    for (AVD_Size i = 1; i < AVD_MATH_BENCH_COUNT; i++) {
+        benchmark->quaternionResults[i] = avdQuatNormalize(avdQuatAdd(benchmark->quaternionResults[i - 1], benchmark->quaternions[i]));
+    }
+}
+
+static void PRIV_avdMathBenchmarkQuatInverse(void *userData)
+{
+    AVD_MathBenchmark *benchmark = (AVD_MathBenchmark *)userData;
+    for (AVD_Size i = 1; i < AVD_MATH_BENCH_COUNT; i++) {
+        benchmark->quaternionResults[i] = avdQuatInverse(benchmark->quaternionResults[i - 1]);
+    }
+}
+
+static void PRIV_avdMathBenchmarkQuatRotateVec3(void *userData)
+{
+    AVD_MathBenchmark *benchmark = (AVD_MathBenchmark *)userData;
+    for (AVD_Size i = 0; i < AVD_MATH_BENCH_COUNT; i++) {
+        benchmark->points[i] = avdQuatRotateVec3(benchmark->quaternions[i], benchmark->points[i]);
+    }
+}
+
+static bool PRIV_avdMathBenchmarkSetup(void *userData)
+{
+    AVD_MathBenchmark *benchmark = (AVD_MathBenchmark *)userData;
+    AVD_UInt32 state             = 0x9E3779B9u;
+    for (AVD_Size i = 0; i < AVD_MATH_BENCH_COUNT; i++) {
+        // near identity so the chained products stay finite
+        benchmark->matrices[i]    = avdMat4x4Add(avdMat4x4Identity(), avdMat4x4Scale(PRIV_avdMathRandomMat4x4(&state), 0.001f));
+        benchmark->vectors[i]     = avdVec4(PRIV_avdMathRandom(&state, 1.0f), PRIV_avdMathRandom(&state, 1.0f), PRIV_avdMathRandom(&state, 1.0f), 1.0f);
+        benchmark->quaternions[i] = avdQuatNormalize(PRIV_avdMathRandomQuat(&state));
+        benchmark->points[i]      = avdVec3(benchmark->vectors[i].x, benchmark->vectors[i].y, benchmark->vectors[i].z);
+    }
+    benchmark->matrixResults[0]     = benchmark->matrices[0];
+    benchmark->quaternionResults[0] = benchmark->quaternions[0];
+    return true;
+}
+
+typedef struct {
+    AVD_TransformStreams streams;
+    AVD_Transform *transforms;
+    AVD_Matrix4x4 *world;
+} AVD_TransformBenchmark;
+
+static void PRIV_avdMathBenchmarkWorldPerNode(void *userData)
+{
+    AVD_TransformBenchmark *benchmark = (AVD_TransformBenchmark *)userData;
+    for (AVD_Size i = 0; i < benchmark->streams.count; i++) {
+        AVD_Int32 parent    = benchmark->streams.parents[i];
+        AVD_Matrix4x4 local = avdTransformToMatrix(&benchmark->transforms[i]);
+        benchmark->world[i] = parent < 0 ? local : avdMat4x4Multiply(benchmark->world[parent], local);
+    }
+}
+
+static void PRIV_avdMathBenchmarkWorldBatched(void *userData)
+{
+    AVD_TransformBenchmark *benchmark = (AVD_TransformBenchmark *)userData;
+    avdTransformStreamsToWorldMatrices(&benchmark->streams, benchmark->world);
+}
+
+static bool PRIV_avdMathBenchmarkTransforms(AVD_Bench *bench, AVD_Size nodeCount, const char *perNodeName, const char *batchedName)
+{
+    AVD_TransformBenchmark benchmark = {0};
+    AVD_CHECK(avdTransformStreamsCreate(&benchmark.streams, nodeCount));
+    benchmark.transforms = (AVD_Transform *)AVD_MALLOC(sizeof(AVD_Transform) * nodeCount);
+    benchmark.world      = (AVD_Matrix4x4 *)AVD_MALLOC(sizeof(AVD_Matrix4x4) * nodeCount);
+
+    bool ok = benchmark.transforms != NULL && benchmark.world != NULL;
+    if (ok) {
+        AVD_UInt32 state = 0xBADC0DEu;
+        for (AVD_Size i = 0; i < nodeCount; i++) {
+            benchmark.transforms[i] = PRIV_avdMathRandomTransform(&state);
+            avdTransformStreamsSet(&benchmark.streams, i, &benchmark.transforms[i], PRIV_avdMathTransformParent(i));
+        }
+    } else {
+        AVD_LOG_ERROR("Failed to allocate %zu benchmark transforms", nodeCount);
+    }
+
+    AVD_BenchCase perNodeCase = {
+        .name               = perNodeName,
+        .unit               = "nodes",
+        .itemsPerRepetition = nodeCount,
+        .run                = PRIV_avdMathBenchmarkWorldPerNode,
+        .userData           = &benchmark,
+    };
+    AVD_BenchCase batchedCase = {
+        .name               = batchedName,
+        .unit               = "nodes",
+        .itemsPerRepetition = nodeCount,
+        .run                = PRIV_avdMathBenchmarkWorldBatched,
+        .userData           = &benchmark,
+    };
+    ok = ok && avdBenchRun(bench, &perNodeCase) && avdBenchRun(bench, &batchedCase);
+
+    AVD_FREE(benchmark.transforms);
+    AVD_FREE(benchmark.world);
+    avdTransformStreamsDestroy(&benchmark.streams);
+    return ok;
+}
+
+typedef struct {
+    AVD_Frustum frustum;
+    AVD_BoundsStreams streams;
+    AVD_AABB *boxes;
+    AVD_UInt32 *visible;
+    AVD_Size visibleCount;
+} AVD_BoundsBenchmark;
+
+static void PRIV_avdMathBenchmarkCullPerBox(void *userData)
+{
+    AVD_BoundsBenchmark *benchmark = (AVD_BoundsBenchmark *)userData;
+    AVD_Size visibleCount          = 0;
+    for (AVD_Size i = 0; i < benchmark->streams.count; i++) {
+        if (avdFrustumTestAABB(&benchmark->frustum, &benchmark->boxes[i])) {
+            benchmark->visible[visibleCount++] = (AVD_UInt32)i;
+        }
+    }
+    benchmark->visibleCount = visibleCount;
+}
+
+static void PRIV_avdMathBenchmarkCullBatched(void *userData)
+{
+    AVD_BoundsBenchmark *benchmark = (AVD_BoundsBenchmark *)userData;
+    benchmark->visibleCount        = avdFrustumCullAABBs(&benchmark->frustum, &benchmark->streams, benchmark->visible);
+}
+
+static bool PRIV_avdMathBenchmarkCulling(AVD_Bench *bench, AVD_Size boxCount)
+{
+    AVD_BoundsBenchmark benchmark = {.frustum = PRIV_avdMathTestFrustum()};
+    AVD_CHECK(avdBoundsStreamsCreate(&benchmark.streams, boxCount));
+    benchmark.boxes   = (AVD_AABB *)AVD_MALLOC(sizeof(AVD_AABB) * boxCount);
+    benchmark.visible = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * boxCount);
+
+    bool ok = benchmark.boxes != NULL && benchmark.visible != NULL;
+    if (ok) {
+        // roughly a third of the boxes end up inside, so both outcomes are common
+        AVD_UInt32 state = 0xB0B5u;
+        for (AVD_Size i = 0; i < boxCount; i++) {
+            AVD_Vector3 center = avdVec3(PRIV_avdMathRandom(&state, 40.0f), PRIV_avdMathRandom(&state, 40.0f), PRIV_avdMathRandom(&state, 40.0f));
+            benchmark.boxes[i] = PRIV_avdMathBox(center, 1.0f + PRIV_avdMathRandom(&state, 0.5f));
+            avdBoundsStreamsSet(&benchmark.streams, i, &benchmark.boxes[i], NULL);
+        }
+    } else {
+        AVD_LOG_ERROR("Failed to allocate %zu benchmark boxes", boxCount);
+    }
+
+    AVD_BenchCase perBoxCase = {
+        .name               = "bounds/cull_per_box_100k",
+        .unit               = "boxes",
+        .itemsPerRepetition = boxCount,
+        .run                = PRIV_avdMathBenchmarkCullPerBox,
+        .userData           = &benchmark,
+    };
+    AVD_BenchCase batchedCase = {
+        .name               = "bounds/cull_batched_100k",
+        .unit               = "boxes",
+        .itemsPerRepetition = boxCount,
+        .run                = PRIV_avdMathBenchmarkCullBatched,
+        .userData           = &benchmark,
+    };
+    ok = ok && avdBenchRun(bench, &perBoxCase) && avdBenchRun(bench, &batchedCase);
+
+    AVD_FREE(benchmark.boxes);
+    AVD_FREE(benchmark.visible);
+    avdBoundsStreamsDestroy(&benchmark.streams);
+    return ok;
+}
+
+bool avdMathBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD Math benchmarks (%s backend)...", avdMathBackendName());
+
+    AVD_MathBenchmark *benchmark = (AVD_MathBenchmark *)AVD_MALLOC(sizeof(AVD_MathBenchmark));
+    AVD_CHECK_MSG(benchmark != NULL, "Failed to allocate math benchmark data");
+
+    const struct {
+        const char *name;
+        AVD_BenchRunFn *run;
+    } cases[] = {
+        {"math/mat4_add", PRIV_avdMathBenchmarkMat4x4Add},
+        {"math/mat4_scale", PRIV_avdMathBenchmarkMat4x4Scale},
+        {"math/mat4_multiply", PRIV_avdMathBenchmarkMat4x4Multiply},
+        {"math/mat4_multiply_vec4", PRIV_avdMathBenchmarkMat4x4MultiplyVec4},
+        {"math/quat_normalize", PRIV_avdMathBenchmarkQuatNormalize},
+        {"math/quat_multiply", PRIV_avdMathBenchmarkQuatMultiply},
+        {"math/quat_inverse", PRIV_avdMathBenchmarkQuatInverse},
+        {"math/quat_rotate_vec3", PRIV_avdMathBenchmarkQuatRotateVec3},
+    };
+
+    bool ok = true;
+    for (AVD_Size i = 0; ok && i < AVD_ARRAY_COUNT(cases); i++) {
+        AVD_BenchCase benchCase = {
+            .name               = cases[i].name,
+            .unit               = "ops",
+            .itemsPerRepetition = AVD_MATH_BENCH_COUNT,
+            .setup              = PRIV_avdMathBenchmarkSetup,
+            .run                = cases[i].run,
+            .userData           = benchmark,
+        };
+        ok = avdBenchRun(bench, &benchCase);
+    }
+
+    AVD_FREE(benchmark);
+
+    ok = ok && PRIV_avdMathBenchmarkTransforms(bench, 10 * 1000, "transform/world_per_node_10k", "transform/world_batched_10k");
+    ok = ok && PRIV_avdMathBenchmarkTransforms(bench, 1000 * 1000, "transform/world_per_node_1m", "transform/world_batched_1m");
+    ok = ok && PRIV_avdMathBenchmarkCulling(bench, 100 * 1000);
+    return ok;
+}
@@ -1,7 +1,5 @@
 #include "math/avd_matrix_non_simd.h"
 
-#ifndef AVD_USE_SIMD
-
 void avdMat4x4AddInplace(AVD_Matrix4x4 *out, const AVD_Matrix4x4 *b)
 {
     AVD_ASSERT(out != NULL && b != NULL);
@@ -53,27 +51,38 @@ AVD_Matrix4x4 avdMat4x4Scale(const AVD_Matrix4x4 a, AVD_Float scalar)
     return result;
 }
 
-void avdMat4x4MultiplyInplace(AVD_Matrix4x4 *out, const AVD_Matrix4x4 *b)
+// with a SIMD backend the products come from avd_matrix_simd.c
+#ifndef AVD_MATH_SIMD
+
+// out must not alias a or b
+static void PRIV_avdMat4x4Multiply(AVD_Matrix4x4 *out, const AVD_Matrix4x4 *a, const AVD_Matrix4x4 *b)
 {
-    AVD_ASSERT(out != NULL && b != NULL);
-    AVD_Matrix4x4 temp = *out;
     for (int i = 0; i < 4; ++i) {
         for (int j = 0; j < 4; ++j) {
-            avdMat4x4Val(*out, i, j) = avdMat4x4Val(temp, i, 0) * avdMat4x4Val(*b, 0, j) +
-                                       avdMat4x4Val(temp, i, 1) * avdMat4x4Val(*b, 1, j) +
-                                       avdMat4x4Val(temp, i, 2) * avdMat4x4Val(*b, 2, j) +
-                                       avdMat4x4Val(temp, i, 3) * avdMat4x4Val(*b, 3, j);
+            avdMat4x4Val(*out, i, j) = avdMat4x4Val(*a, i, 0) * avdMat4x4Val(*b, 0, j) +
+                                       avdMat4x4Val(*a, i, 1) * avdMat4x4Val(*b, 1, j) +
+                                       avdMat4x4Val(*a, i, 2) * avdMat4x4Val(*b, 2, j) +
+                                       avdMat4x4Val(*a, i, 3) * avdMat4x4Val(*b, 3, j);
         }
     }
 }
 
+void avdMat4x4MultiplyInplace(AVD_Matrix4x4 *out, const AVD_Matrix4x4 *b)
+{
+    AVD_ASSERT(out != NULL && b != NULL);
+    AVD_Matrix4x4 temp = *out;
+    PRIV_avdMat4x4Multiply(out, &temp, b);
+}
+
 AVD_Matrix4x4 avdMat4x4Multiply(const AVD_Matrix4x4 a, const AVD_Matrix4x4 b)
 {
-    AVD_Matrix4x4 result = a;
-    avdMat4x4MultiplyInplace(&result, &b);
+    AVD_Matrix4x4 result;
+    PRIV_avdMat4x4Multiply(&result, &a, &b);
     return result;
 }
 
+#endif
+
 AVD_Vector4 avdMat4x4MultiplyVec4(const AVD_Matrix4x4 mat, const AVD_Vector4 vec)
 {
     AVD_Vector4 result;
@@ -85,5 +94,3 @@ AVD_Vector4 avdMat4x4MultiplyVec4(const AVD_Matrix4x4 mat, const AVD_Vector4 vec
     }
     return result;
 }
-
-#endif
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "math/avd_matrix_non_simd.h"
+
+const char *avdMathBackendName(void)
+{
+#if defined(AVD_MATH_SIMD_AVX2)
+    return "avx2";
+#elif defined(AVD_MATH_SIMD_SSE2)
+    return "sse2";
+#elif defined(AVD_MATH_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+#ifdef AVD_MATH_SIMD
+
+// Every column of the result is the columns of a weighted by one column of b,
+// so b may alias out but a may not.
+#if defined(AVD_MATH_SIMD_AVX2)
+static void PRIV_avdMat4x4Multiply(AVD_Matrix4x4 *out, const AVD_Matrix4x4 *a, const AVD_Matrix4x4 *b)
+{
+    // each 256 bit register holds two columns, a column of a is duplicated into both halves
+    __m256 a0 = _mm256_broadcast_ps((const __m128 *)(a->m + 0));
+    __m256 a1 = _mm256_broadcast_ps((const __m128 *)(a->m + 4));
+    __m256 a2 = _mm256_broadcast_ps((const __m128 *)(a->m + 8));
+    __m256 a3 = _mm256_broadcast_ps((const __m128 *)(a->m + 12));
+
+    // b is often a matrix that was just written column by column, loading it
+    // in 128 bit halves keeps the loads forwardable from those stores
+    __m256 b01 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(b->m + 0)), _mm_loadu_ps(b->m + 4), 1);
+    __m256 b23 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(b->m + 8)), _mm_loadu_ps(b->m + 12), 1);
+
+    __m256 r01 = _mm256_mul_ps(a0, _mm256_permute_ps(b01, 0x00));
+    __m256 r23 = _mm256_mul_ps(a0, _mm256_permute_ps(b23, 0x00));
+    r01        = _mm256_fmadd_ps(a1, _mm256_permute_ps(b01, 0x55), r01);
+    r23        = _mm256_fmadd_ps(a1, _mm256_permute_ps(b23, 0x55), r23);
+    r01        = _mm256_fmadd_ps(a2, _mm256_permute_ps(b01, 0xAA), r01);
+    r23        = _mm256_fmadd_ps(a2, _mm256_permute_ps(b23, 0xAA), r23);
+    r01        = _mm256_fmadd_ps(a3, _mm256_permute_ps(b01, 0xFF), r01);
+    r23        = _mm256_fmadd_ps(a3, _mm256_permute_ps(b23, 0xFF), r23);
+
+    _mm256_storeu_ps(out->m + 0, r01);
+    _mm256_storeu_ps(out->m + 8, r23);
+}
+#else
+static void PRIV_avdMat4x4Multiply(AVD_Matrix4x4 *out, const AVD_Matrix4x4 *a, const AVD_Matrix4x4 *b)
+{
+    AVD_SimdFloat4 a0 = avdSimdLoad(a->m + 0);
+    AVD_SimdFloat4 a1 = avdSimdLoad(a->m + 4);
+    AVD_SimdFloat4 a2 = avdSimdLoad(a->m + 8);
+    AVD_SimdFloat4 a3 = avdSimdLoad(a->m + 12);
+
+    for (int j = 0; j < 16; j += 4) {
+        AVD_SimdFloat4 column = avdSimdLoad(b->m + j);
+        AVD_SimdFloat4 result = avdSimdMul(a0, avdSimdLane(column, 0));
+        result                = avdSimdMulAdd(a1, avdSimdLane(column, 1), result);
+        result                = avdSimdMulAdd(a2, avdSimdLane(column, 2), result);
+        result                = avdSimdMulAdd(a3, avdSimdLane(column, 3), result);
+        avdSimdStore(out->m + j, result);
+    }
+}
+#endif
+
+void avdMat4x4MultiplyInplace(AVD_Matrix4x4 *out, const AVD_Matrix4x4 *b)
+{
+    AVD_ASSERT(out != NULL && b != NULL);
+    AVD_Matrix4x4 temp = *out;
+    PRIV_avdMat4x4Multiply(out, &temp, b);
+}
+
+AVD_Matrix4x4 avdMat4x4Multiply(const AVD_Matrix4x4 a, const AVD_Matrix4x4 b)
+{
+    AVD_Matrix4x4 result;
+    PRIV_avdMat4x4Multiply(&result, &a, &b);
+    return result;
+}
+
+#endif
@@ -1,8 +1,6 @@
 #include "math/avd_matrix_non_simd.h"
 #include "math/avd_qaternion_non_simd.h"
 
-#ifndef AVD_USE_SIMD
-
 AVD_Quaternion avdQuatNormalize(const AVD_Quaternion q)
 {
     AVD_Float length = avdQuatLength(q);
@@ -31,6 +29,9 @@ AVD_Quaternion avdQuatInverse(const AVD_Quaternion q)
     return avdQuatIdentity();
 }
 
+// with a SIMD backend this one comes from avd_quaternion_simd.c
+#ifndef AVD_MATH_SIMD
+
 AVD_Vector3 avdQuatRotateVec3(const AVD_Quaternion q, const AVD_Vector3 v)
 {
     // Using the optimized formula: v' = v + 2 * q.xyz × (q.xyz × v + q.w * v)
@@ -41,6 +42,8 @@ AVD_Vector3 avdQuatRotateVec3(const AVD_Quaternion q, const AVD_Vector3 v)
     return avdVec3Add(v, avdVec3Add(avdVec3Scale(cross1, 2.0f * q.w), avdVec3Scale(cross2, 2.0f)));
 }
 
+#endif
+
 AVD_Quaternion avdQuatSlerp(const AVD_Quaternion a, const AVD_Quaternion b, AVD_Float t)
 {
     AVD_Float dot = avdQuatDot(a, b);
@@ -200,5 +203,3 @@ AVD_Quaternion avdQuatLookAt(const AVD_Vector3 forward, const AVD_Vector3 up)
 
     return avdQuatFromMatrix3x3(rotMat);
 }
-
-#endif
@@ -0,0 +1,31 @@
+#include "math/avd_matrix_non_simd.h"
+#include "math/avd_qaternion_non_simd.h"
+
+#ifdef AVD_MATH_SIMD
+
+// (a * b.yzx - a.yzx * b).yzx, the w lane stays zero when both inputs have it zero
+static inline AVD_SimdFloat4 PRIV_avdSimdCross3(AVD_SimdFloat4 a, AVD_SimdFloat4 b)
+{
+    AVD_SimdFloat4 aYzx = avdSimdShuffle(a, 1, 2, 0, 3);
+    AVD_SimdFloat4 bYzx = avdSimdShuffle(b, 1, 2, 0, 3);
+    AVD_SimdFloat4 c    = avdSimdSub(avdSimdMul(a, bYzx), avdSimdMul(aYzx, b));
+    return avdSimdShuffle(c, 1, 2, 0, 3);
+}
+
+AVD_Vector3 avdQuatRotateVec3(const AVD_Quaternion q, const AVD_Vector3 v)
+{
+    // v' = v + 2w * (q.xyz x v) + 2 * (q.xyz x (q.xyz x v)), same as the scalar version
+    AVD_SimdFloat4 qVec   = avdSimdSet(q.x, q.y, q.z, 0.0f);
+    AVD_SimdFloat4 value  = avdSimdSet(v.x, v.y, v.z, 0.0f);
+    AVD_SimdFloat4 cross1 = PRIV_avdSimdCross3(qVec, value);
+    AVD_SimdFloat4 cross2 = PRIV_avdSimdCross3(qVec, cross1);
+
+    AVD_SimdFloat4 result = avdSimdMulAdd(cross1, avdSimdSplat(2.0f * q.w), value);
+    result                = avdSimdMulAdd(cross2, avdSimdSplat(2.0f), result);
+
+    AVD_Float lanes[4];
+    avdSimdStore(lanes, result);
+    return avdVec3(lanes[0], lanes[1], lanes[2]);
+}
+
+#endif
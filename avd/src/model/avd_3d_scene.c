@@ -8,32 +8,28 @@ static void PRIV_avdModelDestructor(void *item, void *context)
     avdModelDestroy(model);
 }
 
-static void PRIV_avd3DScenePrintNodeHierarchy(const AVD_ModelNode *node, int indent, const AVD_ModelNode *mainScene)
+static void PRIV_avd3DScenePrintNodeHierarchy(const AVD_Model *model, int indent)
 {
-    if (node == NULL)
-        return;
+    for (AVD_Int32 index = AVD_MODEL_ROOT_NODE; index >= 0; index = avdModelNodeNext(model, AVD_MODEL_ROOT_NODE, index)) {
+        const AVD_ModelNode *node = avdModelGetNode(model, index);
 
-    for (int i = 0; i < indent; ++i) {
-        AVD_LOG_INFO(" ");
-    }
-
-    const char *marker = "";
-    if (node == mainScene) {
-        marker = " [MAIN SCENE]";
-    } else if (node->parent == NULL) {
-        marker = " [ROOT]";
-    }
+        for (int i = 0; i < indent + avdModelNodeDepth(model, index) * 2; ++i) {
+            AVD_LOG_INFO(" ");
+        }
 
-    AVD_LOG_INFO("Node: '%s' (ID=%d)%s", node->name, node->id, marker);
-    if (node->hasMesh) {
-        AVD_LOG_INFO(" -> Mesh: '%s'", node->mesh.name);
-    }
-    AVD_LOG_INFO("");
+        const char *marker = "";
+        if (index == model->mainScene) {
+            marker = " [MAIN SCENE]";
+        } else if (node->parent < 0) {
+            marker = " [ROOT]";
+        }
 
-    for (int i = 0; i < AVD_MODEL_NODE_MAX_CHILDREN; ++i) {
-        if (node->children[i] != NULL) {
-            PRIV_avd3DScenePrintNodeHierarchy(node->children[i], indent + 2, mainScene);
+        AVD_LOG_INFO("Node: '%s' (ID=%d)%s", node->name, node->id, marker);
+        const AVD_Mesh *mesh = avdModelGetNodeMesh(model, index);
+        if (mesh != NULL) {
+            AVD_LOG_INFO(" -> Mesh: '%s'", mesh->name);
         }
+        AVD_LOG_INFO("");
     }
 }
 
@@ -95,17 +91,15 @@ void avd3DSceneDebugLog(const AVD_3DScene *scene, const char *name)
                          j, mesh->name, mesh->id, mesh->triangleCount, mesh->indexOffset, morphInfo);
         }
 
-        AVD_LOG_INFO("    Node Count: %d\n", model->nodeCount);
-        if (model->rootNode != NULL) {
-            AVD_LOG_INFO("    Root Node: '%s' (ID=%d)\n", model->rootNode->name, model->rootNode->id);
-        }
-        if (model->mainScene != NULL) {
-            AVD_LOG_INFO("    Main Scene Node: '%s' (ID=%d)\n", model->mainScene->name, model->mainScene->id);
+        const AVD_ModelNode *rootNode = avdModelGetNode(model, AVD_MODEL_ROOT_NODE);
+        AVD_LOG_INFO("    Node Count: %d\n", avdModelNodeCount(model));
+        AVD_LOG_INFO("    Root Node: '%s' (ID=%d)\n", rootNode->name, rootNode->id);
+        if (model->mainScene >= 0) {
+            const AVD_ModelNode *mainScene = avdModelGetNode(model, model->mainScene);
+            AVD_LOG_INFO("    Main Scene Node: '%s' (ID=%d)\n", mainScene->name, mainScene->id);
         }
 
-        if (model->rootNode != NULL) {
-            AVD_LOG_INFO("    Node Hierarchy:");
-            PRIV_avd3DScenePrintNodeHierarchy(model->rootNode, 6, model->mainScene);
-        }
+        AVD_LOG_INFO("    Node Hierarchy:");
+        PRIV_avd3DScenePrintNodeHierarchy(model, 6);
     }
 }
@@ -20,7 +20,7 @@ static void PRIV_avdMeshGenCacheCreate(AVD_MeshGenMidpointCache *cache, size_t i
     AVD_ASSERT(initialCapacity > 0);
     cache->capacity = initialCapacity;
     cache->count    = 0;
-    cache->entries  = (AVD_MeshGenCacheEntry *)malloc(cache->capacity * sizeof(AVD_MeshGenCacheEntry));
+    cache->entries  = (AVD_MeshGenCacheEntry *)AVD_MALLOC(cache->capacity * sizeof(AVD_MeshGenCacheEntry));
     AVD_ASSERT(cache->entries != NULL);
     for (size_t i = 0; i < cache->capacity; ++i) {
         cache->entries[i].key = CACHE_EMPTY_KEY;
@@ -31,7 +31,7 @@ static void PRIV_avdMeshGenCacheDestroy(AVD_MeshGenMidpointCache *cache)
 {
     AVD_ASSERT(cache != NULL);
     if (cache->entries) {
-        free(cache->entries);
+        AVD_FREE(cache->entries);
         cache->entries  = NULL;
         cache->capacity = 0;
         cache->count    = 0;
@@ -54,7 +54,7 @@ static AVD_MeshGenCacheEntry *PRIV_avdMeshGenCacheFindEntry(AVD_MeshGenCacheEntr
 
 static void PRIV_avdMeshGenCacheResize(AVD_MeshGenMidpointCache *cache, size_t newCapacity)
 {
-    AVD_MeshGenCacheEntry *newEntries = (AVD_MeshGenCacheEntry *)malloc(newCapacity * sizeof(AVD_MeshGenCacheEntry));
+    AVD_MeshGenCacheEntry *newEntries = (AVD_MeshGenCacheEntry *)AVD_MALLOC(newCapacity * sizeof(AVD_MeshGenCacheEntry));
     AVD_ASSERT(newEntries != NULL);
     for (size_t i = 0; i < newCapacity; ++i) {
         newEntries[i].key = CACHE_EMPTY_KEY;
@@ -71,7 +71,7 @@ static void PRIV_avdMeshGenCacheResize(AVD_MeshGenMidpointCache *cache, size_t n
         }
     }
 
-    free(cache->entries);
+    AVD_FREE(cache->entries);
     cache->entries  = newEntries;
     cache->capacity = newCapacity;
 }
@@ -220,11 +220,16 @@ bool avdModelAddOctaSphere(
     }
 
     mesh.triangleCount = (AVD_Int32)(localIndices.count / 3);
-    avdListPushBack(&model->meshes, &mesh);
 
+    // subdividing leaves the triangles in a poor order for the vertex cache
+    AVD_UInt32 vertexCount = (AVD_UInt32)localVertices.count;
     avdListDestroy(&localVertices);
     avdListDestroy(&localIndices);
 
+    AVD_CHECK(avdMeshOptimize(&mesh, resources, baseVertexIndex, vertexCount, AVD_MESH_OPTIMIZE_VERTEX_CACHE | AVD_MESH_OPTIMIZE_VERTEX_FETCH, NULL, NULL));
+    AVD_CHECK(avdMeshComputeBounds(&mesh, resources));
+    avdListPushBack(&model->meshes, &mesh);
+
     return true;
 }
 
@@ -298,6 +303,7 @@ bool avdModelAddUnitCube(AVD_Model *model, AVD_ModelResources *resources, const
         avdListPushBack(&resources->indicesList, &finalIndex);
     }
 
+    AVD_CHECK(avdMeshComputeBounds(&mesh, resources));
     avdListPushBack(&model->meshes, &mesh);
 
     return true;
@@ -1,55 +1,272 @@
 #include "model/avd_model.h"
 
-bool avdModelNodePrepare(AVD_ModelNode *node, AVD_ModelNode *parent, const char *name, AVD_Int32 id)
+// Longest run of flagged nodes whose local matrices are built in one batch,
+// small enough that they are still in cache for the world matrices.
+#define AVD_MODEL_WORLD_UPDATE_BATCH 64
+
+static void PRIV_avdModelMarkNodeDirty(AVD_Model *model, AVD_Int32 index)
+{
+    AVD_ModelNodeMatrices *matrices = &model->nodeMatrices;
+    AVD_UInt8 *dirty                = (AVD_UInt8 *)matrices->dirty.items;
+    dirty[index]                    = 1;
+    if (matrices->firstDirty < 0 || index < matrices->firstDirty) {
+        matrices->firstDirty = index;
+    }
+}
+
+bool avdModelAddNode(AVD_Model *model, AVD_Int32 parent, const char *name, AVD_Int32 id, AVD_Int32 *outIndex)
 {
-    AVD_ASSERT(node != NULL);
+    AVD_ASSERT(model != NULL);
     AVD_ASSERT(name != NULL);
+    AVD_ASSERT(parent >= -1 && parent < (AVD_Int32)model->nodes.count);
 
-    memset(node, 0, sizeof(AVD_ModelNode));
+    AVD_Int32 index = (AVD_Int32)model->nodes.count;
+    AVD_CHECK_MSG(model->nodes.count < INT32_MAX, "Model '%s' has too many nodes", model->name);
+    AVD_CHECK(avdTransformStreamsReserve(&model->nodeTransforms, model->nodes.count + 1));
+
+    AVD_ModelNode *node = (AVD_ModelNode *)avdListAddEmpty(&model->nodes);
+    AVD_CHECK(node != NULL);
     snprintf(node->name, sizeof(node->name), "%s", name);
-    node->hasMesh   = false;
-    node->id        = id;
-    node->parent    = parent;
-    node->transform = avdTransformIdentity();
-
-    if (parent != NULL) {
-        bool couldPut = false;
-        for (size_t i = 0; i < AVD_MODEL_NODE_MAX_CHILDREN; i++) {
-            if (parent->children[i] == NULL) {
-                parent->children[i] = node;
-                couldPut            = true;
-                break;
-            }
+    node->id          = id;
+    node->parent      = parent;
+    node->firstChild  = -1;
+    node->lastChild   = -1;
+    node->nextSibling = -1;
+
+    AVD_Int32 noMesh = -1;
+    avdListPushBack(&model->nodeMeshes, &noMesh);
+    AVD_Transform identity = avdTransformIdentity();
+    avdTransformStreamsSet(&model->nodeTransforms, (AVD_Size)index, &identity, parent);
+
+    // filled in by the next update
+    AVD_ModelNodeMatrices *matrices = &model->nodeMatrices;
+    AVD_CHECK(avdListAddEmpty(&matrices->local) != NULL && avdListAddEmpty(&matrices->world) != NULL);
+    AVD_CHECK(avdListAddEmpty(&matrices->generations) != NULL && avdListAddEmpty(&matrices->dirty) != NULL);
+    PRIV_avdModelMarkNodeDirty(model, index);
+
+    if (parent >= 0) {
+        AVD_ModelNode *parentNode = avdModelGetNode(model, parent);
+        if (parentNode->lastChild >= 0) {
+            avdModelGetNode(model, parentNode->lastChild)->nextSibling = index;
+        } else {
+            parentNode->firstChild = index;
         }
-        AVD_CHECK_MSG(couldPut, "Parent node '%s' has no space for more children\n", parent->name);
+        parentNode->lastChild = index;
     }
 
+    if (outIndex != NULL) {
+        *outIndex = index;
+    }
     return true;
 }
 
-bool avdModelAllocNode(AVD_Model *model, AVD_ModelNode **outNode)
+void avdModelClearNodes(AVD_Model *model)
 {
     AVD_ASSERT(model != NULL);
-    AVD_ASSERT(outNode != NULL);
-    *outNode = &model->nodes[model->nodeCount++];
-    return true;
+    AVD_ASSERT(model->nodes.count > 0);
+
+    avdListResize(&model->nodes, 1);
+    avdListResize(&model->nodeMeshes, 1);
+    model->nodeTransforms.count = 1;
+
+    AVD_ModelNodeMatrices *matrices = &model->nodeMatrices;
+    avdListResize(&matrices->local, 1);
+    avdListResize(&matrices->world, 1);
+    avdListResize(&matrices->generations, 1);
+    avdListResize(&matrices->dirty, 1);
+    matrices->firstDirty   = ((const AVD_UInt8 *)matrices->dirty.items)[0] ? 0 : -1;
+    matrices->changedFirst = 0;
+    matrices->changedCount = 0;
+
+    AVD_ModelNode *root = avdModelGetNode(model, AVD_MODEL_ROOT_NODE);
+    root->firstChild    = -1;
+    root->lastChild     = -1;
+    model->mainScene    = -1;
+}
+
+AVD_Int32 avdModelNodeCount(const AVD_Model *model)
+{
+    AVD_ASSERT(model != NULL);
+    return (AVD_Int32)model->nodes.count;
+}
+
+AVD_ModelNode *avdModelGetNode(const AVD_Model *model, AVD_Int32 index)
+{
+    AVD_ASSERT(model != NULL);
+    AVD_ASSERT(index >= 0 && (AVD_Size)index < model->nodes.count);
+    return (AVD_ModelNode *)model->nodes.items + index;
+}
+
+AVD_Transform avdModelGetNodeTransform(const AVD_Model *model, AVD_Int32 index)
+{
+    AVD_ASSERT(model != NULL);
+    AVD_ASSERT(index >= 0);
+    return avdTransformStreamsGet(&model->nodeTransforms, (AVD_Size)index);
+}
+
+void avdModelSetNodeTransform(AVD_Model *model, AVD_Int32 index, const AVD_Transform *transform)
+{
+    AVD_ASSERT(model != NULL);
+    AVD_ASSERT(index >= 0 && (AVD_Size)index < model->nodes.count);
+    avdTransformStreamsSet(&model->nodeTransforms, (AVD_Size)index, transform, model->nodeTransforms.parents[index]);
+    PRIV_avdModelMarkNodeDirty(model, index);
+}
+
+AVD_Int32 avdModelGetNodeMeshIndex(const AVD_Model *model, AVD_Int32 index)
+{
+    AVD_ASSERT(model != NULL);
+    AVD_ASSERT(index >= 0 && (AVD_Size)index < model->nodeMeshes.count);
+    return ((const AVD_Int32 *)model->nodeMeshes.items)[index];
+}
+
+AVD_Mesh *avdModelGetNodeMesh(const AVD_Model *model, AVD_Int32 index)
+{
+    AVD_Int32 meshIndex = avdModelGetNodeMeshIndex(model, index);
+    return meshIndex >= 0 ? (AVD_Mesh *)avdListGet(&model->meshes, (AVD_Size)meshIndex) : NULL;
+}
+
+void avdModelSetNodeMesh(AVD_Model *model, AVD_Int32 index, AVD_Int32 meshIndex)
+{
+    AVD_ASSERT(model != NULL);
+    AVD_ASSERT(index >= 0 && (AVD_Size)index < model->nodeMeshes.count);
+    AVD_ASSERT(meshIndex >= -1 && meshIndex < (AVD_Int32)model->meshes.count);
+    ((AVD_Int32 *)model->nodeMeshes.items)[index] = meshIndex;
+}
+
+AVD_Int32 avdModelNodeDepth(const AVD_Model *model, AVD_Int32 index)
+{
+    AVD_Int32 depth = 0;
+    for (AVD_Int32 parent = avdModelGetNode(model, index)->parent; parent >= 0; parent = avdModelGetNode(model, parent)->parent) {
+        depth++;
+    }
+    return depth;
+}
+
+AVD_Int32 avdModelNodeNext(const AVD_Model *model, AVD_Int32 root, AVD_Int32 index)
+{
+    const AVD_ModelNode *node = avdModelGetNode(model, index);
+    if (node->firstChild >= 0) {
+        return node->firstChild;
+    }
+
+    // climb until a node with a sibling left, without leaving the subtree
+    while (index != root) {
+        if (node->nextSibling >= 0) {
+            return node->nextSibling;
+        }
+        index = node->parent;
+        node  = avdModelGetNode(model, index);
+    }
+    return -1;
+}
+
+void avdModelComputeWorldMatrices(const AVD_Model *model, AVD_Matrix4x4 *outWorld)
+{
+    AVD_ASSERT(model != NULL);
+    AVD_ASSERT(outWorld != NULL);
+    AVD_ASSERT(model->nodeTransforms.count == model->nodes.count);
+    avdTransformStreamsToWorldMatrices(&model->nodeTransforms, outWorld);
+}
+
+AVD_Int32 avdModelUpdateWorldMatrices(AVD_Model *model)
+{
+    AVD_ASSERT(model != NULL);
+    AVD_ASSERT(model->nodeTransforms.count == model->nodes.count);
+
+    AVD_ModelNodeMatrices *matrices = &model->nodeMatrices;
+    matrices->changedFirst          = 0;
+    matrices->changedCount          = 0;
+    if (matrices->firstDirty < 0) {
+        return 0;
+    }
+
+    AVD_Size count           = model->nodes.count;
+    AVD_UInt32 generation    = matrices->generation + 1;
+    AVD_UInt8 *dirty         = (AVD_UInt8 *)matrices->dirty.items;
+    AVD_UInt32 *generations  = (AVD_UInt32 *)matrices->generations.items;
+    AVD_Matrix4x4 *local     = (AVD_Matrix4x4 *)matrices->local.items;
+    AVD_Matrix4x4 *world     = (AVD_Matrix4x4 *)matrices->world.items;
+    const AVD_Int32 *parents = model->nodeTransforms.parents;
+    AVD_Int32 changed        = 0;
+    AVD_Size lastChanged     = (AVD_Size)matrices->firstDirty;
+
+    // nothing before the first flagged node changes, past it a node changes
+    // when it was flagged or its parent changed in this pass, and parents come
+    // first so that is already known
+    for (AVD_Size i = (AVD_Size)matrices->firstDirty; i < count;) {
+        if (dirty[i]) {
+            // runs of flagged nodes get their local matrices in batches
+            AVD_Size runEnd = i + 1;
+            while (runEnd < count && runEnd - i < AVD_MODEL_WORLD_UPDATE_BATCH && dirty[runEnd]) {
+                runEnd++;
+            }
+            avdTransformStreamsToMatrices(&model->nodeTransforms, i, runEnd - i, local + i);
+            changed += (AVD_Int32)(runEnd - i);
+            for (; i < runEnd; i++) {
+                AVD_Int32 parent = parents[i];
+                world[i]         = parent >= 0 ? avdMat4x4Multiply(world[parent], local[i]) : local[i];
+                generations[i]   = generation;
+                dirty[i]         = 0;
+            }
+            lastChanged = runEnd - 1;
+            continue;
+        }
+
+        AVD_Int32 parent = parents[i];
+        if (parent >= 0 && generations[parent] == generation) {
+            world[i]       = avdMat4x4Multiply(world[parent], local[i]);
+            generations[i] = generation;
+            lastChanged    = i;
+            changed++;
+        }
+        i++;
+    }
+
+    matrices->generation   = generation;
+    matrices->changedFirst = matrices->firstDirty;
+    matrices->changedCount = (AVD_Int32)(lastChanged + 1) - matrices->firstDirty;
+    matrices->firstDirty   = -1;
+    return changed;
+}
+
+const AVD_Matrix4x4 *avdModelGetWorldMatrices(const AVD_Model *model)
+{
+    AVD_ASSERT(model != NULL);
+    AVD_ASSERT(model->nodeMatrices.firstDirty < 0);
+    return (const AVD_Matrix4x4 *)model->nodeMatrices.world.items;
+}
+
+AVD_UInt32 avdModelGetNodeWorldGeneration(const AVD_Model *model, AVD_Int32 index)
+{
+    AVD_ASSERT(model != NULL);
+    AVD_ASSERT(index >= 0 && (AVD_Size)index < model->nodeMatrices.generations.count);
+    return ((const AVD_UInt32 *)model->nodeMatrices.generations.items)[index];
 }
 
 bool avdModelCreate(AVD_Model *model, AVD_Int32 id)
 {
     AVD_ASSERT(model != NULL);
     memset(model, 0, sizeof(AVD_Model));
-    model->id = id;
+    model->id        = id;
+    model->mainScene = -1;
     avdListCreate(&model->meshes, sizeof(AVD_Mesh));
-    model->nodes = calloc(AVD_MODEL_MAX_NODES, sizeof(AVD_ModelNode));
-    AVD_CHECK_MSG(model->nodes != NULL, "Failed to allocate memory for model nodes\n");
-    memset(model->nodes, 0, sizeof(AVD_ModelNode) * AVD_MODEL_MAX_NODES);
-
     avdListCreate(&model->morphTargets, sizeof(AVD_MorphTargets));
 
+    avdListCreate(&model->nodes, sizeof(AVD_ModelNode));
+    avdListCreate(&model->nodeMeshes, sizeof(AVD_Int32));
+    avdListEnsureCapacity(&model->nodes, AVD_MODEL_INITIAL_NODE_CAPACITY);
+    avdListEnsureCapacity(&model->nodeMeshes, AVD_MODEL_INITIAL_NODE_CAPACITY);
+    AVD_CHECK_MSG(avdTransformStreamsCreate(&model->nodeTransforms, AVD_MODEL_INITIAL_NODE_CAPACITY), "Failed to allocate memory for model nodes\n");
+
+    AVD_ModelNodeMatrices *matrices = &model->nodeMatrices;
+    avdListCreate(&matrices->local, sizeof(AVD_Matrix4x4));
+    avdListCreate(&matrices->world, sizeof(AVD_Matrix4x4));
+    avdListCreate(&matrices->generations, sizeof(AVD_UInt32));
+    avdListCreate(&matrices->dirty, sizeof(AVD_UInt8));
+    matrices->firstDirty = -1;
+
     // prepare the root node
-    AVD_CHECK(avdModelAllocNode(model, &model->rootNode));
-    avdModelNodePrepare(model->rootNode, NULL, "__Root", 0);
+    AVD_CHECK(avdModelAddNode(model, -1, "__Root", 0, NULL));
 
     return true;
 }
@@ -61,12 +278,20 @@ void avdModelDestroy(AVD_Model *model)
     model->id = -1;
     avdListDestroy(&model->meshes);
     avdListDestroy(&model->morphTargets);
-    free(model->nodes);
+    avdListDestroy(&model->nodes);
+    avdListDestroy(&model->nodeMeshes);
+    avdTransformStreamsDestroy(&model->nodeTransforms);
+    avdListDestroy(&model->nodeMatrices.local);
+    avdListDestroy(&model->nodeMatrices.world);
+    avdListDestroy(&model->nodeMatrices.generations);
+    avdListDestroy(&model->nodeMatrices.dirty);
 }
 
 bool avdMeshInit(AVD_Mesh *mesh)
 {
-    *mesh = (AVD_Mesh){0};
+    *mesh                = (AVD_Mesh){0};
+    mesh->bounds         = avdAABBEmpty();
+    mesh->boundingSphere = avdSphereFromAABB(&mesh->bounds);
     return true;
 }
 
@@ -78,4 +303,94 @@ bool avdMeshInitWithNameId(AVD_Mesh *mesh, const char *name, AVD_Int32 id)
     mesh->id = id;
 
     return true;
-}
\ No newline at end of file
+}
+static AVD_Vector3 PRIV_avdMeshVertexPosition(const AVD_ModelVertexPacked *vertex)
+{
+    return avdVec3(avdDequantizeHalf(vertex->vx), avdDequantizeHalf(vertex->vy), avdDequantizeHalf(vertex->vz));
+}
+
+bool avdMeshComputeBounds(AVD_Mesh *mesh, const AVD_ModelResources *resources)
+{
+    AVD_ASSERT(mesh != NULL);
+    AVD_ASSERT(resources != NULL);
+
+    AVD_Size indexCount = (AVD_Size)mesh->triangleCount * 3;
+    AVD_CHECK_MSG((AVD_Size)mesh->indexOffset + indexCount <= resources->indicesList.count, "Mesh '%s' references indices past the end of the index list", mesh->name);
+
+    // positions are decoded from the packed vertices like the shaders do, so
+    // the bounds cover what actually gets drawn
+    const AVD_UInt32 *indices             = (const AVD_UInt32 *)resources->indicesList.items + mesh->indexOffset;
+    const AVD_ModelVertexPacked *vertices = (const AVD_ModelVertexPacked *)resources->verticesList.items;
+
+    mesh->bounds = avdAABBEmpty();
+    for (AVD_Size i = 0; i < indexCount; i++) {
+        AVD_ASSERT(indices[i] < resources->verticesList.count);
+        avdAABBExtend(&mesh->bounds, PRIV_avdMeshVertexPosition(&vertices[indices[i]]));
+    }
+
+    // centered on the box but only as large as the farthest vertex, which is
+    // tighter than the sphere around the box corners
+    mesh->boundingSphere = avdSphereFromAABB(&mesh->bounds);
+    if (!avdAABBIsEmpty(mesh->bounds)) {
+        AVD_Float radiusSq = 0.0f;
+        for (AVD_Size i = 0; i < indexCount; i++) {
+            AVD_Vector3 offset = avdVec3Subtract(PRIV_avdMeshVertexPosition(&vertices[indices[i]]), mesh->boundingSphere.center);
+            radiusSq           = avdMax(radiusSq, avdVec3LengthSq(offset));
+        }
+        mesh->boundingSphere.radius = avdSqrt(radiusSq);
+    }
+
+    return true;
+}
+
+bool avdMeshBuildBvh(const AVD_Mesh *mesh, const AVD_ModelResources *resources, AVD_Bvh *outBvh)
+{
+    AVD_ASSERT(mesh != NULL);
+    AVD_ASSERT(resources != NULL);
+    AVD_ASSERT(outBvh != NULL);
+
+    AVD_Size indexCount = (AVD_Size)mesh->triangleCount * 3;
+    AVD_CHECK_MSG((AVD_Size)mesh->indexOffset + indexCount <= resources->indicesList.count, "Mesh '%s' references indices past the end of the index list", mesh->name);
+
+    const AVD_UInt32 *indices             = (const AVD_UInt32 *)resources->indicesList.items + mesh->indexOffset;
+    const AVD_ModelVertexPacked *vertices = (const AVD_ModelVertexPacked *)resources->verticesList.items;
+
+    if (indexCount == 0) {
+        return avdBvhBuild(outBvh, NULL, NULL, 0);
+    }
+
+    // only the vertex range the mesh uses is decoded, the indices are rebased onto it
+    AVD_UInt32 firstVertex = UINT32_MAX;
+    AVD_UInt32 lastVertex  = 0;
+    for (AVD_Size i = 0; i < indexCount; i++) {
+        AVD_ASSERT(indices[i] < resources->verticesList.count);
+        firstVertex = AVD_MIN(firstVertex, indices[i]);
+        lastVertex  = AVD_MAX(lastVertex, indices[i]);
+    }
+
+    AVD_Size vertexCount     = (AVD_Size)(lastVertex - firstVertex) + 1;
+    AVD_Vector3 *positions   = (AVD_Vector3 *)AVD_MALLOC(sizeof(AVD_Vector3) * vertexCount);
+    AVD_UInt32 *localIndices = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * indexCount);
+    if (positions == NULL || localIndices == NULL) {
+        if (positions != NULL) {
+            AVD_FREE(positions);
+        }
+        if (localIndices != NULL) {
+            AVD_FREE(localIndices);
+        }
+        AVD_LOG_ERROR("Failed to allocate the BVH input of mesh '%s'", mesh->name);
+        return false;
+    }
+
+    for (AVD_Size i = 0; i < vertexCount; i++) {
+        positions[i] = PRIV_avdMeshVertexPosition(&vertices[firstVertex + i]);
+    }
+    for (AVD_Size i = 0; i < indexCount; i++) {
+        localIndices[i] = indices[i] - firstVertex;
+    }
+
+    bool built = avdBvhBuild(outBvh, positions, localIndices, (AVD_Size)mesh->triangleCount);
+    AVD_FREE(positions);
+    AVD_FREE(localIndices);
+    return built;
+}
@@ -80,6 +80,11 @@ bool avdModelResourcesCreate(AVD_ModelResources *resources)
 
     avdListCreate(&resources->verticesList, sizeof(AVD_ModelVertexPacked));
     avdListCreate(&resources->indicesList, sizeof(uint32_t));
+    avdListCreate(&resources->meshletsList, sizeof(AVD_Meshlet));
+    avdListCreate(&resources->meshletVerticesList, sizeof(uint32_t));
+    avdListCreate(&resources->meshletTrianglesList, sizeof(uint32_t));
+    avdListCreate(&resources->morphTargetsList, sizeof(AVD_MorphTargetDeltas));
+    avdListCreate(&resources->morphDeltasList, sizeof(uint32_t));
 
     return true;
 }
@@ -90,4 +95,9 @@ void avdModelResourcesDestroy(AVD_ModelResources *resources)
 
     avdListDestroy(&resources->verticesList);
     avdListDestroy(&resources->indicesList);
+    avdListDestroy(&resources->meshletsList);
+    avdListDestroy(&resources->meshletVerticesList);
+    avdListDestroy(&resources->meshletTrianglesList);
+    avdListDestroy(&resources->morphTargetsList);
+    avdListDestroy(&resources->morphDeltasList);
 }
\ No newline at end of file
@@ -0,0 +1,665 @@
+#include "model/avd_model_cache.h"
+#include "model/avd_model_morph.h"
+
+// Every section starts on a cache line, so the vertex and index sections of a
+// mapped file can be handed to an upload as they are.
+#define AVD_MODEL_CACHE_ALIGNMENT 64
+
+// Rebased indices are written through a buffer of this many values.
+#define AVD_MODEL_CACHE_WRITE_CHUNK 4096
+
+static const char PRIV_avdModelCacheMagic[8] = {'A', 'V', 'D', 'M', 'E', 'S', 'H', '\0'};
+
+typedef enum {
+    AVD_MODEL_CACHE_SECTION_VERTICES = 0,
+    AVD_MODEL_CACHE_SECTION_INDICES,
+    AVD_MODEL_CACHE_SECTION_MESHES,
+    AVD_MODEL_CACHE_SECTION_MESH_MORPH_SETS,
+    AVD_MODEL_CACHE_SECTION_MORPH_SETS,
+    AVD_MODEL_CACHE_SECTION_MORPH_TARGETS,
+    AVD_MODEL_CACHE_SECTION_NODES,
+    AVD_MODEL_CACHE_SECTION_MESHLETS,
+    AVD_MODEL_CACHE_SECTION_MESHLET_VERTICES,
+    AVD_MODEL_CACHE_SECTION_MESHLET_TRIANGLES,
+    AVD_MODEL_CACHE_SECTION_MORPH_TARGET_DELTAS,
+    AVD_MODEL_CACHE_SECTION_MORPH_DELTAS,
+    AVD_MODEL_CACHE_SECTION_COUNT,
+} AVD_ModelCacheSectionType;
+
+typedef struct {
+    AVD_UInt64 offset; // from the start of the file
+    AVD_UInt64 count;
+    AVD_UInt32 stride; // catches layout changes that missed a version bump
+    AVD_UInt32 reserved;
+} AVD_ModelCacheSection;
+
+// Offsets and vertex indices in the sections are relative to the model, they
+// are rebased onto the lists the model is loaded into.
+typedef struct {
+    char magic[8];
+    AVD_UInt32 version;
+    AVD_UInt32 headerSize;
+    AVD_UInt64 key;
+    AVD_UInt64 payloadHash; // of everything after the header
+    AVD_UInt64 fileSize;
+
+    char modelName[256];
+    AVD_Int32 modelId;
+    AVD_Int32 mainSceneNode; // -1 for none
+    AVD_Int32 dependencyCount;
+    AVD_Int32 reserved;
+    AVD_ModelCacheDependency dependencies[AVD_MODEL_CACHE_MAX_DEPENDENCIES];
+
+    AVD_ModelCacheSection sections[AVD_MODEL_CACHE_SECTION_COUNT];
+} AVD_ModelCacheHeader;
+
+// The nodes past the root, in the order they were allocated so that every
+// parent comes before its children.
+typedef struct {
+    char name[256];
+    AVD_Int32 id;
+    AVD_Int32 parent; // index into the nodes of the model, the root is 0
+    AVD_Int32 mesh;   // index into the meshes of the model, -1 for none
+    AVD_Int32 reserved;
+    AVD_Transform transform;
+} AVD_ModelCacheNode;
+
+typedef struct {
+    FILE *file;
+    AVD_HashState payloadHash;
+    AVD_UInt64 offset;
+    bool ok;
+} AVD_ModelCacheWriter;
+
+static const AVD_UInt32 PRIV_avdModelCacheStrides[AVD_MODEL_CACHE_SECTION_COUNT] = {
+    [AVD_MODEL_CACHE_SECTION_VERTICES]            = sizeof(AVD_ModelVertexPacked),
+    [AVD_MODEL_CACHE_SECTION_INDICES]             = sizeof(AVD_UInt32),
+    [AVD_MODEL_CACHE_SECTION_MESHES]              = sizeof(AVD_Mesh),
+    [AVD_MODEL_CACHE_SECTION_MESH_MORPH_SETS]     = sizeof(AVD_Int32),
+    [AVD_MODEL_CACHE_SECTION_MORPH_SETS]          = sizeof(AVD_Int32),
+    [AVD_MODEL_CACHE_SECTION_MORPH_TARGETS]       = sizeof(AVD_MorphTarget),
+    [AVD_MODEL_CACHE_SECTION_NODES]               = sizeof(AVD_ModelCacheNode),
+    [AVD_MODEL_CACHE_SECTION_MESHLETS]            = sizeof(AVD_Meshlet),
+    [AVD_MODEL_CACHE_SECTION_MESHLET_VERTICES]    = sizeof(AVD_UInt32),
+    [AVD_MODEL_CACHE_SECTION_MESHLET_TRIANGLES]   = sizeof(AVD_UInt32),
+    [AVD_MODEL_CACHE_SECTION_MORPH_TARGET_DELTAS] = sizeof(AVD_MorphTargetDeltas),
+    [AVD_MODEL_CACHE_SECTION_MORPH_DELTAS]        = sizeof(AVD_UInt32),
+};
+
+static bool PRIV_avdModelCacheHashFile(const char *path, AVD_UInt64 *outHash)
+{
+    AVD_FileView *view = NULL;
+    if (!avdPathExists(path) || !avdFileViewOpen(path, AVD_FILE_VIEW_FLAG_SEQUENTIAL, &view)) {
+        return false;
+    }
+    *outHash = avdHash64(view->data, view->size, AVD_HASH_DEFAULT_SEED);
+    avdFileViewRelease(view);
+    return true;
+}
+
+bool avdModelCacheBegin(AVD_ModelCache *cache, const char *sourcePath, const char *loaderName, AVD_UInt32 loadFlags, const AVD_ModelResources *resources)
+{
+    AVD_ASSERT(cache != NULL);
+    AVD_ASSERT(sourcePath != NULL);
+    AVD_ASSERT(loaderName != NULL);
+    AVD_ASSERT(resources != NULL);
+
+    memset(cache, 0, sizeof(AVD_ModelCache));
+    cache->vertexBase          = resources->verticesList.count;
+    cache->indexBase           = resources->indicesList.count;
+    cache->meshletBase         = resources->meshletsList.count;
+    cache->meshletVertexBase   = resources->meshletVerticesList.count;
+    cache->meshletTriangleBase = resources->meshletTrianglesList.count;
+    cache->morphTargetBase     = resources->morphTargetsList.count;
+    cache->morphDeltaBase      = resources->morphDeltasList.count;
+
+#if AVD_MODEL_CACHE_ENABLED
+    cache->enabled = true;
+    if (!avdModelCacheAddDependency(cache, sourcePath)) {
+        return false;
+    }
+
+    AVD_UInt64 key = avdHash64Combine(cache->dependencies[0].hash, avdHash64String(loaderName));
+    key            = avdHash64Combine(key, (AVD_UInt64)loadFlags);
+    key            = avdHash64Combine(key, (AVD_UInt64)AVD_MODEL_CACHE_VERSION);
+    cache->key     = key;
+
+    const char *baseName = sourcePath;
+    for (const char *c = sourcePath; *c != '\0'; c++) {
+        if (*c == '/' || *c == '\\') {
+            baseName = c + 1;
+        }
+    }
+    snprintf(cache->path, sizeof(cache->path), "%savd_%s.%s.%016llx.avdmesh", avdGetTempDirPath(), baseName, loaderName, (unsigned long long)key);
+    return true;
+#else
+    (void)loaderName;
+    (void)loadFlags;
+    return false;
+#endif
+}
+
+bool avdModelCacheAddDependency(AVD_ModelCache *cache, const char *path)
+{
+    AVD_ASSERT(cache != NULL);
+    AVD_ASSERT(path != NULL);
+
+    if (!cache->enabled) {
+        return false;
+    }
+
+    AVD_ModelCacheDependency *dependency = &cache->dependencies[cache->dependencyCount];
+    if (cache->dependencyCount >= AVD_MODEL_CACHE_MAX_DEPENDENCIES || strlen(path) >= sizeof(dependency->path)) {
+        AVD_LOG_WARN("Not caching the model loaded from '%s', too many or too long dependencies", cache->dependencies[0].path);
+        cache->enabled = false;
+        return false;
+    }
+    if (!PRIV_avdModelCacheHashFile(path, &dependency->hash)) {
+        AVD_LOG_WARN("Not caching the model, could not read '%s'", path);
+        cache->enabled = false;
+        return false;
+    }
+    snprintf(dependency->path, sizeof(dependency->path), "%s", path);
+    cache->dependencyCount++;
+    return true;
+}
+
+static void PRIV_avdModelCacheWriterWrite(AVD_ModelCacheWriter *writer, const void *data, AVD_Size size)
+{
+    if (!writer->ok || size == 0) {
+        return;
+    }
+    writer->ok = fwrite(data, 1, size, writer->file) == size;
+    avdHashStateUpdate(&writer->payloadHash, data, size);
+    writer->offset += size;
+}
+
+static void PRIV_avdModelCacheWriterBeginSection(AVD_ModelCacheWriter *writer, AVD_ModelCacheHeader *header, AVD_ModelCacheSectionType type, AVD_Size count)
+{
+    static const AVD_UInt8 zeros[AVD_MODEL_CACHE_ALIGNMENT] = {0};
+    PRIV_avdModelCacheWriterWrite(writer, zeros, (AVD_Size)(AVD_ALIGN(writer->offset, AVD_MODEL_CACHE_ALIGNMENT) - writer->offset));
+
+    header->sections[type] = (AVD_ModelCacheSection){
+        .offset = writer->offset,
+        .count  = (AVD_UInt64)count,
+        .stride = PRIV_avdModelCacheStrides[type],
+    };
+}
+
+static void PRIV_avdModelCacheWriterWriteRebased(AVD_ModelCacheWriter *writer, const AVD_UInt32 *values, AVD_Size count, AVD_Size base)
+{
+    AVD_UInt32 chunk[AVD_MODEL_CACHE_WRITE_CHUNK];
+    for (AVD_Size start = 0; start < count; start += AVD_MODEL_CACHE_WRITE_CHUNK) {
+        AVD_Size chunkCount = AVD_MIN(count - start, (AVD_Size)AVD_MODEL_CACHE_WRITE_CHUNK);
+        for (AVD_Size i = 0; i < chunkCount; i++) {
+            chunk[i] = values[start + i] - (AVD_UInt32)base;
+        }
+        PRIV_avdModelCacheWriterWrite(writer, chunk, sizeof(AVD_UInt32) * chunkCount);
+    }
+}
+
+static AVD_Int32 PRIV_avdModelCacheFindMorphSet(const AVD_Model *model, const AVD_MorphTargets *morphTargets)
+{
+    for (AVD_Size i = 0; morphTargets != NULL && i < model->morphTargets.count; i++) {
+        if ((const AVD_MorphTargets *)avdListGet(&model->morphTargets, i) == morphTargets) {
+            return (AVD_Int32)i;
+        }
+    }
+    return -1;
+}
+
+// The tables of the model in their cached form, with offsets relative to the
+// model and indices in place of pointers.
+typedef struct {
+    AVD_Mesh *meshes;
+    AVD_Int32 *meshMorphSets;
+    AVD_Int32 *morphSets;
+    AVD_MorphTarget *morphTargets;
+    AVD_Size morphTargetCount;
+    AVD_ModelCacheNode *nodes;
+    AVD_Size nodeCount;
+    AVD_Meshlet *meshlets;
+    AVD_Size meshletCount;
+    AVD_MorphTargetDeltas *morphTargetDeltas;
+    AVD_Size morphTargetDeltaCount;
+} AVD_ModelCacheTables;
+
+static void PRIV_avdModelCacheTablesDestroy(AVD_ModelCacheTables *tables)
+{
+    void *allocations[] = {tables->meshes, tables->meshMorphSets, tables->morphSets, tables->morphTargets, tables->nodes, tables->meshlets, tables->morphTargetDeltas};
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(allocations); i++) {
+        if (allocations[i] != NULL) {
+            AVD_FREE(allocations[i]);
+        }
+    }
+    memset(tables, 0, sizeof(AVD_ModelCacheTables));
+}
+
+static bool PRIV_avdModelCacheTablesCreate(AVD_ModelCacheTables *tables, const AVD_ModelCache *cache, const AVD_Model *model, const AVD_ModelResources *resources)
+{
+    memset(tables, 0, sizeof(AVD_ModelCacheTables));
+
+    AVD_Size meshCount            = model->meshes.count;
+    AVD_Size morphSetCount        = model->morphTargets.count;
+    tables->nodeCount             = (AVD_Size)avdModelNodeCount(model) - 1;
+    tables->meshletCount          = resources->meshletsList.count - cache->meshletBase;
+    tables->morphTargetDeltaCount = resources->morphTargetsList.count - cache->morphTargetBase;
+    for (AVD_Size i = 0; i < morphSetCount; i++) {
+        tables->morphTargetCount += (AVD_Size)((const AVD_MorphTargets *)avdListGet(&model->morphTargets, i))->count;
+    }
+
+    // one more than needed of each so that empty tables are still allocated
+    tables->meshes            = (AVD_Mesh *)AVD_MALLOC(sizeof(AVD_Mesh) * (meshCount + 1));
+    tables->meshMorphSets     = (AVD_Int32 *)AVD_MALLOC(sizeof(AVD_Int32) * (meshCount + 1));
+    tables->morphSets         = (AVD_Int32 *)AVD_MALLOC(sizeof(AVD_Int32) * (morphSetCount + 1));
+    tables->morphTargets      = (AVD_MorphTarget *)AVD_MALLOC(sizeof(AVD_MorphTarget) * (tables->morphTargetCount + 1));
+    tables->nodes             = (AVD_ModelCacheNode *)AVD_MALLOC(sizeof(AVD_ModelCacheNode) * (tables->nodeCount + 1));
+    tables->meshlets          = (AVD_Meshlet *)AVD_MALLOC(sizeof(AVD_Meshlet) * (tables->meshletCount + 1));
+    tables->morphTargetDeltas = (AVD_MorphTargetDeltas *)AVD_MALLOC(sizeof(AVD_MorphTargetDeltas) * (tables->morphTargetDeltaCount + 1));
+    if (tables->meshes == NULL || tables->meshMorphSets == NULL || tables->morphSets == NULL || tables->morphTargets == NULL || tables->nodes == NULL || tables->meshlets == NULL ||
+        tables->morphTargetDeltas == NULL) {
+        PRIV_avdModelCacheTablesDestroy(tables);
+        AVD_CHECK_MSG(false, "Failed to allocate the cache tables of model '%s'", model->name);
+    }
+
+    AVD_Size morphTargetCursor = 0;
+    for (AVD_Size i = 0; i < morphSetCount; i++) {
+        const AVD_MorphTargets *set = (const AVD_MorphTargets *)avdListGet(&model->morphTargets, i);
+        tables->morphSets[i]        = set->count;
+        memcpy(tables->morphTargets + morphTargetCursor, set->targets, sizeof(AVD_MorphTarget) * (AVD_Size)set->count);
+        morphTargetCursor += (AVD_Size)set->count;
+    }
+
+    bool ok = true;
+    for (AVD_Size i = 0; ok && i < meshCount; i++) {
+        AVD_Mesh *mesh = &tables->meshes[i];
+        *mesh          = *(const AVD_Mesh *)avdListGet(&model->meshes, i);
+
+        // meshes keep a pointer into the morph target list, which moves when
+        // the list grows, such a model is not cached rather than guessed at
+        tables->meshMorphSets[i] = PRIV_avdModelCacheFindMorphSet(model, mesh->morphTargets);
+        ok                       = mesh->morphTargets == NULL || tables->meshMorphSets[i] >= 0;
+
+        mesh->morphTargets = NULL;
+        mesh->indexOffset -= (AVD_Int32)cache->indexBase;
+        mesh->meshletOffset -= mesh->meshletCount > 0 ? (AVD_Int32)cache->meshletBase : 0;
+        for (AVD_Int32 level = 0; level < mesh->lodCount; level++) {
+            mesh->lods[level].indexOffset -= (AVD_Int32)cache->indexBase;
+        }
+        if (mesh->morphTargetCount > 0) {
+            mesh->morphTargetOffset -= (AVD_Int32)cache->morphTargetBase;
+            mesh->morphVertexOffset -= (AVD_Int32)cache->vertexBase;
+        }
+    }
+
+    for (AVD_Size i = 0; i < tables->nodeCount; i++) {
+        AVD_Int32 index           = (AVD_Int32)i + 1;
+        const AVD_ModelNode *node = avdModelGetNode(model, index);
+        AVD_ModelCacheNode *entry = &tables->nodes[i];
+        memset(entry, 0, sizeof(AVD_ModelCacheNode));
+        snprintf(entry->name, sizeof(entry->name), "%s", node->name);
+        entry->id        = node->id;
+        entry->parent    = node->parent;
+        entry->mesh      = avdModelGetNodeMeshIndex(model, index);
+        entry->transform = avdModelGetNodeTransform(model, index);
+    }
+
+    for (AVD_Size i = 0; i < tables->meshletCount; i++) {
+        AVD_Meshlet *meshlet = &tables->meshlets[i];
+        *meshlet             = *(const AVD_Meshlet *)avdListGet(&resources->meshletsList, cache->meshletBase + i);
+        meshlet->vertexOffset -= (uint32_t)cache->meshletVertexBase;
+        meshlet->triangleOffset -= (uint32_t)cache->meshletTriangleBase;
+    }
+
+    // the delta vertices are relative to the mesh already
+    for (AVD_Size i = 0; i < tables->morphTargetDeltaCount; i++) {
+        AVD_MorphTargetDeltas *target = &tables->morphTargetDeltas[i];
+        *target                       = *(const AVD_MorphTargetDeltas *)avdListGet(&resources->morphTargetsList, cache->morphTargetBase + i);
+        target->deltaOffset -= (uint32_t)cache->morphDeltaBase;
+    }
+
+    if (!ok) {
+        PRIV_avdModelCacheTablesDestroy(tables);
+        AVD_LOG_WARN("Not caching model '%s', its morph targets can not be stored", model->name);
+        return false;
+    }
+    return true;
+}
+
+static bool PRIV_avdModelCacheWriteFile(
+    const char *path,
+    const AVD_ModelCache *cache,
+    const AVD_Model *model,
+    const AVD_ModelResources *resources,
+    const AVD_ModelCacheTables *tables)
+{
+    AVD_ModelCacheHeader header = {0};
+    memcpy(header.magic, PRIV_avdModelCacheMagic, sizeof(header.magic));
+    header.version         = AVD_MODEL_CACHE_VERSION;
+    header.headerSize      = (AVD_UInt32)sizeof(AVD_ModelCacheHeader);
+    header.key             = cache->key;
+    header.modelId         = model->id;
+    header.mainSceneNode   = model->mainScene;
+    header.dependencyCount = cache->dependencyCount;
+    snprintf(header.modelName, sizeof(header.modelName), "%s", model->name);
+    memcpy(header.dependencies, cache->dependencies, sizeof(header.dependencies));
+
+    AVD_ModelCacheWriter writer = {.file = fopen(path, "wb"), .ok = true};
+    AVD_CHECK_MSG(writer.file != NULL, "Failed to open model cache file for writing: %s", path);
+
+    // the header is written again once the sections are known
+    writer.ok     = fwrite(&header, sizeof(header), 1, writer.file) == 1;
+    writer.offset = sizeof(header);
+    avdHashStateInit(&writer.payloadHash, AVD_HASH_DEFAULT_SEED);
+
+    const AVD_List *vertices = &resources->verticesList;
+    AVD_Size vertexCount     = vertices->count - cache->vertexBase;
+    PRIV_avdModelCacheWriterBeginSection(&writer, &header, AVD_MODEL_CACHE_SECTION_VERTICES, vertexCount);
+    PRIV_avdModelCacheWriterWrite(&writer, (const AVD_ModelVertexPacked *)vertices->items + cache->vertexBase, sizeof(AVD_ModelVertexPacked) * vertexCount);
+
+    AVD_Size indexCount = resources->indicesList.count - cache->indexBase;
+    PRIV_avdModelCacheWriterBeginSection(&writer, &header, AVD_MODEL_CACHE_SECTION_INDICES, indexCount);
+    PRIV_avdModelCacheWriterWriteRebased(&writer, (const AVD_UInt32 *)resources->indicesList.items + cache->indexBase, indexCount, cache->vertexBase);
+
+    PRIV_avdModelCacheWriterBeginSection(&writer, &header, AVD_MODEL_CACHE_SECTION_MESHES, model->meshes.count);
+    PRIV_avdModelCacheWriterWrite(&writer, tables->meshes, sizeof(AVD_Mesh) * model->meshes.count);
+    PRIV_avdModelCacheWriterBeginSection(&writer, &header, AVD_MODEL_CACHE_SECTION_MESH_MORPH_SETS, model->meshes.count);
+    PRIV_avdModelCacheWriterWrite(&writer, tables->meshMorphSets, sizeof(AVD_Int32) * model->meshes.count);
+    PRIV_avdModelCacheWriterBeginSection(&writer, &header, AVD_MODEL_CACHE_SECTION_MORPH_SETS, model->morphTargets.count);
+    PRIV_avdModelCacheWriterWrite(&writer, tables->morphSets, sizeof(AVD_Int32) * model->morphTargets.count);
+    PRIV_avdModelCacheWriterBeginSection(&writer, &header, AVD_MODEL_CACHE_SECTION_MORPH_TARGETS, tables->morphTargetCount);
+    PRIV_avdModelCacheWriterWrite(&writer, tables->morphTargets, sizeof(AVD_MorphTarget) * tables->morphTargetCount);
+    PRIV_avdModelCacheWriterBeginSection(&writer, &header, AVD_MODEL_CACHE_SECTION_NODES, tables->nodeCount);
+    PRIV_avdModelCacheWriterWrite(&writer, tables->nodes, sizeof(AVD_ModelCacheNode) * tables->nodeCount);
+
+    PRIV_avdModelCacheWriterBeginSection(&writer, &header, AVD_MODEL_CACHE_SECTION_MESHLETS, tables->meshletCount);
+    PRIV_avdModelCacheWriterWrite(&writer, tables->meshlets, sizeof(AVD_Meshlet) * tables->meshletCount);
+    AVD_Size meshletVertexCount = resources->meshletVerticesList.count - cache->meshletVertexBase;
+    PRIV_avdModelCacheWriterBeginSection(&writer, &header, AVD_MODEL_CACHE_SECTION_MESHLET_VERTICES, meshletVertexCount);
+    PRIV_avdModelCacheWriterWriteRebased(&writer, (const AVD_UInt32 *)resources->meshletVerticesList.items + cache->meshletVertexBase, meshletVertexCount, cache->vertexBase);
+    AVD_Size meshletTriangleCount = resources->meshletTrianglesList.count - cache->meshletTriangleBase;
+    PRIV_avdModelCacheWriterBeginSection(&writer, &header, AVD_MODEL_CACHE_SECTION_MESHLET_TRIANGLES, meshletTriangleCount);
+    PRIV_avdModelCacheWriterWrite(&writer, (const AVD_UInt32 *)resources->meshletTrianglesList.items + cache->meshletTriangleBase, sizeof(AVD_UInt32) * meshletTriangleCount);
+
+    PRIV_avdModelCacheWriterBeginSection(&writer, &header, AVD_MODEL_CACHE_SECTION_MORPH_TARGET_DELTAS, tables->morphTargetDeltaCount);
+    PRIV_avdModelCacheWriterWrite(&writer, tables->morphTargetDeltas, sizeof(AVD_MorphTargetDeltas) * tables->morphTargetDeltaCount);
+    AVD_Size morphDeltaCount = resources->morphDeltasList.count - cache->morphDeltaBase;
+    PRIV_avdModelCacheWriterBeginSection(&writer, &header, AVD_MODEL_CACHE_SECTION_MORPH_DELTAS, morphDeltaCount);
+    PRIV_avdModelCacheWriterWrite(&writer, (const AVD_UInt32 *)resources->morphDeltasList.items + cache->morphDeltaBase, sizeof(AVD_UInt32) * morphDeltaCount);
+
+    header.fileSize    = writer.offset;
+    header.payloadHash = avdHashStateDigest(&writer.payloadHash);
+    writer.ok          = writer.ok && fseek(writer.file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, writer.file) == 1;
+    writer.ok          = fclose(writer.file) == 0 && writer.ok;
+    AVD_CHECK_MSG(writer.ok, "Failed to write model cache file: %s", path);
+    return true;
+}
+
+bool avdModelCacheWrite(const AVD_ModelCache *cache, const AVD_Model *model, const AVD_ModelResources *resources)
+{
+    AVD_ASSERT(cache != NULL);
+    AVD_ASSERT(model != NULL);
+    AVD_ASSERT(resources != NULL);
+
+    if (!cache->enabled) {
+        return true;
+    }
+
+    AVD_ModelCacheTables tables = {0};
+    if (!PRIV_avdModelCacheTablesCreate(&tables, cache, model, resources)) {
+        return false;
+    }
+
+    // written next to the final name and renamed, so that a crash or a second
+    // instance never sees a half written file
+    char temporaryPath[sizeof(cache->path) + 16];
+    snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", cache->path);
+    bool written = PRIV_avdModelCacheWriteFile(temporaryPath, cache, model, resources, &tables);
+    PRIV_avdModelCacheTablesDestroy(&tables);
+    if (written) {
+        remove(cache->path);
+        written = rename(temporaryPath, cache->path) == 0;
+    }
+    if (!written) {
+        remove(temporaryPath);
+        AVD_CHECK_MSG(false, "Failed to store model cache file: %s", cache->path);
+    }
+
+    AVD_LOG_INFO("Model cache saved: %s", cache->path);
+    return true;
+}
+
+static const void *PRIV_avdModelCacheSectionData(const AVD_FileView *view, const AVD_ModelCacheHeader *header, AVD_ModelCacheSectionType type)
+{
+    return (const AVD_UInt8 *)view->data + header->sections[type].offset;
+}
+
+static bool PRIV_avdModelCacheValidate(const AVD_ModelCache *cache, const AVD_FileView *view)
+{
+    AVD_CHECK_MSG(view->size >= sizeof(AVD_ModelCacheHeader), "Model cache file is truncated");
+    const AVD_ModelCacheHeader *header = (const AVD_ModelCacheHeader *)view->data;
+    AVD_CHECK_MSG(memcmp(header->magic, PRIV_avdModelCacheMagic, sizeof(header->magic)) == 0, "Not a model cache file");
+    AVD_CHECK_MSG(header->version == AVD_MODEL_CACHE_VERSION && header->headerSize == sizeof(AVD_ModelCacheHeader), "Model cache file is from version %u", header->version);
+    AVD_CHECK_MSG(header->key == cache->key && header->fileSize == view->size, "Model cache file does not match its name or size");
+    AVD_CHECK_MSG(header->dependencyCount >= 1 && header->dependencyCount <= AVD_MODEL_CACHE_MAX_DEPENDENCIES, "Model cache file has %d dependencies", header->dependencyCount);
+
+    for (AVD_ModelCacheSectionType type = 0; type < AVD_MODEL_CACHE_SECTION_COUNT; type++) {
+        const AVD_ModelCacheSection *section = &header->sections[type];
+        AVD_CHECK_MSG(section->stride == PRIV_avdModelCacheStrides[type], "Model cache section %d has a stride of %u", type, section->stride);
+        AVD_CHECK_MSG(
+            section->offset % AVD_MODEL_CACHE_ALIGNMENT == 0 && section->offset >= sizeof(AVD_ModelCacheHeader) && section->offset <= view->size &&
+                section->count <= (view->size - section->offset) / section->stride,
+            "Model cache section %d is out of bounds",
+            type);
+    }
+    AVD_CHECK_MSG(header->sections[AVD_MODEL_CACHE_SECTION_MESH_MORPH_SETS].count == header->sections[AVD_MODEL_CACHE_SECTION_MESHES].count, "Model cache morph sets do not match the meshes");
+    AVD_CHECK_MSG(header->sections[AVD_MODEL_CACHE_SECTION_NODES].count < INT32_MAX, "Model cache file has too many nodes");
+
+    AVD_UInt64 payloadHash = avdHash64((const AVD_UInt8 *)view->data + sizeof(AVD_ModelCacheHeader), view->size - sizeof(AVD_ModelCacheHeader), AVD_HASH_DEFAULT_SEED);
+    AVD_CHECK_MSG(payloadHash == header->payloadHash, "Model cache file is corrupted");
+
+    // the main source is part of the key, the rest has to be hashed again
+    for (AVD_Int32 i = 1; i < header->dependencyCount; i++) {
+        const AVD_ModelCacheDependency *dependency = &header->dependencies[i];
+        AVD_UInt64 hash                            = 0;
+        AVD_CHECK_MSG(
+            memchr(dependency->path, '\0', sizeof(dependency->path)) != NULL && PRIV_avdModelCacheHashFile(dependency->path, &hash) && hash == dependency->hash,
+            "Model cache dependency '%.*s' changed",
+            (int)sizeof(dependency->path),
+            dependency->path);
+    }
+    return true;
+}
+
+static void PRIV_avdModelCacheRollback(const AVD_ModelCache *cache, AVD_Model *model, AVD_ModelResources *resources)
+{
+    avdListResize(&resources->verticesList, cache->vertexBase);
+    avdListResize(&resources->indicesList, cache->indexBase);
+    avdListResize(&resources->meshletsList, cache->meshletBase);
+    avdListResize(&resources->meshletVerticesList, cache->meshletVertexBase);
+    avdListResize(&resources->meshletTrianglesList, cache->meshletTriangleBase);
+    avdListResize(&resources->morphTargetsList, cache->morphTargetBase);
+    avdListResize(&resources->morphDeltasList, cache->morphDeltaBase);
+
+    avdListClear(&model->meshes);
+    avdListClear(&model->morphTargets);
+    avdModelClearNodes(model);
+}
+
+// Adds count values to the list, rebased by base and checked against limit.
+static bool PRIV_avdModelCacheAppendRebased(AVD_List *list, const AVD_UInt32 *values, AVD_Size count, AVD_Size base, AVD_Size limit)
+{
+    AVD_UInt32 *out = (AVD_UInt32 *)avdListAddEmptyN(list, count);
+    AVD_CHECK(out != NULL || count == 0);
+    for (AVD_Size i = 0; i < count; i++) {
+        AVD_CHECK_MSG(values[i] < limit, "Model cache file references vertex %u of %zu", values[i], limit);
+        out[i] = values[i] + (AVD_UInt32)base;
+    }
+    return true;
+}
+
+static bool PRIV_avdModelCacheApply(const AVD_FileView *view, AVD_Model *model, AVD_ModelResources *resources)
+{
+    const AVD_ModelCacheHeader *header   = (const AVD_ModelCacheHeader *)view->data;
+    const AVD_ModelCacheSection *section = header->sections;
+    AVD_Size vertexBase                  = resources->verticesList.count;
+    AVD_Size indexBase                   = resources->indicesList.count;
+    AVD_Size meshletBase                 = resources->meshletsList.count;
+    AVD_Size meshletVertexBase           = resources->meshletVerticesList.count;
+    AVD_Size meshletTriangleBase         = resources->meshletTrianglesList.count;
+    AVD_Size morphTargetBase             = resources->morphTargetsList.count;
+    AVD_Size morphDeltaBase              = resources->morphDeltasList.count;
+    AVD_Size vertexCount                 = (AVD_Size)section[AVD_MODEL_CACHE_SECTION_VERTICES].count;
+    AVD_Size indexCount                  = (AVD_Size)section[AVD_MODEL_CACHE_SECTION_INDICES].count;
+    AVD_Size meshletCount                = (AVD_Size)section[AVD_MODEL_CACHE_SECTION_MESHLETS].count;
+    AVD_Size meshletVertexCount          = (AVD_Size)section[AVD_MODEL_CACHE_SECTION_MESHLET_VERTICES].count;
+    AVD_Size meshletTriangleCount        = (AVD_Size)section[AVD_MODEL_CACHE_SECTION_MESHLET_TRIANGLES].count;
+    AVD_Size morphTargetCount            = (AVD_Size)section[AVD_MODEL_CACHE_SECTION_MORPH_TARGET_DELTAS].count;
+    AVD_Size morphDeltaCount             = (AVD_Size)section[AVD_MODEL_CACHE_SECTION_MORPH_DELTAS].count;
+
+    snprintf(model->name, sizeof(model->name), "%.*s", (int)sizeof(header->modelName), header->modelName);
+    model->id = header->modelId;
+
+    AVD_ModelVertexPacked *vertices = (AVD_ModelVertexPacked *)avdListAddEmptyN(&resources->verticesList, vertexCount);
+    AVD_CHECK(vertices != NULL || vertexCount == 0);
+    memcpy(vertices, PRIV_avdModelCacheSectionData(view, header, AVD_MODEL_CACHE_SECTION_VERTICES), sizeof(AVD_ModelVertexPacked) * vertexCount);
+    AVD_CHECK(PRIV_avdModelCacheAppendRebased(&resources->indicesList, PRIV_avdModelCacheSectionData(view, header, AVD_MODEL_CACHE_SECTION_INDICES), indexCount, vertexBase, vertexCount));
+    AVD_CHECK(PRIV_avdModelCacheAppendRebased(&resources->meshletVerticesList, PRIV_avdModelCacheSectionData(view, header, AVD_MODEL_CACHE_SECTION_MESHLET_VERTICES), meshletVertexCount, vertexBase, vertexCount));
+    AVD_UInt32 *meshletTriangles = (AVD_UInt32 *)avdListAddEmptyN(&resources->meshletTrianglesList, meshletTriangleCount);
+    AVD_CHECK(meshletTriangles != NULL || meshletTriangleCount == 0);
+    memcpy(meshletTriangles, PRIV_avdModelCacheSectionData(view, header, AVD_MODEL_CACHE_SECTION_MESHLET_TRIANGLES), sizeof(AVD_UInt32) * meshletTriangleCount);
+
+    const AVD_Meshlet *sourceMeshlets = PRIV_avdModelCacheSectionData(view, header, AVD_MODEL_CACHE_SECTION_MESHLETS);
+    for (AVD_Size i = 0; i < meshletCount; i++) {
+        AVD_Meshlet meshlet = sourceMeshlets[i];
+        AVD_CHECK_MSG(
+            (AVD_Size)meshlet.vertexOffset + meshlet.vertexCount <= meshletVertexCount && (AVD_Size)meshlet.triangleOffset + meshlet.triangleCount <= meshletTriangleCount,
+            "Model cache meshlet %zu is out of bounds",
+            i);
+        meshlet.vertexOffset += (uint32_t)meshletVertexBase;
+        meshlet.triangleOffset += (uint32_t)meshletTriangleBase;
+        avdListPushBack(&resources->meshletsList, &meshlet);
+    }
+
+    AVD_UInt32 *morphDeltas = (AVD_UInt32 *)avdListAddEmptyN(&resources->morphDeltasList, morphDeltaCount);
+    AVD_CHECK(morphDeltas != NULL || morphDeltaCount == 0);
+    memcpy(morphDeltas, PRIV_avdModelCacheSectionData(view, header, AVD_MODEL_CACHE_SECTION_MORPH_DELTAS), sizeof(AVD_UInt32) * morphDeltaCount);
+    const AVD_MorphTargetDeltas *sourceTargets = PRIV_avdModelCacheSectionData(view, header, AVD_MODEL_CACHE_SECTION_MORPH_TARGET_DELTAS);
+    for (AVD_Size i = 0; i < morphTargetCount; i++) {
+        AVD_MorphTargetDeltas target = sourceTargets[i];
+        AVD_CHECK_MSG(
+            target.encoding <= AVD_MORPH_DELTA_ENCODING_QUANTIZED &&
+                (AVD_Size)target.deltaOffset + (AVD_Size)target.deltaCount * avdMorphDeltaWords((AVD_MorphDeltaEncoding)target.encoding) <= morphDeltaCount,
+            "Model cache morph target %zu is out of bounds",
+            i);
+        target.deltaOffset += (uint32_t)morphDeltaBase;
+        avdListPushBack(&resources->morphTargetsList, &target);
+    }
+
+    // every set is added before any mesh points at one
+    const AVD_Int32 *morphSets          = PRIV_avdModelCacheSectionData(view, header, AVD_MODEL_CACHE_SECTION_MORPH_SETS);
+    const AVD_MorphTarget *morphTargets = PRIV_avdModelCacheSectionData(view, header, AVD_MODEL_CACHE_SECTION_MORPH_TARGETS);
+    AVD_Size morphTargetCursor          = 0;
+    for (AVD_Size i = 0; i < section[AVD_MODEL_CACHE_SECTION_MORPH_SETS].count; i++) {
+        AVD_CHECK_MSG(
+            morphSets[i] >= 0 && morphSets[i] <= AVD_MAX_MORPH_TARGETS_PER_MESH && morphTargetCursor + (AVD_Size)morphSets[i] <= section[AVD_MODEL_CACHE_SECTION_MORPH_TARGETS].count,
+            "Model cache morph target set %zu is out of bounds",
+            i);
+        AVD_MorphTargets *set = (AVD_MorphTargets *)avdListAddEmpty(&model->morphTargets);
+        AVD_CHECK(set != NULL);
+        set->count = morphSets[i];
+        memcpy(set->targets, morphTargets + morphTargetCursor, sizeof(AVD_MorphTarget) * (AVD_Size)morphSets[i]);
+        morphTargetCursor += (AVD_Size)morphSets[i];
+    }
+
+    const AVD_Mesh *meshes         = PRIV_avdModelCacheSectionData(view, header, AVD_MODEL_CACHE_SECTION_MESHES);
+    const AVD_Int32 *meshMorphSets = PRIV_avdModelCacheSectionData(view, header, AVD_MODEL_CACHE_SECTION_MESH_MORPH_SETS);
+    for (AVD_Size i = 0; i < section[AVD_MODEL_CACHE_SECTION_MESHES].count; i++) {
+        AVD_Mesh mesh = meshes[i];
+        AVD_CHECK_MSG(
+            mesh.indexOffset >= 0 && mesh.triangleCount >= 0 && (AVD_Size)mesh.indexOffset + (AVD_Size)mesh.triangleCount * 3 <= indexCount &&
+                mesh.lodCount >= 0 && mesh.lodCount <= AVD_MESH_MAX_LODS &&
+                mesh.meshletOffset >= 0 && mesh.meshletCount >= 0 && (AVD_Size)mesh.meshletOffset + (AVD_Size)mesh.meshletCount <= meshletCount &&
+                meshMorphSets[i] >= -1 && meshMorphSets[i] < (AVD_Int32)model->morphTargets.count &&
+                mesh.morphTargetOffset >= 0 && mesh.morphTargetCount >= 0 && (AVD_Size)mesh.morphTargetOffset + (AVD_Size)mesh.morphTargetCount <= morphTargetCount &&
+                mesh.morphVertexOffset >= 0 && mesh.morphVertexCount >= 0 && (AVD_Size)mesh.morphVertexOffset + (AVD_Size)mesh.morphVertexCount <= vertexCount,
+            "Model cache mesh %zu is out of bounds",
+            i);
+        mesh.name[sizeof(mesh.name) - 1] = '\0';
+        mesh.indexOffset += (AVD_Int32)indexBase;
+        mesh.meshletOffset += mesh.meshletCount > 0 ? (AVD_Int32)meshletBase : 0;
+        for (AVD_Int32 level = 0; level < mesh.lodCount; level++) {
+            AVD_MeshLod *lod = &mesh.lods[level];
+            AVD_CHECK_MSG(lod->indexOffset >= 0 && lod->triangleCount >= 0 && (AVD_Size)lod->indexOffset + (AVD_Size)lod->triangleCount * 3 <= indexCount, "Model cache level of detail is out of bounds");
+            lod->indexOffset += (AVD_Int32)indexBase;
+        }
+        if (mesh.morphTargetCount > 0) {
+            mesh.morphTargetOffset += (AVD_Int32)morphTargetBase;
+            mesh.morphVertexOffset += (AVD_Int32)vertexBase;
+            for (AVD_Int32 target = 0; target < mesh.morphTargetCount; target++) {
+                const AVD_MorphTargetDeltas *deltas = (const AVD_MorphTargetDeltas *)avdListGet(&resources->morphTargetsList, (AVD_Size)(mesh.morphTargetOffset + target));
+                AVD_UInt32 stride                   = avdMorphDeltaWords((AVD_MorphDeltaEncoding)deltas->encoding);
+                const AVD_UInt32 *words             = (const AVD_UInt32 *)resources->morphDeltasList.items + deltas->deltaOffset;
+                for (AVD_UInt32 j = 0; j < deltas->deltaCount; j++) {
+                    AVD_CHECK_MSG(words[j * stride] < (AVD_UInt32)mesh.morphVertexCount, "Model cache morph target of mesh %zu moves a vertex outside of its range", i);
+                }
+            }
+        }
+        mesh.morphTargets = meshMorphSets[i] >= 0 ? (AVD_MorphTargets *)avdListGet(&model->morphTargets, (AVD_Size)meshMorphSets[i]) : NULL;
+        avdListPushBack(&model->meshes, &mesh);
+    }
+
+    const AVD_ModelCacheNode *nodes = PRIV_avdModelCacheSectionData(view, header, AVD_MODEL_CACHE_SECTION_NODES);
+    for (AVD_Size i = 0; i < section[AVD_MODEL_CACHE_SECTION_NODES].count; i++) {
+        const AVD_ModelCacheNode *entry = &nodes[i];
+        AVD_CHECK_MSG(
+            entry->parent >= 0 && entry->parent < avdModelNodeCount(model) && entry->mesh >= -1 && entry->mesh < (AVD_Int32)model->meshes.count,
+            "Model cache node %zu is out of bounds",
+            i);
+
+        char name[sizeof(entry->name)];
+        snprintf(name, sizeof(name), "%.*s", (int)sizeof(entry->name) - 1, entry->name);
+        AVD_Int32 index = -1;
+        AVD_CHECK(avdModelAddNode(model, entry->parent, name, entry->id, &index));
+        avdModelSetNodeTransform(model, index, &entry->transform);
+        avdModelSetNodeMesh(model, index, entry->mesh);
+    }
+    AVD_CHECK_MSG(header->mainSceneNode >= -1 && header->mainSceneNode < avdModelNodeCount(model), "Model cache main scene is out of bounds");
+    model->mainScene = header->mainSceneNode;
+    return true;
+}
+
+bool avdModelCacheRead(AVD_ModelCache *cache, AVD_Model *model, AVD_ModelResources *resources)
+{
+    AVD_ASSERT(cache != NULL);
+    AVD_ASSERT(model != NULL);
+    AVD_ASSERT(resources != NULL);
+    AVD_ASSERT(avdModelNodeCount(model) == 1 && model->meshes.count == 0 && model->morphTargets.count == 0);
+
+    if (!cache->enabled || !avdPathExists(cache->path)) {
+        return false;
+    }
+
+    AVD_FileView *view = NULL;
+    if (!avdFileViewOpen(cache->path, AVD_FILE_VIEW_FLAG_WILL_NEED, &view)) {
+        return false;
+    }
+
+    bool loaded = PRIV_avdModelCacheValidate(cache, view);
+    if (loaded) {
+        const AVD_ModelCacheHeader *header = (const AVD_ModelCacheHeader *)view->data;
+        cache->dependencyCount             = header->dependencyCount;
+        memcpy(cache->dependencies, header->dependencies, sizeof(cache->dependencies));
+
+        loaded = PRIV_avdModelCacheApply(view, model, resources);
+        if (!loaded) {
+            PRIV_avdModelCacheRollback(cache, model, resources);
+        }
+    }
+    avdFileViewRelease(view);
+
+    if (!loaded) {
+        AVD_LOG_WARN("Ignoring model cache file: %s", cache->path);
+    }
+    return loaded;
+}
@@ -0,0 +1,307 @@
+#include "core/avd_core.h"
+#include "model/avd_model_cache.h"
+#include "model/avd_model_lod.h"
+#include "model/avd_model_meshlets.h"
+#include "model/avd_model_morph.h"
+
+typedef struct {
+    char sourcePath[1024];
+    char dependencyPath[1024];
+    AVD_ModelCache cache;
+    AVD_Model model;
+    AVD_ModelResources resources;
+} AVD_ModelCacheTest;
+
+static bool PRIV_avdModelCacheTestWriteFile(const char *path, const char *content)
+{
+    return avdWriteBinaryFile(path, content, strlen(content));
+}
+
+// A sphere with levels of detail and meshlets under a cube with morph
+// targets, after a model that is not cached so that nothing starts at zero.
+static bool PRIV_avdModelCacheTestCreate(AVD_ModelCacheTest *test, AVD_UInt32 subdivisions)
+{
+    memset(test, 0, sizeof(AVD_ModelCacheTest));
+    snprintf(test->sourcePath, sizeof(test->sourcePath), "%savd_model_cache_test_%u.obj", avdGetTempDirPath(), subdivisions);
+    snprintf(test->dependencyPath, sizeof(test->dependencyPath), "%savd_model_cache_test_%u.mtl", avdGetTempDirPath(), subdivisions);
+    AVD_CHECK(PRIV_avdModelCacheTestWriteFile(test->sourcePath, "o CacheTest\n"));
+    AVD_CHECK(PRIV_avdModelCacheTestWriteFile(test->dependencyPath, "newmtl CacheTest\n"));
+    AVD_CHECK(avdModelResourcesCreate(&test->resources));
+
+    AVD_Model other = {0};
+    AVD_CHECK(avdModelCreate(&other, 0));
+    AVD_CHECK(avdModelAddUnitCube(&other, &test->resources, "Other", 0));
+    AVD_CHECK(avdMeshBuildMeshlets((AVD_Mesh *)avdListGet(&other.meshes, 0), &test->resources));
+    avdModelDestroy(&other);
+
+    AVD_CHECK(avdModelCacheBegin(&test->cache, test->sourcePath, "test", subdivisions, &test->resources));
+    AVD_CHECK(avdModelCacheAddDependency(&test->cache, test->dependencyPath));
+
+    AVD_Model *model = &test->model;
+    AVD_CHECK(avdModelCreate(model, 7));
+    snprintf(model->name, sizeof(model->name), "CacheTest");
+    AVD_CHECK(avdModelAddOctaSphere(model, &test->resources, "Sphere", 1, 1.0f, subdivisions));
+    AVD_UInt32 cubeFirstVertex = (AVD_UInt32)test->resources.verticesList.count;
+    AVD_CHECK(avdModelAddUnitCube(model, &test->resources, "Cube", 2));
+    AVD_UInt32 cubeVertexCount = (AVD_UInt32)test->resources.verticesList.count - cubeFirstVertex;
+    AVD_Mesh *sphere           = (AVD_Mesh *)avdListGet(&model->meshes, 0);
+    AVD_Mesh *cube             = (AVD_Mesh *)avdListGet(&model->meshes, 1);
+    AVD_CHECK(avdMeshBuildLods(sphere, &test->resources, NULL));
+    AVD_CHECK(avdMeshBuildMeshlets(sphere, &test->resources));
+    snprintf(cube->material.albedoTexture.path, sizeof(cube->material.albedoTexture.path), "cube_albedo.png");
+
+    AVD_MorphTargets *morphTargets  = (AVD_MorphTargets *)avdListAddEmpty(&model->morphTargets);
+    morphTargets->count             = 2;
+    morphTargets->targets[1].weight = 0.25f;
+    snprintf(morphTargets->targets[1].name, sizeof(morphTargets->targets[1].name), "Open");
+    cube->morphTargets = morphTargets;
+
+    // one target of each encoding, moving every third vertex of the cube
+    AVD_List targets          = {0};
+    AVD_List deltas           = {0};
+    AVD_Float offsets[3 * 64] = {0};
+    AVD_CHECK(cubeVertexCount <= 64);
+    for (AVD_UInt32 i = 0; i < cubeVertexCount; i += 3) {
+        offsets[3 * i + 1] = 0.125f * (AVD_Float)(i + 1);
+    }
+    avdListCreate(&targets, sizeof(AVD_MorphTargetDeltas));
+    avdListCreate(&deltas, sizeof(AVD_UInt32));
+    bool built = avdMorphTargetBuild(&targets, &deltas, offsets, NULL, cubeVertexCount, AVD_MORPH_DELTA_ENCODING_FLOAT);
+    built      = built && avdMorphTargetBuild(&targets, &deltas, offsets, NULL, cubeVertexCount, AVD_MORPH_DELTA_ENCODING_QUANTIZED);
+    built      = built && avdMeshAddMorphTargets(cube, &test->resources, cubeFirstVertex, cubeVertexCount, &targets, &deltas);
+    avdListDestroy(&targets);
+    avdListDestroy(&deltas);
+    AVD_CHECK(built);
+
+    AVD_Int32 sphereNode    = -1;
+    AVD_Int32 cubeNode      = -1;
+    AVD_Transform transform = avdTransformIdentity();
+    transform.position      = avdVec3(1.0f, 2.0f, 3.0f);
+    AVD_CHECK(avdModelAddNode(model, AVD_MODEL_ROOT_NODE, "SphereNode", 3, &sphereNode));
+    avdModelSetNodeMesh(model, sphereNode, 0);
+    AVD_CHECK(avdModelAddNode(model, sphereNode, "CubeNode", 4, &cubeNode));
+    avdModelSetNodeMesh(model, cubeNode, 1);
+    avdModelSetNodeTransform(model, cubeNode, &transform);
+    model->mainScene = sphereNode;
+    return true;
+}
+
+static void PRIV_avdModelCacheTestDestroy(AVD_ModelCacheTest *test)
+{
+    avdModelDestroy(&test->model);
+    avdModelResourcesDestroy(&test->resources);
+    remove(test->sourcePath);
+    remove(test->dependencyPath);
+    remove(test->cache.path);
+}
+
+static bool PRIV_avdModelCacheTestCompareMesh(const AVD_Mesh *a, const AVD_ModelResources *resourcesA, const AVD_Mesh *b, const AVD_ModelResources *resourcesB, AVD_Int64 vertexShift)
+{
+    AVD_CHECK(strcmp(a->name, b->name) == 0 && a->id == b->id && a->triangleCount == b->triangleCount);
+    AVD_CHECK(a->lodCount == b->lodCount && a->meshletCount == b->meshletCount);
+    AVD_CHECK(memcmp(&a->bounds, &b->bounds, sizeof(a->bounds)) == 0 && memcmp(&a->material, &b->material, sizeof(a->material)) == 0);
+    AVD_CHECK((a->morphTargets == NULL) == (b->morphTargets == NULL));
+    AVD_CHECK(a->morphTargets == NULL || memcmp(a->morphTargets, b->morphTargets, sizeof(AVD_MorphTargets)) == 0);
+    AVD_CHECK(a->morphTargetCount == b->morphTargetCount && a->morphVertexCount == b->morphVertexCount);
+    AVD_CHECK(a->morphTargetCount == 0 || (AVD_Int64)a->morphVertexOffset + vertexShift == (AVD_Int64)b->morphVertexOffset);
+    for (AVD_Int32 i = 0; i < a->morphTargetCount; i++) {
+        const AVD_MorphTargetDeltas *targetA = (const AVD_MorphTargetDeltas *)avdListGet(&resourcesA->morphTargetsList, (AVD_Size)(a->morphTargetOffset + i));
+        const AVD_MorphTargetDeltas *targetB = (const AVD_MorphTargetDeltas *)avdListGet(&resourcesB->morphTargetsList, (AVD_Size)(b->morphTargetOffset + i));
+        AVD_CHECK(targetA->deltaCount == targetB->deltaCount && targetA->encoding == targetB->encoding && targetA->positionScale == targetB->positionScale);
+        for (AVD_UInt32 j = 0; j < targetA->deltaCount; j++) {
+            AVD_MorphDelta deltaA = {0};
+            AVD_MorphDelta deltaB = {0};
+            avdMorphTargetGetDelta(resourcesA, targetA, j, &deltaA);
+            avdMorphTargetGetDelta(resourcesB, targetB, j, &deltaB);
+            AVD_CHECK(memcmp(&deltaA, &deltaB, sizeof(AVD_MorphDelta)) == 0);
+        }
+    }
+
+    for (AVD_Int32 level = 0; level < AVD_MAX(a->lodCount, 1); level++) {
+        AVD_MeshLod lodA = avdMeshGetLod(a, level);
+        AVD_MeshLod lodB = avdMeshGetLod(b, level);
+        AVD_CHECK(lodA.triangleCount == lodB.triangleCount && lodA.error == lodB.error);
+        for (AVD_Int32 i = 0; i < lodA.triangleCount * 3; i++) {
+            AVD_UInt32 indexA = *(const AVD_UInt32 *)avdListGet(&resourcesA->indicesList, (AVD_Size)(lodA.indexOffset + i));
+            AVD_UInt32 indexB = *(const AVD_UInt32 *)avdListGet(&resourcesB->indicesList, (AVD_Size)(lodB.indexOffset + i));
+            AVD_CHECK((AVD_Int64)indexA + vertexShift == (AVD_Int64)indexB);
+            AVD_CHECK(memcmp(avdListGet(&resourcesA->verticesList, indexA), avdListGet(&resourcesB->verticesList, indexB), sizeof(AVD_ModelVertexPacked)) == 0);
+        }
+    }
+
+    for (AVD_Int32 i = 0; i < a->meshletCount; i++) {
+        const AVD_Meshlet *meshletA = (const AVD_Meshlet *)avdListGet(&resourcesA->meshletsList, (AVD_Size)(a->meshletOffset + i));
+        const AVD_Meshlet *meshletB = (const AVD_Meshlet *)avdListGet(&resourcesB->meshletsList, (AVD_Size)(b->meshletOffset + i));
+        AVD_CHECK(meshletA->vertexCount == meshletB->vertexCount && meshletA->triangleCount == meshletB->triangleCount);
+        AVD_CHECK(memcmp(meshletA->center, meshletB->center, sizeof(meshletA->center)) == 0);
+        for (AVD_UInt32 j = 0; j < meshletA->vertexCount; j++) {
+            AVD_UInt32 vertexA = *(const AVD_UInt32 *)avdListGet(&resourcesA->meshletVerticesList, meshletA->vertexOffset + j);
+            AVD_UInt32 vertexB = *(const AVD_UInt32 *)avdListGet(&resourcesB->meshletVerticesList, meshletB->vertexOffset + j);
+            AVD_CHECK((AVD_Int64)vertexA + vertexShift == (AVD_Int64)vertexB);
+        }
+        for (AVD_UInt32 j = 0; j < meshletA->triangleCount; j++) {
+            AVD_CHECK(*(const AVD_UInt32 *)avdListGet(&resourcesA->meshletTrianglesList, meshletA->triangleOffset + j) == *(const AVD_UInt32 *)avdListGet(&resourcesB->meshletTrianglesList, meshletB->triangleOffset + j));
+        }
+    }
+    return true;
+}
+
+static bool PRIV_avdModelCacheTestRoundTrip(void)
+{
+    AVD_ModelCacheTest test = {0};
+    AVD_CHECK(PRIV_avdModelCacheTestCreate(&test, 3));
+    remove(test.cache.path);
+    AVD_CHECK(avdModelCacheWrite(&test.cache, &test.model, &test.resources));
+
+    // loaded into the same resources, behind the original
+    AVD_Size vertexBase     = test.resources.verticesList.count;
+    AVD_ModelCache readback = {0};
+    AVD_Model model         = {0};
+    AVD_CHECK(avdModelCreate(&model, 0));
+    AVD_CHECK(avdModelCacheBegin(&readback, test.sourcePath, "test", 3, &test.resources));
+    AVD_CHECK_MSG(strcmp(readback.path, test.cache.path) == 0, "The cache path is not stable: %s", readback.path);
+    bool loaded = avdModelCacheRead(&readback, &model, &test.resources);
+
+    bool ok = loaded && strcmp(model.name, test.model.name) == 0 && model.id == test.model.id;
+    ok      = ok && model.meshes.count == test.model.meshes.count && model.morphTargets.count == 1 && avdModelNodeCount(&model) == avdModelNodeCount(&test.model);
+    ok      = ok && readback.dependencyCount == 2 && test.resources.verticesList.count - vertexBase == vertexBase - test.cache.vertexBase;
+    for (AVD_Size i = 0; ok && i < model.meshes.count; i++) {
+        ok = PRIV_avdModelCacheTestCompareMesh(avdListGet(&test.model.meshes, i), &test.resources, avdListGet(&model.meshes, i), &test.resources, (AVD_Int64)(vertexBase - test.cache.vertexBase));
+    }
+    ok = ok && ((const AVD_Mesh *)avdListGet(&model.meshes, 1))->morphTargets == avdListGet(&model.morphTargets, 0);
+    ok = ok && ((const AVD_Mesh *)avdListGet(&model.meshes, 1))->morphTargetCount == 2;
+    for (AVD_Int32 i = 1; ok && i < avdModelNodeCount(&model); i++) {
+        const AVD_ModelNode *expected = avdModelGetNode(&test.model, i);
+        const AVD_ModelNode *node     = avdModelGetNode(&model, i);
+        AVD_Transform expectedLocal   = avdModelGetNodeTransform(&test.model, i);
+        AVD_Transform local           = avdModelGetNodeTransform(&model, i);
+        ok                            = strcmp(expected->name, node->name) == 0 && expected->id == node->id;
+        ok                            = ok && node->parent == expected->parent && avdModelGetNode(&model, node->parent)->firstChild == i;
+        ok                            = ok && memcmp(&expectedLocal, &local, sizeof(AVD_Transform)) == 0;
+        ok                            = ok && avdModelGetNodeMeshIndex(&model, i) == avdModelGetNodeMeshIndex(&test.model, i);
+    }
+    ok = ok && model.mainScene == 1;
+
+    avdModelDestroy(&model);
+    PRIV_avdModelCacheTestDestroy(&test);
+    AVD_CHECK_MSG(ok, "The model read from the cache differs from the one written");
+    return true;
+}
+
+static bool PRIV_avdModelCacheTestReadFails(AVD_ModelCacheTest *test, const char *what)
+{
+    AVD_ModelCache cache = {0};
+    AVD_Model model      = {0};
+    AVD_Size vertexCount = test->resources.verticesList.count;
+    AVD_Size indexCount  = test->resources.indicesList.count;
+    AVD_CHECK(avdModelCreate(&model, 0));
+    avdModelCacheBegin(&cache, test->sourcePath, "test", 2, &test->resources);
+    bool loaded = avdModelCacheRead(&cache, &model, &test->resources);
+    bool intact = avdModelNodeCount(&model) == 1 && model.meshes.count == 0 && test->resources.verticesList.count == vertexCount && test->resources.indicesList.count == indexCount;
+    avdModelDestroy(&model);
+
+    AVD_CHECK_MSG(!loaded && intact, "A cache file with %s was loaded", what);
+    return true;
+}
+
+static bool PRIV_avdModelCacheTestInvalidation(void)
+{
+    AVD_ModelCacheTest test = {0};
+    AVD_CHECK(PRIV_avdModelCacheTestCreate(&test, 2));
+    AVD_CHECK(avdModelCacheWrite(&test.cache, &test.model, &test.resources));
+
+    void *data  = NULL;
+    size_t size = 0;
+    AVD_CHECK(avdReadBinaryFile(test.cache.path, &data, &size));
+    ((AVD_UInt8 *)data)[size - 1] ^= 0x5a;
+    bool ok = avdWriteBinaryFile(test.cache.path, data, size) && PRIV_avdModelCacheTestReadFails(&test, "a corrupted byte");
+    AVD_FREE(data);
+
+    ok = ok && avdModelCacheWrite(&test.cache, &test.model, &test.resources);
+    ok = ok && PRIV_avdModelCacheTestWriteFile(test.dependencyPath, "newmtl Changed\n");
+    ok = ok && PRIV_avdModelCacheTestReadFails(&test, "a changed dependency");
+    ok = ok && PRIV_avdModelCacheTestWriteFile(test.sourcePath, "o Changed\n");
+    ok = ok && PRIV_avdModelCacheTestReadFails(&test, "a changed source");
+
+    PRIV_avdModelCacheTestDestroy(&test);
+    return ok;
+}
+
+static bool PRIV_avdModelCacheTestDisabled(void)
+{
+    AVD_ModelCacheTest test = {0};
+    AVD_CHECK(PRIV_avdModelCacheTestCreate(&test, 1));
+    remove(test.cache.path);
+    test.cache.enabled = false;
+
+    AVD_Model model = {0};
+    AVD_CHECK(avdModelCreate(&model, 0));
+    bool ok = avdModelCacheWrite(&test.cache, &test.model, &test.resources) && !avdPathExists(test.cache.path);
+    ok      = ok && !avdModelCacheRead(&test.cache, &model, &test.resources) && avdModelNodeCount(&model) == 1;
+    ok      = ok && !avdModelCacheBegin(&test.cache, "does/not/exist.obj", "test", 0, &test.resources) && !test.cache.enabled;
+
+    avdModelDestroy(&model);
+    PRIV_avdModelCacheTestDestroy(&test);
+    AVD_CHECK_MSG(ok, "A disabled cache entry was used");
+    return true;
+}
+
+bool avdModelCacheTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Model Cache Tests...");
+
+    AVD_CHECK(PRIV_avdModelCacheTestRoundTrip());
+    AVD_CHECK(PRIV_avdModelCacheTestInvalidation());
+    AVD_CHECK(PRIV_avdModelCacheTestDisabled());
+
+    AVD_LOG_DEBUG("All AVD Model Cache Tests PASSED");
+    return true;
+}
+
+typedef struct {
+    AVD_ModelCacheTest test;
+    AVD_ModelResources resources;
+} AVD_ModelCacheBenchmark;
+
+static void PRIV_avdModelCacheBenchmarkRead(void *userData)
+{
+    AVD_ModelCacheBenchmark *benchmark = (AVD_ModelCacheBenchmark *)userData;
+    AVD_ModelCache cache               = {0};
+    AVD_Model model                    = {0};
+    avdListClear(&benchmark->resources.verticesList);
+    avdListClear(&benchmark->resources.indicesList);
+    avdListClear(&benchmark->resources.meshletsList);
+    avdListClear(&benchmark->resources.meshletVerticesList);
+    avdListClear(&benchmark->resources.meshletTrianglesList);
+    avdListClear(&benchmark->resources.morphTargetsList);
+    avdListClear(&benchmark->resources.morphDeltasList);
+    avdModelCreate(&model, 0);
+    avdModelCacheBegin(&cache, benchmark->test.sourcePath, "test", 7, &benchmark->resources);
+    avdModelCacheRead(&cache, &model, &benchmark->resources);
+    avdModelDestroy(&model);
+}
+
+bool avdModelCacheBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD Model Cache benchmarks...");
+
+    // 7 subdivisions are 128k triangles before the levels of detail
+    AVD_ModelCacheBenchmark benchmark = {0};
+    AVD_CHECK(PRIV_avdModelCacheTestCreate(&benchmark.test, 7));
+    AVD_CHECK(avdModelCacheWrite(&benchmark.test.cache, &benchmark.test.model, &benchmark.test.resources));
+    AVD_CHECK(avdModelResourcesCreate(&benchmark.resources));
+
+    AVD_BenchCase readCase = {
+        .name               = "cache/read_sphere_128k",
+        .unit               = "triangles",
+        .itemsPerRepetition = (AVD_Size)((const AVD_Mesh *)avdListGet(&benchmark.test.model.meshes, 0))->triangleCount,
+        .run                = PRIV_avdModelCacheBenchmarkRead,
+        .userData           = &benchmark,
+    };
+    bool ok = avdBenchRun(bench, &readCase);
+
+    avdModelResourcesDestroy(&benchmark.resources);
+    PRIV_avdModelCacheTestDestroy(&benchmark.test);
+    return ok;
+}
@@ -0,0 +1,79 @@
+#include "model/avd_model_draw.h"
+
+bool avdModelBuildDrawInstances(
+    const AVD_Model *model,
+    AVD_Int32 root,
+    const AVD_UInt32 *meshMaterials,
+    AVD_List *instances)
+{
+    AVD_ASSERT(model != NULL);
+    AVD_ASSERT(instances != NULL);
+    AVD_ASSERT(instances->itemSize == sizeof(AVD_DrawInstance));
+    AVD_ASSERT(root >= 0 && root < avdModelNodeCount(model));
+
+    const AVD_Matrix4x4 *worldMatrices = avdModelGetWorldMatrices(model);
+    for (AVD_Int32 node = root; node >= 0; node = avdModelNodeNext(model, root, node)) {
+        AVD_Int32 meshIndex = avdModelGetNodeMeshIndex(model, node);
+        if (meshIndex < 0) {
+            continue;
+        }
+        const AVD_Mesh *mesh = (const AVD_Mesh *)avdListGet(&model->meshes, (AVD_Size)meshIndex);
+        if (mesh->triangleCount <= 0 || avdAABBIsEmpty(mesh->bounds)) {
+            continue;
+        }
+
+        AVD_AABB worldBounds = avdAABBTransform(&mesh->bounds, &worldMatrices[node]);
+        AVD_Vector3 center   = avdAABBCenter(worldBounds);
+        AVD_Vector3 extents  = avdAABBExtents(worldBounds);
+
+        AVD_DrawInstance *instance = (AVD_DrawInstance *)avdListAddEmpty(instances);
+        AVD_CHECK_MSG(instance != NULL, "Failed to add the draw instance of node %d", node);
+        *instance = (AVD_DrawInstance){
+            .modelMatrix   = worldMatrices[node],
+            .center        = {center.x, center.y, center.z},
+            .firstIndex    = (uint32_t)mesh->indexOffset,
+            .extents       = {extents.x, extents.y, extents.z},
+            .indexCount    = (uint32_t)mesh->triangleCount * 3,
+            .materialIndex = meshMaterials != NULL ? meshMaterials[meshIndex] : 0,
+            .node          = node,
+        };
+    }
+    return true;
+}
+
+AVD_UInt32 avdDrawInstancesCull(
+    const AVD_DrawInstance *instances,
+    AVD_UInt32 count,
+    const AVD_Frustum *frustum,
+    AVD_DrawIndexedCommand *outCommands)
+{
+    AVD_ASSERT(instances != NULL || count == 0);
+    AVD_ASSERT(frustum != NULL);
+    AVD_ASSERT(outCommands != NULL || count == 0);
+
+    AVD_UInt32 visibleCount = 0;
+    for (AVD_UInt32 i = 0; i < count; i++) {
+        const AVD_DrawInstance *instance = &instances[i];
+        AVD_Vector3 center               = avdVec3(instance->center[0], instance->center[1], instance->center[2]);
+
+        // radius of the box projected onto the plane normal, as avdFrustumCullAABBs
+        bool visible = true;
+        for (int plane = 0; visible && plane < AVD_FRUSTUM_PLANE_COUNT; plane++) {
+            AVD_Vector3 normal = frustum->planes[plane].normal;
+            AVD_Float radius   = avdAbs(normal.x) * instance->extents[0] + avdAbs(normal.y) * instance->extents[1] + avdAbs(normal.z) * instance->extents[2];
+            visible            = avdPlaneDistance(&frustum->planes[plane], center) + radius >= 0.0f;
+        }
+        if (!visible) {
+            continue;
+        }
+
+        outCommands[visibleCount++] = (AVD_DrawIndexedCommand){
+            .indexCount    = instance->indexCount,
+            .instanceCount = 1,
+            .firstIndex    = instance->firstIndex,
+            .vertexOffset  = 0,
+            .firstInstance = i,
+        };
+    }
+    return visibleCount;
+}
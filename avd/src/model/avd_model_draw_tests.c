@@ -0,0 +1,263 @@
+#include "core/avd_bench.h"
+#include "core/avd_core.h"
+#include "model/avd_model_draw.h"
+
+// Cubes on a grid in the xz plane, seen from above one edge so that the
+// frustum cuts through the middle of it and the far plane culls the back rows.
+#define AVD_MODEL_DRAW_TEST_GRID_SIZE  32
+#define AVD_MODEL_DRAW_BENCH_GRID_SIZE 128
+#define AVD_MODEL_DRAW_GRID_SPACING    3.0f
+
+static bool PRIV_avdModelDrawTestAddCube(AVD_Model *model, AVD_Int32 indexOffset, AVD_Int32 triangleCount)
+{
+    AVD_Mesh mesh = {0};
+    AVD_CHECK(avdMeshInitWithNameId(&mesh, "DrawTestCube", (AVD_Int32)model->meshes.count));
+    mesh.indexOffset    = indexOffset;
+    mesh.triangleCount  = triangleCount;
+    mesh.bounds         = (AVD_AABB){.min = avdVec3(-0.5f, -0.5f, -0.5f), .max = avdVec3(0.5f, 0.5f, 0.5f)};
+    mesh.boundingSphere = avdSphereFromAABB(&mesh.bounds);
+    avdListPushBack(&model->meshes, &mesh);
+    return true;
+}
+
+static bool PRIV_avdModelDrawTestCreateGrid(AVD_Model *model, AVD_UInt32 size)
+{
+    AVD_CHECK(avdModelCreate(model, 0));
+    AVD_CHECK(PRIV_avdModelDrawTestAddCube(model, 0, 12));
+
+    AVD_Float offset = (AVD_Float)(size - 1) * AVD_MODEL_DRAW_GRID_SPACING * 0.5f;
+    for (AVD_UInt32 z = 0; z < size; z++) {
+        for (AVD_UInt32 x = 0; x < size; x++) {
+            AVD_Int32 node = -1;
+            AVD_CHECK(avdModelAddNode(model, AVD_MODEL_ROOT_NODE, "DrawTestNode", (AVD_Int32)(z * size + x), &node));
+
+            AVD_Vector3 position = avdVec3((AVD_Float)x * AVD_MODEL_DRAW_GRID_SPACING - offset, 0.0f, (AVD_Float)z * AVD_MODEL_DRAW_GRID_SPACING - offset);
+            AVD_Quaternion spin  = avdQuatFromAxisAngle(avdVec3(0.0f, 1.0f, 0.0f), 0.1f * (AVD_Float)(x + z));
+            AVD_Transform local  = avdTransform(position, spin, avdVec3One());
+            avdModelSetNodeTransform(model, node, &local);
+            avdModelSetNodeMesh(model, node, 0);
+        }
+    }
+    avdModelUpdateWorldMatrices(model);
+    return true;
+}
+
+static AVD_Frustum PRIV_avdModelDrawTestFrustum(AVD_UInt32 size)
+{
+    AVD_Float extent             = (AVD_Float)size * AVD_MODEL_DRAW_GRID_SPACING * 0.5f;
+    AVD_Matrix4x4 projection     = avdMatPerspective(avdDeg2Rad(60.0f), 16.0f / 9.0f, 0.1f, extent * 1.5f);
+    AVD_Matrix4x4 view           = avdMatLookAt(avdVec3(0.0f, extent * 0.3f, extent * 1.2f), avdVec3Zero(), avdVec3(0.0f, 1.0f, 0.0f));
+    AVD_Matrix4x4 viewProjection = avdMat4x4Multiply(projection, view);
+    return avdFrustumFromMatrix(&viewProjection);
+}
+
+// Root
+//   A     mesh 0, at (2, 0, 0)
+//   B     scale 2
+//     C   mesh 0, at (0, 1, 0) of B
+//   D     mesh 1 without triangles
+static bool PRIV_avdModelDrawTestBuild(void)
+{
+    AVD_Model model = {0};
+    AVD_List instances;
+    AVD_CHECK(avdModelCreate(&model, 0));
+    avdListCreate(&instances, sizeof(AVD_DrawInstance));
+
+    AVD_Int32 a     = -1;
+    AVD_Int32 b     = -1;
+    AVD_Int32 c     = -1;
+    AVD_Int32 d     = -1;
+    AVD_Transform t = {0};
+    bool ok         = PRIV_avdModelDrawTestAddCube(&model, 6, 12) && PRIV_avdModelDrawTestAddCube(&model, 42, 0);
+    ok              = ok && avdModelAddNode(&model, AVD_MODEL_ROOT_NODE, "A", 1, &a);
+    ok              = ok && avdModelAddNode(&model, AVD_MODEL_ROOT_NODE, "B", 2, &b);
+    ok              = ok && avdModelAddNode(&model, b, "C", 3, &c);
+    ok              = ok && avdModelAddNode(&model, AVD_MODEL_ROOT_NODE, "D", 4, &d);
+    if (ok) {
+        t = avdTransform(avdVec3(2.0f, 0.0f, 0.0f), avdQuatIdentity(), avdVec3One());
+        avdModelSetNodeTransform(&model, a, &t);
+        t = avdTransform(avdVec3Zero(), avdQuatIdentity(), avdVec3(2.0f, 2.0f, 2.0f));
+        avdModelSetNodeTransform(&model, b, &t);
+        t = avdTransform(avdVec3(0.0f, 1.0f, 0.0f), avdQuatIdentity(), avdVec3One());
+        avdModelSetNodeTransform(&model, c, &t);
+        avdModelSetNodeMesh(&model, a, 0);
+        avdModelSetNodeMesh(&model, c, 0);
+        avdModelSetNodeMesh(&model, d, 1);
+        avdModelUpdateWorldMatrices(&model);
+    }
+
+    const AVD_UInt32 materials[] = {5, 9};
+    ok                           = ok && avdModelBuildDrawInstances(&model, AVD_MODEL_ROOT_NODE, materials, &instances);
+    ok                           = ok && instances.count == 2;
+    if (ok) {
+        const AVD_Matrix4x4 *world     = avdModelGetWorldMatrices(&model);
+        const AVD_DrawInstance *first  = (const AVD_DrawInstance *)avdListGet(&instances, 0);
+        const AVD_DrawInstance *second = (const AVD_DrawInstance *)avdListGet(&instances, 1);
+        ok                             = first->node == a && second->node == c;
+        ok                             = ok && first->firstIndex == 6 && first->indexCount == 36 && first->materialIndex == 5;
+        ok                             = ok && memcmp(&first->modelMatrix, &world[a], sizeof(AVD_Matrix4x4)) == 0;
+        ok                             = ok && memcmp(&second->modelMatrix, &world[c], sizeof(AVD_Matrix4x4)) == 0;
+        ok                             = ok && avdAbs(first->center[0] - 2.0f) < 1e-5f && avdAbs(first->extents[0] - 0.5f) < 1e-5f;
+        ok                             = ok && avdAbs(second->center[1] - 2.0f) < 1e-5f && avdAbs(second->extents[2] - 1.0f) < 1e-5f;
+    }
+    AVD_CHECK_MSG(ok, "The draw instances of the model are wrong");
+
+    // only the subtree of B, appended after the others
+    ok = avdModelBuildDrawInstances(&model, b, NULL, &instances) && instances.count == 3;
+    ok = ok && ((const AVD_DrawInstance *)avdListGet(&instances, 2))->node == c;
+    ok = ok && ((const AVD_DrawInstance *)avdListGet(&instances, 2))->materialIndex == 0;
+
+    avdListDestroy(&instances);
+    avdModelDestroy(&model);
+    AVD_CHECK_MSG(ok, "The draw instances of a subtree are wrong");
+    return true;
+}
+
+// The commands of the culling have to name exactly the entries
+// avdFrustumCullAABBs keeps for the same boxes, in the same order.
+static bool PRIV_avdModelDrawTestCull(void)
+{
+    AVD_Model model = {0};
+    AVD_List instances;
+    AVD_CHECK(PRIV_avdModelDrawTestCreateGrid(&model, AVD_MODEL_DRAW_TEST_GRID_SIZE));
+    avdListCreate(&instances, sizeof(AVD_DrawInstance));
+
+    AVD_BoundsStreams streams        = {0};
+    AVD_UInt32 *visible              = NULL;
+    AVD_DrawIndexedCommand *commands = NULL;
+    AVD_UInt32 count                 = 0;
+    bool ok                          = avdModelBuildDrawInstances(&model, AVD_MODEL_ROOT_NODE, NULL, &instances);
+    if (ok) {
+        count    = (AVD_UInt32)instances.count;
+        ok       = avdBoundsStreamsCreate(&streams, count);
+        visible  = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * count);
+        commands = (AVD_DrawIndexedCommand *)AVD_MALLOC(sizeof(AVD_DrawIndexedCommand) * count);
+        ok       = ok && visible != NULL && commands != NULL;
+    }
+
+    AVD_UInt32 visibleCount      = 0;
+    AVD_UInt32 commandCount      = 0;
+    AVD_Frustum frustum          = PRIV_avdModelDrawTestFrustum(AVD_MODEL_DRAW_TEST_GRID_SIZE);
+    const AVD_DrawInstance *grid = (const AVD_DrawInstance *)instances.items;
+    if (ok) {
+        for (AVD_UInt32 i = 0; i < count; i++) {
+            streams.centerX[i] = grid[i].center[0];
+            streams.centerY[i] = grid[i].center[1];
+            streams.centerZ[i] = grid[i].center[2];
+            streams.extentX[i] = grid[i].extents[0];
+            streams.extentY[i] = grid[i].extents[1];
+            streams.extentZ[i] = grid[i].extents[2];
+            streams.radius[i]  = 0.0f;
+        }
+        streams.count = count;
+        visibleCount  = (AVD_UInt32)avdFrustumCullAABBs(&frustum, &streams, visible);
+        commandCount  = avdDrawInstancesCull(grid, count, &frustum, commands);
+        ok            = count == AVD_MODEL_DRAW_TEST_GRID_SIZE * AVD_MODEL_DRAW_TEST_GRID_SIZE;
+        ok            = ok && visibleCount > 0 && visibleCount < count && commandCount == visibleCount;
+    }
+    for (AVD_UInt32 i = 0; ok && i < commandCount; i++) {
+        const AVD_DrawIndexedCommand *command = &commands[i];
+        ok                                    = command->firstInstance == visible[i] && command->instanceCount == 1 && command->vertexOffset == 0;
+        ok                                    = ok && command->indexCount == 36 && command->firstIndex == 0;
+    }
+    AVD_LOG_DEBUG("    %u of %u grid instances visible", commandCount, count);
+
+    if (visible != NULL) {
+        AVD_FREE(visible);
+    }
+    if (commands != NULL) {
+        AVD_FREE(commands);
+    }
+    avdBoundsStreamsDestroy(&streams);
+    avdListDestroy(&instances);
+    avdModelDestroy(&model);
+    AVD_CHECK_MSG(ok, "The draw commands do not match the frustum culling");
+    return true;
+}
+
+bool avdModelDrawTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Model Draw Tests...");
+
+    AVD_CHECK(PRIV_avdModelDrawTestBuild());
+    AVD_CHECK(PRIV_avdModelDrawTestCull());
+
+    AVD_LOG_DEBUG("All AVD Model Draw Tests PASSED");
+    return true;
+}
+
+typedef struct {
+    AVD_Model model;
+    AVD_List instances;
+    AVD_Frustum frustum;
+    AVD_DrawIndexedCommand *commands;
+    AVD_UInt32 visibleCount;
+} AVD_ModelDrawBenchmark;
+
+static void PRIV_avdModelDrawBenchmarkBuild(void *userData)
+{
+    AVD_ModelDrawBenchmark *benchmark = (AVD_ModelDrawBenchmark *)userData;
+    avdListClear(&benchmark->instances);
+    avdModelBuildDrawInstances(&benchmark->model, AVD_MODEL_ROOT_NODE, NULL, &benchmark->instances);
+}
+
+static void PRIV_avdModelDrawBenchmarkCull(void *userData)
+{
+    AVD_ModelDrawBenchmark *benchmark = (AVD_ModelDrawBenchmark *)userData;
+    benchmark->visibleCount           = avdDrawInstancesCull(
+        (const AVD_DrawInstance *)benchmark->instances.items,
+        (AVD_UInt32)benchmark->instances.count,
+        &benchmark->frustum,
+        benchmark->commands);
+}
+
+// What the CPU still does per frame once the draws are GPU driven: gather the
+// instances after a node moved, and the reference of the culling shader for
+// comparison with the batched CPU culling of the scenes.
+bool avdModelDrawBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD Model Draw benchmarks...");
+
+    const char *buildName = "draw/build_instances_16k";
+    const char *cullName  = "draw/cull_instances_16k";
+    if (!avdBenchIsSelected(bench, buildName) && !avdBenchIsSelected(bench, cullName)) {
+        return true;
+    }
+
+    AVD_ModelDrawBenchmark benchmark = {0};
+    AVD_CHECK(PRIV_avdModelDrawTestCreateGrid(&benchmark.model, AVD_MODEL_DRAW_BENCH_GRID_SIZE));
+    avdListCreate(&benchmark.instances, sizeof(AVD_DrawInstance));
+    benchmark.frustum = PRIV_avdModelDrawTestFrustum(AVD_MODEL_DRAW_BENCH_GRID_SIZE);
+
+    AVD_Size count     = AVD_MODEL_DRAW_BENCH_GRID_SIZE * AVD_MODEL_DRAW_BENCH_GRID_SIZE;
+    benchmark.commands = (AVD_DrawIndexedCommand *)AVD_MALLOC(sizeof(AVD_DrawIndexedCommand) * count);
+    bool ok            = benchmark.commands != NULL && avdModelBuildDrawInstances(&benchmark.model, AVD_MODEL_ROOT_NODE, NULL, &benchmark.instances);
+
+    AVD_BenchCase buildCase = {
+        .name               = buildName,
+        .unit               = "instances",
+        .itemsPerRepetition = count,
+        .run                = PRIV_avdModelDrawBenchmarkBuild,
+        .userData           = &benchmark,
+    };
+    AVD_BenchCase cullCase = {
+        .name               = cullName,
+        .unit               = "instances",
+        .itemsPerRepetition = count,
+        .run                = PRIV_avdModelDrawBenchmarkCull,
+        .userData           = &benchmark,
+    };
+    ok = ok && avdBenchRun(bench, &buildCase);
+    ok = ok && avdBenchRun(bench, &cullCase);
+    if (ok) {
+        AVD_LOG_INFO("%s: %u of %zu instances visible", cullName, benchmark.visibleCount, count);
+    }
+
+    if (benchmark.commands != NULL) {
+        AVD_FREE(benchmark.commands);
+    }
+    avdListDestroy(&benchmark.instances);
+    avdModelDestroy(&benchmark.model);
+    return ok;
+}
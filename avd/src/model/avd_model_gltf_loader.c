@@ -1,4 +1,5 @@
 #include "model/avd_3d_scene.h"
+#include "model/avd_model_morph.h"
 
 #include "cgltf.h"
 
@@ -49,158 +50,376 @@ static bool PRIV_avdModelLoadGltfTransform(AVD_Transform *transform, cgltf_node
     return true;
 }
 
-static void *PRIV_avdModelGltfFindAttribute(cgltf_attribute *attributes, cgltf_size count, cgltf_attribute_type type, AVD_UInt32 index, void *scratchBuffer)
+// A primitive whose index and vertex ranges were reserved while the nodes
+// were loaded, it is filled in by a job once all of them are known.
+typedef struct {
+    cgltf_primitive *primitive;
+    AVD_Size meshIndex; // in the meshes of the model
+    AVD_UInt32 vertexOffset;
+    AVD_UInt32 vertexCount;
+    bool loaded;
+
+    // the names and weights in the morph target sets of the model, -1 for
+    // none, meshes only point at their set once all sets were added
+    AVD_Int32 morphSet;
+    // the sparse targets, only created for primitives that have targets and
+    // moved to the resources in mesh order
+    AVD_List morphTargets;
+    AVD_List morphDeltas;
+} AVD_GltfPrimitive;
+
+typedef struct {
+    AVD_Model *model;
+    AVD_ModelResources *resources;
+    AVD_GltfLoadFlags flags;
+    AVD_GltfPrimitive *primitives;
+} AVD_GltfPrimitiveJobs;
+
+static void PRIV_avdModelGltfPrimitiveDestroy(void *item, void *context)
 {
-    AVD_Size size = attributes[0].data->count;
-    for (cgltf_size i = 0; i < count; i++) {
-        if (attributes[i].type == type && attributes[i].index == index) {
-            switch (type) {
-                case cgltf_attribute_type_position:
-                case cgltf_attribute_type_normal: {
-                    if (cgltf_num_components(attributes[i].data->type) != 3) {
-                        AVD_LOG_WARN("%s attribute is not vec3, found type %d. This is unexpected, skipping.",
-                                     type == cgltf_attribute_type_position ? "POSITION" : "NORMAL",
-                                     attributes[i].data->type);
-                        continue;
-                    } else {
-                        size *= 3;
-                        break;
-                    }
-                }
-                case cgltf_attribute_type_tangent: {
-                    if (cgltf_num_components(attributes[i].data->type) != 4) {
-                        AVD_LOG_WARN("TANGENT attribute is not vec4, found type %d. This is unexpected, skipping.", attributes[i].data->type);
-                        continue;
-                    } else {
-                        size *= 4;
-                        break;
-                    }
-                }
-                case cgltf_attribute_type_texcoord: {
-                    if (cgltf_num_components(attributes[i].data->type) != 2) {
-                        AVD_LOG_WARN("TEXCOORD attribute is not vec2, found type %d. This is unexpected, skipping.", attributes[i].data->type);
-                        continue;
-                    } else {
-                        size *= 2;
-                        break;
-                    }
-                }
-                default: {
-                    AVD_LOG_WARN("Unsupported attribute type %d requested. This is unexpected, skipping.\n", type);
-                    continue;
-                }
-            }
+    (void)context;
+    AVD_GltfPrimitive *primitive = (AVD_GltfPrimitive *)item;
+    if (primitive->morphTargets.items != NULL) {
+        avdListDestroy(&primitive->morphTargets);
+        avdListDestroy(&primitive->morphDeltas);
+    }
+}
 
-            cgltf_accessor_unpack_floats(attributes[i].data, scratchBuffer, size);
-            return scratchBuffer;
+static const cgltf_accessor *PRIV_avdModelGltfFindAttribute(const cgltf_attribute *attributes, cgltf_size count, cgltf_attribute_type type, AVD_UInt32 index, AVD_UInt32 components)
+{
+    static const char *names[] = {"", "POSITION", "NORMAL", "TANGENT", "TEXCOORD"};
+    for (cgltf_size i = 0; i < count; i++) {
+        if (attributes[i].type != type || attributes[i].index != (cgltf_int)index) {
+            continue;
         }
+        if (cgltf_num_components(attributes[i].data->type) != components) {
+            AVD_LOG_WARN("%s attribute is not vec%u, found type %d. This is unexpected, skipping.", names[type], components, attributes[i].data->type);
+            continue;
+        }
+        return attributes[i].data;
     }
     return NULL;
 }
 
-static bool PRIV_avdModelLoadGltfAttrs(AVD_ModelResources *resources, cgltf_attribute *attributes, cgltf_size attributeCount, AVD_GltfLoadFlags flags, AVD_ModelVertexPacked *defaultVertex)
+// Points the stream straight at the accessor data in the loaded or mapped
+// buffer, false for layouts the packer does not read (sparse accessors and
+// integers that are not normalized).
+static bool PRIV_avdModelGltfStream(const cgltf_accessor *accessor, AVD_VertexStream *outStream)
 {
-    AVD_ASSERT(resources != NULL);
-    AVD_ASSERT(attributes != NULL);
-    AVD_ASSERT(attributeCount > 0);
-
-    AVD_UInt32 attrCount     = (AVD_UInt32)attributes[0].data->count;
-    AVD_Float *scratchBuffer = (AVD_Float *)calloc(attrCount * 4 * 4, sizeof(AVD_Float));
-    AVD_Size indBuffSize     = attrCount * 4;
-
-    const AVD_Float *positionAttr = (const AVD_Float *)PRIV_avdModelGltfFindAttribute(attributes, attributeCount, cgltf_attribute_type_position, 0, scratchBuffer + indBuffSize * 0);
-    const AVD_Float *normalAttr   = (const AVD_Float *)PRIV_avdModelGltfFindAttribute(attributes, attributeCount, cgltf_attribute_type_normal, 0, scratchBuffer + indBuffSize * 1);
-    const AVD_Float *tangentAttr  = (const AVD_Float *)PRIV_avdModelGltfFindAttribute(attributes, attributeCount, cgltf_attribute_type_tangent, 0, scratchBuffer + indBuffSize * 2);
-    const AVD_Float *texcoordAttr = (const AVD_Float *)PRIV_avdModelGltfFindAttribute(attributes, attributeCount, cgltf_attribute_type_texcoord, 0, scratchBuffer + indBuffSize * 3);
+    if (accessor->is_sparse || accessor->buffer_view == NULL) {
+        return false;
+    }
+    const AVD_UInt8 *data = (const AVD_UInt8 *)cgltf_buffer_view_data(accessor->buffer_view);
+    if (data == NULL) {
+        return false;
+    }
 
-    // const AVD_UInt32* jointsAttr = (const AVD_UInt32*)PRIV_avdModelGltfFindAttribute(attributes, attributeCount, cgltf_attribute_type_joints, 0, scratchBuffer + indBuffSize * 4);
-    // const AVD_Float* weightsAttr = (const AVD_Float*)PRIV_avdModelGltfFindAttribute(attributes, attributeCount, cgltf_attribute_type_weights, 0, scratchBuffer + indBuffSize * 5);
+    AVD_VertexStreamFormat format = AVD_VERTEX_STREAM_FORMAT_NONE;
+    switch (accessor->component_type) {
+        case cgltf_component_type_r_32f:
+            format = AVD_VERTEX_STREAM_FORMAT_FLOAT;
+            break;
+        case cgltf_component_type_r_8u:
+            format = accessor->normalized ? AVD_VERTEX_STREAM_FORMAT_UNORM8 : AVD_VERTEX_STREAM_FORMAT_NONE;
+            break;
+        case cgltf_component_type_r_8:
+            format = accessor->normalized ? AVD_VERTEX_STREAM_FORMAT_SNORM8 : AVD_VERTEX_STREAM_FORMAT_NONE;
+            break;
+        case cgltf_component_type_r_16u:
+            format = accessor->normalized ? AVD_VERTEX_STREAM_FORMAT_UNORM16 : AVD_VERTEX_STREAM_FORMAT_NONE;
+            break;
+        case cgltf_component_type_r_16:
+            format = accessor->normalized ? AVD_VERTEX_STREAM_FORMAT_SNORM16 : AVD_VERTEX_STREAM_FORMAT_NONE;
+            break;
+        default:
+            break;
+    }
+    if (format == AVD_VERTEX_STREAM_FORMAT_NONE) {
+        return false;
+    }
 
-    AVD_CHECK_MSG(positionAttr != NULL, "A primitive is missing POSITION attribute which is required.\n");
+    outStream->data       = data + accessor->offset;
+    outStream->stride     = accessor->stride;
+    outStream->format     = format;
+    outStream->components = (AVD_UInt32)cgltf_num_components(accessor->type);
+    return true;
+}
 
-    AVD_ModelVertex vertex             = {0};
-    AVD_ModelVertexPacked packedVertex = {0};
-    for (AVD_UInt32 i = 0; i < attrCount; i++) {
-        if (defaultVertex) {
-            avdModelVertexUnpack(&defaultVertex[i], &vertex);
-        } else {
-            avdModelVertexInit(&vertex);
+// Packs the position, normal, tangent and first texture coordinate of count
+// vertices into out, attributes the primitive does not have are taken from
+// defaults when given.
+static bool PRIV_avdModelLoadGltfAttrs(const cgltf_attribute *attributes, cgltf_size attributeCount, AVD_Size count, const AVD_ModelVertexPacked *defaults, AVD_ModelVertexPacked *out)
+{
+    AVD_ASSERT(attributes != NULL);
+    AVD_ASSERT(out != NULL);
+
+    static const cgltf_attribute_type types[] = {cgltf_attribute_type_position, cgltf_attribute_type_normal, cgltf_attribute_type_tangent, cgltf_attribute_type_texcoord};
+    static const AVD_UInt32 components[]      = {3, 3, 4, 2};
+
+    AVD_VertexStreams streams       = {0};
+    AVD_VertexStream *streamSlots[] = {&streams.position, &streams.normal, &streams.tangent, &streams.texCoord};
+    AVD_Float *unpacked[AVD_ARRAY_COUNT(types)] = {0};
+    bool ok                             = true;
+    for (AVD_Size i = 0; ok && i < AVD_ARRAY_COUNT(types); i++) {
+        const cgltf_accessor *accessor = PRIV_avdModelGltfFindAttribute(attributes, attributeCount, types[i], 0, components[i]);
+        if (accessor == NULL) {
+            continue;
+        }
+        if (accessor->count < count) {
+            AVD_LOG_ERROR("An attribute has %zu elements for %zu vertices", (AVD_Size)accessor->count, count);
+            ok = false;
+            break;
+        }
+        if (PRIV_avdModelGltfStream(accessor, streamSlots[i])) {
+            continue;
         }
 
-        if (positionAttr) {
-            vertex.position = avdVec3(
-                positionAttr[i * 3 + 0],
-                positionAttr[i * 3 + 1],
-                positionAttr[i * 3 + 2]);
+        // everything else is converted by cgltf
+        unpacked[i] = (AVD_Float *)AVD_MALLOC(sizeof(AVD_Float) * components[i] * AVD_MAX(count, (AVD_Size)1));
+        if (unpacked[i] == NULL) {
+            AVD_LOG_ERROR("Failed to allocate memory to unpack %zu vertices", count);
+            ok = false;
+            break;
         }
+        cgltf_accessor_unpack_floats(accessor, unpacked[i], components[i] * count);
+        *streamSlots[i] = (AVD_VertexStream){
+            .data       = unpacked[i],
+            .stride     = sizeof(AVD_Float) * components[i],
+            .format     = AVD_VERTEX_STREAM_FORMAT_FLOAT,
+            .components = components[i],
+        };
+    }
 
-        if (normalAttr) {
-            vertex.normal = avdVec3(
-                normalAttr[i * 3 + 0],
-                normalAttr[i * 3 + 1],
-                normalAttr[i * 3 + 2]);
+    if (ok && defaults == NULL && streams.position.data == NULL) {
+        AVD_LOG_ERROR("A primitive is missing POSITION attribute which is required.\n");
+        ok = false;
+    }
+    ok = ok && avdVertexStreamsPack(&streams, count, defaults, out);
+
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(unpacked); i++) {
+        if (unpacked[i] != NULL) {
+            AVD_FREE(unpacked[i]);
         }
+    }
+    return ok;
+}
+
+// Reads count xyz deltas of a morph target attribute, zero when the target
+// does not have it. cgltf resolves sparse accessors, which morph targets use
+// a lot.
+static bool PRIV_avdModelLoadGltfMorphDeltas(const cgltf_accessor *accessor, AVD_Size count, AVD_Float *out)
+{
+    if (accessor == NULL) {
+        memset(out, 0, sizeof(AVD_Float) * 3 * count);
+        return true;
+    }
+    AVD_CHECK_MSG(accessor->count >= count, "A morph target has %zu deltas for %zu vertices", (AVD_Size)accessor->count, count);
+    AVD_CHECK_MSG(cgltf_accessor_unpack_floats(accessor, out, 3 * count) == 3 * count, "Failed to read the deltas of a morph target");
+    return true;
+}
+
+// Builds the sparse targets of a primitive from the dense glTF deltas, one
+// target at a time. Tangent deltas are not kept.
+static bool PRIV_avdModelLoadGltfMorphTargets(AVD_GltfPrimitive *primitive, AVD_MorphDeltaEncoding encoding)
+{
+    cgltf_primitive *prim = primitive->primitive;
+    if (prim->targets_count == 0) {
+        return true;
+    }
+
+    AVD_Size count       = primitive->vertexCount;
+    AVD_Float *positions = (AVD_Float *)AVD_MALLOC(sizeof(AVD_Float) * 6 * AVD_MAX(count, (AVD_Size)1));
+    AVD_CHECK_MSG(positions != NULL, "Failed to allocate the deltas of %zu vertices", count);
+    AVD_Float *normals = positions + 3 * count;
+
+    bool ok = true;
+    for (cgltf_size i = 0; ok && i < prim->targets_count; i++) {
+        const cgltf_morph_target *target = &prim->targets[i];
+        const cgltf_accessor *position   = PRIV_avdModelGltfFindAttribute(target->attributes, target->attributes_count, cgltf_attribute_type_position, 0, 3);
+        const cgltf_accessor *normal     = PRIV_avdModelGltfFindAttribute(target->attributes, target->attributes_count, cgltf_attribute_type_normal, 0, 3);
+        ok                               = PRIV_avdModelLoadGltfMorphDeltas(position, count, positions);
+        ok                               = ok && PRIV_avdModelLoadGltfMorphDeltas(normal, count, normals);
+        ok                               = ok && avdMorphTargetBuild(&primitive->morphTargets, &primitive->morphDeltas, positions, normal != NULL ? normals : NULL, count, encoding);
+    }
 
-        if (tangentAttr) {
-            vertex.tangent = avdVec4(
-                tangentAttr[i * 4 + 0],
-                tangentAttr[i * 4 + 1],
-                tangentAttr[i * 4 + 2],
-                tangentAttr[i * 4 + 3]);
+    AVD_FREE(positions);
+    return ok;
+}
+
+static void PRIV_avdModelLoadGltfIndices(const cgltf_primitive *prim, AVD_UInt32 vertexOffset, AVD_UInt32 *out, AVD_Size count)
+{
+    const cgltf_accessor *accessor = prim->indices;
+    if (accessor == NULL) {
+        for (AVD_Size i = 0; i < count; i++) {
+            out[i] = vertexOffset + (AVD_UInt32)i;
         }
+        return;
+    }
 
-        if (texcoordAttr) {
-            vertex.texCoord = avdVec2(
-                texcoordAttr[i * 2 + 0],
-                texcoordAttr[i * 2 + 1]);
+    const AVD_UInt8 *data = NULL;
+    if (!accessor->is_sparse && accessor->buffer_view != NULL) {
+        data = (const AVD_UInt8 *)cgltf_buffer_view_data(accessor->buffer_view);
+    }
+    if (data == NULL) {
+        cgltf_accessor_unpack_indices(accessor, out, sizeof(AVD_UInt32), count);
+        for (AVD_Size i = 0; i < count; i++) {
+            out[i] += vertexOffset;
         }
+        return;
+    }
 
-        AVD_CHECK(avdModelVertexPack(&vertex, &packedVertex));
-        avdListPushBack(&resources->verticesList, &packedVertex);
+    data += accessor->offset;
+    switch (accessor->component_type) {
+        case cgltf_component_type_r_8u:
+            for (AVD_Size i = 0; i < count; i++) {
+                out[i] = vertexOffset + data[i * accessor->stride];
+            }
+            break;
+        case cgltf_component_type_r_16u:
+            for (AVD_Size i = 0; i < count; i++) {
+                AVD_UInt16 index = 0;
+                memcpy(&index, data + i * accessor->stride, sizeof(index));
+                out[i] = vertexOffset + index;
+            }
+            break;
+        default:
+            for (AVD_Size i = 0; i < count; i++) {
+                AVD_UInt32 index = 0;
+                memcpy(&index, data + i * accessor->stride, sizeof(index));
+                out[i] = vertexOffset + index;
+            }
+            break;
     }
+}
 
-    free(scratchBuffer);
-    return true;
+static AVD_MeshOptimizeFlags PRIV_avdModelGltfOptimizeFlags(AVD_GltfLoadFlags flags)
+{
+    if (flags & AVD_GLTF_LOAD_FLAG_OPTIMIZE_OVERDRAW) {
+        return AVD_MESH_OPTIMIZE_VERTEX_CACHE | AVD_MESH_OPTIMIZE_OVERDRAW | AVD_MESH_OPTIMIZE_VERTEX_FETCH;
+    }
+    if (flags & AVD_GLTF_LOAD_FLAG_OPTIMIZE) {
+        return AVD_MESH_OPTIMIZE_VERTEX_CACHE | AVD_MESH_OPTIMIZE_VERTEX_FETCH;
+    }
+    return AVD_MESH_OPTIMIZE_NONE;
 }
 
-static bool PRIV_avdModelLoadGltfLoadPrimAttributes(AVD_ModelResources *resources, AVD_Mesh *mesh, cgltf_primitive *prim, AVD_GltfLoadFlags flags)
+// Reserves the index and vertex ranges of a primitive, they are filled in by
+// PRIV_avdModelLoadGltfPrimitive.
+static bool PRIV_avdModelLoadGltfLoadPrimAttributes(AVD_ModelResources *resources, AVD_Mesh *mesh, cgltf_primitive *prim, AVD_GltfPrimitive *outPrimitive)
 {
     AVD_ASSERT(resources != NULL);
     AVD_ASSERT(mesh != NULL);
     AVD_ASSERT(prim != NULL);
+    AVD_ASSERT(outPrimitive != NULL);
+
+    AVD_CHECK_MSG(prim->attributes_count > 0, "A primitive is missing POSITION attribute which is required.\n");
+    AVD_UInt32 attrCount  = (AVD_UInt32)prim->attributes[0].data->count;
+    AVD_UInt32 indexCount = prim->indices ? (AVD_UInt32)prim->indices->count : attrCount;
+    AVD_CHECK_MSG(indexCount % 3 == 0, "Only triangle primitives are supported. Found a primitive with %d indices which is not a multiple of 3.\n", indexCount);
 
-    mesh->triangleCount     = 0;
-    mesh->indexOffset       = (AVD_Int32)resources->indicesList.count;
-    AVD_UInt32 vertexOffset = (AVD_UInt32)resources->verticesList.count;
-
-    AVD_UInt32 indexCount = 0;
-    AVD_UInt32 index      = 0;
-    if (prim->indices) {
-        indexCount          = (AVD_UInt32)prim->indices->count;
-        AVD_UInt32 *indices = avdListAddEmptyN(&resources->indicesList, (AVD_Size)indexCount);
-        cgltf_accessor_unpack_indices(prim->indices, indices, 4, indexCount);
-        for (AVD_UInt32 i = 0; i < indexCount; i++) {
-            indices[i] += vertexOffset;
+    mesh->indexOffset   = (AVD_Int32)resources->indicesList.count;
+    mesh->triangleCount = (AVD_Int32)(indexCount / 3);
+    AVD_CHECK_MSG(avdListAddEmptyN(&resources->indicesList, (AVD_Size)indexCount) != NULL || indexCount == 0, "Failed to reserve %u indices", indexCount);
+
+    AVD_Int32 morphSet = outPrimitive->morphSet;
+    memset(outPrimitive, 0, sizeof(AVD_GltfPrimitive));
+    outPrimitive->primitive    = prim;
+    outPrimitive->vertexOffset = (AVD_UInt32)resources->verticesList.count;
+    outPrimitive->vertexCount  = attrCount;
+    outPrimitive->morphSet     = morphSet;
+    AVD_CHECK_MSG(avdListAddEmptyN(&resources->verticesList, (AVD_Size)attrCount) != NULL || attrCount == 0, "Failed to reserve %u vertices", attrCount);
+    if (prim->targets_count > 0) {
+        avdListCreate(&outPrimitive->morphTargets, sizeof(AVD_MorphTargetDeltas));
+        avdListCreate(&outPrimitive->morphDeltas, sizeof(AVD_UInt32));
+    }
+    return true;
+}
+
+// Fills in the ranges reserved for a primitive, only touches its own part of
+// the lists so primitives load in parallel.
+static bool PRIV_avdModelLoadGltfPrimitive(const AVD_GltfPrimitiveJobs *jobs, AVD_GltfPrimitive *primitive)
+{
+    AVD_Mesh *mesh        = (AVD_Mesh *)avdListGet(&jobs->model->meshes, primitive->meshIndex);
+    cgltf_primitive *prim = primitive->primitive;
+    AVD_UInt32 *indices   = (AVD_UInt32 *)jobs->resources->indicesList.items + mesh->indexOffset;
+    PRIV_avdModelLoadGltfIndices(prim, primitive->vertexOffset, indices, (AVD_Size)mesh->triangleCount * 3);
+
+    AVD_ModelVertexPacked *baseVertex = (AVD_ModelVertexPacked *)jobs->resources->verticesList.items + primitive->vertexOffset;
+    AVD_CHECK(PRIV_avdModelLoadGltfAttrs(prim->attributes, prim->attributes_count, primitive->vertexCount, NULL, baseVertex));
+    AVD_MorphDeltaEncoding encoding = (jobs->flags & AVD_GLTF_LOAD_FLAG_QUANTIZE_MORPHS) ? AVD_MORPH_DELTA_ENCODING_QUANTIZED : AVD_MORPH_DELTA_ENCODING_FLOAT;
+    AVD_CHECK(PRIV_avdModelLoadGltfMorphTargets(primitive, encoding));
+
+    AVD_MeshOptimizeFlags optimizeFlags = PRIV_avdModelGltfOptimizeFlags(jobs->flags);
+    if (optimizeFlags != AVD_MESH_OPTIMIZE_NONE) {
+        // the morph targets follow the vertices they move
+        AVD_UInt32 *remap = NULL;
+        if (prim->targets_count > 0) {
+            remap = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * AVD_MAX(primitive->vertexCount, 1u));
+            AVD_CHECK_MSG(remap != NULL, "Failed to allocate the vertex remap of mesh '%s'", mesh->name);
         }
-    } else {
-        indexCount = (AVD_UInt32)prim->attributes[0].data->count;
-        for (AVD_UInt32 i = 0; i < indexCount; i++) {
-            index = vertexOffset + i;
-            avdListPushBack(&resources->indicesList, &index);
+        AVD_MeshOptimizeStats stats = {0};
+        bool optimized              = avdMeshOptimize(mesh, jobs->resources, primitive->vertexOffset, primitive->vertexCount, optimizeFlags, remap, &stats);
+        if (optimized && remap != NULL) {
+            avdMorphTargetsRemap(&primitive->morphTargets, &primitive->morphDeltas, remap);
         }
+        if (remap != NULL) {
+            AVD_FREE(remap);
+        }
+        AVD_CHECK(optimized);
+        AVD_LOG_DEBUG(
+            "Optimized mesh '%s': ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+            mesh->name,
+            avdMeshCacheStatsACMR(stats.before),
+            avdMeshCacheStatsACMR(stats.after),
+            avdMeshCacheStatsATVR(stats.before),
+            avdMeshCacheStatsATVR(stats.after));
     }
-    AVD_CHECK_MSG(indexCount % 3 == 0, "Only triangle primitives are supported. Found a primitive with %d indices which is not a multiple of 3.\n", indexCount);
-    mesh->triangleCount = indexCount / 3;
 
-    AVD_UInt32 attrCount = (AVD_UInt32)prim->attributes[0].data->count;
-    avdListEnsureCapacity(&resources->verticesList, resources->verticesList.count + attrCount * (1 + prim->targets_count));
-    AVD_ModelVertexPacked *baseVertex = (AVD_ModelVertexPacked *)avdListGet(&resources->verticesList, resources->verticesList.count - attrCount * (1 + prim->targets_count));
-    AVD_CHECK(PRIV_avdModelLoadGltfAttrs(resources, prim->attributes, prim->attributes_count, 0, NULL));
+    // morph targets can move the mesh outside of these
+    AVD_CHECK(avdMeshComputeBounds(mesh, jobs->resources));
+    return true;
+}
 
-    for (AVD_UInt32 i = 0; i < prim->targets_count; i++) {
-        AVD_CHECK(PRIV_avdModelLoadGltfAttrs(resources, prim->targets[i].attributes, prim->targets[i].attributes_count, 0, baseVertex));
+static void PRIV_avdModelLoadGltfPrimitiveRange(AVD_Size begin, AVD_Size end, void *userData)
+{
+    AVD_GltfPrimitiveJobs *jobs = (AVD_GltfPrimitiveJobs *)userData;
+    for (AVD_Size i = begin; i < end; i++) {
+        jobs->primitives[i].loaded = PRIV_avdModelLoadGltfPrimitive(jobs, &jobs->primitives[i]);
     }
+}
 
+// Loads the primitives reserved while the nodes were loaded, one job each.
+// Levels of detail and meshlets are appended to shared lists and are built
+// afterwards, in the order of the meshes.
+static bool PRIV_avdModelLoadGltfPrimitives(AVD_Model *model, AVD_ModelResources *resources, AVD_List *primitives, AVD_GltfLoadFlags flags)
+{
+    AVD_GltfPrimitiveJobs jobs = {
+        .model      = model,
+        .resources  = resources,
+        .flags      = flags,
+        .primitives = (AVD_GltfPrimitive *)primitives->items,
+    };
+    avdJobsParallelFor(primitives->count, 1, PRIV_avdModelLoadGltfPrimitiveRange, &jobs);
+
+    for (AVD_Size i = 0; i < primitives->count; i++) {
+        AVD_GltfPrimitive *primitive = &jobs.primitives[i];
+        AVD_Mesh *mesh               = (AVD_Mesh *)avdListGet(&model->meshes, primitive->meshIndex);
+        AVD_CHECK_MSG(primitive->loaded, "Failed to load the primitive of mesh '%s'", mesh->name);
+
+        mesh->morphTargets = primitive->morphSet >= 0 ? (AVD_MorphTargets *)avdListGet(&model->morphTargets, (AVD_Size)primitive->morphSet) : NULL;
+        if (primitive->morphTargets.items != NULL) {
+            AVD_CHECK(avdMeshAddMorphTargets(mesh, resources, primitive->vertexOffset, primitive->vertexCount, &primitive->morphTargets, &primitive->morphDeltas));
+        }
+
+        if (flags & AVD_GLTF_LOAD_FLAG_LODS) {
+            AVD_CHECK(avdMeshBuildLods(mesh, resources, NULL));
+            AVD_LOG_DEBUG("Built %d levels of detail for mesh '%s'", mesh->lodCount, mesh->name);
+        }
+        if (flags & AVD_GLTF_LOAD_FLAG_MESHLETS) {
+            AVD_CHECK(avdMeshBuildMeshlets(mesh, resources));
+            AVD_LOG_DEBUG("Built %d meshlets for mesh '%s'", mesh->meshletCount, mesh->name);
+        }
+    }
     return true;
 }
 
@@ -224,7 +443,7 @@ static bool PRIV_avdModelLoadGltfTexture(cgltf_texture *texture, AVD_ModelTextur
     }
 
     if (avdTexture->hasTexture) {
-        avdTexture->id = avdHashString(avdTexture->path);
+        avdTexture->id = avdHash64String(avdTexture->path);
     }
 
     return true;
@@ -258,7 +477,7 @@ static bool PRIV_avdModelLoadGltfTextureView(cgltf_texture_view *textureView, AV
     return true;
 }
 
-static bool PRIV_avdModelLoadGltfNodeMeshPrim(AVD_ModelResources *resources, AVD_Mesh *mesh, cgltf_primitive *prim, AVD_GltfLoadFlags flags)
+static bool PRIV_avdModelLoadGltfNodeMeshPrim(AVD_ModelResources *resources, AVD_Mesh *mesh, cgltf_primitive *prim, AVD_GltfPrimitive *outPrimitive)
 {
     AVD_ASSERT(resources != NULL);
     AVD_ASSERT(mesh != NULL);
@@ -295,16 +514,16 @@ static bool PRIV_avdModelLoadGltfNodeMeshPrim(AVD_ModelResources *resources, AVD
         mesh->material.unlit = prim->material->unlit;
     }
 
-    AVD_CHECK(PRIV_avdModelLoadGltfLoadPrimAttributes(resources, mesh, prim, flags));
+    AVD_CHECK(PRIV_avdModelLoadGltfLoadPrimAttributes(resources, mesh, prim, outPrimitive));
 
     return true;
 }
 
-static bool PRIV_avdModelLoadGltfNodeMesh(AVD_Model *model, AVD_ModelResources *resources, AVD_ModelNode *node, cgltf_mesh *mesh, cgltf_skin *skin, AVD_GltfLoadFlags flags)
+static bool PRIV_avdModelLoadGltfNodeMesh(AVD_Model *model, AVD_ModelResources *resources, AVD_Int32 node, cgltf_mesh *mesh, cgltf_skin *skin, AVD_List *primitives)
 {
     AVD_ASSERT(model != NULL);
     AVD_ASSERT(resources != NULL);
-    AVD_ASSERT(node != NULL);
+    AVD_ASSERT(node >= 0);
     AVD_ASSERT(mesh != NULL);
 
     if (skin) {
@@ -315,79 +534,94 @@ static bool PRIV_avdModelLoadGltfNodeMesh(AVD_Model *model, AVD_ModelResources *
     AVD_Mesh avdMesh = {0};
     AVD_CHECK(avdMeshInit(&avdMesh));
 
-    if (mesh->target_names_count > 0) {
-        AVD_CHECK_MSG(mesh->target_names_count == mesh->weights_count, "Mismatched target names and weights count");
-
-        avdMesh.morphTargets        = (AVD_MorphTargets *)avdListAddEmpty(&model->morphTargets);
-        avdMesh.morphTargets->count = (AVD_Int32)mesh->target_names_count;
-        for (int i = 0; i < mesh->target_names_count; i++) {
-            snprintf(avdMesh.morphTargets->targets[i].name, sizeof(avdMesh.morphTargets->targets[i].name), "%s", mesh->target_names[i]);
-            avdMesh.morphTargets->targets[i].weight = 0.0;
+    // every primitive of a mesh has the same targets, the names are optional
+    AVD_Int32 morphSet     = -1;
+    cgltf_size targetCount = mesh->primitives_count > 0 ? mesh->primitives[0].targets_count : 0;
+    if (targetCount > 0) {
+        AVD_CHECK_MSG(targetCount <= AVD_MAX_MORPH_TARGETS_PER_MESH, "Mesh '%s' has %zu morph targets", mesh->name ? mesh->name : "__UnnamedMesh", (AVD_Size)targetCount);
+        AVD_CHECK_MSG(mesh->target_names_count == 0 || mesh->target_names_count == targetCount, "Mismatched target names and targets count");
+        AVD_CHECK_MSG(mesh->weights_count == 0 || mesh->weights_count == targetCount, "Mismatched target weights and targets count");
+
+        AVD_MorphTargets *morphTargets = (AVD_MorphTargets *)avdListAddEmpty(&model->morphTargets);
+        AVD_CHECK(morphTargets != NULL);
+        morphTargets->count = (AVD_Int32)targetCount;
+        for (cgltf_size i = 0; i < targetCount; i++) {
+            AVD_MorphTarget *target = &morphTargets->targets[i];
+            if (mesh->target_names_count > 0) {
+                snprintf(target->name, sizeof(target->name), "%s", mesh->target_names[i]);
+            } else {
+                snprintf(target->name, sizeof(target->name), "Target%zu", (AVD_Size)i);
+            }
+            target->weight = mesh->weights_count > 0 ? mesh->weights[i] : 0.0f;
         }
+        morphSet = (AVD_Int32)model->morphTargets.count - 1;
     }
 
     const char *meshRawName = mesh->name ? mesh->name : "__UnnamedMesh";
     if (mesh->primitives_count == 1) {
+        AVD_GltfPrimitive primitive = {.morphSet = morphSet};
         sprintf(avdMesh.name, "%s", meshRawName);
-        AVD_CHECK(PRIV_avdModelLoadGltfNodeMeshPrim(resources, &avdMesh, &mesh->primitives[0], flags));
+        AVD_CHECK(PRIV_avdModelLoadGltfNodeMeshPrim(resources, &avdMesh, &mesh->primitives[0], &primitive));
 
-        avdMesh.id    = avdHashString(avdMesh.name);
-        node->mesh    = avdMesh;
-        node->hasMesh = true;
+        avdMesh.id = avdHashString(avdMesh.name);
         avdListPushBack(&model->meshes, &avdMesh);
+        avdModelSetNodeMesh(model, node, (AVD_Int32)model->meshes.count - 1);
+
+        primitive.meshIndex = model->meshes.count - 1;
+        avdListPushBack(primitives, &primitive);
     } else {
         for (int i = 0; i < mesh->primitives_count; i++) {
-            AVD_ModelNode *sceneNode = NULL;
-            AVD_CHECK(avdModelAllocNode(model, &sceneNode));
+            AVD_Int32 sceneNode = -1;
             static char nodeName[64];
             snprintf(nodeName, sizeof(nodeName), "MeshPrim/%s/%d", meshRawName, i);
-            AVD_CHECK(avdModelNodePrepare(sceneNode, node, nodeName, avdHashString(nodeName)));
+            AVD_CHECK(avdModelAddNode(model, node, nodeName, avdHashString(nodeName), &sceneNode));
 
             AVD_Mesh localMesh = {0};
             AVD_CHECK(avdMeshInit(&localMesh));
             snprintf(localMesh.name, sizeof(localMesh.name), "%s/%d", meshRawName, i);
-            localMesh.id           = avdHashString(nodeName);
-            localMesh.morphTargets = avdMesh.morphTargets;
-            AVD_CHECK(PRIV_avdModelLoadGltfNodeMeshPrim(resources, &localMesh, &mesh->primitives[i], flags));
-
-            sceneNode->mesh    = localMesh;
-            sceneNode->hasMesh = true;
+            localMesh.id                = avdHashString(nodeName);
+            AVD_GltfPrimitive primitive = {.morphSet = morphSet};
+            AVD_CHECK(PRIV_avdModelLoadGltfNodeMeshPrim(resources, &localMesh, &mesh->primitives[i], &primitive));
 
             avdListPushBack(&model->meshes, &localMesh);
+            avdModelSetNodeMesh(model, sceneNode, (AVD_Int32)model->meshes.count - 1);
+
+            primitive.meshIndex = model->meshes.count - 1;
+            avdListPushBack(primitives, &primitive);
         }
     }
 
     return true;
 }
 
-static bool PRIV_avdModelLoadGltfNode(AVD_Model *model, AVD_ModelResources *resources, AVD_ModelNode *parent, cgltf_node *node, AVD_GltfLoadFlags flags)
+static bool PRIV_avdModelLoadGltfNode(AVD_Model *model, AVD_ModelResources *resources, AVD_Int32 parent, cgltf_node *node, AVD_List *primitives)
 {
-    AVD_ModelNode *sceneNode = NULL;
-    AVD_CHECK(avdModelAllocNode(model, &sceneNode));
-    const char *nodeName = node->name ? node->name : "__UnnamedNode";
-    AVD_CHECK(avdModelNodePrepare(sceneNode, parent, nodeName, avdHashString(nodeName)));
-    AVD_CHECK(PRIV_avdModelLoadGltfTransform(&sceneNode->transform, node));
+    AVD_Int32 sceneNode     = -1;
+    AVD_Transform transform = {0};
+    const char *nodeName    = node->name ? node->name : "__UnnamedNode";
+    AVD_CHECK(avdModelAddNode(model, parent, nodeName, avdHashString(nodeName), &sceneNode));
+    AVD_CHECK(PRIV_avdModelLoadGltfTransform(&transform, node));
+    avdModelSetNodeTransform(model, sceneNode, &transform);
 
     if (node->mesh) {
-        AVD_CHECK(PRIV_avdModelLoadGltfNodeMesh(model, resources, sceneNode, node->mesh, node->skin, flags));
+        AVD_CHECK(PRIV_avdModelLoadGltfNodeMesh(model, resources, sceneNode, node->mesh, node->skin, primitives));
     }
 
     for (int i = 0; i < node->children_count; i++) {
-        AVD_CHECK(PRIV_avdModelLoadGltfNode(model, resources, sceneNode, node->children[i], flags));
+        AVD_CHECK(PRIV_avdModelLoadGltfNode(model, resources, sceneNode, node->children[i], primitives));
     }
 
     return true;
 }
 
-static bool PRIV_avdModelLoadGltfScene(AVD_Model *model, AVD_ModelResources *resources, cgltf_scene *scene, AVD_GltfLoadFlags flags, bool mainScene)
+static bool PRIV_avdModelLoadGltfScene(AVD_Model *model, AVD_ModelResources *resources, cgltf_scene *scene, AVD_List *primitives, bool mainScene)
 {
-    AVD_ModelNode *sceneNode = NULL;
-    AVD_CHECK(avdModelAllocNode(model, &sceneNode));
+    AVD_Int32 sceneNode   = -1;
     const char *sceneName = scene->name ? scene->name : "__UnnamedScene";
-    AVD_CHECK(avdModelNodePrepare(sceneNode, model->rootNode, sceneName, avdHashString(sceneName)));
+    AVD_CHECK(avdModelAddNode(model, AVD_MODEL_ROOT_NODE, sceneName, avdHashString(sceneName), &sceneNode));
 
     for (int i = 0; i < scene->nodes_count; i++) {
-        AVD_CHECK(PRIV_avdModelLoadGltfNode(model, resources, sceneNode, scene->nodes[i], flags));
+        AVD_CHECK(PRIV_avdModelLoadGltfNode(model, resources, sceneNode, scene->nodes[i], primitives));
     }
 
     if (mainScene) {
@@ -401,13 +635,95 @@ bool avd3DSceneLoadGltf(const char *filename, AVD_3DScene *scene, AVD_GltfLoadFl
 {
     AVD_ASSERT(scene != NULL);
 
-    AVD_Model model = {0};
-    AVD_CHECK(avdModelCreate(&model, 0));
-    AVD_CHECK(avdModelLoadGltf(filename, &model, &scene->modelResources, flags));
+    // the scene containers grow while loading, charge them to the model subsystem
+    AVD_MemoryTag previousTag = avdMemorySetThreadTag(AVD_MEMORY_TAG_MODEL);
+    AVD_Model model           = {0};
+    bool loaded               = avdModelCreate(&model, 0) && avdModelLoadGltf(filename, &model, &scene->modelResources, flags);
+    avdMemorySetThreadTag(previousTag);
+    AVD_CHECK(loaded);
+
     avdListPushBack(&scene->modelsList, &model);
     return true;
 }
 
+// Maps external .bin buffers so cgltf does not read them into memory, buffers
+// it skips (embedded, percent encoded or remote URIs) are still loaded by
+// cgltf_load_buffers. A GLB binary chunk is used in place by cgltf already.
+// Every external buffer is a dependency of the cache entry, which is dropped
+// for buffers that can not be tracked as files.
+static void PRIV_avdModelGltfMapBuffers(const char *filename, cgltf_data *data, AVD_FileView **bufferViews, AVD_ModelCache *cache)
+{
+    AVD_ASSERT(filename != NULL);
+    AVD_ASSERT(data != NULL);
+    AVD_ASSERT(bufferViews != NULL);
+
+    int directoryLength = 0;
+    for (int i = 0; filename[i] != '\0'; i++) {
+        if (filename[i] == '/' || filename[i] == '\\') {
+            directoryLength = i + 1;
+        }
+    }
+
+    for (cgltf_size i = 0; i < data->buffers_count; i++) {
+        cgltf_buffer *buffer = &data->buffers[i];
+        if (buffer->data != NULL || buffer->uri == NULL || strchr(buffer->uri, ':') != NULL || strchr(buffer->uri, '%') != NULL) {
+            // embedded data URIs are part of the file itself
+            if (buffer->data == NULL && buffer->uri != NULL && strncmp(buffer->uri, "data:", 5) != 0) {
+                cache->enabled = false;
+            }
+            continue;
+        }
+
+        char path[4096];
+        snprintf(path, sizeof(path), "%.*s%s", directoryLength, filename, buffer->uri);
+        avdModelCacheAddDependency(cache, path);
+
+        AVD_FileView *view = NULL;
+        if (!avdFileViewOpen(path, AVD_FILE_VIEW_FLAG_WILL_NEED, &view)) {
+            continue;
+        }
+        if (view->size < buffer->size) {
+            avdFileViewRelease(view);
+            continue;
+        }
+
+        bufferViews[i]           = view;
+        buffer->data             = (void *)view->data;
+        buffer->data_free_method = cgltf_data_free_method_none;
+    }
+}
+
+static bool PRIV_avdModelLoadGltfData(
+    const char *filename,
+    cgltf_options *options,
+    cgltf_data *data,
+    AVD_FileView **bufferViews,
+    AVD_ModelCache *cache,
+    AVD_Model *model,
+    AVD_ModelResources *resources,
+    AVD_GltfLoadFlags flags)
+{
+    PRIV_avdModelGltfMapBuffers(filename, data, bufferViews, cache);
+    AVD_CHECK_MSG(cgltf_load_buffers(options, data, filename) == cgltf_result_success, "Failed to parse GLTF file: %s", filename);
+    AVD_CHECK_MSG(cgltf_validate(data) == cgltf_result_success, "Failed to validate GLTF file: %s", filename);
+
+    snprintf(model->name, sizeof(model->name), "%s", filename);
+    model->id = avdHashString(model->name);
+
+    // the nodes reserve the ranges of their primitives, which are then loaded in parallel
+    AVD_List primitives = {0};
+    avdListCreate(&primitives, sizeof(AVD_GltfPrimitive));
+    avdListSetDestructor(&primitives, PRIV_avdModelGltfPrimitiveDestroy, NULL);
+    bool loaded = true;
+    for (int i = 0; loaded && i < data->scenes_count; i++) {
+        loaded = PRIV_avdModelLoadGltfScene(model, resources, &data->scenes[i], &primitives, &data->scenes[i] == data->scene);
+    }
+    loaded = loaded && PRIV_avdModelLoadGltfPrimitives(model, resources, &primitives, flags);
+    avdListDestroy(&primitives);
+
+    return loaded;
+}
+
 bool avdModelLoadGltf(const char *filename, AVD_Model *model, AVD_ModelResources *resources, AVD_GltfLoadFlags flags)
 {
     AVD_ASSERT(model != NULL);
@@ -416,19 +732,46 @@ bool avdModelLoadGltf(const char *filename, AVD_Model *model, AVD_ModelResources
 
     AVD_CHECK_MSG(avdPathExists(filename), "The specified GLTF file does not exist: %s", filename);
 
+    picoPerfTime start   = picoPerfNow();
+    AVD_ModelCache cache = {0};
+    if (avdModelCacheBegin(&cache, filename, "gltf", (AVD_UInt32)flags, resources) && avdModelCacheRead(&cache, model, resources)) {
+        AVD_LOG_INFO("Loaded '%s' from the mesh cache in %.1f ms", filename, picoPerfDurationMilliseconds(start, picoPerfNow()));
+        return true;
+    }
+
+    // cgltf keeps pointers into the file it parsed (the GLB binary chunk among
+    // them), so the views stay alive until the data is freed
+    AVD_FileView *fileView = NULL;
+    AVD_CHECK_MSG(avdFileViewOpen(filename, AVD_FILE_VIEW_FLAG_NONE, &fileView), "Failed to open GLTF file: %s", filename);
+
     cgltf_options options = {0};
     cgltf_data *data      = NULL;
-    AVD_CHECK_MSG(cgltf_parse_file(&options, filename, &data) == cgltf_result_success, "Failed to parse GLTF file: %s", filename);
-    AVD_CHECK_MSG(cgltf_load_buffers(&options, data, filename) == cgltf_result_success, "Failed to parse GLTF file: %s", filename);
-    AVD_CHECK_MSG(cgltf_validate(data) == cgltf_result_success, "Failed to validate GLTF file: %s", filename);
-
-    snprintf(model->name, sizeof(model->name), "%s", filename);
-    model->id = avdHashString(model->name);
+    if (cgltf_parse(&options, fileView->data, fileView->size, &data) != cgltf_result_success) {
+        avdFileViewRelease(fileView);
+        AVD_CHECK_MSG(false, "Failed to parse GLTF file: %s", filename);
+    }
 
-    for (int i = 0; i < data->scenes_count; i++) {
-        AVD_CHECK(PRIV_avdModelLoadGltfScene(model, resources, &data->scenes[i], flags, &data->scenes[i] == data->scene));
+    cgltf_size bufferCount     = data->buffers_count;
+    AVD_Size bufferViewsSize   = sizeof(AVD_FileView *) * AVD_MAX(bufferCount, (cgltf_size)1);
+    AVD_FileView **bufferViews = (AVD_FileView **)AVD_MALLOC(bufferViewsSize);
+    bool loaded                = false;
+    if (bufferViews != NULL) {
+        memset(bufferViews, 0, bufferViewsSize);
+        loaded = PRIV_avdModelLoadGltfData(filename, &options, data, bufferViews, &cache, model, resources, flags);
+    } else {
+        AVD_LOG_ERROR("Failed to allocate buffer views for GLTF file: %s", filename);
     }
 
     cgltf_free(data);
-    return true;
+    for (cgltf_size i = 0; bufferViews != NULL && i < bufferCount; i++) {
+        avdFileViewRelease(bufferViews[i]);
+    }
+    AVD_FREE(bufferViews);
+    avdFileViewRelease(fileView);
+
+    if (loaded) {
+        AVD_LOG_INFO("Loaded '%s' in %.1f ms", filename, picoPerfDurationMilliseconds(start, picoPerfNow()));
+        avdModelCacheWrite(&cache, model, resources);
+    }
+    return loaded;
 }
\ No newline at end of file
@@ -0,0 +1,662 @@
+#include "model/avd_model_lod.h"
+#include "model/avd_model_optimizer.h"
+
+// normal and texture coordinate, scaled by their weights
+#define AVD_MESH_LOD_ATTRIBUTE_COUNT 5
+
+// No triangle around a collapsed vertex may turn by more than about 75
+// degrees, which also rejects flipped and collapsed triangles.
+#define AVD_MESH_LOD_MIN_NORMAL_DOT 0.25f
+
+// The manifold check is quadratic in the triangles around a vertex, vertices
+// with more of them are locked.
+#define AVD_MESH_LOD_MAX_VALENCE 64
+
+// A level that removes less than this fraction of the triangles of the one
+// before is not worth its indices and ends the chain.
+#define AVD_MESH_LOD_MIN_REDUCTION 0.2f
+
+// Sum of squared distances to the planes of the triangles around a vertex and
+// of the squared attribute distances, both weighted by triangle area.
+typedef struct {
+    AVD_Float planes[10]; // symmetric 4x4 matrix: xx xy xz xw yy yz yw zz zw ww
+    AVD_Float attributes[AVD_MESH_LOD_ATTRIBUTE_COUNT];
+    AVD_Float attributeLengthSq;
+    AVD_Float weight;
+} AVD_MeshLodQuadric;
+
+typedef struct {
+    AVD_Float cost;
+    AVD_Float positionError;
+    AVD_UInt32 from;
+    AVD_UInt32 to;
+} AVD_MeshLodCollapse;
+
+typedef struct {
+    uint32_t bits[3];
+    AVD_UInt32 vertex;
+} AVD_MeshLodPositionKey;
+
+// Indices are relative to the vertices, which are only read. The index list
+// shrinks with every pass and can be simplified further for the next level.
+typedef struct {
+    AVD_Size vertexCount;
+    AVD_Size indexCount;
+    AVD_UInt32 *indices;
+    AVD_Vector3 *positions; // relative to the bounds, in units of the largest extent
+    AVD_Float *attributes;  // AVD_MESH_LOD_ATTRIBUTE_COUNT per vertex
+    AVD_MeshLodQuadric *quadrics;
+    AVD_MeshLodCollapse *collapses;
+    AVD_UInt32 *adjacencyOffsets;
+    AVD_UInt32 *adjacency;
+    AVD_UInt32 *remap;
+    AVD_UInt8 *seams;  // shares its position with another vertex or is unused
+    AVD_UInt8 *locked; // per pass, see PRIV_avdMeshLodSimplifierPass
+    AVD_Float extent;
+    AVD_Float maxErrorSq;
+    AVD_Float positionErrorSq; // largest of all collapses so far
+} AVD_MeshLodSimplifier;
+
+static void PRIV_avdMeshLodQuadricAddPlane(AVD_MeshLodQuadric *quadric, AVD_Vector3 normal, AVD_Float distance, AVD_Float weight)
+{
+    quadric->planes[0] += weight * normal.x * normal.x;
+    quadric->planes[1] += weight * normal.x * normal.y;
+    quadric->planes[2] += weight * normal.x * normal.z;
+    quadric->planes[3] += weight * normal.x * distance;
+    quadric->planes[4] += weight * normal.y * normal.y;
+    quadric->planes[5] += weight * normal.y * normal.z;
+    quadric->planes[6] += weight * normal.y * distance;
+    quadric->planes[7] += weight * normal.z * normal.z;
+    quadric->planes[8] += weight * normal.z * distance;
+    quadric->planes[9] += weight * distance * distance;
+}
+
+static void PRIV_avdMeshLodQuadricAddAttributes(AVD_MeshLodQuadric *quadric, const AVD_Float *attributes, AVD_Float weight)
+{
+    AVD_Float lengthSq = 0.0f;
+    for (AVD_UInt32 i = 0; i < AVD_MESH_LOD_ATTRIBUTE_COUNT; i++) {
+        quadric->attributes[i] += weight * attributes[i];
+        lengthSq += attributes[i] * attributes[i];
+    }
+    quadric->attributeLengthSq += weight * lengthSq;
+    quadric->weight += weight;
+}
+
+static void PRIV_avdMeshLodQuadricMerge(AVD_MeshLodQuadric *out, const AVD_MeshLodQuadric *a, const AVD_MeshLodQuadric *b)
+{
+    for (AVD_UInt32 i = 0; i < 10; i++) {
+        out->planes[i] = a->planes[i] + b->planes[i];
+    }
+    for (AVD_UInt32 i = 0; i < AVD_MESH_LOD_ATTRIBUTE_COUNT; i++) {
+        out->attributes[i] = a->attributes[i] + b->attributes[i];
+    }
+    out->attributeLengthSq = a->attributeLengthSq + b->attributeLengthSq;
+    out->weight            = a->weight + b->weight;
+}
+
+// Mean squared errors of moving everything the quadric holds to a vertex,
+// the total is written to outCost.
+static AVD_Float PRIV_avdMeshLodQuadricError(const AVD_MeshLodQuadric *quadric, AVD_Vector3 position, const AVD_Float *attributes, AVD_Float *outCost)
+{
+    if (!(quadric->weight > 0.0f)) {
+        *outCost = 0.0f;
+        return 0.0f;
+    }
+
+    const AVD_Float *m = quadric->planes;
+    AVD_Float x        = position.x;
+    AVD_Float y        = position.y;
+    AVD_Float z        = position.z;
+    AVD_Float planes   = m[0] * x * x + 2.0f * (m[1] * x * y + m[2] * x * z + m[3] * x) +
+                       m[4] * y * y + 2.0f * (m[5] * y * z + m[6] * y) +
+                       m[7] * z * z + 2.0f * m[8] * z + m[9];
+
+    AVD_Float attributeError = quadric->attributeLengthSq;
+    for (AVD_UInt32 i = 0; i < AVD_MESH_LOD_ATTRIBUTE_COUNT; i++) {
+        attributeError += attributes[i] * (quadric->weight * attributes[i] - 2.0f * quadric->attributes[i]);
+    }
+
+    // both sums are non negative, rounding can push them slightly below
+    AVD_Float positionError = avdMax(planes, 0.0f) / quadric->weight;
+    *outCost                = positionError + avdMax(attributeError, 0.0f) / quadric->weight;
+    return positionError;
+}
+
+static int PRIV_avdMeshLodComparePositionKeys(const void *a, const void *b)
+{
+    return memcmp(((const AVD_MeshLodPositionKey *)a)->bits, ((const AVD_MeshLodPositionKey *)b)->bits, sizeof(uint32_t) * 3);
+}
+
+static int PRIV_avdMeshLodCompareCollapses(const void *a, const void *b)
+{
+    AVD_Float costA = ((const AVD_MeshLodCollapse *)a)->cost;
+    AVD_Float costB = ((const AVD_MeshLodCollapse *)b)->cost;
+    return (costA > costB) - (costA < costB);
+}
+
+// Marks the vertices whose position is used by more than one vertex, the
+// corners of attribute seams and of split hard edges.
+static bool PRIV_avdMeshLodFindSeams(AVD_MeshLodSimplifier *simplifier, const AVD_ModelVertex *vertices)
+{
+    memset(simplifier->seams, 1, simplifier->vertexCount);
+    memset(simplifier->locked, 0, simplifier->vertexCount);
+    for (AVD_Size i = 0; i < simplifier->indexCount; i++) {
+        simplifier->locked[simplifier->indices[i]] = 1;
+    }
+
+    AVD_MeshLodPositionKey *keys = (AVD_MeshLodPositionKey *)AVD_MALLOC(sizeof(AVD_MeshLodPositionKey) * simplifier->vertexCount);
+    AVD_CHECK_MSG(keys != NULL, "Failed to allocate the seam detection of the simplifier");
+
+    AVD_Size keyCount = 0;
+    for (AVD_Size vertex = 0; vertex < simplifier->vertexCount; vertex++) {
+        if (!simplifier->locked[vertex]) {
+            continue;
+        }
+        // adding zero turns -0 into 0 so both compare equal
+        AVD_Float position[3] = {
+            vertices[vertex].position.x + 0.0f,
+            vertices[vertex].position.y + 0.0f,
+            vertices[vertex].position.z + 0.0f,
+        };
+        memcpy(keys[keyCount].bits, position, sizeof(position));
+        keys[keyCount].vertex = (AVD_UInt32)vertex;
+        keyCount++;
+    }
+    qsort(keys, keyCount, sizeof(AVD_MeshLodPositionKey), PRIV_avdMeshLodComparePositionKeys);
+
+    for (AVD_Size runStart = 0; runStart < keyCount;) {
+        AVD_Size runEnd = runStart + 1;
+        while (runEnd < keyCount && PRIV_avdMeshLodComparePositionKeys(&keys[runStart], &keys[runEnd]) == 0) {
+            runEnd++;
+        }
+        for (AVD_Size i = runStart; i < runEnd; i++) {
+            simplifier->seams[keys[i].vertex] = runEnd - runStart > 1 ? 1 : 0;
+        }
+        runStart = runEnd;
+    }
+
+    AVD_FREE(keys);
+    return true;
+}
+
+static bool PRIV_avdMeshLodSimplifierCreate(
+    AVD_MeshLodSimplifier *simplifier,
+    const AVD_UInt32 *indices,
+    AVD_Size indexCount,
+    const AVD_ModelVertex *vertices,
+    AVD_Size vertexCount,
+    const AVD_MeshLodOptions *options)
+{
+    AVD_ASSERT(simplifier != NULL);
+    AVD_ASSERT(indexCount % 3 == 0);
+    AVD_CHECK_MSG(indexCount <= UINT32_MAX && vertexCount < UINT32_MAX, "Mesh is too large to simplify");
+
+    memset(simplifier, 0, sizeof(AVD_MeshLodSimplifier));
+    simplifier->vertexCount = vertexCount;
+    simplifier->indexCount  = indexCount;
+
+    // one allocation, the members with the largest alignment first
+    AVD_Size storageSize = sizeof(AVD_Vector3) * vertexCount +
+                           sizeof(AVD_Float) * AVD_MESH_LOD_ATTRIBUTE_COUNT * vertexCount +
+                           sizeof(AVD_MeshLodQuadric) * vertexCount +
+                           sizeof(AVD_MeshLodCollapse) * vertexCount +
+                           sizeof(AVD_UInt32) * (indexCount * 2 + (vertexCount + 1) + vertexCount) +
+                           vertexCount * 2;
+    simplifier->positions = (AVD_Vector3 *)AVD_MALLOC(AVD_MAX(storageSize, (AVD_Size)1));
+    AVD_CHECK_MSG(simplifier->positions != NULL, "Failed to allocate the simplifier");
+
+    simplifier->attributes       = (AVD_Float *)(simplifier->positions + vertexCount);
+    simplifier->quadrics         = (AVD_MeshLodQuadric *)(simplifier->attributes + AVD_MESH_LOD_ATTRIBUTE_COUNT * vertexCount);
+    simplifier->collapses        = (AVD_MeshLodCollapse *)(simplifier->quadrics + vertexCount);
+    simplifier->indices          = (AVD_UInt32 *)(simplifier->collapses + vertexCount);
+    simplifier->adjacency        = simplifier->indices + indexCount;
+    simplifier->adjacencyOffsets = simplifier->adjacency + indexCount;
+    simplifier->remap            = simplifier->adjacencyOffsets + vertexCount + 1;
+    simplifier->seams            = (AVD_UInt8 *)(simplifier->remap + vertexCount);
+    simplifier->locked           = simplifier->seams + vertexCount;
+
+    memcpy(simplifier->indices, indices, sizeof(AVD_UInt32) * indexCount);
+    memset(simplifier->quadrics, 0, sizeof(AVD_MeshLodQuadric) * vertexCount);
+    for (AVD_Size vertex = 0; vertex < vertexCount; vertex++) {
+        simplifier->remap[vertex] = (AVD_UInt32)vertex;
+    }
+    if (!PRIV_avdMeshLodFindSeams(simplifier, vertices)) {
+        AVD_FREE(simplifier->positions);
+        simplifier->positions = NULL;
+        return false;
+    }
+
+    // errors are measured relative to the largest extent so that the limits
+    // and the attribute weights mean the same for every mesh
+    AVD_AABB bounds = avdAABBEmpty();
+    for (AVD_Size i = 0; i < indexCount; i++) {
+        AVD_ASSERT(indices[i] < vertexCount);
+        avdAABBExtend(&bounds, vertices[indices[i]].position);
+    }
+    AVD_Vector3 size   = avdVec3Subtract(bounds.max, bounds.min);
+    simplifier->extent = avdMax(avdMax(size.x, size.y), size.z);
+    simplifier->extent = simplifier->extent > 0.0f ? simplifier->extent : 1.0f;
+
+    for (AVD_Size vertex = 0; vertex < vertexCount; vertex++) {
+        const AVD_ModelVertex *source = &vertices[vertex];
+        AVD_Float *attributes         = simplifier->attributes + vertex * AVD_MESH_LOD_ATTRIBUTE_COUNT;
+        simplifier->positions[vertex] = avdVec3Scale(avdVec3Subtract(source->position, bounds.min), 1.0f / simplifier->extent);
+        attributes[0]                 = source->normal.x * options->normalWeight;
+        attributes[1]                 = source->normal.y * options->normalWeight;
+        attributes[2]                 = source->normal.z * options->normalWeight;
+        attributes[3]                 = source->texCoord.x * options->uvWeight;
+        attributes[4]                 = source->texCoord.y * options->uvWeight;
+    }
+
+    for (AVD_Size triangle = 0; triangle < indexCount / 3; triangle++) {
+        const AVD_UInt32 *corners = simplifier->indices + triangle * 3;
+        AVD_Vector3 a             = simplifier->positions[corners[0]];
+        AVD_Vector3 normal        = avdVec3Cross(avdVec3Subtract(simplifier->positions[corners[1]], a), avdVec3Subtract(simplifier->positions[corners[2]], a));
+        AVD_Float length          = avdVec3Length(normal);
+        if (!(length > 0.0f)) {
+            continue;
+        }
+        normal             = avdVec3Scale(normal, 1.0f / length);
+        AVD_Float distance = -avdVec3Dot(normal, a);
+        AVD_Float area     = length * 0.5f;
+        for (AVD_UInt32 corner = 0; corner < 3; corner++) {
+            AVD_MeshLodQuadric *quadric = &simplifier->quadrics[corners[corner]];
+            PRIV_avdMeshLodQuadricAddPlane(quadric, normal, distance, area);
+            PRIV_avdMeshLodQuadricAddAttributes(quadric, simplifier->attributes + corners[corner] * AVD_MESH_LOD_ATTRIBUTE_COUNT, area);
+        }
+    }
+
+    simplifier->maxErrorSq = options->maxError * options->maxError;
+    return true;
+}
+
+static void PRIV_avdMeshLodSimplifierDestroy(AVD_MeshLodSimplifier *simplifier)
+{
+    if (simplifier->positions != NULL) {
+        AVD_FREE(simplifier->positions);
+    }
+    memset(simplifier, 0, sizeof(AVD_MeshLodSimplifier));
+}
+
+static AVD_UInt32 PRIV_avdMeshLodCorner(const AVD_UInt32 *corners, AVD_UInt32 vertex)
+{
+    return corners[0] == vertex ? 0 : (corners[1] == vertex ? 1 : 2);
+}
+
+// The triangles around the vertex form a single closed fan: every edge to a
+// neighbor is used once in each direction and walking them visits them all.
+static bool PRIV_avdMeshLodIsManifold(const AVD_MeshLodSimplifier *simplifier, AVD_UInt32 vertex)
+{
+    AVD_UInt32 begin = simplifier->adjacencyOffsets[vertex];
+    AVD_UInt32 count = simplifier->adjacencyOffsets[vertex + 1] - begin;
+    if (count < 3 || count > AVD_MESH_LOD_MAX_VALENCE) {
+        return false;
+    }
+
+    AVD_UInt32 next[AVD_MESH_LOD_MAX_VALENCE];
+    AVD_UInt32 prev[AVD_MESH_LOD_MAX_VALENCE];
+    for (AVD_UInt32 i = 0; i < count; i++) {
+        const AVD_UInt32 *corners = simplifier->indices + simplifier->adjacency[begin + i] * 3;
+        AVD_UInt32 corner         = PRIV_avdMeshLodCorner(corners, vertex);
+        next[i]                   = corners[(corner + 1) % 3];
+        prev[i]                   = corners[(corner + 2) % 3];
+        if (next[i] == vertex || prev[i] == vertex || next[i] == prev[i]) {
+            return false;
+        }
+    }
+
+    AVD_UInt32 current = 0;
+    for (AVD_UInt32 step = 0; step < count; step++) {
+        AVD_UInt32 following = count;
+        for (AVD_UInt32 i = 0; i < count; i++) {
+            if (next[i] == next[current] && i != current) {
+                return false;
+            }
+            if (prev[i] == next[current]) {
+                if (following != count) {
+                    return false;
+                }
+                following = i;
+            }
+        }
+        if (following == count || (following == 0 && step + 1 < count)) {
+            return false;
+        }
+        current = following;
+    }
+    return current == 0;
+}
+
+// Moving from onto to must not turn any of the remaining triangles around
+// from too far, see AVD_MESH_LOD_MIN_NORMAL_DOT.
+static bool PRIV_avdMeshLodFlips(const AVD_MeshLodSimplifier *simplifier, AVD_UInt32 from, AVD_UInt32 to)
+{
+    AVD_Vector3 source = simplifier->positions[from];
+    AVD_Vector3 target = simplifier->positions[to];
+    for (AVD_UInt32 i = simplifier->adjacencyOffsets[from]; i < simplifier->adjacencyOffsets[from + 1]; i++) {
+        const AVD_UInt32 *corners = simplifier->indices + simplifier->adjacency[i] * 3;
+        if (corners[0] == to || corners[1] == to || corners[2] == to) {
+            continue;
+        }
+        AVD_UInt32 corner     = PRIV_avdMeshLodCorner(corners, from);
+        AVD_Vector3 b         = simplifier->positions[corners[(corner + 1) % 3]];
+        AVD_Vector3 c         = simplifier->positions[corners[(corner + 2) % 3]];
+        AVD_Vector3 before    = avdVec3Cross(avdVec3Subtract(b, source), avdVec3Subtract(c, source));
+        AVD_Vector3 after     = avdVec3Cross(avdVec3Subtract(b, target), avdVec3Subtract(c, target));
+        AVD_Float beforeSq    = avdVec3LengthSq(before);
+        AVD_Float alignment   = avdVec3Dot(before, after);
+        AVD_Float afterSq     = avdVec3LengthSq(after);
+        bool alreadyCollapsed = !(beforeSq > 0.0f);
+        if (!alreadyCollapsed && alignment <= AVD_MESH_LOD_MIN_NORMAL_DOT * avdSqrt(beforeSq * afterSq)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// One round of independent collapses, the cheapest first. Returns how many
+// were made, zero once nothing within the error limit is left.
+static AVD_Size PRIV_avdMeshLodSimplifierPass(AVD_MeshLodSimplifier *simplifier, AVD_Size targetIndexCount)
+{
+    AVD_Size vertexCount   = simplifier->vertexCount;
+    AVD_Size triangleCount = simplifier->indexCount / 3;
+    AVD_UInt32 *indices    = simplifier->indices;
+
+    // the same offsets construction as the vertex cache optimizer, filled back
+    // to front so every offset ends up at the start of its list
+    memset(simplifier->adjacencyOffsets, 0, sizeof(AVD_UInt32) * (vertexCount + 1));
+    for (AVD_Size i = 0; i < simplifier->indexCount; i++) {
+        simplifier->adjacencyOffsets[indices[i]]++;
+    }
+    AVD_UInt32 adjacencyEnd = 0;
+    for (AVD_Size vertex = 0; vertex < vertexCount; vertex++) {
+        adjacencyEnd += simplifier->adjacencyOffsets[vertex];
+        simplifier->adjacencyOffsets[vertex] = adjacencyEnd;
+    }
+    simplifier->adjacencyOffsets[vertexCount] = adjacencyEnd;
+    for (AVD_Size triangle = 0; triangle < triangleCount; triangle++) {
+        for (AVD_UInt32 corner = 0; corner < 3; corner++) {
+            AVD_UInt32 *offset                 = &simplifier->adjacencyOffsets[indices[triangle * 3 + corner]];
+            simplifier->adjacency[--(*offset)] = (AVD_UInt32)triangle;
+        }
+    }
+
+    // the cheapest collapse of every free vertex onto one of its neighbors
+    AVD_Size collapseCount = 0;
+    for (AVD_UInt32 vertex = 0; vertex < (AVD_UInt32)vertexCount; vertex++) {
+        if (simplifier->seams[vertex] || !PRIV_avdMeshLodIsManifold(simplifier, vertex)) {
+            continue;
+        }
+
+        AVD_MeshLodCollapse best = {.cost = FLT_MAX, .from = vertex, .to = vertex};
+        for (AVD_UInt32 i = simplifier->adjacencyOffsets[vertex]; i < simplifier->adjacencyOffsets[vertex + 1]; i++) {
+            const AVD_UInt32 *corners = indices + simplifier->adjacency[i] * 3;
+            AVD_UInt32 corner         = PRIV_avdMeshLodCorner(corners, vertex);
+            // every edge is seen from both of its triangles, one direction is enough
+            AVD_UInt32 neighbor = corners[(corner + 1) % 3];
+
+            AVD_MeshLodQuadric merged = {0};
+            PRIV_avdMeshLodQuadricMerge(&merged, &simplifier->quadrics[vertex], &simplifier->quadrics[neighbor]);
+            AVD_Float cost          = 0.0f;
+            AVD_Float positionError = PRIV_avdMeshLodQuadricError(
+                &merged,
+                simplifier->positions[neighbor],
+                simplifier->attributes + neighbor * AVD_MESH_LOD_ATTRIBUTE_COUNT,
+                &cost);
+            if (cost < best.cost) {
+                best.cost          = cost;
+                best.positionError = positionError;
+                best.to            = neighbor;
+            }
+        }
+        if (best.to != vertex && best.cost <= simplifier->maxErrorSq) {
+            simplifier->collapses[collapseCount++] = best;
+        }
+    }
+    qsort(simplifier->collapses, collapseCount, sizeof(AVD_MeshLodCollapse), PRIV_avdMeshLodCompareCollapses);
+
+    // locked now marks the vertices of triangles that changed this pass, the
+    // collapses and their flip checks stay independent of each other
+    memset(simplifier->locked, 0, vertexCount);
+    AVD_Size wantedTriangles  = simplifier->indexCount > targetIndexCount ? (simplifier->indexCount - targetIndexCount) / 3 : 0;
+    AVD_Size removedTriangles = 0;
+    AVD_Size collapsed        = 0;
+    for (AVD_Size i = 0; i < collapseCount && removedTriangles < wantedTriangles; i++) {
+        const AVD_MeshLodCollapse *collapse = &simplifier->collapses[i];
+        if (simplifier->locked[collapse->from] || simplifier->locked[collapse->to]) {
+            continue;
+        }
+        if (PRIV_avdMeshLodFlips(simplifier, collapse->from, collapse->to)) {
+            continue;
+        }
+
+        for (AVD_UInt32 j = simplifier->adjacencyOffsets[collapse->from]; j < simplifier->adjacencyOffsets[collapse->from + 1]; j++) {
+            const AVD_UInt32 *corners      = indices + simplifier->adjacency[j] * 3;
+            simplifier->locked[corners[0]] = 1;
+            simplifier->locked[corners[1]] = 1;
+            simplifier->locked[corners[2]] = 1;
+            removedTriangles += (corners[0] == collapse->to || corners[1] == collapse->to || corners[2] == collapse->to) ? 1 : 0;
+        }
+
+        AVD_MeshLodQuadric merged = {0};
+        PRIV_avdMeshLodQuadricMerge(&merged, &simplifier->quadrics[collapse->from], &simplifier->quadrics[collapse->to]);
+        simplifier->quadrics[collapse->to] = merged;
+        simplifier->remap[collapse->from]  = collapse->to;
+        simplifier->positionErrorSq        = avdMax(simplifier->positionErrorSq, collapse->positionError);
+        collapsed++;
+    }
+    if (collapsed == 0) {
+        return 0;
+    }
+
+    AVD_Size writeIndex = 0;
+    for (AVD_Size triangle = 0; triangle < triangleCount; triangle++) {
+        AVD_UInt32 a = simplifier->remap[indices[triangle * 3 + 0]];
+        AVD_UInt32 b = simplifier->remap[indices[triangle * 3 + 1]];
+        AVD_UInt32 c = simplifier->remap[indices[triangle * 3 + 2]];
+        if (a == b || b == c || a == c) {
+            continue;
+        }
+        indices[writeIndex++] = a;
+        indices[writeIndex++] = b;
+        indices[writeIndex++] = c;
+    }
+    simplifier->indexCount = writeIndex;
+    return collapsed;
+}
+
+static void PRIV_avdMeshLodSimplifierRun(AVD_MeshLodSimplifier *simplifier, AVD_Size targetIndexCount)
+{
+    while (simplifier->indexCount > targetIndexCount) {
+        if (PRIV_avdMeshLodSimplifierPass(simplifier, targetIndexCount) == 0) {
+            break;
+        }
+    }
+}
+
+static AVD_Float PRIV_avdMeshLodSimplifierError(const AVD_MeshLodSimplifier *simplifier)
+{
+    return avdSqrt(simplifier->positionErrorSq) * simplifier->extent;
+}
+
+void avdMeshLodOptionsDefault(AVD_MeshLodOptions *options)
+{
+    AVD_ASSERT(options != NULL);
+
+    options->triangleRatio = 0.5f;
+    options->maxError      = 0.05f;
+    options->normalWeight  = 0.1f;
+    options->uvWeight      = 0.1f;
+    options->maxLevels     = 6;
+    options->minTriangles  = 64;
+}
+
+bool avdMeshSimplify(
+    AVD_UInt32 *outIndices,
+    AVD_Size *outIndexCount,
+    const AVD_UInt32 *indices,
+    AVD_Size indexCount,
+    const AVD_ModelVertex *vertices,
+    AVD_Size vertexCount,
+    AVD_Size targetIndexCount,
+    const AVD_MeshLodOptions *options,
+    AVD_Float *outError)
+{
+    AVD_ASSERT(outIndices != NULL || indexCount == 0);
+    AVD_ASSERT(outIndexCount != NULL);
+    AVD_ASSERT(indices != NULL || indexCount == 0);
+    AVD_ASSERT(vertices != NULL || vertexCount == 0);
+    AVD_ASSERT(options != NULL);
+
+    AVD_MeshLodSimplifier simplifier = {0};
+    AVD_CHECK(PRIV_avdMeshLodSimplifierCreate(&simplifier, indices, indexCount, vertices, vertexCount, options));
+    PRIV_avdMeshLodSimplifierRun(&simplifier, targetIndexCount);
+
+    memcpy(outIndices, simplifier.indices, sizeof(AVD_UInt32) * simplifier.indexCount);
+    *outIndexCount = simplifier.indexCount;
+    if (outError != NULL) {
+        *outError = PRIV_avdMeshLodSimplifierError(&simplifier);
+    }
+
+    PRIV_avdMeshLodSimplifierDestroy(&simplifier);
+    return true;
+}
+
+// Appends a level to the index list, reordered for the vertex cache.
+static bool PRIV_avdMeshLodAppendLevel(
+    AVD_Mesh *mesh,
+    AVD_ModelResources *resources,
+    const AVD_MeshLodSimplifier *simplifier,
+    AVD_UInt32 *scratch,
+    AVD_UInt32 firstVertex)
+{
+    AVD_CHECK(avdMeshOptimizeVertexCache(scratch, simplifier->indices, simplifier->indexCount, simplifier->vertexCount, AVD_MESH_OPTIMIZER_CACHE_SIZE));
+
+    AVD_Size indexOffset = resources->indicesList.count;
+    AVD_UInt32 *indices  = (AVD_UInt32 *)avdListAddEmptyN(&resources->indicesList, simplifier->indexCount);
+    AVD_CHECK_MSG(indices != NULL, "Failed to add the level of detail indices of mesh '%s'", mesh->name);
+    for (AVD_Size i = 0; i < simplifier->indexCount; i++) {
+        indices[i] = scratch[i] + firstVertex;
+    }
+
+    AVD_MeshLod *lod   = &mesh->lods[mesh->lodCount++];
+    lod->indexOffset   = (AVD_Int32)indexOffset;
+    lod->triangleCount = (AVD_Int32)(simplifier->indexCount / 3);
+    lod->error         = PRIV_avdMeshLodSimplifierError(simplifier);
+    return true;
+}
+
+bool avdMeshBuildLods(AVD_Mesh *mesh, AVD_ModelResources *resources, const AVD_MeshLodOptions *options)
+{
+    AVD_ASSERT(mesh != NULL);
+    AVD_ASSERT(resources != NULL);
+
+    AVD_MeshLodOptions defaultOptions = {0};
+    if (options == NULL) {
+        avdMeshLodOptionsDefault(&defaultOptions);
+        options = &defaultOptions;
+    }
+    AVD_CHECK_MSG(options->maxLevels >= 1 && options->maxLevels <= AVD_MESH_MAX_LODS, "Meshes can have 1 to %d levels of detail", AVD_MESH_MAX_LODS);
+
+    AVD_Size indexCount = (AVD_Size)mesh->triangleCount * 3;
+    AVD_CHECK_MSG((AVD_Size)mesh->indexOffset + indexCount <= resources->indicesList.count, "Mesh '%s' references indices past the end of the index list", mesh->name);
+
+    mesh->lods[0]  = (AVD_MeshLod){.indexOffset = mesh->indexOffset, .triangleCount = mesh->triangleCount, .error = 0.0f};
+    mesh->lodCount = 1;
+    if (indexCount == 0 || options->maxLevels == 1) {
+        return true;
+    }
+
+    const AVD_UInt32 *meshIndices = (const AVD_UInt32 *)resources->indicesList.items + mesh->indexOffset;
+
+    // only the vertex range the mesh uses is decoded, like avdMeshBuildMeshlets
+    AVD_UInt32 firstVertex = UINT32_MAX;
+    AVD_UInt32 lastVertex  = 0;
+    for (AVD_Size i = 0; i < indexCount; i++) {
+        AVD_CHECK_MSG(meshIndices[i] < resources->verticesList.count, "Mesh '%s' references vertex %u past the end of the vertex list", mesh->name, meshIndices[i]);
+        firstVertex = AVD_MIN(firstVertex, meshIndices[i]);
+        lastVertex  = AVD_MAX(lastVertex, meshIndices[i]);
+    }
+    AVD_Size vertexCount = (AVD_Size)(lastVertex - firstVertex) + 1;
+
+    AVD_Size storageSize      = sizeof(AVD_ModelVertex) * vertexCount + sizeof(AVD_UInt32) * indexCount * 2;
+    AVD_ModelVertex *vertices = (AVD_ModelVertex *)AVD_MALLOC(storageSize);
+    AVD_CHECK_MSG(vertices != NULL, "Failed to allocate the simplification of mesh '%s'", mesh->name);
+    AVD_UInt32 *localIndices = (AVD_UInt32 *)(vertices + vertexCount);
+    AVD_UInt32 *scratch      = localIndices + indexCount;
+
+    const AVD_ModelVertexPacked *packed = (const AVD_ModelVertexPacked *)resources->verticesList.items + firstVertex;
+    for (AVD_Size i = 0; i < vertexCount; i++) {
+        avdModelVertexUnpack(&packed[i], &vertices[i]);
+    }
+    for (AVD_Size i = 0; i < indexCount; i++) {
+        localIndices[i] = meshIndices[i] - firstVertex;
+    }
+
+    AVD_MeshLodSimplifier simplifier = {0};
+    bool ok                          = PRIV_avdMeshLodSimplifierCreate(&simplifier, localIndices, indexCount, vertices, vertexCount, options);
+    while (ok && mesh->lodCount < options->maxLevels) {
+        AVD_Size previousTriangles = (AVD_Size)mesh->lods[mesh->lodCount - 1].triangleCount;
+        if (previousTriangles <= (AVD_Size)options->minTriangles) {
+            break;
+        }
+        AVD_Size targetTriangles = AVD_MAX((AVD_Size)((AVD_Float)previousTriangles * options->triangleRatio), (AVD_Size)options->minTriangles);
+        PRIV_avdMeshLodSimplifierRun(&simplifier, targetTriangles * 3);
+
+        AVD_Size triangles = simplifier.indexCount / 3;
+        if ((AVD_Float)triangles > (AVD_Float)previousTriangles * (1.0f - AVD_MESH_LOD_MIN_REDUCTION)) {
+            break;
+        }
+        ok = PRIV_avdMeshLodAppendLevel(mesh, resources, &simplifier, scratch, firstVertex);
+    }
+
+    PRIV_avdMeshLodSimplifierDestroy(&simplifier);
+    AVD_FREE(vertices);
+    AVD_CHECK_MSG(ok, "Failed to build the levels of detail of mesh '%s'", mesh->name);
+    return true;
+}
+
+AVD_MeshLod avdMeshGetLod(const AVD_Mesh *mesh, AVD_Int32 level)
+{
+    AVD_ASSERT(mesh != NULL);
+
+    if (mesh->lodCount <= 0 || level <= 0) {
+        return (AVD_MeshLod){.indexOffset = mesh->indexOffset, .triangleCount = mesh->triangleCount, .error = 0.0f};
+    }
+    return mesh->lods[AVD_MIN(level, mesh->lodCount - 1)];
+}
+
+void avdMeshLodStatsAdd(AVD_MeshLodStats *total, const AVD_Mesh *mesh)
+{
+    AVD_ASSERT(total != NULL);
+    AVD_ASSERT(mesh != NULL);
+
+    total->meshCount++;
+    total->levelCount = AVD_MAX(total->levelCount, AVD_MAX(mesh->lodCount, 1));
+    for (AVD_Int32 level = 0; level < AVD_MESH_MAX_LODS; level++) {
+        total->triangleCount[level] += (AVD_Size)avdMeshGetLod(mesh, level).triangleCount;
+    }
+}
+
+AVD_Float avdMeshLodProjectionScale(AVD_Float fovY, AVD_Float viewportHeight)
+{
+    return viewportHeight / (2.0f * tanf(fovY * 0.5f));
+}
+
+AVD_Int32 avdMeshSelectLod(const AVD_Mesh *mesh, AVD_Float distance, AVD_Float scale, AVD_Float projectionScale, AVD_Float maxPixelError)
+{
+    AVD_ASSERT(mesh != NULL);
+
+    // inside the bounds everything has to be full detail
+    if (mesh->lodCount <= 1 || !(distance > 0.0f)) {
+        return 0;
+    }
+
+    AVD_Float pixelsPerUnit = projectionScale * scale / distance;
+    for (AVD_Int32 level = mesh->lodCount - 1; level > 0; level--) {
+        if (mesh->lods[level].error * pixelsPerUnit <= maxPixelError) {
+            return level;
+        }
+    }
+    return 0;
+}
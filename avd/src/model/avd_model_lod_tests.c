@@ -0,0 +1,266 @@
+#include "core/avd_core.h"
+#include "model/avd_model_lod.h"
+
+static void PRIV_avdModelLodTestPushTriangle(AVD_ModelResources *resources, AVD_UInt32 a, AVD_UInt32 b, AVD_UInt32 c)
+{
+    avdListPushBack(&resources->indicesList, &a);
+    avdListPushBack(&resources->indicesList, &b);
+    avdListPushBack(&resources->indicesList, &c);
+}
+
+// Lat-long sphere with outward facing triangles and smooth normals, the pole
+// rows are degenerate and the first and last column are a texture seam.
+static void PRIV_avdModelLodTestAddSphere(AVD_ModelResources *resources, AVD_Mesh *mesh, AVD_UInt32 rings, AVD_UInt32 segments)
+{
+    avdMeshInitWithNameId(mesh, "LodTestSphere", 0);
+    mesh->indexOffset = (AVD_Int32)resources->indicesList.count;
+
+    AVD_UInt32 firstVertex = (AVD_UInt32)resources->verticesList.count;
+    for (AVD_UInt32 ring = 0; ring <= rings; ring++) {
+        AVD_Float theta = AVD_PI * (AVD_Float)ring / (AVD_Float)rings;
+        for (AVD_UInt32 segment = 0; segment <= segments; segment++) {
+            AVD_Float phi                      = 2.0f * AVD_PI * (AVD_Float)segment / (AVD_Float)segments;
+            AVD_ModelVertex vertex             = {0};
+            AVD_ModelVertexPacked packedVertex = {0};
+            avdModelVertexInit(&vertex);
+            vertex.position = avdVec3(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi));
+            vertex.normal   = vertex.position;
+            vertex.texCoord = avdVec2((AVD_Float)segment / (AVD_Float)segments, (AVD_Float)ring / (AVD_Float)rings);
+            avdModelVertexPack(&vertex, &packedVertex);
+            avdListPushBack(&resources->verticesList, &packedVertex);
+        }
+    }
+    for (AVD_UInt32 ring = 0; ring < rings; ring++) {
+        for (AVD_UInt32 segment = 0; segment < segments; segment++) {
+            AVD_UInt32 a = firstVertex + ring * (segments + 1) + segment;
+            AVD_UInt32 b = a + segments + 1;
+            PRIV_avdModelLodTestPushTriangle(resources, a, a + 1, b);
+            PRIV_avdModelLodTestPushTriangle(resources, a + 1, b + 1, b);
+        }
+    }
+    mesh->triangleCount = (AVD_Int32)(rings * segments * 2);
+}
+
+static AVD_Vector3 PRIV_avdModelLodTestPosition(const AVD_ModelResources *resources, AVD_UInt32 vertex)
+{
+    AVD_ModelVertex unpacked = {0};
+    avdModelVertexUnpack((const AVD_ModelVertexPacked *)avdListGet(&resources->verticesList, vertex), &unpacked);
+    return unpacked.position;
+}
+
+// Flat grid of size by size quads in the xy plane facing +z.
+static bool PRIV_avdModelLodTestGrid(void)
+{
+    const AVD_UInt32 size     = 64;
+    AVD_Size vertexCount      = (AVD_Size)(size + 1) * (size + 1);
+    AVD_Size indexCount       = (AVD_Size)size * size * 6;
+    AVD_ModelVertex *vertices = (AVD_ModelVertex *)AVD_MALLOC(sizeof(AVD_ModelVertex) * vertexCount);
+    AVD_UInt32 *indices       = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * indexCount * 2);
+    AVD_CHECK_MSG(vertices != NULL && indices != NULL, "Failed to allocate the grid");
+    AVD_UInt32 *simplified = indices + indexCount;
+
+    for (AVD_UInt32 y = 0; y <= size; y++) {
+        for (AVD_UInt32 x = 0; x <= size; x++) {
+            AVD_ModelVertex *vertex = &vertices[y * (size + 1) + x];
+            avdModelVertexInit(vertex);
+            vertex->position = avdVec3((AVD_Float)x, (AVD_Float)y, 0.0f);
+            vertex->normal   = avdVec3(0.0f, 0.0f, 1.0f);
+            vertex->texCoord = avdVec2((AVD_Float)x / (AVD_Float)size, (AVD_Float)y / (AVD_Float)size);
+        }
+    }
+    AVD_Size writeIndex = 0;
+    for (AVD_UInt32 y = 0; y < size; y++) {
+        for (AVD_UInt32 x = 0; x < size; x++) {
+            AVD_UInt32 a          = y * (size + 1) + x;
+            AVD_UInt32 b          = a + size + 1;
+            indices[writeIndex++] = a;
+            indices[writeIndex++] = a + 1;
+            indices[writeIndex++] = b + 1;
+            indices[writeIndex++] = a;
+            indices[writeIndex++] = b + 1;
+            indices[writeIndex++] = b;
+        }
+    }
+
+    AVD_MeshLodOptions options = {0};
+    avdMeshLodOptionsDefault(&options);
+    AVD_Size simplifiedCount = 0;
+    AVD_Float error          = -1.0f;
+    bool ok                  = avdMeshSimplify(simplified, &simplifiedCount, indices, indexCount, vertices, vertexCount, 0, &options, &error);
+
+    // the border has to stay where it is, every corner and edge vertex used
+    AVD_UInt8 used[(64 + 1) * (64 + 1)] = {0};
+    for (AVD_Size i = 0; ok && i < simplifiedCount; i += 3) {
+        AVD_Vector3 a      = vertices[simplified[i + 0]].position;
+        AVD_Vector3 normal = avdVec3Cross(avdVec3Subtract(vertices[simplified[i + 1]].position, a), avdVec3Subtract(vertices[simplified[i + 2]].position, a));
+        ok                 = normal.z > 0.0f;
+        for (AVD_UInt32 corner = 0; corner < 3; corner++) {
+            used[simplified[i + corner]] = 1;
+        }
+    }
+    AVD_Size borderUsed = 0;
+    for (AVD_UInt32 i = 0; i <= size; i++) {
+        borderUsed += used[i] + used[size * (size + 1) + i] + used[i * (size + 1)] + used[i * (size + 1) + size];
+    }
+
+    AVD_FREE(vertices);
+    AVD_FREE(indices);
+    AVD_CHECK_MSG(ok, "Simplifying the grid flipped a triangle");
+    AVD_LOG_DEBUG("    grid: %zu of %zu triangles left, error %f", simplifiedCount / 3, indexCount / 3, error);
+
+    AVD_CHECK_MSG(borderUsed == (AVD_Size)(size + 1) * 4, "Only %zu of the %u border vertices are left", borderUsed, (size + 1) * 4);
+    // a flat grid with a locked border goes down to about two triangles per border vertex
+    AVD_CHECK_MSG(simplifiedCount / 3 < indexCount / 3 / 8, "Only simplified the grid to %zu triangles", simplifiedCount / 3);
+    AVD_CHECK_MSG(error >= 0.0f && error < 1e-3f, "A flat grid was simplified with an error of %f", error);
+    return true;
+}
+
+// Every level of the sphere is smaller and less precise than the one before,
+// faces outward and stays close to the unit sphere.
+static bool PRIV_avdModelLodTestSphere(void)
+{
+    AVD_ModelResources resources = {0};
+    AVD_CHECK(avdModelResourcesCreate(&resources));
+
+    // a triangle in front so that the mesh does not start at zero
+    PRIV_avdModelLodTestPushTriangle(&resources, 0, 0, 0);
+    AVD_Mesh mesh = {0};
+    PRIV_avdModelLodTestAddSphere(&resources, &mesh, 64, 128);
+
+    bool ok                = avdMeshBuildLods(&mesh, &resources, NULL);
+    ok                     = ok && mesh.lodCount >= 3;
+    ok                     = ok && mesh.lods[0].indexOffset == mesh.indexOffset && mesh.lods[0].triangleCount == mesh.triangleCount;
+    AVD_MeshLodStats stats = {0};
+    avdMeshLodStatsAdd(&stats, &mesh);
+
+    AVD_Float worstRadius = 0.0f;
+    for (AVD_Int32 level = 1; ok && level < mesh.lodCount; level++) {
+        const AVD_MeshLod *lod      = &mesh.lods[level];
+        const AVD_MeshLod *previous = &mesh.lods[level - 1];
+        ok                          = lod->triangleCount < previous->triangleCount && lod->error >= previous->error;
+        ok                          = ok && (AVD_Size)(lod->indexOffset + lod->triangleCount * 3) <= resources.indicesList.count;
+
+        const AVD_UInt32 *indices = (const AVD_UInt32 *)resources.indicesList.items + lod->indexOffset;
+        for (AVD_Int32 i = 0; ok && i < lod->triangleCount * 3; i += 3) {
+            AVD_Vector3 a        = PRIV_avdModelLodTestPosition(&resources, indices[i + 0]);
+            AVD_Vector3 b        = PRIV_avdModelLodTestPosition(&resources, indices[i + 1]);
+            AVD_Vector3 c        = PRIV_avdModelLodTestPosition(&resources, indices[i + 2]);
+            AVD_Vector3 centroid = avdVec3Scale(avdVec3Add(avdVec3Add(a, b), c), 1.0f / 3.0f);
+            AVD_Vector3 normal   = avdVec3Cross(avdVec3Subtract(b, a), avdVec3Subtract(c, a));
+            ok                   = indices[i + 0] != indices[i + 1] && indices[i + 1] != indices[i + 2] && indices[i + 0] != indices[i + 2];
+            // the pole triangles stay degenerate in position
+            ok          = ok && avdVec3Dot(normal, centroid) >= 0.0f;
+            worstRadius = avdMax(worstRadius, 1.0f - avdVec3Length(centroid));
+        }
+    }
+    avdModelResourcesDestroy(&resources);
+    AVD_CHECK_MSG(ok, "Levels of detail of the sphere are not ordered or have broken triangles");
+
+    for (AVD_Int32 level = 0; level < stats.levelCount; level++) {
+        AVD_LOG_DEBUG("    sphere level %d: %zu triangles, error %f", level, stats.triangleCount[level], mesh.lods[level].error);
+    }
+
+    AVD_CHECK_MSG(mesh.lods[1].error < 0.02f, "The first level already moved the surface by %f", mesh.lods[1].error);
+    AVD_CHECK_MSG(mesh.lods[mesh.lodCount - 1].error < 0.2f, "The last level moved the surface by %f", mesh.lods[mesh.lodCount - 1].error);
+    AVD_CHECK_MSG(worstRadius < 0.3f, "A triangle of the simplified sphere is %f inside of it", worstRadius);
+    return true;
+}
+
+static bool PRIV_avdModelLodTestSelect(void)
+{
+    AVD_Mesh mesh = {0};
+    avdMeshInitWithNameId(&mesh, "LodTestSelect", 1);
+    mesh.triangleCount = 1000;
+
+    // no levels always draws the mesh itself
+    AVD_CHECK(avdMeshSelectLod(&mesh, 100.0f, 1.0f, 1000.0f, 1.0f) == 0);
+    AVD_MeshLod lod = avdMeshGetLod(&mesh, 3);
+    AVD_CHECK(lod.indexOffset == 0 && lod.triangleCount == 1000);
+
+    const AVD_Float errors[] = {0.0f, 0.01f, 0.05f, 0.2f};
+    for (AVD_Int32 level = 0; level < 4; level++) {
+        mesh.lods[level] = (AVD_MeshLod){.indexOffset = 1000 * level, .triangleCount = 1000 >> level, .error = errors[level]};
+    }
+    mesh.lodCount = 4;
+
+    // 1080 pixels for 60 degrees, about 935 pixels per unit at distance one
+    AVD_Float projectionScale = avdMeshLodProjectionScale(AVD_PI / 3.0f, 1080.0f);
+    AVD_CHECK(fabsf(projectionScale - 935.307f) < 1e-2f);
+
+    AVD_CHECK(avdMeshSelectLod(&mesh, 0.0f, 1.0f, projectionScale, 1.0f) == 0);
+    AVD_CHECK(avdMeshSelectLod(&mesh, 5.0f, 1.0f, projectionScale, 1.0f) == 0);
+    AVD_CHECK(avdMeshSelectLod(&mesh, 10.0f, 1.0f, projectionScale, 1.0f) == 1);
+    AVD_CHECK(avdMeshSelectLod(&mesh, 50.0f, 1.0f, projectionScale, 1.0f) == 2);
+    AVD_CHECK(avdMeshSelectLod(&mesh, 500.0f, 1.0f, projectionScale, 1.0f) == 3);
+    // twice the scale needs twice the distance, twice the tolerance half of it
+    AVD_CHECK(avdMeshSelectLod(&mesh, 50.0f, 2.0f, projectionScale, 1.0f) == 1);
+    AVD_CHECK(avdMeshSelectLod(&mesh, 25.0f, 1.0f, projectionScale, 2.0f) == 2);
+
+    lod = avdMeshGetLod(&mesh, 7);
+    AVD_CHECK(lod.indexOffset == 3000 && lod.triangleCount == 125);
+    return true;
+}
+
+static bool PRIV_avdModelLodTestEmpty(void)
+{
+    AVD_ModelResources resources = {0};
+    AVD_CHECK(avdModelResourcesCreate(&resources));
+
+    AVD_Mesh mesh = {0};
+    avdMeshInitWithNameId(&mesh, "LodTestEmpty", 2);
+    bool ok = avdMeshBuildLods(&mesh, &resources, NULL);
+    ok      = ok && mesh.lodCount == 1 && mesh.lods[0].triangleCount == 0 && resources.indicesList.count == 0;
+    avdModelResourcesDestroy(&resources);
+
+    AVD_CHECK_MSG(ok, "An empty mesh got levels of detail");
+    return true;
+}
+
+bool avdModelLodTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Model Lod Tests...");
+
+    AVD_CHECK(PRIV_avdModelLodTestGrid());
+    AVD_CHECK(PRIV_avdModelLodTestSphere());
+    AVD_CHECK(PRIV_avdModelLodTestSelect());
+    AVD_CHECK(PRIV_avdModelLodTestEmpty());
+
+    AVD_LOG_DEBUG("All AVD Model Lod Tests PASSED");
+    return true;
+}
+
+typedef struct {
+    AVD_ModelResources resources;
+    AVD_Mesh mesh;
+    AVD_Size indexCount;
+} AVD_ModelLodBenchmark;
+
+static void PRIV_avdModelLodBenchmarkBuild(void *userData)
+{
+    AVD_ModelLodBenchmark *benchmark = (AVD_ModelLodBenchmark *)userData;
+    avdListResize(&benchmark->resources.indicesList, benchmark->indexCount);
+    avdMeshBuildLods(&benchmark->mesh, &benchmark->resources, NULL);
+}
+
+bool avdModelLodBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD Model Lod benchmarks...");
+
+    AVD_ModelLodBenchmark benchmark = {0};
+    AVD_CHECK(avdModelResourcesCreate(&benchmark.resources));
+    PRIV_avdModelLodTestAddSphere(&benchmark.resources, &benchmark.mesh, 256, 512);
+    benchmark.indexCount = benchmark.resources.indicesList.count;
+
+    AVD_BenchCase buildCase = {
+        .name               = "lod/build_sphere_256k",
+        .unit               = "triangles",
+        .itemsPerRepetition = (AVD_Size)benchmark.mesh.triangleCount,
+        .run                = PRIV_avdModelLodBenchmarkBuild,
+        .userData           = &benchmark,
+    };
+    bool ok = avdBenchRun(bench, &buildCase);
+
+    avdModelResourcesDestroy(&benchmark.resources);
+    return ok;
+}
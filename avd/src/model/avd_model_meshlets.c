@@ -0,0 +1,370 @@
+#include "model/avd_model_meshlets.h"
+
+#define AVD_MESHLET_NO_VERTEX   0xffu
+#define AVD_MESHLET_NO_TRIANGLE UINT32_MAX
+
+// Cones where the widest triangle normal is this close to perpendicular to
+// the axis are nearly half spheres and are never worth testing.
+#define AVD_MESHLET_MIN_CONE_DOT 0.1f
+
+typedef struct {
+    AVD_UInt32 vertices[AVD_MESHLET_MAX_VERTICES];
+    AVD_UInt32 triangles[AVD_MESHLET_MAX_TRIANGLES]; // packed
+    AVD_UInt32 triangleIds[AVD_MESHLET_MAX_TRIANGLES];
+    AVD_UInt32 vertexCount;
+    AVD_UInt32 triangleCount;
+    AVD_Vector3 centroidSum;
+    AVD_Vector3 normalSum;
+} AVD_MeshletBuilderMeshlet;
+
+// Indices are relative to the first vertex the mesh uses, triangles leave the
+// adjacency lists of their vertices as soon as they are added to a meshlet.
+typedef struct {
+    const AVD_UInt32 *indices;
+    AVD_Vector3 *positions;
+    AVD_Vector3 *normals; // zero for degenerate triangles
+    AVD_Vector3 *centroids;
+    AVD_UInt32 *adjacencyOffsets;
+    AVD_UInt32 *adjacency;
+    AVD_UInt32 *liveTriangles;
+    AVD_UInt8 *meshletVertices; // index in the open meshlet or AVD_MESHLET_NO_VERTEX
+    AVD_UInt8 *emitted;
+    AVD_Size vertexCount;
+    AVD_Size triangleCount;
+    AVD_Size scanTriangle;
+
+    // vertices of the last finished meshlet, the next one starts next to it
+    AVD_UInt32 lastVertices[AVD_MESHLET_MAX_VERTICES];
+    AVD_UInt32 lastVertexCount;
+} AVD_MeshletBuilder;
+
+static AVD_Vector3 PRIV_avdMeshletVertexPosition(const AVD_ModelVertexPacked *vertex)
+{
+    return avdVec3(avdDequantizeHalf(vertex->vx), avdDequantizeHalf(vertex->vy), avdDequantizeHalf(vertex->vz));
+}
+
+static AVD_UInt32 PRIV_avdMeshletNewVertices(const AVD_MeshletBuilder *builder, AVD_UInt32 triangle)
+{
+    const AVD_UInt32 *corners = builder->indices + triangle * 3;
+    return (builder->meshletVertices[corners[0]] == AVD_MESHLET_NO_VERTEX ? 1 : 0) +
+           (builder->meshletVertices[corners[1]] == AVD_MESHLET_NO_VERTEX ? 1 : 0) +
+           (builder->meshletVertices[corners[2]] == AVD_MESHLET_NO_VERTEX ? 1 : 0);
+}
+
+static void PRIV_avdMeshletEmit(AVD_MeshletBuilder *builder, AVD_MeshletBuilderMeshlet *meshlet, AVD_UInt32 triangle)
+{
+    AVD_ASSERT(!builder->emitted[triangle]);
+    AVD_ASSERT(meshlet->triangleCount < AVD_MESHLET_MAX_TRIANGLES);
+
+    AVD_UInt8 corners[3] = {0};
+    for (AVD_UInt32 corner = 0; corner < 3; corner++) {
+        AVD_UInt32 vertex = builder->indices[triangle * 3 + corner];
+        if (builder->meshletVertices[vertex] == AVD_MESHLET_NO_VERTEX) {
+            AVD_ASSERT(meshlet->vertexCount < AVD_MESHLET_MAX_VERTICES);
+            builder->meshletVertices[vertex]          = (AVD_UInt8)meshlet->vertexCount;
+            meshlet->vertices[meshlet->vertexCount++] = vertex;
+        }
+        corners[corner] = builder->meshletVertices[vertex];
+
+        // swap the triangle out of the live part of the adjacency list
+        AVD_UInt32 *triangles = builder->adjacency + builder->adjacencyOffsets[vertex];
+        AVD_UInt32 liveCount  = builder->liveTriangles[vertex];
+        for (AVD_UInt32 i = 0; i < liveCount; i++) {
+            if (triangles[i] == triangle) {
+                triangles[i]             = triangles[liveCount - 1];
+                triangles[liveCount - 1] = triangle;
+                builder->liveTriangles[vertex]--;
+                break;
+            }
+        }
+    }
+
+    builder->emitted[triangle]                   = 1;
+    meshlet->triangleIds[meshlet->triangleCount] = triangle;
+    meshlet->triangles[meshlet->triangleCount++] = avdMeshletTrianglePack(corners[0], corners[1], corners[2]);
+    meshlet->centroidSum                         = avdVec3Add(meshlet->centroidSum, builder->centroids[triangle]);
+    meshlet->normalSum                           = avdVec3Add(meshlet->normalSum, builder->normals[triangle]);
+}
+
+// Best triangle next to the open meshlet, the one adding the fewest vertices
+// and of those the closest one facing the same way. blocked is set when there
+// are neighbors but none of them fits.
+static AVD_UInt32 PRIV_avdMeshletNextTriangle(const AVD_MeshletBuilder *builder, const AVD_MeshletBuilderMeshlet *meshlet, bool *blocked)
+{
+    *blocked = false;
+    if (meshlet->triangleCount == 0) {
+        return AVD_MESHLET_NO_TRIANGLE;
+    }
+
+    AVD_Vector3 centroid = avdVec3Scale(meshlet->centroidSum, 1.0f / (AVD_Float)meshlet->triangleCount);
+    AVD_Vector3 axis     = avdVec3Scale(meshlet->normalSum, avdVec3InvLength(meshlet->normalSum));
+
+    AVD_UInt32 best    = AVD_MESHLET_NO_TRIANGLE;
+    AVD_UInt32 bestNew = UINT32_MAX;
+    AVD_Float bestCost = FLT_MAX;
+    for (AVD_UInt32 i = 0; i < meshlet->vertexCount; i++) {
+        AVD_UInt32 vertex           = meshlet->vertices[i];
+        const AVD_UInt32 *triangles = builder->adjacency + builder->adjacencyOffsets[vertex];
+        for (AVD_UInt32 j = 0; j < builder->liveTriangles[vertex]; j++) {
+            AVD_UInt32 triangle    = triangles[j];
+            AVD_UInt32 newVertices = PRIV_avdMeshletNewVertices(builder, triangle);
+            if (meshlet->vertexCount + newVertices > AVD_MESHLET_MAX_VERTICES) {
+                *blocked = true;
+                continue;
+            }
+            if (newVertices > bestNew) {
+                continue;
+            }
+
+            AVD_Vector3 offset = avdVec3Subtract(builder->centroids[triangle], centroid);
+            AVD_Float cost     = avdVec3Length(offset) * (2.0f - avdVec3Dot(builder->normals[triangle], axis));
+            if (newVertices < bestNew || cost < bestCost) {
+                best     = triangle;
+                bestNew  = newVertices;
+                bestCost = cost;
+            }
+        }
+    }
+
+    if (best != AVD_MESHLET_NO_TRIANGLE) {
+        *blocked = false;
+    }
+    return best;
+}
+
+// Start of a new meshlet, on the border of the previous one where the fewest
+// triangles are left around it so that no small islands are left behind.
+// Without any such triangle the next one in index order continues.
+static AVD_UInt32 PRIV_avdMeshletSeedTriangle(AVD_MeshletBuilder *builder, const AVD_MeshletBuilderMeshlet *meshlet)
+{
+    AVD_UInt32 best     = AVD_MESHLET_NO_TRIANGLE;
+    AVD_UInt32 bestLive = UINT32_MAX;
+    for (AVD_UInt32 i = 0; meshlet->triangleCount == 0 && i < builder->lastVertexCount; i++) {
+        AVD_UInt32 vertex           = builder->lastVertices[i];
+        const AVD_UInt32 *triangles = builder->adjacency + builder->adjacencyOffsets[vertex];
+        for (AVD_UInt32 j = 0; j < builder->liveTriangles[vertex]; j++) {
+            const AVD_UInt32 *corners = builder->indices + triangles[j] * 3;
+            AVD_UInt32 live           = builder->liveTriangles[corners[0]] + builder->liveTriangles[corners[1]] + builder->liveTriangles[corners[2]];
+            if (live < bestLive) {
+                best     = triangles[j];
+                bestLive = live;
+            }
+        }
+    }
+    if (best != AVD_MESHLET_NO_TRIANGLE) {
+        return best;
+    }
+
+    while (builder->scanTriangle < builder->triangleCount && builder->emitted[builder->scanTriangle]) {
+        builder->scanTriangle++;
+    }
+    AVD_ASSERT(builder->scanTriangle < builder->triangleCount);
+    return (AVD_UInt32)builder->scanTriangle;
+}
+
+static void PRIV_avdMeshletComputeBounds(const AVD_MeshletBuilder *builder, const AVD_MeshletBuilderMeshlet *meshlet, AVD_Meshlet *outMeshlet)
+{
+    AVD_Vector3 positions[AVD_MESHLET_MAX_VERTICES];
+    for (AVD_UInt32 i = 0; i < meshlet->vertexCount; i++) {
+        positions[i] = builder->positions[meshlet->vertices[i]];
+    }
+
+    // same sphere as the mesh bounds, centered on the box and as large as the
+    // farthest vertex
+    AVD_AABB box       = avdAABBFromPoints(positions, meshlet->vertexCount);
+    AVD_Vector3 center = avdAABBCenter(box);
+    AVD_Float radiusSq = 0.0f;
+    for (AVD_UInt32 i = 0; i < meshlet->vertexCount; i++) {
+        AVD_Vector3 offset = avdVec3Subtract(positions[i], center);
+        radiusSq           = avdMax(radiusSq, avdVec3LengthSq(offset));
+    }
+
+    // the cone around all triangle normals, turned into the cutoff of the
+    // culling test, sin(a) for a cone with a half angle of a
+    AVD_Vector3 axis = avdVec3Scale(meshlet->normalSum, avdVec3InvLength(meshlet->normalSum));
+    AVD_Float minDot = 1.0f;
+    for (AVD_UInt32 i = 0; i < meshlet->triangleCount; i++) {
+        AVD_Vector3 normal = builder->normals[meshlet->triangleIds[i]];
+        if (avdVec3LengthSq(normal) > 0.0f) {
+            minDot = avdMin(minDot, avdVec3Dot(normal, axis));
+        }
+    }
+
+    // a zero axis with a cutoff of 1 never passes the test
+    bool hasCone = minDot > AVD_MESHLET_MIN_CONE_DOT;
+    if (!hasCone) {
+        axis = avdVec3Zero();
+    }
+
+    outMeshlet->center[0]     = center.x;
+    outMeshlet->center[1]     = center.y;
+    outMeshlet->center[2]     = center.z;
+    outMeshlet->radius        = avdSqrt(radiusSq);
+    outMeshlet->coneAxis[0]   = axis.x;
+    outMeshlet->coneAxis[1]   = axis.y;
+    outMeshlet->coneAxis[2]   = axis.z;
+    outMeshlet->coneCutoff    = hasCone ? avdSqrt(1.0f - minDot * minDot) : 1.0f;
+    outMeshlet->vertexCount   = meshlet->vertexCount;
+    outMeshlet->triangleCount = meshlet->triangleCount;
+}
+
+static void PRIV_avdMeshletFlush(AVD_MeshletBuilder *builder, AVD_MeshletBuilderMeshlet *meshlet, AVD_ModelResources *resources, AVD_UInt32 firstVertex)
+{
+    if (meshlet->triangleCount == 0) {
+        return;
+    }
+
+    AVD_Meshlet gpuMeshlet = {0};
+    PRIV_avdMeshletComputeBounds(builder, meshlet, &gpuMeshlet);
+    gpuMeshlet.vertexOffset   = (uint32_t)resources->meshletVerticesList.count;
+    gpuMeshlet.triangleOffset = (uint32_t)resources->meshletTrianglesList.count;
+    avdListPushBack(&resources->meshletsList, &gpuMeshlet);
+
+    uint32_t *vertices = (uint32_t *)avdListAddEmptyN(&resources->meshletVerticesList, meshlet->vertexCount);
+    for (AVD_UInt32 i = 0; i < meshlet->vertexCount; i++) {
+        vertices[i]                                    = meshlet->vertices[i] + firstVertex;
+        builder->meshletVertices[meshlet->vertices[i]] = AVD_MESHLET_NO_VERTEX;
+        builder->lastVertices[i]                       = meshlet->vertices[i];
+    }
+    builder->lastVertexCount = meshlet->vertexCount;
+
+    uint32_t *triangles = (uint32_t *)avdListAddEmptyN(&resources->meshletTrianglesList, meshlet->triangleCount);
+    memcpy(triangles, meshlet->triangles, sizeof(uint32_t) * meshlet->triangleCount);
+
+    meshlet->vertexCount   = 0;
+    meshlet->triangleCount = 0;
+    meshlet->centroidSum   = avdVec3Zero();
+    meshlet->normalSum     = avdVec3Zero();
+}
+
+bool avdMeshBuildMeshlets(AVD_Mesh *mesh, AVD_ModelResources *resources)
+{
+    AVD_ASSERT(mesh != NULL);
+    AVD_ASSERT(resources != NULL);
+
+    AVD_Size indexCount = (AVD_Size)mesh->triangleCount * 3;
+    AVD_CHECK_MSG((AVD_Size)mesh->indexOffset + indexCount <= resources->indicesList.count, "Mesh '%s' references indices past the end of the index list", mesh->name);
+
+    mesh->meshletOffset = (AVD_Int32)resources->meshletsList.count;
+    mesh->meshletCount  = 0;
+    if (indexCount == 0) {
+        return true;
+    }
+
+    const AVD_UInt32 *indices             = (const AVD_UInt32 *)resources->indicesList.items + mesh->indexOffset;
+    const AVD_ModelVertexPacked *vertices = (const AVD_ModelVertexPacked *)resources->verticesList.items;
+
+    // only the vertex range the mesh uses is decoded, like avdMeshBuildBvh
+    AVD_UInt32 firstVertex = UINT32_MAX;
+    AVD_UInt32 lastVertex  = 0;
+    for (AVD_Size i = 0; i < indexCount; i++) {
+        AVD_CHECK_MSG(indices[i] < resources->verticesList.count, "Mesh '%s' references vertex %u past the end of the vertex list", mesh->name, indices[i]);
+        firstVertex = AVD_MIN(firstVertex, indices[i]);
+        lastVertex  = AVD_MAX(lastVertex, indices[i]);
+    }
+
+    AVD_MeshletBuilder builder = {0};
+    builder.vertexCount        = (AVD_Size)(lastVertex - firstVertex) + 1;
+    builder.triangleCount      = (AVD_Size)mesh->triangleCount;
+
+    // one allocation for the decoded geometry, the adjacency and the flags
+    AVD_Size vectorCount = builder.vertexCount + builder.triangleCount * 2;
+    AVD_Size wordCount   = indexCount + (builder.vertexCount + 1) + indexCount + builder.vertexCount;
+    AVD_Size byteCount   = builder.vertexCount + builder.triangleCount;
+    AVD_Size storageSize = sizeof(AVD_Vector3) * vectorCount + sizeof(AVD_UInt32) * wordCount + byteCount;
+    AVD_Vector3 *storage = (AVD_Vector3 *)AVD_MALLOC(storageSize);
+    AVD_CHECK_MSG(storage != NULL, "Failed to allocate the meshlet builder of mesh '%s'", mesh->name);
+
+    builder.positions        = storage;
+    builder.normals          = builder.positions + builder.vertexCount;
+    builder.centroids        = builder.normals + builder.triangleCount;
+    AVD_UInt32 *localIndices = (AVD_UInt32 *)(builder.centroids + builder.triangleCount);
+    builder.indices          = localIndices;
+    builder.adjacencyOffsets = localIndices + indexCount;
+    builder.adjacency        = builder.adjacencyOffsets + builder.vertexCount + 1;
+    builder.liveTriangles    = builder.adjacency + indexCount;
+    builder.meshletVertices  = (AVD_UInt8 *)(builder.liveTriangles + builder.vertexCount);
+    builder.emitted          = builder.meshletVertices + builder.vertexCount;
+    memset(builder.liveTriangles, 0, sizeof(AVD_UInt32) * builder.vertexCount);
+    memset(builder.meshletVertices, AVD_MESHLET_NO_VERTEX, builder.vertexCount);
+    memset(builder.emitted, 0, builder.triangleCount);
+
+    for (AVD_Size i = 0; i < builder.vertexCount; i++) {
+        builder.positions[i] = PRIV_avdMeshletVertexPosition(&vertices[firstVertex + i]);
+    }
+    for (AVD_Size i = 0; i < indexCount; i++) {
+        localIndices[i] = indices[i] - firstVertex;
+        builder.liveTriangles[localIndices[i]]++;
+    }
+    for (AVD_Size triangle = 0; triangle < builder.triangleCount; triangle++) {
+        AVD_Vector3 a               = builder.positions[localIndices[triangle * 3 + 0]];
+        AVD_Vector3 b               = builder.positions[localIndices[triangle * 3 + 1]];
+        AVD_Vector3 c               = builder.positions[localIndices[triangle * 3 + 2]];
+        AVD_Vector3 normal          = avdVec3Cross(avdVec3Subtract(b, a), avdVec3Subtract(c, a));
+        builder.normals[triangle]   = avdVec3Scale(normal, avdVec3InvLength(normal));
+        builder.centroids[triangle] = avdVec3Scale(avdVec3Add(avdVec3Add(a, b), c), 1.0f / 3.0f);
+    }
+
+    // the same offsets construction as the vertex cache optimizer, filled back
+    // to front so every offset ends up at the start of its list
+    AVD_UInt32 adjacencyEnd = 0;
+    for (AVD_Size vertex = 0; vertex < builder.vertexCount; vertex++) {
+        adjacencyEnd += builder.liveTriangles[vertex];
+        builder.adjacencyOffsets[vertex] = adjacencyEnd;
+    }
+    builder.adjacencyOffsets[builder.vertexCount] = adjacencyEnd;
+    for (AVD_Size i = indexCount; i-- > 0;) {
+        builder.adjacency[--builder.adjacencyOffsets[localIndices[i]]] = (AVD_UInt32)(i / 3);
+    }
+
+    AVD_MeshletBuilderMeshlet meshlet = {0};
+    for (AVD_Size emittedCount = 0; emittedCount < builder.triangleCount; emittedCount++) {
+        bool blocked        = false;
+        AVD_UInt32 triangle = PRIV_avdMeshletNextTriangle(&builder, &meshlet, &blocked);
+        if (triangle == AVD_MESHLET_NO_TRIANGLE && blocked) {
+            PRIV_avdMeshletFlush(&builder, &meshlet, resources, firstVertex);
+        }
+        if (triangle == AVD_MESHLET_NO_TRIANGLE) {
+            triangle = PRIV_avdMeshletSeedTriangle(&builder, &meshlet);
+        }
+        // a jump to a part that is not connected to the open meshlet
+        if (meshlet.vertexCount + PRIV_avdMeshletNewVertices(&builder, triangle) > AVD_MESHLET_MAX_VERTICES) {
+            PRIV_avdMeshletFlush(&builder, &meshlet, resources, firstVertex);
+        }
+
+        PRIV_avdMeshletEmit(&builder, &meshlet, triangle);
+        if (meshlet.triangleCount == AVD_MESHLET_MAX_TRIANGLES) {
+            PRIV_avdMeshletFlush(&builder, &meshlet, resources, firstVertex);
+        }
+    }
+    PRIV_avdMeshletFlush(&builder, &meshlet, resources, firstVertex);
+
+    mesh->meshletCount = (AVD_Int32)resources->meshletsList.count - mesh->meshletOffset;
+    AVD_FREE(storage);
+    return true;
+}
+
+void avdMeshletStatsAdd(AVD_MeshletStats *total, const AVD_Mesh *mesh, const AVD_ModelResources *resources)
+{
+    AVD_ASSERT(total != NULL);
+    AVD_ASSERT(mesh != NULL);
+    AVD_ASSERT(resources != NULL);
+
+    for (AVD_Int32 i = 0; i < mesh->meshletCount; i++) {
+        const AVD_Meshlet *meshlet = (const AVD_Meshlet *)avdListGet(&resources->meshletsList, (AVD_Size)(mesh->meshletOffset + i));
+        total->meshletCount++;
+        total->triangleCount += meshlet->triangleCount;
+        total->vertexCount += meshlet->vertexCount;
+        total->coneCount += meshlet->coneCutoff < 1.0f ? 1 : 0;
+    }
+}
+
+bool avdMeshletConeCulled(const AVD_Meshlet *meshlet, AVD_Vector3 cameraPosition)
+{
+    AVD_ASSERT(meshlet != NULL);
+
+    AVD_Vector3 center = avdVec3(meshlet->center[0], meshlet->center[1], meshlet->center[2]);
+    AVD_Vector3 axis   = avdVec3(meshlet->coneAxis[0], meshlet->coneAxis[1], meshlet->coneAxis[2]);
+    AVD_Vector3 offset = avdVec3Subtract(center, cameraPosition);
+    return avdVec3Dot(offset, axis) >= meshlet->coneCutoff * avdVec3Length(offset) + meshlet->radius;
+}
@@ -0,0 +1,299 @@
+#include "core/avd_core.h"
+#include "model/avd_model_meshlets.h"
+
+// Camera positions for the cone checks, in units of the test mesh radius.
+static const AVD_Float PRIV_avdModelMeshletsTestCameras[][3] = {
+    {0.0f, 0.0f, 10.0f},
+    {0.0f, 3.0f, 0.0f},
+    {-2.0f, -1.5f, 1.0f},
+    {40.0f, 20.0f, -30.0f},
+    {0.0f, 0.0f, 0.0f},
+};
+
+static void PRIV_avdModelMeshletsTestPushVertex(AVD_ModelResources *resources, AVD_Vector3 position)
+{
+    AVD_ModelVertex vertex             = {0};
+    AVD_ModelVertexPacked packedVertex = {0};
+    avdModelVertexInit(&vertex);
+    vertex.position = position;
+    avdModelVertexPack(&vertex, &packedVertex);
+    avdListPushBack(&resources->verticesList, &packedVertex);
+}
+
+static void PRIV_avdModelMeshletsTestPushTriangle(AVD_ModelResources *resources, AVD_UInt32 a, AVD_UInt32 b, AVD_UInt32 c)
+{
+    avdListPushBack(&resources->indicesList, &a);
+    avdListPushBack(&resources->indicesList, &b);
+    avdListPushBack(&resources->indicesList, &c);
+}
+
+// Lat-long sphere with outward facing triangles, the pole rows are degenerate.
+static void PRIV_avdModelMeshletsTestAddSphere(AVD_ModelResources *resources, AVD_Mesh *mesh, AVD_UInt32 rings, AVD_UInt32 segments)
+{
+    avdMeshInitWithNameId(mesh, "MeshletsTestSphere", 0);
+    mesh->indexOffset = (AVD_Int32)resources->indicesList.count;
+
+    AVD_UInt32 firstVertex = (AVD_UInt32)resources->verticesList.count;
+    for (AVD_UInt32 ring = 0; ring <= rings; ring++) {
+        AVD_Float theta = AVD_PI * (AVD_Float)ring / (AVD_Float)rings;
+        for (AVD_UInt32 segment = 0; segment <= segments; segment++) {
+            AVD_Float phi = 2.0f * AVD_PI * (AVD_Float)segment / (AVD_Float)segments;
+            PRIV_avdModelMeshletsTestPushVertex(resources, avdVec3(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi)));
+        }
+    }
+    for (AVD_UInt32 ring = 0; ring < rings; ring++) {
+        for (AVD_UInt32 segment = 0; segment < segments; segment++) {
+            AVD_UInt32 a = firstVertex + ring * (segments + 1) + segment;
+            AVD_UInt32 b = a + segments + 1;
+            PRIV_avdModelMeshletsTestPushTriangle(resources, a, a + 1, b);
+            PRIV_avdModelMeshletsTestPushTriangle(resources, a + 1, b + 1, b);
+        }
+    }
+    mesh->triangleCount = (AVD_Int32)(rings * segments * 2);
+}
+
+// Cubes with a separate quad per face like most exported models with hard
+// edges, so no face shares a vertex with any other.
+static void PRIV_avdModelMeshletsTestAddCubes(AVD_ModelResources *resources, AVD_Mesh *mesh, AVD_UInt32 cubeCount)
+{
+    avdMeshInitWithNameId(mesh, "MeshletsTestCubes", 1);
+    mesh->indexOffset = (AVD_Int32)resources->indicesList.count;
+
+    for (AVD_UInt32 cube = 0; cube < cubeCount; cube++) {
+        AVD_Vector3 center = avdVec3(0.3f * (AVD_Float)cube, 0.0f, 0.0f);
+        for (AVD_UInt32 face = 0; face < 6; face++) {
+            AVD_UInt32 axis     = face / 2;
+            AVD_Float side      = (face % 2) ? -0.1f : 0.1f;
+            AVD_UInt32 first    = (AVD_UInt32)resources->verticesList.count;
+            AVD_Float corners[] = {-0.1f, -0.1f, 0.1f, -0.1f, 0.1f, 0.1f, -0.1f, 0.1f};
+            for (AVD_UInt32 i = 0; i < 4; i++) {
+                AVD_Vector3 offset       = avdVec3Zero();
+                offset.v[axis]           = side;
+                offset.v[(axis + 1) % 3] = corners[i * 2 + 0] * (side > 0.0f ? 1.0f : -1.0f);
+                offset.v[(axis + 2) % 3] = corners[i * 2 + 1];
+                PRIV_avdModelMeshletsTestPushVertex(resources, avdVec3Add(center, offset));
+            }
+            PRIV_avdModelMeshletsTestPushTriangle(resources, first, first + 1, first + 2);
+            PRIV_avdModelMeshletsTestPushTriangle(resources, first, first + 2, first + 3);
+        }
+    }
+    mesh->triangleCount = (AVD_Int32)(cubeCount * 12);
+}
+
+static AVD_Vector3 PRIV_avdModelMeshletsTestPosition(const AVD_ModelResources *resources, AVD_UInt32 vertex)
+{
+    AVD_ModelVertex unpacked = {0};
+    avdModelVertexUnpack((const AVD_ModelVertexPacked *)avdListGet(&resources->verticesList, vertex), &unpacked);
+    return unpacked.position;
+}
+
+static int PRIV_avdModelMeshletsCompareTriangles(const void *a, const void *b)
+{
+    return memcmp(a, b, sizeof(AVD_UInt32) * 3);
+}
+
+// Every triangle of the mesh is in exactly one meshlet with its winding, no
+// meshlet is over the limits and the bounds hold what they should.
+static bool PRIV_avdModelMeshletsTestValidate(const AVD_ModelResources *resources, const AVD_Mesh *mesh)
+{
+    AVD_Size indexCount  = (AVD_Size)mesh->triangleCount * 3;
+    AVD_UInt32 *expected = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * indexCount);
+    AVD_UInt32 *actual   = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * indexCount);
+    bool ok              = expected != NULL && actual != NULL;
+    if (ok) {
+        memcpy(expected, (const AVD_UInt32 *)resources->indicesList.items + mesh->indexOffset, sizeof(AVD_UInt32) * indexCount);
+    }
+
+    AVD_Size actualCount = 0;
+    for (AVD_Int32 m = 0; ok && m < mesh->meshletCount; m++) {
+        const AVD_Meshlet *meshlet = (const AVD_Meshlet *)avdListGet(&resources->meshletsList, (AVD_Size)(mesh->meshletOffset + m));
+        const uint32_t *vertices   = (const uint32_t *)resources->meshletVerticesList.items + meshlet->vertexOffset;
+        const uint32_t *triangles  = (const uint32_t *)resources->meshletTrianglesList.items + meshlet->triangleOffset;
+        AVD_Vector3 center         = avdVec3(meshlet->center[0], meshlet->center[1], meshlet->center[2]);
+        ok                         = meshlet->vertexCount > 0 && meshlet->vertexCount <= AVD_MESHLET_MAX_VERTICES;
+        ok                         = ok && meshlet->triangleCount > 0 && meshlet->triangleCount <= AVD_MESHLET_MAX_TRIANGLES;
+        ok                         = ok && actualCount + meshlet->triangleCount * 3 <= indexCount;
+        for (AVD_UInt32 i = 0; ok && i < meshlet->vertexCount; i++) {
+            for (AVD_UInt32 j = 0; ok && j < i; j++) {
+                ok = vertices[i] != vertices[j];
+            }
+            AVD_Vector3 offset = avdVec3Subtract(PRIV_avdModelMeshletsTestPosition(resources, vertices[i]), center);
+            ok                 = ok && avdVec3Length(offset) <= meshlet->radius * 1.0001f + 1e-6f;
+        }
+        for (AVD_UInt32 i = 0; ok && i < meshlet->triangleCount; i++) {
+            for (AVD_UInt32 corner = 0; ok && corner < 3; corner++) {
+                AVD_UInt32 local = avdMeshletTriangleCorner(triangles[i], corner);
+                ok               = local < meshlet->vertexCount;
+                if (ok) {
+                    actual[actualCount++] = vertices[local];
+                }
+            }
+        }
+    }
+    ok = ok && actualCount == indexCount;
+    if (ok) {
+        qsort(expected, (AVD_Size)mesh->triangleCount, sizeof(AVD_UInt32) * 3, PRIV_avdModelMeshletsCompareTriangles);
+        qsort(actual, (AVD_Size)mesh->triangleCount, sizeof(AVD_UInt32) * 3, PRIV_avdModelMeshletsCompareTriangles);
+        ok = memcmp(expected, actual, sizeof(AVD_UInt32) * indexCount) == 0;
+    }
+
+    if (expected != NULL) {
+        AVD_FREE(expected);
+    }
+    if (actual != NULL) {
+        AVD_FREE(actual);
+    }
+    AVD_CHECK_MSG(ok, "Meshlets of mesh '%s' do not match its triangles", mesh->name);
+    return true;
+}
+
+// Cone culling must never drop a meshlet with a triangle facing the camera.
+// Returns how many of the meshlets were culled from the camera.
+static bool PRIV_avdModelMeshletsTestCones(const AVD_ModelResources *resources, const AVD_Mesh *mesh, AVD_Vector3 camera, AVD_Size *outCulled)
+{
+    *outCulled = 0;
+    for (AVD_Int32 m = 0; m < mesh->meshletCount; m++) {
+        const AVD_Meshlet *meshlet = (const AVD_Meshlet *)avdListGet(&resources->meshletsList, (AVD_Size)(mesh->meshletOffset + m));
+        if (!avdMeshletConeCulled(meshlet, camera)) {
+            continue;
+        }
+        *outCulled += 1;
+
+        const uint32_t *vertices  = (const uint32_t *)resources->meshletVerticesList.items + meshlet->vertexOffset;
+        const uint32_t *triangles = (const uint32_t *)resources->meshletTrianglesList.items + meshlet->triangleOffset;
+        for (AVD_UInt32 i = 0; i < meshlet->triangleCount; i++) {
+            AVD_Vector3 a      = PRIV_avdModelMeshletsTestPosition(resources, vertices[avdMeshletTriangleCorner(triangles[i], 0)]);
+            AVD_Vector3 b      = PRIV_avdModelMeshletsTestPosition(resources, vertices[avdMeshletTriangleCorner(triangles[i], 1)]);
+            AVD_Vector3 c      = PRIV_avdModelMeshletsTestPosition(resources, vertices[avdMeshletTriangleCorner(triangles[i], 2)]);
+            AVD_Vector3 normal = avdVec3Cross(avdVec3Subtract(b, a), avdVec3Subtract(c, a));
+            AVD_Float facing   = avdVec3Dot(avdVec3Scale(normal, avdVec3InvLength(normal)), avdVec3Subtract(camera, a));
+            AVD_CHECK_MSG(facing <= 1e-4f, "Meshlet %d of mesh '%s' was culled with a triangle facing the camera", m, mesh->name);
+        }
+    }
+    return true;
+}
+
+static bool PRIV_avdModelMeshletsTestSphere(void)
+{
+    AVD_ModelResources resources = {0};
+    AVD_CHECK(avdModelResourcesCreate(&resources));
+
+    // a vertex in front so that the mesh does not start at zero
+    PRIV_avdModelMeshletsTestPushVertex(&resources, avdVec3(7.0f, 7.0f, 7.0f));
+    AVD_Mesh mesh = {0};
+    PRIV_avdModelMeshletsTestAddSphere(&resources, &mesh, 64, 128);
+
+    bool ok                = avdMeshBuildMeshlets(&mesh, &resources);
+    ok                     = ok && PRIV_avdModelMeshletsTestValidate(&resources, &mesh);
+    AVD_MeshletStats stats = {0};
+    avdMeshletStatsAdd(&stats, &mesh, &resources);
+
+    AVD_Size farCulled = 0;
+    for (AVD_Size i = 0; ok && i < AVD_ARRAY_COUNT(PRIV_avdModelMeshletsTestCameras); i++) {
+        const AVD_Float *camera = PRIV_avdModelMeshletsTestCameras[i];
+        AVD_Size culled         = 0;
+        ok                      = PRIV_avdModelMeshletsTestCones(&resources, &mesh, avdVec3(camera[0], camera[1], camera[2]), &culled);
+        farCulled               = i == 0 ? culled : farCulled;
+    }
+    avdModelResourcesDestroy(&resources);
+    AVD_CHECK(ok);
+
+    AVD_Float trianglesPerMeshlet = (AVD_Float)stats.triangleCount / (AVD_Float)stats.meshletCount;
+    AVD_LOG_DEBUG(
+        "    sphere: %zu meshlets, %.1f triangles and %.1f vertices each, %zu with cones, %zu culled from the front",
+        stats.meshletCount,
+        trianglesPerMeshlet,
+        (AVD_Float)stats.vertexCount / (AVD_Float)stats.meshletCount,
+        stats.coneCount,
+        farCulled);
+
+    // a regular grid can get about 100 triangles into 64 vertices
+    AVD_CHECK_MSG(trianglesPerMeshlet > 80.0f, "Meshlets are only %.1f triangles on average", trianglesPerMeshlet);
+    // from far away about half of a sphere faces away, a good part of that has to be culled
+    AVD_CHECK_MSG(farCulled * 4 > stats.meshletCount, "Only %zu of %zu meshlets culled from the front", farCulled, stats.meshletCount);
+    return true;
+}
+
+static bool PRIV_avdModelMeshletsTestCubes(void)
+{
+    AVD_ModelResources resources = {0};
+    AVD_CHECK(avdModelResourcesCreate(&resources));
+
+    AVD_Mesh mesh = {0};
+    PRIV_avdModelMeshletsTestAddCubes(&resources, &mesh, 10);
+
+    bool ok         = avdMeshBuildMeshlets(&mesh, &resources);
+    ok              = ok && PRIV_avdModelMeshletsTestValidate(&resources, &mesh);
+    AVD_Size culled = 0;
+    ok              = ok && PRIV_avdModelMeshletsTestCones(&resources, &mesh, avdVec3(0.0f, 0.0f, 10.0f), &culled);
+    AVD_Int32 count = mesh.meshletCount;
+    avdModelResourcesDestroy(&resources);
+    AVD_CHECK(ok);
+
+    // 60 faces of 4 vertices fill 64 vertex meshlets 16 faces at a time
+    AVD_CHECK_MSG(count == 4, "Disconnected faces were split into %d meshlets instead of 4", count);
+    return true;
+}
+
+static bool PRIV_avdModelMeshletsTestEmpty(void)
+{
+    AVD_ModelResources resources = {0};
+    AVD_CHECK(avdModelResourcesCreate(&resources));
+
+    AVD_Mesh mesh = {0};
+    avdMeshInitWithNameId(&mesh, "MeshletsTestEmpty", 2);
+    bool ok = avdMeshBuildMeshlets(&mesh, &resources);
+    ok      = ok && mesh.meshletCount == 0 && resources.meshletsList.count == 0;
+    avdModelResourcesDestroy(&resources);
+
+    AVD_CHECK_MSG(ok, "An empty mesh got meshlets");
+    return true;
+}
+
+bool avdModelMeshletsTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Model Meshlets Tests...");
+
+    AVD_CHECK(PRIV_avdModelMeshletsTestSphere());
+    AVD_CHECK(PRIV_avdModelMeshletsTestCubes());
+    AVD_CHECK(PRIV_avdModelMeshletsTestEmpty());
+
+    AVD_LOG_DEBUG("All AVD Model Meshlets Tests PASSED");
+    return true;
+}
+
+typedef struct {
+    AVD_ModelResources resources;
+    AVD_Mesh mesh;
+} AVD_ModelMeshletsBenchmark;
+
+static void PRIV_avdModelMeshletsBenchmarkBuild(void *userData)
+{
+    AVD_ModelMeshletsBenchmark *benchmark = (AVD_ModelMeshletsBenchmark *)userData;
+    avdListClear(&benchmark->resources.meshletsList);
+    avdListClear(&benchmark->resources.meshletVerticesList);
+    avdListClear(&benchmark->resources.meshletTrianglesList);
+    avdMeshBuildMeshlets(&benchmark->mesh, &benchmark->resources);
+}
+
+bool avdModelMeshletsBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD Model Meshlets benchmarks...");
+
+    AVD_ModelMeshletsBenchmark benchmark = {0};
+    AVD_CHECK(avdModelResourcesCreate(&benchmark.resources));
+    PRIV_avdModelMeshletsTestAddSphere(&benchmark.resources, &benchmark.mesh, 256, 512);
+
+    AVD_BenchCase buildCase = {
+        .name               = "meshlets/build_sphere_256k",
+        .unit               = "triangles",
+        .itemsPerRepetition = (AVD_Size)benchmark.mesh.triangleCount,
+        .run                = PRIV_avdModelMeshletsBenchmarkBuild,
+        .userData           = &benchmark,
+    };
+    bool ok = avdBenchRun(bench, &buildCase);
+
+    avdModelResourcesDestroy(&benchmark.resources);
+    return ok;
+}
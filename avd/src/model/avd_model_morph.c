@@ -0,0 +1,291 @@
+#include "model/avd_model_morph.h"
+
+// Components summed per vertex, position xyz then normal xyz.
+#define AVD_MORPH_ACCUMULATORS 6
+
+#define AVD_MORPH_QUANTIZED_MAX 32767.0f
+
+AVD_UInt32 avdMorphDeltaWords(AVD_MorphDeltaEncoding encoding)
+{
+    return encoding == AVD_MORPH_DELTA_ENCODING_QUANTIZED ? (AVD_UInt32)(sizeof(AVD_MorphDeltaQuantized) / sizeof(uint32_t)) : (AVD_UInt32)(sizeof(AVD_MorphDelta) / sizeof(uint32_t));
+}
+
+static bool PRIV_avdMorphDeltaMoves(const AVD_Float *position, const AVD_Float *normal)
+{
+    for (AVD_Size i = 0; i < 3; i++) {
+        if (fabsf(position[i]) > AVD_MORPH_DELTA_EPSILON || (normal != NULL && fabsf(normal[i]) > AVD_MORPH_DELTA_EPSILON)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int16_t PRIV_avdMorphQuantize(AVD_Float value, AVD_Float step)
+{
+    AVD_Float steps = floorf(value / step + 0.5f);
+    return (int16_t)AVD_CLAMP(steps, -AVD_MORPH_QUANTIZED_MAX, AVD_MORPH_QUANTIZED_MAX);
+}
+
+bool avdMorphTargetBuild(
+    AVD_List *targets,
+    AVD_List *deltas,
+    const AVD_Float *positionDeltas,
+    const AVD_Float *normalDeltas,
+    AVD_Size vertexCount,
+    AVD_MorphDeltaEncoding encoding)
+{
+    AVD_ASSERT(targets != NULL);
+    AVD_ASSERT(deltas != NULL);
+    AVD_ASSERT(positionDeltas != NULL || vertexCount == 0);
+    AVD_CHECK_MSG(vertexCount <= UINT32_MAX, "Morph target has too many vertices (%zu)", vertexCount);
+
+    AVD_Size deltaCount   = 0;
+    AVD_Float maxPosition = 0.0f;
+    for (AVD_Size vertex = 0; vertex < vertexCount; vertex++) {
+        const AVD_Float *position = positionDeltas + vertex * 3;
+        if (!PRIV_avdMorphDeltaMoves(position, normalDeltas != NULL ? normalDeltas + vertex * 3 : NULL)) {
+            continue;
+        }
+        deltaCount++;
+        maxPosition = AVD_MAX(maxPosition, AVD_MAX(fabsf(position[0]), AVD_MAX(fabsf(position[1]), fabsf(position[2]))));
+    }
+
+    AVD_UInt32 words             = avdMorphDeltaWords(encoding);
+    AVD_MorphTargetDeltas target = {
+        .deltaOffset   = (uint32_t)deltas->count,
+        .deltaCount    = (uint32_t)deltaCount,
+        .encoding      = (uint32_t)encoding,
+        .positionScale = maxPosition > 0.0f ? maxPosition / AVD_MORPH_QUANTIZED_MAX : 1.0f,
+    };
+    AVD_UInt32 *out = (AVD_UInt32 *)avdListAddEmptyN(deltas, deltaCount * words);
+    AVD_CHECK_MSG(out != NULL || deltaCount == 0, "Failed to allocate %zu morph deltas", deltaCount);
+    AVD_CHECK(avdListPushBack(targets, &target) != NULL);
+
+    static const AVD_Float zero[3] = {0.0f, 0.0f, 0.0f};
+    for (AVD_Size vertex = 0; vertex < vertexCount; vertex++) {
+        const AVD_Float *position = positionDeltas + vertex * 3;
+        const AVD_Float *normal   = normalDeltas != NULL ? normalDeltas + vertex * 3 : zero;
+        if (!PRIV_avdMorphDeltaMoves(position, normal)) {
+            continue;
+        }
+
+        if (encoding == AVD_MORPH_DELTA_ENCODING_QUANTIZED) {
+            AVD_MorphDeltaQuantized delta = {.vertex = (uint32_t)vertex};
+            for (AVD_Size i = 0; i < 3; i++) {
+                delta.position[i] = PRIV_avdMorphQuantize(position[i], target.positionScale);
+                delta.normal[i]   = PRIV_avdMorphQuantize(normal[i], AVD_MORPH_NORMAL_SCALE);
+            }
+            memcpy(out, &delta, sizeof(delta));
+        } else {
+            AVD_MorphDelta delta = {.vertex = (uint32_t)vertex};
+            memcpy(delta.position, position, sizeof(delta.position));
+            memcpy(delta.normal, normal, sizeof(delta.normal));
+            memcpy(out, &delta, sizeof(delta));
+        }
+        out += words;
+    }
+    return true;
+}
+
+void avdMorphTargetsRemap(const AVD_List *targets, AVD_List *deltas, const AVD_UInt32 *remap)
+{
+    AVD_ASSERT(targets != NULL);
+    AVD_ASSERT(deltas != NULL);
+    AVD_ASSERT(remap != NULL);
+
+    // the vertex is the first word of both encodings
+    AVD_UInt32 *words = (AVD_UInt32 *)deltas->items;
+    for (AVD_Size i = 0; i < targets->count; i++) {
+        const AVD_MorphTargetDeltas *target = (const AVD_MorphTargetDeltas *)avdListGet(targets, i);
+        AVD_UInt32 stride                   = avdMorphDeltaWords((AVD_MorphDeltaEncoding)target->encoding);
+        AVD_UInt32 *delta                   = words + target->deltaOffset;
+        for (AVD_UInt32 j = 0; j < target->deltaCount; j++, delta += stride) {
+            delta[0] = remap[delta[0]];
+        }
+    }
+}
+
+bool avdMeshAddMorphTargets(
+    AVD_Mesh *mesh,
+    AVD_ModelResources *resources,
+    AVD_UInt32 firstVertex,
+    AVD_UInt32 vertexCount,
+    const AVD_List *targets,
+    const AVD_List *deltas)
+{
+    AVD_ASSERT(mesh != NULL);
+    AVD_ASSERT(resources != NULL);
+    AVD_ASSERT(targets != NULL);
+    AVD_ASSERT(deltas != NULL);
+
+    AVD_CHECK_MSG((AVD_Size)firstVertex + vertexCount <= resources->verticesList.count, "Mesh '%s' morph vertex range is past the end of the vertex list", mesh->name);
+    const AVD_UInt32 *words = (const AVD_UInt32 *)deltas->items;
+    for (AVD_Size i = 0; i < targets->count; i++) {
+        const AVD_MorphTargetDeltas *target = (const AVD_MorphTargetDeltas *)avdListGet(targets, i);
+        AVD_UInt32 stride                   = avdMorphDeltaWords((AVD_MorphDeltaEncoding)target->encoding);
+        AVD_CHECK_MSG((AVD_Size)target->deltaOffset + (AVD_Size)target->deltaCount * stride <= deltas->count, "Mesh '%s' morph target %zu is out of bounds", mesh->name, i);
+        for (AVD_UInt32 j = 0; j < target->deltaCount; j++) {
+            AVD_CHECK_MSG(words[target->deltaOffset + j * stride] < vertexCount, "Mesh '%s' morph target %zu moves a vertex outside of its range", mesh->name, i);
+        }
+    }
+
+    AVD_Size deltaBase = resources->morphDeltasList.count;
+    AVD_UInt32 *out    = (AVD_UInt32 *)avdListAddEmptyN(&resources->morphDeltasList, deltas->count);
+    AVD_CHECK_MSG(out != NULL || deltas->count == 0, "Failed to allocate the morph deltas of mesh '%s'", mesh->name);
+    if (deltas->count > 0) {
+        memcpy(out, deltas->items, sizeof(AVD_UInt32) * deltas->count);
+    }
+
+    mesh->morphTargetOffset = (AVD_Int32)resources->morphTargetsList.count;
+    mesh->morphTargetCount  = (AVD_Int32)targets->count;
+    mesh->morphVertexOffset = (AVD_Int32)firstVertex;
+    mesh->morphVertexCount  = (AVD_Int32)vertexCount;
+    for (AVD_Size i = 0; i < targets->count; i++) {
+        AVD_MorphTargetDeltas target = *(const AVD_MorphTargetDeltas *)avdListGet(targets, i);
+        target.deltaOffset += (uint32_t)deltaBase;
+        AVD_CHECK(avdListPushBack(&resources->morphTargetsList, &target) != NULL);
+    }
+    return true;
+}
+
+static void PRIV_avdMorphDeltaDecode(const AVD_MorphTargetDeltas *target, const AVD_UInt32 *words, AVD_MorphDelta *outDelta)
+{
+    if (target->encoding == AVD_MORPH_DELTA_ENCODING_QUANTIZED) {
+        AVD_MorphDeltaQuantized delta = {0};
+        memcpy(&delta, words, sizeof(delta));
+        outDelta->vertex = delta.vertex;
+        for (AVD_Size i = 0; i < 3; i++) {
+            outDelta->position[i] = (AVD_Float)delta.position[i] * target->positionScale;
+            outDelta->normal[i]   = (AVD_Float)delta.normal[i] * AVD_MORPH_NORMAL_SCALE;
+        }
+    } else {
+        memcpy(outDelta, words, sizeof(AVD_MorphDelta));
+    }
+}
+
+void avdMorphTargetGetDelta(const AVD_ModelResources *resources, const AVD_MorphTargetDeltas *target, AVD_Size index, AVD_MorphDelta *outDelta)
+{
+    AVD_ASSERT(resources != NULL);
+    AVD_ASSERT(target != NULL);
+    AVD_ASSERT(index < target->deltaCount);
+    AVD_ASSERT(outDelta != NULL);
+
+    AVD_UInt32 stride       = avdMorphDeltaWords((AVD_MorphDeltaEncoding)target->encoding);
+    const AVD_UInt32 *words = (const AVD_UInt32 *)resources->morphDeltasList.items + target->deltaOffset + index * stride;
+    PRIV_avdMorphDeltaDecode(target, words, outDelta);
+}
+
+AVD_Size avdMeshMorphTargetsSize(const AVD_Mesh *mesh, const AVD_ModelResources *resources)
+{
+    AVD_ASSERT(mesh != NULL);
+    AVD_ASSERT(resources != NULL);
+
+    AVD_Size size = 0;
+    for (AVD_Int32 i = 0; i < mesh->morphTargetCount; i++) {
+        const AVD_MorphTargetDeltas *target = (const AVD_MorphTargetDeltas *)avdListGet(&resources->morphTargetsList, (AVD_Size)(mesh->morphTargetOffset + i));
+        size += sizeof(AVD_MorphTargetDeltas) + sizeof(AVD_UInt32) * target->deltaCount * avdMorphDeltaWords((AVD_MorphDeltaEncoding)target->encoding);
+    }
+    return size;
+}
+
+// Same rounding as the shader, floor(x + 0.5), clamped so that the sum of a
+// few targets does not overflow.
+static AVD_Int32 PRIV_avdMorphToFixed(AVD_Float weight, AVD_Float value)
+{
+    AVD_Float fixed = floorf(weight * value * AVD_MORPH_FIXED_POINT_SCALE + 0.5f);
+    return (AVD_Int32)AVD_CLAMP(fixed, -1073741824.0f, 1073741824.0f);
+}
+
+static void PRIV_avdMorphAccumulate(AVD_Int32 *accumulators, const AVD_MorphDelta *delta, AVD_Float weight)
+{
+    AVD_Int32 *sums = accumulators + (AVD_Size)delta->vertex * AVD_MORPH_ACCUMULATORS;
+    sums[0] += PRIV_avdMorphToFixed(weight, delta->position[0]);
+    sums[1] += PRIV_avdMorphToFixed(weight, delta->position[1]);
+    sums[2] += PRIV_avdMorphToFixed(weight, delta->position[2]);
+    sums[3] += PRIV_avdMorphToFixed(weight, delta->normal[0]);
+    sums[4] += PRIV_avdMorphToFixed(weight, delta->normal[1]);
+    sums[5] += PRIV_avdMorphToFixed(weight, delta->normal[2]);
+}
+
+static AVD_UInt32 PRIV_avdMorphPackNormal(AVD_Float x, AVD_Float y, AVD_Float z)
+{
+    return (AVD_UInt32)(avdQuantizeSnorm(x, 10) + 511) |
+           (AVD_UInt32)(avdQuantizeSnorm(y, 10) + 511) << 10 |
+           (AVD_UInt32)(avdQuantizeSnorm(z, 10) + 511) << 20;
+}
+
+static AVD_ModelVertexPacked PRIV_avdMorphResolve(const AVD_ModelVertexPacked *base, const AVD_Int32 *sums)
+{
+    // vertices none of the active targets moved are copied, a round trip
+    // through the normalization could change their normal
+    if ((sums[0] | sums[1] | sums[2] | sums[3] | sums[4] | sums[5]) == 0) {
+        return *base;
+    }
+
+    const AVD_Float unit = 1.0f / AVD_MORPH_FIXED_POINT_SCALE;
+    AVD_Float nx         = ((AVD_Int32)(base->np & 1023) - 511) / 511.0f + (AVD_Float)sums[3] * unit;
+    AVD_Float ny         = ((AVD_Int32)((base->np >> 10) & 1023) - 511) / 511.0f + (AVD_Float)sums[4] * unit;
+    AVD_Float nz         = ((AVD_Int32)((base->np >> 20) & 1023) - 511) / 511.0f + (AVD_Float)sums[5] * unit;
+    AVD_Float length     = sqrtf(nx * nx + ny * ny + nz * nz);
+    if (length > 1e-8f) {
+        nx /= length;
+        ny /= length;
+        nz /= length;
+    }
+
+    AVD_ModelVertexPacked vertex = *base;
+    vertex.vx                    = avdQuantizeHalf(avdDequantizeHalf(base->vx) + (AVD_Float)sums[0] * unit);
+    vertex.vy                    = avdQuantizeHalf(avdDequantizeHalf(base->vy) + (AVD_Float)sums[1] * unit);
+    vertex.vz                    = avdQuantizeHalf(avdDequantizeHalf(base->vz) + (AVD_Float)sums[2] * unit);
+    vertex.np                    = PRIV_avdMorphPackNormal(nx, ny, nz) | (base->np & (3u << 30));
+    return vertex;
+}
+
+bool avdMeshBlendMorphTargets(
+    const AVD_Mesh *mesh,
+    const AVD_ModelResources *resources,
+    const AVD_Float *weights,
+    AVD_List *accumulators,
+    AVD_ModelVertexPacked *outVertices)
+{
+    AVD_ASSERT(mesh != NULL);
+    AVD_ASSERT(resources != NULL);
+    AVD_ASSERT(weights != NULL || mesh->morphTargetCount == 0);
+    AVD_ASSERT(accumulators != NULL && accumulators->itemSize == sizeof(AVD_Int32));
+    AVD_ASSERT(outVertices != NULL || mesh->morphVertexCount == 0);
+
+    AVD_Size vertexCount = (AVD_Size)AVD_MAX(mesh->morphVertexCount, 0);
+    AVD_CHECK_MSG(mesh->morphVertexOffset >= 0 && (AVD_Size)mesh->morphVertexOffset + vertexCount <= resources->verticesList.count, "Mesh '%s' morph vertex range is out of bounds", mesh->name);
+    AVD_CHECK_MSG(
+        mesh->morphTargetOffset >= 0 && mesh->morphTargetCount >= 0 && (AVD_Size)mesh->morphTargetOffset + (AVD_Size)mesh->morphTargetCount <= resources->morphTargetsList.count,
+        "Mesh '%s' morph targets are out of bounds",
+        mesh->name);
+
+    avdListResize(accumulators, 0);
+    avdListResize(accumulators, vertexCount * AVD_MORPH_ACCUMULATORS);
+    AVD_Int32 *sums = (AVD_Int32 *)accumulators->items;
+
+    const AVD_UInt32 *words = (const AVD_UInt32 *)resources->morphDeltasList.items;
+    for (AVD_Int32 i = 0; i < mesh->morphTargetCount; i++) {
+        AVD_Float weight = weights[i];
+        if (fabsf(weight) < AVD_MORPH_MIN_WEIGHT) {
+            continue;
+        }
+
+        const AVD_MorphTargetDeltas *target = (const AVD_MorphTargetDeltas *)avdListGet(&resources->morphTargetsList, (AVD_Size)(mesh->morphTargetOffset + i));
+        AVD_UInt32 stride                   = avdMorphDeltaWords((AVD_MorphDeltaEncoding)target->encoding);
+        const AVD_UInt32 *delta             = words + target->deltaOffset;
+        for (AVD_UInt32 j = 0; j < target->deltaCount; j++, delta += stride) {
+            AVD_MorphDelta decoded = {0};
+            PRIV_avdMorphDeltaDecode(target, delta, &decoded);
+            AVD_ASSERT(decoded.vertex < vertexCount);
+            PRIV_avdMorphAccumulate(sums, &decoded, weight);
+        }
+    }
+
+    const AVD_ModelVertexPacked *base = (const AVD_ModelVertexPacked *)resources->verticesList.items + mesh->morphVertexOffset;
+    for (AVD_Size vertex = 0; vertex < vertexCount; vertex++) {
+        outVertices[vertex] = PRIV_avdMorphResolve(&base[vertex], sums + vertex * AVD_MORPH_ACCUMULATORS);
+    }
+    return true;
+}
@@ -0,0 +1,456 @@
+#include "core/avd_bench.h"
+#include "core/avd_core.h"
+#include "model/avd_model_morph.h"
+
+// A face sized grid with the targets of a typical face rig, every one of them
+// moves a small patch of the vertices.
+#define AVD_MORPH_BENCH_GRID_SIZE     160
+#define AVD_MORPH_BENCH_TARGET_COUNT  52
+#define AVD_MORPH_BENCH_ACTIVE_COUNT  12
+#define AVD_MORPH_BENCH_TARGET_RADIUS 0.12f
+
+// One mesh on a size x size grid in [-1, 1] facing +z, behind a vertex that
+// belongs to another mesh, with its dense target deltas kept for reference.
+typedef struct {
+    AVD_ModelResources resources;
+    AVD_Mesh mesh;
+    AVD_UInt32 size;
+    AVD_UInt32 vertexCount;
+    AVD_UInt32 targetCount;
+    AVD_Float *positionDeltas; // targetCount * vertexCount xyz
+    AVD_Float *normalDeltas;
+} AVD_ModelMorphTestMesh;
+
+static void PRIV_avdModelMorphTestPushVertex(AVD_ModelResources *resources, AVD_Vector3 position, AVD_Vector3 normal)
+{
+    AVD_ModelVertex vertex             = {0};
+    AVD_ModelVertexPacked packedVertex = {0};
+    avdModelVertexInit(&vertex);
+    vertex.position = position;
+    vertex.normal   = normal;
+    vertex.tangent  = avdVec4(1.0f, 0.0f, 0.0f, 1.0f);
+    avdModelVertexPack(&vertex, &packedVertex);
+    avdListPushBack(&resources->verticesList, &packedVertex);
+}
+
+static void PRIV_avdModelMorphTestMeshDestroy(AVD_ModelMorphTestMesh *mesh)
+{
+    if (mesh->positionDeltas != NULL) {
+        AVD_FREE(mesh->positionDeltas);
+    }
+    if (mesh->normalDeltas != NULL) {
+        AVD_FREE(mesh->normalDeltas);
+    }
+    avdModelResourcesDestroy(&mesh->resources);
+}
+
+// Target t pushes a round patch of the grid out along z and tilts its normals,
+// its center walks over the grid so that the patches overlap a little.
+static bool PRIV_avdModelMorphTestMeshCreate(AVD_ModelMorphTestMesh *mesh, AVD_UInt32 size, AVD_UInt32 targetCount, AVD_Float radius, AVD_MorphDeltaEncoding encoding)
+{
+    memset(mesh, 0, sizeof(AVD_ModelMorphTestMesh));
+    AVD_CHECK(avdModelResourcesCreate(&mesh->resources));
+    mesh->size           = size;
+    mesh->vertexCount    = size * size;
+    mesh->targetCount    = targetCount;
+    AVD_Size deltaCount  = (AVD_Size)mesh->vertexCount * targetCount * 3;
+    mesh->positionDeltas = (AVD_Float *)AVD_MALLOC(sizeof(AVD_Float) * AVD_MAX(deltaCount, (AVD_Size)1));
+    mesh->normalDeltas   = (AVD_Float *)AVD_MALLOC(sizeof(AVD_Float) * AVD_MAX(deltaCount, (AVD_Size)1));
+    if (mesh->positionDeltas == NULL || mesh->normalDeltas == NULL) {
+        PRIV_avdModelMorphTestMeshDestroy(mesh);
+        AVD_CHECK_MSG(false, "Failed to allocate the dense morph deltas");
+    }
+
+    PRIV_avdModelMorphTestPushVertex(&mesh->resources, avdVec3(7.0f, 7.0f, 7.0f), avdVec3(0.0f, 1.0f, 0.0f));
+    AVD_UInt32 firstVertex = (AVD_UInt32)mesh->resources.verticesList.count;
+    for (AVD_UInt32 y = 0; y < size; y++) {
+        for (AVD_UInt32 x = 0; x < size; x++) {
+            AVD_Float u = 2.0f * (AVD_Float)x / (AVD_Float)(size - 1) - 1.0f;
+            AVD_Float v = 2.0f * (AVD_Float)y / (AVD_Float)(size - 1) - 1.0f;
+            PRIV_avdModelMorphTestPushVertex(&mesh->resources, avdVec3(u, v, 0.0f), avdVec3(0.0f, 0.0f, 1.0f));
+        }
+    }
+
+    AVD_List targets = {0};
+    AVD_List deltas  = {0};
+    avdListCreate(&targets, sizeof(AVD_MorphTargetDeltas));
+    avdListCreate(&deltas, sizeof(AVD_UInt32));
+    bool ok = true;
+    for (AVD_UInt32 target = 0; ok && target < targetCount; target++) {
+        AVD_Float centerX         = sinf((AVD_Float)target * 2.39996f) * 0.7f;
+        AVD_Float centerY         = cosf((AVD_Float)target * 2.39996f) * 0.7f;
+        AVD_Float *positionDeltas = mesh->positionDeltas + (AVD_Size)target * mesh->vertexCount * 3;
+        AVD_Float *normalDeltas   = mesh->normalDeltas + (AVD_Size)target * mesh->vertexCount * 3;
+        for (AVD_UInt32 vertex = 0; vertex < mesh->vertexCount; vertex++) {
+            AVD_Float u                    = 2.0f * (AVD_Float)(vertex % size) / (AVD_Float)(size - 1) - 1.0f - centerX;
+            AVD_Float v                    = 2.0f * (AVD_Float)(vertex / size) / (AVD_Float)(size - 1) - 1.0f - centerY;
+            AVD_Float distance             = sqrtf(u * u + v * v) / radius;
+            AVD_Float falloff              = distance < 1.0f ? 0.5f + 0.5f * cosf(distance * AVD_PI) : 0.0f;
+            positionDeltas[vertex * 3 + 0] = 0.01f * falloff * (AVD_Float)(target % 3);
+            positionDeltas[vertex * 3 + 1] = 0.0f;
+            positionDeltas[vertex * 3 + 2] = 0.05f * falloff;
+            normalDeltas[vertex * 3 + 0]   = -0.3f * falloff * u / radius;
+            normalDeltas[vertex * 3 + 1]   = -0.3f * falloff * v / radius;
+            normalDeltas[vertex * 3 + 2]   = 0.0f;
+        }
+        ok = avdMorphTargetBuild(&targets, &deltas, positionDeltas, normalDeltas, mesh->vertexCount, encoding);
+    }
+
+    avdMeshInitWithNameId(&mesh->mesh, "MorphTestGrid", 0);
+    ok = ok && avdMeshAddMorphTargets(&mesh->mesh, &mesh->resources, firstVertex, mesh->vertexCount, &targets, &deltas);
+    avdListDestroy(&targets);
+    avdListDestroy(&deltas);
+    if (!ok) {
+        PRIV_avdModelMorphTestMeshDestroy(mesh);
+        AVD_CHECK_MSG(false, "Failed to build the morph targets of the test grid");
+    }
+    return true;
+}
+
+// Straight float blend of the dense deltas, what the sparse blends are held to.
+static void PRIV_avdModelMorphTestBlendDense(const AVD_ModelMorphTestMesh *mesh, const AVD_Float *weights, AVD_UInt32 vertex, AVD_Vector3 *outPosition, AVD_Vector3 *outNormal)
+{
+    const AVD_ModelVertexPacked *base = (const AVD_ModelVertexPacked *)mesh->resources.verticesList.items + mesh->mesh.morphVertexOffset + vertex;
+    AVD_ModelVertex unpacked          = {0};
+    avdModelVertexUnpack(base, &unpacked);
+    for (AVD_UInt32 target = 0; target < mesh->targetCount; target++) {
+        const AVD_Float *position = mesh->positionDeltas + ((AVD_Size)target * mesh->vertexCount + vertex) * 3;
+        const AVD_Float *normal   = mesh->normalDeltas + ((AVD_Size)target * mesh->vertexCount + vertex) * 3;
+        unpacked.position         = avdVec3Add(unpacked.position, avdVec3Scale(avdVec3(position[0], position[1], position[2]), weights[target]));
+        unpacked.normal           = avdVec3Add(unpacked.normal, avdVec3Scale(avdVec3(normal[0], normal[1], normal[2]), weights[target]));
+    }
+    *outPosition = unpacked.position;
+    *outNormal   = avdVec3Normalize(unpacked.normal);
+}
+
+static bool PRIV_avdModelMorphTestCompare(const AVD_ModelMorphTestMesh *mesh, const AVD_Float *weights, const AVD_ModelVertexPacked *blended, AVD_Float positionTolerance)
+{
+    for (AVD_UInt32 vertex = 0; vertex < mesh->vertexCount; vertex++) {
+        AVD_Vector3 position = {0};
+        AVD_Vector3 normal   = {0};
+        PRIV_avdModelMorphTestBlendDense(mesh, weights, vertex, &position, &normal);
+
+        AVD_ModelVertex unpacked = {0};
+        avdModelVertexUnpack(&blended[vertex], &unpacked);
+        AVD_Float positionError = avdVec3Length(avdVec3Subtract(unpacked.position, position));
+        AVD_Float normalError   = avdVec3Length(avdVec3Subtract(unpacked.normal, normal));
+        AVD_CHECK_MSG(positionError <= positionTolerance, "Blended vertex %u is %f away from the dense blend", vertex, positionError);
+        AVD_CHECK_MSG(normalError <= 0.01f, "Blended normal %u is %f away from the dense blend", vertex, normalError);
+    }
+    return true;
+}
+
+static bool PRIV_avdModelMorphTestBuild(void)
+{
+    const AVD_Float positions[] = {0.0f, 0.0f, 0.0f, 0.5f, 0.0f, 0.0f, 1e-7f, 0.0f, 0.0f, 0.0f, -0.25f, 1.0f};
+    const AVD_Float normals[]   = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.5f, -1.5f};
+    const AVD_UInt32 expected[] = {1, 3};
+
+    AVD_MorphDeltaEncoding encodings[] = {AVD_MORPH_DELTA_ENCODING_FLOAT, AVD_MORPH_DELTA_ENCODING_QUANTIZED};
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(encodings); i++) {
+        AVD_ModelResources resources = {0};
+        AVD_List targets             = {0};
+        AVD_List deltas              = {0};
+        AVD_CHECK(avdModelResourcesCreate(&resources));
+        avdListCreate(&targets, sizeof(AVD_MorphTargetDeltas));
+        avdListCreate(&deltas, sizeof(AVD_UInt32));
+        for (AVD_Size vertex = 0; vertex < 4; vertex++) {
+            PRIV_avdModelMorphTestPushVertex(&resources, avdVec3Zero(), avdVec3(0.0f, 0.0f, 1.0f));
+        }
+
+        // the second copy has no normals and two vertices that do not move
+        AVD_Mesh mesh = {0};
+        avdMeshInitWithNameId(&mesh, "MorphTestBuild", 0);
+        bool ok = avdMorphTargetBuild(&targets, &deltas, positions, normals, 4, encodings[i]);
+        ok      = ok && avdMorphTargetBuild(&targets, &deltas, positions, NULL, 4, encodings[i]);
+        ok      = ok && avdMeshAddMorphTargets(&mesh, &resources, 0, 4, &targets, &deltas);
+        ok      = ok && mesh.morphTargetCount == 2 && mesh.morphVertexCount == 4 && resources.morphDeltasList.count == 4 * avdMorphDeltaWords(encodings[i]);
+
+        // quantized values are within half a step
+        AVD_Float positionStep = encodings[i] == AVD_MORPH_DELTA_ENCODING_QUANTIZED ? 1.0f / 32767.0f : 0.0f;
+        AVD_Float normalStep   = encodings[i] == AVD_MORPH_DELTA_ENCODING_QUANTIZED ? AVD_MORPH_NORMAL_SCALE : 0.0f;
+        for (AVD_Int32 target = 0; ok && target < mesh.morphTargetCount; target++) {
+            const AVD_MorphTargetDeltas *entry = (const AVD_MorphTargetDeltas *)avdListGet(&resources.morphTargetsList, (AVD_Size)target);
+            ok                                 = entry->deltaCount == AVD_ARRAY_COUNT(expected) && entry->encoding == (uint32_t)encodings[i];
+            for (AVD_UInt32 j = 0; ok && j < entry->deltaCount; j++) {
+                AVD_MorphDelta delta = {0};
+                avdMorphTargetGetDelta(&resources, entry, j, &delta);
+                ok = delta.vertex == expected[j];
+                for (AVD_Size k = 0; ok && k < 3; k++) {
+                    AVD_Float normal = target == 0 ? normals[delta.vertex * 3 + k] : 0.0f;
+                    ok               = fabsf(delta.position[k] - positions[delta.vertex * 3 + k]) <= positionStep * 0.5f + 1e-7f;
+                    ok               = ok && fabsf(delta.normal[k] - normal) <= normalStep * 0.5f + 1e-7f;
+                }
+            }
+        }
+
+        // a target that moves a vertex past the range is refused
+        AVD_Mesh outside = {0};
+        avdMeshInitWithNameId(&outside, "MorphTestOutside", 1);
+        ok = ok && !avdMeshAddMorphTargets(&outside, &resources, 0, 3, &targets, &deltas);
+
+        avdListDestroy(&targets);
+        avdListDestroy(&deltas);
+        avdModelResourcesDestroy(&resources);
+        AVD_CHECK_MSG(ok, "Sparse morph targets do not hold the dense deltas (encoding %d)", (int)encodings[i]);
+    }
+    return true;
+}
+
+static bool PRIV_avdModelMorphTestBlend(AVD_MorphDeltaEncoding encoding)
+{
+    AVD_ModelMorphTestMesh mesh = {0};
+    AVD_CHECK(PRIV_avdModelMorphTestMeshCreate(&mesh, 33, 8, 0.4f, encoding));
+
+    AVD_List accumulators = {0};
+    avdListCreate(&accumulators, sizeof(AVD_Int32));
+    AVD_ModelVertexPacked *blended = (AVD_ModelVertexPacked *)AVD_MALLOC(sizeof(AVD_ModelVertexPacked) * mesh.vertexCount);
+    AVD_Float weights[8]           = {0};
+    bool ok                        = blended != NULL;
+
+    // nothing active gives the base vertices bit for bit
+    const AVD_ModelVertexPacked *base = (const AVD_ModelVertexPacked *)mesh.resources.verticesList.items + mesh.mesh.morphVertexOffset;
+    ok                                = ok && avdMeshBlendMorphTargets(&mesh.mesh, &mesh.resources, weights, &accumulators, blended);
+    ok                                = ok && memcmp(blended, base, sizeof(AVD_ModelVertexPacked) * mesh.vertexCount) == 0;
+    if (!ok) {
+        AVD_LOG_ERROR("    FAILED: Blending with zero weights changed the mesh");
+    }
+
+    // half float positions on [-1, 1] are good to about 5e-4, the quantized
+    // deltas add half a step of the largest one
+    AVD_Float tolerance   = encoding == AVD_MORPH_DELTA_ENCODING_QUANTIZED ? 2e-3f : 1e-3f;
+    AVD_Float frames[][8] = {
+        {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f},
+        {0.25f, 0.5f, 1.0f, 0.0f, 0.75f, 0.0f, 0.1f, 1.0f},
+        {-0.5f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f},
+    };
+    for (AVD_Size frame = 0; ok && frame < AVD_ARRAY_COUNT(frames); frame++) {
+        ok = avdMeshBlendMorphTargets(&mesh.mesh, &mesh.resources, frames[frame], &accumulators, blended);
+        ok = ok && PRIV_avdModelMorphTestCompare(&mesh, frames[frame], blended, tolerance);
+    }
+
+    // weights below the threshold are not blended at all
+    AVD_ModelVertexPacked *skipped = (AVD_ModelVertexPacked *)AVD_MALLOC(sizeof(AVD_ModelVertexPacked) * mesh.vertexCount);
+    ok                             = ok && skipped != NULL;
+    if (ok) {
+        memcpy(weights, frames[1], sizeof(weights));
+        ok         = avdMeshBlendMorphTargets(&mesh.mesh, &mesh.resources, weights, &accumulators, blended);
+        weights[3] = AVD_MORPH_MIN_WEIGHT * 0.5f;
+        ok         = ok && avdMeshBlendMorphTargets(&mesh.mesh, &mesh.resources, weights, &accumulators, skipped);
+        ok         = ok && memcmp(blended, skipped, sizeof(AVD_ModelVertexPacked) * mesh.vertexCount) == 0;
+        if (!ok) {
+            AVD_LOG_ERROR("    FAILED: A target below the minimum weight was blended");
+        }
+    }
+
+    if (skipped != NULL) {
+        AVD_FREE(skipped);
+    }
+    if (blended != NULL) {
+        AVD_FREE(blended);
+    }
+    avdListDestroy(&accumulators);
+    PRIV_avdModelMorphTestMeshDestroy(&mesh);
+    AVD_CHECK(ok);
+    return true;
+}
+
+// Reversing the vertex order has to reverse the deltas with it, every vertex
+// moves as far as its index.
+static bool PRIV_avdModelMorphTestRemap(void)
+{
+    const AVD_Float positions[] = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 3.0f, 0.0f, 0.0f, 0.0f, 4.0f};
+    const AVD_UInt32 remap[]    = {4, 3, 2, 1, 0};
+
+    AVD_List targets = {0};
+    AVD_List deltas  = {0};
+    avdListCreate(&targets, sizeof(AVD_MorphTargetDeltas));
+    avdListCreate(&deltas, sizeof(AVD_UInt32));
+    bool ok = avdMorphTargetBuild(&targets, &deltas, positions, NULL, 5, AVD_MORPH_DELTA_ENCODING_FLOAT);
+    ok      = ok && avdMorphTargetBuild(&targets, &deltas, positions, NULL, 5, AVD_MORPH_DELTA_ENCODING_QUANTIZED);
+    if (ok) {
+        avdMorphTargetsRemap(&targets, &deltas, remap);
+    }
+
+    AVD_ModelResources resources = {0};
+    AVD_Mesh mesh                = {0};
+    ok                           = ok && avdModelResourcesCreate(&resources);
+    for (AVD_Size i = 0; ok && i < 5; i++) {
+        PRIV_avdModelMorphTestPushVertex(&resources, avdVec3Zero(), avdVec3(0.0f, 0.0f, 1.0f));
+    }
+    avdMeshInitWithNameId(&mesh, "MorphTestRemap", 0);
+    ok = ok && avdMeshAddMorphTargets(&mesh, &resources, 0, 5, &targets, &deltas);
+    for (AVD_Size target = 0; ok && target < resources.morphTargetsList.count; target++) {
+        const AVD_MorphTargetDeltas *entry = (const AVD_MorphTargetDeltas *)avdListGet(&resources.morphTargetsList, target);
+        for (AVD_UInt32 j = 0; ok && j < entry->deltaCount; j++) {
+            AVD_MorphDelta delta = {0};
+            avdMorphTargetGetDelta(&resources, entry, j, &delta);
+            AVD_UInt32 source = remap[delta.vertex];
+            ok                = fabsf(delta.position[0] + delta.position[1] + delta.position[2] - (AVD_Float)source) < 1e-3f;
+        }
+    }
+
+    avdListDestroy(&targets);
+    avdListDestroy(&deltas);
+    avdModelResourcesDestroy(&resources);
+    AVD_CHECK_MSG(ok, "Remapped morph deltas do not follow their vertices");
+    return true;
+}
+
+// The rig of the benchmark has to come out far smaller than the dense layout,
+// one full packed vertex per vertex and target.
+static bool PRIV_avdModelMorphTestMemory(void)
+{
+    AVD_ModelMorphTestMesh floats    = {0};
+    AVD_ModelMorphTestMesh quantized = {0};
+    AVD_CHECK(PRIV_avdModelMorphTestMeshCreate(&floats, 64, 16, AVD_MORPH_BENCH_TARGET_RADIUS, AVD_MORPH_DELTA_ENCODING_FLOAT));
+    if (!PRIV_avdModelMorphTestMeshCreate(&quantized, 64, 16, AVD_MORPH_BENCH_TARGET_RADIUS, AVD_MORPH_DELTA_ENCODING_QUANTIZED)) {
+        PRIV_avdModelMorphTestMeshDestroy(&floats);
+        return false;
+    }
+
+    AVD_Size dense    = sizeof(AVD_ModelVertexPacked) * floats.vertexCount * floats.targetCount;
+    AVD_Size sparse   = avdMeshMorphTargetsSize(&floats.mesh, &floats.resources);
+    AVD_Size sparse16 = avdMeshMorphTargetsSize(&quantized.mesh, &quantized.resources);
+    PRIV_avdModelMorphTestMeshDestroy(&floats);
+    PRIV_avdModelMorphTestMeshDestroy(&quantized);
+
+    AVD_LOG_DEBUG("    morph targets: %zu bytes dense, %zu sparse, %zu quantized", dense, sparse, sparse16);
+    AVD_CHECK_MSG(sparse * 2 < dense && sparse16 * 3 < sparse * 2, "Sparse morph targets take %zu bytes (%zu quantized) against %zu dense", sparse, sparse16, dense);
+    return true;
+}
+
+bool avdModelMorphTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Model Morph Tests...");
+
+    AVD_CHECK(PRIV_avdModelMorphTestBuild());
+    AVD_CHECK(PRIV_avdModelMorphTestBlend(AVD_MORPH_DELTA_ENCODING_FLOAT));
+    AVD_CHECK(PRIV_avdModelMorphTestBlend(AVD_MORPH_DELTA_ENCODING_QUANTIZED));
+    AVD_CHECK(PRIV_avdModelMorphTestRemap());
+    AVD_CHECK(PRIV_avdModelMorphTestMemory());
+
+    AVD_LOG_DEBUG("All AVD Model Morph Tests PASSED");
+    return true;
+}
+
+typedef struct {
+    const AVD_Mesh *mesh;
+    const AVD_ModelResources *resources;
+    AVD_Float *weights;
+    AVD_List accumulators;
+    AVD_ModelVertexPacked *blended;
+} AVD_ModelMorphBenchmark;
+
+static void PRIV_avdModelMorphBenchmarkBlend(void *userData)
+{
+    AVD_ModelMorphBenchmark *benchmark = (AVD_ModelMorphBenchmark *)userData;
+    avdMeshBlendMorphTargets(benchmark->mesh, benchmark->resources, benchmark->weights, &benchmark->accumulators, benchmark->blended);
+}
+
+// Blends mesh with a few targets of the rig active, like a frame of facial
+// animation, and reports what its targets take in memory.
+static bool PRIV_avdModelMorphBenchmarkRun(AVD_Bench *bench, const char *name, const AVD_Mesh *mesh, const AVD_ModelResources *resources)
+{
+    AVD_Size vertexCount = (AVD_Size)mesh->morphVertexCount;
+    AVD_Size dense       = sizeof(AVD_ModelVertexPacked) * vertexCount * (AVD_Size)mesh->morphTargetCount;
+    AVD_Size sparse      = avdMeshMorphTargetsSize(mesh, resources);
+    AVD_LOG_INFO(
+        "%s: %zu vertices, %d targets, %zu KiB of targets (%zu KiB dense, %.1f%%)",
+        name,
+        vertexCount,
+        mesh->morphTargetCount,
+        sparse / 1024,
+        dense / 1024,
+        dense > 0 ? 100.0 * (AVD_Double)sparse / (AVD_Double)dense : 0.0);
+
+    AVD_ModelMorphBenchmark benchmark = {
+        .mesh      = mesh,
+        .resources = resources,
+        .weights   = (AVD_Float *)AVD_MALLOC(sizeof(AVD_Float) * AVD_MAX((AVD_Size)mesh->morphTargetCount, (AVD_Size)1)),
+        .blended   = (AVD_ModelVertexPacked *)AVD_MALLOC(sizeof(AVD_ModelVertexPacked) * AVD_MAX(vertexCount, (AVD_Size)1)),
+    };
+    avdListCreate(&benchmark.accumulators, sizeof(AVD_Int32));
+    bool ok = benchmark.weights != NULL && benchmark.blended != NULL;
+    if (ok) {
+        memset(benchmark.weights, 0, sizeof(AVD_Float) * (AVD_Size)mesh->morphTargetCount);
+        for (AVD_Int32 i = 0; i < mesh->morphTargetCount && i < AVD_MORPH_BENCH_ACTIVE_COUNT; i++) {
+            benchmark.weights[(i * 7) % mesh->morphTargetCount] = 0.3f + 0.05f * (AVD_Float)i;
+        }
+
+        AVD_BenchCase blendCase = {
+            .name               = name,
+            .unit               = "vertices",
+            .itemsPerRepetition = vertexCount,
+            .run                = PRIV_avdModelMorphBenchmarkBlend,
+            .userData           = &benchmark,
+        };
+        ok = avdBenchRun(bench, &blendCase);
+    }
+
+    if (benchmark.weights != NULL) {
+        AVD_FREE(benchmark.weights);
+    }
+    if (benchmark.blended != NULL) {
+        AVD_FREE(benchmark.blended);
+    }
+    avdListDestroy(&benchmark.accumulators);
+    return ok;
+}
+
+static bool PRIV_avdModelMorphBenchmarkGrid(AVD_Bench *bench, const char *name, AVD_MorphDeltaEncoding encoding)
+{
+    if (!avdBenchIsSelected(bench, name)) {
+        return true;
+    }
+
+    AVD_ModelMorphTestMesh mesh = {0};
+    AVD_CHECK(PRIV_avdModelMorphTestMeshCreate(&mesh, AVD_MORPH_BENCH_GRID_SIZE, AVD_MORPH_BENCH_TARGET_COUNT, AVD_MORPH_BENCH_TARGET_RADIUS, encoding));
+    bool ok = PRIV_avdModelMorphBenchmarkRun(bench, name, &mesh.mesh, &mesh.resources);
+    PRIV_avdModelMorphTestMeshDestroy(&mesh);
+    return ok;
+}
+
+// A face rig with ARKit style blend shapes, skipped when the asset has not
+// been downloaded next to the working directory. Every mesh with targets is
+// blended as one case.
+static bool PRIV_avdModelMorphBenchmarkFaceRig(AVD_Bench *bench)
+{
+    const char *name = "morph/blend_face_rig";
+    const char *path = "assets/face_rig/facecap.glb";
+    if (!avdBenchIsSelected(bench, name)) {
+        return true;
+    }
+    if (!avdPathExists(path)) {
+        AVD_LOG_WARN("Skipping the face rig blend benchmark, %s was not found", path);
+        return true;
+    }
+
+    AVD_Model model              = {0};
+    AVD_ModelResources resources = {0};
+    AVD_CHECK(avdModelCreate(&model, 0));
+    AVD_CHECK(avdModelResourcesCreate(&resources));
+
+    bool ok = avdModelLoadGltf(path, &model, &resources, AVD_GLTF_LOAD_FLAG_OPTIMIZE);
+    for (AVD_Size i = 0; ok && i < model.meshes.count; i++) {
+        const AVD_Mesh *mesh = (const AVD_Mesh *)avdListGet(&model.meshes, i);
+        if (mesh->morphTargetCount > 0) {
+            ok = PRIV_avdModelMorphBenchmarkRun(bench, name, mesh, &resources);
+        }
+    }
+
+    avdModelResourcesDestroy(&resources);
+    avdModelDestroy(&model);
+    return ok;
+}
+
+bool avdModelMorphBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD Model Morph benchmarks...");
+
+    bool ok = PRIV_avdModelMorphBenchmarkGrid(bench, "morph/blend_grid_25k", AVD_MORPH_DELTA_ENCODING_FLOAT);
+    ok      = ok && PRIV_avdModelMorphBenchmarkGrid(bench, "morph/blend_grid_25k_quantized", AVD_MORPH_DELTA_ENCODING_QUANTIZED);
+    ok      = ok && PRIV_avdModelMorphBenchmarkFaceRig(bench);
+    return ok;
+}
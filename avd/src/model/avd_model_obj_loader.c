@@ -1,118 +1,166 @@
 #include "model/avd_3d_scene.h"
 
-#include "tinyobj_loader_c.h"
-
+// OBJ faces index positions, normals and texture coordinates separately, so
+// every face corner is looked up by its index triple and corners that use the
+// same triple share one vertex. With AVD_OBJ_LOAD_FLAG_WELD_PACKED corners whose
+// packed vertices come out bit identical share one as well, that catches
+// attributes duplicated in the file and values that only differ below the
+// precision the vertices are stored at, without changing what gets drawn.
 typedef struct {
-    void *allocatedObjData;
-    void *allocatedMtlData;
-} AVD_MemoryContext;
-
-static void PRIV_avdReadFile(
-    void *ctx,
-    const char *filename,
-    const int is_mtl,
-    const char *obj_filename,
-    char **data,
-    size_t *len)
+    AVD_HashTable cornerVertices;
+    AVD_HashTable packedVertices;
+    bool weldPacked;
+    AVD_Size cornerCount;
+    AVD_Size vertexCount;
+} AVD_ObjVertexWelder;
+
+static bool PRIV_avdObjVertexWelderCreate(AVD_ObjVertexWelder *welder, const AVD_ObjData *obj, AVD_ObjLoadFlags flags)
 {
-    AVD_MemoryContext *memoryContext = (AVD_MemoryContext *)ctx;
-    AVD_ASSERT(memoryContext != NULL);
-    AVD_ASSERT(data != NULL);
-    AVD_ASSERT(len != NULL);
-    AVD_ASSERT(filename != NULL);
+    AVD_ASSERT(welder != NULL);
+    AVD_ASSERT(obj != NULL);
 
-    if (!avdPathExists(filename)) {
-        AVD_LOG_ERROR("File does not exist: %s", filename);
-        *data = NULL;
-        *len  = 0;
-        return;
-    }
+    memset(welder, 0, sizeof(AVD_ObjVertexWelder));
+    welder->weldPacked = (flags & AVD_OBJ_LOAD_FLAG_WELD_PACKED) != 0;
 
-    if (!avdReadBinaryFile(filename, (void **)data, len)) {
-        AVD_LOG_ERROR("Failed to read file: %s", filename);
-        *data = NULL;
-        *len  = 0;
-        return;
+    // most meshes end up with about one vertex per position, the tables grow if they need more
+    AVD_CHECK(avdHashTableCreate(&welder->cornerVertices, sizeof(AVD_ObjCorner), sizeof(AVD_UInt32), obj->positions.count, false));
+    if (welder->weldPacked) {
+        AVD_CHECK(avdHashTableCreate(&welder->packedVertices, sizeof(AVD_ModelVertexPacked), sizeof(AVD_UInt32), obj->positions.count, false));
     }
+    return true;
+}
 
-    if (is_mtl) {
-        memoryContext->allocatedMtlData = *data;
-    } else {
-        memoryContext->allocatedObjData = *data;
+static void PRIV_avdObjVertexWelderDestroy(AVD_ObjVertexWelder *welder)
+{
+    AVD_ASSERT(welder != NULL);
+
+    if (welder->cornerVertices.slots != NULL) {
+        avdHashTableDestroy(&welder->cornerVertices);
+    }
+    if (welder->packedVertices.slots != NULL) {
+        avdHashTableDestroy(&welder->packedVertices);
     }
 }
 
-static bool PRIV_avdMeshLoadFaces(
-    tinyobj_attrib_t *attrib,
+// Attributes a corner does not have are left at their defaults.
+static bool PRIV_avdObjVertexWelderAdd(
+    AVD_ObjVertexWelder *welder,
+    const AVD_ObjData *obj,
     AVD_ModelResources *resources,
-    AVD_Mesh *mesh,
-    uint32_t faceOffset,
-    uint32_t faceCount)
+    const AVD_ObjCorner *corner,
+    AVD_UInt32 *outIndex)
 {
-    AVD_ASSERT(attrib != NULL);
-    AVD_ASSERT(resources != NULL);
-    AVD_ASSERT(mesh != NULL);
-    AVD_ASSERT(faceOffset < attrib->num_face_num_verts);
-
-    mesh->triangleCount = 0;
-    mesh->indexOffset   = (uint32_t)resources->indicesList.count;
-
-    uint32_t attribFaceOffset = 0;
+    welder->cornerCount++;
 
-    for (uint32_t faceIndex = 0; faceIndex < faceOffset; faceIndex++) {
-        attribFaceOffset += (uint32_t)attrib->face_num_verts[faceIndex];
+    if (avdHashTableGet(&welder->cornerVertices, corner, outIndex)) {
+        return true;
     }
 
     AVD_ModelVertex vertex             = {0};
     AVD_ModelVertexPacked packedVertex = {0};
+    avdModelVertexInit(&vertex);
 
-    for (size_t faceIndex = faceOffset; faceIndex < faceOffset + faceCount; faceIndex++) {
-        // Ensure the face has a multiple of 3 vertices (triangles)
-        uint32_t vertexCount = (uint32_t)attrib->face_num_verts[faceIndex];
-        AVD_CHECK(vertexCount % 3 == 0);
-        mesh->triangleCount += vertexCount / 3;
+    vertex.position = *(const AVD_Vector3 *)avdListGet(&obj->positions, (AVD_Size)corner->position);
+    if (corner->normal >= 0) {
+        vertex.normal = *(const AVD_Vector3 *)avdListGet(&obj->normals, (AVD_Size)corner->normal);
+    }
+    if (corner->texCoord >= 0) {
+        vertex.texCoord = *(const AVD_Vector2 *)avdListGet(&obj->texCoords, (AVD_Size)corner->texCoord);
+    }
 
-        // Add the three indices for the triangle
-        uint32_t currentIndex = 0;
-        for (uint32_t vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
-            avdModelVertexInit(&vertex);
+    AVD_CHECK(avdModelVertexPack(&vertex, &packedVertex));
 
-            tinyobj_vertex_index_t index = attrib->faces[attribFaceOffset + vertexIndex];
+    if (!welder->weldPacked || !avdHashTableGet(&welder->packedVertices, &packedVertex, outIndex)) {
+        avdListPushBack(&resources->verticesList, &packedVertex);
+        *outIndex = (AVD_UInt32)resources->verticesList.count - 1;
+        welder->vertexCount++;
 
-            vertex.position.x = attrib->vertices[3 * index.v_idx + 0];
-            vertex.position.y = attrib->vertices[3 * index.v_idx + 1];
-            vertex.position.z = attrib->vertices[3 * index.v_idx + 2];
+        if (welder->weldPacked) {
+            AVD_CHECK(avdHashTableSet(&welder->packedVertices, &packedVertex, outIndex));
+        }
+    }
 
-            if (attrib->num_normals > 0) {
-                vertex.normal.x = attrib->normals[3 * index.vn_idx + 0];
-                vertex.normal.y = attrib->normals[3 * index.vn_idx + 1];
-                vertex.normal.z = attrib->normals[3 * index.vn_idx + 2];
-            }
+    AVD_CHECK(avdHashTableSet(&welder->cornerVertices, corner, outIndex));
+    return true;
+}
 
-            if (attrib->num_texcoords > 0) {
-                vertex.texCoord.x = attrib->texcoords[2 * index.vt_idx + 0];
-                vertex.texCoord.y = attrib->texcoords[2 * index.vt_idx + 1];
-            }
+static bool PRIV_avdMeshLoadFaces(
+    const AVD_ObjData *obj,
+    AVD_ModelResources *resources,
+    AVD_ObjVertexWelder *welder,
+    AVD_MeshOptimizeFlags optimizeFlags,
+    AVD_MeshOptimizeStats *optimizeStats,
+    AVD_ObjLoadFlags flags,
+    AVD_Mesh *mesh,
+    AVD_Size firstTriangle,
+    AVD_Size triangleCount)
+{
+    AVD_ASSERT(obj != NULL);
+    AVD_ASSERT(resources != NULL);
+    AVD_ASSERT(welder != NULL);
+    AVD_ASSERT(optimizeStats != NULL);
+    AVD_ASSERT(mesh != NULL);
+    AVD_ASSERT((firstTriangle + triangleCount) * 3 <= obj->corners.count);
 
-            AVD_CHECK(avdModelVertexPack(&vertex, &packedVertex));
-            avdListPushBack(&resources->verticesList, &packedVertex);
+    mesh->triangleCount    = (AVD_Int32)triangleCount;
+    mesh->indexOffset      = (AVD_Int32)resources->indicesList.count;
+    AVD_UInt32 firstVertex = (AVD_UInt32)resources->verticesList.count;
 
-            currentIndex = (uint32_t)resources->verticesList.count - 1;
-            avdListPushBack(&resources->indicesList, &currentIndex);
-        }
+    // every mesh gets its own vertices so that the optimizer can reorder them
+    avdHashTableClear(&welder->cornerVertices);
+    if (welder->weldPacked) {
+        avdHashTableClear(&welder->packedVertices);
+    }
+
+    // the index count is known up front, indices are written in place
+    const AVD_ObjCorner *corners = (const AVD_ObjCorner *)obj->corners.items + firstTriangle * 3;
+    AVD_UInt32 *indices          = (AVD_UInt32 *)avdListAddEmptyN(&resources->indicesList, triangleCount * 3);
+    AVD_CHECK(indices != NULL || triangleCount == 0);
+    for (AVD_Size i = 0; i < triangleCount * 3; i++) {
+        AVD_CHECK(PRIV_avdObjVertexWelderAdd(welder, obj, resources, &corners[i], &indices[i]));
+    }
+
+    if (optimizeFlags != AVD_MESH_OPTIMIZE_NONE) {
+        AVD_MeshOptimizeStats stats = {0};
+        AVD_UInt32 vertexCount      = (AVD_UInt32)resources->verticesList.count - firstVertex;
+        AVD_CHECK(avdMeshOptimize(mesh, resources, firstVertex, vertexCount, optimizeFlags, NULL, &stats));
+        avdMeshCacheStatsAdd(&optimizeStats->before, &stats.before);
+        avdMeshCacheStatsAdd(&optimizeStats->after, &stats.after);
+    }
 
-        attribFaceOffset += (uint32_t)attrib->face_num_verts[faceIndex];
+    AVD_CHECK(avdMeshComputeBounds(mesh, resources));
+    if (flags & AVD_OBJ_LOAD_FLAG_LODS) {
+        AVD_CHECK(avdMeshBuildLods(mesh, resources, NULL));
+    }
+    // meshlets are only built for the full mesh
+    if (flags & AVD_OBJ_LOAD_FLAG_MESHLETS) {
+        AVD_CHECK(avdMeshBuildMeshlets(mesh, resources));
     }
     return true;
 }
 
+static AVD_MeshOptimizeFlags PRIV_avdObjOptimizeFlags(AVD_ObjLoadFlags flags)
+{
+    if (flags & AVD_OBJ_LOAD_FLAG_OPTIMIZE_OVERDRAW) {
+        return AVD_MESH_OPTIMIZE_VERTEX_CACHE | AVD_MESH_OPTIMIZE_OVERDRAW | AVD_MESH_OPTIMIZE_VERTEX_FETCH;
+    }
+    if (flags & AVD_OBJ_LOAD_FLAG_OPTIMIZE) {
+        return AVD_MESH_OPTIMIZE_VERTEX_CACHE | AVD_MESH_OPTIMIZE_VERTEX_FETCH;
+    }
+    return AVD_MESH_OPTIMIZE_NONE;
+}
+
 bool avd3DSceneLoadObj(const char *filename, AVD_3DScene *scene, AVD_ObjLoadFlags flags)
 {
     AVD_ASSERT(scene != NULL);
 
-    AVD_Model model = {0};
-    AVD_CHECK(avdModelCreate(&model, 0));
-    AVD_CHECK(avdModelLoadObj(filename, &model, &scene->modelResources, flags));
+    // the scene containers grow while loading, charge them to the model subsystem
+    AVD_MemoryTag previousTag = avdMemorySetThreadTag(AVD_MEMORY_TAG_MODEL);
+    AVD_Model model           = {0};
+    bool loaded               = avdModelCreate(&model, 0) && avdModelLoadObj(filename, &model, &scene->modelResources, flags);
+    avdMemorySetThreadTag(previousTag);
+    AVD_CHECK(loaded);
+
     avdListPushBack(&scene->modelsList, &model);
     return true;
 }
@@ -125,66 +173,117 @@ bool avdModelLoadObj(const char *filename, AVD_Model *model, AVD_ModelResources
 
     AVD_CHECK_MSG(avdPathExists(filename), "The specified OBJ file does not exist: %s", filename);
 
-    tinyobj_attrib_t attrib                = {0};
-    tinyobj_shape_t *shapes                = NULL;
-    size_t shapeCount                      = 0;
-    tinyobj_material_t *materials          = NULL;
-    size_t materialCount                   = 0;
-    static AVD_MemoryContext memoryContext = {0};
-    memoryContext.allocatedObjData         = NULL;
-    memoryContext.allocatedMtlData         = NULL;
-
-    int err = tinyobj_parse_obj(
-        &attrib,
-        &shapes,
-        &shapeCount,
-        &materials,
-        &materialCount,
-        filename,
-        PRIV_avdReadFile,
-        &memoryContext,
-        TINYOBJ_FLAG_TRIANGULATE);
+    picoPerfTime start   = picoPerfNow();
+    AVD_ModelCache cache = {0};
+    if (avdModelCacheBegin(&cache, filename, "obj", (AVD_UInt32)flags, resources) && avdModelCacheRead(&cache, model, resources)) {
+        AVD_LOG_INFO("Loaded '%s' from the mesh cache in %.1f ms", filename, picoPerfDurationMilliseconds(start, picoPerfNow()));
+        return true;
+    }
 
-    if (err != TINYOBJ_SUCCESS) {
-        AVD_LOG_ERROR("Error parsing OBJ file: %d", err);
+    AVD_ObjData obj = {0};
+    AVD_CHECK(avdObjDataCreate(&obj));
+    if (!avdObjParseFile(filename, &obj)) {
+        avdObjDataDestroy(&obj);
         return false;
     }
+    AVD_LOG_INFO(
+        "Parsed '%s': %zu lines in %zu chunks, %zu positions and %zu triangles, %.1f ms",
+        filename,
+        obj.lineCount,
+        obj.chunkCount,
+        obj.positions.count,
+        obj.corners.count / 3,
+        picoPerfDurationMilliseconds(start, picoPerfNow()));
 
     snprintf(model->name, sizeof(model->name), "%s", filename);
     model->id = avdHashString(model->name);
 
-    if (flags & AVD_OBJ_LOAD_FLAG_IGNORE_OBJECTS) {
-        // Load all shapes as a single mesh
+    AVD_ObjVertexWelder welder          = {0};
+    AVD_MeshOptimizeFlags optimizeFlags = PRIV_avdObjOptimizeFlags(flags);
+    AVD_MeshOptimizeStats optimizeStats = {0};
+    bool loaded                         = PRIV_avdObjVertexWelderCreate(&welder, &obj, flags);
+
+    // meshes of a model mostly share positions, so there is about one vertex per position
+    avdListEnsureCapacity(&resources->verticesList, resources->verticesList.count + obj.positions.count);
+    avdListEnsureCapacity(&resources->indicesList, resources->indicesList.count + obj.corners.count);
+
+    if (loaded && (flags & AVD_OBJ_LOAD_FLAG_IGNORE_OBJECTS)) {
+        // Load all objects as a single mesh
         AVD_Mesh mesh = {0};
-        AVD_CHECK(avdMeshInit(&mesh));
+        loaded        = avdMeshInit(&mesh);
         snprintf(mesh.name, sizeof(mesh.name), "%s/Mesh", model->name);
         mesh.id = avdHashString(mesh.name);
-        AVD_CHECK(PRIV_avdMeshLoadFaces(&attrib, resources, &mesh, 0, attrib.num_face_num_verts));
-        avdListPushBack(&model->meshes, &mesh);
+        loaded  = loaded && PRIV_avdMeshLoadFaces(&obj, resources, &welder, optimizeFlags, &optimizeStats, flags, &mesh, 0, obj.corners.count / 3);
+        if (loaded) {
+            avdListPushBack(&model->meshes, &mesh);
+        }
     } else {
-        // Load all shapes as separate meshes
-        for (size_t i = 0; i < shapeCount; i++) {
-            tinyobj_shape_t *shape = &shapes[i];
-            AVD_Mesh mesh          = {0};
-            AVD_CHECK(avdMeshInit(&mesh));
-            snprintf(mesh.name, sizeof(mesh.name), "%s/%s", model->name, shape->name);
+        // Load all objects as separate meshes
+        for (AVD_Size i = 0; loaded && i < obj.objects.count; i++) {
+            const AVD_ObjObject *object = (const AVD_ObjObject *)avdListGet(&obj.objects, i);
+            AVD_Mesh mesh               = {0};
+            loaded                      = avdMeshInit(&mesh);
+            snprintf(mesh.name, sizeof(mesh.name), "%s/%s", model->name, object->name);
             mesh.id = avdHashString(mesh.name);
-            AVD_CHECK(PRIV_avdMeshLoadFaces(&attrib, resources, &mesh, shape->face_offset, shape->length));
-            avdListPushBack(&model->meshes, &mesh);
+            loaded  = loaded && PRIV_avdMeshLoadFaces(&obj, resources, &welder, optimizeFlags, &optimizeStats, flags, &mesh, object->firstTriangle, object->triangleCount);
+            if (loaded) {
+                avdListPushBack(&model->meshes, &mesh);
+            }
         }
     }
 
-    tinyobj_attrib_free(&attrib);
-    tinyobj_shapes_free(shapes, shapeCount);
-    tinyobj_materials_free(materials, materialCount);
-
-    if (memoryContext.allocatedObjData != NULL) {
-        free(memoryContext.allocatedObjData);
+    if (loaded) {
+        AVD_Size savedBytes = (welder.cornerCount - welder.vertexCount) * sizeof(AVD_ModelVertexPacked);
+        AVD_LOG_INFO(
+            "Loaded '%s': %zu face corners welded to %zu vertices, %.2f MiB of vertex data saved, %.1f ms",
+            filename,
+            welder.cornerCount,
+            welder.vertexCount,
+            (double)savedBytes / (1024.0 * 1024.0),
+            picoPerfDurationMilliseconds(start, picoPerfNow()));
     }
-
-    if (memoryContext.allocatedMtlData != NULL) {
-        free(memoryContext.allocatedMtlData);
+    if (loaded && optimizeFlags != AVD_MESH_OPTIMIZE_NONE) {
+        AVD_LOG_INFO(
+            "Optimized '%s': ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+            filename,
+            avdMeshCacheStatsACMR(optimizeStats.before),
+            avdMeshCacheStatsACMR(optimizeStats.after),
+            avdMeshCacheStatsATVR(optimizeStats.before),
+            avdMeshCacheStatsATVR(optimizeStats.after));
     }
+    if (loaded && (flags & AVD_OBJ_LOAD_FLAG_LODS)) {
+        AVD_MeshLodStats lodStats = {0};
+        for (AVD_Size i = 0; i < model->meshes.count; i++) {
+            avdMeshLodStatsAdd(&lodStats, (const AVD_Mesh *)avdListGet(&model->meshes, i));
+        }
+        char levels[256] = {0};
+        AVD_Size length  = 0;
+        for (AVD_Int32 level = 0; level < lodStats.levelCount && length < sizeof(levels); level++) {
+            length += (AVD_Size)snprintf(levels + length, sizeof(levels) - length, level == 0 ? "%zu" : " -> %zu", lodStats.triangleCount[level]);
+        }
+        AVD_LOG_INFO("Built %d levels of detail for '%s': %s triangles", lodStats.levelCount, filename, levels);
+    }
+    if (loaded && (flags & AVD_OBJ_LOAD_FLAG_MESHLETS)) {
+        AVD_MeshletStats meshletStats = {0};
+        for (AVD_Size i = 0; i < model->meshes.count; i++) {
+            avdMeshletStatsAdd(&meshletStats, (const AVD_Mesh *)avdListGet(&model->meshes, i), resources);
+        }
+        AVD_LOG_INFO(
+            "Built %zu meshlets for '%s': %.1f triangles and %.1f vertices each, %zu with normal cones",
+            meshletStats.meshletCount,
+            filename,
+            (double)meshletStats.triangleCount / (double)AVD_MAX(meshletStats.meshletCount, (AVD_Size)1),
+            (double)meshletStats.vertexCount / (double)AVD_MAX(meshletStats.meshletCount, (AVD_Size)1),
+            meshletStats.coneCount);
+    }
+    // the model is usable without its cache entry, the next load just parses again
+    if (loaded) {
+        avdModelCacheWrite(&cache, model, resources);
+    }
+
+    PRIV_avdObjVertexWelderDestroy(&welder);
+    avdObjDataDestroy(&obj);
 
+    AVD_CHECK_MSG(loaded, "Failed to load the faces of %s", filename);
     return true;
 }
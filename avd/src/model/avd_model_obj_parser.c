@@ -0,0 +1,669 @@
+#include "model/avd_model_obj_parser.h"
+#include "core/avd_jobs.h"
+
+#if !defined(AVD_OBJ_PARSER_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AVD_OBJ_PARSER_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define AVD_OBJ_PARSER_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// The fast float path relies on float arithmetic being done in float, builds
+// that keep wider intermediates (x87) always go through strtof.
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0
+#define AVD_OBJ_PARSER_NO_FAST_FLOATS
+#endif
+
+// Eight digits are converted at once by loading them into a little endian
+// 64 bit integer.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define AVD_OBJ_PARSER_NO_SWAR
+#endif
+
+// Numbers longer than this are handed to strtof.
+#define AVD_OBJ_PARSER_MAX_NUMBER_LENGTH 64
+
+typedef enum {
+    AVD_OBJ_ATTRIBUTE_POSITION = 0,
+    AVD_OBJ_ATTRIBUTE_TEX_COORD,
+    AVD_OBJ_ATTRIBUTE_NORMAL,
+    AVD_OBJ_ATTRIBUTE_COUNT,
+} AVD_ObjAttribute;
+
+typedef struct {
+    AVD_ObjCorner corner;
+    // attributes given as negative indices, counted from the start of the chunk
+    AVD_UInt32 relativeMask;
+} AVD_ObjParsedCorner;
+
+typedef struct {
+    const char *begin;
+    const char *end;
+
+    AVD_List positions;
+    AVD_List texCoords;
+    AVD_List normals;
+    AVD_List corners;
+    AVD_List objects; // firstTriangle counts from the start of the chunk
+    // corner * AVD_OBJ_ATTRIBUTE_COUNT + attribute of every relative index
+    AVD_List relativeIndices;
+    AVD_Size lineCount;
+
+    const char *error;
+    AVD_Size errorLine; // within the chunk, starting at 1
+
+    // where the chunk goes in the merged lists
+    AVD_Size positionOffset;
+    AVD_Size texCoordOffset;
+    AVD_Size normalOffset;
+    AVD_Size cornerOffset;
+} AVD_ObjChunk;
+
+typedef struct {
+    AVD_ObjChunk *chunks;
+    AVD_ObjData *data;
+} AVD_ObjParser;
+
+static bool PRIV_avdObjParserSimdEnabled = true;
+
+// 10^10 is the largest power of ten that is an exact float.
+static const AVD_Float PRIV_avdObjPowersOfTen[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+static const AVD_UInt64 PRIV_avdObjIntegerPowersOfTen[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+    10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+    1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull};
+
+#if defined(AVD_OBJ_PARSER_SSE2) || defined(AVD_OBJ_PARSER_NEON)
+static AVD_UInt32 PRIV_avdObjTrailingZeros(AVD_UInt64 mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward64(&index, mask);
+    return (AVD_UInt32)index;
+#else
+    return (AVD_UInt32)__builtin_ctzll(mask);
+#endif
+}
+#endif
+
+// Length of the run of decimal digits at text.
+static AVD_Size PRIV_avdObjDigitCount(const char *text, const char *end)
+{
+    const char *cursor = text;
+#if defined(AVD_OBJ_PARSER_SSE2)
+    if (PRIV_avdObjParserSimdEnabled) {
+        const __m128i zero = _mm_set1_epi8('0');
+        const __m128i nine = _mm_set1_epi8(9);
+        while (end - cursor >= 16) {
+            // bytes at most nine above '0' when compared unsigned are digits
+            __m128i values  = _mm_sub_epi8(_mm_loadu_si128((const __m128i *)cursor), zero);
+            __m128i digits  = _mm_cmpeq_epi8(_mm_min_epu8(values, nine), values);
+            AVD_UInt32 mask = ~(AVD_UInt32)_mm_movemask_epi8(digits) & 0xffffu;
+            if (mask != 0) {
+                return (AVD_Size)(cursor - text) + PRIV_avdObjTrailingZeros(mask);
+            }
+            cursor += 16;
+        }
+    }
+#elif defined(AVD_OBJ_PARSER_NEON)
+    if (PRIV_avdObjParserSimdEnabled) {
+        while (end - cursor >= 16) {
+            uint8x16_t values = vsubq_u8(vld1q_u8((const uint8_t *)cursor), vdupq_n_u8('0'));
+            uint8x16_t digits = vcleq_u8(values, vdupq_n_u8(9));
+            // four bits per byte, there is no movemask
+            AVD_UInt64 mask = ~vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(digits), 4)), 0);
+            if (mask != 0) {
+                return (AVD_Size)(cursor - text) + PRIV_avdObjTrailingZeros(mask) / 4;
+            }
+            cursor += 16;
+        }
+    }
+#endif
+    while (cursor < end && (AVD_UInt8)(*cursor - '0') <= 9) {
+        cursor++;
+    }
+    return (AVD_Size)(cursor - text);
+}
+
+// Value of at most 19 digits.
+static AVD_UInt64 PRIV_avdObjDigitsValue(const char *digits, AVD_Size count)
+{
+    AVD_UInt64 value = 0;
+#if !defined(AVD_OBJ_PARSER_NO_SWAR)
+    for (; count >= 8; count -= 8, digits += 8) {
+        // pairs, then quads, then all eight digits (Lemire, "Fast number parsing
+        // without fallback")
+        AVD_UInt64 chunk = 0;
+        memcpy(&chunk, digits, sizeof(chunk));
+        chunk -= 0x3030303030303030ull;
+        chunk = (chunk * 10) + (chunk >> 8);
+        chunk = (((chunk & 0x000000ff000000ffull) * (100 + (1000000ull << 32))) + (((chunk >> 16) & 0x000000ff000000ffull) * (1 + (10000ull << 32)))) >> 32;
+        value = value * 100000000ull + (chunk & 0xffffffffull);
+    }
+#endif
+    for (; count > 0; count--, digits++) {
+        value = value * 10 + (AVD_UInt64)(*digits - '0');
+    }
+    return value;
+}
+
+static const char *PRIV_avdObjParseFloatSlow(const char *text, const char *end, AVD_Float *outValue)
+{
+    char buffer[AVD_OBJ_PARSER_MAX_NUMBER_LENGTH + 1];
+    AVD_Size length = 0;
+    while (text + length < end && length < AVD_OBJ_PARSER_MAX_NUMBER_LENGTH && text[length] != ' ' && text[length] != '\t' && text[length] != '\r' && text[length] != '\n') {
+        buffer[length] = text[length];
+        length++;
+    }
+    buffer[length] = '\0';
+
+    char *numberEnd = NULL;
+    *outValue       = strtof(buffer, &numberEnd);
+    return numberEnd == buffer ? NULL : text + (numberEnd - buffer);
+}
+
+const char *avdObjParseFloat(const char *text, const char *end, AVD_Float *outValue)
+{
+    AVD_ASSERT(text != NULL);
+    AVD_ASSERT(outValue != NULL);
+
+    const char *cursor = text;
+    bool negative      = false;
+    if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+        negative = *cursor == '-';
+        cursor++;
+    }
+
+    const char *integer   = cursor;
+    AVD_Size integerCount = PRIV_avdObjDigitCount(cursor, end);
+    cursor += integerCount;
+    const char *fraction   = cursor;
+    AVD_Size fractionCount = 0;
+    if (cursor < end && *cursor == '.') {
+        fraction      = ++cursor;
+        fractionCount = PRIV_avdObjDigitCount(cursor, end);
+        cursor += fractionCount;
+    }
+    if (integerCount + fractionCount == 0) {
+        // nan, inf and the like
+        return PRIV_avdObjParseFloatSlow(text, end, outValue);
+    }
+
+    AVD_Int32 exponent = -(AVD_Int32)fractionCount;
+    if (cursor < end && (*cursor == 'e' || *cursor == 'E')) {
+        const char *exponentText = cursor + 1;
+        bool negativeExponent    = false;
+        if (exponentText < end && (*exponentText == '-' || *exponentText == '+')) {
+            negativeExponent = *exponentText == '-';
+            exponentText++;
+        }
+        // an 'e' without digits is not part of the number, like for strtof
+        AVD_Size exponentCount = PRIV_avdObjDigitCount(exponentText, end);
+        if (exponentCount > 4) {
+            return PRIV_avdObjParseFloatSlow(text, end, outValue);
+        }
+        if (exponentCount > 0) {
+            AVD_Int32 value = (AVD_Int32)PRIV_avdObjDigitsValue(exponentText, exponentCount);
+            exponent += negativeExponent ? -value : value;
+            cursor = exponentText + exponentCount;
+        }
+    }
+
+    // leading zeros carry no precision
+    while (integerCount > 0 && *integer == '0') {
+        integer++;
+        integerCount--;
+    }
+    AVD_Size fractionSignificant = fractionCount;
+    if (integerCount == 0) {
+        while (fractionSignificant > 0 && *fraction == '0') {
+            fraction++;
+            fractionSignificant--;
+        }
+    }
+    // neither do trailing ones, "%f" pads every value with them
+    while (fractionSignificant > 0 && fraction[fractionSignificant - 1] == '0') {
+        fractionSignificant--;
+        exponent++;
+    }
+    if (integerCount + fractionSignificant > 19) {
+        return PRIV_avdObjParseFloatSlow(text, end, outValue);
+    }
+
+    AVD_UInt64 mantissa = PRIV_avdObjDigitsValue(integer, integerCount);
+    mantissa            = mantissa * PRIV_avdObjIntegerPowersOfTen[fractionSignificant] + PRIV_avdObjDigitsValue(fraction, fractionSignificant);
+
+    // both the mantissa and the power of ten are exact floats, so one float
+    // multiplication or division rounds correctly (Clinger 1990). Doing it in
+    // double and narrowing the result would round twice.
+    AVD_Float value = 0.0f;
+    if (mantissa != 0) {
+#if defined(AVD_OBJ_PARSER_NO_FAST_FLOATS)
+        return PRIV_avdObjParseFloatSlow(text, end, outValue);
+#else
+        if (mantissa > (1ull << 24) || exponent < -10 || exponent > 10) {
+            return PRIV_avdObjParseFloatSlow(text, end, outValue);
+        }
+        value = (AVD_Float)mantissa;
+        value = exponent < 0 ? value / PRIV_avdObjPowersOfTen[-exponent] : value * PRIV_avdObjPowersOfTen[exponent];
+#endif
+    }
+    *outValue = negative ? -value : value;
+    return cursor;
+}
+
+static const char *PRIV_avdObjParseIndex(const char *text, const char *end, AVD_Int64 *outValue)
+{
+    bool negative = text < end && *text == '-';
+    if (text < end && (*text == '-' || *text == '+')) {
+        text++;
+    }
+    AVD_Size count = PRIV_avdObjDigitCount(text, end);
+    if (count == 0 || count > 10) {
+        return NULL;
+    }
+    AVD_Int64 value = (AVD_Int64)PRIV_avdObjDigitsValue(text, count);
+    *outValue       = negative ? -value : value;
+    return text + count;
+}
+
+static const char *PRIV_avdObjSkipSpace(const char *cursor, const char *end)
+{
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t')) {
+        cursor++;
+    }
+    return cursor;
+}
+
+static bool PRIV_avdObjChunkFail(AVD_ObjChunk *chunk, const char *error)
+{
+    chunk->error     = error;
+    chunk->errorLine = chunk->lineCount;
+    return false;
+}
+
+static bool PRIV_avdObjParseFloats(AVD_ObjChunk *chunk, const char *cursor, const char *end, AVD_Float *outValues, AVD_Size requiredCount, AVD_Size count)
+{
+    for (AVD_Size i = 0; i < count; i++) {
+        cursor = PRIV_avdObjSkipSpace(cursor, end);
+        if (cursor == end && i >= requiredCount) {
+            outValues[i] = 0.0f;
+            continue;
+        }
+        cursor = cursor < end ? avdObjParseFloat(cursor, end, &outValues[i]) : NULL;
+        if (cursor == NULL) {
+            return PRIV_avdObjChunkFail(chunk, "expected a number");
+        }
+    }
+    return true;
+}
+
+static AVD_Int32 *PRIV_avdObjCornerIndex(AVD_ObjCorner *corner, AVD_Size attribute)
+{
+    switch (attribute) {
+        case AVD_OBJ_ATTRIBUTE_POSITION:
+            return &corner->position;
+        case AVD_OBJ_ATTRIBUTE_TEX_COORD:
+            return &corner->texCoord;
+        default:
+            return &corner->normal;
+    }
+}
+
+// One v, v/vt, v//vn or v/vt/vn corner.
+static const char *PRIV_avdObjParseCorner(AVD_ObjChunk *chunk, const char *cursor, const char *end, AVD_ObjParsedCorner *outCorner)
+{
+    AVD_Size counts[]       = {chunk->positions.count, chunk->texCoords.count, chunk->normals.count};
+    outCorner->corner       = (AVD_ObjCorner){.position = -1, .texCoord = -1, .normal = -1};
+    outCorner->relativeMask = 0;
+
+    for (AVD_Int32 attribute = 0; attribute < AVD_OBJ_ATTRIBUTE_COUNT; attribute++) {
+        if (attribute > 0) {
+            if (cursor == end || *cursor != '/') {
+                break;
+            }
+            cursor++;
+            if (attribute == AVD_OBJ_ATTRIBUTE_TEX_COORD && cursor < end && *cursor == '/') {
+                continue;
+            }
+        }
+
+        AVD_Int64 value = 0;
+        cursor          = PRIV_avdObjParseIndex(cursor, end, &value);
+        if (cursor == NULL || value == 0) {
+            return NULL;
+        }
+        AVD_Int32 *index = PRIV_avdObjCornerIndex(&outCorner->corner, (AVD_Size)attribute);
+        if (value > 0) {
+            *index = (AVD_Int32)(value - 1);
+        } else {
+            // the start of the chunk is added once the earlier chunks are counted
+            *index = (AVD_Int32)((AVD_Int64)counts[attribute] + value);
+            outCorner->relativeMask |= 1u << attribute;
+        }
+    }
+    return cursor;
+}
+
+static void PRIV_avdObjPushCorner(AVD_ObjChunk *chunk, const AVD_ObjParsedCorner *corner)
+{
+    for (AVD_UInt32 attribute = 0; corner->relativeMask != 0 && attribute < AVD_OBJ_ATTRIBUTE_COUNT; attribute++) {
+        if (corner->relativeMask & (1u << attribute)) {
+            AVD_Size relativeIndex = chunk->corners.count * AVD_OBJ_ATTRIBUTE_COUNT + attribute;
+            avdListPushBack(&chunk->relativeIndices, &relativeIndex);
+        }
+    }
+    avdListPushBack(&chunk->corners, &corner->corner);
+}
+
+// Polygons become fans around their first corner.
+static bool PRIV_avdObjParseFace(AVD_ObjChunk *chunk, const char *cursor, const char *end)
+{
+    AVD_ObjParsedCorner first    = {0};
+    AVD_ObjParsedCorner previous = {0};
+    AVD_ObjParsedCorner current  = {0};
+    AVD_Size cornerCount         = 0;
+    for (cursor = PRIV_avdObjSkipSpace(cursor, end); cursor < end; cursor = PRIV_avdObjSkipSpace(cursor, end)) {
+        cursor = PRIV_avdObjParseCorner(chunk, cursor, end, &current);
+        if (cursor == NULL) {
+            return PRIV_avdObjChunkFail(chunk, "invalid face corner");
+        }
+        if (cornerCount >= 2) {
+            PRIV_avdObjPushCorner(chunk, &first);
+            PRIV_avdObjPushCorner(chunk, &previous);
+            PRIV_avdObjPushCorner(chunk, &current);
+        }
+        first    = cornerCount == 0 ? current : first;
+        previous = current;
+        cornerCount++;
+    }
+    return true;
+}
+
+static void PRIV_avdObjParseObject(AVD_ObjChunk *chunk, const char *cursor, const char *end)
+{
+    cursor = PRIV_avdObjSkipSpace(cursor, end);
+    while (end > cursor && (end[-1] == ' ' || end[-1] == '\t')) {
+        end--;
+    }
+
+    AVD_ObjObject *object = (AVD_ObjObject *)avdListAddEmpty(&chunk->objects);
+    object->firstTriangle = chunk->corners.count / 3;
+    snprintf(object->name, sizeof(object->name), "%.*s", (int)AVD_MIN((AVD_Size)(end - cursor), sizeof(object->name) - 1), cursor);
+}
+
+static bool PRIV_avdObjParseLine(AVD_ObjChunk *chunk, const char *cursor, const char *end)
+{
+    cursor = PRIV_avdObjSkipSpace(cursor, end);
+    if (end - cursor < 2) {
+        return true;
+    }
+
+    // every keyword is followed by white space
+    char keyword       = cursor[0];
+    char second        = cursor[1];
+    bool shortKeyword  = second == ' ' || second == '\t';
+    bool longKeyword   = end - cursor >= 3 && (cursor[2] == ' ' || cursor[2] == '\t');
+    AVD_Float value[3] = {0};
+    if (keyword == 'v' && shortKeyword) {
+        return PRIV_avdObjParseFloats(chunk, cursor + 2, end, value, 3, 3) && avdListPushBack(&chunk->positions, value) != NULL;
+    }
+    if (keyword == 'v' && second == 't' && longKeyword) {
+        return PRIV_avdObjParseFloats(chunk, cursor + 3, end, value, 1, 2) && avdListPushBack(&chunk->texCoords, value) != NULL;
+    }
+    if (keyword == 'v' && second == 'n' && longKeyword) {
+        return PRIV_avdObjParseFloats(chunk, cursor + 3, end, value, 3, 3) && avdListPushBack(&chunk->normals, value) != NULL;
+    }
+    if (keyword == 'f' && shortKeyword) {
+        return PRIV_avdObjParseFace(chunk, cursor + 2, end);
+    }
+    if ((keyword == 'o' || keyword == 'g') && shortKeyword) {
+        PRIV_avdObjParseObject(chunk, cursor + 2, end);
+    }
+    return true;
+}
+
+static void PRIV_avdObjParseChunk(AVD_Size begin, AVD_Size end, void *userData)
+{
+    AVD_ObjParser *parser = (AVD_ObjParser *)userData;
+    for (AVD_Size i = begin; i < end; i++) {
+        AVD_ObjChunk *chunk = &parser->chunks[i];
+        for (const char *line = chunk->begin; line < chunk->end && chunk->error == NULL;) {
+            const char *lineEnd = (const char *)memchr(line, '\n', (AVD_Size)(chunk->end - line));
+            const char *next    = lineEnd != NULL ? lineEnd + 1 : chunk->end;
+            lineEnd             = lineEnd != NULL ? lineEnd : chunk->end;
+            if (lineEnd > line && lineEnd[-1] == '\r') {
+                lineEnd--;
+            }
+            chunk->lineCount++;
+            PRIV_avdObjParseLine(chunk, line, lineEnd);
+            line = next;
+        }
+    }
+}
+
+static void PRIV_avdObjStoreChunk(AVD_Size begin, AVD_Size end, void *userData)
+{
+    AVD_ObjParser *parser = (AVD_ObjParser *)userData;
+    AVD_ObjData *data     = parser->data;
+    for (AVD_Size i = begin; i < end; i++) {
+        AVD_ObjChunk *chunk = &parser->chunks[i];
+        memcpy((AVD_Vector3 *)data->positions.items + chunk->positionOffset, chunk->positions.items, sizeof(AVD_Vector3) * chunk->positions.count);
+        memcpy((AVD_Vector2 *)data->texCoords.items + chunk->texCoordOffset, chunk->texCoords.items, sizeof(AVD_Vector2) * chunk->texCoords.count);
+        memcpy((AVD_Vector3 *)data->normals.items + chunk->normalOffset, chunk->normals.items, sizeof(AVD_Vector3) * chunk->normals.count);
+
+        AVD_ObjCorner *corners = (AVD_ObjCorner *)data->corners.items + chunk->cornerOffset;
+        memcpy(corners, chunk->corners.items, sizeof(AVD_ObjCorner) * chunk->corners.count);
+
+        AVD_Size attributeOffsets[] = {chunk->positionOffset, chunk->texCoordOffset, chunk->normalOffset};
+        bool relativeInRange        = true;
+        for (AVD_Size j = 0; j < chunk->relativeIndices.count; j++) {
+            AVD_Size relativeIndex = *(const AVD_Size *)avdListGet(&chunk->relativeIndices, j);
+            AVD_Int32 *index       = PRIV_avdObjCornerIndex(&corners[relativeIndex / AVD_OBJ_ATTRIBUTE_COUNT], relativeIndex % AVD_OBJ_ATTRIBUTE_COUNT);
+            *index += (AVD_Int32)attributeOffsets[relativeIndex % AVD_OBJ_ATTRIBUTE_COUNT];
+            relativeInRange = relativeInRange && *index >= 0;
+        }
+
+        AVD_Int32 positionCount = (AVD_Int32)data->positions.count;
+        AVD_Int32 texCoordCount = (AVD_Int32)data->texCoords.count;
+        AVD_Int32 normalCount   = (AVD_Int32)data->normals.count;
+        bool inRange            = relativeInRange;
+        for (AVD_Size j = 0; j < chunk->corners.count; j++) {
+            const AVD_ObjCorner *corner = &corners[j];
+            inRange                     = inRange && corner->position >= 0 && corner->position < positionCount;
+            inRange                     = inRange && corner->texCoord >= -1 && corner->texCoord < texCoordCount;
+            inRange                     = inRange && corner->normal >= -1 && corner->normal < normalCount;
+        }
+        if (!inRange && chunk->error == NULL) {
+            chunk->error     = "a face references an attribute that is not in the file";
+            chunk->errorLine = 0;
+        }
+    }
+}
+
+static void PRIV_avdObjAddObject(AVD_ObjData *data, AVD_ObjObject *object, AVD_Size endTriangle)
+{
+    object->triangleCount = endTriangle - object->firstTriangle;
+    if (object->triangleCount > 0) {
+        avdListPushBack(&data->objects, object);
+    }
+}
+
+bool avdObjDataCreate(AVD_ObjData *data)
+{
+    AVD_ASSERT(data != NULL);
+
+    memset(data, 0, sizeof(AVD_ObjData));
+    avdListCreate(&data->positions, sizeof(AVD_Vector3));
+    avdListCreate(&data->texCoords, sizeof(AVD_Vector2));
+    avdListCreate(&data->normals, sizeof(AVD_Vector3));
+    avdListCreate(&data->corners, sizeof(AVD_ObjCorner));
+    avdListCreate(&data->objects, sizeof(AVD_ObjObject));
+    return true;
+}
+
+void avdObjDataDestroy(AVD_ObjData *data)
+{
+    AVD_ASSERT(data != NULL);
+
+    avdListDestroy(&data->positions);
+    avdListDestroy(&data->texCoords);
+    avdListDestroy(&data->normals);
+    avdListDestroy(&data->corners);
+    avdListDestroy(&data->objects);
+}
+
+static void PRIV_avdObjChunksDestroy(AVD_ObjChunk *chunks, AVD_Size chunkCount)
+{
+    for (AVD_Size i = 0; i < chunkCount; i++) {
+        avdListDestroy(&chunks[i].positions);
+        avdListDestroy(&chunks[i].texCoords);
+        avdListDestroy(&chunks[i].normals);
+        avdListDestroy(&chunks[i].corners);
+        avdListDestroy(&chunks[i].objects);
+        avdListDestroy(&chunks[i].relativeIndices);
+    }
+    AVD_FREE(chunks);
+}
+
+static bool PRIV_avdObjReportError(const AVD_ObjChunk *chunks, AVD_Size chunkCount)
+{
+    AVD_Size line = 0;
+    for (AVD_Size i = 0; i < chunkCount; i++) {
+        if (chunks[i].error != NULL) {
+            if (chunks[i].errorLine > 0) {
+                AVD_LOG_ERROR("Failed to parse OBJ line %zu: %s", line + chunks[i].errorLine, chunks[i].error);
+            } else {
+                AVD_LOG_ERROR("Failed to parse OBJ lines %zu to %zu: %s", line + 1, line + chunks[i].lineCount, chunks[i].error);
+            }
+            return false;
+        }
+        line += chunks[i].lineCount;
+    }
+    return true;
+}
+
+bool avdObjParse(const char *text, AVD_Size size, AVD_ObjData *data)
+{
+    AVD_ASSERT(text != NULL || size == 0);
+    AVD_ASSERT(data != NULL);
+    AVD_ASSERT(data->positions.count == 0 && data->corners.count == 0);
+
+    AVD_Size threadCount = (AVD_Size)(avdJobsIsInitialized() ? avdJobsWorkerCount() + 1 : 1);
+    AVD_Size chunkCount  = AVD_MIN(AVD_MIN(size / AVD_OBJ_PARSER_MIN_CHUNK_SIZE, threadCount * 4), (AVD_Size)AVD_OBJ_PARSER_MAX_CHUNKS);
+    chunkCount           = AVD_MAX(chunkCount, (AVD_Size)1);
+
+    AVD_ObjChunk *chunks = (AVD_ObjChunk *)AVD_MALLOC(sizeof(AVD_ObjChunk) * chunkCount);
+    AVD_CHECK_MSG(chunks != NULL, "Failed to allocate %zu OBJ chunks", chunkCount);
+    memset(chunks, 0, sizeof(AVD_ObjChunk) * chunkCount);
+
+    // every chunk but the first starts after the line break past its share
+    const char *end = text + size;
+    for (AVD_Size i = 0; i < chunkCount; i++) {
+        AVD_ObjChunk *chunk = &chunks[i];
+        chunk->begin        = i == 0 ? text : chunks[i - 1].end;
+        chunk->end          = end;
+        if (i + 1 < chunkCount) {
+            const char *split     = AVD_MAX(text + size * (i + 1) / chunkCount, chunk->begin);
+            const char *lineBreak = (const char *)memchr(split, '\n', (AVD_Size)(end - split));
+            chunk->end            = lineBreak != NULL ? lineBreak + 1 : end;
+        }
+        avdListCreate(&chunk->positions, sizeof(AVD_Vector3));
+        avdListCreate(&chunk->texCoords, sizeof(AVD_Vector2));
+        avdListCreate(&chunk->normals, sizeof(AVD_Vector3));
+        avdListCreate(&chunk->corners, sizeof(AVD_ObjCorner));
+        avdListCreate(&chunk->objects, sizeof(AVD_ObjObject));
+        avdListCreate(&chunk->relativeIndices, sizeof(AVD_Size));
+    }
+
+    AVD_ObjParser parser = {.chunks = chunks, .data = data};
+    avdJobsParallelFor(chunkCount, 1, PRIV_avdObjParseChunk, &parser);
+    if (!PRIV_avdObjReportError(chunks, chunkCount)) {
+        PRIV_avdObjChunksDestroy(chunks, chunkCount);
+        return false;
+    }
+
+    AVD_Size positionCount = 0;
+    AVD_Size texCoordCount = 0;
+    AVD_Size normalCount   = 0;
+    AVD_Size cornerCount   = 0;
+    AVD_Size lineCount     = 0;
+    for (AVD_Size i = 0; i < chunkCount; i++) {
+        chunks[i].positionOffset = positionCount;
+        chunks[i].texCoordOffset = texCoordCount;
+        chunks[i].normalOffset   = normalCount;
+        chunks[i].cornerOffset   = cornerCount;
+        positionCount += chunks[i].positions.count;
+        texCoordCount += chunks[i].texCoords.count;
+        normalCount += chunks[i].normals.count;
+        cornerCount += chunks[i].corners.count;
+        lineCount += chunks[i].lineCount;
+    }
+
+    // objects can span chunks, they end where the next one starts
+    AVD_ObjObject object = {0};
+    for (AVD_Size i = 0; i < chunkCount; i++) {
+        for (AVD_Size j = 0; j < chunks[i].objects.count; j++) {
+            const AVD_ObjObject *next = (const AVD_ObjObject *)avdListGet(&chunks[i].objects, j);
+            AVD_Size firstTriangle    = chunks[i].cornerOffset / 3 + next->firstTriangle;
+            PRIV_avdObjAddObject(data, &object, firstTriangle);
+            object               = *next;
+            object.firstTriangle = firstTriangle;
+        }
+    }
+    PRIV_avdObjAddObject(data, &object, cornerCount / 3);
+
+    avdListResize(&data->positions, positionCount);
+    avdListResize(&data->texCoords, texCoordCount);
+    avdListResize(&data->normals, normalCount);
+    avdListResize(&data->corners, cornerCount);
+    avdJobsParallelFor(chunkCount, 1, PRIV_avdObjStoreChunk, &parser);
+    data->lineCount  = lineCount;
+    data->chunkCount = chunkCount;
+
+    bool ok = PRIV_avdObjReportError(chunks, chunkCount);
+    PRIV_avdObjChunksDestroy(chunks, chunkCount);
+    return ok;
+}
+
+bool avdObjParseFile(const char *filename, AVD_ObjData *data)
+{
+    AVD_ASSERT(filename != NULL);
+    AVD_ASSERT(data != NULL);
+
+    AVD_FileView *view = NULL;
+    AVD_CHECK_MSG(avdPathExists(filename), "The specified OBJ file does not exist: %s", filename);
+    AVD_CHECK_MSG(avdFileViewOpen(filename, AVD_FILE_VIEW_FLAG_SEQUENTIAL | AVD_FILE_VIEW_FLAG_WILL_NEED, &view), "Failed to open OBJ file: %s", filename);
+    bool ok = avdObjParse((const char *)view->data, view->size, data);
+    avdFileViewRelease(view);
+    AVD_CHECK_MSG(ok, "Failed to parse OBJ file: %s", filename);
+    return true;
+}
+
+const char *avdObjParserBackendName(void)
+{
+    if (!PRIV_avdObjParserSimdEnabled) {
+        return "scalar";
+    }
+#if defined(AVD_OBJ_PARSER_SSE2)
+    return "sse2";
+#elif defined(AVD_OBJ_PARSER_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+void avdObjParserSetSimdEnabled(bool enabled)
+{
+    PRIV_avdObjParserSimdEnabled = enabled;
+}
@@ -0,0 +1,359 @@
+#include "core/avd_core.h"
+#include "model/avd_3d_scene.h"
+
+#include <stdarg.h>
+
+// Workers for the tests that parse in chunks, the same as for the BVH tests.
+#define AVD_OBJ_PARSER_TEST_WORKERS 4
+
+static void PRIV_avdObjTestAppend(AVD_List *text, const char *format, ...)
+{
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    memcpy(avdListAddEmptyN(text, (AVD_Size)length), line, (AVD_Size)length);
+}
+
+static AVD_UInt32 PRIV_avdObjTestRandom(AVD_UInt32 *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+static bool PRIV_avdObjTestFloat(const char *text, bool simd)
+{
+    avdObjParserSetSimdEnabled(simd);
+    AVD_Float value    = 0.0f;
+    AVD_Size length    = strlen(text);
+    const char *end    = avdObjParseFloat(text, text + length, &value);
+    char *expectedEnd  = NULL;
+    AVD_Float expected = strtof(text, &expectedEnd);
+    bool sameValue     = memcmp(&value, &expected, sizeof(AVD_Float)) == 0 || (isnan(value) && isnan(expected));
+    bool sameEnd       = end == NULL ? expectedEnd == text : end == expectedEnd;
+    avdObjParserSetSimdEnabled(true);
+
+    AVD_CHECK_MSG(sameValue && sameEnd, "Parsing '%s' with the %s scanner gave %.9g instead of %.9g", text, simd ? "simd" : "scalar", value, expected);
+    return true;
+}
+
+static bool PRIV_avdObjTestFloats(void)
+{
+    AVD_LOG_DEBUG("  Testing OBJ float parsing with the %s scanner...", avdObjParserBackendName());
+
+    static const char *cases[] = {
+        "0", "-0", "1", "-1.5", "+2.25", ".5", "1.", "-.125e2", "1e", "1e+", "3.402823466e38", "1.17549435e-38",
+        "0.000000000000000000000000000001", "3.14159265358979323846264338327950288", "123456789012345678901234567890",
+        "0.1", "0.30000001192092896", "-98765.4321", "1E5", "7e-3", "12345678.9", "1234567890123456789", "00000000000000000000001.5",
+        "0.00000000000000000000000000000000000000000000140129846", "nan", "-inf", "1.5/2", "x", "-", "16777217", "9007199254740993",
+        "0.1234567890123456789012345678901234567890", "1.0000000596046447755", "16777216.5", "0.30000000447034836",
+    };
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(cases); i++) {
+        AVD_CHECK(PRIV_avdObjTestFloat(cases[i], true));
+        AVD_CHECK(PRIV_avdObjTestFloat(cases[i], false));
+    }
+
+    AVD_UInt32 state = 0x0b1ec7u;
+    for (AVD_Size i = 0; i < 20000; i++) {
+        char text[64];
+        AVD_Float value = ((AVD_Float)PRIV_avdObjTestRandom(&state) / 16777216.0f - 0.5f) * powf(10.0f, (AVD_Float)(PRIV_avdObjTestRandom(&state) % 24) - 12.0f);
+        snprintf(text, sizeof(text), i % 3 == 0 ? "%.9g" : (i % 3 == 1 ? "%f" : "%.6e"), value);
+        AVD_CHECK(PRIV_avdObjTestFloat(text, true));
+        AVD_CHECK(PRIV_avdObjTestFloat(text, false));
+    }
+    return true;
+}
+
+static bool PRIV_avdObjTestCorner(const AVD_ObjData *data, AVD_Size index, AVD_Int32 position, AVD_Int32 texCoord, AVD_Int32 normal)
+{
+    const AVD_ObjCorner *corner = (const AVD_ObjCorner *)avdListGet(&data->corners, index);
+    AVD_CHECK_MSG(
+        corner != NULL && corner->position == position && corner->texCoord == texCoord && corner->normal == normal,
+        "OBJ corner %zu is not %d/%d/%d",
+        index,
+        position,
+        texCoord,
+        normal);
+    return true;
+}
+
+static bool PRIV_avdObjTestSmallFile(void)
+{
+    static const char text[] =
+        "# comment\r\n"
+        "mtllib test.mtl\r\n"
+        "v 0 0 0\r\n"
+        "v 1 0 0\n"
+        "  v\t1 1 0 1.0\n"
+        "v 0 1 0\n"
+        "vt 0.5\n"
+        "vt 0.25 0.75 0\n"
+        "vn 0 0 1\n"
+        "f 1 2 3\n"
+        "o  Quad \n"
+        "usemtl none\n"
+        "s off\n"
+        "f 1/1/1 2/2/1 3/1/1 4/2/1\n"
+        "g Empty\n"
+        "g Relative\n"
+        "f -4//-1 -3//-1 -2//-1\n"
+        "l 1 2\n"
+        "f 1 2";
+
+    AVD_ObjData data = {0};
+    AVD_CHECK(avdObjDataCreate(&data));
+    bool ok = avdObjParse(text, sizeof(text) - 1, &data);
+    ok      = ok && data.lineCount == 19 && data.positions.count == 4 && data.texCoords.count == 2 && data.normals.count == 1;
+    ok      = ok && data.corners.count == 12 && data.objects.count == 3;
+    ok      = ok && ((const AVD_Vector3 *)avdListGet(&data.positions, 2))->y == 1.0f;
+    ok      = ok && ((const AVD_Vector2 *)avdListGet(&data.texCoords, 0))->y == 0.0f;
+    ok      = ok && ((const AVD_Vector2 *)avdListGet(&data.texCoords, 1))->y == 0.75f;
+
+    // the quad is a fan around its first corner
+    ok = ok && PRIV_avdObjTestCorner(&data, 0, 0, -1, -1) && PRIV_avdObjTestCorner(&data, 2, 2, -1, -1);
+    ok = ok && PRIV_avdObjTestCorner(&data, 3, 0, 0, 0) && PRIV_avdObjTestCorner(&data, 4, 1, 1, 0) && PRIV_avdObjTestCorner(&data, 5, 2, 0, 0);
+    ok = ok && PRIV_avdObjTestCorner(&data, 6, 0, 0, 0) && PRIV_avdObjTestCorner(&data, 7, 2, 0, 0) && PRIV_avdObjTestCorner(&data, 8, 3, 1, 0);
+    ok = ok && PRIV_avdObjTestCorner(&data, 9, 0, -1, 0) && PRIV_avdObjTestCorner(&data, 11, 2, -1, 0);
+
+    const char *names[]       = {"", "Quad", "Relative"};
+    AVD_Size firstTriangles[] = {0, 1, 3};
+    AVD_Size triangleCounts[] = {1, 2, 1};
+    for (AVD_Size i = 0; ok && i < data.objects.count; i++) {
+        const AVD_ObjObject *object = (const AVD_ObjObject *)avdListGet(&data.objects, i);
+        ok                          = strcmp(object->name, names[i]) == 0 && object->firstTriangle == firstTriangles[i] && object->triangleCount == triangleCounts[i];
+    }
+    avdObjDataDestroy(&data);
+
+    AVD_CHECK_MSG(ok, "The small OBJ file was not parsed as expected");
+    return true;
+}
+
+static bool PRIV_avdObjTestInvalid(void)
+{
+    static const char *cases[] = {
+        "v 0 0 0\nf 1 2 3\n",
+        "v 0 0 0\nv 0 0 0\nv 0 0 0\nf 1/1 2/1 3/1\n",
+        "v 0 0 0\nv 0 0 0\nv 0 0 0\nf 0 1 2\n",
+        "v 0 0 0\nv 0 0 0\nf -3 -2 -1\n",
+        "v 0 0\n",
+        "v 0 0 0\nv 0 0 0\nv 0 0 0\nf 1 2 3x\n",
+    };
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(cases); i++) {
+        AVD_ObjData data = {0};
+        AVD_CHECK(avdObjDataCreate(&data));
+        bool parsed = avdObjParse(cases[i], strlen(cases[i]), &data);
+        avdObjDataDestroy(&data);
+        AVD_CHECK_MSG(!parsed, "The invalid OBJ file %zu was parsed", i);
+    }
+    return true;
+}
+
+typedef struct {
+    AVD_List text;
+    AVD_Size size; // vertices per side
+    AVD_Size rowsPerObject;
+} AVD_ObjTestGrid;
+
+// A grid of quads with every attribute, faces use relative indices on every
+// other row and objects start every few rows, so chunk boundaries land in the
+// middle of both.
+static bool PRIV_avdObjTestGridCreate(AVD_ObjTestGrid *grid, AVD_Size size, AVD_Size rowsPerObject)
+{
+    memset(grid, 0, sizeof(AVD_ObjTestGrid));
+    grid->size          = size;
+    grid->rowsPerObject = rowsPerObject;
+    avdListCreate(&grid->text, sizeof(char));
+    avdListEnsureCapacity(&grid->text, size * size * 96);
+
+    for (AVD_Size y = 0; y < size; y++) {
+        for (AVD_Size x = 0; x < size; x++) {
+            PRIV_avdObjTestAppend(&grid->text, "v %f %f %.4f\nvt %f %f\nvn 0 0 1\n", (double)x * 0.125, (double)y * -0.5, (double)(x * y % 97) * 0.01, (double)x / (double)size, (double)y / (double)size);
+        }
+        if (y == 0) {
+            continue;
+        }
+        if ((y - 1) % rowsPerObject == 0) {
+            PRIV_avdObjTestAppend(&grid->text, "o Rows%zu\n", y - 1);
+        }
+        for (AVD_Size x = 0; x + 1 < size; x++) {
+            AVD_Size a = (y - 1) * size + x + 1;
+            AVD_Size b = y * size + x + 1;
+            if (y % 2 == 0) {
+                PRIV_avdObjTestAppend(&grid->text, "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", a, a, a, a + 1, a + 1, a + 1, b + 1, b + 1, b + 1, b, b, b);
+            } else {
+                // counted back from the last vertex of row y
+                AVD_Int64 last = (AVD_Int64)((y + 1) * size);
+                AVD_Int64 ra   = (AVD_Int64)a - last - 1;
+                AVD_Int64 rb   = (AVD_Int64)b - last - 1;
+                PRIV_avdObjTestAppend(&grid->text, "f %lld/%lld/%lld %lld/%lld/%lld %lld/%lld/%lld %lld/%lld/%lld\n", ra, ra, ra, ra + 1, ra + 1, ra + 1, rb + 1, rb + 1, rb + 1, rb, rb, rb);
+            }
+        }
+    }
+    return true;
+}
+
+static bool PRIV_avdObjTestGridCheck(const AVD_ObjTestGrid *grid, const AVD_ObjData *data)
+{
+    AVD_Size size = grid->size;
+    AVD_CHECK(data->positions.count == size * size && data->texCoords.count == size * size && data->normals.count == size * size);
+    AVD_CHECK(data->corners.count == (size - 1) * (size - 1) * 6);
+    AVD_CHECK(data->objects.count == (size - 2) / grid->rowsPerObject + 1);
+
+    for (AVD_Size i = 0; i < data->positions.count; i++) {
+        const AVD_Vector3 *position = (const AVD_Vector3 *)avdListGet(&data->positions, i);
+        char expected[64];
+        snprintf(expected, sizeof(expected), "%.4f", (double)((i % size) * (i / size) % 97) * 0.01);
+        AVD_CHECK(position->x == (AVD_Float)(i % size) * 0.125f && position->y == (AVD_Float)(i / size) * -0.5f && position->z == strtof(expected, NULL));
+    }
+    for (AVD_Size y = 1; y < size; y++) {
+        for (AVD_Size x = 0; x + 1 < size; x++) {
+            AVD_Int32 a     = (AVD_Int32)((y - 1) * size + x);
+            AVD_Int32 b     = (AVD_Int32)(y * size + x);
+            AVD_Size corner = ((y - 1) * (size - 1) + x) * 6;
+            AVD_CHECK(PRIV_avdObjTestCorner(data, corner + 0, a, a, a) && PRIV_avdObjTestCorner(data, corner + 1, a + 1, a + 1, a + 1));
+            AVD_CHECK(PRIV_avdObjTestCorner(data, corner + 2, b + 1, b + 1, b + 1) && PRIV_avdObjTestCorner(data, corner + 5, b, b, b));
+        }
+    }
+    for (AVD_Size i = 0; i < data->objects.count; i++) {
+        const AVD_ObjObject *object = (const AVD_ObjObject *)avdListGet(&data->objects, i);
+        AVD_Size rows               = AVD_MIN(grid->rowsPerObject, size - 1 - i * grid->rowsPerObject);
+        char name[32];
+        snprintf(name, sizeof(name), "Rows%zu", i * grid->rowsPerObject);
+        AVD_CHECK(strcmp(object->name, name) == 0 && object->firstTriangle == i * grid->rowsPerObject * (size - 1) * 2 && object->triangleCount == rows * (size - 1) * 2);
+    }
+    return true;
+}
+
+static bool PRIV_avdObjTestChunks(void)
+{
+    AVD_ObjTestGrid grid = {0};
+    AVD_CHECK(PRIV_avdObjTestGridCreate(&grid, 384, 7));
+
+    bool ownsJobSystem = !avdJobsIsInitialized();
+    bool ok            = !ownsJobSystem || avdJobsInit(AVD_OBJ_PARSER_TEST_WORKERS);
+    AVD_ObjData data   = {0};
+    ok                 = ok && avdObjDataCreate(&data) && avdObjParse((const char *)grid.text.items, grid.text.count, &data);
+    ok                 = ok && data.chunkCount > 1 && PRIV_avdObjTestGridCheck(&grid, &data);
+    if (ownsJobSystem && avdJobsIsInitialized()) {
+        avdJobsShutdown();
+    }
+
+    avdObjDataDestroy(&data);
+    avdListDestroy(&grid.text);
+    AVD_CHECK_MSG(ok, "The OBJ grid parsed in chunks differs from the one written");
+    return true;
+}
+
+static bool PRIV_avdObjTestLoad(void)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), "%savd_obj_parser_test.obj", avdGetTempDirPath());
+    static const char text[] =
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvn 0 0 1\n"
+        "o First\nf 1//1 2//1 3//1 4//1\n"
+        "o Second\nf 1//1 3//1 4//1\n";
+    AVD_CHECK(avdWriteBinaryFile(path, text, sizeof(text) - 1));
+
+    AVD_Model model              = {0};
+    AVD_ModelResources resources = {0};
+    AVD_ModelCache cache         = {0};
+    AVD_CHECK(avdModelCreate(&model, 0));
+    AVD_CHECK(avdModelResourcesCreate(&resources));
+    if (avdModelCacheBegin(&cache, path, "obj", AVD_OBJ_LOAD_FLAG_NONE, &resources)) {
+        remove(cache.path);
+    }
+
+    bool ok = avdModelLoadObj(path, &model, &resources, AVD_OBJ_LOAD_FLAG_NONE) && model.meshes.count == 2;
+    ok      = ok && resources.verticesList.count == 7 && resources.indicesList.count == 9;
+    for (AVD_Size i = 0; ok && i < model.meshes.count; i++) {
+        const AVD_Mesh *mesh = (const AVD_Mesh *)avdListGet(&model.meshes, i);
+        ok                   = mesh->triangleCount == (i == 0 ? 2 : 1) && mesh->indexOffset == (i == 0 ? 0 : 6);
+        ok                   = ok && strstr(mesh->name, i == 0 ? "/First" : "/Second") != NULL;
+    }
+
+    avdModelResourcesDestroy(&resources);
+    avdModelDestroy(&model);
+    remove(cache.path);
+    remove(path);
+    AVD_CHECK_MSG(ok, "The OBJ file was not loaded as expected");
+    return true;
+}
+
+bool avdModelObjParserTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Model OBJ Parser Tests...");
+
+    AVD_CHECK(PRIV_avdObjTestFloats());
+    AVD_CHECK(PRIV_avdObjTestSmallFile());
+    AVD_CHECK(PRIV_avdObjTestInvalid());
+    AVD_CHECK(PRIV_avdObjTestChunks());
+    AVD_CHECK(PRIV_avdObjTestLoad());
+
+    AVD_LOG_DEBUG("All AVD Model OBJ Parser Tests PASSED");
+    return true;
+}
+
+typedef struct {
+    AVD_ObjTestGrid grid;
+    bool simd;
+} AVD_ObjParserBenchmark;
+
+static void PRIV_avdObjParserBenchmarkParse(void *userData)
+{
+    AVD_ObjParserBenchmark *benchmark = (AVD_ObjParserBenchmark *)userData;
+    AVD_ObjData data                  = {0};
+    avdObjParserSetSimdEnabled(benchmark->simd);
+    avdObjDataCreate(&data);
+    avdObjParse((const char *)benchmark->grid.text.items, benchmark->grid.text.count, &data);
+    avdObjDataDestroy(&data);
+}
+
+bool avdModelObjParserBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD Model OBJ Parser benchmarks (%s backend)...", avdObjParserBackendName());
+
+    char names[3][AVD_BENCH_NAME_LENGTH];
+    snprintf(names[0], AVD_BENCH_NAME_LENGTH, "obj/parse_grid_512k/scalar/threads_1");
+    snprintf(names[1], AVD_BENCH_NAME_LENGTH, "obj/parse_grid_512k/%s/threads_1", avdObjParserBackendName());
+    snprintf(names[2], AVD_BENCH_NAME_LENGTH, "obj/parse_grid_512k/%s/threads_%u", avdObjParserBackendName(), avdJobsHardwareThreadCount());
+
+    // writing the text is slow, skip it when none of the cases run
+    bool selected = false;
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(names); i++) {
+        selected = selected || avdBenchIsSelected(bench, names[i]);
+    }
+    if (!selected) {
+        return true;
+    }
+
+    // about 30 MiB of text, 512k triangles
+    AVD_ObjParserBenchmark benchmark = {0};
+    AVD_CHECK(PRIV_avdObjTestGridCreate(&benchmark.grid, 512, 16));
+
+    // only the last case runs with the job system, one worker per core
+    AVD_CHECK_MSG(!avdJobsIsInitialized(), "OBJ parser benchmarks need to start the job system themselves");
+    bool ok = true;
+    for (AVD_Size i = 0; ok && i < AVD_ARRAY_COUNT(names); i++) {
+        benchmark.simd = i > 0;
+        if (i == 2) {
+            ok = avdJobsInit(0);
+        }
+        AVD_BenchCase parseCase = {
+            .name               = names[i],
+            .unit               = "bytes",
+            .itemsPerRepetition = benchmark.grid.text.count,
+            .run                = PRIV_avdObjParserBenchmarkParse,
+            .userData           = &benchmark,
+        };
+        ok = ok && avdBenchRun(bench, &parseCase);
+        if (i == 2 && avdJobsIsInitialized()) {
+            avdJobsShutdown();
+        }
+    }
+    avdObjParserSetSimdEnabled(true);
+
+    avdListDestroy(&benchmark.grid.text);
+    return ok;
+}
@@ -0,0 +1,485 @@
+#include "model/avd_model_optimizer.h"
+
+#define AVD_MESH_OPTIMIZER_NO_VERTEX UINT32_MAX
+
+typedef struct {
+    AVD_Float key;
+    AVD_UInt32 firstTriangle;
+    AVD_UInt32 triangleCount;
+} AVD_MeshOptimizerCluster;
+
+// A vertex is in the FIFO while fewer than cacheSize other vertices were
+// transformed after it, so only the time of its last transform is tracked.
+static bool PRIV_avdMeshOptimizerCacheMiss(AVD_UInt32 *cacheTimes, AVD_UInt32 *time, AVD_UInt32 cacheSize, AVD_UInt32 vertex)
+{
+    if (*time - cacheTimes[vertex] > cacheSize) {
+        cacheTimes[vertex] = (*time)++;
+        return true;
+    }
+    return false;
+}
+
+bool avdMeshAnalyzeVertexCache(const AVD_UInt32 *indices, AVD_Size indexCount, AVD_Size vertexCount, AVD_UInt32 cacheSize, AVD_MeshCacheStats *outStats)
+{
+    AVD_ASSERT(indices != NULL || indexCount == 0);
+    AVD_ASSERT(outStats != NULL);
+    AVD_ASSERT(indexCount % 3 == 0);
+
+    memset(outStats, 0, sizeof(AVD_MeshCacheStats));
+    outStats->triangleCount = indexCount / 3;
+    if (indexCount == 0) {
+        return true;
+    }
+
+    AVD_UInt32 *cacheTimes = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * vertexCount);
+    AVD_CHECK_MSG(cacheTimes != NULL, "Failed to allocate the vertex cache simulation");
+    memset(cacheTimes, 0, sizeof(AVD_UInt32) * vertexCount);
+
+    AVD_UInt32 time = cacheSize + 1;
+    for (AVD_Size i = 0; i < indexCount; i++) {
+        AVD_ASSERT(indices[i] < vertexCount);
+        bool firstUse = cacheTimes[indices[i]] == 0;
+        if (PRIV_avdMeshOptimizerCacheMiss(cacheTimes, &time, cacheSize, indices[i])) {
+            outStats->transformCount++;
+            outStats->vertexCount += firstUse ? 1 : 0;
+        }
+    }
+
+    AVD_FREE(cacheTimes);
+    return true;
+}
+
+void avdMeshCacheStatsAdd(AVD_MeshCacheStats *total, const AVD_MeshCacheStats *stats)
+{
+    AVD_ASSERT(total != NULL);
+    AVD_ASSERT(stats != NULL);
+
+    total->triangleCount += stats->triangleCount;
+    total->vertexCount += stats->vertexCount;
+    total->transformCount += stats->transformCount;
+}
+
+// Next vertex to fan around, of the candidates that would still be in the cache
+// after emitting all of their triangles the one that has been there longest.
+static AVD_UInt32 PRIV_avdMeshOptimizerNextFanVertex(
+    const AVD_UInt32 *candidates,
+    AVD_Size candidateCount,
+    const AVD_UInt32 *liveTriangles,
+    const AVD_UInt32 *cacheTimes,
+    AVD_UInt32 time,
+    AVD_UInt32 cacheSize)
+{
+    AVD_UInt32 best        = AVD_MESH_OPTIMIZER_NO_VERTEX;
+    AVD_Int64 bestPriority = -1;
+    for (AVD_Size i = 0; i < candidateCount; i++) {
+        AVD_UInt32 vertex = candidates[i];
+        if (liveTriangles[vertex] == 0) {
+            continue;
+        }
+
+        AVD_Int64 priority = 0;
+        if (time - cacheTimes[vertex] + 2 * liveTriangles[vertex] <= cacheSize) {
+            priority = time - cacheTimes[vertex];
+        }
+        if (priority > bestPriority) {
+            bestPriority = priority;
+            best         = vertex;
+        }
+    }
+    return best;
+}
+
+bool avdMeshOptimizeVertexCache(AVD_UInt32 *outIndices, const AVD_UInt32 *indices, AVD_Size indexCount, AVD_Size vertexCount, AVD_UInt32 cacheSize)
+{
+    AVD_ASSERT(outIndices != NULL || indexCount == 0);
+    AVD_ASSERT(indices != NULL || indexCount == 0);
+    AVD_ASSERT(outIndices != indices || indexCount == 0);
+    AVD_ASSERT(indexCount % 3 == 0);
+
+    if (indexCount == 0) {
+        return true;
+    }
+    AVD_CHECK_MSG(indexCount <= UINT32_MAX && vertexCount < UINT32_MAX, "Index buffer is too large to optimize");
+
+    AVD_Size triangleCount = indexCount / 3;
+
+    // one allocation for the vertex to triangle adjacency, the per vertex
+    // state, the dead end stack and the candidates of the current fan
+    AVD_Size wordCount  = (vertexCount + 1) + indexCount + vertexCount * 2 + indexCount * 2;
+    AVD_UInt32 *storage = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * wordCount + triangleCount);
+    AVD_CHECK_MSG(storage != NULL, "Failed to allocate the vertex cache optimizer state");
+    memset(storage, 0, sizeof(AVD_UInt32) * wordCount + triangleCount);
+
+    AVD_UInt32 *adjacencyOffsets = storage;
+    AVD_UInt32 *adjacency        = adjacencyOffsets + vertexCount + 1;
+    AVD_UInt32 *liveTriangles    = adjacency + indexCount;
+    AVD_UInt32 *cacheTimes       = liveTriangles + vertexCount;
+    AVD_UInt32 *deadEnds         = cacheTimes + vertexCount;
+    AVD_UInt32 *candidates       = deadEnds + indexCount;
+    AVD_UInt8 *emitted           = (AVD_UInt8 *)(candidates + indexCount);
+
+    for (AVD_Size i = 0; i < indexCount; i++) {
+        AVD_ASSERT(indices[i] < vertexCount);
+        liveTriangles[indices[i]]++;
+    }
+    // every offset starts at the end of its list and is moved back to the
+    // start while filling, back to front so the lists stay in triangle order
+    AVD_UInt32 adjacencyEnd = 0;
+    for (AVD_Size vertex = 0; vertex < vertexCount; vertex++) {
+        adjacencyEnd += liveTriangles[vertex];
+        adjacencyOffsets[vertex] = adjacencyEnd;
+    }
+    adjacencyOffsets[vertexCount] = adjacencyEnd;
+    for (AVD_Size i = indexCount; i-- > 0;) {
+        adjacency[--adjacencyOffsets[indices[i]]] = (AVD_UInt32)(i / 3);
+    }
+
+    AVD_UInt32 time       = cacheSize + 1;
+    AVD_Size deadEndCount = 0;
+    AVD_Size outputCount  = 0;
+    AVD_Size scanVertex   = 0;
+    AVD_UInt32 fanVertex  = indices[0];
+    while (fanVertex != AVD_MESH_OPTIMIZER_NO_VERTEX) {
+        AVD_Size candidateCount = 0;
+        for (AVD_UInt32 i = adjacencyOffsets[fanVertex]; i < adjacencyOffsets[fanVertex + 1]; i++) {
+            AVD_UInt32 triangle = adjacency[i];
+            if (emitted[triangle]) {
+                continue;
+            }
+            emitted[triangle] = 1;
+
+            for (AVD_UInt32 corner = 0; corner < 3; corner++) {
+                AVD_UInt32 vertex            = indices[triangle * 3 + corner];
+                outIndices[outputCount++]    = vertex;
+                deadEnds[deadEndCount++]     = vertex;
+                candidates[candidateCount++] = vertex;
+                liveTriangles[vertex]--;
+                PRIV_avdMeshOptimizerCacheMiss(cacheTimes, &time, cacheSize, vertex);
+            }
+        }
+
+        fanVertex = PRIV_avdMeshOptimizerNextFanVertex(candidates, candidateCount, liveTriangles, cacheTimes, time, cacheSize);
+
+        // dead end, go back to the most recent vertex with triangles left and
+        // only then to the first one in index order
+        while (fanVertex == AVD_MESH_OPTIMIZER_NO_VERTEX && deadEndCount > 0) {
+            AVD_UInt32 vertex = deadEnds[--deadEndCount];
+            if (liveTriangles[vertex] > 0) {
+                fanVertex = vertex;
+            }
+        }
+        while (fanVertex == AVD_MESH_OPTIMIZER_NO_VERTEX && scanVertex < vertexCount) {
+            if (liveTriangles[scanVertex] > 0) {
+                fanVertex = (AVD_UInt32)scanVertex;
+            }
+            scanVertex++;
+        }
+    }
+
+    AVD_ASSERT(outputCount == indexCount);
+    AVD_FREE(storage);
+    return true;
+}
+
+static int PRIV_avdMeshOptimizerCompareClusters(const void *a, const void *b)
+{
+    const AVD_MeshOptimizerCluster *clusterA = (const AVD_MeshOptimizerCluster *)a;
+    const AVD_MeshOptimizerCluster *clusterB = (const AVD_MeshOptimizerCluster *)b;
+
+    // outward facing first, ties keep the cache optimized order
+    if (clusterA->key != clusterB->key) {
+        return clusterA->key > clusterB->key ? -1 : 1;
+    }
+    return clusterA->firstTriangle < clusterB->firstTriangle ? -1 : 1;
+}
+
+// Area weighted centroid and the unnormalized normal (twice the area) of a triangle.
+static AVD_Vector3 PRIV_avdMeshOptimizerTriangle(const AVD_UInt32 *triangle, const AVD_Vector3 *positions, AVD_Vector3 *outCentroid)
+{
+    AVD_Vector3 a = positions[triangle[0]];
+    AVD_Vector3 b = positions[triangle[1]];
+    AVD_Vector3 c = positions[triangle[2]];
+
+    *outCentroid = avdVec3Scale(avdVec3Add(avdVec3Add(a, b), c), 1.0f / 3.0f);
+    return avdVec3Cross(avdVec3Subtract(b, a), avdVec3Subtract(c, a));
+}
+
+// Hard boundaries where the cache restarts, at every triangle that misses all
+// three vertices, and soft ones inside those wherever the ACMR since the last
+// cut is already within threshold of the ACMR of the whole hard cluster.
+static AVD_Size PRIV_avdMeshOptimizerClusters(
+    AVD_MeshOptimizerCluster *outClusters,
+    AVD_UInt32 *cacheTimes,
+    AVD_UInt8 *triangleMisses,
+    const AVD_UInt32 *indices,
+    AVD_Size triangleCount,
+    AVD_UInt32 cacheSize,
+    AVD_Float threshold)
+{
+    AVD_UInt32 time = cacheSize + 1;
+    for (AVD_Size triangle = 0; triangle < triangleCount; triangle++) {
+        AVD_UInt8 misses = 0;
+        for (AVD_UInt32 corner = 0; corner < 3; corner++) {
+            misses += PRIV_avdMeshOptimizerCacheMiss(cacheTimes, &time, cacheSize, indices[triangle * 3 + corner]) ? 1 : 0;
+        }
+        triangleMisses[triangle] = misses;
+    }
+
+    AVD_Size clusterCount = 0;
+    AVD_Size end          = 0;
+    for (AVD_Size first = 0; first < triangleCount; first = end) {
+        AVD_Size hardMisses = triangleMisses[first];
+        for (end = first + 1; end < triangleCount && triangleMisses[end] < 3; end++) {
+            hardMisses += triangleMisses[end];
+        }
+        AVD_Float limit = threshold * (AVD_Float)hardMisses / (AVD_Float)(end - first);
+
+        // the clusters are drawn in a different order afterwards, so each one
+        // is measured from a cold cache, moving the time on evicts everything
+        time += cacheSize + 1;
+        AVD_Size runStart  = first;
+        AVD_Size runMisses = 0;
+        for (AVD_Size triangle = first; triangle < end; triangle++) {
+            for (AVD_UInt32 corner = 0; corner < 3; corner++) {
+                runMisses += PRIV_avdMeshOptimizerCacheMiss(cacheTimes, &time, cacheSize, indices[triangle * 3 + corner]) ? 1 : 0;
+            }
+
+            AVD_Size runTriangles = triangle + 1 - runStart;
+            if (triangle + 1 == end || (AVD_Float)runMisses <= limit * (AVD_Float)runTriangles) {
+                outClusters[clusterCount].firstTriangle = (AVD_UInt32)runStart;
+                outClusters[clusterCount].triangleCount = (AVD_UInt32)runTriangles;
+                clusterCount++;
+
+                runStart  = triangle + 1;
+                runMisses = 0;
+                time += cacheSize + 1;
+            }
+        }
+    }
+    return clusterCount;
+}
+
+bool avdMeshOptimizeOverdraw(
+    AVD_UInt32 *outIndices,
+    const AVD_UInt32 *indices,
+    AVD_Size indexCount,
+    const AVD_Vector3 *positions,
+    AVD_Size vertexCount,
+    AVD_UInt32 cacheSize,
+    AVD_Float threshold)
+{
+    AVD_ASSERT(outIndices != NULL || indexCount == 0);
+    AVD_ASSERT(indices != NULL || indexCount == 0);
+    AVD_ASSERT(outIndices != indices || indexCount == 0);
+    AVD_ASSERT(positions != NULL || indexCount == 0);
+    AVD_ASSERT(indexCount % 3 == 0);
+
+    if (indexCount == 0) {
+        return true;
+    }
+
+    // the cache time moves on by cacheSize + 1 for every cluster
+    AVD_Size triangleCount = indexCount / 3;
+    AVD_CHECK_MSG((AVD_UInt64)triangleCount * (2 * (AVD_UInt64)cacheSize + 5) < UINT32_MAX, "Index buffer is too large to optimize");
+
+    AVD_Size storageSize = (sizeof(AVD_MeshOptimizerCluster) + 1) * triangleCount + sizeof(AVD_UInt32) * vertexCount;
+    AVD_UInt8 *storage   = (AVD_UInt8 *)AVD_MALLOC(storageSize);
+    AVD_CHECK_MSG(storage != NULL, "Failed to allocate the overdraw optimizer state");
+    memset(storage, 0, storageSize);
+
+    AVD_MeshOptimizerCluster *clusters = (AVD_MeshOptimizerCluster *)storage;
+    AVD_UInt32 *cacheTimes             = (AVD_UInt32 *)(clusters + triangleCount);
+    AVD_UInt8 *triangleMisses          = (AVD_UInt8 *)(cacheTimes + vertexCount);
+    AVD_Size clusterCount              = PRIV_avdMeshOptimizerClusters(clusters, cacheTimes, triangleMisses, indices, triangleCount, cacheSize, threshold);
+
+    AVD_Vector3 meshCentroid = avdVec3Zero();
+    AVD_Float meshArea       = 0.0f;
+    for (AVD_Size triangle = 0; triangle < triangleCount; triangle++) {
+        AVD_Vector3 centroid;
+        AVD_Float area = avdVec3Length(PRIV_avdMeshOptimizerTriangle(&indices[triangle * 3], positions, &centroid));
+        meshCentroid   = avdVec3Add(meshCentroid, avdVec3Scale(centroid, area));
+        meshArea += area;
+    }
+    meshCentroid = meshArea > 0.0f ? avdVec3Scale(meshCentroid, 1.0f / meshArea) : meshCentroid;
+
+    for (AVD_Size i = 0; i < clusterCount; i++) {
+        AVD_MeshOptimizerCluster *cluster = &clusters[i];
+        AVD_Vector3 clusterCentroid       = avdVec3Zero();
+        AVD_Vector3 clusterNormal         = avdVec3Zero();
+        AVD_Float clusterArea             = 0.0f;
+        for (AVD_Size triangle = cluster->firstTriangle; triangle < cluster->firstTriangle + cluster->triangleCount; triangle++) {
+            AVD_Vector3 centroid;
+            AVD_Vector3 normal = PRIV_avdMeshOptimizerTriangle(&indices[triangle * 3], positions, &centroid);
+            AVD_Float area     = avdVec3Length(normal);
+            clusterCentroid    = avdVec3Add(clusterCentroid, avdVec3Scale(centroid, area));
+            clusterNormal      = avdVec3Add(clusterNormal, normal);
+            clusterArea += area;
+        }
+
+        // degenerate clusters cover nothing, their place does not matter
+        if (clusterArea <= 0.0f || avdVec3LengthSq(clusterNormal) <= 0.0f) {
+            cluster->key = 0.0f;
+            continue;
+        }
+        clusterCentroid = avdVec3Scale(clusterCentroid, 1.0f / clusterArea);
+        cluster->key    = avdVec3Dot(avdVec3Subtract(clusterCentroid, meshCentroid), avdVec3Normalize(clusterNormal));
+    }
+
+    qsort(clusters, clusterCount, sizeof(AVD_MeshOptimizerCluster), PRIV_avdMeshOptimizerCompareClusters);
+
+    AVD_UInt32 *output = outIndices;
+    for (AVD_Size i = 0; i < clusterCount; i++) {
+        AVD_Size count = (AVD_Size)clusters[i].triangleCount * 3;
+        memcpy(output, &indices[(AVD_Size)clusters[i].firstTriangle * 3], sizeof(AVD_UInt32) * count);
+        output += count;
+    }
+
+    AVD_FREE(storage);
+    return true;
+}
+
+AVD_Size avdMeshOptimizeVertexFetchRemap(AVD_UInt32 *outRemap, const AVD_UInt32 *indices, AVD_Size indexCount, AVD_Size vertexCount)
+{
+    AVD_ASSERT(outRemap != NULL || vertexCount == 0);
+    AVD_ASSERT(indices != NULL || indexCount == 0);
+
+    for (AVD_Size vertex = 0; vertex < vertexCount; vertex++) {
+        outRemap[vertex] = AVD_MESH_OPTIMIZER_NO_VERTEX;
+    }
+
+    AVD_UInt32 nextVertex = 0;
+    for (AVD_Size i = 0; i < indexCount; i++) {
+        AVD_ASSERT(indices[i] < vertexCount);
+        if (outRemap[indices[i]] == AVD_MESH_OPTIMIZER_NO_VERTEX) {
+            outRemap[indices[i]] = nextVertex++;
+        }
+    }
+
+    AVD_Size referencedCount = nextVertex;
+    for (AVD_Size vertex = 0; vertex < vertexCount; vertex++) {
+        if (outRemap[vertex] == AVD_MESH_OPTIMIZER_NO_VERTEX) {
+            outRemap[vertex] = nextVertex++;
+        }
+    }
+    return referencedCount;
+}
+
+static AVD_Vector3 PRIV_avdMeshOptimizerVertexPosition(const AVD_ModelVertexPacked *vertex)
+{
+    return avdVec3(avdDequantizeHalf(vertex->vx), avdDequantizeHalf(vertex->vy), avdDequantizeHalf(vertex->vz));
+}
+
+static bool PRIV_avdMeshOptimizeLocal(
+    AVD_UInt32 *indices,
+    AVD_UInt32 *scratch,
+    AVD_Size indexCount,
+    AVD_ModelVertexPacked *vertices,
+    AVD_UInt32 vertexCount,
+    AVD_MeshOptimizeFlags flags,
+    AVD_UInt32 *outRemap)
+{
+    if (flags & (AVD_MESH_OPTIMIZE_VERTEX_CACHE | AVD_MESH_OPTIMIZE_OVERDRAW)) {
+        AVD_CHECK(avdMeshOptimizeVertexCache(scratch, indices, indexCount, vertexCount, AVD_MESH_OPTIMIZER_CACHE_SIZE));
+        memcpy(indices, scratch, sizeof(AVD_UInt32) * indexCount);
+    }
+
+    if (flags & AVD_MESH_OPTIMIZE_OVERDRAW) {
+        // sorted by what the shaders see, the decoded packed positions
+        AVD_Vector3 *positions = (AVD_Vector3 *)AVD_MALLOC(sizeof(AVD_Vector3) * vertexCount);
+        AVD_CHECK_MSG(positions != NULL, "Failed to allocate the overdraw optimizer positions");
+        for (AVD_UInt32 vertex = 0; vertex < vertexCount; vertex++) {
+            positions[vertex] = PRIV_avdMeshOptimizerVertexPosition(&vertices[vertex]);
+        }
+        bool sorted = avdMeshOptimizeOverdraw(scratch, indices, indexCount, positions, vertexCount, AVD_MESH_OPTIMIZER_CACHE_SIZE, AVD_MESH_OPTIMIZER_OVERDRAW_THRESHOLD);
+        AVD_FREE(positions);
+        AVD_CHECK(sorted);
+        memcpy(indices, scratch, sizeof(AVD_UInt32) * indexCount);
+    }
+
+    if (flags & AVD_MESH_OPTIMIZE_VERTEX_FETCH) {
+        AVD_UInt32 *remap              = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * vertexCount);
+        AVD_ModelVertexPacked *ordered = (AVD_ModelVertexPacked *)AVD_MALLOC(sizeof(AVD_ModelVertexPacked) * vertexCount);
+        if (remap == NULL || ordered == NULL) {
+            if (remap != NULL) {
+                AVD_FREE(remap);
+            }
+            if (ordered != NULL) {
+                AVD_FREE(ordered);
+            }
+            AVD_LOG_ERROR("Failed to allocate the vertex fetch remap");
+            return false;
+        }
+
+        avdMeshOptimizeVertexFetchRemap(remap, indices, indexCount, vertexCount);
+        for (AVD_UInt32 vertex = 0; vertex < vertexCount; vertex++) {
+            ordered[remap[vertex]] = vertices[vertex];
+        }
+        memcpy(vertices, ordered, sizeof(AVD_ModelVertexPacked) * vertexCount);
+        for (AVD_Size i = 0; i < indexCount; i++) {
+            indices[i] = remap[indices[i]];
+        }
+        if (outRemap != NULL) {
+            memcpy(outRemap, remap, sizeof(AVD_UInt32) * vertexCount);
+        }
+
+        AVD_FREE(remap);
+        AVD_FREE(ordered);
+    } else if (outRemap != NULL) {
+        for (AVD_UInt32 vertex = 0; vertex < vertexCount; vertex++) {
+            outRemap[vertex] = vertex;
+        }
+    }
+
+    return true;
+}
+
+bool avdMeshOptimize(
+    const AVD_Mesh *mesh,
+    AVD_ModelResources *resources,
+    AVD_UInt32 firstVertex,
+    AVD_UInt32 vertexCount,
+    AVD_MeshOptimizeFlags flags,
+    AVD_UInt32 *outRemap,
+    AVD_MeshOptimizeStats *outStats)
+{
+    AVD_ASSERT(mesh != NULL);
+    AVD_ASSERT(resources != NULL);
+
+    AVD_Size indexCount = (AVD_Size)mesh->triangleCount * 3;
+    AVD_CHECK_MSG((AVD_Size)mesh->indexOffset + indexCount <= resources->indicesList.count, "Mesh '%s' references indices past the end of the index list", mesh->name);
+    AVD_CHECK_MSG((AVD_Size)firstVertex + (AVD_Size)vertexCount <= resources->verticesList.count, "Mesh '%s' vertex range is past the end of the vertex list", mesh->name);
+
+    AVD_UInt32 *indices             = (AVD_UInt32 *)resources->indicesList.items + mesh->indexOffset;
+    AVD_ModelVertexPacked *vertices = (AVD_ModelVertexPacked *)resources->verticesList.items + firstVertex;
+    for (AVD_Size i = 0; i < indexCount; i++) {
+        AVD_CHECK_MSG(indices[i] >= firstVertex && indices[i] - firstVertex < vertexCount, "Mesh '%s' references vertex %u outside of its range", mesh->name, indices[i]);
+    }
+
+    // the optimizers work on indices relative to the vertex range
+    AVD_UInt32 *localIndices = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * AVD_MAX(indexCount, (AVD_Size)1) * 2);
+    AVD_CHECK_MSG(localIndices != NULL, "Failed to allocate the indices of mesh '%s'", mesh->name);
+    AVD_UInt32 *scratch = localIndices + indexCount;
+    for (AVD_Size i = 0; i < indexCount; i++) {
+        localIndices[i] = indices[i] - firstVertex;
+    }
+
+    AVD_MeshOptimizeStats stats = {0};
+    bool optimized              = avdMeshAnalyzeVertexCache(localIndices, indexCount, vertexCount, AVD_MESH_OPTIMIZER_CACHE_SIZE, &stats.before);
+    optimized                   = optimized && PRIV_avdMeshOptimizeLocal(localIndices, scratch, indexCount, vertices, vertexCount, flags, outRemap);
+
+    // the vertices may have moved already, the indices have to follow them
+    if (optimized) {
+        for (AVD_Size i = 0; i < indexCount; i++) {
+            indices[i] = localIndices[i] + firstVertex;
+        }
+    }
+
+    optimized = optimized && avdMeshAnalyzeVertexCache(localIndices, indexCount, vertexCount, AVD_MESH_OPTIMIZER_CACHE_SIZE, &stats.after);
+    if (optimized && outStats != NULL) {
+        *outStats = stats;
+    }
+
+    AVD_FREE(localIndices);
+    AVD_CHECK_MSG(optimized, "Failed to optimize mesh '%s'", mesh->name);
+    return true;
+}
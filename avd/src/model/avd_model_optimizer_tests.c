@@ -0,0 +1,437 @@
+#include "core/avd_core.h"
+#include "model/avd_model_optimizer.h"
+
+#define AVD_MODEL_OPTIMIZER_TEST_SEED 0x5EEDu
+
+typedef struct {
+    AVD_Vector3 *positions;
+    AVD_UInt32 *indices;
+    AVD_Size vertexCount;
+    AVD_Size indexCount;
+} AVD_ModelOptimizerTestMesh;
+
+typedef struct {
+    AVD_UInt32 corners[3];
+} AVD_ModelOptimizerTestTriangle;
+
+static AVD_UInt32 PRIV_avdModelOptimizerRandom(AVD_UInt32 *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+static void PRIV_avdModelOptimizerTestMeshDestroy(AVD_ModelOptimizerTestMesh *mesh)
+{
+    if (mesh->positions != NULL) {
+        AVD_FREE(mesh->positions);
+    }
+    if (mesh->indices != NULL) {
+        AVD_FREE(mesh->indices);
+    }
+    memset(mesh, 0, sizeof(AVD_ModelOptimizerTestMesh));
+}
+
+// Lat-long sphere with its triangles shuffled, like a scanned mesh exported
+// without any reordering. Several spheres of different radii can be added to
+// the same mesh, each one after the ones before.
+static bool PRIV_avdModelOptimizerTestMeshAddSphere(AVD_ModelOptimizerTestMesh *mesh, AVD_UInt32 rings, AVD_UInt32 segments, AVD_Float radius, bool shuffle)
+{
+    AVD_Size firstVertex = mesh->vertexCount;
+    AVD_Size firstIndex  = mesh->indexCount;
+    mesh->vertexCount += (AVD_Size)(rings + 1) * (segments + 1);
+    mesh->indexCount += (AVD_Size)rings * segments * 6;
+
+    AVD_Vector3 *positions = (AVD_Vector3 *)AVD_REALLOC(mesh->positions, sizeof(AVD_Vector3) * mesh->vertexCount);
+    AVD_CHECK_MSG(positions != NULL, "Failed to allocate the test sphere");
+    mesh->positions     = positions;
+    AVD_UInt32 *indices = (AVD_UInt32 *)AVD_REALLOC(mesh->indices, sizeof(AVD_UInt32) * mesh->indexCount);
+    AVD_CHECK_MSG(indices != NULL, "Failed to allocate the test sphere");
+    mesh->indices = indices;
+
+    for (AVD_UInt32 ring = 0; ring <= rings; ring++) {
+        for (AVD_UInt32 segment = 0; segment <= segments; segment++) {
+            AVD_Float theta = AVD_PI * (AVD_Float)ring / (AVD_Float)rings;
+            AVD_Float phi   = 2.0f * AVD_PI * (AVD_Float)segment / (AVD_Float)segments;
+
+            mesh->positions[firstVertex + ring * (segments + 1) + segment] = avdVec3(radius * avdSin(theta) * avdCos(phi), radius * avdCos(theta), radius * avdSin(theta) * avdSin(phi));
+        }
+    }
+
+    AVD_UInt32 *index = mesh->indices + firstIndex;
+    for (AVD_UInt32 ring = 0; ring < rings; ring++) {
+        for (AVD_UInt32 segment = 0; segment < segments; segment++) {
+            AVD_UInt32 corner = (AVD_UInt32)firstVertex + ring * (segments + 1) + segment;
+            *index++          = corner;
+            *index++          = corner + 1;
+            *index++          = corner + segments + 1;
+            *index++          = corner + 1;
+            *index++          = corner + segments + 2;
+            *index++          = corner + segments + 1;
+        }
+    }
+
+    AVD_ModelOptimizerTestTriangle *triangles = (AVD_ModelOptimizerTestTriangle *)(mesh->indices + firstIndex);
+    AVD_Size triangleCount                    = (mesh->indexCount - firstIndex) / 3;
+    AVD_UInt32 state                          = AVD_MODEL_OPTIMIZER_TEST_SEED;
+    for (AVD_Size i = triangleCount; shuffle && i > 1; i--) {
+        AVD_Size j                          = PRIV_avdModelOptimizerRandom(&state) % i;
+        AVD_ModelOptimizerTestTriangle swap = triangles[i - 1];
+        triangles[i - 1]                    = triangles[j];
+        triangles[j]                        = swap;
+    }
+    return true;
+}
+
+static int PRIV_avdModelOptimizerCompareTriangles(const void *a, const void *b)
+{
+    return memcmp(a, b, sizeof(AVD_ModelOptimizerTestTriangle));
+}
+
+// Same triangles with the same winding, starting at the same corner.
+static bool PRIV_avdModelOptimizerSameTriangles(const AVD_UInt32 *expected, const AVD_UInt32 *actual, AVD_Size indexCount)
+{
+    AVD_UInt32 *sorted = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * indexCount * 2);
+    AVD_CHECK_MSG(sorted != NULL, "Failed to allocate the triangle comparison");
+    memcpy(sorted, expected, sizeof(AVD_UInt32) * indexCount);
+    memcpy(sorted + indexCount, actual, sizeof(AVD_UInt32) * indexCount);
+    qsort(sorted, indexCount / 3, sizeof(AVD_ModelOptimizerTestTriangle), PRIV_avdModelOptimizerCompareTriangles);
+    qsort(sorted + indexCount, indexCount / 3, sizeof(AVD_ModelOptimizerTestTriangle), PRIV_avdModelOptimizerCompareTriangles);
+
+    bool same = memcmp(sorted, sorted + indexCount, sizeof(AVD_UInt32) * indexCount) == 0;
+    AVD_FREE(sorted);
+    return same;
+}
+
+static bool PRIV_avdModelOptimizerTestAnalyze(void)
+{
+    AVD_MeshCacheStats stats     = {0};
+    const AVD_UInt32 triangle[]  = {0, 1, 2};
+    const AVD_UInt32 quad[]      = {0, 1, 2, 2, 1, 3};
+    const AVD_UInt32 repeated[]  = {0, 1, 2, 0, 1, 2};
+    const AVD_UInt32 tinyCache[] = {0, 1, 2, 3, 4, 5, 0, 1, 2};
+
+    AVD_CHECK(avdMeshAnalyzeVertexCache(triangle, 3, 3, 16, &stats));
+    AVD_CHECK(stats.triangleCount == 1 && stats.vertexCount == 3 && stats.transformCount == 3);
+    AVD_CHECK(avdMeshAnalyzeVertexCache(quad, 6, 4, 16, &stats));
+    AVD_CHECK(stats.transformCount == 4 && avdMeshCacheStatsACMR(stats) == 2.0f && avdMeshCacheStatsATVR(stats) == 1.0f);
+    AVD_CHECK(avdMeshAnalyzeVertexCache(repeated, 6, 3, 16, &stats));
+    AVD_CHECK(stats.transformCount == 3);
+    // with room for three vertices the first triangle is evicted again
+    AVD_CHECK(avdMeshAnalyzeVertexCache(tinyCache, 9, 6, 3, &stats));
+    AVD_CHECK(stats.vertexCount == 6 && stats.transformCount == 9);
+    AVD_CHECK(avdMeshAnalyzeVertexCache(NULL, 0, 0, 16, &stats));
+    AVD_CHECK(stats.triangleCount == 0 && avdMeshCacheStatsACMR(stats) == 0.0f);
+    return true;
+}
+
+static bool PRIV_avdModelOptimizerTestVertexCache(const AVD_ModelOptimizerTestMesh *mesh, AVD_UInt32 *optimized)
+{
+    AVD_MeshCacheStats before = {0};
+    AVD_MeshCacheStats after  = {0};
+    AVD_CHECK(avdMeshAnalyzeVertexCache(mesh->indices, mesh->indexCount, mesh->vertexCount, AVD_MESH_OPTIMIZER_CACHE_SIZE, &before));
+    AVD_CHECK(avdMeshOptimizeVertexCache(optimized, mesh->indices, mesh->indexCount, mesh->vertexCount, AVD_MESH_OPTIMIZER_CACHE_SIZE));
+    AVD_CHECK(avdMeshAnalyzeVertexCache(optimized, mesh->indexCount, mesh->vertexCount, AVD_MESH_OPTIMIZER_CACHE_SIZE, &after));
+    AVD_LOG_DEBUG("    vertex cache: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", avdMeshCacheStatsACMR(before), avdMeshCacheStatsACMR(after), avdMeshCacheStatsATVR(before), avdMeshCacheStatsATVR(after));
+
+    AVD_CHECK_MSG(PRIV_avdModelOptimizerSameTriangles(mesh->indices, optimized, mesh->indexCount), "Vertex cache optimization changed the triangles");
+    // shuffled the grid is close to the worst case, fanning gets it well under one
+    AVD_CHECK_MSG(avdMeshCacheStatsACMR(before) > 2.5f, "Shuffled test mesh already has a good order");
+    AVD_CHECK_MSG(avdMeshCacheStatsACMR(after) < 0.8f, "Vertex cache optimization only reached an ACMR of %.3f", avdMeshCacheStatsACMR(after));
+    return true;
+}
+
+// An inner and an outer sphere, the inner one first. Overdraw sorting has to
+// put the outer one in front since it occludes the inner one from everywhere.
+static bool PRIV_avdModelOptimizerTestOverdraw(void)
+{
+    AVD_ModelOptimizerTestMesh mesh = {0};
+    AVD_UInt32 *cacheOptimized      = NULL;
+    AVD_UInt32 *sorted              = NULL;
+    bool ok                         = PRIV_avdModelOptimizerTestMeshAddSphere(&mesh, 24, 48, 0.5f, false);
+    ok                              = ok && PRIV_avdModelOptimizerTestMeshAddSphere(&mesh, 24, 48, 1.0f, false);
+    if (ok) {
+        cacheOptimized = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * mesh.indexCount);
+        sorted         = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * mesh.indexCount);
+        ok             = cacheOptimized != NULL && sorted != NULL;
+    }
+    ok = ok && avdMeshOptimizeVertexCache(cacheOptimized, mesh.indices, mesh.indexCount, mesh.vertexCount, AVD_MESH_OPTIMIZER_CACHE_SIZE);
+    ok = ok && avdMeshOptimizeOverdraw(sorted, cacheOptimized, mesh.indexCount, mesh.positions, mesh.vertexCount, AVD_MESH_OPTIMIZER_CACHE_SIZE, AVD_MESH_OPTIMIZER_OVERDRAW_THRESHOLD);
+
+    AVD_MeshCacheStats cacheStats  = {0};
+    AVD_MeshCacheStats sortedStats = {0};
+    ok                             = ok && avdMeshAnalyzeVertexCache(cacheOptimized, mesh.indexCount, mesh.vertexCount, AVD_MESH_OPTIMIZER_CACHE_SIZE, &cacheStats);
+    ok                             = ok && avdMeshAnalyzeVertexCache(sorted, mesh.indexCount, mesh.vertexCount, AVD_MESH_OPTIMIZER_CACHE_SIZE, &sortedStats);
+    if (ok) {
+        AVD_LOG_DEBUG("    overdraw: ACMR %.3f -> %.3f", avdMeshCacheStatsACMR(cacheStats), avdMeshCacheStatsACMR(sortedStats));
+        ok = PRIV_avdModelOptimizerSameTriangles(mesh.indices, sorted, mesh.indexCount);
+        if (!ok) {
+            AVD_LOG_ERROR("    FAILED: Overdraw optimization changed the triangles");
+        }
+    }
+
+    // the inner sphere uses the first half of the vertices, clusters wrapping
+    // around a whole ring face nowhere in particular so a few of its triangles
+    // can still end up in front of the outer sphere
+    AVD_UInt32 innerVertexCount = (AVD_UInt32)(mesh.vertexCount / 2);
+    AVD_Size innerInFront       = 0;
+    for (AVD_Size i = 0; ok && i < mesh.indexCount / 2; i += 3) {
+        innerInFront += sorted[i] < innerVertexCount ? 1 : 0;
+    }
+    AVD_LOG_DEBUG("    overdraw: %zu of %zu inner sphere triangles sorted in front", innerInFront, mesh.indexCount / 6);
+    if (ok && innerInFront * 20 > mesh.indexCount / 6) {
+        AVD_LOG_ERROR("    FAILED: %zu inner sphere triangles sorted in front of the outer sphere", innerInFront);
+        ok = false;
+    }
+    if (ok && avdMeshCacheStatsACMR(sortedStats) > avdMeshCacheStatsACMR(cacheStats) * 1.25f) {
+        AVD_LOG_ERROR("    FAILED: Overdraw sorting raised the ACMR from %.3f to %.3f", avdMeshCacheStatsACMR(cacheStats), avdMeshCacheStatsACMR(sortedStats));
+        ok = false;
+    }
+
+    if (cacheOptimized != NULL) {
+        AVD_FREE(cacheOptimized);
+    }
+    if (sorted != NULL) {
+        AVD_FREE(sorted);
+    }
+    PRIV_avdModelOptimizerTestMeshDestroy(&mesh);
+    return ok;
+}
+
+static bool PRIV_avdModelOptimizerTestVertexFetch(void)
+{
+    // vertex 2 is never used and has to end up last
+    const AVD_UInt32 indices[]  = {4, 0, 3, 3, 0, 1, 5, 4, 1};
+    const AVD_UInt32 expected[] = {1, 3, 5, 2, 0, 4};
+    AVD_UInt32 remap[6];
+
+    AVD_CHECK(avdMeshOptimizeVertexFetchRemap(remap, indices, AVD_ARRAY_COUNT(indices), 6) == 5);
+    AVD_CHECK(memcmp(remap, expected, sizeof(expected)) == 0);
+    AVD_CHECK(avdMeshOptimizeVertexFetchRemap(remap, NULL, 0, 0) == 0);
+    return true;
+}
+
+// All three corners of every triangle with their morphed copies, sorted so
+// that the triangle order does not matter.
+typedef struct {
+    AVD_ModelVertexPacked corners[6];
+} AVD_ModelOptimizerTestCorners;
+
+static int PRIV_avdModelOptimizerCompareCorners(const void *a, const void *b)
+{
+    return memcmp(a, b, sizeof(AVD_ModelOptimizerTestCorners));
+}
+
+static void PRIV_avdModelOptimizerTestCorners(
+    const AVD_Mesh *mesh,
+    const AVD_ModelResources *resources,
+    AVD_UInt32 firstVertex,
+    const AVD_ModelVertexPacked *morphed,
+    AVD_ModelOptimizerTestCorners *outCorners)
+{
+    const AVD_ModelVertexPacked *vertices = (const AVD_ModelVertexPacked *)resources->verticesList.items;
+    const AVD_UInt32 *indices             = (const AVD_UInt32 *)resources->indicesList.items + mesh->indexOffset;
+    for (AVD_Size triangle = 0; triangle < (AVD_Size)mesh->triangleCount; triangle++) {
+        for (AVD_Size corner = 0; corner < 3; corner++) {
+            AVD_UInt32 index                         = indices[triangle * 3 + corner];
+            outCorners[triangle].corners[corner]     = vertices[index];
+            outCorners[triangle].corners[corner + 3] = morphed[index - firstVertex];
+        }
+    }
+    qsort(outCorners, (AVD_Size)mesh->triangleCount, sizeof(AVD_ModelOptimizerTestCorners), PRIV_avdModelOptimizerCompareCorners);
+}
+
+// A mesh in a model resource list that does not start at the first vertex,
+// with a moved copy of its vertices on the side standing in for a morph target
+// that has to follow the remap.
+static bool PRIV_avdModelOptimizerTestMesh(const AVD_ModelOptimizerTestMesh *source)
+{
+    AVD_ModelResources resources = {0};
+    AVD_CHECK(avdModelResourcesCreate(&resources));
+
+    AVD_ModelVertex vertex             = {0};
+    AVD_ModelVertexPacked packedVertex = {0};
+    avdModelVertexInit(&vertex);
+    vertex.position = avdVec3(7.0f, 7.0f, 7.0f);
+    avdModelVertexPack(&vertex, &packedVertex);
+    avdListPushBack(&resources.verticesList, &packedVertex);
+    AVD_ModelVertexPacked untouchedVertex = packedVertex;
+
+    AVD_UInt32 firstVertex = (AVD_UInt32)resources.verticesList.count;
+    for (AVD_Size i = 0; i < source->vertexCount; i++) {
+        vertex.position = source->positions[i];
+        avdModelVertexPack(&vertex, &packedVertex);
+        avdListPushBack(&resources.verticesList, &packedVertex);
+    }
+
+    AVD_Mesh mesh = {0};
+    avdMeshInit(&mesh);
+    snprintf(mesh.name, sizeof(mesh.name), "OptimizerTest");
+    mesh.indexOffset   = (AVD_Int32)resources.indicesList.count;
+    mesh.triangleCount = (AVD_Int32)(source->indexCount / 3);
+    for (AVD_Size i = 0; i < source->indexCount; i++) {
+        AVD_UInt32 index = source->indices[i] + firstVertex;
+        avdListPushBack(&resources.indicesList, &index);
+    }
+
+    AVD_Size triangleCount                  = source->indexCount / 3;
+    AVD_ModelOptimizerTestCorners *expected = (AVD_ModelOptimizerTestCorners *)AVD_MALLOC(sizeof(AVD_ModelOptimizerTestCorners) * triangleCount);
+    AVD_ModelOptimizerTestCorners *actual   = (AVD_ModelOptimizerTestCorners *)AVD_MALLOC(sizeof(AVD_ModelOptimizerTestCorners) * triangleCount);
+    AVD_ModelVertexPacked *morphed          = (AVD_ModelVertexPacked *)AVD_MALLOC(sizeof(AVD_ModelVertexPacked) * source->vertexCount * 2);
+    AVD_UInt32 *remap                       = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * source->vertexCount);
+    bool ok                                 = expected != NULL && actual != NULL && morphed != NULL && remap != NULL;
+    if (ok) {
+        for (AVD_Size i = 0; i < source->vertexCount; i++) {
+            vertex.position = avdVec3Add(source->positions[i], avdVec3(0.0f, 1.0f, 0.0f));
+            avdModelVertexPack(&vertex, &morphed[i]);
+        }
+        PRIV_avdModelOptimizerTestCorners(&mesh, &resources, firstVertex, morphed, expected);
+    }
+
+    AVD_MeshOptimizeStats stats = {0};
+    AVD_MeshOptimizeFlags flags = AVD_MESH_OPTIMIZE_VERTEX_CACHE | AVD_MESH_OPTIMIZE_OVERDRAW | AVD_MESH_OPTIMIZE_VERTEX_FETCH;
+    ok                          = ok && avdMeshOptimize(&mesh, &resources, firstVertex, (AVD_UInt32)source->vertexCount, flags, remap, &stats);
+    ok                          = ok && avdMeshCacheStatsACMR(stats.after) < avdMeshCacheStatsACMR(stats.before);
+    if (ok) {
+        AVD_ModelVertexPacked *ordered = morphed + source->vertexCount;
+        for (AVD_Size i = 0; i < source->vertexCount; i++) {
+            ordered[remap[i]] = morphed[i];
+        }
+        PRIV_avdModelOptimizerTestCorners(&mesh, &resources, firstVertex, ordered, actual);
+        ok = memcmp(expected, actual, sizeof(AVD_ModelOptimizerTestCorners) * triangleCount) == 0;
+    }
+
+    // the vertex in front of the range belongs to someone else
+    const AVD_ModelVertexPacked *vertices = (const AVD_ModelVertexPacked *)resources.verticesList.items;
+    const AVD_UInt32 *indices             = (const AVD_UInt32 *)resources.indicesList.items;
+    ok                                    = ok && memcmp(&vertices[0], &untouchedVertex, sizeof(AVD_ModelVertexPacked)) == 0;
+
+    // first use order, every index is at most one past the largest one so far
+    AVD_UInt32 maxIndex = firstVertex;
+    for (AVD_Size i = 0; ok && i < source->indexCount; i++) {
+        ok       = indices[i] <= maxIndex + 1;
+        maxIndex = AVD_MAX(maxIndex, indices[i]);
+    }
+    if (!ok) {
+        AVD_LOG_ERROR("    FAILED: Optimizing a mesh changed what it draws");
+    }
+
+    // nothing to do for an empty mesh
+    mesh.triangleCount = 0;
+    ok                 = ok && avdMeshOptimize(&mesh, &resources, firstVertex, 0, flags, NULL, NULL);
+
+    void *allocations[] = {expected, actual, morphed, remap};
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(allocations); i++) {
+        if (allocations[i] != NULL) {
+            AVD_FREE(allocations[i]);
+        }
+    }
+    avdModelResourcesDestroy(&resources);
+    return ok;
+}
+
+bool avdModelOptimizerTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Model Optimizer Tests...");
+
+    AVD_ModelOptimizerTestMesh sphere = {0};
+    AVD_UInt32 *optimized             = NULL;
+    bool ok                           = PRIV_avdModelOptimizerTestMeshAddSphere(&sphere, 64, 128, 1.0f, true);
+    if (ok) {
+        optimized = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * sphere.indexCount);
+        ok        = optimized != NULL;
+    }
+
+    ok = ok && PRIV_avdModelOptimizerTestAnalyze();
+    ok = ok && PRIV_avdModelOptimizerTestVertexCache(&sphere, optimized);
+    ok = ok && PRIV_avdModelOptimizerTestOverdraw();
+    ok = ok && PRIV_avdModelOptimizerTestVertexFetch();
+    ok = ok && PRIV_avdModelOptimizerTestMesh(&sphere);
+
+    if (optimized != NULL) {
+        AVD_FREE(optimized);
+    }
+    PRIV_avdModelOptimizerTestMeshDestroy(&sphere);
+    AVD_CHECK(ok);
+
+    AVD_LOG_DEBUG("All AVD Model Optimizer Tests PASSED");
+    return true;
+}
+
+typedef struct {
+    AVD_ModelOptimizerTestMesh mesh;
+    AVD_UInt32 *cacheOptimized;
+    AVD_UInt32 *output;
+    AVD_UInt32 *remap;
+    AVD_MeshCacheStats stats;
+} AVD_ModelOptimizerBenchmark;
+
+static void PRIV_avdModelOptimizerBenchmarkAnalyze(void *userData)
+{
+    AVD_ModelOptimizerBenchmark *benchmark = (AVD_ModelOptimizerBenchmark *)userData;
+    avdMeshAnalyzeVertexCache(benchmark->mesh.indices, benchmark->mesh.indexCount, benchmark->mesh.vertexCount, AVD_MESH_OPTIMIZER_CACHE_SIZE, &benchmark->stats);
+}
+
+static void PRIV_avdModelOptimizerBenchmarkVertexCache(void *userData)
+{
+    AVD_ModelOptimizerBenchmark *benchmark = (AVD_ModelOptimizerBenchmark *)userData;
+    avdMeshOptimizeVertexCache(benchmark->output, benchmark->mesh.indices, benchmark->mesh.indexCount, benchmark->mesh.vertexCount, AVD_MESH_OPTIMIZER_CACHE_SIZE);
+}
+
+static void PRIV_avdModelOptimizerBenchmarkOverdraw(void *userData)
+{
+    AVD_ModelOptimizerBenchmark *benchmark = (AVD_ModelOptimizerBenchmark *)userData;
+    avdMeshOptimizeOverdraw(
+        benchmark->output,
+        benchmark->cacheOptimized,
+        benchmark->mesh.indexCount,
+        benchmark->mesh.positions,
+        benchmark->mesh.vertexCount,
+        AVD_MESH_OPTIMIZER_CACHE_SIZE,
+        AVD_MESH_OPTIMIZER_OVERDRAW_THRESHOLD);
+}
+
+static void PRIV_avdModelOptimizerBenchmarkVertexFetch(void *userData)
+{
+    AVD_ModelOptimizerBenchmark *benchmark = (AVD_ModelOptimizerBenchmark *)userData;
+    avdMeshOptimizeVertexFetchRemap(benchmark->remap, benchmark->cacheOptimized, benchmark->mesh.indexCount, benchmark->mesh.vertexCount);
+}
+
+bool avdModelOptimizerBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD Model Optimizer benchmarks...");
+
+    AVD_ModelOptimizerBenchmark benchmark = {0};
+    bool ok                               = PRIV_avdModelOptimizerTestMeshAddSphere(&benchmark.mesh, 256, 512, 1.0f, true);
+    if (ok) {
+        benchmark.cacheOptimized = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * benchmark.mesh.indexCount);
+        benchmark.output         = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * benchmark.mesh.indexCount);
+        benchmark.remap          = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * benchmark.mesh.vertexCount);
+        ok                       = benchmark.cacheOptimized != NULL && benchmark.output != NULL && benchmark.remap != NULL;
+    }
+    ok = ok && avdMeshOptimizeVertexCache(benchmark.cacheOptimized, benchmark.mesh.indices, benchmark.mesh.indexCount, benchmark.mesh.vertexCount, AVD_MESH_OPTIMIZER_CACHE_SIZE);
+
+    AVD_Size triangleCount = benchmark.mesh.indexCount / 3;
+    AVD_BenchCase cases[]  = {
+        {.name = "optimizer/analyze_sphere_256k", .unit = "triangles", .itemsPerRepetition = triangleCount, .run = PRIV_avdModelOptimizerBenchmarkAnalyze},
+        {.name = "optimizer/vertex_cache_sphere_256k", .unit = "triangles", .itemsPerRepetition = triangleCount, .run = PRIV_avdModelOptimizerBenchmarkVertexCache},
+        {.name = "optimizer/overdraw_sphere_256k", .unit = "triangles", .itemsPerRepetition = triangleCount, .run = PRIV_avdModelOptimizerBenchmarkOverdraw},
+        {.name = "optimizer/vertex_fetch_sphere_256k", .unit = "triangles", .itemsPerRepetition = triangleCount, .run = PRIV_avdModelOptimizerBenchmarkVertexFetch},
+    };
+    for (AVD_Size i = 0; ok && i < AVD_ARRAY_COUNT(cases); i++) {
+        cases[i].userData = &benchmark;
+        ok                = avdBenchRun(bench, &cases[i]);
+    }
+
+    if (benchmark.cacheOptimized != NULL) {
+        AVD_FREE(benchmark.cacheOptimized);
+    }
+    if (benchmark.output != NULL) {
+        AVD_FREE(benchmark.output);
+    }
+    if (benchmark.remap != NULL) {
+        AVD_FREE(benchmark.remap);
+    }
+    PRIV_avdModelOptimizerTestMeshDestroy(&benchmark.mesh);
+    return ok;
+}
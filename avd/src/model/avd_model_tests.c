@@ -0,0 +1,442 @@
+#include "core/avd_core.h"
+#include "model/avd_model.h"
+
+// large enough for the node streams to grow a few times past their initial capacity
+#define AVD_MODEL_TEST_GROWTH_NODES 1000
+#define AVD_MODEL_BENCH_TREE_NODES  (16 * 1024)
+#define AVD_MODEL_TEST_CACHE_NODES  300
+
+static bool PRIV_avdModelTestNearlyEqual(const AVD_Float *a, const AVD_Float *b, AVD_Size count)
+{
+    for (AVD_Size i = 0; i < count; i++) {
+        if (avdAbs(a[i] - b[i]) > 1e-4f * avdMax(1.0f, avdAbs(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Root
+//   A
+//     B
+//     C
+//       D
+//   E
+static bool PRIV_avdModelTestHierarchy(void)
+{
+    AVD_Model model = {0};
+    AVD_CHECK(avdModelCreate(&model, 0));
+
+    AVD_Int32 a = -1;
+    AVD_Int32 b = -1;
+    AVD_Int32 c = -1;
+    AVD_Int32 d = -1;
+    AVD_Int32 e = -1;
+    bool ok     = avdModelAddNode(&model, AVD_MODEL_ROOT_NODE, "A", 1, &a);
+    ok          = ok && avdModelAddNode(&model, a, "B", 2, &b);
+    ok          = ok && avdModelAddNode(&model, a, "C", 3, &c);
+    ok          = ok && avdModelAddNode(&model, c, "D", 4, &d);
+    ok          = ok && avdModelAddNode(&model, AVD_MODEL_ROOT_NODE, "E", 5, &e);
+    ok          = ok && avdModelNodeCount(&model) == 6 && a == 1 && e == 5;
+
+    const AVD_ModelNode *root  = avdModelGetNode(&model, AVD_MODEL_ROOT_NODE);
+    const AVD_ModelNode *nodeA = avdModelGetNode(&model, a);
+    const AVD_ModelNode *nodeC = avdModelGetNode(&model, c);
+    ok                         = ok && root->parent == -1 && root->firstChild == a && root->lastChild == e;
+    ok                         = ok && nodeA->parent == AVD_MODEL_ROOT_NODE && nodeA->firstChild == b && nodeA->nextSibling == e;
+    ok                         = ok && avdModelGetNode(&model, b)->nextSibling == c && nodeC->nextSibling == -1 && nodeC->firstChild == d;
+    ok                         = ok && avdModelNodeDepth(&model, d) == 3 && avdModelNodeDepth(&model, e) == 1;
+    ok                         = ok && strcmp(avdModelGetNode(&model, d)->name, "D") == 0 && avdModelGetNode(&model, d)->id == 4;
+    ok                         = ok && avdModelGetNodeMeshIndex(&model, d) == -1 && avdModelGetNodeMesh(&model, d) == NULL;
+    AVD_CHECK_MSG(ok, "The node links are wrong");
+
+    AVD_Mesh mesh = {0};
+    AVD_CHECK(avdMeshInitWithNameId(&mesh, "Mesh", 6));
+    avdListPushBack(&model.meshes, &mesh);
+    avdModelSetNodeMesh(&model, d, 0);
+    ok = avdModelGetNodeMeshIndex(&model, d) == 0 && avdModelGetNodeMesh(&model, d) == avdListGet(&model.meshes, 0);
+    ok = ok && avdModelGetNodeMeshIndex(&model, c) == -1;
+    AVD_CHECK_MSG(ok, "The node mesh is wrong");
+
+    // depth first from the root, and a subtree walk that has to stop at its root
+    const AVD_Int32 expected[] = {AVD_MODEL_ROOT_NODE, a, b, c, d, e};
+    AVD_Int32 visited          = 0;
+    for (AVD_Int32 node = AVD_MODEL_ROOT_NODE; ok && node >= 0; node = avdModelNodeNext(&model, AVD_MODEL_ROOT_NODE, node)) {
+        ok = visited < (AVD_Int32)AVD_ARRAY_COUNT(expected) && node == expected[visited++];
+    }
+    ok = ok && visited == (AVD_Int32)AVD_ARRAY_COUNT(expected);
+    ok = ok && avdModelNodeNext(&model, c, c) == d && avdModelNodeNext(&model, c, d) == -1 && avdModelNodeNext(&model, b, b) == -1;
+    AVD_CHECK_MSG(ok, "The node walk visited the wrong nodes");
+
+    model.mainScene = a;
+    avdModelClearNodes(&model);
+    ok = avdModelNodeCount(&model) == 1 && model.mainScene == -1;
+    ok = ok && avdModelGetNode(&model, AVD_MODEL_ROOT_NODE)->firstChild == -1 && avdModelGetNode(&model, AVD_MODEL_ROOT_NODE)->lastChild == -1;
+    ok = ok && avdModelAddNode(&model, AVD_MODEL_ROOT_NODE, "Again", 7, &a) && a == 1;
+    ok = ok && avdModelNodeNext(&model, AVD_MODEL_ROOT_NODE, AVD_MODEL_ROOT_NODE) == a && avdModelNodeNext(&model, AVD_MODEL_ROOT_NODE, a) == -1;
+
+    avdModelDestroy(&model);
+    AVD_CHECK_MSG(ok, "Clearing the nodes did not leave only the root");
+    return true;
+}
+
+// A four way tree grown far past the initial capacity, the local transforms
+// have to survive every time the streams grow.
+static bool PRIV_avdModelTestGrowth(void)
+{
+    AVD_Model model = {0};
+    AVD_CHECK(avdModelCreate(&model, 0));
+
+    AVD_Transform *transforms = (AVD_Transform *)AVD_MALLOC(sizeof(AVD_Transform) * AVD_MODEL_TEST_GROWTH_NODES);
+    AVD_Matrix4x4 *world      = (AVD_Matrix4x4 *)AVD_MALLOC(sizeof(AVD_Matrix4x4) * AVD_MODEL_TEST_GROWTH_NODES * 2);
+    if (transforms == NULL || world == NULL) {
+        if (transforms != NULL) {
+            AVD_FREE(transforms);
+        }
+        if (world != NULL) {
+            AVD_FREE(world);
+        }
+        avdModelDestroy(&model);
+        AVD_LOG_ERROR("Failed to allocate the test hierarchy");
+        return false;
+    }
+    AVD_Matrix4x4 *expected = world + AVD_MODEL_TEST_GROWTH_NODES;
+
+    bool ok = true;
+    for (AVD_Int32 i = 1; ok && i < AVD_MODEL_TEST_GROWTH_NODES; i++) {
+        AVD_Int32 parent = (i - 1) / 4;
+        AVD_Float angle  = (AVD_Float)i * 0.01f;
+        transforms[i]    = avdTransform(
+            avdVec3((AVD_Float)(i % 7), 0.5f, -(AVD_Float)(i % 5)),
+            avdQuatFromAxisAngle(avdVec3(0.0f, 1.0f, 0.0f), angle),
+            avdVec3(1.0f, 1.0f + angle * 0.1f, 1.0f));
+
+        AVD_Int32 index = -1;
+        ok              = avdModelAddNode(&model, parent, "Node", i, &index) && index == i;
+        if (ok) {
+            avdModelSetNodeTransform(&model, index, &transforms[i]);
+        }
+    }
+    ok = ok && avdModelNodeCount(&model) == AVD_MODEL_TEST_GROWTH_NODES && model.nodeTransforms.capacity >= AVD_MODEL_TEST_GROWTH_NODES;
+
+    // the per node path, parents come first so theirs is already done
+    expected[0] = avdMat4x4Identity();
+    for (AVD_Int32 i = 1; ok && i < AVD_MODEL_TEST_GROWTH_NODES; i++) {
+        AVD_Transform stored = avdModelGetNodeTransform(&model, i);
+        AVD_Matrix4x4 local  = avdTransformToMatrix(&transforms[i]);
+        expected[i]          = avdMat4x4Multiply(expected[(i - 1) / 4], local);
+        ok                   = memcmp(&stored, &transforms[i], sizeof(AVD_Transform)) == 0;
+    }
+
+    if (ok) {
+        avdModelComputeWorldMatrices(&model, world);
+    }
+    for (AVD_Int32 i = 0; ok && i < AVD_MODEL_TEST_GROWTH_NODES; i++) {
+        ok = PRIV_avdModelTestNearlyEqual(world[i].m, expected[i].m, 16);
+    }
+
+    // every node is reached exactly once
+    AVD_Int32 visited = 0;
+    for (AVD_Int32 node = AVD_MODEL_ROOT_NODE; ok && node >= 0; node = avdModelNodeNext(&model, AVD_MODEL_ROOT_NODE, node)) {
+        visited++;
+    }
+    ok = ok && visited == AVD_MODEL_TEST_GROWTH_NODES;
+
+    AVD_FREE(transforms);
+    AVD_FREE(world);
+    avdModelDestroy(&model);
+    AVD_CHECK_MSG(ok, "The transforms, world matrices or walk of a grown hierarchy are wrong");
+    return true;
+}
+
+// The cached world matrices against a full recompute, after the first
+// update, a static frame, a moved subtree and a cleared hierarchy.
+static bool PRIV_avdModelTestWorldMatrixCache(void)
+{
+    AVD_Model model = {0};
+    AVD_CHECK(avdModelCreate(&model, 0));
+    AVD_Matrix4x4 *expected = (AVD_Matrix4x4 *)AVD_MALLOC(sizeof(AVD_Matrix4x4) * AVD_MODEL_TEST_CACHE_NODES);
+    if (expected == NULL) {
+        avdModelDestroy(&model);
+        AVD_LOG_ERROR("Failed to allocate the expected world matrices");
+        return false;
+    }
+
+    bool ok = true;
+    for (AVD_Int32 i = 1; ok && i < AVD_MODEL_TEST_CACHE_NODES; i++) {
+        AVD_Float angle     = (AVD_Float)i * 0.03f;
+        AVD_Transform local = avdTransform(
+            avdVec3((AVD_Float)(i % 5), 0.25f * (AVD_Float)(i % 3), 1.0f),
+            avdQuatFromAxisAngle(avdVec3(1.0f, 0.0f, 0.0f), angle),
+            avdVec3(1.0f + angle * 0.01f, 1.0f, 1.0f));
+        AVD_Int32 index = -1;
+        ok              = avdModelAddNode(&model, (i - 1) / 3, "Node", i, &index);
+        if (ok) {
+            avdModelSetNodeTransform(&model, index, &local);
+        }
+    }
+
+    // the same products in the same order, so the matrices match exactly
+    ok = ok && avdModelUpdateWorldMatrices(&model) == AVD_MODEL_TEST_CACHE_NODES;
+    if (ok) {
+        avdModelComputeWorldMatrices(&model, expected);
+    }
+    ok                    = ok && memcmp(avdModelGetWorldMatrices(&model), expected, sizeof(AVD_Matrix4x4) * AVD_MODEL_TEST_CACHE_NODES) == 0;
+    AVD_UInt32 generation = model.nodeMatrices.generation;
+    ok                    = ok && avdModelUpdateWorldMatrices(&model) == 0 && model.nodeMatrices.generation == generation && model.nodeMatrices.changedCount == 0;
+    AVD_CHECK_MSG(ok, "The first update of the world matrix cache is wrong");
+
+    // only the moved node and its subtree are redone
+    AVD_Int32 moved     = 4;
+    AVD_Transform local = avdTransform(avdVec3(-2.0f, 3.0f, 0.5f), avdQuatFromAxisAngle(avdVec3(0.0f, 0.0f, 1.0f), 0.7f), avdVec3One());
+    avdModelSetNodeTransform(&model, moved, &local);
+    AVD_Int32 subtree = 0;
+    for (AVD_Int32 node = moved; node >= 0; node = avdModelNodeNext(&model, moved, node)) {
+        subtree++;
+    }
+    ok = avdModelUpdateWorldMatrices(&model) == subtree && model.nodeMatrices.generation == generation + 1;
+    ok = ok && model.nodeMatrices.changedFirst == moved && model.nodeMatrices.changedFirst + model.nodeMatrices.changedCount <= AVD_MODEL_TEST_CACHE_NODES;
+    for (AVD_Int32 node = moved; ok && node >= 0; node = avdModelNodeNext(&model, moved, node)) {
+        ok = avdModelGetNodeWorldGeneration(&model, node) == generation + 1 && node < model.nodeMatrices.changedFirst + model.nodeMatrices.changedCount;
+    }
+    ok = ok && avdModelGetNodeWorldGeneration(&model, 1) == generation && avdModelGetNodeWorldGeneration(&model, moved + 1) == generation;
+    avdModelComputeWorldMatrices(&model, expected);
+    ok = ok && memcmp(avdModelGetWorldMatrices(&model), expected, sizeof(AVD_Matrix4x4) * AVD_MODEL_TEST_CACHE_NODES) == 0;
+    AVD_CHECK_MSG(ok, "Moving a subtree updated the wrong world matrices");
+
+    // nodes added after a clear start out dirty
+    avdModelClearNodes(&model);
+    AVD_Int32 index = -1;
+    ok              = avdModelAddNode(&model, AVD_MODEL_ROOT_NODE, "Again", 1, &index);
+    if (ok) {
+        avdModelSetNodeTransform(&model, index, &local);
+    }
+    ok = ok && avdModelUpdateWorldMatrices(&model) == 1;
+    avdModelComputeWorldMatrices(&model, expected);
+    ok = ok && memcmp(avdModelGetWorldMatrices(&model), expected, sizeof(AVD_Matrix4x4) * 2) == 0;
+
+    AVD_FREE(expected);
+    avdModelDestroy(&model);
+    AVD_CHECK_MSG(ok, "The world matrix cache is wrong after clearing the nodes");
+    return true;
+}
+
+bool avdModelTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Model Tests...");
+
+    AVD_CHECK(PRIV_avdModelTestHierarchy());
+    AVD_CHECK(PRIV_avdModelTestGrowth());
+    AVD_CHECK(PRIV_avdModelTestWorldMatrixCache());
+
+    AVD_LOG_DEBUG("All AVD Model Tests PASSED");
+    return true;
+}
+
+typedef struct {
+    AVD_Model model;
+    AVD_Int32 root;
+    AVD_Matrix4x4 *world;
+    AVD_Size meshNodes;
+
+    // nodes moved by every repetition of the world matrix cases
+    AVD_Int32 movedStride;
+    AVD_Float time;
+    AVD_Size redoneNodes;
+} AVD_ModelBenchmark;
+
+// What the scenes do before culling, the world matrix of every node and a
+// walk below the scene for the ones with a mesh.
+static void PRIV_avdModelBenchmarkTraverse(void *userData)
+{
+    AVD_ModelBenchmark *benchmark = (AVD_ModelBenchmark *)userData;
+    avdModelComputeWorldMatrices(&benchmark->model, benchmark->world);
+
+    AVD_Size meshNodes = 0;
+    for (AVD_Int32 node = benchmark->root; node >= 0; node = avdModelNodeNext(&benchmark->model, benchmark->root, node)) {
+        meshNodes += avdModelGetNodeMeshIndex(&benchmark->model, node) >= 0 ? 1 : 0;
+    }
+    benchmark->meshNodes = meshNodes;
+}
+
+static bool PRIV_avdModelBenchmarkRun(AVD_Bench *bench, AVD_ModelBenchmark *benchmark, const char *name)
+{
+    AVD_Size nodeCount = (AVD_Size)avdModelNodeCount(&benchmark->model);
+    benchmark->world   = (AVD_Matrix4x4 *)AVD_MALLOC(sizeof(AVD_Matrix4x4) * nodeCount);
+    AVD_CHECK_MSG(benchmark->world != NULL, "Failed to allocate %zu world matrices", nodeCount);
+
+    // the hierarchy itself, the local transform, parent and mesh streams
+    // included, the meshes are shared with the renderers
+    AVD_Size perNode = sizeof(AVD_ModelNode) + sizeof(AVD_Float) * 10 + sizeof(AVD_Int32) * 2;
+    AVD_LOG_INFO("%s: %zu nodes, %zu byte model, %zu bytes of hierarchy per node", name, nodeCount, sizeof(AVD_Model), perNode);
+
+    AVD_BenchCase traverseCase = {
+        .name               = name,
+        .unit               = "nodes",
+        .itemsPerRepetition = nodeCount,
+        .run                = PRIV_avdModelBenchmarkTraverse,
+        .userData           = benchmark,
+    };
+    bool ok = avdBenchRun(bench, &traverseCase);
+
+    AVD_FREE(benchmark->world);
+    return ok;
+}
+
+// A four way tree below one scene node, every other node has a mesh.
+static bool PRIV_avdModelBenchmarkCreateTree(AVD_ModelBenchmark *benchmark)
+{
+    AVD_Mesh mesh = {0};
+    AVD_CHECK(avdModelCreate(&benchmark->model, 0));
+    AVD_CHECK(avdMeshInitWithNameId(&mesh, "Mesh", 0));
+    avdListPushBack(&benchmark->model.meshes, &mesh);
+    bool ok = avdModelAddNode(&benchmark->model, AVD_MODEL_ROOT_NODE, "Scene", 0, &benchmark->root);
+    for (AVD_Int32 i = 2; ok && i < AVD_MODEL_BENCH_TREE_NODES; i++) {
+        AVD_Int32 index     = -1;
+        AVD_Transform local = avdTransform(avdVec3((AVD_Float)(i % 3), 1.0f, 0.0f), avdQuatIdentity(), avdVec3One());
+        ok                  = avdModelAddNode(&benchmark->model, 1 + (i - 2) / 4, "Node", i, &index);
+        if (ok) {
+            avdModelSetNodeTransform(&benchmark->model, index, &local);
+            avdModelSetNodeMesh(&benchmark->model, index, i % 2 == 0 ? 0 : -1);
+        }
+    }
+    return ok;
+}
+
+static bool PRIV_avdModelBenchmarkTree(AVD_Bench *bench)
+{
+    const char *name = "model/traverse_tree_16k";
+    if (!avdBenchIsSelected(bench, name)) {
+        return true;
+    }
+
+    AVD_ModelBenchmark benchmark = {0};
+    bool ok                      = PRIV_avdModelBenchmarkCreateTree(&benchmark);
+    ok                           = ok && PRIV_avdModelBenchmarkRun(bench, &benchmark, name);
+    avdModelDestroy(&benchmark.model);
+    return ok;
+}
+
+// What a scene pays per frame for the world matrices: every node moved and
+// recomputed as before the cache, then the cache with nothing, every
+// hundredth node and every node moved. Moving is part of the measurement
+// since it flags the nodes.
+static void PRIV_avdModelBenchmarkMoveNodes(AVD_ModelBenchmark *benchmark)
+{
+    AVD_Model *model = &benchmark->model;
+    benchmark->time += 0.01f;
+    for (AVD_Int32 i = benchmark->movedStride; benchmark->movedStride > 0 && i < avdModelNodeCount(model); i += benchmark->movedStride) {
+        AVD_Transform local = avdTransform(avdVec3((AVD_Float)(i % 3), 1.0f, 0.0f), avdQuatFromAxisAngle(avdVec3(0.0f, 1.0f, 0.0f), benchmark->time), avdVec3One());
+        avdModelSetNodeTransform(model, i, &local);
+    }
+}
+
+static void PRIV_avdModelBenchmarkWorldRecompute(void *userData)
+{
+    AVD_ModelBenchmark *benchmark = (AVD_ModelBenchmark *)userData;
+    PRIV_avdModelBenchmarkMoveNodes(benchmark);
+    avdModelComputeWorldMatrices(&benchmark->model, benchmark->world);
+}
+
+static void PRIV_avdModelBenchmarkWorldUpdate(void *userData)
+{
+    AVD_ModelBenchmark *benchmark = (AVD_ModelBenchmark *)userData;
+    PRIV_avdModelBenchmarkMoveNodes(benchmark);
+    benchmark->redoneNodes = (AVD_Size)avdModelUpdateWorldMatrices(&benchmark->model);
+}
+
+static bool PRIV_avdModelBenchmarkWorldMatrices(AVD_Bench *bench)
+{
+    static const struct {
+        const char *name;
+        AVD_Int32 movedStride; // 0 for none
+    } cases[] = {
+        {"model/world_static_16k", 0},
+        {"model/world_dirty_1pct_16k", 100},
+        {"model/world_animated_16k", 1},
+    };
+
+    AVD_ModelBenchmark benchmark = {0};
+    AVD_CHECK(PRIV_avdModelBenchmarkCreateTree(&benchmark));
+    AVD_Size nodeCount = (AVD_Size)avdModelNodeCount(&benchmark.model);
+    benchmark.world    = (AVD_Matrix4x4 *)AVD_MALLOC(sizeof(AVD_Matrix4x4) * nodeCount);
+    if (benchmark.world == NULL) {
+        avdModelDestroy(&benchmark.model);
+        AVD_LOG_ERROR("Failed to allocate %zu world matrices", nodeCount);
+        return false;
+    }
+    avdModelUpdateWorldMatrices(&benchmark.model);
+
+    benchmark.movedStride       = 1;
+    AVD_BenchCase recomputeCase = {
+        .name               = "model/world_recompute_16k",
+        .unit               = "nodes",
+        .itemsPerRepetition = nodeCount,
+        .run                = PRIV_avdModelBenchmarkWorldRecompute,
+        .userData           = &benchmark,
+    };
+    bool ok = avdBenchRun(bench, &recomputeCase);
+
+    for (AVD_Size i = 0; ok && i < AVD_ARRAY_COUNT(cases); i++) {
+        if (!avdBenchIsSelected(bench, cases[i].name)) {
+            continue;
+        }
+        // flush what the previous case left dirty before counting
+        avdModelUpdateWorldMatrices(&benchmark.model);
+        benchmark.movedStride = cases[i].movedStride;
+        PRIV_avdModelBenchmarkWorldUpdate(&benchmark);
+        AVD_LOG_INFO("%s: %zu of %zu world matrices redone per frame", cases[i].name, benchmark.redoneNodes, nodeCount);
+
+        AVD_BenchCase updateCase = {
+            .name               = cases[i].name,
+            .unit               = "nodes",
+            .itemsPerRepetition = nodeCount,
+            .run                = PRIV_avdModelBenchmarkWorldUpdate,
+            .userData           = &benchmark,
+        };
+        ok = avdBenchRun(bench, &updateCase);
+    }
+
+    AVD_FREE(benchmark.world);
+    avdModelDestroy(&benchmark.model);
+    return ok;
+}
+
+// The model of the deccer cubes scene, skipped when the assets have not been
+// downloaded next to the working directory.
+static bool PRIV_avdModelBenchmarkDeccerCubes(AVD_Bench *bench)
+{
+    const char *name = "model/traverse_deccer_cubes";
+    const char *path = "assets/scene_deccer_cubes/SM_Deccer_Cubes_Textured_Complex.gltf";
+    if (!avdBenchIsSelected(bench, name)) {
+        return true;
+    }
+    if (!avdPathExists(path)) {
+        AVD_LOG_WARN("Skipping the deccer cubes traversal benchmark, %s was not found", path);
+        return true;
+    }
+
+    AVD_ModelBenchmark benchmark = {0};
+    AVD_ModelResources resources = {0};
+    AVD_CHECK(avdModelCreate(&benchmark.model, 0));
+    AVD_CHECK(avdModelResourcesCreate(&resources));
+
+    bool ok        = avdModelLoadGltf(path, &benchmark.model, &resources, AVD_GLT_LOAD_FLAG_NONE);
+    benchmark.root = benchmark.model.mainScene >= 0 ? benchmark.model.mainScene : AVD_MODEL_ROOT_NODE;
+    ok             = ok && PRIV_avdModelBenchmarkRun(bench, &benchmark, name);
+
+    avdModelResourcesDestroy(&resources);
+    avdModelDestroy(&benchmark.model);
+    return ok;
+}
+
+bool avdModelBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD Model benchmarks...");
+
+    bool ok = PRIV_avdModelBenchmarkTree(bench);
+    ok      = ok && PRIV_avdModelBenchmarkWorldMatrices(bench);
+    ok      = ok && PRIV_avdModelBenchmarkDeccerCubes(bench);
+    return ok;
+}
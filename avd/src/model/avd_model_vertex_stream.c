@@ -0,0 +1,431 @@
+#include "model/avd_model_vertex_stream.h"
+
+#if !defined(AVD_VERTEX_STREAM_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AVD_VERTEX_STREAM_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+// arm64 only, the packer divides and 32 bit NEON can not
+#define AVD_VERTEX_STREAM_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#if defined(AVD_VERTEX_STREAM_SSE2) || defined(AVD_VERTEX_STREAM_NEON)
+#define AVD_VERTEX_STREAM_SIMD
+#endif
+
+// A packed vertex seen as four little endian words: vx | vy << 16,
+// vz | tp << 16, np and tu | tv << 16.
+#define AVD_VERTEX_STREAM_WORD_COUNT 4
+
+typedef struct {
+    AVD_Float position[3][AVD_VERTEX_STREAM_BLOCK_SIZE];
+    AVD_Float normal[3][AVD_VERTEX_STREAM_BLOCK_SIZE];
+    AVD_Float tangent[4][AVD_VERTEX_STREAM_BLOCK_SIZE];
+    AVD_Float texCoord[2][AVD_VERTEX_STREAM_BLOCK_SIZE];
+} AVD_VertexStreamBlock;
+
+static bool PRIV_avdVertexStreamSimdEnabled = true;
+
+AVD_Size avdVertexStreamFormatSize(AVD_VertexStreamFormat format)
+{
+    switch (format) {
+        case AVD_VERTEX_STREAM_FORMAT_FLOAT:
+            return sizeof(AVD_Float);
+        case AVD_VERTEX_STREAM_FORMAT_UNORM8:
+        case AVD_VERTEX_STREAM_FORMAT_SNORM8:
+            return 1;
+        case AVD_VERTEX_STREAM_FORMAT_UNORM16:
+        case AVD_VERTEX_STREAM_FORMAT_SNORM16:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+// Decodes the components of count elements into the lanes of a block, one
+// loop per format so the common float layouts compile to plain loads.
+static void PRIV_avdVertexStreamDecode(const AVD_VertexStream *stream, AVD_Size first, AVD_Size count, AVD_Float (*lanes)[AVD_VERTEX_STREAM_BLOCK_SIZE], AVD_UInt32 components)
+{
+    const AVD_UInt8 *data = (const AVD_UInt8 *)stream->data + first * stream->stride;
+    AVD_UInt32 decoded    = AVD_MIN(stream->components, components);
+
+    switch (stream->format) {
+        case AVD_VERTEX_STREAM_FORMAT_FLOAT:
+            if (decoded == 3 && stream->stride == sizeof(AVD_Float) * 3) {
+                const AVD_Float *values = (const AVD_Float *)data;
+                for (AVD_Size i = 0; i < count; i++) {
+                    lanes[0][i] = values[i * 3 + 0];
+                    lanes[1][i] = values[i * 3 + 1];
+                    lanes[2][i] = values[i * 3 + 2];
+                }
+            } else if (decoded == 2 && stream->stride == sizeof(AVD_Float) * 2) {
+                const AVD_Float *values = (const AVD_Float *)data;
+                for (AVD_Size i = 0; i < count; i++) {
+                    lanes[0][i] = values[i * 2 + 0];
+                    lanes[1][i] = values[i * 2 + 1];
+                }
+            } else {
+                // interleaved, the stride need not be a multiple of four either
+                for (AVD_Size i = 0; i < count; i++) {
+                    AVD_Float values[4];
+                    memcpy(values, data + i * stream->stride, sizeof(AVD_Float) * decoded);
+                    for (AVD_UInt32 component = 0; component < decoded; component++) {
+                        lanes[component][i] = values[component];
+                    }
+                }
+            }
+            break;
+        case AVD_VERTEX_STREAM_FORMAT_UNORM8:
+            for (AVD_Size i = 0; i < count; i++) {
+                for (AVD_UInt32 component = 0; component < decoded; component++) {
+                    lanes[component][i] = (AVD_Float)data[i * stream->stride + component] / 255.0f;
+                }
+            }
+            break;
+        case AVD_VERTEX_STREAM_FORMAT_SNORM8:
+            for (AVD_Size i = 0; i < count; i++) {
+                for (AVD_UInt32 component = 0; component < decoded; component++) {
+                    lanes[component][i] = AVD_MAX((AVD_Float)(AVD_Int8)data[i * stream->stride + component] / 127.0f, -1.0f);
+                }
+            }
+            break;
+        case AVD_VERTEX_STREAM_FORMAT_UNORM16:
+            for (AVD_Size i = 0; i < count; i++) {
+                AVD_UInt16 values[4];
+                memcpy(values, data + i * stream->stride, sizeof(AVD_UInt16) * decoded);
+                for (AVD_UInt32 component = 0; component < decoded; component++) {
+                    lanes[component][i] = (AVD_Float)values[component] / 65535.0f;
+                }
+            }
+            break;
+        case AVD_VERTEX_STREAM_FORMAT_SNORM16:
+            for (AVD_Size i = 0; i < count; i++) {
+                AVD_Int16 values[4];
+                memcpy(values, data + i * stream->stride, sizeof(AVD_Int16) * decoded);
+                for (AVD_UInt32 component = 0; component < decoded; component++) {
+                    lanes[component][i] = AVD_MAX((AVD_Float)values[component] / 32767.0f, -1.0f);
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Bits of every packed word that come from the streams that are present.
+static void PRIV_avdVertexStreamsWordMask(const AVD_VertexStreams *streams, AVD_UInt32 *outMask)
+{
+    memset(outMask, 0, sizeof(AVD_UInt32) * AVD_VERTEX_STREAM_WORD_COUNT);
+    if (streams->position.data != NULL) {
+        outMask[0] = 0xffffffffu;
+        outMask[1] |= 0x0000ffffu;
+    }
+    if (streams->normal.data != NULL) {
+        outMask[2] |= 0x3fffffffu;
+    }
+    if (streams->tangent.data != NULL) {
+        outMask[1] |= 0xffff0000u;
+        outMask[2] |= 0x40000000u;
+    }
+    if (streams->texCoord.data != NULL) {
+        outMask[3] = 0xffffffffu;
+    }
+}
+
+static void PRIV_avdVertexStreamPackBlockScalar(const AVD_VertexStreamBlock *block, AVD_Size count, const AVD_UInt32 *mask, const AVD_ModelVertexPacked *defaults, AVD_ModelVertexPacked *out)
+{
+    for (AVD_Size i = 0; i < count; i++) {
+        AVD_ModelVertex vertex = {
+            .position = avdVec3(block->position[0][i], block->position[1][i], block->position[2][i]),
+            .normal   = avdVec3(block->normal[0][i], block->normal[1][i], block->normal[2][i]),
+            .texCoord = avdVec2(block->texCoord[0][i], block->texCoord[1][i]),
+            .tangent  = avdVec4(block->tangent[0][i], block->tangent[1][i], block->tangent[2][i], block->tangent[3][i]),
+        };
+        avdModelVertexPack(&vertex, &out[i]);
+        if (defaults != NULL) {
+            AVD_UInt32 words[AVD_VERTEX_STREAM_WORD_COUNT];
+            AVD_UInt32 defaultWords[AVD_VERTEX_STREAM_WORD_COUNT];
+            memcpy(words, &out[i], sizeof(words));
+            memcpy(defaultWords, &defaults[i], sizeof(defaultWords));
+            for (AVD_UInt32 word = 0; word < AVD_VERTEX_STREAM_WORD_COUNT; word++) {
+                words[word] = (words[word] & mask[word]) | (defaultWords[word] & ~mask[word]);
+            }
+            memcpy(&out[i], words, sizeof(words));
+        }
+    }
+}
+
+#if defined(AVD_VERTEX_STREAM_SSE2)
+
+typedef __m128 AVD_VertexStreamFloat4;
+typedef __m128i AVD_VertexStreamInt4;
+
+#define PRIV_avdVsLoad(ptr)               _mm_loadu_ps(ptr)
+#define PRIV_avdVsSplat(value)            _mm_set1_ps(value)
+#define PRIV_avdVsSplatInt(value)         _mm_set1_epi32(value)
+#define PRIV_avdVsAdd(a, b)               _mm_add_ps((a), (b))
+#define PRIV_avdVsSub(a, b)               _mm_sub_ps((a), (b))
+#define PRIV_avdVsMul(a, b)               _mm_mul_ps((a), (b))
+#define PRIV_avdVsDiv(a, b)               _mm_div_ps((a), (b))
+#define PRIV_avdVsAbs(v)                  _mm_andnot_ps(_mm_set1_ps(-0.0f), (v))
+#define PRIV_avdVsNegate(v)               _mm_xor_ps(_mm_set1_ps(-0.0f), (v))
+#define PRIV_avdVsGreaterEqual(a, b)      _mm_castps_si128(_mm_cmpge_ps((a), (b)))
+#define PRIV_avdVsLessEqual(a, b)         _mm_castps_si128(_mm_cmple_ps((a), (b)))
+#define PRIV_avdVsTruncate(v)             _mm_cvttps_epi32(v)
+#define PRIV_avdVsBits(v)                 _mm_castps_si128(v)
+#define PRIV_avdVsAndInt(a, b)            _mm_and_si128((a), (b))
+#define PRIV_avdVsOrInt(a, b)             _mm_or_si128((a), (b))
+#define PRIV_avdVsAddInt(a, b)            _mm_add_epi32((a), (b))
+#define PRIV_avdVsShiftLeft(v, bits)      _mm_slli_epi32((v), (bits))
+#define PRIV_avdVsShiftRight(v, bits)     _mm_srli_epi32((v), (bits))
+#define PRIV_avdVsShiftRightSign(v, bits) _mm_srai_epi32((v), (bits))
+#define PRIV_avdVsLessInt(a, b)           _mm_cmplt_epi32((a), (b))
+#define PRIV_avdVsGreaterInt(a, b)        _mm_cmpgt_epi32((a), (b))
+
+static inline AVD_VertexStreamFloat4 PRIV_avdVsSelect(AVD_VertexStreamInt4 mask, AVD_VertexStreamFloat4 a, AVD_VertexStreamFloat4 b)
+{
+    __m128 maskFloat = _mm_castsi128_ps(mask);
+    return _mm_or_ps(_mm_and_ps(maskFloat, a), _mm_andnot_ps(maskFloat, b));
+}
+
+static inline AVD_VertexStreamInt4 PRIV_avdVsSelectInt(AVD_VertexStreamInt4 mask, AVD_VertexStreamInt4 a, AVD_VertexStreamInt4 b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Transposes the four words of four vertices and blends in the defaults.
+static inline void PRIV_avdVsStore(AVD_ModelVertexPacked *out, const AVD_ModelVertexPacked *defaults, const AVD_UInt32 *mask, AVD_VertexStreamInt4 *words)
+{
+    __m128i low01       = _mm_unpacklo_epi32(words[0], words[1]);
+    __m128i low23       = _mm_unpacklo_epi32(words[2], words[3]);
+    __m128i high01      = _mm_unpackhi_epi32(words[0], words[1]);
+    __m128i high23      = _mm_unpackhi_epi32(words[2], words[3]);
+    __m128i vertices[4] = {
+        _mm_unpacklo_epi64(low01, low23),
+        _mm_unpackhi_epi64(low01, low23),
+        _mm_unpacklo_epi64(high01, high23),
+        _mm_unpackhi_epi64(high01, high23),
+    };
+
+    __m128i blend = _mm_loadu_si128((const __m128i *)mask);
+    for (AVD_UInt32 i = 0; i < 4; i++) {
+        if (defaults != NULL) {
+            vertices[i] = PRIV_avdVsSelectInt(blend, vertices[i], _mm_loadu_si128((const __m128i *)&defaults[i]));
+        }
+        _mm_storeu_si128((__m128i *)&out[i], vertices[i]);
+    }
+}
+
+#elif defined(AVD_VERTEX_STREAM_NEON)
+
+typedef float32x4_t AVD_VertexStreamFloat4;
+typedef int32x4_t AVD_VertexStreamInt4;
+
+#define PRIV_avdVsLoad(ptr)               vld1q_f32(ptr)
+#define PRIV_avdVsSplat(value)            vdupq_n_f32(value)
+#define PRIV_avdVsSplatInt(value)         vdupq_n_s32(value)
+#define PRIV_avdVsAdd(a, b)               vaddq_f32((a), (b))
+#define PRIV_avdVsSub(a, b)               vsubq_f32((a), (b))
+#define PRIV_avdVsMul(a, b)               vmulq_f32((a), (b))
+#define PRIV_avdVsDiv(a, b)               vdivq_f32((a), (b))
+#define PRIV_avdVsAbs(v)                  vabsq_f32(v)
+#define PRIV_avdVsNegate(v)               vnegq_f32(v)
+#define PRIV_avdVsGreaterEqual(a, b)      vreinterpretq_s32_u32(vcgeq_f32((a), (b)))
+#define PRIV_avdVsLessEqual(a, b)         vreinterpretq_s32_u32(vcleq_f32((a), (b)))
+#define PRIV_avdVsTruncate(v)             vcvtq_s32_f32(v)
+#define PRIV_avdVsBits(v)                 vreinterpretq_s32_f32(v)
+#define PRIV_avdVsAndInt(a, b)            vandq_s32((a), (b))
+#define PRIV_avdVsOrInt(a, b)             vorrq_s32((a), (b))
+#define PRIV_avdVsAddInt(a, b)            vaddq_s32((a), (b))
+#define PRIV_avdVsShiftLeft(v, bits)      vshlq_n_s32((v), (bits))
+#define PRIV_avdVsShiftRight(v, bits)     vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(v), (bits)))
+#define PRIV_avdVsShiftRightSign(v, bits) vshrq_n_s32((v), (bits))
+#define PRIV_avdVsLessInt(a, b)           vreinterpretq_s32_u32(vcltq_s32((a), (b)))
+#define PRIV_avdVsGreaterInt(a, b)        vreinterpretq_s32_u32(vcgtq_s32((a), (b)))
+
+static inline AVD_VertexStreamFloat4 PRIV_avdVsSelect(AVD_VertexStreamInt4 mask, AVD_VertexStreamFloat4 a, AVD_VertexStreamFloat4 b)
+{
+    return vbslq_f32(vreinterpretq_u32_s32(mask), a, b);
+}
+
+static inline AVD_VertexStreamInt4 PRIV_avdVsSelectInt(AVD_VertexStreamInt4 mask, AVD_VertexStreamInt4 a, AVD_VertexStreamInt4 b)
+{
+    return vbslq_s32(vreinterpretq_u32_s32(mask), a, b);
+}
+
+// The interleaving store writes the four words of four vertices in order, the
+// defaults are blended in before it.
+static inline void PRIV_avdVsStore(AVD_ModelVertexPacked *out, const AVD_ModelVertexPacked *defaults, const AVD_UInt32 *mask, AVD_VertexStreamInt4 *words)
+{
+    uint32x4x4_t vertices = {{
+        vreinterpretq_u32_s32(words[0]),
+        vreinterpretq_u32_s32(words[1]),
+        vreinterpretq_u32_s32(words[2]),
+        vreinterpretq_u32_s32(words[3]),
+    }};
+    if (defaults != NULL) {
+        uint32x4x4_t defaultWords = vld4q_u32((const uint32_t *)defaults);
+        for (AVD_UInt32 i = 0; i < AVD_VERTEX_STREAM_WORD_COUNT; i++) {
+            vertices.val[i] = vbslq_u32(vdupq_n_u32(mask[i]), vertices.val[i], defaultWords.val[i]);
+        }
+    }
+    vst4q_u32((uint32_t *)out, vertices);
+}
+
+#endif
+
+#if defined(AVD_VERTEX_STREAM_SIMD)
+
+// avdQuantizeHalf on four lanes.
+static inline AVD_VertexStreamInt4 PRIV_avdVertexStreamHalf(AVD_VertexStreamFloat4 value)
+{
+    AVD_VertexStreamInt4 bits = PRIV_avdVsBits(value);
+    AVD_VertexStreamInt4 sign = PRIV_avdVsAndInt(PRIV_avdVsShiftRight(bits, 16), PRIV_avdVsSplatInt(0x8000));
+    AVD_VertexStreamInt4 em   = PRIV_avdVsAndInt(bits, PRIV_avdVsSplatInt(0x7fffffff));
+
+    AVD_VertexStreamInt4 half = PRIV_avdVsShiftRightSign(PRIV_avdVsAddInt(em, PRIV_avdVsSplatInt(-(112 << 23) + (1 << 12))), 13);
+    half                      = PRIV_avdVsSelectInt(PRIV_avdVsLessInt(em, PRIV_avdVsSplatInt(113 << 23)), PRIV_avdVsSplatInt(0), half);
+    half                      = PRIV_avdVsSelectInt(PRIV_avdVsGreaterInt(em, PRIV_avdVsSplatInt((143 << 23) - 1)), PRIV_avdVsSplatInt(0x7c00), half);
+    half                      = PRIV_avdVsSelectInt(PRIV_avdVsGreaterInt(em, PRIV_avdVsSplatInt(255 << 23)), PRIV_avdVsSplatInt(0x7e00), half);
+    return PRIV_avdVsOrInt(sign, half);
+}
+
+// avdQuantizeSnorm on four lanes, offset to be unsigned like the packed fields.
+static inline AVD_VertexStreamInt4 PRIV_avdVertexStreamSnorm(AVD_VertexStreamFloat4 value, int bits)
+{
+    AVD_Float scale             = (AVD_Float)((1 << (bits - 1)) - 1);
+    AVD_VertexStreamFloat4 zero = PRIV_avdVsSplat(0.0f);
+    AVD_VertexStreamFloat4 one  = PRIV_avdVsSplat(1.0f);
+    // NaN compares false everywhere and ends up at -1 as in the scalar code
+    AVD_VertexStreamFloat4 round = PRIV_avdVsSelect(PRIV_avdVsGreaterEqual(value, zero), PRIV_avdVsSplat(0.5f), PRIV_avdVsSplat(-0.5f));
+    value                        = PRIV_avdVsSelect(PRIV_avdVsGreaterEqual(value, PRIV_avdVsNegate(one)), value, PRIV_avdVsNegate(one));
+    value                        = PRIV_avdVsSelect(PRIV_avdVsLessEqual(value, one), value, one);
+    // no fused multiply add, the scalar code rounds the product first
+    AVD_VertexStreamInt4 snorm = PRIV_avdVsTruncate(PRIV_avdVsAdd(PRIV_avdVsMul(value, PRIV_avdVsSplat(scale)), round));
+    return PRIV_avdVsAddInt(snorm, PRIV_avdVsSplatInt((int)scale));
+}
+
+// avdModelVertexPack for four vertices of a block at once.
+static void PRIV_avdVertexStreamPackBlockSimd(const AVD_VertexStreamBlock *block, AVD_Size count, const AVD_UInt32 *mask, const AVD_ModelVertexPacked *defaults, AVD_ModelVertexPacked *out)
+{
+    for (AVD_Size i = 0; i < count; i += 4) {
+        AVD_VertexStreamInt4 vx = PRIV_avdVertexStreamHalf(PRIV_avdVsLoad(&block->position[0][i]));
+        AVD_VertexStreamInt4 vy = PRIV_avdVertexStreamHalf(PRIV_avdVsLoad(&block->position[1][i]));
+        AVD_VertexStreamInt4 vz = PRIV_avdVertexStreamHalf(PRIV_avdVsLoad(&block->position[2][i]));
+        AVD_VertexStreamInt4 tu = PRIV_avdVertexStreamHalf(PRIV_avdVsLoad(&block->texCoord[0][i]));
+        AVD_VertexStreamInt4 tv = PRIV_avdVertexStreamHalf(PRIV_avdVsLoad(&block->texCoord[1][i]));
+
+        // octahedral tangent
+        AVD_VertexStreamFloat4 tx   = PRIV_avdVsLoad(&block->tangent[0][i]);
+        AVD_VertexStreamFloat4 ty   = PRIV_avdVsLoad(&block->tangent[1][i]);
+        AVD_VertexStreamFloat4 tz   = PRIV_avdVsLoad(&block->tangent[2][i]);
+        AVD_VertexStreamFloat4 tw   = PRIV_avdVsLoad(&block->tangent[3][i]);
+        AVD_VertexStreamFloat4 zero = PRIV_avdVsSplat(0.0f);
+        AVD_VertexStreamFloat4 tsum = PRIV_avdVsAdd(PRIV_avdVsAdd(PRIV_avdVsAbs(tx), PRIV_avdVsAbs(ty)), PRIV_avdVsAbs(tz));
+        AVD_VertexStreamFloat4 dx   = PRIV_avdVsDiv(tx, tsum);
+        AVD_VertexStreamFloat4 dy   = PRIV_avdVsDiv(ty, tsum);
+        AVD_VertexStreamFloat4 fx   = PRIV_avdVsSub(PRIV_avdVsSplat(1.0f), PRIV_avdVsAbs(dy));
+        AVD_VertexStreamFloat4 fy   = PRIV_avdVsSub(PRIV_avdVsSplat(1.0f), PRIV_avdVsAbs(dx));
+        fx                          = PRIV_avdVsSelect(PRIV_avdVsGreaterEqual(tx, zero), fx, PRIV_avdVsNegate(fx));
+        fy                          = PRIV_avdVsSelect(PRIV_avdVsGreaterEqual(ty, zero), fy, PRIV_avdVsNegate(fy));
+        AVD_VertexStreamInt4 front  = PRIV_avdVsGreaterEqual(tz, zero);
+        AVD_VertexStreamInt4 tp     = PRIV_avdVertexStreamSnorm(PRIV_avdVsSelect(front, dx, fx), 8);
+        tp                          = PRIV_avdVsOrInt(tp, PRIV_avdVsShiftLeft(PRIV_avdVertexStreamSnorm(PRIV_avdVsSelect(front, dy, fy), 8), 8));
+
+        AVD_VertexStreamInt4 np = PRIV_avdVertexStreamSnorm(PRIV_avdVsLoad(&block->normal[0][i]), 10);
+        np                      = PRIV_avdVsOrInt(np, PRIV_avdVsShiftLeft(PRIV_avdVertexStreamSnorm(PRIV_avdVsLoad(&block->normal[1][i]), 10), 10));
+        np                      = PRIV_avdVsOrInt(np, PRIV_avdVsShiftLeft(PRIV_avdVertexStreamSnorm(PRIV_avdVsLoad(&block->normal[2][i]), 10), 20));
+        np                      = PRIV_avdVsSelectInt(PRIV_avdVsGreaterEqual(tw, zero), np, PRIV_avdVsOrInt(np, PRIV_avdVsSplatInt(1 << 30)));
+
+        AVD_VertexStreamInt4 words[AVD_VERTEX_STREAM_WORD_COUNT] = {
+            PRIV_avdVsOrInt(vx, PRIV_avdVsShiftLeft(vy, 16)),
+            PRIV_avdVsOrInt(vz, PRIV_avdVsShiftLeft(tp, 16)),
+            np,
+            PRIV_avdVsOrInt(tu, PRIV_avdVsShiftLeft(tv, 16)),
+        };
+
+        // the block lanes past count are packed too but not stored
+        if (i + 4 <= count) {
+            PRIV_avdVsStore(out + i, defaults != NULL ? defaults + i : NULL, mask, words);
+        } else {
+            AVD_ModelVertexPacked tail[4];
+            AVD_ModelVertexPacked tailDefaults[4] = {0};
+            if (defaults != NULL) {
+                memcpy(tailDefaults, defaults + i, sizeof(AVD_ModelVertexPacked) * (count - i));
+            }
+            PRIV_avdVsStore(tail, defaults != NULL ? tailDefaults : NULL, mask, words);
+            memcpy(out + i, tail, sizeof(AVD_ModelVertexPacked) * (count - i));
+        }
+    }
+}
+
+#endif
+
+bool avdVertexStreamsPack(const AVD_VertexStreams *streams, AVD_Size count, const AVD_ModelVertexPacked *defaults, AVD_ModelVertexPacked *out)
+{
+    AVD_ASSERT(streams != NULL);
+    AVD_ASSERT(out != NULL || count == 0);
+
+    const AVD_VertexStream *attributes[] = {&streams->position, &streams->normal, &streams->tangent, &streams->texCoord};
+    for (AVD_Size i = 0; i < AVD_ARRAY_COUNT(attributes); i++) {
+        const AVD_VertexStream *stream = attributes[i];
+        AVD_CHECK_MSG(
+            stream->data == NULL || (stream->format != AVD_VERTEX_STREAM_FORMAT_NONE && avdVertexStreamFormatSize(stream->format) * AVD_MIN(stream->components, 4u) <= stream->stride),
+            "Vertex stream %zu has no format or elements larger than its stride of %zu bytes",
+            i,
+            stream->stride);
+    }
+
+    AVD_UInt32 mask[AVD_VERTEX_STREAM_WORD_COUNT];
+    PRIV_avdVertexStreamsWordMask(streams, mask);
+
+    // lanes of missing attributes stay zero
+    AVD_VertexStreamBlock block;
+    memset(&block, 0, sizeof(block));
+    for (AVD_Size first = 0; first < count; first += AVD_VERTEX_STREAM_BLOCK_SIZE) {
+        AVD_Size blockCount = AVD_MIN(count - first, (AVD_Size)AVD_VERTEX_STREAM_BLOCK_SIZE);
+        if (streams->position.data != NULL) {
+            PRIV_avdVertexStreamDecode(&streams->position, first, blockCount, block.position, 3);
+        }
+        if (streams->normal.data != NULL) {
+            PRIV_avdVertexStreamDecode(&streams->normal, first, blockCount, block.normal, 3);
+        }
+        if (streams->tangent.data != NULL) {
+            PRIV_avdVertexStreamDecode(&streams->tangent, first, blockCount, block.tangent, 4);
+        }
+        if (streams->texCoord.data != NULL) {
+            PRIV_avdVertexStreamDecode(&streams->texCoord, first, blockCount, block.texCoord, 2);
+        }
+
+        const AVD_ModelVertexPacked *blockDefaults = defaults != NULL ? defaults + first : NULL;
+#if defined(AVD_VERTEX_STREAM_SIMD)
+        if (PRIV_avdVertexStreamSimdEnabled) {
+            PRIV_avdVertexStreamPackBlockSimd(&block, blockCount, mask, blockDefaults, out + first);
+            continue;
+        }
+#endif
+        PRIV_avdVertexStreamPackBlockScalar(&block, blockCount, mask, blockDefaults, out + first);
+    }
+    return true;
+}
+
+const char *avdVertexStreamBackendName(void)
+{
+    if (!PRIV_avdVertexStreamSimdEnabled) {
+        return "scalar";
+    }
+#if defined(AVD_VERTEX_STREAM_SSE2)
+    return "sse2";
+#elif defined(AVD_VERTEX_STREAM_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+void avdVertexStreamSetSimdEnabled(bool enabled)
+{
+    PRIV_avdVertexStreamSimdEnabled = enabled;
+}
@@ -0,0 +1,398 @@
+#include "core/avd_core.h"
+#include "model/avd_3d_scene.h"
+
+// Position, normal, tangent and texture coordinate of one vertex, the way a
+// glTF exporter usually interleaves them.
+#define AVD_VERTEX_STREAM_TEST_FLOATS 12
+
+// Not multiples of the block size, the last block of every pack is short.
+#define AVD_VERTEX_STREAM_TEST_NORMALIZED_COUNT 333
+#define AVD_VERTEX_STREAM_TEST_DEFAULTS_COUNT   130
+
+static AVD_UInt32 PRIV_avdVertexStreamTestRandom(AVD_UInt32 *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+static AVD_Float PRIV_avdVertexStreamTestFloat(AVD_UInt32 *state, AVD_Float range)
+{
+    return ((AVD_Float)PRIV_avdVertexStreamTestRandom(state) / 16777216.0f * 2.0f - 1.0f) * range;
+}
+
+// Interleaved vertices with a few that stress the quantization: zero and
+// negative tangents, values past the half range, denormals and NaN.
+static void PRIV_avdVertexStreamTestFill(AVD_Float *vertices, AVD_Size count, AVD_UInt32 seed)
+{
+    AVD_UInt32 state = seed;
+    for (AVD_Size i = 0; i < count; i++) {
+        AVD_Float *vertex = vertices + i * AVD_VERTEX_STREAM_TEST_FLOATS;
+        for (AVD_UInt32 component = 0; component < AVD_VERTEX_STREAM_TEST_FLOATS; component++) {
+            vertex[component] = PRIV_avdVertexStreamTestFloat(&state, component < 3 ? 100.0f : 1.0f);
+        }
+        vertex[9] = vertex[9] < 0.0f ? -1.0f : 1.0f;
+        switch (i % 16) {
+            case 1:
+                memset(vertex + 6, 0, sizeof(AVD_Float) * 4);
+                break;
+            case 2:
+                vertex[0] = 1.0e6f;
+                vertex[1] = -70000.0f;
+                vertex[2] = 1.0e-30f;
+                break;
+            case 3:
+                vertex[3]  = NAN;
+                vertex[10] = NAN;
+                break;
+            case 4:
+                vertex[3] = 1.5f;
+                vertex[4] = -1.5f;
+                vertex[8] = -0.0f;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static AVD_VertexStreams PRIV_avdVertexStreamTestStreams(const AVD_Float *vertices)
+{
+    AVD_Size stride           = sizeof(AVD_Float) * AVD_VERTEX_STREAM_TEST_FLOATS;
+    AVD_VertexStreams streams = {
+        .position = {.data = vertices + 0, .stride = stride, .format = AVD_VERTEX_STREAM_FORMAT_FLOAT, .components = 3},
+        .normal   = {.data = vertices + 3, .stride = stride, .format = AVD_VERTEX_STREAM_FORMAT_FLOAT, .components = 3},
+        .tangent  = {.data = vertices + 6, .stride = stride, .format = AVD_VERTEX_STREAM_FORMAT_FLOAT, .components = 4},
+        .texCoord = {.data = vertices + 10, .stride = stride, .format = AVD_VERTEX_STREAM_FORMAT_FLOAT, .components = 2},
+    };
+    return streams;
+}
+
+static void PRIV_avdVertexStreamTestReference(const AVD_Float *vertices, AVD_Size count, AVD_ModelVertexPacked *out)
+{
+    for (AVD_Size i = 0; i < count; i++) {
+        const AVD_Float *vertex  = vertices + i * AVD_VERTEX_STREAM_TEST_FLOATS;
+        AVD_ModelVertex unpacked = {0};
+        unpacked.position        = avdVec3(vertex[0], vertex[1], vertex[2]);
+        unpacked.normal          = avdVec3(vertex[3], vertex[4], vertex[5]);
+        unpacked.tangent         = avdVec4(vertex[6], vertex[7], vertex[8], vertex[9]);
+        unpacked.texCoord        = avdVec2(vertex[10], vertex[11]);
+        avdModelVertexPack(&unpacked, &out[i]);
+    }
+}
+
+// Packs with the SIMD and the scalar packer, both have to match the expected
+// vertices bit for bit.
+static bool PRIV_avdVertexStreamTestPack(const AVD_VertexStreams *streams, AVD_Size count, const AVD_ModelVertexPacked *defaults, const AVD_ModelVertexPacked *expected, const char *name)
+{
+    AVD_ModelVertexPacked *packed = (AVD_ModelVertexPacked *)AVD_MALLOC(sizeof(AVD_ModelVertexPacked) * AVD_MAX(count, (AVD_Size)1));
+    AVD_CHECK_MSG(packed != NULL, "Failed to allocate %zu packed vertices", count);
+
+    bool ok = true;
+    for (AVD_UInt32 simd = 0; ok && simd < 2; simd++) {
+        avdVertexStreamSetSimdEnabled(simd == 0);
+        memset(packed, 0xcd, sizeof(AVD_ModelVertexPacked) * count);
+        ok = avdVertexStreamsPack(streams, count, defaults, packed);
+        for (AVD_Size i = 0; ok && i < count; i++) {
+            if (memcmp(&packed[i], &expected[i], sizeof(AVD_ModelVertexPacked)) != 0) {
+                AVD_LOG_ERROR("Vertex %zu of %zu packed with the %s packer differs for %s", i, count, avdVertexStreamBackendName(), name);
+                ok = false;
+            }
+        }
+    }
+    avdVertexStreamSetSimdEnabled(true);
+
+    AVD_FREE(packed);
+    return ok;
+}
+
+static bool PRIV_avdVertexStreamTestFloatStreams(void)
+{
+    AVD_LOG_DEBUG("  Testing float vertex streams with the %s packer...", avdVertexStreamBackendName());
+
+    static const AVD_Size counts[] = {0, 1, 3, 4, 63, 64, 65, 1001};
+    AVD_Size maxCount              = counts[AVD_ARRAY_COUNT(counts) - 1];
+    AVD_Float *vertices            = (AVD_Float *)AVD_MALLOC(sizeof(AVD_Float) * AVD_VERTEX_STREAM_TEST_FLOATS * maxCount);
+    AVD_Float *positions           = (AVD_Float *)AVD_MALLOC(sizeof(AVD_Float) * 3 * maxCount);
+    AVD_ModelVertexPacked *packed  = (AVD_ModelVertexPacked *)AVD_MALLOC(sizeof(AVD_ModelVertexPacked) * maxCount);
+    AVD_ModelVertexPacked *zero    = (AVD_ModelVertexPacked *)AVD_MALLOC(sizeof(AVD_ModelVertexPacked) * maxCount);
+    AVD_CHECK_MSG(vertices != NULL && positions != NULL && packed != NULL && zero != NULL, "Failed to allocate the vertex stream test data");
+
+    PRIV_avdVertexStreamTestFill(vertices, maxCount, 0x5eed);
+    PRIV_avdVertexStreamTestReference(vertices, maxCount, packed);
+    AVD_VertexStreams streams = PRIV_avdVertexStreamTestStreams(vertices);
+
+    // the same positions tightly packed, the other attributes packed from zero
+    AVD_VertexStreams positionOnly = {
+        .position = {.data = positions, .stride = sizeof(AVD_Float) * 3, .format = AVD_VERTEX_STREAM_FORMAT_FLOAT, .components = 3},
+    };
+    AVD_ModelVertex origin = {0};
+    for (AVD_Size i = 0; i < maxCount; i++) {
+        memcpy(positions + i * 3, vertices + i * AVD_VERTEX_STREAM_TEST_FLOATS, sizeof(AVD_Float) * 3);
+        origin.position = avdVec3(positions[i * 3 + 0], positions[i * 3 + 1], positions[i * 3 + 2]);
+        avdModelVertexPack(&origin, &zero[i]);
+    }
+
+    bool ok = true;
+    for (AVD_Size i = 0; ok && i < AVD_ARRAY_COUNT(counts); i++) {
+        ok = PRIV_avdVertexStreamTestPack(&streams, counts[i], NULL, packed, "interleaved floats");
+        ok = ok && PRIV_avdVertexStreamTestPack(&positionOnly, counts[i], NULL, zero, "tight positions");
+    }
+
+    AVD_FREE(vertices);
+    AVD_FREE(positions);
+    AVD_FREE(packed);
+    AVD_FREE(zero);
+    return ok;
+}
+
+static bool PRIV_avdVertexStreamTestNormalized(void)
+{
+    AVD_LOG_DEBUG("  Testing normalized vertex streams...");
+
+    // normals as snorm16, tangents as snorm8, uv as unorm16 and unorm8
+    typedef struct {
+        AVD_Int16 normal[3];
+        AVD_Int8 tangent[4];
+        AVD_UInt16 texCoord[2];
+        AVD_UInt8 texCoord8[2];
+    } AVD_VertexStreamTestVertex;
+
+    const AVD_Size count = AVD_VERTEX_STREAM_TEST_NORMALIZED_COUNT;
+    AVD_VertexStreamTestVertex vertices[AVD_VERTEX_STREAM_TEST_NORMALIZED_COUNT];
+    AVD_ModelVertexPacked expected[AVD_VERTEX_STREAM_TEST_NORMALIZED_COUNT];
+    AVD_ModelVertexPacked expected8[AVD_VERTEX_STREAM_TEST_NORMALIZED_COUNT];
+    AVD_UInt32 state = 0xface;
+    for (AVD_Size i = 0; i < count; i++) {
+        AVD_VertexStreamTestVertex *vertex = &vertices[i];
+        for (AVD_UInt32 component = 0; component < 4; component++) {
+            AVD_UInt32 random = PRIV_avdVertexStreamTestRandom(&state);
+            if (component < 3) {
+                vertex->normal[component] = (AVD_Int16)(i == 0 ? -32768 : (AVD_Int32)(random & 0xffff) - 32768);
+            }
+            vertex->tangent[component] = (AVD_Int8)(i == 0 ? -128 : (AVD_Int32)(random >> 8 & 0xff) - 128);
+            if (component < 2) {
+                vertex->texCoord[component]  = (AVD_UInt16)(random >> 4);
+                vertex->texCoord8[component] = (AVD_UInt8)(random >> 12);
+            }
+        }
+
+        // glTF decoding of normalized integers
+        AVD_ModelVertex unpacked = {0};
+        unpacked.normal          = avdVec3(
+            AVD_MAX(vertex->normal[0] / 32767.0f, -1.0f),
+            AVD_MAX(vertex->normal[1] / 32767.0f, -1.0f),
+            AVD_MAX(vertex->normal[2] / 32767.0f, -1.0f));
+        unpacked.tangent = avdVec4(
+            AVD_MAX(vertex->tangent[0] / 127.0f, -1.0f),
+            AVD_MAX(vertex->tangent[1] / 127.0f, -1.0f),
+            AVD_MAX(vertex->tangent[2] / 127.0f, -1.0f),
+            AVD_MAX(vertex->tangent[3] / 127.0f, -1.0f));
+        unpacked.texCoord = avdVec2(vertex->texCoord[0] / 65535.0f, vertex->texCoord[1] / 65535.0f);
+        avdModelVertexPack(&unpacked, &expected[i]);
+        unpacked.texCoord = avdVec2(vertex->texCoord8[0] / 255.0f, vertex->texCoord8[1] / 255.0f);
+        avdModelVertexPack(&unpacked, &expected8[i]);
+    }
+
+    AVD_VertexStreams streams = {
+        .normal   = {.data = vertices[0].normal, .stride = sizeof(AVD_VertexStreamTestVertex), .format = AVD_VERTEX_STREAM_FORMAT_SNORM16, .components = 3},
+        .tangent  = {.data = vertices[0].tangent, .stride = sizeof(AVD_VertexStreamTestVertex), .format = AVD_VERTEX_STREAM_FORMAT_SNORM8, .components = 4},
+        .texCoord = {.data = vertices[0].texCoord, .stride = sizeof(AVD_VertexStreamTestVertex), .format = AVD_VERTEX_STREAM_FORMAT_UNORM16, .components = 2},
+    };
+    AVD_CHECK(PRIV_avdVertexStreamTestPack(&streams, count, NULL, expected, "normalized integers"));
+
+    streams.texCoord = (AVD_VertexStream){.data = vertices[0].texCoord8, .stride = sizeof(AVD_VertexStreamTestVertex), .format = AVD_VERTEX_STREAM_FORMAT_UNORM8, .components = 2};
+    AVD_CHECK(PRIV_avdVertexStreamTestPack(&streams, count, NULL, expected8, "normalized bytes"));
+    return true;
+}
+
+static bool PRIV_avdVertexStreamTestDefaults(void)
+{
+    AVD_LOG_DEBUG("  Testing vertex stream defaults...");
+
+    const AVD_Size count = AVD_VERTEX_STREAM_TEST_DEFAULTS_COUNT;
+    AVD_Float *base      = (AVD_Float *)AVD_MALLOC(sizeof(AVD_Float) * AVD_VERTEX_STREAM_TEST_FLOATS * count);
+    AVD_Float *target    = (AVD_Float *)AVD_MALLOC(sizeof(AVD_Float) * AVD_VERTEX_STREAM_TEST_FLOATS * count);
+    AVD_CHECK_MSG(base != NULL && target != NULL, "Failed to allocate the vertex stream test data");
+    PRIV_avdVertexStreamTestFill(base, count, 0xba5e);
+    PRIV_avdVertexStreamTestFill(target, count, 0x7a26);
+
+    AVD_ModelVertexPacked defaults[AVD_VERTEX_STREAM_TEST_DEFAULTS_COUNT];
+    AVD_ModelVertexPacked packed[AVD_VERTEX_STREAM_TEST_DEFAULTS_COUNT];
+    AVD_ModelVertexPacked expected[AVD_VERTEX_STREAM_TEST_DEFAULTS_COUNT];
+    PRIV_avdVertexStreamTestReference(base, count, defaults);
+    PRIV_avdVertexStreamTestReference(target, count, packed);
+
+    // a morph target moving positions and normals only keeps the tangent
+    // (with its sign) and the uv of the base vertices
+    AVD_VertexStreams streams = PRIV_avdVertexStreamTestStreams(target);
+    streams.tangent.data      = NULL;
+    streams.texCoord.data     = NULL;
+    for (AVD_Size i = 0; i < count; i++) {
+        expected[i]    = defaults[i];
+        expected[i].vx = packed[i].vx;
+        expected[i].vy = packed[i].vy;
+        expected[i].vz = packed[i].vz;
+        expected[i].np = (packed[i].np & 0x3fffffffu) | (defaults[i].np & 0xc0000000u);
+    }
+    bool ok = PRIV_avdVertexStreamTestPack(&streams, count, defaults, expected, "position and normal over defaults");
+
+    // only a tangent, the sign moves into the normal word
+    streams               = PRIV_avdVertexStreamTestStreams(target);
+    streams.position.data = NULL;
+    streams.normal.data   = NULL;
+    streams.texCoord.data = NULL;
+    for (AVD_Size i = 0; i < count; i++) {
+        expected[i]    = defaults[i];
+        expected[i].tp = packed[i].tp;
+        expected[i].np = (defaults[i].np & ~0x40000000u) | (packed[i].np & 0x40000000u);
+    }
+    ok = ok && PRIV_avdVertexStreamTestPack(&streams, count, defaults, expected, "tangent over defaults");
+
+    AVD_VertexStreams empty = {0};
+    ok                      = ok && PRIV_avdVertexStreamTestPack(&empty, count, defaults, defaults, "no streams over defaults");
+
+    AVD_FREE(base);
+    AVD_FREE(target);
+    return ok;
+}
+
+static bool PRIV_avdVertexStreamTestInvalid(void)
+{
+    AVD_Float vertices[16]    = {0};
+    AVD_ModelVertexPacked out[4];
+    AVD_VertexStreams streams = {
+        .position = {.data = vertices, .stride = sizeof(AVD_Float) * 2, .format = AVD_VERTEX_STREAM_FORMAT_FLOAT, .components = 3},
+    };
+    AVD_CHECK_MSG(!avdVertexStreamsPack(&streams, 4, NULL, out), "A stream with elements larger than its stride was packed");
+
+    streams.position = (AVD_VertexStream){.data = vertices, .stride = sizeof(AVD_Float) * 3, .format = AVD_VERTEX_STREAM_FORMAT_NONE, .components = 3};
+    AVD_CHECK_MSG(!avdVertexStreamsPack(&streams, 4, NULL, out), "A stream without a format was packed");
+    return true;
+}
+
+bool avdModelVertexStreamTestsRun(void)
+{
+    AVD_LOG_DEBUG("Running AVD Model Vertex Stream Tests...");
+
+    AVD_CHECK(PRIV_avdVertexStreamTestFloatStreams());
+    AVD_CHECK(PRIV_avdVertexStreamTestNormalized());
+    AVD_CHECK(PRIV_avdVertexStreamTestDefaults());
+    AVD_CHECK(PRIV_avdVertexStreamTestInvalid());
+
+    AVD_LOG_DEBUG("All AVD Model Vertex Stream Tests PASSED");
+    return true;
+}
+
+// A scene of many primitives like a large glTF file, every primitive with its
+// own interleaved vertex buffer.
+#define AVD_VERTEX_STREAM_BENCH_PRIMITIVES 64
+#define AVD_VERTEX_STREAM_BENCH_VERTICES   (16 * 1024)
+
+typedef struct {
+    AVD_Float *vertices;
+    AVD_ModelVertexPacked *packed;
+    AVD_List verticesList; // for the unpack and push back path
+} AVD_VertexStreamBenchmark;
+
+// How the glTF loader used to pack a primitive: every attribute unpacked into
+// float scratch memory, then packed and pushed one vertex at a time.
+static void PRIV_avdVertexStreamBenchmarkUnpack(void *userData)
+{
+    AVD_VertexStreamBenchmark *benchmark = (AVD_VertexStreamBenchmark *)userData;
+    AVD_Float *scratch                   = (AVD_Float *)AVD_MALLOC(sizeof(AVD_Float) * AVD_VERTEX_STREAM_TEST_FLOATS * AVD_VERTEX_STREAM_BENCH_VERTICES);
+    static const AVD_UInt32 offsets[]    = {0, 3, 6, 10, AVD_VERTEX_STREAM_TEST_FLOATS};
+
+    avdListClear(&benchmark->verticesList);
+    for (AVD_Size primitive = 0; scratch != NULL && primitive < AVD_VERTEX_STREAM_BENCH_PRIMITIVES; primitive++) {
+        const AVD_Float *vertices = benchmark->vertices + primitive * AVD_VERTEX_STREAM_BENCH_VERTICES * AVD_VERTEX_STREAM_TEST_FLOATS;
+        AVD_Float *attributes[4];
+        for (AVD_Size attribute = 0; attribute < 4; attribute++) {
+            AVD_UInt32 components = offsets[attribute + 1] - offsets[attribute];
+            attributes[attribute] = scratch + offsets[attribute] * AVD_VERTEX_STREAM_BENCH_VERTICES;
+            for (AVD_Size i = 0; i < AVD_VERTEX_STREAM_BENCH_VERTICES; i++) {
+                memcpy(attributes[attribute] + i * components, vertices + i * AVD_VERTEX_STREAM_TEST_FLOATS + offsets[attribute], sizeof(AVD_Float) * components);
+            }
+        }
+
+        AVD_ModelVertex vertex             = {0};
+        AVD_ModelVertexPacked packedVertex = {0};
+        for (AVD_Size i = 0; i < AVD_VERTEX_STREAM_BENCH_VERTICES; i++) {
+            avdModelVertexInit(&vertex);
+            vertex.position = avdVec3(attributes[0][i * 3 + 0], attributes[0][i * 3 + 1], attributes[0][i * 3 + 2]);
+            vertex.normal   = avdVec3(attributes[1][i * 3 + 0], attributes[1][i * 3 + 1], attributes[1][i * 3 + 2]);
+            vertex.tangent  = avdVec4(attributes[2][i * 4 + 0], attributes[2][i * 4 + 1], attributes[2][i * 4 + 2], attributes[2][i * 4 + 3]);
+            vertex.texCoord = avdVec2(attributes[3][i * 2 + 0], attributes[3][i * 2 + 1]);
+            avdModelVertexPack(&vertex, &packedVertex);
+            avdListPushBack(&benchmark->verticesList, &packedVertex);
+        }
+    }
+    if (scratch != NULL) {
+        AVD_FREE(scratch);
+    }
+}
+
+static void PRIV_avdVertexStreamBenchmarkPackRange(AVD_Size begin, AVD_Size end, void *userData)
+{
+    AVD_VertexStreamBenchmark *benchmark = (AVD_VertexStreamBenchmark *)userData;
+    for (AVD_Size primitive = begin; primitive < end; primitive++) {
+        AVD_VertexStreams streams = PRIV_avdVertexStreamTestStreams(benchmark->vertices + primitive * AVD_VERTEX_STREAM_BENCH_VERTICES * AVD_VERTEX_STREAM_TEST_FLOATS);
+        avdVertexStreamsPack(&streams, AVD_VERTEX_STREAM_BENCH_VERTICES, NULL, benchmark->packed + primitive * AVD_VERTEX_STREAM_BENCH_VERTICES);
+    }
+}
+
+static void PRIV_avdVertexStreamBenchmarkPack(void *userData)
+{
+    avdJobsParallelFor(AVD_VERTEX_STREAM_BENCH_PRIMITIVES, 1, PRIV_avdVertexStreamBenchmarkPackRange, userData);
+}
+
+bool avdModelVertexStreamBenchmarksRun(AVD_Bench *bench)
+{
+    AVD_ASSERT(bench != NULL);
+    AVD_LOG_INFO("Running AVD Model Vertex Stream benchmarks (%s backend)...", avdVertexStreamBackendName());
+
+    char names[4][AVD_BENCH_NAME_LENGTH];
+    snprintf(names[0], AVD_BENCH_NAME_LENGTH, "vertex_stream/pack_scene_1m/unpack_floats/threads_1");
+    snprintf(names[1], AVD_BENCH_NAME_LENGTH, "vertex_stream/pack_scene_1m/scalar/threads_1");
+    snprintf(names[2], AVD_BENCH_NAME_LENGTH, "vertex_stream/pack_scene_1m/%s/threads_1", avdVertexStreamBackendName());
+    snprintf(names[3], AVD_BENCH_NAME_LENGTH, "vertex_stream/pack_scene_1m/%s/threads_%u", avdVertexStreamBackendName(), avdJobsHardwareThreadCount());
+
+    AVD_CHECK_MSG(!avdJobsIsInitialized(), "Vertex stream benchmarks need to start the job system themselves");
+    AVD_Size vertexCount                = (AVD_Size)AVD_VERTEX_STREAM_BENCH_PRIMITIVES * AVD_VERTEX_STREAM_BENCH_VERTICES;
+    AVD_VertexStreamBenchmark benchmark = {0};
+    benchmark.vertices                  = (AVD_Float *)AVD_MALLOC(sizeof(AVD_Float) * AVD_VERTEX_STREAM_TEST_FLOATS * vertexCount);
+    benchmark.packed                    = (AVD_ModelVertexPacked *)AVD_MALLOC(sizeof(AVD_ModelVertexPacked) * vertexCount);
+    avdListCreate(&benchmark.verticesList, sizeof(AVD_ModelVertexPacked));
+    bool ok = benchmark.vertices != NULL && benchmark.packed != NULL;
+    if (ok) {
+        PRIV_avdVertexStreamTestFill(benchmark.vertices, vertexCount, 0xbe7c);
+    }
+
+    // only the last case runs with the job system, one worker per core
+    for (AVD_Size i = 0; ok && i < AVD_ARRAY_COUNT(names); i++) {
+        avdVertexStreamSetSimdEnabled(i >= 2);
+        if (i == 3) {
+            ok = avdJobsInit(0);
+        }
+        AVD_BenchCase packCase = {
+            .name               = names[i],
+            .unit               = "vertices",
+            .itemsPerRepetition = vertexCount,
+            .run                = i == 0 ? PRIV_avdVertexStreamBenchmarkUnpack : PRIV_avdVertexStreamBenchmarkPack,
+            .userData           = &benchmark,
+        };
+        ok = ok && avdBenchRun(bench, &packCase);
+        if (i == 3 && avdJobsIsInitialized()) {
+            avdJobsShutdown();
+        }
+    }
+    avdVertexStreamSetSimdEnabled(true);
+
+    avdListDestroy(&benchmark.verticesList);
+    if (benchmark.vertices != NULL) {
+        AVD_FREE(benchmark.vertices);
+    }
+    if (benchmark.packed != NULL) {
+        AVD_FREE(benchmark.packed);
+    }
+    return ok;
+}
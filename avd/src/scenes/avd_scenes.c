@@ -76,9 +76,15 @@ bool avdSceneManagerUpdate(AVD_SceneManager *sceneManager, AVD_AppState *appStat
 
     if (sceneManager->isSceneInitialized) {
         if (sceneManager->isSceneLoaded) {
-            AVD_CHECK(sceneManager->api[sceneManager->currentSceneType].update(appState, &sceneManager->scene));
+            bool updated = false;
+            AVD_PROFILE_SCOPE("SceneManager/Update") {
+                updated = sceneManager->api[sceneManager->currentSceneType].update(appState, &sceneManager->scene);
+            }
+            AVD_CHECK(updated);
         } else {
-            sceneManager->isSceneLoaded = sceneManager->api[sceneManager->currentSceneType].load(appState, &sceneManager->scene, &sceneManager->sceneLoadingStatusMessage, &sceneManager->sceneLoadingProgress);
+            AVD_PROFILE_SCOPE("SceneManager/Load") {
+                sceneManager->isSceneLoaded = sceneManager->api[sceneManager->currentSceneType].load(appState, &sceneManager->scene, &sceneManager->sceneLoadingStatusMessage, &sceneManager->sceneLoadingProgress);
+            }
             sceneManager->sceneLoadPollCount++;
             if (sceneManager->sceneLoadPollCount >= AVD_SCENE_MAX_SCENE_LOAD_POLL_COUNT && !sceneManager->isSceneLoaded) {
                 AVD_LOG_ERROR("Scene loading timed out after %zu polls. Status: %s", sceneManager->sceneLoadPollCount, sceneManager->sceneLoadingStatusMessage ? sceneManager->sceneLoadingStatusMessage : "No status message");
@@ -97,7 +103,11 @@ bool avdSceneManagerRender(AVD_SceneManager *sceneManager, AVD_AppState *appStat
     AVD_ASSERT(appState != NULL);
 
     if (sceneManager->isSceneInitialized && sceneManager->isSceneLoaded) {
-        AVD_CHECK(sceneManager->api[sceneManager->currentSceneType].render(appState, &sceneManager->scene));
+        bool rendered = false;
+        AVD_PROFILE_SCOPE("SceneManager/Render") {
+            rendered = sceneManager->api[sceneManager->currentSceneType].render(appState, &sceneManager->scene);
+        }
+        AVD_CHECK(rendered);
     }
 
     return true;
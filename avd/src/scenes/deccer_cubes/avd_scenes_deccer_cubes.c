@@ -14,6 +14,17 @@ typedef struct {
     uint32_t pad1;
 } AVD_DeccerCubeUberPushConstants;
 
+// the model matrix and texture of every draw come from its instance
+typedef struct {
+    AVD_Matrix4x4 projectionMatrix;
+    AVD_Matrix4x4 viewMatrix;
+
+    uint32_t instanceOffset; // start of the instances of this frame
+    uint32_t pad0;
+    uint32_t pad1;
+    uint32_t pad2;
+} AVD_DeccerCubeIndirectPushConstants;
+
 static AVD_SceneDeccerCubes *PRIV_avdSceneGetTypePtr(AVD_Scene *scene)
 {
     AVD_ASSERT(scene != NULL);
@@ -31,7 +42,7 @@ static bool PRIV_avdSetupBuffer(
         vulkan,
         buffer,
         size,
-        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         "Scene/DeccerCubes/Buffer"));
     AVD_CHECK(avdVulkanBufferUpload(
@@ -42,7 +53,7 @@ static bool PRIV_avdSetupBuffer(
     return true;
 }
 
-static uint32_t PRIV_avdFindTextureIndexFromHash(AVD_SceneDeccerCubes *deccerCubes, uint32_t hash)
+static uint32_t PRIV_avdFindTextureIndexFromHash(AVD_SceneDeccerCubes *deccerCubes, uint64_t hash)
 {
     AVD_ASSERT(deccerCubes != NULL);
 
@@ -55,36 +66,177 @@ static uint32_t PRIV_avdFindTextureIndexFromHash(AVD_SceneDeccerCubes *deccerCub
     return 0; // as a fallback return the first texture
 }
 
-static bool PRIV_avdRenderModelNode(VkCommandBuffer commandBuffer, AVD_SceneDeccerCubes *deccerCubes, AVD_ModelNode *node, AVD_Matrix4x4 parentTransform)
+// A walk below root picks the nodes with a mesh and their cached world
+// matrices.
+static bool PRIV_avdCollectModelNodes(AVD_SceneDeccerCubes *deccerCubes, const AVD_Model *model, AVD_Int32 root)
+{
+    AVD_ASSERT(deccerCubes != NULL);
+    AVD_ASSERT(model != NULL);
+
+    const AVD_Matrix4x4 *worldMatrices = avdModelGetWorldMatrices(model);
+    for (AVD_Int32 index = root; index >= 0; index = avdModelNodeNext(model, root, index)) {
+        const AVD_Mesh *mesh = avdModelGetNodeMesh(model, index);
+        if (mesh == NULL || deccerCubes->drawNodes.count >= deccerCubes->drawBounds.capacity) {
+            continue;
+        }
+
+        const AVD_Matrix4x4 *globalTransform = &worldMatrices[index];
+        AVD_AABB worldBounds                 = avdAABBTransform(&mesh->bounds, globalTransform);
+        AVD_Sphere worldSphere               = avdSphereTransform(&mesh->boundingSphere, globalTransform);
+        avdBoundsStreamsSet(&deccerCubes->drawBounds, deccerCubes->drawNodes.count, &worldBounds, &worldSphere);
+        AVD_CHECK(avdListPushBack(&deccerCubes->drawNodes, &index) != NULL);
+        AVD_CHECK(avdListPushBack(&deccerCubes->drawMatrices, globalTransform) != NULL);
+    }
+    return true;
+}
+
+static bool PRIV_avdCullModelNodes(AVD_SceneDeccerCubes *deccerCubes, AVD_Model *model, AVD_Int32 root)
+{
+    AVD_ASSERT(deccerCubes != NULL);
+    AVD_ASSERT(model != NULL);
+    AVD_ASSERT(root >= 0);
+
+    picoPerfTime start = picoPerfNow();
+
+    // only the subtrees of moved nodes get new world matrices, and the draw
+    // lists are gathered again only when any node changed since the last frame
+    avdModelUpdateWorldMatrices(model);
+    if (model->nodeMatrices.generation != deccerCubes->drawGeneration) {
+        avdListClear(&deccerCubes->drawNodes);
+        avdListClear(&deccerCubes->drawMatrices);
+        avdListClear(&deccerCubes->drawInstances);
+        deccerCubes->drawBounds.count = 0;
+        AVD_CHECK(PRIV_avdCollectModelNodes(deccerCubes, model, root));
+        AVD_CHECK(avdModelBuildDrawInstances(model, root, deccerCubes->meshMaterials, &deccerCubes->drawInstances));
+        deccerCubes->drawGeneration = model->nodeMatrices.generation;
+    }
+
+    // the GPU driven path culls all instances in its compute pass
+    if (deccerCubes->useIndirect) {
+        deccerCubes->visibleCount = 0;
+        deccerCubes->cullingMs    = picoPerfDurationMilliseconds(start, picoPerfNow());
+        return true;
+    }
+
+    AVD_Matrix4x4 viewProjection = avdMat4x4Multiply(deccerCubes->projectionMatrix, deccerCubes->viewMatrix);
+    AVD_Frustum frustum          = avdFrustumFromMatrix(&viewProjection);
+    deccerCubes->visibleCount    = avdFrustumCullAABBs(&frustum, &deccerCubes->drawBounds, deccerCubes->visibleDraws);
+    deccerCubes->cullingMs       = picoPerfDurationMilliseconds(start, picoPerfNow());
+    return true;
+}
+
+static void PRIV_avdRenderModelNode(VkCommandBuffer commandBuffer, AVD_SceneDeccerCubes *deccerCubes, const AVD_Mesh *mesh, const AVD_Matrix4x4 *globalTransform)
+{
+    AVD_ASSERT(deccerCubes != NULL);
+    AVD_ASSERT(mesh != NULL);
+    AVD_ASSERT(commandBuffer != VK_NULL_HANDLE);
+
+    AVD_DeccerCubeUberPushConstants pushConstants = {
+        .projectionMatrix = deccerCubes->projectionMatrix,
+        .modelMatrix      = *globalTransform,
+        .viewMatrix       = deccerCubes->viewMatrix,
+        .vertexCount      = mesh->triangleCount * 3,
+        .vertexOffset     = mesh->indexOffset,
+        .textureIndex     = PRIV_avdFindTextureIndexFromHash(deccerCubes, mesh->material.albedoTexture.id) + 1,
+    };
+    vkCmdPushConstants(commandBuffer, deccerCubes->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(pushConstants), &pushConstants);
+    vkCmdDraw(commandBuffer, mesh->triangleCount * 3, 1, 0, 0);
+}
+
+static void PRIV_avdRenderModelNodeMeshlets(VkCommandBuffer commandBuffer, AVD_SceneDeccerCubes *deccerCubes, const AVD_Mesh *mesh, const AVD_Matrix4x4 *globalTransform, AVD_UInt32 drawIndex)
 {
     AVD_ASSERT(deccerCubes != NULL);
-    AVD_ASSERT(node != NULL);
+    AVD_ASSERT(mesh != NULL);
     AVD_ASSERT(commandBuffer != VK_NULL_HANDLE);
 
-    AVD_Matrix4x4 localTransform  = avdTransformToMatrix(&node->transform);
-    AVD_Matrix4x4 globalTransform = avdMat4x4Multiply(parentTransform, localTransform);
-
-    if (node->hasMesh) {
-        AVD_DeccerCubeUberPushConstants pushConstants = {
-            .projectionMatrix = deccerCubes->projectionMatrix,
-            .modelMatrix      = globalTransform,
-            .viewMatrix       = deccerCubes->viewMatrix,
-            .vertexCount      = node->mesh.triangleCount * 3,
-            .vertexOffset     = node->mesh.indexOffset,
-            .textureIndex     = PRIV_avdFindTextureIndexFromHash(deccerCubes, node->mesh.material.albedoTexture.id) + 1,
-        };
-        vkCmdPushConstants(commandBuffer, deccerCubes->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(pushConstants), &pushConstants);
-        vkCmdDraw(commandBuffer, node->mesh.triangleCount * 3, 1, 0, 0);
+    // the vertex count comes from the indirect command written by the culling
+    AVD_DeccerCubeUberPushConstants pushConstants = {
+        .projectionMatrix = deccerCubes->projectionMatrix,
+        .modelMatrix      = *globalTransform,
+        .viewMatrix       = deccerCubes->viewMatrix,
+        .vertexCount      = 0,
+        .vertexOffset     = deccerCubes->meshletVisibleOffsets[drawIndex],
+        .textureIndex     = PRIV_avdFindTextureIndexFromHash(deccerCubes, mesh->material.albedoTexture.id) + 1,
+    };
+    vkCmdPushConstants(commandBuffer, deccerCubes->meshletPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(pushConstants), &pushConstants);
+    avdMeshletCullingDraw(commandBuffer, &deccerCubes->meshletCulling, drawIndex);
+}
+
+static bool PRIV_avdCullModelNodeMeshlets(VkCommandBuffer commandBuffer, AVD_SceneDeccerCubes *deccerCubes, const AVD_Model *model, AVD_VulkanRenderer *renderer)
+{
+    AVD_ASSERT(deccerCubes != NULL);
+    AVD_ASSERT(model != NULL);
+    AVD_ASSERT(renderer != NULL);
+
+    AVD_Matrix4x4 viewProjection = avdMat4x4Multiply(deccerCubes->projectionMatrix, deccerCubes->viewMatrix);
+    AVD_CHECK(avdMeshletCullingBegin(
+        commandBuffer,
+        &deccerCubes->meshletCulling,
+        renderer,
+        &viewProjection,
+        deccerCubes->cameraPosition,
+        AVD_MESHLET_CULLING_FLAG_ALL));
+    // the nodes passed the CPU frustum test, the draw index is their position
+    // in the visible list
+    for (AVD_UInt32 i = 0; i < (AVD_UInt32)deccerCubes->visibleCount; i++) {
+        AVD_UInt32 nodeIndex = deccerCubes->visibleDraws[i];
+        AVD_Int32 node       = *(AVD_Int32 *)avdListGet(&deccerCubes->drawNodes, nodeIndex);
+        AVD_CHECK(avdMeshletCullingDispatch(
+            commandBuffer,
+            &deccerCubes->meshletCulling,
+            avdModelGetNodeMesh(model, node),
+            (AVD_Matrix4x4 *)avdListGet(&deccerCubes->drawMatrices, nodeIndex),
+            i,
+            &deccerCubes->meshletVisibleOffsets[i]));
     }
+    AVD_CHECK(avdMeshletCullingEnd(commandBuffer, &deccerCubes->meshletCulling));
+
+    return true;
+}
+
+// Every mesh with morph targets once, the nodes that share a mesh share its
+// deformed vertices.
+static bool PRIV_avdBlendModelMorphTargets(VkCommandBuffer commandBuffer, AVD_SceneDeccerCubes *deccerCubes, const AVD_Model *model, AVD_VulkanRenderer *renderer)
+{
+    AVD_ASSERT(deccerCubes != NULL);
+    AVD_ASSERT(model != NULL);
+    AVD_ASSERT(renderer != NULL);
+
+    AVD_CHECK(avdMorphBlendBegin(commandBuffer, &deccerCubes->morphBlend, renderer));
+    for (AVD_Size i = 0; i < model->meshes.count; i++) {
+        const AVD_Mesh *mesh = (const AVD_Mesh *)avdListGet(&model->meshes, i);
+        if (mesh->morphVertexCount <= 0) {
+            continue;
+        }
+        AVD_CHECK_MSG(mesh->morphTargetCount <= AVD_MAX_MORPH_TARGETS_PER_MESH, "Mesh '%s' has too many morph targets", mesh->name);
 
-    for (AVD_UInt32 i = 0; i < AVD_MODEL_NODE_MAX_CHILDREN; i++) {
-        if (node->children[i])
-            AVD_CHECK(PRIV_avdRenderModelNode(commandBuffer, deccerCubes, node->children[i], globalTransform));
+        static AVD_Float weights[AVD_MAX_MORPH_TARGETS_PER_MESH];
+        for (AVD_Int32 target = 0; target < mesh->morphTargetCount; target++) {
+            bool named      = mesh->morphTargets != NULL && target < mesh->morphTargets->count;
+            weights[target] = named ? mesh->morphTargets->targets[target].weight : 0.0f;
+        }
+        AVD_CHECK(avdMorphBlendDispatch(commandBuffer, &deccerCubes->morphBlend, mesh, &deccerCubes->scene.modelResources, weights));
     }
+    AVD_CHECK(avdMorphBlendEnd(commandBuffer, &deccerCubes->morphBlend));
 
     return true;
 }
 
+static void PRIV_avdRenderModelNodesIndirect(VkCommandBuffer commandBuffer, AVD_SceneDeccerCubes *deccerCubes)
+{
+    AVD_ASSERT(deccerCubes != NULL);
+    AVD_ASSERT(commandBuffer != VK_NULL_HANDLE);
+
+    AVD_DeccerCubeIndirectPushConstants pushConstants = {
+        .projectionMatrix = deccerCubes->projectionMatrix,
+        .viewMatrix       = deccerCubes->viewMatrix,
+        .instanceOffset   = avdIndirectDrawInstanceOffset(&deccerCubes->indirectDraw),
+    };
+    vkCmdBindIndexBuffer(commandBuffer, deccerCubes->indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdPushConstants(commandBuffer, deccerCubes->indirectPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(pushConstants), &pushConstants);
+    avdIndirectDrawDraw(commandBuffer, &deccerCubes->indirectDraw);
+}
+
 bool avdSceneDeccerCubesCheckIntegrity(struct AVD_AppState *appState, const char **statusMessage)
 {
     AVD_ASSERT(statusMessage != NULL);
@@ -134,7 +286,8 @@ bool avdSceneDeccerCubesInit(struct AVD_AppState *appState, union AVD_Scene *sce
     deccerCubes->loadStage        = 0;
     deccerCubes->imagesCount      = 0;
     deccerCubes->projectionMatrix = avdMatPerspective(avdDeg2Rad(45.0f), 16.0f / 9.0f, 0.01f, 100.0f);
-    deccerCubes->viewMatrix       = avdMatLookAt(avdVec3(12.0f, 12.0f, 12.0f), avdVec3(0.0f, 0.0f, 0.0f), avdVec3(0.0f, 1.0f, 0.0f));
+    deccerCubes->cameraPosition   = avdVec3(12.0f, 12.0f, 12.0f);
+    deccerCubes->viewMatrix       = avdMatLookAt(deccerCubes->cameraPosition, avdVec3(0.0f, 0.0f, 0.0f), avdVec3(0.0f, 1.0f, 0.0f));
 
     avd3DSceneCreate(&deccerCubes->scene);
 
@@ -165,6 +318,30 @@ bool avdSceneDeccerCubesInit(struct AVD_AppState *appState, union AVD_Scene *sce
         "RobotoCondensedRegular",
         "A simple GLTF scene with some weird transforms to test the transform calculation edge cases",
         18.0f));
+    AVD_CHECK(avdRenderableTextCreate(
+        &deccerCubes->cullingInfo,
+        &appState->fontRenderer,
+        &appState->vulkan,
+        "RobotoCondensedRegular",
+        "Culling: -",
+        18.0f));
+
+    avdListCreate(&deccerCubes->drawNodes, sizeof(AVD_Int32));
+    avdListCreate(&deccerCubes->drawMatrices, sizeof(AVD_Matrix4x4));
+    deccerCubes->drawGeneration        = 0;
+    deccerCubes->drawBounds            = (AVD_BoundsStreams){0};
+    deccerCubes->visibleDraws          = NULL;
+    deccerCubes->visibleCount          = 0;
+    deccerCubes->cullingMs             = 0.0;
+    deccerCubes->useMeshlets           = true;
+    deccerCubes->meshletCulling        = (AVD_MeshletCulling){0};
+    deccerCubes->meshletVisibleOffsets = NULL;
+    deccerCubes->useIndirect           = false;
+    deccerCubes->indirectDraw          = (AVD_IndirectDraw){0};
+    deccerCubes->meshMaterials         = NULL;
+    deccerCubes->useMorphBlend         = false;
+    deccerCubes->morphBlend            = (AVD_MorphBlend){0};
+    avdListCreate(&deccerCubes->drawInstances, sizeof(AVD_DrawInstance));
 
     return true;
 }
@@ -178,12 +355,30 @@ void avdSceneDeccerCubesDestroy(struct AVD_AppState *appState, union AVD_Scene *
 
     avdVulkanBufferDestroy(&appState->vulkan, &deccerCubes->vertexBuffer);
     avdVulkanBufferDestroy(&appState->vulkan, &deccerCubes->indexBuffer);
+    avdMeshletCullingDestroy(&deccerCubes->meshletCulling, &appState->vulkan);
+    avdIndirectDrawDestroy(&deccerCubes->indirectDraw, &appState->vulkan);
+    avdMorphBlendDestroy(&deccerCubes->morphBlend, &appState->vulkan);
 
     vkDestroyDescriptorSetLayout(appState->vulkan.device, deccerCubes->set0Layout, NULL);
 
     avd3DSceneDestroy(&deccerCubes->scene);
     avdRenderableTextDestroy(&deccerCubes->title, &appState->vulkan);
     avdRenderableTextDestroy(&deccerCubes->info, &appState->vulkan);
+    avdRenderableTextDestroy(&deccerCubes->cullingInfo, &appState->vulkan);
+
+    avdListDestroy(&deccerCubes->drawNodes);
+    avdListDestroy(&deccerCubes->drawMatrices);
+    avdBoundsStreamsDestroy(&deccerCubes->drawBounds);
+    if (deccerCubes->visibleDraws != NULL) {
+        AVD_FREE(deccerCubes->visibleDraws);
+    }
+    if (deccerCubes->meshletVisibleOffsets != NULL) {
+        AVD_FREE(deccerCubes->meshletVisibleOffsets);
+    }
+    avdListDestroy(&deccerCubes->drawInstances);
+    if (deccerCubes->meshMaterials != NULL) {
+        AVD_FREE(deccerCubes->meshMaterials);
+    }
 
     for (AVD_UInt32 i = 0; i < deccerCubes->imagesCount; i++) {
         avdVulkanImageDestroy(&appState->vulkan, &deccerCubes->images[i]);
@@ -191,6 +386,10 @@ void avdSceneDeccerCubesDestroy(struct AVD_AppState *appState, union AVD_Scene *
 
     vkDestroyPipelineLayout(appState->vulkan.device, deccerCubes->pipelineLayout, NULL);
     vkDestroyPipeline(appState->vulkan.device, deccerCubes->pipeline, NULL);
+    vkDestroyPipelineLayout(appState->vulkan.device, deccerCubes->meshletPipelineLayout, NULL);
+    vkDestroyPipeline(appState->vulkan.device, deccerCubes->meshletPipeline, NULL);
+    vkDestroyPipelineLayout(appState->vulkan.device, deccerCubes->indirectPipelineLayout, NULL);
+    vkDestroyPipeline(appState->vulkan.device, deccerCubes->indirectPipeline, NULL);
 }
 
 bool avdSceneDeccerCubesLoad(struct AVD_AppState *appState, union AVD_Scene *scene, const char **statusMessage, float *progress)
@@ -205,7 +404,7 @@ bool avdSceneDeccerCubesLoad(struct AVD_AppState *appState, union AVD_Scene *sce
             *statusMessage = "Loaded scene license";
         case 1:
             *statusMessage = "Loaded plain deccer cube model";
-            AVD_CHECK(avd3DSceneLoadGltf("assets/scene_deccer_cubes/SM_Deccer_Cubes_Textured_Complex.gltf", &deccerCubes->scene, AVD_GLT_LOAD_FLAG_NONE));
+            AVD_CHECK(avd3DSceneLoadGltf("assets/scene_deccer_cubes/SM_Deccer_Cubes_Textured_Complex.gltf", &deccerCubes->scene, AVD_GLTF_LOAD_FLAG_MESHLETS));
             break;
         case 2:
             *statusMessage = "Setup GPU Buffers";
@@ -217,16 +416,61 @@ bool avdSceneDeccerCubesLoad(struct AVD_AppState *appState, union AVD_Scene *sce
                 &appState->vulkan,
                 &deccerCubes->vertexBuffer,
                 &deccerCubes->scene.modelResources.verticesList));
+
+            // one accumulator per morphed vertex and one slot per target, all
+            // of them may be active in the same frame
+            AVD_UInt32 maxMorphVertices = 0;
+            AVD_UInt32 maxActiveTargets = 0;
+            AVD_Model *morphModel       = (AVD_Model *)avdListGet(&deccerCubes->scene.modelsList, 0);
+            for (AVD_Size i = 0; i < morphModel->meshes.count; i++) {
+                const AVD_Mesh *mesh = (const AVD_Mesh *)avdListGet(&morphModel->meshes, i);
+                maxMorphVertices += (AVD_UInt32)AVD_MAX(mesh->morphVertexCount, 0);
+                maxActiveTargets += (AVD_UInt32)AVD_MAX(mesh->morphTargetCount, 0);
+            }
+            deccerCubes->useMorphBlend = maxMorphVertices > 0 && deccerCubes->scene.modelResources.morphTargetsList.count > 0;
+            if (deccerCubes->useMorphBlend) {
+                AVD_CHECK(avdMorphBlendCreate(
+                    &deccerCubes->morphBlend,
+                    &appState->vulkan,
+                    &deccerCubes->scene.modelResources,
+                    maxMorphVertices,
+                    maxActiveTargets,
+                    "DeccerCubes"));
+            }
+
             VkWriteDescriptorSet descriptorSetWrite[2] = {0};
+            AVD_VulkanBuffer *vertices                 = deccerCubes->useMorphBlend ? &deccerCubes->morphBlend.deformedVerticesBuffer : &deccerCubes->vertexBuffer;
             AVD_CHECK(avdWriteBufferDescriptorSet(&descriptorSetWrite[0],
                                                   deccerCubes->set0,
                                                   0,
-                                                  &deccerCubes->vertexBuffer.descriptorBufferInfo));
+                                                  &vertices->descriptorBufferInfo));
             AVD_CHECK(avdWriteBufferDescriptorSet(&descriptorSetWrite[1],
                                                   deccerCubes->set0,
                                                   1,
                                                   &deccerCubes->indexBuffer.descriptorBufferInfo));
             vkUpdateDescriptorSets(appState->vulkan.device, 2, descriptorSetWrite, 0, NULL);
+
+            // every node gets its own indirect command and visible list
+            AVD_Model *meshletModel       = (AVD_Model *)avdListGet(&deccerCubes->scene.modelsList, 0);
+            AVD_UInt32 maxVisibleMeshlets = 0;
+            for (AVD_Int32 i = 0; i < avdModelNodeCount(meshletModel); i++) {
+                const AVD_Mesh *mesh = avdModelGetNodeMesh(meshletModel, i);
+                if (mesh != NULL) {
+                    maxVisibleMeshlets += (AVD_UInt32)mesh->meshletCount;
+                }
+            }
+            AVD_CHECK(avdMeshletCullingCreate(
+                &deccerCubes->meshletCulling,
+                &appState->vulkan,
+                &deccerCubes->scene.modelResources,
+                (AVD_UInt32)avdModelNodeCount(meshletModel),
+                maxVisibleMeshlets,
+                "DeccerCubes"));
+            AVD_CHECK(avdIndirectDrawCreate(
+                &deccerCubes->indirectDraw,
+                &appState->vulkan,
+                (AVD_UInt32)avdModelNodeCount(meshletModel),
+                "DeccerCubes"));
             break;
         case 3:
             *statusMessage                                      = "Created pipelines...";
@@ -250,6 +494,40 @@ bool avdSceneDeccerCubesLoad(struct AVD_AppState *appState, union AVD_Scene *sce
                 "DeccerCubeFrag",
                 NULL,
                 &pipelineCreationInfo));
+            AVD_CHECK(avdPipelineUtilsCreateGraphicsLayoutAndPipeline(
+                &deccerCubes->meshletPipelineLayout,
+                &deccerCubes->meshletPipeline,
+                appState->vulkan.device,
+                (VkDescriptorSetLayout[]){
+                    deccerCubes->set0Layout,
+                    appState->vulkan.bindlessDescriptorSetLayout,
+                    deccerCubes->meshletCulling.descriptorSetLayout,
+                },
+                3,
+                sizeof(AVD_DeccerCubeUberPushConstants),
+                appState->renderer.sceneFramebuffer.renderPass,
+                (AVD_UInt32)appState->renderer.sceneFramebuffer.colorAttachments.count,
+                "DeccerCubeMeshletVert",
+                "DeccerCubeFrag",
+                NULL,
+                &pipelineCreationInfo));
+            AVD_CHECK(avdPipelineUtilsCreateGraphicsLayoutAndPipeline(
+                &deccerCubes->indirectPipelineLayout,
+                &deccerCubes->indirectPipeline,
+                appState->vulkan.device,
+                (VkDescriptorSetLayout[]){
+                    deccerCubes->set0Layout,
+                    appState->vulkan.bindlessDescriptorSetLayout,
+                    deccerCubes->indirectDraw.descriptorSetLayout,
+                },
+                3,
+                sizeof(AVD_DeccerCubeIndirectPushConstants),
+                appState->renderer.sceneFramebuffer.renderPass,
+                (AVD_UInt32)appState->renderer.sceneFramebuffer.colorAttachments.count,
+                "DeccerCubeIndirectVert",
+                "DeccerCubeFrag",
+                NULL,
+                &pipelineCreationInfo));
             break;
         case 4:
             *statusMessage                                                                 = "Loaded images...";
@@ -260,7 +538,7 @@ bool avdSceneDeccerCubesLoad(struct AVD_AppState *appState, union AVD_Scene *sce
                 if (!mesh->material.albedoTexture.hasTexture)
                     continue;
                 deccerCubes->imagesHashes[deccerCubes->imagesCount] = mesh->material.albedoTexture.id;
-                AVD_LOG_INFO("Loading image: %s (hash: %u)", mesh->material.albedoTexture.path, mesh->material.albedoTexture.id);
+                AVD_LOG_INFO("Loading image: %s (hash: 0x%016llX)", mesh->material.albedoTexture.path, (unsigned long long)mesh->material.albedoTexture.id);
                 AVD_CHECK(avdVulkanImageLoadFromFile(
                     &appState->vulkan,
                     mesh->material.albedoTexture.path,
@@ -282,6 +560,23 @@ bool avdSceneDeccerCubesLoad(struct AVD_AppState *appState, union AVD_Scene *sce
         case 5:
             *statusMessage = "Done loading...";
             avd3DSceneDebugLog(&deccerCubes->scene, "Deccer Cubes");
+
+            // every node could hold a mesh, size the culling buffers for all of them
+            AVD_Model *loadedModel = (AVD_Model *)avdListGet(&deccerCubes->scene.modelsList, 0);
+            AVD_Size nodeCount     = (AVD_Size)avdModelNodeCount(loadedModel);
+            AVD_CHECK(avdBoundsStreamsCreate(&deccerCubes->drawBounds, nodeCount));
+            deccerCubes->visibleDraws = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * nodeCount);
+            AVD_CHECK_MSG(deccerCubes->visibleDraws != NULL, "Failed to allocate the visible draw list");
+            deccerCubes->meshletVisibleOffsets = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * nodeCount);
+            AVD_CHECK_MSG(deccerCubes->meshletVisibleOffsets != NULL, "Failed to allocate the meshlet visible offsets");
+
+            // the indirect draws look up the texture of an instance by its mesh
+            deccerCubes->meshMaterials = (AVD_UInt32 *)AVD_MALLOC(sizeof(AVD_UInt32) * (loadedModel->meshes.count + 1));
+            AVD_CHECK_MSG(deccerCubes->meshMaterials != NULL, "Failed to allocate the mesh materials");
+            for (AVD_Size i = 0; i < loadedModel->meshes.count; i++) {
+                const AVD_Mesh *mesh          = (const AVD_Mesh *)avdListGet(&loadedModel->meshes, i);
+                deccerCubes->meshMaterials[i] = PRIV_avdFindTextureIndexFromHash(deccerCubes, mesh->material.albedoTexture.id) + 1;
+            }
             break;
         default:
             AVD_LOG_ERROR("Deccer Cubes scene invalid load stage");
@@ -306,6 +601,14 @@ void avdSceneDeccerCubesInputEvent(struct AVD_AppState *appState, union AVD_Scen
                 AVD_SCENE_TYPE_MAIN_MENU,
                 appState);
         }
+        if (event->key.key == GLFW_KEY_M && event->key.action == GLFW_PRESS) {
+            AVD_SceneDeccerCubes *deccerCubes = PRIV_avdSceneGetTypePtr(scene);
+            deccerCubes->useMeshlets          = !deccerCubes->useMeshlets;
+        }
+        if (event->key.key == GLFW_KEY_G && event->key.action == GLFW_PRESS) {
+            AVD_SceneDeccerCubes *deccerCubes = PRIV_avdSceneGetTypePtr(scene);
+            deccerCubes->useIndirect          = !deccerCubes->useIndirect;
+        }
     }
 }
 
@@ -317,11 +620,49 @@ bool avdSceneDeccerCubesUpdate(struct AVD_AppState *appState, union AVD_Scene *s
     AVD_SceneDeccerCubes *deccerCubes = PRIV_avdSceneGetTypePtr(scene);
 
     // rotate the camera around the orgin
-    deccerCubes->viewMatrix = avdMatLookAt(
-        avdVec3(16.0f * cosf((AVD_Float)appState->framerate.currentTime * 0.2f), 16.0f, 16.0f * sinf((AVD_Float)appState->framerate.currentTime * 0.2f)),
+    deccerCubes->cameraPosition = avdVec3(16.0f * cosf((AVD_Float)appState->framerate.currentTime * 0.2f), 16.0f, 16.0f * sinf((AVD_Float)appState->framerate.currentTime * 0.2f));
+    deccerCubes->viewMatrix     = avdMatLookAt(
+        deccerCubes->cameraPosition,
         avdVec3(0.0f, 0.0f, 0.0f),
         avdVec3(0.0f, 1.0f, 0.0f));
 
+    // numbers of the previous frame, the culling runs as part of the render
+    static char buffer[256];
+    if (deccerCubes->useIndirect) {
+        // read back from the frame that last used this in flight slot
+        snprintf(buffer, sizeof(buffer),
+                 "Culling: GPU driven (G), %u of %u meshes drawn with one indirect draw, %.3f ms CPU",
+                 deccerCubes->indirectDraw.lastDrawCount,
+                 deccerCubes->indirectDraw.lastInstanceCount,
+                 deccerCubes->cullingMs);
+        AVD_CHECK(avdRenderableTextUpdate(&deccerCubes->cullingInfo,
+                                          &appState->fontRenderer,
+                                          &appState->vulkan,
+                                          buffer));
+        return true;
+    }
+
+    int length = snprintf(buffer, sizeof(buffer),
+                          "Culling: %zu of %zu meshes visible, %zu culled, %.3f ms CPU",
+                          deccerCubes->visibleCount,
+                          deccerCubes->drawNodes.count,
+                          deccerCubes->drawNodes.count - deccerCubes->visibleCount,
+                          deccerCubes->cullingMs);
+    if (deccerCubes->useMeshlets && length > 0 && (size_t)length < sizeof(buffer)) {
+        // read back from the frame that last used this in flight slot
+        const AVD_MeshletCullingStats *stats = &deccerCubes->meshletCulling.lastStats;
+        snprintf(buffer + length, sizeof(buffer) - (size_t)length,
+                 " | Meshlets (M): %u of %u visible, %u frustum and %u cone culled",
+                 stats->visibleMeshlets,
+                 stats->testedMeshlets,
+                 stats->frustumCulledMeshlets,
+                 stats->coneCulledMeshlets);
+    }
+    AVD_CHECK(avdRenderableTextUpdate(&deccerCubes->cullingInfo,
+                                      &appState->fontRenderer,
+                                      &appState->vulkan,
+                                      buffer));
+
     return true;
 }
 
@@ -334,23 +675,71 @@ bool avdSceneDeccerCubesRender(struct AVD_AppState *appState, union AVD_Scene *s
 
     VkCommandBuffer commandBuffer = avdVulkanRendererGetCurrentCmdBuffer(&appState->renderer);
 
+    AVD_Model *model = (AVD_Model *)avdListGet(&deccerCubes->scene.modelsList, 0);
+    // checked outside of the zone, returning from inside would leave it open
+    bool culled = false;
+    AVD_PROFILE_SCOPE("DeccerCubes/Culling") {
+        culled = PRIV_avdCullModelNodes(deccerCubes, model, model->mainScene >= 0 ? model->mainScene : AVD_MODEL_ROOT_NODE);
+    }
+    AVD_CHECK(culled);
+    // the morph blend, meshlet and indirect culling are compute passes and
+    // have to run before the render pass
+    if (deccerCubes->useMorphBlend) {
+        AVD_CHECK(PRIV_avdBlendModelMorphTargets(commandBuffer, deccerCubes, model, &appState->renderer));
+    }
+    if (deccerCubes->useIndirect) {
+        AVD_Matrix4x4 viewProjection = avdMat4x4Multiply(deccerCubes->projectionMatrix, deccerCubes->viewMatrix);
+        AVD_CHECK(avdIndirectDrawCull(
+            commandBuffer,
+            &deccerCubes->indirectDraw,
+            &appState->renderer,
+            (const AVD_DrawInstance *)deccerCubes->drawInstances.items,
+            (AVD_UInt32)deccerCubes->drawInstances.count,
+            deccerCubes->drawGeneration,
+            &viewProjection));
+    } else if (deccerCubes->useMeshlets) {
+        AVD_CHECK(PRIV_avdCullModelNodeMeshlets(commandBuffer, deccerCubes, model, &appState->renderer));
+    }
+
     AVD_CHECK(avdBeginSceneRenderPass(commandBuffer, &appState->renderer));
     AVD_DEBUG_VK_CMD_BEGIN_LABEL(commandBuffer, NULL, "[Cmd][Scene]:DeccerCubes/Render");
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, deccerCubes->pipeline);
     VkDescriptorSet descriptorSets[] = {
         deccerCubes->set0,
         appState->vulkan.bindlessDescriptorSet,
+        deccerCubes->meshletCulling.descriptorSet,
     };
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, deccerCubes->pipelineLayout, 0, 2, descriptorSets, 0, NULL);
+    if (deccerCubes->useIndirect) {
+        descriptorSets[2] = deccerCubes->indirectDraw.descriptorSet;
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, deccerCubes->indirectPipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, deccerCubes->indirectPipelineLayout, 0, 3, descriptorSets, 0, NULL);
+        PRIV_avdRenderModelNodesIndirect(commandBuffer, deccerCubes);
+    } else if (deccerCubes->useMeshlets) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, deccerCubes->meshletPipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, deccerCubes->meshletPipelineLayout, 0, 3, descriptorSets, 0, NULL);
+    } else {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, deccerCubes->pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, deccerCubes->pipelineLayout, 0, 2, descriptorSets, 0, NULL);
+    }
 
-    AVD_Model *model = (AVD_Model *)avdListGet(&deccerCubes->scene.modelsList, 0);
-    AVD_CHECK(PRIV_avdRenderModelNode(commandBuffer, deccerCubes, model->mainScene, avdMat4x4Identity()));
+    for (AVD_Size i = 0; i < deccerCubes->visibleCount; i++) {
+        AVD_UInt32 drawIndex         = deccerCubes->visibleDraws[i];
+        AVD_Int32 node               = *(AVD_Int32 *)avdListGet(&deccerCubes->drawNodes, drawIndex);
+        const AVD_Mesh *mesh         = avdModelGetNodeMesh(model, node);
+        AVD_Matrix4x4 *nodeTransform = (AVD_Matrix4x4 *)avdListGet(&deccerCubes->drawMatrices, drawIndex);
+        if (deccerCubes->useMeshlets) {
+            PRIV_avdRenderModelNodeMeshlets(commandBuffer, deccerCubes, mesh, nodeTransform, (AVD_UInt32)i);
+        } else {
+            PRIV_avdRenderModelNode(commandBuffer, deccerCubes, mesh, nodeTransform);
+        }
+    }
 
     float titleWidth, titleHeight;
     float infoWidth, infoHeight;
+    float cullingWidth, cullingHeight;
     avdRenderableTextGetSize(&deccerCubes->title, &titleWidth, &titleHeight);
     avdRenderableTextGetSize(&deccerCubes->info, &infoWidth, &infoHeight);
+    avdRenderableTextGetSize(&deccerCubes->cullingInfo, &cullingWidth, &cullingHeight);
 
     avdRenderText(
         &appState->vulkan,
@@ -371,6 +760,15 @@ bool avdSceneDeccerCubesRender(struct AVD_AppState *appState, union AVD_Scene *s
         1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
         appState->renderer.sceneFramebuffer.width,
         appState->renderer.sceneFramebuffer.height);
+    avdRenderText(
+        &appState->vulkan,
+        &appState->fontRenderer,
+        &deccerCubes->cullingInfo,
+        commandBuffer,
+        10.0f, 20.0f + infoHeight + cullingHeight,
+        1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+        appState->renderer.sceneFramebuffer.width,
+        appState->renderer.sceneFramebuffer.height);
 
     AVD_DEBUG_VK_CMD_END_LABEL(commandBuffer);
     AVD_CHECK(avdEndSceneRenderPass(commandBuffer));
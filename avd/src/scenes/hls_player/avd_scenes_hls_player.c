@@ -6,6 +6,7 @@
 #include "avd_application.h"
 #include "common/avd_fps_camera.h"
 #include "core/avd_base.h"
+#include "core/avd_hash.h"
 #include "core/avd_types.h"
 #include "core/avd_utils.h"
 #include "math/avd_vector_non_simd.h"
@@ -105,9 +106,9 @@ static bool PRIV_avdSceneHLSPlayerLoadSourcesFromPath(AVD_AppState *appState, AV
         lineStart = (*lineEnd == '\0') ? lineEnd : lineEnd + 1;
     }
     scene->sourceCount = (AVD_UInt32)sourceIndex;
-    scene->sourcesHash = avdHashBuffer(scene->sources, sizeof(AVD_SceneHLSPlayerSource) * scene->sourceCount);
+    scene->sourcesHash = avdHash64(scene->sources, sizeof(AVD_SceneHLSPlayerSource) * scene->sourceCount, AVD_HASH_DEFAULT_SEED);
 
-    AVD_LOG_INFO("Total HLS sources loaded: %d [hash: 0x%08X]", scene->sourceCount, scene->sourcesHash);
+    AVD_LOG_INFO("Total HLS sources loaded: %d [hash: 0x%016llX]", scene->sourceCount, (unsigned long long)scene->sourcesHash);
 
     AVD_FREE(fileData);
     return true;
@@ -179,7 +180,7 @@ static bool PRIV_avdSceneHLSPlayerReceiveReadySegments(AVD_AppState *appState, A
     AVD_HLSReadyPayload payload = {0};
     while (avdHLSWorkerPoolReceiveReadySegment(&scene->workerPool, &payload)) {
         if (payload.sourcesHash != scene->sourcesHash) {
-            AVD_LOG_WARN("HLS Main Thread received segment for outdated sources hash 0x%08X (current: 0x%08X), discarding", payload.sourcesHash, scene->sourcesHash);
+            AVD_LOG_WARN("HLS Main Thread received segment for outdated sources hash 0x%016llX (current: 0x%016llX), discarding", (unsigned long long)payload.sourcesHash, (unsigned long long)scene->sourcesHash);
             avdHLSSegmentAVDataFree(&payload.avData);
             continue;
         }
@@ -1,6 +1,7 @@
 #include "audio/avd_audio_core.h"
 #include "audio/avd_audio_streaming_player.h"
 #include "core/avd_base.h"
+#include "core/avd_profiler.h"
 #include "core/avd_types.h"
 #include "core/avd_utils.h"
 #include "pico/picoPerf.h"
@@ -301,7 +302,11 @@ bool avdSceneHLSPlayerContextUpdate(AVD_Vulkan *vulkan, AVD_Audio *audio, AVD_Sc
     } else {
         context->currentSegmentPlayTime = time - context->currentSegmentStartTime;
         if (!avdVulkanVideoDecoderHasFrameForTime(&context->videoPlayer, time)) {
-            AVD_CHECK(PRIV_avdSceneHLSPlayerContextDecodeVideoFrames(vulkan, audio, context));
+            bool decoded = false;
+            AVD_PROFILE_SCOPE("HLSPlayer/DecodeVideo") {
+                decoded = PRIV_avdSceneHLSPlayerContextDecodeVideoFrames(vulkan, audio, context);
+            }
+            AVD_CHECK(decoded);
         }
     }
 
@@ -37,7 +37,7 @@ void avdHLSMediaCacheDestroy(AVD_HLSMediaCache *cache)
     }
 }
 
-bool avdHLSMediaCacheQuery(AVD_HLSMediaCache *cache, AVD_UInt32 key, char **data, AVD_Size *dataSize)
+bool avdHLSMediaCacheQuery(AVD_HLSMediaCache *cache, AVD_UInt64 key, char **data, AVD_Size *dataSize)
 {
     AVD_ASSERT(cache != NULL);
     AVD_ASSERT(data != NULL);
@@ -62,7 +62,7 @@ bool avdHLSMediaCacheQuery(AVD_HLSMediaCache *cache, AVD_UInt32 key, char **data
     return false;
 }
 
-bool avdHLSMediaCacheInsert(AVD_HLSMediaCache *cache, AVD_UInt32 key, const char *data, AVD_Size dataSize)
+bool avdHLSMediaCacheInsert(AVD_HLSMediaCache *cache, AVD_UInt64 key, const char *data, AVD_Size dataSize)
 {
     AVD_ASSERT(cache != NULL);
     AVD_ASSERT(data != NULL);
@@ -1,6 +1,8 @@
 #include "core/avd_base.h"
 #include "scenes/hls_player/avd_scene_hls_player_segment_store.h"
 
+#include "pico/picoMpegTS.h"
+
 bool avdHLSSegmentStoreInit(AVD_HLSSegmentStore *store)
 {
     AVD_ASSERT(store);
@@ -155,17 +157,87 @@ void avdHLSSegmentAVDataFree(AVD_HLSSegmentAVData *avData)
 {
     AVD_ASSERT(avData != NULL);
 
+    // the AAC data lives in the same allocation right after the H.264 data
     if (avData->h264Buffer) {
         AVD_FREE(avData->h264Buffer);
         avData->h264Buffer = NULL;
         avData->h264Size   = 0;
     }
 
-    if (avData->aacBuffer) {
-        AVD_FREE(avData->aacBuffer);
-        avData->aacBuffer = NULL;
-        avData->aacSize   = 0;
+    memset(avData, 0, sizeof(AVD_HLSSegmentAVData));
+}
+
+bool avdHLSSegmentAVDataDemux(const AVD_UInt8 *data, AVD_Size dataSize, AVD_HLSSegmentAVData *outAvData)
+{
+    AVD_ASSERT(data != NULL);
+    AVD_ASSERT(outAvData != NULL);
+
+    memset(outAvData, 0, sizeof(AVD_HLSSegmentAVData));
+
+    picoMpegTS mpegts = picoMpegTSCreate(false);
+    AVD_CHECK_MSG(mpegts != NULL, "Failed to create MPEG-TS parser");
+
+    if (picoMpegTSAddBuffer(mpegts, (uint8_t *)data, dataSize) != PICO_MPEGTS_RESULT_SUCCESS) {
+        picoMpegTSDestroy(mpegts);
+        AVD_LOG_ERROR("Failed to parse MPEG-TS buffer");
+        return false;
     }
 
-    memset(avData, 0, sizeof(AVD_HLSSegmentAVData));
-}
\ No newline at end of file
+    size_t pesPacketCount           = 0;
+    picoMpegTSPESPacket *pesPackets = picoMpegTSGetPESPackets(mpegts, &pesPacketCount);
+
+    AVD_Size totalH264Size  = 0;
+    AVD_Size totalAudioSize = 0;
+
+    for (AVD_Size i = 0; i < pesPacketCount; i++) {
+        picoMpegTSPESPacket pesPacket = pesPackets[i];
+        if (picoMpegTSGetPMSStreamByPID(mpegts, pesPacket->head.pid)->streamType == PICO_MPEGTS_STREAM_TYPE_H264) {
+            totalH264Size += pesPacket->dataLength;
+        } else if (picoMpegTSIsStreamIDVideo(pesPacket->head.streamId)) {
+            AVD_LOG_WARN("Found video PES packet with video, but stream type is not H.264");
+        }
+        if (picoMpegTSGetPMSStreamByPID(mpegts, pesPacket->head.pid)->streamType == PICO_MPEGTS_STREAM_TYPE_AAC_ADTS) {
+            totalAudioSize += pesPacket->dataLength;
+        } else if (picoMpegTSIsStreamIDAudio(pesPacket->head.streamId)) {
+            AVD_LOG_WARN("Found audio PES packet with audio, but stream type is not AAC ADTS");
+        }
+    }
+
+    if (totalH264Size == 0 || totalAudioSize == 0) {
+        picoMpegTSDestroy(mpegts);
+        AVD_LOG_ERROR("Segment is missing H.264 video or AAC audio data");
+        return false;
+    }
+
+    // both streams share a single allocation owned by h264Buffer, see avdHLSSegmentAVDataFree
+    uint8_t *h264Buffer = (uint8_t *)AVD_MALLOC(totalH264Size + totalAudioSize);
+    if (!h264Buffer) {
+        picoMpegTSDestroy(mpegts);
+        AVD_LOG_ERROR("Failed to allocate A/V buffer");
+        return false;
+    }
+    uint8_t *audioBuffer = h264Buffer + totalH264Size;
+
+    size_t h264Offset  = 0;
+    size_t audioOffset = 0;
+    for (AVD_Size i = 0; i < pesPacketCount; i++) {
+        picoMpegTSPESPacket pesPacket = pesPackets[i];
+        if (picoMpegTSGetPMSStreamByPID(mpegts, pesPacket->head.pid)->streamType == PICO_MPEGTS_STREAM_TYPE_H264) {
+            memcpy(h264Buffer + h264Offset, pesPacket->data, pesPacket->dataLength);
+            h264Offset += pesPacket->dataLength;
+        }
+
+        if (picoMpegTSGetPMSStreamByPID(mpegts, pesPacket->head.pid)->streamType == PICO_MPEGTS_STREAM_TYPE_AAC_ADTS) {
+            memcpy(audioBuffer + audioOffset, pesPacket->data, pesPacket->dataLength);
+            audioOffset += pesPacket->dataLength;
+        }
+    }
+
+    picoMpegTSDestroy(mpegts);
+
+    outAvData->h264Buffer = h264Buffer;
+    outAvData->h264Size   = totalH264Size;
+    outAvData->aacBuffer  = audioBuffer;
+    outAvData->aacSize    = totalAudioSize;
+    return true;
+}
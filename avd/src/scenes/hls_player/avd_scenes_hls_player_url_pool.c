@@ -1,6 +1,7 @@
 #include "scenes/hls_player/avd_scene_hls_url_pool.h"
 
 #include "core/avd_base.h"
+#include "core/avd_hash.h"
 #include "core/avd_types.h"
 #include "core/avd_utils.h"
 
@@ -30,12 +31,12 @@ void avdHLSURLPoolDestroy(AVD_HLSURLPool *pool)
     }
 }
 
-AVD_Bool avdHLSURLPoolInsert(AVD_HLSURLPool *pool, const char *url, AVD_UInt32 *outHash)
+AVD_Bool avdHLSURLPoolInsert(AVD_HLSURLPool *pool, const char *url, AVD_UInt64 *outHash)
 {
     AVD_ASSERT(pool != NULL);
     AVD_ASSERT(url != NULL);
 
-    AVD_UInt32 hash = avdHashString(url);
+    AVD_UInt64 hash = avdHash64String(url);
     if (outHash) {
         *outHash = hash;
     }
@@ -44,6 +45,11 @@ AVD_Bool avdHLSURLPoolInsert(AVD_HLSURLPool *pool, const char *url, AVD_UInt32 *
 
     for (AVD_UInt32 i = 0; i < pool->count; i++) {
         if (pool->hashes[i] == hash) {
+            if (strcmp(pool->urls[i], url) != 0) {
+                AVD_LOG_ERROR("URL pool hash collision 0x%016llX between %s and %s", (unsigned long long)hash, pool->urls[i], url);
+                picoThreadMutexUnlock(pool->mutex);
+                return false;
+            }
             pool->lastAccess[i] = ++pool->accessCounter;
             picoThreadMutexUnlock(pool->mutex);
             return true;
@@ -79,7 +85,7 @@ AVD_Bool avdHLSURLPoolInsert(AVD_HLSURLPool *pool, const char *url, AVD_UInt32 *
     return true;
 }
 
-const char *avdHLSURLPoolGet(AVD_HLSURLPool *pool, AVD_UInt32 hash)
+const char *avdHLSURLPoolGet(AVD_HLSURLPool *pool, AVD_UInt64 hash)
 {
     AVD_ASSERT(pool != NULL);
 
@@ -1,10 +1,9 @@
-#include "pico/picoPerf.h"
 #include "scenes/hls_player/avd_scene_hls_worker_pool.h"
 
 #include "core/avd_base.h"
+#include "core/avd_profiler.h"
 #include "core/avd_utils.h"
 #include "pico/picoM3U8.h"
-#include "pico/picoMpegTS.h"
 #include "scenes/hls_player/avd_scenes_hls_player.h"
 #include "vulkan/avd_vulkan_video.h"
 
@@ -19,7 +18,7 @@ static void PRIV_avdHLSWorkerPoolFreeDemuxPayload(void *payloadRaw, void *contex
     AVD_ASSERT(payload != NULL);
 
     if (payload->data) {
-        free(payload->data);
+        AVD_FREE(payload->data);
         payload->data     = NULL;
         payload->dataSize = 0;
     }
@@ -39,6 +38,8 @@ static void PRIV_avdHLSSourceDownloadWorker(void *arg)
 {
     AVD_HLSWorkerPool *pool     = (AVD_HLSWorkerPool *)arg;
     pool->sourceDownloadRunning = true;
+    avdMemorySetThreadTag(AVD_MEMORY_TAG_HLS);
+    AVD_PROFILE_THREAD_NAME("HLS Source Download");
 
     AVD_HLS_WORKER_POOL_LOG("Source download worker started [tid: %llu]", picoThreadGetCurrentId());
 
@@ -51,17 +52,20 @@ static void PRIV_avdHLSSourceDownloadWorker(void *arg)
             continue;
         }
 
-        AVD_HLS_WORKER_POOL_LOG("Source download worker received task [src: %u, urlHash: 0x%08X, sourcesHash: 0x%08X]", sourcePayload.sourceIndex, sourcePayload.sourceUrlHash, sourcePayload.sourcesHash);
+        AVD_HLS_WORKER_POOL_LOG("Source download worker received task [src: %u, urlHash: 0x%016llX, sourcesHash: 0x%016llX]", sourcePayload.sourceIndex, (unsigned long long)sourcePayload.sourceUrlHash, (unsigned long long)sourcePayload.sourcesHash);
 
         const char *sourceUrl = avdHLSURLPoolGet(pool->urlPool, sourcePayload.sourceUrlHash);
         if (!sourceUrl) {
-            AVD_LOG_ERROR("Failed to get source URL from pool for hash 0x%08X", sourcePayload.sourceUrlHash);
+            AVD_LOG_ERROR("Failed to get source URL from pool for hash 0x%016llX", (unsigned long long)sourcePayload.sourceUrlHash);
             continue;
         }
 
         char *data = NULL;
 
-        if (!avdCurlFetchStringContent(sourceUrl, &data, NULL)) {
+        AVD_PROFILE_BEGIN("HLS/FetchPlaylist");
+        bool fetched = avdCurlFetchStringContent(sourceUrl, &data, NULL);
+        AVD_PROFILE_END();
+        if (!fetched) {
             AVD_LOG_ERROR("Failed to fetch HLS playlist for source: %s", sourceUrl);
             goto cleanup;
         }
@@ -105,7 +109,7 @@ static void PRIV_avdHLSSourceDownloadWorker(void *arg)
                 continue;
             }
 
-            AVD_HLS_WORKER_POOL_LOG("Source download worker enqueue media [seg: %u, src: %u, urlHash: 0x%08X]", mediaPayload.segmentId, mediaPayload.sourceIndex, mediaPayload.urlHash);
+            AVD_HLS_WORKER_POOL_LOG("Source download worker enqueue media [seg: %u, src: %u, urlHash: 0x%016llX]", mediaPayload.segmentId, mediaPayload.sourceIndex, (unsigned long long)mediaPayload.urlHash);
             if (!picoThreadChannelSend(pool->mediaDownloadChannel, &mediaPayload)) {
                 AVD_LOG_ERROR("Failed to send media download task");
             }
@@ -116,17 +120,21 @@ static void PRIV_avdHLSSourceDownloadWorker(void *arg)
             picoM3U8PlaylistDestroy(playlist);
         }
         if (data) {
-            free(data);
+            AVD_FREE(data);
         }
     }
 
+    AVD_PROFILE_THREAD_SHUTDOWN();
     AVD_HLS_WORKER_POOL_LOG("Source download worker stopping [tid: %llu]", picoThreadGetCurrentId());
+    avdLogThreadShutdown();
 }
 
 static void PRIV_avdHLSMediaDownloadWorker(void *arg)
 {
     AVD_HLSWorkerPool *pool    = (AVD_HLSWorkerPool *)arg;
     pool->mediaDownloadRunning = true;
+    avdMemorySetThreadTag(AVD_MEMORY_TAG_HLS);
+    AVD_PROFILE_THREAD_NAME("HLS Media Download");
 
     AVD_HLS_WORKER_POOL_LOG("Media download worker started [tid: %llu]", picoThreadGetCurrentId());
 
@@ -138,7 +146,7 @@ static void PRIV_avdHLSMediaDownloadWorker(void *arg)
             continue;
         }
 
-        AVD_HLS_WORKER_POOL_LOG("Media download worker received task [src: %u, seg: %u, urlHash: 0x%08X]", mediaPayload.sourceIndex, mediaPayload.segmentId, mediaPayload.urlHash);
+        AVD_HLS_WORKER_POOL_LOG("Media download worker received task [src: %u, seg: %u, urlHash: 0x%016llX]", mediaPayload.sourceIndex, mediaPayload.segmentId, (unsigned long long)mediaPayload.urlHash);
 
         demuxPayload.segmentId   = mediaPayload.segmentId;
         demuxPayload.sourceIndex = mediaPayload.sourceIndex;
@@ -148,43 +156,47 @@ static void PRIV_avdHLSMediaDownloadWorker(void *arg)
         demuxPayload.dataSize    = 0;
 
         if (avdHLSMediaCacheQuery(pool->mediaCache, mediaPayload.urlHash, &demuxPayload.data, &demuxPayload.dataSize)) {
-            AVD_HLS_WORKER_POOL_LOG("Media download worker cache hit [urlHash: 0x%08X, seg: %u]", mediaPayload.urlHash, mediaPayload.segmentId);
+            AVD_HLS_WORKER_POOL_LOG("Media download worker cache hit [urlHash: 0x%016llX, seg: %u]", (unsigned long long)mediaPayload.urlHash, mediaPayload.segmentId);
             if (!picoThreadChannelSend(pool->mediaDemuxChannel, &demuxPayload)) {
                 AVD_LOG_ERROR("Failed to send media demux task (cached)");
-                free(demuxPayload.data);
+                AVD_FREE(demuxPayload.data);
             }
             continue;
         }
 
         const char *segmentUrl = avdHLSURLPoolGet(pool->urlPool, mediaPayload.urlHash);
         if (!segmentUrl) {
-            AVD_LOG_ERROR("Failed to get URL from pool for hash 0x%08X", mediaPayload.urlHash);
+            AVD_LOG_ERROR("Failed to get URL from pool for hash 0x%016llX", (unsigned long long)mediaPayload.urlHash);
             continue;
         }
 
-        picoPerfTime downloadStartTime = picoPerfNow();
-        if (!avdCurlDownloadToMemory(segmentUrl, (void **)&demuxPayload.data, &demuxPayload.dataSize)) {
+        AVD_PROFILE_BEGIN("HLS/DownloadSegment");
+        bool downloaded = avdCurlDownloadToMemory(segmentUrl, (void **)&demuxPayload.data, &demuxPayload.dataSize);
+        AVD_PROFILE_END();
+        if (!downloaded) {
             AVD_LOG_ERROR("Failed to download media segment from url: %s", segmentUrl);
             continue;
         }
-        picoPerfTime downloadEndTime = picoPerfNow();
-        // AVD_LOG_VERBOSE("Downloading segment %u took %lf ms", demuxPayload.segmentId, picoPerfDurationMilliseconds(downloadStartTime, downloadEndTime));
 
         avdHLSMediaCacheInsert(pool->mediaCache, mediaPayload.urlHash, demuxPayload.data, demuxPayload.dataSize);
 
         AVD_HLS_WORKER_POOL_LOG("Media download worker forwarding demux [seg: %u]", demuxPayload.segmentId);
         if (!picoThreadChannelSend(pool->mediaDemuxChannel, &demuxPayload)) {
             AVD_LOG_ERROR("Failed to send media demux task");
-            free(demuxPayload.data);
+            AVD_FREE(demuxPayload.data);
         }
     }
+    AVD_PROFILE_THREAD_SHUTDOWN();
     AVD_HLS_WORKER_POOL_LOG("Media download worker stopping [tid: %llu]", picoThreadGetCurrentId());
+    avdLogThreadShutdown();
 }
 
 static void PRIV_avdHLSMediaDemuxWorker(void *arg)
 {
     AVD_HLSWorkerPool *pool = (AVD_HLSWorkerPool *)arg;
     pool->mediaDemuxRunning = true;
+    avdMemorySetThreadTag(AVD_MEMORY_TAG_HLS);
+    AVD_PROFILE_THREAD_NAME("HLS Media Demux");
 
     AVD_HLS_WORKER_POOL_LOG("Media demux worker started [tid: %llu]", picoThreadGetCurrentId());
 
@@ -198,102 +210,33 @@ static void PRIV_avdHLSMediaDemuxWorker(void *arg)
 
         AVD_HLS_WORKER_POOL_LOG("Media demux worker received task [src: %u, seg: %u, size: %zu]", demuxPayload.sourceIndex, demuxPayload.segmentId, demuxPayload.dataSize);
 
-        picoPerfTime demuxStartTime = picoPerfNow();
-
-        picoMpegTS mpegts = picoMpegTSCreate(false);
-        if (!mpegts) {
-            AVD_LOG_ERROR("Failed to create MPEG-TS parser for segment %u", demuxPayload.segmentId);
-            goto cleanup;
-        }
-
-        if (picoMpegTSAddBuffer(mpegts, (uint8_t *)demuxPayload.data, demuxPayload.dataSize) != PICO_MPEGTS_RESULT_SUCCESS) {
-            AVD_LOG_ERROR("Failed to parse MPEG-TS buffer for segment %u", demuxPayload.segmentId);
-            goto cleanup;
-        }
-
-        size_t pesPacketCount           = 0;
-        picoMpegTSPESPacket *pesPackets = picoMpegTSGetPESPackets(mpegts, &pesPacketCount);
-
-        AVD_Size totalH264Size  = 0;
-        AVD_Size totalAudioSize = 0;
-
-        for (AVD_Size i = 0; i < pesPacketCount; i++) {
-            picoMpegTSPESPacket pesPacket = pesPackets[i];
-            if (picoMpegTSGetPMSStreamByPID(mpegts, pesPacket->head.pid)->streamType == PICO_MPEGTS_STREAM_TYPE_H264) {
-                totalH264Size += pesPacket->dataLength;
-            } else if (picoMpegTSIsStreamIDVideo(pesPacket->head.streamId)) {
-                AVD_LOG_WARN("Found video PES packet with video, but stream type is not H.264 for segment %u", demuxPayload.segmentId);
-            }
-            if (picoMpegTSGetPMSStreamByPID(mpegts, pesPacket->head.pid)->streamType == PICO_MPEGTS_STREAM_TYPE_AAC_ADTS) {
-                totalAudioSize += pesPacket->dataLength;
-            } else if (picoMpegTSIsStreamIDAudio(pesPacket->head.streamId)) {
-                AVD_LOG_WARN("Found audio PES packet with audio, but stream type is not AAC ADTS for segment %u", demuxPayload.segmentId);
-            }
-        }
-
-        if (totalH264Size == 0 || totalAudioSize == 0) {
-            AVD_LOG_ERROR("No H.264 video data found in segment %u", demuxPayload.segmentId);
+        AVD_PROFILE_BEGIN("HLS/DemuxSegment");
+        bool demuxed = avdHLSSegmentAVDataDemux((const AVD_UInt8 *)demuxPayload.data, demuxPayload.dataSize, &readyPayload.avData);
+        AVD_PROFILE_END();
+        if (!demuxed) {
+            AVD_LOG_ERROR("Failed to demux segment %u", demuxPayload.segmentId);
             goto cleanup;
         }
+        readyPayload.sourcesHash      = demuxPayload.sourcesHash;
+        readyPayload.avData.duration  = demuxPayload.duration;
+        readyPayload.avData.segmentId = demuxPayload.segmentId;
+        readyPayload.avData.source    = demuxPayload.sourceIndex;
 
-        char *h264Buffer = (char *)AVD_MALLOC(totalH264Size);
-        if (!h264Buffer) {
-            AVD_LOG_ERROR("Failed to allocate H.264 buffer for segment %u", demuxPayload.segmentId);
-            goto cleanup;
-        }
-
-        char *audioBuffer = (char *)AVD_MALLOC(totalAudioSize);
-        if (!audioBuffer) {
-            AVD_LOG_ERROR("Failed to allocate audio buffer for segment %u", demuxPayload.segmentId);
-            AVD_FREE(h264Buffer);
-            goto cleanup;
-        }
-
-        size_t h264Offset  = 0;
-        size_t audioOffset = 0;
-        for (AVD_Size i = 0; i < pesPacketCount; i++) {
-            picoMpegTSPESPacket pesPacket = pesPackets[i];
-            if (picoMpegTSGetPMSStreamByPID(mpegts, pesPacket->head.pid)->streamType == PICO_MPEGTS_STREAM_TYPE_H264) {
-                memcpy(h264Buffer + h264Offset, pesPacket->data, pesPacket->dataLength);
-                h264Offset += pesPacket->dataLength;
-            }
-
-            if (picoMpegTSGetPMSStreamByPID(mpegts, pesPacket->head.pid)->streamType == PICO_MPEGTS_STREAM_TYPE_AAC_ADTS) {
-                memcpy(audioBuffer + audioOffset, pesPacket->data, pesPacket->dataLength);
-                audioOffset += pesPacket->dataLength;
-            }
-        }
-
-        readyPayload.sourcesHash = demuxPayload.sourcesHash;
-        readyPayload.avData      = (AVD_HLSSegmentAVData){
-                 .h264Buffer = (uint8_t *)h264Buffer,
-                 .h264Size   = totalH264Size,
-                 .aacBuffer  = (uint8_t *)audioBuffer,
-                 .aacSize    = totalAudioSize,
-                 .duration   = demuxPayload.duration,
-                 .segmentId  = demuxPayload.segmentId,
-                 .source     = demuxPayload.sourceIndex};
-
-        picoPerfTime demuxEndTime = picoPerfNow();
-        // AVD_LOG_VERBOSE("Demuxing segment %u took %lf ms", demuxPayload.segmentId, picoPerfDurationMilliseconds(demuxStartTime, demuxEndTime));
-
-        AVD_HLS_WORKER_POOL_LOG("Media demux worker forwarding ready payload [seg: %u, h264: %zu bytes]", demuxPayload.segmentId, totalH264Size);
+        AVD_HLS_WORKER_POOL_LOG("Media demux worker forwarding ready payload [seg: %u, h264: %zu bytes]", demuxPayload.segmentId, readyPayload.avData.h264Size);
         if (!picoThreadChannelSend(pool->mediaReadyChannel, &readyPayload)) {
             AVD_LOG_ERROR("Failed to send ready segment %u", demuxPayload.segmentId);
-            AVD_FREE(h264Buffer);
-            AVD_FREE(audioBuffer);
+            avdHLSSegmentAVDataFree(&readyPayload.avData);
         }
 
     cleanup:
-        if (mpegts) {
-            picoMpegTSDestroy(mpegts);
-        }
         if (demuxPayload.data) {
-            free(demuxPayload.data);
+            AVD_FREE(demuxPayload.data);
         }
     }
 
+    AVD_PROFILE_THREAD_SHUTDOWN();
     AVD_HLS_WORKER_POOL_LOG("HLS Media Demux Worker stopping with thread ID: %llu.", picoThreadGetCurrentId());
+    avdLogThreadShutdown();
 }
 
 bool avdHLSWorkerPoolInit(AVD_HLSWorkerPool *pool, AVD_HLSURLPool *urlPool, AVD_HLSMediaCache *mediaCache, AVD_SceneHLSPlayer *parentScene)
@@ -401,12 +344,12 @@ void avdHLSWorkerPoolFlush(AVD_HLSWorkerPool *pool)
     }
 }
 
-bool avdHLSWorkerPoolSendSourceTask(AVD_HLSWorkerPool *pool, AVD_UInt32 sourceIndex, AVD_UInt32 sourcesHash, const char *sourceUrl)
+bool avdHLSWorkerPoolSendSourceTask(AVD_HLSWorkerPool *pool, AVD_UInt32 sourceIndex, AVD_UInt64 sourcesHash, const char *sourceUrl)
 {
     AVD_ASSERT(pool != NULL);
     AVD_ASSERT(sourceUrl != NULL);
 
-    AVD_UInt32 sourceUrlHash = 0;
+    AVD_UInt64 sourceUrlHash = 0;
     if (!avdHLSURLPoolInsert(pool->urlPool, sourceUrl, &sourceUrlHash)) {
         AVD_LOG_ERROR("Failed to insert source URL into pool: %s", sourceUrl);
         return false;
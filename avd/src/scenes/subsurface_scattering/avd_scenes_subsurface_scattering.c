@@ -21,6 +21,7 @@
 #define AVD_SSS_BUDDHA_NORMAL_MAP                              15
 #define AVD_SSS_NOISE_TEXTURE                                  16
 #define AVD_SSS_RENDER_MODE_COUNT                              17
+#define AVD_SSS_CAMERA_FOV_DEGREES                             67.0f
 
 typedef struct {
     AVD_Matrix4x4 viewModelMatrix;
@@ -408,6 +409,9 @@ static bool PRIV_avdSceneInitializeParams(AVD_SceneSubsurfaceScattering *subsurf
     subsurfaceScattering->translucencyAmbientDiffusion = 0.1f;
     subsurfaceScattering->useScreenSpaceIrradiance     = true;
 
+    subsurfaceScattering->useLods          = true;
+    subsurfaceScattering->lodMaxPixelError = 1.0f;
+
     return true;
 }
 
@@ -426,7 +430,7 @@ bool avdSceneSubsurfaceScatteringInit(struct AVD_AppState *appState, union AVD_S
     AVD_CHECK(avdCreateDescriptorSetLayout(
         &subsurfaceScattering->set0Layout,
         appState->vulkan.device,
-        (VkDescriptorType[]){VK_DESCRIPTOR_TYPE_STORAGE_BUFFER}, 1,
+        (VkDescriptorType[]){VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER}, 2,
         VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT));
     AVD_CHECK(avdAllocateDescriptorSet(
         appState->vulkan.device,
@@ -478,6 +482,7 @@ void avdSceneSubsurfaceScatteringDestroy(struct AVD_AppState *appState, union AV
     avdVulkanFramebufferDestroy(&appState->vulkan, &subsurfaceScattering->diffusedIrradianceBuffer);
 
     avdVulkanBufferDestroy(&appState->vulkan, &subsurfaceScattering->vertexBuffer);
+    avdVulkanBufferDestroy(&appState->vulkan, &subsurfaceScattering->indexBuffer);
 
     avdVulkanImageDestroy(&appState->vulkan, &subsurfaceScattering->alienThicknessMap);
     avdVulkanImageDestroy(&appState->vulkan, &subsurfaceScattering->buddhaThicknessMap);
@@ -561,21 +566,21 @@ bool avdSceneSubsurfaceScatteringLoad(struct AVD_AppState *appState, union AVD_S
             AVD_CHECK(avd3DSceneLoadObj(
                 "assets/scene_subsurface_scattering/alien.obj",
                 &subsurfaceScattering->models,
-                AVD_OBJ_LOAD_FLAG_IGNORE_OBJECTS));
+                AVD_OBJ_LOAD_FLAG_IGNORE_OBJECTS | AVD_OBJ_LOAD_FLAG_WELD_PACKED | AVD_OBJ_LOAD_FLAG_LODS));
             break;
         case 3:
             *statusMessage = "Loaded Buddha Model";
             AVD_CHECK(avd3DSceneLoadObj(
                 "assets/scene_subsurface_scattering/buddha.obj",
                 &subsurfaceScattering->models,
-                AVD_OBJ_LOAD_FLAG_IGNORE_OBJECTS));
+                AVD_OBJ_LOAD_FLAG_IGNORE_OBJECTS | AVD_OBJ_LOAD_FLAG_WELD_PACKED | AVD_OBJ_LOAD_FLAG_LODS));
             break;
         case 4:
             *statusMessage = "Loaded Standford Dragon Model";
             AVD_CHECK(avd3DSceneLoadObj(
                 "assets/scene_subsurface_scattering/standford_dragon.obj",
                 &subsurfaceScattering->models,
-                AVD_OBJ_LOAD_FLAG_IGNORE_OBJECTS));
+                AVD_OBJ_LOAD_FLAG_IGNORE_OBJECTS | AVD_OBJ_LOAD_FLAG_WELD_PACKED | AVD_OBJ_LOAD_FLAG_LODS));
             break;
         case 5:
             // NOTE: Pretty dumb thing to do! Ideally we should generate the sphere
@@ -586,7 +591,7 @@ bool avdSceneSubsurfaceScatteringLoad(struct AVD_AppState *appState, union AVD_S
             AVD_CHECK(avd3DSceneLoadObj(
                 "assets/scene_subsurface_scattering/sphere.obj",
                 &subsurfaceScattering->models,
-                AVD_OBJ_LOAD_FLAG_IGNORE_OBJECTS));
+                AVD_OBJ_LOAD_FLAG_IGNORE_OBJECTS | AVD_OBJ_LOAD_FLAG_WELD_PACKED));
             break;
         case 6:
             *statusMessage = "Loaded Alien Thickness Map";
@@ -640,7 +645,8 @@ bool avdSceneSubsurfaceScatteringLoad(struct AVD_AppState *appState, union AVD_S
                     64,
                     VK_FORMAT_R8G8B8A8_UNORM,
                     VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, "Scene/SubsurfaceScattering/NoiseTexture")));
-            uint8_t *noiseTextureData = (uint8_t *)malloc(64 * 64 * 4);
+            // scene loading runs one step per frame, so the frame arena outlives the upload below
+            uint8_t *noiseTextureData = AVD_ARENA_PUSH_ARRAY(avdArenaFrame(), uint8_t, 64 * 64 * 4);
             AVD_CHECK_MSG(noiseTextureData != NULL, "Failed to allocate noise texture data");
             for (uint32_t i = 0; i < 64 * 64; i++) {
                 noiseTextureData[i * 4 + 0] = (uint8_t)(rand() % 256);
@@ -653,7 +659,6 @@ bool avdSceneSubsurfaceScatteringLoad(struct AVD_AppState *appState, union AVD_S
                 &subsurfaceScattering->noiseTexture,
                 noiseTextureData,
                 NULL));
-            free(noiseTextureData);
             break;
         case 13:
             *statusMessage    = "Set Up GPU buffers";
@@ -670,12 +675,29 @@ bool avdSceneSubsurfaceScatteringLoad(struct AVD_AppState *appState, union AVD_S
                 &subsurfaceScattering->vertexBuffer,
                 subsurfaceScattering->models.modelResources.verticesList.items,
                 bufferSize));
-            VkWriteDescriptorSet descriptorSetWrite = {0};
-            AVD_CHECK(avdWriteBufferDescriptorSet(&descriptorSetWrite,
+            size_t indexBufferSize = subsurfaceScattering->models.modelResources.indicesList.count * subsurfaceScattering->models.modelResources.indicesList.itemSize;
+            AVD_CHECK(avdVulkanBufferCreate(
+                &appState->vulkan,
+                &subsurfaceScattering->indexBuffer,
+                indexBufferSize,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                "SubsurfaceScatteringIndexBuffer"));
+            AVD_CHECK(avdVulkanBufferUpload(
+                &appState->vulkan,
+                &subsurfaceScattering->indexBuffer,
+                subsurfaceScattering->models.modelResources.indicesList.items,
+                indexBufferSize));
+            VkWriteDescriptorSet descriptorSetWrites[2] = {0};
+            AVD_CHECK(avdWriteBufferDescriptorSet(&descriptorSetWrites[0],
                                                   subsurfaceScattering->set0,
                                                   0,
                                                   &subsurfaceScattering->vertexBuffer.descriptorBufferInfo));
-            vkUpdateDescriptorSets(appState->vulkan.device, 1, &descriptorSetWrite, 0, NULL);
+            AVD_CHECK(avdWriteBufferDescriptorSet(&descriptorSetWrites[1],
+                                                  subsurfaceScattering->set0,
+                                                  1,
+                                                  &subsurfaceScattering->indexBuffer.descriptorBufferInfo));
+            vkUpdateDescriptorSets(appState->vulkan.device, 2, descriptorSetWrites, 0, NULL);
             break;
         case 14:
             *statusMessage = "Set Up Bindless Descriptors";
@@ -722,6 +744,8 @@ void avdSceneSubsurfaceScatteringInputEvent(struct AVD_AppState *appState, union
             subsurfaceScattering->renderMode = (subsurfaceScattering->renderMode + 1) % AVD_SSS_RENDER_MODE_COUNT;
         } else if (event->key.key == GLFW_KEY_S && event->key.action == GLFW_PRESS) {
             subsurfaceScattering->useScreenSpaceIrradiance = !subsurfaceScattering->useScreenSpaceIrradiance;
+        } else if (event->key.key == GLFW_KEY_L && event->key.action == GLFW_PRESS) {
+            subsurfaceScattering->useLods = !subsurfaceScattering->useLods;
         }
     } else if (event->type == AVD_INPUT_EVENT_MOUSE_BUTTON) {
         if (event->mouseButton.button == GLFW_MOUSE_BUTTON_LEFT) {
@@ -765,7 +789,7 @@ static bool PRIV_avdSceneUpdateCamera(AVD_SceneSubsurfaceScattering *subsurfaceS
         avdVec3(0.0f, 1.0f, 0.0f));
 
     subsurfaceScattering->projectionMatrix = avdMatPerspective(
-        avdDeg2Rad(67.0f),
+        avdDeg2Rad(AVD_SSS_CAMERA_FOV_DEGREES),
         (float)subsurfaceScattering->sceneWidth / (float)subsurfaceScattering->sceneHeight,
         0.1f,
         100.0f);
@@ -841,6 +865,11 @@ bool avdSceneSubsurfaceScatteringUpdate(struct AVD_AppState *appState, union AVD
     AVD_CHECK(PRIV_avdSceneUpdateCamera(subsurfaceScattering));
     AVD_CHECK(PRIV_avdSceneUpdateLighting(subsurfaceScattering, (AVD_Float)appState->framerate.currentTime));
 
+    // the frame just finished was drawn with the current setting
+    float frameTime         = (float)appState->framerate.deltaTime * 1000.0f;
+    float *averageFrameTime = subsurfaceScattering->useLods ? &subsurfaceScattering->frameTimeLodsOn : &subsurfaceScattering->frameTimeLodsOff;
+    *averageFrameTime       = *averageFrameTime > 0.0f ? avdLerp(*averageFrameTime, frameTime, 0.05f) : frameTime;
+
     const float scale = (float)appState->framerate.deltaTime * 2.0f;
 
     if (appState->input.keyState[GLFW_KEY_UP] && appState->input.keyState[GLFW_KEY_1]) {
@@ -905,6 +934,7 @@ bool avdSceneSubsurfaceScatteringUpdate(struct AVD_AppState *appState, union AVD
              "  - Focus Target: %s [Press F to cycle]\n"
              "  - Render Mode: %s [Press R to cycle]\n"
              "  - Screen Space Irradiance: %s [Press S to toggle]\n"
+             "  - Levels of Detail: %s [Press L to toggle]\n"
              "  - Camera: Drag LMB to orbit, Scroll to zoom\n"
              "Material Parameters:\n"
              "  - Roughness: %.2f [1 + Up/Down]\n"
@@ -921,11 +951,14 @@ bool avdSceneSubsurfaceScatteringUpdate(struct AVD_AppState *appState, union AVD
              "General Stats:\n"
              "  - Frame Rate: %zu FPS\n"
              "  - Frame Time: %.2f ms\n"
+             "  - Triangles Drawn: %u (LOD levels %d, %d, %d)\n"
+             "  - Average Frame Time: LODs on %.2f ms, off %.2f ms\n"
              "Press ESC to return to the main menu",
              subsurfaceScattering->bloomEnabled ? "Yes" : "No",
              currentFocusName,
              PRIV_avdSceneSubsurfaceScatteringGetRenderModeName(subsurfaceScattering->renderMode),
              subsurfaceScattering->useScreenSpaceIrradiance ? "Yes" : "No",
+             subsurfaceScattering->useLods ? "Yes" : "No",
              subsurfaceScattering->materialRoughness,
              subsurfaceScattering->materialMetallic,
              subsurfaceScattering->translucencyScale,
@@ -937,7 +970,13 @@ bool avdSceneSubsurfaceScatteringUpdate(struct AVD_AppState *appState, union AVD
              subsurfaceScattering->bloomIntensity,
              subsurfaceScattering->bloomSoftKnee,
              appState->framerate.fps,
-             appState->framerate.deltaTime * 1000.0f);
+             appState->framerate.deltaTime * 1000.0f,
+             subsurfaceScattering->drawnTriangles,
+             subsurfaceScattering->modelsInfo[0].lodLevel,
+             subsurfaceScattering->modelsInfo[1].lodLevel,
+             subsurfaceScattering->modelsInfo[2].lodLevel,
+             subsurfaceScattering->frameTimeLodsOn,
+             subsurfaceScattering->frameTimeLodsOff);
 
     AVD_CHECK(avdRenderableTextUpdate(&subsurfaceScattering->info,
                                       &appState->fontRenderer,
@@ -967,23 +1006,34 @@ static bool PRIV_avdSceneRenderFirstMesh(
     AVD_Model *model = (AVD_Model *)avdListGet(&subsurfaceScattering->models.modelsList, modelIndex);
     AVD_Mesh *mesh   = (AVD_Mesh *)avdListGet(&model->meshes, 0); // We only render the first mesh for now
 
-    AVD_Matrix4x4 modelMatrix = avdMatCalculateTransform(
-        subsurfaceScattering->modelsInfo[sceneModelIndex].position,
-        subsurfaceScattering->modelsInfo[sceneModelIndex].rotation,
-        subsurfaceScattering->modelsInfo[sceneModelIndex].scale);
-
-    // NOTE: We arent using the indices for now as the models loaded from obj files
-    // are garunteed to have a single index for a single vertex and no re-use,
-    // however for a proper renderer we need to use the indices.
+    AVD_SceneSubsurfaceScatteringModelInfo *modelInfo = &subsurfaceScattering->modelsInfo[sceneModelIndex];
+    AVD_Matrix4x4 modelMatrix                         = avdMatCalculateTransform(
+        modelInfo->position,
+        modelInfo->rotation,
+        modelInfo->scale);
+
+    // distance to the bounding sphere, the models are scaled uniformly
+    modelInfo->lodLevel = 0;
+    if (subsurfaceScattering->useLods) {
+        AVD_Float scale           = modelInfo->scale.x;
+        AVD_Vector3 center        = avdVec3Add(modelInfo->position, avdVec3Scale(mesh->boundingSphere.center, scale));
+        AVD_Float distance        = avdVec3Length(avdVec3Subtract(subsurfaceScattering->cameraPosition, center)) - mesh->boundingSphere.radius * scale;
+        AVD_Float projectionScale = avdMeshLodProjectionScale(avdDeg2Rad(AVD_SSS_CAMERA_FOV_DEGREES), (AVD_Float)subsurfaceScattering->sceneHeight);
+        modelInfo->lodLevel       = avdMeshSelectLod(mesh, distance, scale, projectionScale, subsurfaceScattering->lodMaxPixelError);
+    }
+    AVD_MeshLod lod = avdMeshGetLod(mesh, modelInfo->lodLevel);
+    subsurfaceScattering->drawnTriangles += (uint32_t)lod.triangleCount;
 
+    // The models share welded vertices, the vertex shader reads them through
+    // the index buffer and vertexOffset is the first index of the level.
     AVD_SubSurfaceScatteringUberPushConstants pushConstants = {0};
     pushConstants.projectionMatrix                          = subsurfaceScattering->projectionMatrix;
     pushConstants.viewModelMatrix                           = avdMat4x4Multiply(subsurfaceScattering->viewMatrix, modelMatrix);
     pushConstants.lightA                                    = subsurfaceScattering->modelsInfo[sceneModelIndex].lightPositionA;
     pushConstants.lightB                                    = subsurfaceScattering->modelsInfo[sceneModelIndex].lightPositionB;
     pushConstants.cameraPosition                            = avdVec4FromVec3(subsurfaceScattering->cameraPosition, 1.0f);
-    pushConstants.vertexOffset                              = mesh->indexOffset;
-    pushConstants.vertexCount                               = mesh->triangleCount * 3;
+    pushConstants.vertexOffset                              = lod.indexOffset;
+    pushConstants.vertexCount                               = lod.triangleCount * 3;
     pushConstants.screenSize.x                              = (AVD_Float)subsurfaceScattering->sceneWidth;
     pushConstants.screenSize.y                              = (AVD_Float)subsurfaceScattering->sceneHeight;
     pushConstants.hasPBRTextures                            = subsurfaceScattering->modelsInfo[sceneModelIndex].hasPBRTextures;
@@ -993,7 +1043,7 @@ static bool PRIV_avdSceneRenderFirstMesh(
     pushConstants.thicknessTextureIndex                     = subsurfaceScattering->modelsInfo[sceneModelIndex].thicknessTextureIndex;
     pushConstants.renderingLight                            = 0;
     vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(pushConstants), &pushConstants);
-    vkCmdDraw(commandBuffer, mesh->triangleCount * 3, 1, 0, 0);
+    vkCmdDraw(commandBuffer, lod.triangleCount * 3, 1, 0, 0);
 
     if (renderLightSpheres) {
         pushConstants.viewModelMatrix = avdMat4x4Identity(); // no model matrix needed here
@@ -1013,6 +1063,7 @@ static bool PRIV_avdSceneRenderModels(
     VkPipelineLayout pipelineLayout,
     bool renderLightSpheres)
 {
+    subsurfaceScattering->drawnTriangles = 0;
     for (uint32_t i = 0; i < AVD_ARRAY_COUNT(subsurfaceScattering->modelsInfo); i++) {
         AVD_CHECK(PRIV_avdSceneRenderFirstMesh(commandBuffer, subsurfaceScattering, pipelineLayout, i, renderLightSpheres));
     }
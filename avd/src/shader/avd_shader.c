@@ -11,11 +11,11 @@ static AVD_ShaderManager *__AVD_SHADER_MANAGER_CACHE = NULL;
 
 bool avdShaderManagerInit(AVD_ShaderManager *shaderManager)
 {
-    shaderManager->shaderCContext = (AVD_ShaderShaderCContext *)malloc(sizeof(AVD_ShaderShaderCContext));
+    shaderManager->shaderCContext = (AVD_ShaderShaderCContext *)AVD_MALLOC(sizeof(AVD_ShaderShaderCContext));
     AVD_CHECK_MSG(shaderManager->shaderCContext != NULL, "Failed to allocate shaderCContext");
     AVD_CHECK(avdShaderShaderCContextInit(shaderManager->shaderCContext));
 
-    shaderManager->slangContext = (AVD_ShaderSlangContext *)malloc(sizeof(AVD_ShaderSlangContext));
+    shaderManager->slangContext = (AVD_ShaderSlangContext *)AVD_MALLOC(sizeof(AVD_ShaderSlangContext));
     AVD_CHECK_MSG(shaderManager->slangContext != NULL, "Failed to allocate slangContext");
     AVD_CHECK(avdShaderSlangContextInit(shaderManager->slangContext));
 
@@ -28,12 +28,12 @@ void avdShaderManagerDestroy(AVD_ShaderManager *shaderManager)
 {
     if (shaderManager->shaderCContext != NULL) {
         avdShaderShaderCContextDestroy(shaderManager->shaderCContext);
-        free(shaderManager->shaderCContext);
+        AVD_FREE(shaderManager->shaderCContext);
     }
 
     if (shaderManager->slangContext != NULL) {
         avdShaderSlangContextDestroy(shaderManager->slangContext);
-        free(shaderManager->slangContext);
+        AVD_FREE(shaderManager->slangContext);
     }
 
     __AVD_SHADER_MANAGER_CACHE = NULL;
@@ -61,8 +61,9 @@ bool avdShaderModuleCreateWithoutCache(
     createInfo.codeSize                 = compilationResult.size * sizeof(uint32_t);
     createInfo.pCode                    = compilationResult.compiledCode;
 
-    AVD_CHECK_VK_RESULT(vkCreateShaderModule(device, &createInfo, NULL, outModule),
-                        "Failed to create shader module from asset: %s", shaderName);
+    VkResult result = vkCreateShaderModule(device, &createInfo, NULL, outModule);
+    avdShaderCompilationResultDestroy(&compilationResult);
+    AVD_CHECK_VK_RESULT(result, "Failed to create shader module from asset: %s", shaderName);
     AVD_DEBUG_VK_SET_OBJECT_NAME(VK_OBJECT_TYPE_SHADER_MODULE, *outModule, "ShaderModule/%s", shaderName);
     return true;
 }
@@ -89,8 +90,9 @@ bool avdShaderModuleCreate(
     createInfo.codeSize                 = compilationResult.size * sizeof(uint32_t);
     createInfo.pCode                    = compilationResult.compiledCode;
 
-    AVD_CHECK_VK_RESULT(vkCreateShaderModule(device, &createInfo, NULL, outModule),
-                        "Failed to create shader module from asset: %s", shaderName);
+    VkResult result = vkCreateShaderModule(device, &createInfo, NULL, outModule);
+    avdShaderCompilationResultDestroy(&compilationResult);
+    AVD_CHECK_VK_RESULT(result, "Failed to create shader module from asset: %s", shaderName);
     AVD_DEBUG_VK_SET_OBJECT_NAME(VK_OBJECT_TYPE_SHADER_MODULE, *outModule, "ShaderModule/%s", shaderName);
     return true;
 }
@@ -130,22 +132,20 @@ bool PRIV_avdShaderLoadCached(
     AVD_ASSERT(outResult != NULL);
 
     AVD_LOG_INFO("Using cached shader: %s", cachedShaderPath);
-    FILE *file = fopen(cachedShaderPath, "rb");
-    AVD_CHECK_MSG(file != NULL, "Failed to open cached shader file: %s", cachedShaderPath);
 
-    fseek(file, 0, SEEK_END);
-    size_t size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-
-    uint32_t *compiledCode = (uint32_t *)malloc(size);
-    AVD_CHECK_MSG(compiledCode != NULL, "Failed to allocate memory for compiled shader");
-
-    fread(compiledCode, 1, size, file);
-    fclose(file);
+    // the SPIR-V is handed to Vulkan straight from the mapping, which is page
+    // aligned (and the read fallback is malloc aligned) so the words line up
+    AVD_FileView *fileView = NULL;
+    AVD_CHECK_MSG(avdFileViewOpen(cachedShaderPath, AVD_FILE_VIEW_FLAG_WILL_NEED, &fileView), "Failed to open cached shader file: %s", cachedShaderPath);
+    if (fileView->size == 0 || fileView->size % sizeof(uint32_t) != 0) {
+        avdFileViewRelease(fileView);
+        AVD_CHECK_MSG(false, "Cached shader file is corrupted: %s", cachedShaderPath);
+    }
 
     *outResult = (AVD_ShaderCompilationResult){
-        .compiledCode = compiledCode,
-        .size         = size / sizeof(uint32_t),
+        .compiledCode = (uint32_t *)fileView->data,
+        .size         = fileView->size / sizeof(uint32_t),
+        .fileView     = fileView,
         .stage        = avdAssetShaderStage(inputShaderName),
         .language     = avdAssetShaderLanguage(inputShaderName)};
 
@@ -185,20 +185,20 @@ bool avdShaderManagerCompileAndCache(
     AVD_ASSERT(inputShaderName != NULL);
     AVD_ASSERT(outResult != NULL);
 
-    uint32_t shaderDependencyHash = avdAssetShaderGetDependencyHash(inputShaderName);
-    uint32_t optionsHash          = avdShaderCompilationOptionsHash(options);
-    uint32_t cacheKey             = shaderDependencyHash ^ optionsHash;
+    uint64_t shaderDependencyHash = avdAssetShaderGetDependencyHash(inputShaderName);
+    uint64_t optionsHash          = avdShaderCompilationOptionsHash(options);
+    uint64_t cacheKey             = avdHash64Combine(shaderDependencyHash, optionsHash);
 
     static char cachedShaderPath[1024 * 4] = {0};
     snprintf(
         cachedShaderPath,
         sizeof(cachedShaderPath),
-        "%savd_%s.%s.%s.%u.avdshader",
+        "%savd_%s.%s.%s.%016llx.avdshader",
         avdGetTempDirPath(),
         inputShaderName,
         avdShaderStageToString(avdAssetShaderStage(inputShaderName)),
         avdShaderLanguageToString(avdAssetShaderLanguage(inputShaderName)),
-        cacheKey);
+        (unsigned long long)cacheKey);
 
     if (avdPathExists(cachedShaderPath)) {
         AVD_CHECK(PRIV_avdShaderLoadCached(
@@ -18,22 +18,26 @@ bool avdShaderCompilationOptionsDefault(AVD_ShaderCompilationOptions *options)
     return true;
 }
 
-uint32_t avdShaderCompilationOptionsHash(const AVD_ShaderCompilationOptions *options)
+uint64_t avdShaderCompilationOptionsHash(const AVD_ShaderCompilationOptions *options)
 {
     AVD_ASSERT(options != NULL);
 
-    uint32_t hash = 5381; // Starting with a prime number
+    AVD_HashState state;
+    avdHashStateInit(&state, AVD_HASH_DEFAULT_SEED);
     for (size_t i = 0; i < options->macroCount; ++i) {
+        // include the terminator so that {"AB", "C"} and {"A", "BC"} hash differently
         const char *macro = options->macros[i];
-        while (*macro) {
-            hash = ((hash << 5) + hash) + *macro++; // hash * 33 + c
-        }
+        avdHashStateUpdate(&state, macro, strlen(macro) + 1);
     }
-    hash ^= options->warningsAsErrors ? 0x1 : 0x0;
-    hash ^= options->debugSymbols ? 0x2 : 0x0;
-    hash ^= options->optimize;
 
-    return hash;
+    uint8_t flags[3] = {
+        options->warningsAsErrors ? 1 : 0,
+        options->debugSymbols ? 1 : 0,
+        options->optimize,
+    };
+    avdHashStateUpdate(&state, flags, sizeof(flags));
+
+    return avdHashStateDigest(&state);
 }
 
 const char *avdShaderStageToString(AVD_ShaderStage stage)
@@ -66,7 +70,11 @@ const char *avdShaderLanguageToString(AVD_ShaderLanguage language)
 
 void avdShaderCompilationResultDestroy(AVD_ShaderCompilationResult *result)
 {
-    if (result) {
-        free(result->compiledCode);
+    if (result && result->fileView) {
+        avdFileViewRelease(result->fileView);
+        result->fileView     = NULL;
+        result->compiledCode = NULL;
+    } else if (result && result->compiledCode) {
+        AVD_FREE(result->compiledCode);
     }
 }
\ No newline at end of file
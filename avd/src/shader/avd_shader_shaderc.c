@@ -5,7 +5,7 @@ static shaderc_include_result *PRIV_avdIncludeResolver(void *userData, const cha
 {
     AVD_ASSERT(requestedSource != NULL);
 
-    shaderc_include_result *result = (shaderc_include_result *)malloc(sizeof(*result));
+    shaderc_include_result *result = (shaderc_include_result *)AVD_MALLOC(sizeof(*result));
     if (!result) {
         AVD_LOG_ERROR("Failed to allocate memory for include result");
         return NULL;
@@ -24,7 +24,7 @@ static void PRIV_avdIncludeResultReleaser(void *userData, shaderc_include_result
 {
     (void)userData;
     if (includeResult) {
-        free(includeResult);
+        AVD_FREE(includeResult);
     }
 }
 
@@ -153,7 +153,7 @@ bool avdShaderShaderCCompile(
         return false;
     }
 
-    uint32_t *compiledCode = (uint32_t *)malloc(size);
+    uint32_t *compiledCode = (uint32_t *)AVD_MALLOC(size);
     if (!compiledCode) {
         AVD_LOG_ERROR("Failed to allocate memory for compiled shader");
         shaderc_result_release(result);
@@ -7,7 +7,6 @@
 static AVD_Vulkan *PRIV_avdGlobalVulkanInstance = NULL;
 
 static const char *PRIV_avd_RequiredVulkanExtensions[] = {
-    VK_KHR_SWAPCHAIN_EXTENSION_NAME,
     VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME,
     VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME,
     VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME,
@@ -15,6 +14,11 @@ static const char *PRIV_avd_RequiredVulkanExtensions[] = {
     VK_KHR_SPIRV_1_4_EXTENSION_NAME,
     VK_KHR_IMAGE_FORMAT_LIST_EXTENSION_NAME,
     VK_KHR_IMAGELESS_FRAMEBUFFER_EXTENSION_NAME,
+};
+
+// required unless the device is created headless
+static const char *PRIV_avd_VulkanSwapchainExtensions[] = {
+    VK_KHR_SWAPCHAIN_EXTENSION_NAME,
     // TODO: We can just use VK_KHR_SURFACE_MAINTENANCE_1_EXTENSION_NAME and
     // VK_KHR_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME instead but we are using the
     // EXT versions for better compatibility with older drivers. In the future
@@ -91,6 +95,9 @@ static const char **PRIV_avdGetVulkanDeviceExtensions(AVD_Vulkan *vulkan, uint32
 
     uint32_t count = 0;
     PRIV_avdVulkanAddDeviceExtensionsToList(deviceExtensions, &count, PRIV_avd_RequiredVulkanExtensions, AVD_ARRAY_COUNT(PRIV_avd_RequiredVulkanExtensions));
+    if (!vulkan->headless) {
+        PRIV_avdVulkanAddDeviceExtensionsToList(deviceExtensions, &count, PRIV_avd_VulkanSwapchainExtensions, AVD_ARRAY_COUNT(PRIV_avd_VulkanSwapchainExtensions));
+    }
     if (vulkan->supportedFeatures.rayTracing) {
         PRIV_avdVulkanAddDeviceExtensionsToList(deviceExtensions, &count, PRIV_avd_VulkanRayTraceExtensions, AVD_ARRAY_COUNT(PRIV_avd_VulkanRayTraceExtensions));
     }
@@ -138,8 +145,10 @@ static bool PRIV_avdVulkanCreateInstance(AVD_Vulkan *vulkan)
     uint32_t extensionCount           = 0;
     static const char *extensions[64] = {0};
 
-    AVD_CHECK(PRIV_avdAddGlfwExtenstions(&extensionCount, extensions));
-    AVD_CHECK(PRIV_avdAddSurfaceExtensions(&extensionCount, extensions));
+    if (!vulkan->headless) {
+        AVD_CHECK(PRIV_avdAddGlfwExtenstions(&extensionCount, extensions));
+        AVD_CHECK(PRIV_avdAddSurfaceExtensions(&extensionCount, extensions));
+    }
 
     AVD_DEBUG_ONLY(avdVulkanAddDebugUtilsExtensions(&extensionCount, extensions));
 
@@ -199,7 +208,7 @@ static bool PRIV_avdVulkanPhysicalDeviceCheckExtensionsSet(VkExtensionProperties
     return true;
 }
 
-static bool PRIV_avdVulkanPhysicalDeviceCheckExtensions(VkPhysicalDevice device, AVD_VulkanFeatures *outFeatures)
+static bool PRIV_avdVulkanPhysicalDeviceCheckExtensions(VkPhysicalDevice device, bool headless, AVD_VulkanFeatures *outFeatures)
 {
     uint32_t extensionCount                      = 0;
     static VkExtensionProperties extensions[256] = {0};
@@ -213,6 +222,9 @@ static bool PRIV_avdVulkanPhysicalDeviceCheckExtensions(VkPhysicalDevice device,
     if (!PRIV_avdVulkanPhysicalDeviceCheckExtensionsSet(extensions, extensionCount, PRIV_avd_RequiredVulkanExtensions, AVD_ARRAY_COUNT(PRIV_avd_RequiredVulkanExtensions))) {
         return false;
     }
+    if (!headless && !PRIV_avdVulkanPhysicalDeviceCheckExtensionsSet(extensions, extensionCount, PRIV_avd_VulkanSwapchainExtensions, AVD_ARRAY_COUNT(PRIV_avd_VulkanSwapchainExtensions))) {
+        return false;
+    }
 
     outFeatures->rayTracing      = PRIV_avdVulkanPhysicalDeviceCheckExtensionsSet(extensions, extensionCount, PRIV_avd_VulkanRayTraceExtensions, AVD_ARRAY_COUNT(PRIV_avd_VulkanRayTraceExtensions));
     outFeatures->videoCore       = PRIV_avdVulkanPhysicalDeviceCheckExtensionsSet(extensions, extensionCount, PRIV_avd_VulkanVideoExtensions, AVD_ARRAY_COUNT(PRIV_avd_VulkanVideoExtensions));
@@ -237,6 +249,25 @@ static bool PRIV_avdVulkanPhysicalDeviceCheckFeatures(VkPhysicalDevice device, A
         return false;
     }
 
+    // the GPU driven draws pick their instance through firstInstance
+    if (!features.multiDrawIndirect || !features.drawIndirectFirstInstance) {
+        AVD_LOG_WARN("Multi draw indirect with a first instance not supported");
+        return false;
+    }
+
+    VkPhysicalDeviceVulkan12Features features12 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+    };
+    VkPhysicalDeviceFeatures2 features2 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext = &features12,
+    };
+    vkGetPhysicalDeviceFeatures2(device, &features2);
+    if (!features12.drawIndirectCount) {
+        AVD_LOG_WARN("Draw indirect count not supported");
+        return false;
+    }
+
     // TODO: Add all the feature checks here! (NOW ITS INCOMPLETE)
 
     return true;
@@ -256,11 +287,12 @@ static bool PRIV_avdVulkanPickPhysicalDevice(AVD_Vulkan *vulkan)
 
     AVD_VulkanFeatures supportedFeatures = {0};
     bool foundDiscreteGPU                = false;
+    bool foundFallbackDevice             = false;
     for (uint32_t i = 0; i < deviceCount; ++i) {
         VkPhysicalDeviceProperties deviceProperties;
         vkGetPhysicalDeviceProperties(devices[i], &deviceProperties);
 
-        if (!PRIV_avdVulkanPhysicalDeviceCheckExtensions(devices[i], PRIV_avdVulkanFeaturesInit(&supportedFeatures))) {
+        if (!PRIV_avdVulkanPhysicalDeviceCheckExtensions(devices[i], vulkan->headless, PRIV_avdVulkanFeaturesInit(&supportedFeatures))) {
             AVD_LOG_WARN("Physical device %s does not support required extensions\n", deviceProperties.deviceName);
             continue;
         }
@@ -276,9 +308,16 @@ static bool PRIV_avdVulkanPickPhysicalDevice(AVD_Vulkan *vulkan)
             foundDiscreteGPU          = true;
             break;
         }
+
+        // headless runs take whatever there is, e.g. lavapipe on CI machines
+        if (vulkan->headless && !foundFallbackDevice) {
+            vulkan->physicalDevice    = devices[i];
+            vulkan->supportedFeatures = supportedFeatures;
+            foundFallbackDevice       = true;
+        }
     }
 
-    AVD_CHECK_MSG(foundDiscreteGPU, "No suitable physical device found\n");
+    AVD_CHECK_MSG(foundDiscreteGPU || foundFallbackDevice, "No suitable physical device found\n");
 
     VkPhysicalDeviceProperties deviceProperties = {0};
     vkGetPhysicalDeviceProperties(vulkan->physicalDevice, &deviceProperties);
@@ -332,6 +371,10 @@ static bool PRIV_avdVulkanCreateDevice(AVD_Vulkan *vulkan, VkSurfaceKHR *surface
     AVD_CHECK_MSG(graphicsQueueFamilyIndex >= 0, "Failed to find graphics queue family index\n");
 
     int32_t computeQueueFamilyIndex = PRIV_avdVulkanFindQueueFamilyIndex(vulkan->physicalDevice, VK_QUEUE_COMPUTE_BIT, VK_NULL_HANDLE, graphicsQueueFamilyIndex);
+    if (computeQueueFamilyIndex < 0 && vulkan->headless) {
+        // software devices only have the one family, compute shares the graphics queue
+        computeQueueFamilyIndex = graphicsQueueFamilyIndex;
+    }
     AVD_CHECK_MSG(computeQueueFamilyIndex >= 0, "Failed to find compute queue family index\n");
 
     int32_t videoDecodeQueueFamilyIndex = PRIV_avdVulkanFindQueueFamilyIndex(vulkan->physicalDevice, VK_QUEUE_VIDEO_DECODE_BIT_KHR | VK_QUEUE_TRANSFER_BIT, VK_NULL_HANDLE, -1);
@@ -359,13 +402,15 @@ static bool PRIV_avdVulkanCreateDevice(AVD_Vulkan *vulkan, VkSurfaceKHR *surface
     queueCreateInfoCount++;
 
     // then the compute queue
-    queueCreateInfos[queueCreateInfoCount] = (VkDeviceQueueCreateInfo){
-        .sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-        .queueFamilyIndex = computeQueueFamilyIndex,
-        .queueCount       = 1,
-        .pQueuePriorities = &queuePriority,
-    };
-    queueCreateInfoCount++;
+    if (computeQueueFamilyIndex != graphicsQueueFamilyIndex) {
+        queueCreateInfos[queueCreateInfoCount] = (VkDeviceQueueCreateInfo){
+            .sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            .queueFamilyIndex = computeQueueFamilyIndex,
+            .queueCount       = 1,
+            .pQueuePriorities = &queuePriority,
+        };
+        queueCreateInfoCount++;
+    }
 
     if (vulkan->supportedFeatures.videoDecode) {
         // finally the video decode queue
@@ -426,7 +471,7 @@ static bool PRIV_avdVulkanCreateDevice(AVD_Vulkan *vulkan, VkSurfaceKHR *surface
         .descriptorBindingUniformBufferUpdateAfterBind = VK_TRUE,
         .descriptorBindingUpdateUnusedWhilePending     = VK_TRUE,
         .descriptorBindingVariableDescriptorCount      = VK_TRUE,
-        .pNext                                         = &accelerationStructureFeatures,
+        .pNext                                         = vulkan->supportedFeatures.rayTracing ? &accelerationStructureFeatures : NULL,
     };
 
     VkPhysicalDeviceVulkan11Features deviceVulkan11Features = {
@@ -446,13 +491,14 @@ static bool PRIV_avdVulkanCreateDevice(AVD_Vulkan *vulkan, VkSurfaceKHR *surface
     VkPhysicalDeviceFeatures2 deviceFeatures2 = {
         .sType    = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
         .features = (VkPhysicalDeviceFeatures){
-            .multiDrawIndirect       = VK_TRUE,
-            .pipelineStatisticsQuery = VK_TRUE,
-            .samplerAnisotropy       = VK_TRUE,
-            .shaderInt64             = VK_TRUE,
-            .shaderInt16             = VK_TRUE,
+            .multiDrawIndirect         = VK_TRUE,
+            .drawIndirectFirstInstance = VK_TRUE,
+            .pipelineStatisticsQuery   = VK_TRUE,
+            .samplerAnisotropy         = VK_TRUE,
+            .shaderInt64               = VK_TRUE,
+            .shaderInt16               = VK_TRUE,
         },
-        .pNext = &swapchainMaintenance1Features,
+        .pNext = vulkan->headless ? (void *)&deviceVulkan11Features : (void *)&swapchainMaintenance1Features,
     };
 
     uint32_t deviceExtensionCount = 0;
@@ -775,6 +821,27 @@ bool avdVulkanInit(AVD_Vulkan *vulkan, AVD_Window *window, VkSurfaceKHR *surface
     return true;
 }
 
+bool avdVulkanInitHeadless(AVD_Vulkan *vulkan)
+{
+    AVD_CHECK_MSG(PRIV_avdGlobalVulkanInstance == NULL, "Vulkan instance already initialized");
+    PRIV_avdGlobalVulkanInstance = vulkan;
+    vulkan->headless             = true;
+
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
+    AVD_CHECK_VK_RESULT(volkInitialize(), "Failed to initialize Vulkan");
+    AVD_CHECK(PRIV_avdVulkanCreateInstance(vulkan));
+    AVD_DEBUG_ONLY(AVD_CHECK(avdVulkanDebuggerCreate(vulkan)));
+    AVD_CHECK(PRIV_avdVulkanPickPhysicalDevice(vulkan));
+    AVD_CHECK(PRIV_avdVulkanCreateDevice(vulkan, &surface));
+    AVD_CHECK(PRIV_avdVulkanQueryDeviceProperties(vulkan));
+    AVD_CHECK(PRIV_avdVulkanGetQueues(vulkan));
+    AVD_CHECK(PRIV_avdVulkanCreateCommandPools(vulkan));
+    AVD_CHECK(PRIV_avdVulkanDescriptorPoolCreate(vulkan));
+    AVD_CHECK(PRIV_avdVulkanCreateDescriptorSets(vulkan));
+
+    return true;
+}
+
 void avdVulkanWaitIdle(AVD_Vulkan *vulkan)
 {
     AVD_DEBUG_VK_QUEUE_BEGIN_LABEL(vulkan->graphicsQueue, NULL, "[Queue][Core]:Vulkan/Queue/Graphics/WaitIdle");
@@ -800,6 +867,59 @@ void avdVulkanWaitIdle(AVD_Vulkan *vulkan)
     }
 }
 
+bool avdVulkanBeginOneTimeCommands(AVD_Vulkan *vulkan, VkCommandBuffer *commandBuffer, const char *label)
+{
+    AVD_ASSERT(vulkan != NULL);
+    AVD_ASSERT(commandBuffer != NULL);
+
+    VkCommandBufferAllocateInfo allocInfo = {
+        .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandPool        = vulkan->graphicsCommandPool,
+        .commandBufferCount = 1,
+    };
+    AVD_CHECK_VK_RESULT(vkAllocateCommandBuffers(vulkan->device, &allocInfo, commandBuffer), "Failed to allocate one time command buffer");
+    AVD_DEBUG_VK_SET_OBJECT_NAME(VK_OBJECT_TYPE_COMMAND_BUFFER, *commandBuffer, "[CommandBuffer][Core]:Vulkan/OneTime/%s", label);
+
+    VkCommandBufferBeginInfo beginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+    AVD_CHECK_VK_RESULT(vkBeginCommandBuffer(*commandBuffer, &beginInfo), "Failed to begin one time command buffer");
+    return true;
+}
+
+bool avdVulkanSubmitOneTimeCommands(AVD_Vulkan *vulkan, VkCommandBuffer commandBuffer)
+{
+    AVD_ASSERT(vulkan != NULL);
+
+    AVD_CHECK_VK_RESULT(vkEndCommandBuffer(commandBuffer), "Failed to end one time command buffer");
+
+    VkFenceCreateInfo fenceInfo = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    };
+    VkFence fence;
+    AVD_CHECK_VK_RESULT(vkCreateFence(vulkan->device, &fenceInfo, NULL, &fence), "Failed to create one time fence");
+    AVD_DEBUG_VK_SET_OBJECT_NAME(VK_OBJECT_TYPE_FENCE, fence, "[Fence][Core]:Vulkan/OneTime");
+
+    VkSubmitInfo submitInfo = {
+        .sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1,
+        .pCommandBuffers    = &commandBuffer,
+    };
+    AVD_DEBUG_VK_QUEUE_BEGIN_LABEL(vulkan->graphicsQueue, NULL, "[Queue][Core]:Vulkan/Queue/OneTimeSubmit");
+    VkResult result = vkQueueSubmit(vulkan->graphicsQueue, 1, &submitInfo, fence);
+    AVD_DEBUG_VK_QUEUE_END_LABEL(vulkan->graphicsQueue);
+    if (result == VK_SUCCESS) {
+        result = vkWaitForFences(vulkan->device, 1, &fence, VK_TRUE, UINT64_MAX);
+    }
+
+    vkDestroyFence(vulkan->device, fence, NULL);
+    vkFreeCommandBuffers(vulkan->device, vulkan->graphicsCommandPool, 1, &commandBuffer);
+    AVD_CHECK_VK_RESULT(result, "Failed to submit one time command buffer");
+    return true;
+}
+
 void avdVulkanDestroySurface(AVD_Vulkan *vulkan, VkSurfaceKHR surface)
 {
     vkDestroySurfaceKHR(vulkan->instance, surface, NULL);
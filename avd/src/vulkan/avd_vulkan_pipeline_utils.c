@@ -374,6 +374,106 @@ bool avdPipelineUtilsCreateGraphicsLayoutAndPipeline(
     return true;
 }
 
+bool avdPipelineUtilsCreateComputePipelineLayout(
+    VkPipelineLayout *pipelineLayout,
+    VkDevice device,
+    VkDescriptorSetLayout *descriptorSetLayouts,
+    size_t descriptorSetLayoutCount,
+    uint32_t pushConstantSize)
+{
+    AVD_ASSERT(pipelineLayout != NULL);
+    AVD_ASSERT(device != VK_NULL_HANDLE);
+
+    VkPushConstantRange pushConstantRanges[1] = {
+        [0] = {.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+               .offset     = 0,
+               .size       = pushConstantSize},
+    };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {
+        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount         = (uint32_t)descriptorSetLayoutCount,
+        .pSetLayouts            = descriptorSetLayouts,
+        .pPushConstantRanges    = pushConstantRanges,
+        .pushConstantRangeCount = pushConstantSize > 0 ? AVD_ARRAY_COUNT(pushConstantRanges) : 0,
+    };
+
+    VkResult result = vkCreatePipelineLayout(device, &pipelineLayoutInfo, NULL, pipelineLayout);
+    AVD_CHECK_VK_RESULT(result, "Failed to create compute pipeline layout");
+    AVD_DEBUG_VK_SET_OBJECT_NAME(
+        VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+        *pipelineLayout,
+        "[PipelineLayout][Core]:Vulkan/Pipeline/ComputeLayout");
+
+    return true;
+}
+
+bool avdPipelineUtilsCreateComputePipeline(
+    VkPipeline *pipeline,
+    VkPipelineLayout layout,
+    VkDevice device,
+    const char *compShaderAsset,
+    AVD_ShaderCompilationOptions *compilationOptions)
+{
+    AVD_ASSERT(pipeline != NULL);
+    AVD_ASSERT(layout != VK_NULL_HANDLE);
+    AVD_ASSERT(device != VK_NULL_HANDLE);
+    AVD_ASSERT(compShaderAsset != NULL);
+
+    VkShaderModule computeShaderModule;
+    AVD_CHECK(avdShaderModuleCreate(device, compShaderAsset, compilationOptions, &computeShaderModule));
+
+    VkComputePipelineCreateInfo pipelineInfo = {
+        .sType              = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .layout             = layout,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex  = -1,
+    };
+    AVD_CHECK(avdPipelineUtilsShaderStage(&pipelineInfo.stage, computeShaderModule, VK_SHADER_STAGE_COMPUTE_BIT));
+
+    VkResult result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, NULL, pipeline);
+    vkDestroyShaderModule(device, computeShaderModule, NULL);
+    AVD_CHECK_VK_RESULT(result, "Failed to create compute pipeline for %s", compShaderAsset);
+    AVD_DEBUG_VK_SET_OBJECT_NAME(
+        VK_OBJECT_TYPE_PIPELINE,
+        *pipeline,
+        "[Pipeline][Core]:Vulkan/Pipeline/Compute/%s",
+        compShaderAsset);
+
+    return true;
+}
+
+bool avdPipelineUtilsCreateComputeLayoutAndPipeline(
+    VkPipelineLayout *pipelineLayout,
+    VkPipeline *pipeline,
+    VkDevice device,
+    VkDescriptorSetLayout *descriptorSetLayouts,
+    size_t descriptorSetLayoutCount,
+    uint32_t pushConstantSize,
+    const char *compShaderAsset,
+    AVD_ShaderCompilationOptions *compilationOptions)
+{
+    AVD_ASSERT(pipelineLayout != NULL);
+    AVD_ASSERT(pipeline != NULL);
+    AVD_ASSERT(device != VK_NULL_HANDLE);
+    AVD_ASSERT(compShaderAsset != NULL);
+
+    AVD_CHECK(avdPipelineUtilsCreateComputePipelineLayout(
+        pipelineLayout,
+        device,
+        descriptorSetLayouts,
+        descriptorSetLayoutCount,
+        pushConstantSize));
+    AVD_CHECK(avdPipelineUtilsCreateComputePipeline(
+        pipeline,
+        *pipelineLayout,
+        device,
+        compShaderAsset,
+        compilationOptions));
+
+    return true;
+}
+
 bool avdWriteImageDescriptorSet(VkWriteDescriptorSet *writeDescriptorSet, VkDescriptorSet descriptorSet, uint32_t binding, VkDescriptorImageInfo *imageInfo)
 {
     AVD_ASSERT(writeDescriptorSet != NULL);
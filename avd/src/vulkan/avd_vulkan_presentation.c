@@ -15,6 +15,35 @@ typedef struct AVD_VulkanPresentationPushConstants {
     float pad1;
 } AVD_VulkanPresentationPushConstants;
 
+#ifdef AVD_PROFILER
+static bool PRIV_avdVulkanPresentationRenderProfilerOverlay(AVD_VulkanPresentation *presentation, AVD_Vulkan *vulkan, AVD_VulkanSwapchain *swapchain, VkCommandBuffer commandBuffer)
+{
+    bool updated = true;
+    // rebuilding the text every frame would show up in the very numbers it displays
+    AVD_EXECUTE_DEBOUNCED(250, {
+        char summary[2048];
+        avdProfilerFormatLastFrame(summary, sizeof(summary), AVD_VULKAN_PRESENTATION_PROFILER_ZONES);
+        updated = avdRenderableTextUpdate(&presentation->profilerText, &presentation->presentationFontRenderer, vulkan, summary);
+    });
+    AVD_CHECK(updated);
+
+    float textWidth, textHeight;
+    avdRenderableTextGetSize(&presentation->profilerText, &textWidth, &textHeight);
+
+    avdRenderText(
+        vulkan,
+        &presentation->presentationFontRenderer,
+        &presentation->profilerText,
+        commandBuffer,
+        10.0f,
+        10.0f + textHeight,
+        1.0f,
+        1.0f, 1.0f, 0.4f, 1.0f,
+        swapchain->extent.width, swapchain->extent.height);
+    return true;
+}
+#endif
+
 bool avdVulkanPresentationInit(AVD_VulkanPresentation *presentation, AVD_Vulkan *vulkan, AVD_VulkanSwapchain *swapchain, AVD_FontManager *fontManager)
 {
     AVD_ASSERT(presentation != NULL);
@@ -69,6 +98,16 @@ bool avdVulkanPresentationInit(AVD_VulkanPresentation *presentation, AVD_Vulkan
         "OpenSansRegular",
         "No status",
         16.0f));
+#ifdef AVD_PROFILER
+    AVD_CHECK(avdRenderableTextCreate(
+        &presentation->profilerText,
+        &presentation->presentationFontRenderer,
+        vulkan,
+        "RobotoCondensedRegular",
+        "Frame",
+        16.0f));
+    presentation->profilerOverlayVisible = false;
+#endif
     return true;
 }
 
@@ -77,6 +116,9 @@ void avdVulkanPresentationDestroy(AVD_VulkanPresentation *presentation, AVD_Vulk
     AVD_ASSERT(presentation != NULL);
     AVD_ASSERT(vulkan != NULL);
 
+#ifdef AVD_PROFILER
+    avdRenderableTextDestroy(&presentation->profilerText, vulkan);
+#endif
     avdRenderableTextDestroy(&presentation->loadingStatusText, vulkan);
     avdRenderableTextDestroy(&presentation->loadingText, vulkan);
     avdFontRendererDestroy(&presentation->presentationFontRenderer, vulkan);
@@ -174,6 +216,12 @@ bool avdVulkanPresentationRender(AVD_VulkanPresentation *presentation, AVD_Vulka
         }
     }
 
+#ifdef AVD_PROFILER
+    if (presentation->profilerOverlayVisible) {
+        AVD_CHECK(PRIV_avdVulkanPresentationRenderProfilerOverlay(presentation, vulkan, swapchain, commandBuffer));
+    }
+#endif
+
     AVD_CHECK(avdEndRenderPass(commandBuffer));
     AVD_DEBUG_VK_CMD_END_LABEL(commandBuffer);
     return true;
@@ -1,5 +1,6 @@
 #include "vulkan/avd_vulkan_renderer.h"
 #include "core/avd_base.h"
+#include "core/avd_profiler.h"
 
 static bool PRIV_avdVulkanCreateSemaphore(VkDevice device, VkSemaphore *semaphore)
 {
@@ -201,10 +202,15 @@ bool avdVulkanRendererBegin(AVD_VulkanRenderer *renderer, AVD_Vulkan *vulkan, AV
     AVD_ASSERT(swapchain != NULL);
 
     uint32_t currentFrameIndex = renderer->currentFrameIndex;
-    vkWaitForFences(vulkan->device, 1, &renderer->resources[currentFrameIndex].renderFence, VK_TRUE, UINT64_MAX);
-    vkResetFences(vulkan->device, 1, &renderer->resources[currentFrameIndex].renderFence);
+    AVD_PROFILE_SCOPE("Renderer/WaitForFrame") {
+        vkWaitForFences(vulkan->device, 1, &renderer->resources[currentFrameIndex].renderFence, VK_TRUE, UINT64_MAX);
+        vkResetFences(vulkan->device, 1, &renderer->resources[currentFrameIndex].renderFence);
+    }
 
-    VkResult result = avdVulkanSwapchainAcquireNextImage(swapchain, vulkan, &renderer->currentImageIndex, renderer->resources[currentFrameIndex].imageAvailableSemaphore, VK_NULL_HANDLE);
+    VkResult result = VK_SUCCESS;
+    AVD_PROFILE_SCOPE("Renderer/AcquireImage") {
+        result = avdVulkanSwapchainAcquireNextImage(swapchain, vulkan, &renderer->currentImageIndex, renderer->resources[currentFrameIndex].imageAvailableSemaphore, VK_NULL_HANDLE);
+    }
     if (!PRIV_avdVulkanRendererHandleSwapchainResult(renderer, swapchain, result)) {
         AVD_LOG_ERROR("Failed to acquire next image from swapchain");
         return false;
@@ -262,7 +268,9 @@ bool avdVulkanRendererEnd(AVD_VulkanRenderer *renderer, AVD_Vulkan *vulkan, AVD_
     submitInfo.pSignalSemaphores    = &renderer->resources[currentFrameIndex].renderFinishedSemaphore;
 
     AVD_DEBUG_VK_QUEUE_BEGIN_LABEL(vulkan->graphicsQueue, NULL, "[Queue][Core]:Vulkan/Queue/RenderSubmit/Frame/%u", currentFrameIndex);
-    result = vkQueueSubmit(vulkan->graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    AVD_PROFILE_SCOPE("Renderer/Submit") {
+        result = vkQueueSubmit(vulkan->graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    }
     AVD_DEBUG_VK_QUEUE_END_LABEL(vulkan->graphicsQueue);
     if (result != VK_SUCCESS) {
         AVD_LOG_ERROR("Failed to submit command buffer: %s", string_VkResult(result));
@@ -271,7 +279,9 @@ bool avdVulkanRendererEnd(AVD_VulkanRenderer *renderer, AVD_Vulkan *vulkan, AVD_
         return false; // do not render this frame
     }
 
-    result = avdVulkanSwapchainPresent(swapchain, vulkan, renderer->currentImageIndex, renderer->resources[currentFrameIndex].renderFinishedSemaphore, renderer->resources[currentFrameIndex].renderFence);
+    AVD_PROFILE_SCOPE("Renderer/Present") {
+        result = avdVulkanSwapchainPresent(swapchain, vulkan, renderer->currentImageIndex, renderer->resources[currentFrameIndex].renderFinishedSemaphore, renderer->resources[currentFrameIndex].renderFence);
+    }
     if (!PRIV_avdVulkanRendererHandleSwapchainResult(renderer, swapchain, result)) {
         AVD_LOG_ERROR("Failed to present swapchain image");
         return false; // do not render this frame
@@ -1,6 +1,7 @@
 #include "vulkan/video/avd_vulkan_video_decoder.h"
 #include "core/avd_base.h"
 #include "core/avd_list.h"
+#include "core/avd_profiler.h"
 #include "core/avd_types.h"
 #include "math/avd_math_base.h"
 #include "pico/picoH264.h"
@@ -1153,14 +1154,17 @@ bool avdVulkanVideoDecoderNextChunk(AVD_Vulkan *vulkan, AVD_VulkanVideoDecoder *
     bool spsDirty = false;
     bool ppsDirty = false;
 
-    AVD_CHECK(
-        avdH264VideoLoadChunk(
+    bool loaded = false;
+    AVD_PROFILE_SCOPE("VideoDecoder/LoadChunk") {
+        loaded = avdH264VideoLoadChunk(
             video->h264Video,
             chunkLoadParams,
             &video->currentChunk.videoChunk,
             &spsDirty,
             &ppsDirty,
-            eof));
+            eof);
+    }
+    AVD_CHECK(loaded);
 
     AVD_CHECK(PRIV_avdVulkanVideoDecoderPrepareForNewChunk(vulkan, video, &video->currentChunk, spsDirty, ppsDirty));
 
@@ -1228,7 +1232,11 @@ bool avdVulkanVideoDecoderTryDecodeFrames(
         decodedFrame = oldestFrame;
     }
 
-    AVD_CHECK(PRIV_avdVulkanVideoDecoderDecodeCurrentFrame(vulkan, video, decodedFrame));
+    bool decoded = false;
+    AVD_PROFILE_SCOPE("VideoDecoder/DecodeFrame") {
+        decoded = PRIV_avdVulkanVideoDecoderDecodeCurrentFrame(vulkan, video, decodedFrame);
+    }
+    AVD_CHECK(decoded);
 
     return true;
 }
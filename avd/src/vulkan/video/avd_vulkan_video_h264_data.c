@@ -1,7 +1,12 @@
 #include "vulkan/video/avd_vulkan_video_h264_data.h"
+
+#ifndef AVD_HEADLESS
 #include "vulkan/avd_vulkan_base.h"
+#endif
 
+#include "core/avd_arena.h"
 #include "core/avd_base.h"
+#include "core/avd_hash.h"
 #include "core/avd_list.h"
 #include "core/avd_types.h"
 #include "core/avd_utils.h"
@@ -83,19 +88,23 @@ static bool PRIV_avdH264VideoAddSPS(AVD_H264Video *video, picoH264SequenceParame
         target = video->sps[spsId];
     } else {
         // allocate new SPS
-        target            = (picoH264SequenceParameterSet)malloc(sizeof(picoH264SequenceParameterSet_t));
+        target            = (picoH264SequenceParameterSet)AVD_MALLOC(sizeof(picoH264SequenceParameterSet_t));
         video->sps[spsId] = target;
         AVD_CHECK_MSG(target != NULL, "Failed to allocate memory for SPS\n");
     }
 
     memcpy(target, sps, sizeof(picoH264SequenceParameterSet_t));
 
-    AVD_UInt32 spsHash = 1223456789; // seed
+    // the slot index is hashed along with the contents, so moving a SPS to another id changes the hash
+    AVD_HashState hashState;
+    avdHashStateInit(&hashState, AVD_HASH_DEFAULT_SEED);
     for (AVD_Size i = 0; i < PICO_H264_MAX_SPS_COUNT; ++i) {
         if (video->sps[i]) {
-            spsHash ^= avdHashBuffer(video->sps[i], sizeof(picoH264SequenceParameterSet_t));
+            avdHashStateUpdate(&hashState, &i, sizeof(i));
+            avdHashStateUpdate(&hashState, video->sps[i], sizeof(picoH264SequenceParameterSet_t));
         }
     }
+    AVD_UInt64 spsHash = avdHashStateDigest(&hashState);
     bool changed   = video->spsHash != spsHash;
     video->spsHash = spsHash;
     return changed;
@@ -114,19 +123,22 @@ static bool PRIV_avdH264VideoAddPPS(AVD_H264Video *video, picoH264PictureParamet
         target = video->pps[ppsId];
     } else {
         // allocate new PPS
-        target            = (picoH264PictureParameterSet)malloc(sizeof(picoH264PictureParameterSet_t));
+        target            = (picoH264PictureParameterSet)AVD_MALLOC(sizeof(picoH264PictureParameterSet_t));
         video->pps[ppsId] = target;
         AVD_CHECK_MSG(target != NULL, "Failed to allocate memory for PPS\n");
     }
 
     memcpy(target, pps, sizeof(picoH264PictureParameterSet_t));
 
-    AVD_UInt32 ppsHash = 987654321; // seed
+    AVD_HashState hashState;
+    avdHashStateInit(&hashState, AVD_HASH_DEFAULT_SEED);
     for (AVD_Size i = 0; i < PICO_H264_MAX_PPS_COUNT; ++i) {
         if (video->pps[i]) {
-            ppsHash ^= avdHashBuffer(video->pps[i], sizeof(picoH264PictureParameterSet_t));
+            avdHashStateUpdate(&hashState, &i, sizeof(i));
+            avdHashStateUpdate(&hashState, video->pps[i], sizeof(picoH264PictureParameterSet_t));
         }
     }
+    AVD_UInt64 ppsHash = avdHashStateDigest(&hashState);
     bool changed   = video->ppsHash != ppsHash;
     video->ppsHash = ppsHash;
     return changed;
@@ -649,8 +661,13 @@ static bool PRIV_avdH264VideoChunkCalculateDisplayOrder(AVD_H264VideoChunk *chun
         return true;
     }
 
-    __AVD_POCIndexPair *pairs = (__AVD_POCIndexPair *)AVD_MALLOC(sizeof(__AVD_POCIndexPair) * frameCount);
-    AVD_CHECK_MSG(pairs != NULL, "Failed to allocate memory for POC index pairs");
+    AVD_ArenaScratch scratch  = avdArenaScratchBegin(NULL);
+    __AVD_POCIndexPair *pairs = AVD_ARENA_PUSH_ARRAY(scratch.arena, __AVD_POCIndexPair, frameCount);
+    if (pairs == NULL) {
+        avdArenaScratchEnd(scratch);
+        AVD_LOG_ERROR("Failed to allocate memory for POC index pairs");
+        return false;
+    }
 
     for (AVD_Size i = 0; i < frameCount; ++i) {
         AVD_H264VideoFrameInfo *frameInfo = (AVD_H264VideoFrameInfo *)avdListGet(&chunk->frameInfos, i);
@@ -666,7 +683,7 @@ static bool PRIV_avdH264VideoChunkCalculateDisplayOrder(AVD_H264VideoChunk *chun
         frameInfo->chunkDisplayOrder      = (AVD_UInt32)displayOrder;
     }
 
-    AVD_FREE(pairs);
+    avdArenaScratchEnd(scratch);
 
     return true;
 }
@@ -677,7 +694,7 @@ bool avdH264VideoLoadFromStream(picoStream stream, AVD_H264VideoLoadParams *para
     AVD_ASSERT(outVideo != NULL);
     AVD_ASSERT(params != NULL);
 
-    AVD_H264Video *video = (AVD_H264Video *)malloc(sizeof(AVD_H264Video));
+    AVD_H264Video *video = (AVD_H264Video *)AVD_MALLOC(sizeof(AVD_H264Video));
     AVD_CHECK_MSG(video != NULL, "Failed to allocate memory for H.264 video");
     *outVideo = video;
 
@@ -693,10 +710,10 @@ bool avdH264VideoLoadFromStream(picoStream stream, AVD_H264VideoLoadParams *para
 
     picoStreamSeek(stream, (int64_t)params->bufferOffset, PICO_STREAM_SEEK_SET);
 
-    video->nalUnitBuffer = (uint8_t *)malloc(AVD_VULKAN_VIDEO_MAX_NAL_TEMP_BUFFER_SIZE);
+    video->nalUnitBuffer = (uint8_t *)AVD_MALLOC(AVD_VULKAN_VIDEO_MAX_NAL_TEMP_BUFFER_SIZE);
     AVD_CHECK_MSG(video->nalUnitBuffer != NULL, "Failed to allocate memory for NAL unit buffer");
 
-    video->nalUnitPayloadBuffer = (uint8_t *)malloc(AVD_VULKAN_VIDEO_MAX_NAL_TEMP_BUFFER_SIZE);
+    video->nalUnitPayloadBuffer = (uint8_t *)AVD_MALLOC(AVD_VULKAN_VIDEO_MAX_NAL_TEMP_BUFFER_SIZE);
     AVD_CHECK_MSG(video->nalUnitPayloadBuffer != NULL, "Failed to allocate memory for NAL unit payload buffer");
 
     video->bitstream = PRIV_avdH264BitstreamFromPicoStream(stream);
@@ -748,15 +765,25 @@ bool avdH264VideoLoadFromFile(const char *filename, AVD_H264VideoLoadParams *par
 {
     AVD_ASSERT(filename != NULL);
     AVD_ASSERT(outVideo != NULL);
-    picoStream stream = picoStreamFromFileMapped(filename);
-    AVD_CHECK_MSG(stream != NULL, "Failed to create picoStream from file: %s", filename);
-    return avdH264VideoLoadFromStream(stream, params, outVideo);
+
+    // NAL units are parsed front to back, seeking only happens on loops
+    AVD_FileView *fileView = NULL;
+    AVD_CHECK_MSG(avdFileViewOpen(filename, AVD_FILE_VIEW_FLAG_SEQUENTIAL, &fileView), "Failed to open video file: %s", filename);
+
+    picoStream stream = picoStreamFromMemory((void *)fileView->data, fileView->size, true, false, false);
+    if (stream == NULL || !avdH264VideoLoadFromStream(stream, params, outVideo)) {
+        avdFileViewRelease(fileView);
+        AVD_CHECK_MSG(false, "Failed to load video from file: %s", filename);
+    }
+
+    (*outVideo)->fileView = fileView;
+    return true;
 }
 
 void avdH264VideoDestroy(AVD_H264Video *video)
 {
-    free(video->nalUnitBuffer);
-    free(video->nalUnitPayloadBuffer);
+    AVD_FREE(video->nalUnitBuffer);
+    AVD_FREE(video->nalUnitPayloadBuffer);
 
     avdAlignedBufferDestroy(&video->currentChunk.sliceDataBuffer);
     avdListDestroy(&video->currentChunk.frameInfos);
@@ -767,22 +794,23 @@ void avdH264VideoDestroy(AVD_H264Video *video)
     if (video->bitstream) {
         picoH264BitstreamDestroy(video->bitstream);
     }
+    avdFileViewRelease(video->fileView);
 
     for (AVD_Size i = 0; i < PICO_H264_MAX_SPS_COUNT; ++i) {
         if (video->sps[i]) {
-            free(video->sps[i]);
+            AVD_FREE(video->sps[i]);
             video->sps[i] = NULL;
         }
     }
 
     for (AVD_Size i = 0; i < PICO_H264_MAX_PPS_COUNT; ++i) {
         if (video->pps[i]) {
-            free(video->pps[i]);
+            AVD_FREE(video->pps[i]);
             video->pps[i] = NULL;
         }
     }
 
-    free(video);
+    AVD_FREE(video);
 }
 
 void avdH264VideoDebugPrint(AVD_H264Video *video)
@@ -810,8 +838,8 @@ void avdH264VideoChunkDebugPrint(AVD_H264VideoChunk *chunk, bool logFrameInfos)
     AVD_LOG_INFO("    Capacity: %zu bytes", chunk->sliceDataBuffer.capacity);
     AVD_LOG_INFO("  Number of Frame Infos: %zu", chunk->frameInfos.count);
     AVD_LOG_INFO("  Number of Slice Headers: %zu", chunk->sliceHeaders.count);
-    AVD_LOG_INFO("  SPS Hash: 0x%08X", chunk->spsHash);
-    AVD_LOG_INFO("  PPS Hash: 0x%08X", chunk->ppsHash);
+    AVD_LOG_INFO("  SPS Hash: 0x%016llX", (unsigned long long)chunk->spsHash);
+    AVD_LOG_INFO("  PPS Hash: 0x%016llX", (unsigned long long)chunk->ppsHash);
     AVD_LOG_INFO("  Duration of Chunk: %.6f seconds", chunk->durationSeconds);
     AVD_LOG_INFO("  Timestamp of Chunk: %.6f seconds", chunk->timestampSeconds);
     if (logFrameInfos && chunk->frameInfos.count > 0) {
@@ -834,14 +862,21 @@ void avdH264VideoChunkDebugPrint(AVD_H264VideoChunk *chunk, bool logFrameInfos)
     }
 }
 
-bool avdH264VideoLoadParamsDefault(AVD_Vulkan *vulkan, AVD_H264VideoLoadParams *outParams)
+bool avdH264VideoLoadParamsDefault(struct AVD_Vulkan *vulkan, AVD_H264VideoLoadParams *outParams)
 {
     AVD_ASSERT(outParams != NULL);
     memset(outParams, 0, sizeof(AVD_H264VideoLoadParams));
     outParams->bufferOffset       = 0;
-    outParams->frameDataAlignment = AVD_ALIGN(
-        vulkan->supportedFeatures.videoCapabilitiesDecode.minBitstreamBufferOffsetAlignment,
-        vulkan->supportedFeatures.videoCapabilitiesDecode.minBitstreamBufferSizeAlignment);
+    outParams->frameDataAlignment = AVD_H264_VIDEO_DEFAULT_FRAME_DATA_ALIGNMENT;
+#ifndef AVD_HEADLESS
+    if (vulkan != NULL) {
+        outParams->frameDataAlignment = AVD_ALIGN(
+            vulkan->supportedFeatures.videoCapabilitiesDecode.minBitstreamBufferOffsetAlignment,
+            vulkan->supportedFeatures.videoCapabilitiesDecode.minBitstreamBufferSizeAlignment);
+    }
+#else
+    (void)vulkan;
+#endif
     outParams->targetFramerate = 30.0;
     return true;
 }
@@ -0,0 +1,65 @@
+#include "IndirectDrawUtils"
+
+// Must match AVD_IndirectDrawPushConstants
+struct CullPushConstantData {
+    float4 frustumPlanes[6];
+
+    uint instanceOffset;
+    uint instanceCount;
+    uint pad0;
+    uint pad1;
+};
+
+[[vk::binding(0, 0)]]
+StructuredBuffer<DrawInstance> instances : register(t0, space0);
+
+// VkDrawIndexedIndirectCommand: indexCount, instanceCount, firstIndex, vertexOffset, firstInstance
+[[vk::binding(1, 0)]]
+RWStructuredBuffer<uint> drawCommands : register(u1, space0);
+
+// the count vkCmdDrawIndexedIndirectCount reads, cleared to zero before culling
+[[vk::binding(2, 0)]]
+RWStructuredBuffer<uint> drawCount : register(u2, space0);
+
+[[vk::push_constant]]
+cbuffer PushConstants {
+    CullPushConstantData data;
+};
+
+// Same test as avdDrawInstancesCull, the radius of the box projected onto
+// every plane normal.
+bool frustumCulled(float3 center, float3 extents)
+{
+    for (uint i = 0; i < 6; i++) {
+        float4 plane = data.frustumPlanes[i];
+        float radius = abs(plane.x) * extents.x + abs(plane.y) * extents.y + abs(plane.z) * extents.z;
+        if (dot(plane.xyz, center) + plane.w + radius < 0.0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+[numthreads(64, 1, 1)]
+void main(uint3 threadId : SV_DispatchThreadID)
+{
+    if (threadId.x >= data.instanceCount) {
+        return;
+    }
+
+    DrawInstance instance = instances[data.instanceOffset + threadId.x];
+    if (frustumCulled(instance.center, instance.extents)) {
+        return;
+    }
+
+    // the order of the commands does not matter, the depth test sorts it out
+    uint slot;
+    InterlockedAdd(drawCount[0], 1, slot);
+
+    uint word              = slot * INDIRECT_DRAW_COMMAND_WORDS;
+    drawCommands[word + 0] = instance.indexCount;
+    drawCommands[word + 1] = 1;
+    drawCommands[word + 2] = instance.firstIndex;
+    drawCommands[word + 3] = 0;
+    drawCommands[word + 4] = threadId.x;
+}
@@ -0,0 +1,22 @@
+#ifndef INDIRECT_DRAW_UTILS
+#define INDIRECT_DRAW_UTILS
+
+#include "ShaderAdapter"
+
+// keep in sync with avd_indirect_draw.c
+#define INDIRECT_DRAW_COMMAND_WORDS 5
+
+// same layout as AVD_DrawInstance, the box is in world space
+struct DrawInstance {
+    float4x4 modelMatrix;
+    float3 center;
+    uint firstIndex;
+    float3 extents;
+    uint indexCount;
+    uint materialIndex;
+    int node;
+    uint pad0;
+    uint pad1;
+};
+
+#endif
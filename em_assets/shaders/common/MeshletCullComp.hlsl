@@ -0,0 +1,88 @@
+#include "MeshletUtils"
+
+struct CullPushConstantData {
+    float4x4 modelMatrix;
+    float4 frustumPlanes[6];
+    float4 cameraPosition;
+
+    uint meshletOffset;
+    uint meshletCount;
+    uint drawIndex;
+    uint visibleOffset;
+
+    uint statsIndex;
+    uint flags;
+    uint pad0;
+    uint pad1;
+};
+
+[[vk::binding(0, 0)]]
+StructuredBuffer<Meshlet> meshlets : register(t0, space0);
+
+[[vk::binding(3, 0)]]
+RWStructuredBuffer<uint> visibleMeshlets : register(u3, space0);
+
+// VkDrawIndirectCommand: vertexCount, instanceCount, firstVertex, firstInstance
+[[vk::binding(4, 0)]]
+RWStructuredBuffer<uint> drawCommands : register(u4, space0);
+
+// AVD_MeshletCullingStats: visible, frustum culled, cone culled, tested
+[[vk::binding(5, 0)]]
+RWStructuredBuffer<uint> stats : register(u5, space0);
+
+[[vk::push_constant]]
+cbuffer PushConstants {
+    CullPushConstantData data;
+};
+
+bool frustumCulled(float3 center, float radius)
+{
+    for (uint i = 0; i < 6; i++) {
+        if (dot(data.frustumPlanes[i].xyz, center) + data.frustumPlanes[i].w < -radius) {
+            return true;
+        }
+    }
+    return false;
+}
+
+[numthreads(64, 1, 1)]
+void main(uint3 threadId : SV_DispatchThreadID)
+{
+    // the commands are cleared to zero before culling
+    if (threadId.x == 0) {
+        drawCommands[data.drawIndex * 4 + 1] = 1;
+    }
+    if (threadId.x >= data.meshletCount) {
+        return;
+    }
+
+    uint meshletIndex = data.meshletOffset + threadId.x;
+    Meshlet meshlet   = meshlets[meshletIndex];
+    uint unused;
+
+    if ((data.flags & MESHLET_CULLING_FLAG_FRUSTUM) != 0) {
+        float3 center = mul(data.modelMatrix, float4(meshlet.center, 1.0)).xyz;
+        float radius  = meshlet.radius * meshletMaxScale(data.modelMatrix);
+        if (frustumCulled(center, radius)) {
+            InterlockedAdd(stats[data.statsIndex * 4 + 1], 1, unused);
+            return;
+        }
+    }
+
+    if ((data.flags & MESHLET_CULLING_FLAG_CONE) != 0) {
+        // back facing does not change under an affine transform, so test in
+        // the space of the mesh and keep the cone valid for any scale
+        float3 translation = float3(data.modelMatrix[0][3], data.modelMatrix[1][3], data.modelMatrix[2][3]);
+        float3 localCamera = mul(inverse(mat3(data.modelMatrix)), data.cameraPosition.xyz - translation);
+        if (meshletConeCulled(meshlet, localCamera)) {
+            InterlockedAdd(stats[data.statsIndex * 4 + 2], 1, unused);
+            return;
+        }
+    }
+
+    // every visible meshlet takes a fixed slot of the indirect vertex count
+    uint firstVertex;
+    InterlockedAdd(drawCommands[data.drawIndex * 4 + 0], MESHLET_SLOT_VERTICES, firstVertex);
+    visibleMeshlets[data.visibleOffset + firstVertex / MESHLET_SLOT_VERTICES] = meshletIndex;
+    InterlockedAdd(stats[data.statsIndex * 4 + 0], 1, unused);
+}
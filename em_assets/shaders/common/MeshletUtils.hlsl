@@ -0,0 +1,46 @@
+#ifndef MESHLET_UTILS
+#define MESHLET_UTILS
+
+#include "ShaderAdapter"
+
+// keep in sync with avd_model_base.h and avd_meshlet_culling.h
+#define MESHLET_MAX_TRIANGLES 124
+#define MESHLET_SLOT_VERTICES (MESHLET_MAX_TRIANGLES * 3)
+
+#define MESHLET_CULLING_FLAG_FRUSTUM 1
+#define MESHLET_CULLING_FLAG_CONE 2
+
+// same layout as AVD_Meshlet
+struct Meshlet {
+    float3 center;
+    float radius;
+    float3 coneAxis;
+    float coneCutoff;
+    uint vertexOffset;
+    uint triangleOffset;
+    uint vertexCount;
+    uint triangleCount;
+};
+
+uint meshletTriangleCorner(uint packedTriangle, uint corner)
+{
+    return (packedTriangle >> (corner * 8)) & 0xff;
+}
+
+// Same test as avdMeshletConeCulled, cameraPosition is in the space of the mesh.
+bool meshletConeCulled(Meshlet meshlet, float3 cameraPosition)
+{
+    float3 toCenter = meshlet.center - cameraPosition;
+    return dot(toCenter, meshlet.coneAxis) >= meshlet.coneCutoff * length(toCenter) + meshlet.radius;
+}
+
+// Same bound as avdSphereTransform, the longest basis vector.
+float meshletMaxScale(float4x4 modelMatrix)
+{
+    float3 axisX = float3(modelMatrix[0][0], modelMatrix[1][0], modelMatrix[2][0]);
+    float3 axisY = float3(modelMatrix[0][1], modelMatrix[1][1], modelMatrix[2][1]);
+    float3 axisZ = float3(modelMatrix[0][2], modelMatrix[1][2], modelMatrix[2][2]);
+    return sqrt(max(dot(axisX, axisX), max(dot(axisY, axisY), dot(axisZ, axisZ))));
+}
+
+#endif
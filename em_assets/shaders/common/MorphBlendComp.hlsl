@@ -0,0 +1,197 @@
+// Must match AVD_MorphBlendPushConstants
+struct MorphBlendPushConstantData {
+    uint activeOffset;
+    uint activeCount;
+    uint vertexOffset;
+    uint vertexCount;
+
+    uint accumulatorOffset; // in vertices
+    uint pass;
+    uint pad0;
+    uint pad1;
+};
+
+// AVD_MorphTargetDeltas
+struct MorphTargetDeltas {
+    uint deltaOffset; // into morphDeltas, in 32 bit words
+    uint deltaCount;
+    uint encoding;
+    float positionScale;
+};
+
+#define MORPH_BLEND_PASS_ACCUMULATE 0
+#define MORPH_BLEND_PASS_RESOLVE 1
+
+#define MORPH_DELTA_ENCODING_QUANTIZED 1
+
+// AVD_MORPH_NORMAL_SCALE, AVD_MORPH_FIXED_POINT_SCALE
+#define MORPH_NORMAL_SCALE (2.0 / 32767.0)
+#define MORPH_FIXED_POINT_SCALE 1048576.0
+
+#define MORPH_ACCUMULATORS 6
+
+// AVD_ModelVertexPacked as four words: vx vy, vz tp, np, tu tv
+[[vk::binding(0, 0)]]
+StructuredBuffer<uint4> baseVertices : register(t0, space0);
+
+[[vk::binding(1, 0)]]
+RWStructuredBuffer<uint4> deformedVertices : register(u1, space0);
+
+[[vk::binding(2, 0)]]
+StructuredBuffer<MorphTargetDeltas> morphTargets : register(t2, space0);
+
+// AVD_MorphDelta or AVD_MorphDeltaQuantized, the encoding of the target decides
+[[vk::binding(3, 0)]]
+StructuredBuffer<uint> morphDeltas : register(t3, space0);
+
+[[vk::binding(4, 0)]]
+RWStructuredBuffer<int> accumulators : register(u4, space0);
+
+// target index, weight as float bits
+[[vk::binding(5, 0)]]
+StructuredBuffer<uint2> activeTargets : register(t5, space0);
+
+[[vk::push_constant]]
+cbuffer PushConstants {
+    MorphBlendPushConstantData data;
+};
+
+// The half conversions of avd_utils.c rather than f16tof32/f32tof16, their
+// rounding and denormal handling is not specified closely enough to match the
+// CPU blend.
+float dequantizeHalf(uint h)
+{
+    uint s  = (h & 0x8000) << 16;
+    uint em = h & 0x7fff;
+    uint r  = (em + (112 << 10)) << 13;
+    r       = (em < (1 << 10)) ? 0 : r;
+    r += (em >= (31 << 10)) ? (112 << 23) : 0;
+    return asfloat(s | r);
+}
+
+uint quantizeHalf(float v)
+{
+    uint ui = asuint(v);
+    uint s  = (ui >> 16) & 0x8000;
+    int em  = (int)(ui & 0x7fffffff);
+    int h   = (em - (112 << 23) + (1 << 12)) >> 13;
+    h       = (em < (113 << 23)) ? 0 : h;
+    h       = (em >= (143 << 23)) ? 0x7c00 : h;
+    h       = (em > (255 << 23)) ? 0x7e00 : h;
+    return s | (uint)h;
+}
+
+int quantizeSnorm10(float v)
+{
+    float round = v >= 0.0 ? 0.5 : -0.5;
+    return (int)(clamp(v, -1.0, 1.0) * 511.0 + round);
+}
+
+// floor(x + 0.5) of the weighted delta, precise so that the compiler does not
+// fuse it into a differently rounded multiply add
+int toFixed(float weight, float value)
+{
+    precise float fixedValue = floor(weight * value * MORPH_FIXED_POINT_SCALE + 0.5);
+    return (int)clamp(fixedValue, -1073741824.0, 1073741824.0);
+}
+
+int lowInt16(uint word)
+{
+    return ((int)(word << 16)) >> 16;
+}
+
+int highInt16(uint word)
+{
+    return ((int)word) >> 16;
+}
+
+void accumulate(uint3 threadId)
+{
+    uint2 active             = activeTargets[data.activeOffset + threadId.y];
+    MorphTargetDeltas target = morphTargets[active.x];
+    if (threadId.x >= target.deltaCount) {
+        return;
+    }
+
+    float weight = asfloat(active.y);
+    uint vertex;
+    float3 position;
+    float3 normal;
+    if (target.encoding == MORPH_DELTA_ENCODING_QUANTIZED) {
+        uint word = target.deltaOffset + threadId.x * 4;
+        uint w1   = morphDeltas[word + 1];
+        uint w2   = morphDeltas[word + 2];
+        uint w3   = morphDeltas[word + 3];
+        vertex    = morphDeltas[word];
+        position  = float3(lowInt16(w1), highInt16(w1), lowInt16(w2)) * target.positionScale;
+        normal    = float3(highInt16(w2), lowInt16(w3), highInt16(w3)) * MORPH_NORMAL_SCALE;
+    } else {
+        uint word = target.deltaOffset + threadId.x * 7;
+        vertex    = morphDeltas[word];
+        position  = asfloat(uint3(morphDeltas[word + 1], morphDeltas[word + 2], morphDeltas[word + 3]));
+        normal    = asfloat(uint3(morphDeltas[word + 4], morphDeltas[word + 5], morphDeltas[word + 6]));
+    }
+    if (vertex >= data.vertexCount) {
+        return;
+    }
+
+    uint base = (data.accumulatorOffset + vertex) * MORPH_ACCUMULATORS;
+    InterlockedAdd(accumulators[base + 0], toFixed(weight, position.x));
+    InterlockedAdd(accumulators[base + 1], toFixed(weight, position.y));
+    InterlockedAdd(accumulators[base + 2], toFixed(weight, position.z));
+    InterlockedAdd(accumulators[base + 3], toFixed(weight, normal.x));
+    InterlockedAdd(accumulators[base + 4], toFixed(weight, normal.y));
+    InterlockedAdd(accumulators[base + 5], toFixed(weight, normal.z));
+}
+
+void resolve(uint3 threadId)
+{
+    if (threadId.x >= data.vertexCount) {
+        return;
+    }
+
+    uint index       = data.vertexOffset + threadId.x;
+    uint4 vertex     = baseVertices[index];
+    uint base        = (data.accumulatorOffset + threadId.x) * MORPH_ACCUMULATORS;
+    int3 positionSum = int3(accumulators[base + 0], accumulators[base + 1], accumulators[base + 2]);
+    int3 normalSum   = int3(accumulators[base + 3], accumulators[base + 4], accumulators[base + 5]);
+
+    // vertices none of the active targets moved are copied, a round trip
+    // through the normalization could change their normal
+    if (all(positionSum == 0) && all(normalSum == 0)) {
+        deformedVertices[index] = vertex;
+        return;
+    }
+
+    const float unit = 1.0 / MORPH_FIXED_POINT_SCALE;
+    float3 position  = float3(dequantizeHalf(vertex.x & 0xffff), dequantizeHalf(vertex.x >> 16), dequantizeHalf(vertex.y & 0xffff));
+    position += float3(positionSum) * unit;
+
+    uint np       = vertex.z;
+    float3 normal = float3(int3(np & 1023, (np >> 10) & 1023, (np >> 20) & 1023) - 511) / 511.0;
+    normal += float3(normalSum) * unit;
+    float len = length(normal);
+    if (len > 1e-8) {
+        normal /= len;
+    }
+
+    uint3 packedNormal = uint3(
+        quantizeSnorm10(normal.x) + 511,
+        quantizeSnorm10(normal.y) + 511,
+        quantizeSnorm10(normal.z) + 511);
+
+    vertex.x                = quantizeHalf(position.x) | (quantizeHalf(position.y) << 16);
+    vertex.y                = quantizeHalf(position.z) | (vertex.y & 0xffff0000);
+    vertex.z                = packedNormal.x | (packedNormal.y << 10) | (packedNormal.z << 20) | (np & (3u << 30));
+    deformedVertices[index] = vertex;
+}
+
+[numthreads(64, 1, 1)]
+void main(uint3 threadId : SV_DispatchThreadID)
+{
+    if (data.pass == MORPH_BLEND_PASS_ACCUMULATE) {
+        accumulate(threadId);
+    } else {
+        resolve(threadId);
+    }
+}
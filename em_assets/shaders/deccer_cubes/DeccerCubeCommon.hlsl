@@ -16,6 +16,7 @@ struct UberPushConstantData {
 struct VertexShaderOutput {
     float2 uv : TEXCOORD0;
     float3 normal: NORMAL;
+    nointerpolation uint textureIndex : TEXCOORD1; // 0 for none
     float4 position : POSITION;
     float4 targetPosition : SV_Position;
 };
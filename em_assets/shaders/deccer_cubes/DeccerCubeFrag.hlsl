@@ -1,10 +1,5 @@
 #include "DeccerCubeCommon"
 
-[[vk::push_constant]]
-cbuffer PushConstants {
-    UberPushConstantData data;
-};
-
 [[vk::binding(1, 1)]]
 SAMPLER2D_TAB(textures, 1);
 
@@ -15,8 +10,8 @@ float4 main(VertexShaderOutput input) : SV_Target {
     float3 L = normalize(lightPosition - input.position.xyz);
 
     float3 albedo = float3(0.8, 0.3, 0.2);
-    if (data.textureIndex > 0) {
-        albedo = SAMPLE_TEXTURE_TAB(textures, input.uv, data.textureIndex).rgb;
+    if (input.textureIndex > 0) {
+        albedo = SAMPLE_TEXTURE_TAB(textures, input.uv, input.textureIndex).rgb;
     }
 
     float3 ambient = 0.05 * albedo;
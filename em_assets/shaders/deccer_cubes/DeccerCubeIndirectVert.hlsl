@@ -0,0 +1,58 @@
+#include "DeccerCubeCommon"
+#include "IndirectDrawUtils"
+
+[[vk::binding(0, 0)]]
+StructuredBuffer<ModelVertex> vertices : register(t0, space0);
+
+[[vk::binding(0, 2)]]
+StructuredBuffer<DrawInstance> instances : register(t0, space2);
+
+// Must match AVD_DeccerCubeIndirectPushConstants, the model matrix and
+// texture come from the instance
+struct IndirectPushConstantData {
+    float4x4 projectionMatrix;
+    float4x4 viewMatrix;
+
+    uint instanceOffset; // start of the instances of this frame
+    uint pad0;
+    uint pad1;
+    uint pad2;
+};
+
+[[vk::push_constant]]
+cbuffer PushConstants {
+    IndirectPushConstantData data;
+};
+
+// The index buffer is bound and the indices are absolute, so the vertex index
+// is the vertex itself. The instance index includes firstInstance, which the
+// culling sets to the instance of the command.
+VertexShaderOutput main(uint vertexIndex : SV_VertexID, uint instanceIndex : SV_InstanceID)
+{
+    VertexShaderOutput output;
+
+    DrawInstance instance = instances[data.instanceOffset + instanceIndex];
+    ModelVertex vertex    = vertices[vertexIndex];
+
+    float4x4 modelMatrix      = instance.modelMatrix;
+    float4x4 viewMatrix       = data.viewMatrix;
+    float4x4 viewModelMatrix  = mul(viewMatrix, modelMatrix);
+    float4x4 projectionMatrix = data.projectionMatrix;
+    float3x3 normalMatrix     = transpose(inverse(mat3(modelMatrix)));
+
+    float3 normal;
+    float4 tangent;
+    unpackTBN(vertex.np, uint(vertex.tp), normal, tangent);
+
+    float4 viewPosition = mul(viewModelMatrix, float4(vertex.vx, vertex.vy, vertex.vz, 1.0));
+    float4 position     = mul(projectionMatrix, viewPosition);
+
+    output.uv             = float2(vertex.tu, vertex.tv);
+    output.normal         = mul(normalMatrix, normalize(normal));
+    output.position       = viewPosition;
+    output.textureIndex   = instance.materialIndex;
+    output.targetPosition = position;
+    output.targetPosition.y *= -1.0;
+
+    return output;
+}
@@ -0,0 +1,68 @@
+#include "DeccerCubeCommon"
+#include "MeshletUtils"
+
+[[vk::binding(0, 0)]]
+StructuredBuffer<ModelVertex> vertices : register(t0, space0);
+
+[[vk::binding(0, 2)]]
+StructuredBuffer<Meshlet> meshlets : register(t0, space2);
+
+[[vk::binding(1, 2)]]
+StructuredBuffer<uint> meshletVertices : register(t1, space2);
+
+[[vk::binding(2, 2)]]
+StructuredBuffer<uint> meshletTriangles : register(t2, space2);
+
+[[vk::binding(3, 2)]]
+StructuredBuffer<uint> visibleMeshlets : register(t3, space2);
+
+// vertexOffset holds the start of the visible meshlets of this draw
+[[vk::push_constant]]
+cbuffer PushConstants {
+    UberPushConstantData data;
+};
+
+VertexShaderOutput main(uint vertexIndex : SV_VertexID)
+{
+    VertexShaderOutput output;
+
+    uint meshletIndex = visibleMeshlets[data.vertexOffset + vertexIndex / MESHLET_SLOT_VERTICES];
+    uint slotCorner   = vertexIndex % MESHLET_SLOT_VERTICES;
+    Meshlet meshlet   = meshlets[meshletIndex];
+
+    // padding of the slot, a degenerate triangle outside of the depth range
+    if (slotCorner >= meshlet.triangleCount * 3) {
+        output.uv             = float2(0.0, 0.0);
+        output.normal         = float3(0.0, 0.0, 0.0);
+        output.textureIndex   = 0;
+        output.position       = float4(0.0, 0.0, 0.0, 1.0);
+        output.targetPosition = float4(0.0, 0.0, 2.0, 1.0);
+        return output;
+    }
+
+    uint packedTriangle = meshletTriangles[meshlet.triangleOffset + slotCorner / 3];
+    uint localIndex     = meshletTriangleCorner(packedTriangle, slotCorner % 3);
+    uint index          = meshletVertices[meshlet.vertexOffset + localIndex];
+
+    float4x4 modelMatrix      = data.modelMatrix;
+    float4x4 viewMatrix       = data.viewMatrix;
+    float4x4 viewModelMatrix  = mul(viewMatrix, modelMatrix);
+    float4x4 projectionMatrix = data.projectionMatrix;
+    float3x3 normalMatrix     = transpose(inverse(mat3(data.modelMatrix)));
+
+    float3 normal;
+    float4 tangent;
+    unpackTBN(vertices[index].np, uint(vertices[index].tp), normal, tangent);
+
+    float4 viewPosition = mul(viewModelMatrix, float4(vertices[index].vx, vertices[index].vy, vertices[index].vz, 1.0));
+    float4 position     = mul(projectionMatrix, viewPosition);
+
+    output.uv             = float2(vertices[index].tu, vertices[index].tv);
+    output.position       = viewPosition;
+    output.normal         = mul(normalMatrix, normalize(normal));
+    output.textureIndex   = data.textureIndex;
+    output.targetPosition = position;
+    output.targetPosition.y *= -1.0;
+
+    return output;
+}
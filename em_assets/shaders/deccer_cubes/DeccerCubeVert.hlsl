@@ -58,6 +58,7 @@ VertexShaderOutput main(uint vertexIndex : SV_VertexID)
     output.uv       = sampleTextureCoords(vertexIndex);
     output.position = viewPosition;
     output.normal = mul(normalMatrix, normal);
+    output.textureIndex = data.textureIndex;
     output.targetPosition = position;
     output.targetPosition.y *= -1.0;
 
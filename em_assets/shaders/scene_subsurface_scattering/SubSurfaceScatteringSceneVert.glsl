@@ -15,6 +15,13 @@ layout(set = 0, binding = 0, std430) readonly buffer VertexBuffer
     ModelVertex vertices[];
 };
 
+// vertexOffset in the push constants is the first index of the drawn range,
+// the meshes share welded vertices so they have to go through their indices
+layout(set = 0, binding = 1, std430) readonly buffer IndexBuffer
+{
+    uint indices[];
+};
+
 layout(push_constant) uniform PushConstants
 {
     UberPushConstantData data;
@@ -35,7 +42,7 @@ void main()
 {
     outUV = vec2(0.0, 0.0); // Initialize outUV to avoid warnings
 
-    int vertexIndex = gl_VertexIndex + pushConstants.data.vertexOffset;
+    int vertexIndex = int(indices[gl_VertexIndex + pushConstants.data.vertexOffset]);
 
     mat4 viewModelMatrix  = pushConstants.data.viewModelMatrix;
     mat4 projectionMatrix = pushConstants.data.projectionMatrix;
@@ -44,7 +51,7 @@ void main()
 
     if (pushConstants.data.renderingLight == 1) {
         bool isLightA            = gl_VertexIndex / pushConstants.data.vertexCount == 0;
-        vertexIndex              = gl_VertexIndex % pushConstants.data.vertexCount + pushConstants.data.vertexOffset;
+        vertexIndex              = int(indices[gl_VertexIndex % pushConstants.data.vertexCount + pushConstants.data.vertexOffset]);
         vec4 lightVertexPosition = samplePosition(vertexIndex) * 0.1f;
         if (isLightA) {
             outRenderingLight = 1;
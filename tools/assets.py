@@ -703,7 +703,7 @@ def calculate_shader_dependency_hash(output_dir, shader_name, shader_names):
     dependencies = [read_shader_source(output_dir, dep) for dep in dependencies]
     # return a 32 integer bit hash of the concatenated shader sources, RETURN A INTEGER HASH
     concatenated_sources = ''.join(dependencies) 
-    return int(hashlib.sha256(concatenated_sources.encode('utf-8')).hexdigest()[:8], 16)
+    return int(hashlib.sha256(concatenated_sources.encode('utf-8')).hexdigest()[:16], 16)
 
 
 def create_shader_assets_common_header(output_dir):
@@ -734,7 +734,7 @@ def create_shader_assets_common_header(output_dir):
         "// Returns a list of shader names that this shader depends on",
         "const char** avdAssetShaderGetDependencies(const char* name, size_t* count); \n",
         "// Returns a hash of the shader dependencies",
-        "unsigned int avdAssetShaderGetDependencyHash(const char* name); \n",
+        "unsigned long long avdAssetShaderGetDependencyHash(const char* name); \n",
         f"\n",
         f"#endif // AVD_ASSET_SHADER_COMMON_H"
     ]
@@ -811,14 +811,14 @@ def create_shader_assets_common_header(output_dir):
         f"\n"
         f"// This function returns a hash of the shader dependencies.",
         f"// It is used to ensure that all dependencies are included in the build.",
-        f"unsigned int avdAssetShaderGetDependencyHash(const char* name) {{",
+        f"unsigned long long avdAssetShaderGetDependencyHash(const char* name) {{",
         f"    if (name == NULL) {{",
         f"        return 0;",
         f"    }}",
         f"    if (strcmp(name, \"\") == 0) {{",
         f"        return 0;",
         f"    }}",
-        *[f"    if (strcmp(name, \"{shader_name}\") == 0) return {calculate_shader_dependency_hash(output_dir, shader_name, all_shader_names)};" for shader_name in all_shader_names],
+        *[f"    if (strcmp(name, \"{shader_name}\") == 0) return {calculate_shader_dependency_hash(output_dir, shader_name, all_shader_names)}ull;" for shader_name in all_shader_names],
         f"    printf(\"Error: Shader asset \\\"%s\\\" not found.\\n\", name);",
         f"    return 0;",
         f"}}",